@@ -0,0 +1,168 @@
+#include "PayloadHeader.h"
+#include "../utils/Checksum.h"
+#include "../utils/CryptoModule.h"
+
+#include <sstream>
+
+namespace {
+
+constexpr std::size_t CRC_OFFSET = 16;
+
+void WriteU32(uint8_t *out, uint32_t value) {
+    for (int idx = 0; idx < 4; ++idx) {
+        out[idx] = static_cast<uint8_t>(value >> (8 * idx));
+    }
+}
+
+uint32_t ReadU32(const uint8_t *in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Magic and checksum match: anything else is rejected by Parse
+bool IsIntact(const uint8_t *bytes) {
+    return ReadU32(bytes) == PayloadHeader::MAGIC && ReadU32(bytes + CRC_OFFSET) == Checksum::Crc32c(bytes, CRC_OFFSET);
+}
+
+// lsb and lsbmatch write the same layout, so either one can read the other's payload
+bool SharesLayout(PayloadMethod stored, PayloadMethod reader) {
+    auto plain = [](PayloadMethod method) {
+        return method == PayloadMethod::LSB || method == PayloadMethod::LSBMatching;
+    };
+    return stored == reader || (plain(stored) && plain(reader));
+}
+
+} // namespace
+
+std::array<uint8_t, PayloadHeader::SIZE_BYTES> PayloadHeader::Encode(PayloadMethod method, uint32_t dataSize, uint8_t flags) {
+    std::array<uint8_t, SIZE_BYTES> header{};
+    WriteU32(header.data(), MAGIC);
+    header[4] = VERSION;
+    header[5] = static_cast<uint8_t>(method);
+    header[6] = flags;
+    header[7] = KDF_PBKDF2_SHA256;
+    WriteU32(header.data() + 8, static_cast<uint32_t>(CryptoModule::PBKDF2_ITERATIONS));
+    WriteU32(header.data() + 12, dataSize);
+    WriteU32(header.data() + CRC_OFFSET, Checksum::Crc32c(header.data(), CRC_OFFSET));
+    return header;
+}
+
+std::vector<uint8_t> PayloadHeader::Build(PayloadMethod method, const std::vector<uint8_t> &data, uint8_t flags) {
+    auto header = Encode(method, static_cast<uint32_t>(data.size()), flags);
+    std::vector<uint8_t> stream(SIZE_BYTES + data.size());
+    std::copy(header.begin(), header.end(), stream.begin());
+    std::copy(data.begin(), data.end(), stream.begin() + SIZE_BYTES);
+    return stream;
+}
+
+std::vector<uint8_t> PayloadHeader::AddCopies(PayloadMethod method, const std::vector<uint8_t> &data, uint8_t flags) {
+    auto header = Encode(method, static_cast<uint32_t>(COPIES_SIZE_BYTES + data.size()), flags);
+    std::vector<uint8_t> stream(COPIES_SIZE_BYTES + data.size());
+    for (std::size_t copy = 0; copy + 1 < ECC_COPIES; ++copy) {
+        std::copy(header.begin(), header.end(), stream.begin() + copy * SIZE_BYTES);
+    }
+    std::copy(data.begin(), data.end(), stream.begin() + COPIES_SIZE_BYTES);
+    return stream;
+}
+
+Result<PayloadHeader> PayloadHeader::Parse(const uint8_t *bytes, std::size_t size, PayloadMethod method,
+                                           bool acceptLegacy) {
+    // A damaged first copy: any bit that at most one copy got wrong is still right in the majority
+    std::array<uint8_t, SIZE_BYTES> voted{};
+    if (size >= PROTECTED_SIZE_BYTES && !IsIntact(bytes)) {
+        const uint8_t *second = bytes + SIZE_BYTES;
+        const uint8_t *third = bytes + 2 * SIZE_BYTES;
+        for (std::size_t idx = 0; idx < SIZE_BYTES; ++idx) {
+            voted[idx] = static_cast<uint8_t>((bytes[idx] & second[idx]) | (bytes[idx] & third[idx]) |
+                                              (second[idx] & third[idx]));
+        }
+        if (IsIntact(voted.data()) && (voted[6] & FLAG_ERROR_CORRECTION) != 0) {
+            bytes = voted.data();
+            size = SIZE_BYTES;
+        }
+    }
+
+    if (size < (acceptLegacy ? LEGACY_SIZE_BYTES : SIZE_BYTES)) {
+        return Result<PayloadHeader>(ErrorCode::ImageTooSmall, "Carrier is too small to contain a payload header");
+    }
+
+    PayloadHeader header;
+
+    // No magic: a payload written before the header existed, or no payload at all
+    if (ReadU32(bytes) != MAGIC) {
+        if (!acceptLegacy) {
+            return Result<PayloadHeader>(
+                ErrorCode::CorruptedPayload,
+                "No payload header found. Carrier may not contain embedded data or password is wrong."
+            );
+        }
+        header.version = 0;
+        header.dataSize = ReadU32(bytes);
+        return Result<PayloadHeader>(header);
+    }
+
+    if (size < SIZE_BYTES) {
+        return Result<PayloadHeader>(ErrorCode::ImageTooSmall, "Carrier is too small to contain a payload header");
+    }
+
+    if (ReadU32(bytes + CRC_OFFSET) != Checksum::Crc32c(bytes, CRC_OFFSET)) {
+        return Result<PayloadHeader>(
+            ErrorCode::CorruptedPayload,
+            "Payload header checksum mismatch. Carrier may not contain embedded data or was modified."
+        );
+    }
+
+    header.version = bytes[4];
+    header.method = static_cast<PayloadMethod>(bytes[5]);
+    header.flags = bytes[6];
+    header.kdf = bytes[7];
+    header.kdfIterations = ReadU32(bytes + 8);
+    header.dataSize = ReadU32(bytes + 12);
+
+    if (header.version != VERSION) {
+        std::ostringstream oss;
+        oss << "Unsupported payload format version " << static_cast<int>(header.version)
+            << " (supported: " << static_cast<int>(VERSION) << ")";
+        return Result<PayloadHeader>(ErrorCode::CorruptedPayload, oss.str());
+    }
+
+    if (!SharesLayout(header.method, method)) {
+        return Result<PayloadHeader>(
+            ErrorCode::MethodMismatch,
+            "Payload was embedded with method '" + GetMethodName(header.method) +
+            "', not '" + GetMethodName(method) + "'"
+        );
+    }
+
+    if ((header.flags & ~KNOWN_FLAGS) != 0) {
+        std::ostringstream oss;
+        oss << "Unsupported payload flags 0x" << std::hex << static_cast<int>(header.flags);
+        return Result<PayloadHeader>(ErrorCode::CorruptedPayload, oss.str());
+    }
+
+    if (header.kdf != KDF_PBKDF2_SHA256 ||
+        header.kdfIterations != static_cast<uint32_t>(CryptoModule::PBKDF2_ITERATIONS)) {
+        std::ostringstream oss;
+        oss << "Unsupported key derivation (id " << static_cast<int>(header.kdf)
+            << ", " << header.kdfIterations << " iterations)";
+        return Result<PayloadHeader>(ErrorCode::CorruptedPayload, oss.str());
+    }
+
+    return Result<PayloadHeader>(header);
+}
+
+std::string PayloadHeader::GetMethodName(PayloadMethod method) {
+    switch (method) {
+        case PayloadMethod::LSB:         return "lsb";
+        case PayloadMethod::LSBShuffle:  return "lsbshuffle";
+        case PayloadMethod::LSBMatching: return "lsbmatch";
+        case PayloadMethod::LSBHamming:  return "hamming";
+        case PayloadMethod::DCT:         return "dct";
+        case PayloadMethod::LSBAdaptive: return "adaptive";
+        case PayloadMethod::WAV:         return "wav";
+        case PayloadMethod::APNG:        return "apng";
+        case PayloadMethod::Y4M:         return "y4m";
+        case PayloadMethod::LSBTiled:    return "lsbtile";
+        default:                         return "unknown";
+    }
+}
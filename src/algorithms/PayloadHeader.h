@@ -0,0 +1,175 @@
+#ifndef __PAYLOAD_HEADER_H_
+#define __PAYLOAD_HEADER_H_
+
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "../utils/ErrorHandler.h"
+
+/**
+ * @brief Method identifiers stored in the payload header.
+ *
+ * Values are part of the on-disk format: never renumber, only append.
+ */
+enum class PayloadMethod : uint8_t {
+    Unknown = 0,
+    LSB = 1,
+    LSBShuffle = 2,
+    LSBMatching = 3,
+    LSBHamming = 4,
+    DCT = 5,
+    LSBAdaptive = 6,
+    WAV = 7,
+    APNG = 8,
+    Y4M = 9,
+    LSBTiled = 10
+};
+
+/**
+ * @brief Self-describing header written in front of every embedded payload.
+ *
+ * Layout (20 bytes, little endian, read LSB first like the data that follows):
+ *   [0..3]   magic "STG1"
+ *   [4]      format version
+ *   [5]      PayloadMethod that embedded the data
+ *   [6]      flags (FLAG_ constants below, other bits must be 0)
+ *   [7]      key derivation id (1 = PBKDF2-HMAC-SHA256)
+ *   [8..11]  key derivation iterations
+ *   [12..15] size of the data that follows
+ *   [16..19] CRC-32C of bytes 0..15
+ *
+ * Reed-Solomon only covers the data, so with FLAG_ERROR_CORRECTION two more copies
+ * of the header lead the data (they count towards dataSize, so handlers place them
+ * like any other data). Parse votes bitwise over the three copies when the first
+ * one is damaged, and DecryptPayload drops them before decoding.
+ *
+ * Payloads that lsb and lsbshuffle wrote before the header existed start with a
+ * bare 32-bit size. For those methods Parse falls back to that layout when the
+ * magic is absent, so old stego files still extract; such headers report version 0
+ * and PayloadMethod::Unknown. Every other method requires the magic.
+ */
+struct PayloadHeader {
+    /** Magic bytes "STG1" read as a little endian word **/
+    static constexpr uint32_t MAGIC = 0x31475453;
+    static constexpr uint8_t VERSION = 1;
+    static constexpr uint8_t KDF_PBKDF2_SHA256 = 1;
+
+    /** Data starts with a keyed check of the encrypted payload, see CryptoModule::AddKeyCheck **/
+    static constexpr uint8_t FLAG_KEY_CHECK = 0x01;
+    /** Plaintext was compressed before encryption, see Compression **/
+    static constexpr uint8_t FLAG_COMPRESSED = 0x02;
+    /** Data is wrapped in Reed-Solomon error correction, see ReedSolomon **/
+    static constexpr uint8_t FLAG_ERROR_CORRECTION = 0x04;
+    static constexpr uint8_t KNOWN_FLAGS = FLAG_KEY_CHECK | FLAG_COMPRESSED | FLAG_ERROR_CORRECTION;
+
+    /** Size of the header in bytes / bits **/
+    static constexpr std::size_t SIZE_BYTES = 20;
+    static constexpr std::size_t SIZE_BITS = SIZE_BYTES * 8;
+
+    /** With FLAG_ERROR_CORRECTION the header is written this many times in a row **/
+    static constexpr std::size_t ECC_COPIES = 3;
+    /** Bytes / bits a reader needs to see every copy **/
+    static constexpr std::size_t PROTECTED_SIZE_BYTES = SIZE_BYTES * ECC_COPIES;
+    static constexpr std::size_t PROTECTED_SIZE_BITS = PROTECTED_SIZE_BYTES * 8;
+    /** Bytes the copies after the first add in front of the data **/
+    static constexpr std::size_t COPIES_SIZE_BYTES = PROTECTED_SIZE_BYTES - SIZE_BYTES;
+
+    /** Size of the pre-header payload prefix (bare 32-bit size) **/
+    static constexpr std::size_t LEGACY_SIZE_BYTES = 4;
+
+    uint8_t version = VERSION;
+    PayloadMethod method = PayloadMethod::Unknown;
+    uint8_t flags = 0;
+    uint8_t kdf = KDF_PBKDF2_SHA256;
+    uint32_t kdfIterations = 0;
+    uint32_t dataSize = 0;
+
+    /**
+     * @brief Number of stream bytes this header occupied (4 for legacy payloads).
+     */
+    std::size_t GetSizeBytes() const { return version == 0 ? LEGACY_SIZE_BYTES : SIZE_BYTES; }
+
+    /**
+     * @brief Number of stream bits this header occupied; data starts right after.
+     */
+    std::size_t GetSizeBits() const { return GetSizeBytes() * 8; }
+
+    /**
+     * @brief Serialize a current-version header.
+     *
+     * @param method Method doing the embedding
+     * @param dataSize Size of the data that follows the header
+     * @param flags Combination of the FLAG_ constants
+     * @return Header bytes
+     */
+    static std::array<uint8_t, SIZE_BYTES> Encode(PayloadMethod method, uint32_t dataSize, uint8_t flags = 0);
+
+    /**
+     * @brief Build the stream to embed: header followed by the data.
+     *
+     * @param method Method doing the embedding
+     * @param data Data to embed (already encrypted)
+     * @param flags Combination of the FLAG_ constants
+     * @return Header and data bytes
+     */
+    static std::vector<uint8_t> Build(PayloadMethod method, const std::vector<uint8_t> &data, uint8_t flags = 0);
+
+    /**
+     * @brief Prefix error corrected data with the header copies beyond the first.
+     *
+     * @param method Method doing the embedding
+     * @param data Data to embed (already Reed-Solomon encoded)
+     * @param flags Combination of the FLAG_ constants, including FLAG_ERROR_CORRECTION
+     * @return COPIES_SIZE_BYTES of header copies followed by the data; Build then adds
+     *         the first copy, identical to the others
+     */
+    static std::vector<uint8_t> AddCopies(PayloadMethod method, const std::vector<uint8_t> &data, uint8_t flags);
+
+    /**
+     * @brief Validate the start of an extracted stream.
+     *
+     * Needs at most PROTECTED_SIZE_BYTES bytes, so a handler can reject carriers that
+     * hold no payload, or a payload of another method, before extracting the rest.
+     * When the first copy fails its checksum and all copies are available, the bitwise
+     * majority of the copies is used instead, provided it is intact and has
+     * FLAG_ERROR_CORRECTION set.
+     *
+     * @param bytes First bytes of the stream
+     * @param size Number of bytes available (fewer than SIZE_BYTES for tiny carriers)
+     * @param method Method doing the extraction
+     * @param acceptLegacy Whether a stream without magic is a legacy bare size rather than an error
+     * @return Result containing the header, or ImageTooSmall, CorruptedPayload or MethodMismatch
+     */
+    static Result<PayloadHeader> Parse(const uint8_t *bytes, std::size_t size, PayloadMethod method,
+                                       bool acceptLegacy = false);
+
+    /**
+     * @brief Read and validate the header through a per-bit accessor.
+     *
+     * @param availableBits Number of stream bits the carrier holds
+     * @param method Method doing the extraction
+     * @param readBit Returns stream bit i in bit 0 (higher bits are ignored)
+     * @param acceptLegacy See Parse
+     * @return Result of Parse on the first min(availableBits, PROTECTED_SIZE_BITS) bits
+     */
+    template <typename ReadBit>
+    static Result<PayloadHeader> Read(std::size_t availableBits, PayloadMethod method, ReadBit readBit,
+                                      bool acceptLegacy = false) {
+        std::array<uint8_t, PROTECTED_SIZE_BYTES> bytes{};
+        std::size_t bitCount = std::min(availableBits, PROTECTED_SIZE_BITS);
+        for (std::size_t bit = 0; bit < bitCount; ++bit) {
+            bytes[bit / 8] |= static_cast<uint8_t>((readBit(bit) & 1u) << (bit % 8));
+        }
+        return Parse(bytes.data(), bitCount / 8, method, acceptLegacy);
+    }
+
+    /**
+     * @brief Command line name of a method ("lsb", "dct", ...).
+     */
+    static std::string GetMethodName(PayloadMethod method);
+};
+
+#endif // __PAYLOAD_HEADER_H_
@@ -1,53 +1,47 @@
 #include "StegoHandler.h"
 #include "../utils/ImageIO.h"
 #include "../utils/CryptoModule.h"
+#include "../utils/Compression.h"
+#include "../utils/ReedSolomon.h"
+#include "../utils/Stats.h"
 
 #include <vector>
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <filesystem>
+
+namespace {
+
+// Decoded image plus the decoder's own buffer, which it holds until the image is copied out
+constexpr std::size_t IMAGE_COPIES = 2;
+// Payload buffers alive at once: the one being transformed, its result and the embedded stream
+constexpr std::size_t PAYLOAD_COPIES = 3;
+
+} // namespace
 
 Result<> StegoHandler::Embed(const std::string &coverFile,
                              const std::string &dataFile,
                              const std::string &outputFile,
                              const std::string &password) {
     
+    auto memoryCheck = CheckMemoryLimit(coverFile, dataFile, sizeof(uint8_t));
+    if (!memoryCheck) {
+        return memoryCheck;
+    }
+
     // Load cover image
     auto imageResult = ImageIO::Load(coverFile);
     if (!imageResult) {
         return Result<>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
     }
     
-    auto imageData = imageResult.GetValue();
-
-    // Load data file
-    std::ifstream inFile(dataFile, std::ios::binary);
-    if (!inFile) {
-        return Result<>(
-            ErrorCode::FileNotFound,
-            "Failed to open data file '" + dataFile + "'"
-        );
-    }
-    
-    // Read text in file into a vector
-    std::vector<uint8_t> plainData((std::istreambuf_iterator<char>(inFile)),
-                                    std::istreambuf_iterator<char>());
-    inFile.close();
-    
-    if (plainData.empty()) {
-        return Result<>(
-            ErrorCode::InvalidArgument,
-            "Data file '" + dataFile + "' is empty. Nothing to embed."
-        );
-    }
+    auto imageData = std::move(imageResult.GetValue());
 
-    // Encrypt data
-    auto encryptResult = CryptoModule::EncryptData(plainData, password);
+    // Load and encrypt data
+    auto encryptResult = LoadEncryptedData(dataFile, password);
     if (!encryptResult) {
-        return Result<>(
-            encryptResult.GetErrorCode(),
-            "Encryption failed: " + encryptResult.GetErrorMessage()
-        );
+        return Result<>(encryptResult.GetErrorCode(), encryptResult.GetErrorMessage());
     }
     
     const auto& encryptedData = encryptResult.GetValue();
@@ -88,39 +82,8 @@ Result<> StegoHandler::Extract(const std::string &stegoFile,
         );
     }
     
-    const auto& encryptedData = extractResult.GetValue();
-
-    // Decrypt data
-    auto decryptResult = CryptoModule::DecryptData(encryptedData, password);
-    if (!decryptResult) {
-        return Result<>(
-            decryptResult.GetErrorCode(),
-            "Decryption failed: " + decryptResult.GetErrorMessage()
-        );
-    }
-    
-    const auto& plainData = decryptResult.GetValue();
-
-    // Write output file
-    std::ofstream outFile(outputFile, std::ios::binary);
-    if (!outFile) {
-        return Result<>(
-            ErrorCode::FileWriteError,
-            "Failed to open output file '" + outputFile + "' for writing"
-        );
-    }
-    
-    outFile.write(reinterpret_cast<const char *>(plainData.data()), plainData.size());
-    
-    if (!outFile) {
-        return Result<>(
-            ErrorCode::FileWriteError,
-            "Failed to write data to '" + outputFile + "'"
-        );
-    }
-
-    outFile.close();
-    return Result<>();
+    // Decrypt data and write output file
+    return SaveDecryptedData(extractResult.GetValue(), outputFile, password);
 }
 
 Result<> StegoHandler::Visual(const std::string &coverFile,
@@ -128,68 +91,293 @@ Result<> StegoHandler::Visual(const std::string &coverFile,
                              const std::string &outputFile,
                              const std::string &password) {
     
+    auto memoryCheck = CheckMemoryLimit(coverFile, dataFile, sizeof(uint8_t));
+    if (!memoryCheck) {
+        return memoryCheck;
+    }
+
     // Load cover image
     auto imageResult = ImageIO::Load(coverFile);
     if (!imageResult) {
         return Result<>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
     }
+
+    // Only the dimensions are needed: embed into the cover's buffer, zero filled
+    auto imageData = std::move(imageResult.GetValue());
+    std::fill(imageData.pixels.begin(), imageData.pixels.end(), 0);
+
+    // Load and encrypt data
+    auto encryptResult = LoadEncryptedData(dataFile, password);
+    if (!encryptResult) {
+        return Result<>(encryptResult.GetErrorCode(), encryptResult.GetErrorMessage());
+    }
     
-    auto inputImage = imageResult.GetValue();
+    const auto& encryptedData = encryptResult.GetValue();
 
-    //create a duplicate image with 0 filled pixels
-    std::vector<uint8_t> imagePixels(inputImage.GetPixelCount());
-    std::fill(imagePixels.begin(), imagePixels.end(), 0);
-    auto imageData = ImageData(imagePixels, inputImage.width, inputImage.height, inputImage.channels);
+    // Embed data into image
+    auto embedResult = EmbedMethod(imageData, encryptedData, password);
+    if (!embedResult) {
+        return embedResult;
+    }
+
+    //change stego bits to visible color
+    auto visualResult = VisualizeMethod(imageData);
+    if (!visualResult) {
+        return visualResult;
+    }
+
+    // Save stego image
+    auto saveResult = ImageIO::Save(outputFile, imageData);
+    if (!saveResult) {
+        return saveResult;
+    }
+
+    return Result<>();
+}
 
+Result<std::vector<uint8_t>> StegoHandler::ReadDataFile(const std::string &dataFile) const {
+    
     // Load data file
     std::ifstream inFile(dataFile, std::ios::binary);
     if (!inFile) {
-        return Result<>(
+        return Result<std::vector<uint8_t>>(
             ErrorCode::FileNotFound,
             "Failed to open data file '" + dataFile + "'"
         );
     }
     
-    // Read text in file into a vector
-    std::vector<uint8_t> plainData((std::istreambuf_iterator<char>(inFile)),
-                                    std::istreambuf_iterator<char>());
+    // Read the file in one piece, without growing a buffer
+    StageTimer readTimer(Stats::Stage::DataRead);
+    inFile.seekg(0, std::ios::end);
+    std::streamoff fileSize = inFile.tellg();
+    inFile.seekg(0, std::ios::beg);
+    if (fileSize < 0) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::FileReadError,
+            "Failed to read data file '" + dataFile + "'"
+        );
+    }
+
+    std::vector<uint8_t> plainData(static_cast<std::size_t>(fileSize));
+    if (!inFile.read(reinterpret_cast<char *>(plainData.data()), fileSize)) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::FileReadError,
+            "Failed to read data file '" + dataFile + "'"
+        );
+    }
     inFile.close();
+    readTimer.AddBytes(plainData.size());
+    readTimer.Stop();
     
     if (plainData.empty()) {
-        return Result<>(
+        return Result<std::vector<uint8_t>>(
             ErrorCode::InvalidArgument,
             "Data file '" + dataFile + "' is empty. Nothing to embed."
         );
     }
+    return Result<std::vector<uint8_t>>(std::move(plainData));
+}
+
+Result<std::size_t> StegoHandler::GetEncryptedDataSize(const std::string &dataFile) const {
+
+    std::size_t plainBytes = 0;
+    if (compress_) {
+        // Compressed size depends on the contents
+        auto readResult = ReadDataFile(dataFile);
+        if (!readResult) {
+            return Result<std::size_t>(readResult.GetErrorCode(), readResult.GetErrorMessage());
+        }
+        plainBytes = Compression::Compress(readResult.GetValue()).size() - Compression::HEADER_SIZE;
+    } else {
+        std::error_code error;
+        std::uintmax_t fileSize = std::filesystem::file_size(dataFile, error);
+        if (error) {
+            return Result<std::size_t>(ErrorCode::FileNotFound, "Failed to open data file '" + dataFile + "'");
+        }
+        if (fileSize == 0) {
+            return Result<std::size_t>(
+                ErrorCode::InvalidArgument,
+                "Data file '" + dataFile + "' is empty. Nothing to embed."
+            );
+        }
+        plainBytes = static_cast<std::size_t>(fileSize);
+    }
+    return Result<std::size_t>(GetEncodedPayloadSize(plainBytes) - PayloadHeader::SIZE_BYTES);
+}
+
+Result<std::vector<uint8_t>> StegoHandler::LoadEncryptedData(const std::string &dataFile,
+                                                             const std::string &password) const {
+    
+    auto readResult = ReadDataFile(dataFile);
+    if (!readResult) {
+        return readResult;
+    }
+    std::vector<uint8_t> plainData = std::move(readResult.GetValue());
+
+    // Compress before encrypting, ciphertext does not compress
+    if (compress_) {
+        plainData = Compression::Compress(plainData);
+    }
 
     // Encrypt data
     auto encryptResult = CryptoModule::EncryptData(plainData, password);
     if (!encryptResult) {
-        return Result<>(
+        return Result<std::vector<uint8_t>>(
             encryptResult.GetErrorCode(),
             "Encryption failed: " + encryptResult.GetErrorMessage()
         );
     }
+
+    if (keyCheck_) {
+        encryptResult = CryptoModule::AddKeyCheck(encryptResult.GetValue(), password);
+        if (!encryptResult) {
+            return Result<std::vector<uint8_t>>(
+                encryptResult.GetErrorCode(),
+                "Encryption failed: " + encryptResult.GetErrorMessage()
+            );
+        }
+    }
+
+    if (eccParity_ > 0) {
+        encryptResult = ReedSolomon::Encode(encryptResult.GetValue(), eccParity_);
+        if (!encryptResult) {
+            return Result<std::vector<uint8_t>>(
+                encryptResult.GetErrorCode(),
+                "Error correction failed: " + encryptResult.GetErrorMessage()
+            );
+        }
+        // The header is outside the codewords: repeat it so a reader can outvote damage
+        encryptResult = PayloadHeader::AddCopies(GetPayloadMethod(), encryptResult.GetValue(), GetPayloadFlags());
+    }
+
+    return encryptResult;
+}
+
+Result<std::vector<uint8_t>> StegoHandler::DecryptPayload(const std::vector<uint8_t> &extractedData,
+                                                          const std::string &password) const {
+
+    // Repair damaged bytes before anything checks them
+    std::vector<uint8_t> repairedData;
+    const std::vector<uint8_t> *payload = &extractedData;
+    if (extractedFlags_ & PayloadHeader::FLAG_ERROR_CORRECTION) {
+        // Header copies first, Parse already used them
+        if (extractedData.size() < PayloadHeader::COPIES_SIZE_BYTES) {
+            return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, "Payload is too short for its header copies");
+        }
+        std::vector<uint8_t> codewords(extractedData.begin() + PayloadHeader::COPIES_SIZE_BYTES, extractedData.end());
+        auto decodeResult = ReedSolomon::Decode(codewords, MAX_REASONABLE_SIZE);
+        if (!decodeResult) {
+            return decodeResult;
+        }
+        repairedData = decodeResult.GetValue();
+        payload = &repairedData;
+    }
+
+    // The key check costs one HKDF call, the HMAC check below a full PBKDF2 run
+    auto decryptResult = [&]() {
+        if (extractedFlags_ & PayloadHeader::FLAG_KEY_CHECK) {
+            auto checkResult = CryptoModule::VerifyKeyCheck(*payload, password);
+            if (!checkResult) {
+                return checkResult;
+            }
+            return CryptoModule::DecryptData(checkResult.GetValue(), password);
+        }
+        return CryptoModule::DecryptData(*payload, password);
+    }();
+
+    if (!decryptResult || !(extractedFlags_ & PayloadHeader::FLAG_COMPRESSED)) {
+        return decryptResult;
+    }
+    return Compression::Decompress(decryptResult.GetValue(), MAX_REASONABLE_SIZE);
+}
+
+Result<> StegoHandler::SaveDecryptedData(const std::vector<uint8_t> &encryptedData,
+                                         const std::string &outputFile,
+                                         const std::string &password) const {
+
+    // Decrypt data
+    auto decryptResult = DecryptPayload(encryptedData, password);
+    if (!decryptResult) {
+        return Result<>(
+            decryptResult.GetErrorCode(),
+            "Decryption failed: " + decryptResult.GetErrorMessage()
+        );
+    }
     
-    const auto& encryptedData = encryptResult.GetValue();
+    const auto& plainData = decryptResult.GetValue();
 
-    // Embed data into image
-    auto embedResult = EmbedMethod(imageData, encryptedData, password);
-    if (!embedResult) {
-        return embedResult;
+    // Write output file
+    StageTimer writeTimer(Stats::Stage::DataWrite, plainData.size());
+    std::ofstream outFile(outputFile, std::ios::binary);
+    if (!outFile) {
+        return Result<>(
+            ErrorCode::FileWriteError,
+            "Failed to open output file '" + outputFile + "' for writing"
+        );
+    }
+    
+    outFile.write(reinterpret_cast<const char *>(plainData.data()), plainData.size());
+    
+    if (!outFile) {
+        return Result<>(
+            ErrorCode::FileWriteError,
+            "Failed to write data to '" + outputFile + "'"
+        );
     }
 
-    //change stego bits to visible color
-    auto visualResult = VisualizeMethod(imageData);
-    if (!visualResult) {
-        return visualResult;
+    outFile.close();
+    return Result<>();
+}
+
+std::size_t StegoHandler::GetEncodedPayloadSize(std::size_t dataBytes) const {
+    std::size_t size = dataBytes + (compress_ ? Compression::HEADER_SIZE : 0);
+    size = (size / CryptoModule::IV_SIZE + 1) * CryptoModule::IV_SIZE + CryptoModule::ENCRYPTION_OVERHEAD;
+    size += keyCheck_ ? CryptoModule::KEY_CHECK_SIZE : 0;
+    if (eccParity_ > 0) {
+        size = ReedSolomon::GetEncodedSize(size, eccParity_) + PayloadHeader::COPIES_SIZE_BYTES;
     }
+    return size + PayloadHeader::SIZE_BYTES;
+}
 
-    // Save stego image
-    auto saveResult = ImageIO::Save(outputFile, imageData);
-    if (!saveResult) {
-        return saveResult;
+std::size_t StegoHandler::EstimateEmbedMemory(const ImageData &header, std::size_t sampleBytes,
+                                              std::size_t dataBytes) const {
+    return IMAGE_COPIES * header.GetPixelCount() * sampleBytes + PAYLOAD_COPIES * GetEncodedPayloadSize(dataBytes);
+}
+
+Result<> StegoHandler::SetErrorCorrection(int parity) {
+    if (parity != 0 && !ReedSolomon::IsValidParity(parity)) {
+        std::ostringstream oss;
+        oss << "Invalid error correction parity " << parity << " (supported: 0 to disable, or even values from "
+            << ReedSolomon::MIN_PARITY << " to " << ReedSolomon::MAX_PARITY << ")";
+        return Result<>(ErrorCode::InvalidArgument, oss.str());
+    }
+    eccParity_ = parity;
+    return Result<>();
+}
+
+Result<> StegoHandler::CheckMemoryLimit(const std::string &coverFile, const std::string &dataFile,
+                                        std::size_t sampleBytes) {
+    estimatedMemory_ = 0;
+    if (memoryLimit_ == 0) {
+        return Result<>();
     }
 
+    auto headerResult = ImageIO::Probe(coverFile);
+    if (!headerResult) {
+        return Result<>(headerResult.GetErrorCode(), headerResult.GetErrorMessage());
+    }
+    std::error_code error;
+    std::uintmax_t dataBytes = std::filesystem::file_size(dataFile, error);
+    if (error) {
+        return Result<>(ErrorCode::FileNotFound, "Failed to open data file '" + dataFile + "'");
+    }
+
+    estimatedMemory_ = EstimateEmbedMemory(headerResult.GetValue(), sampleBytes, static_cast<std::size_t>(dataBytes));
+    if (estimatedMemory_ > memoryLimit_) {
+        std::ostringstream oss;
+        oss << "Embedding needs about " << (estimatedMemory_ + 1023) / 1024 << " KB, above the limit of "
+            << memoryLimit_ / 1024 << " KB";
+        return Result<>(ErrorCode::MemoryLimitExceeded, oss.str());
+    }
     return Result<>();
 }
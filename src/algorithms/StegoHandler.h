@@ -3,8 +3,14 @@
 
 #include <string>
 #include <cstdint>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <memory_resource>
 #include "../utils/ErrorHandler.h"
 #include "../utils/ImageIO.h"
+#include "../utils/MemoryArena.h"
+#include "PayloadHeader.h"
 
 /**
  * @brief Abstract base class for all steganography handlers.
@@ -20,7 +26,7 @@ public:
     /**
      * @brief Embeds data into pixel array using technique from subclass.
      * 
-     * Format: [32-bit size header | data bits]
+     * Format: [payload header | data bits], see PayloadHeader
      * 
      * @param imageData Image data to modify (in-place)
      * @param dataToEmbed Data to embed (already encrypted)
@@ -59,10 +65,10 @@ public:
     * @param password Password used for AES encryption
     * @return Result indicating success or detailed error
     */
-    Result<> Embed(const std::string &coverFile,
-                   const std::string &dataFile,
-                   const std::string &outputFile,
-                   const std::string &password);
+    virtual Result<> Embed(const std::string &coverFile,
+                           const std::string &dataFile,
+                           const std::string &outputFile,
+                           const std::string &password);
 
     /**
     * @brief Visualizes the embedding of a file into a cover image using steganography.
@@ -73,10 +79,10 @@ public:
     * @param password Password used for AES encryption
     * @return Result indicating success or detailed error
     */
-    Result<> Visual(const std::string &coverFile,
-                   const std::string &dataFile,
-                   const std::string &outputFile,
-                   const std::string &password);
+    virtual Result<> Visual(const std::string &coverFile,
+                            const std::string &dataFile,
+                            const std::string &outputFile,
+                            const std::string &password);
 
     /**
     * @brief Extracts a hidden file from a stego image using steganography.
@@ -86,12 +92,266 @@ public:
     * @param password Password used for AES decryption
     * @return Result indicating success or detailed error
     */
-    Result<> Extract(const std::string &stegoFile,
-                     const std::string &outputFile,
-                     const std::string &password);
+    virtual Result<> Extract(const std::string &stegoFile,
+                             const std::string &outputFile,
+                             const std::string &password);
+
+    /**
+    * @brief Method identifier written into the payload header.
+    */
+    virtual PayloadMethod GetPayloadMethod() const = 0;
+
+    /**
+    * @brief Store a fast password check with the payload on Embed.
+    *
+    * Lets Extract reject wrong passwords without running PBKDF2,
+    * see CryptoModule::AddKeyCheck. Costs 2 bytes of capacity.
+    *
+    * @param enabled True to add the check
+    */
+    void SetKeyCheck(bool enabled) { keyCheck_ = enabled; }
+    bool GetKeyCheck() const { return keyCheck_; }
+
+    /**
+    * @brief Compress the data file before encrypting it on Embed.
+    *
+    * Compressible data then needs fewer carrier bits, see Compression.
+    * Costs 5 bytes of capacity when the data does not compress.
+    *
+    * @param enabled True to compress
+    */
+    void SetCompression(bool enabled) { compress_ = enabled; }
+    bool GetCompression() const { return compress_; }
+
+    /**
+    * @brief Protect the embedded data with Reed-Solomon error correction on Embed.
+    *
+    * Each 255-byte codeword then survives up to parity / 2 damaged bytes,
+    * e.g. LSBs flipped by a resave. See ReedSolomon.
+    *
+    * @param parity Parity bytes per codeword (even, 2 to 128), 0 to disable
+    * @return Result indicating success, or InvalidArgument for any other parity
+    */
+    Result<> SetErrorCorrection(int parity);
+    int GetErrorCorrection() const { return eccParity_; }
+
+    /**
+    * @brief Cap the estimated memory of Embed and Visual.
+    *
+    * Embed and Visual fail with MemoryLimitExceeded before decoding the cover
+    * when the estimate exceeds the limit. Handlers with a leaner variant fall
+    * back to it first (lsbshuffle writes directly instead of partitioning its
+    * writes). See EstimateEmbedMemory.
+    *
+    * @param bytes Memory limit in bytes, 0 for none (the default)
+    */
+    void SetMemoryLimit(std::size_t bytes) { memoryLimit_ = bytes; }
+    std::size_t GetMemoryLimit() const { return memoryLimit_; }
+
+    /**
+    * @brief Estimated peak memory of an embed, with the leanest algorithms.
+    *
+    * Covers the decoded image and its decode buffer, and the payload on its
+    * way through compression, encryption and error correction. Handlers add
+    * the working memory of their method.
+    *
+    * @param header Image dimensions, pixels are not needed
+    * @param sampleBytes Bytes per sample (2 for 16-bit images)
+    * @param dataBytes Size of the data file
+    * @return Estimated bytes
+    */
+    virtual std::size_t EstimateEmbedMemory(const ImageData &header, std::size_t sampleBytes,
+                                            std::size_t dataBytes) const;
+
+    /**
+    * @brief Decrypt data returned by ExtractMethod.
+    *
+    * Repairs the data first when the payload header says it carries error
+    * correction, runs the fast key check when it carried one, and
+    * decompresses when the plaintext was compressed.
+    *
+    * @param extractedData Data returned by the last ExtractMethod call
+    * @param password Password used for AES decryption
+    * @return Result containing the plaintext or detailed error
+    */
+    Result<std::vector<uint8_t>> DecryptPayload(const std::vector<uint8_t> &extractedData,
+                                                const std::string &password) const;
+
+    /**
+    * @brief Let another thread abort a running extraction.
+    *
+    * Handlers check the flag between phases and then fail with
+    * OperationCancelled. Pass nullptr to detach.
+    *
+    * @param cancelFlag Flag set to true to cancel, must outlive the extraction
+    */
+    void SetCancelFlag(const std::atomic<bool> *cancelFlag) { cancelFlag_ = cancelFlag; }
 
     virtual ~StegoHandler() = default;
 
+protected:
+
+    /**
+    * @brief Whether the cancel flag has been raised.
+    */
+    bool IsCancelled() const {
+        return cancelFlag_ != nullptr && cancelFlag_->load(std::memory_order_relaxed);
+    }
+
+    /**
+    * @brief Provides a MemoryArena to the handler while the scope lives.
+    *
+    * Handlers open one around their embed phase, so its buffers are released
+    * together before the image is encoded. The arena never reuses memory:
+    * buffers freed early within the phase belong on the heap.
+    */
+    class OperationScope {
+    public:
+        explicit OperationScope(StegoHandler &handler) : handler_(handler), previous_(handler.arena_) {
+            handler_.arena_ = &arena_;
+        }
+        ~OperationScope() { handler_.arena_ = previous_; }
+
+        OperationScope(const OperationScope &) = delete;
+        OperationScope &operator=(const OperationScope &) = delete;
+
+    private:
+        StegoHandler &handler_;
+        MemoryArena *previous_;
+        MemoryArena arena_;
+    };
+
+    /**
+    * @brief Arena of the running operation, the default resource outside of one.
+    *
+    * For buffers that the calling thread allocates and drops within the
+    * operation; parallel workers must not allocate from it.
+    */
+    std::pmr::memory_resource *GetArena() const {
+        return arena_ != nullptr ? static_cast<std::pmr::memory_resource *>(arena_) : std::pmr::get_default_resource();
+    }
+
+    /**
+    * @brief Fail with MemoryLimitExceeded when an embed of this cover and data file would not fit the limit.
+    *
+    * Reads only the image header and the file size. Remembers the estimate for FitsMemoryLimit.
+    *
+    * @param coverFile Path to the cover image
+    * @param dataFile Path to the file to embed
+    * @param sampleBytes Bytes per sample of the cover as it will be loaded
+    * @return Result indicating success, MemoryLimitExceeded or the error reading the files
+    */
+    Result<> CheckMemoryLimit(const std::string &coverFile, const std::string &dataFile, std::size_t sampleBytes);
+
+    /**
+    * @brief Whether extraBytes of optional working memory fit next to the checked estimate.
+    */
+    bool FitsMemoryLimit(std::size_t extraBytes) const {
+        return memoryLimit_ == 0 || estimatedMemory_ + extraBytes <= memoryLimit_;
+    }
+
+    /**
+    * @brief Size of the encrypted payload for a data file of dataBytes, at most.
+    */
+    std::size_t GetEncodedPayloadSize(std::size_t dataBytes) const;
+
+    /**
+    * @brief Size of LoadEncryptedData's output for a data file, without encrypting it.
+    *
+    * Only the file size is read, unless compression is enabled: the contents
+    * are compressed then, as the compressed size depends on them.
+    *
+    * @param dataFile Path to the file to embed
+    * @return Result containing the size in bytes (payload header excluded) or the file error
+    */
+    Result<std::size_t> GetEncryptedDataSize(const std::string &dataFile) const;
+
+    /**
+    * @brief Read a data file and encrypt its contents for embedding.
+    *
+    * Compresses first, prefixes the key check and adds error correction when enabled.
+    *
+    * @param dataFile Path to the file to embed
+    * @param password Password used for AES encryption
+    * @return Result containing encrypted data or detailed error
+    */
+    Result<std::vector<uint8_t>> LoadEncryptedData(const std::string &dataFile,
+                                                   const std::string &password) const;
+
+    /**
+    * @brief Decrypt extracted data and write it to the output file.
+    *
+    * @param encryptedData Data extracted from the stego medium
+    * @param outputFile Path to save the recovered file
+    * @param password Password used for AES decryption
+    * @return Result indicating success or detailed error
+    */
+    Result<> SaveDecryptedData(const std::vector<uint8_t> &encryptedData,
+                               const std::string &outputFile,
+                               const std::string &password) const;
+
+    /**
+    * @brief Payload header for this method and the configured flags.
+    */
+    std::array<uint8_t, PayloadHeader::SIZE_BYTES> EncodePayloadHeader(uint32_t dataSize) const {
+        return PayloadHeader::Encode(GetPayloadMethod(), dataSize, GetPayloadFlags());
+    }
+
+    /**
+    * @brief Payload header followed by the data, see PayloadHeader::Build.
+    */
+    std::vector<uint8_t> BuildPayload(const std::vector<uint8_t> &data) const {
+        return PayloadHeader::Build(GetPayloadMethod(), data, GetPayloadFlags());
+    }
+
+    /**
+    * @brief PayloadHeader::Parse for this method; remembers the flags for DecryptPayload.
+    */
+    Result<PayloadHeader> ParsePayloadHeader(const uint8_t *bytes, std::size_t size) {
+        return RecordPayloadHeader(PayloadHeader::Parse(bytes, size, GetPayloadMethod(), AcceptsLegacyHeader()));
+    }
+
+    /**
+    * @brief PayloadHeader::Read for this method; remembers the flags for DecryptPayload.
+    */
+    template <typename ReadBit>
+    Result<PayloadHeader> ReadPayloadHeader(std::size_t availableBits, ReadBit readBit) {
+        return RecordPayloadHeader(PayloadHeader::Read(availableBits, GetPayloadMethod(), readBit,
+                                                       AcceptsLegacyHeader()));
+    }
+
+    /**
+    * @brief Whether payloads of this method may predate the header (see PayloadHeader).
+    *
+    * Only methods that existed before the header was introduced override this.
+    */
+    virtual bool AcceptsLegacyHeader() const { return false; }
+
+private:
+    /**
+    * @brief Read a whole data file; empty files are an error, as there is nothing to embed.
+    */
+    Result<std::vector<uint8_t>> ReadDataFile(const std::string &dataFile) const;
+
+    uint8_t GetPayloadFlags() const {
+        return (keyCheck_ ? PayloadHeader::FLAG_KEY_CHECK : 0) |
+               (compress_ ? PayloadHeader::FLAG_COMPRESSED : 0) |
+               (eccParity_ > 0 ? PayloadHeader::FLAG_ERROR_CORRECTION : 0);
+    }
+
+    Result<PayloadHeader> RecordPayloadHeader(Result<PayloadHeader> header) {
+        extractedFlags_ = header ? header.GetValue().flags : 0;
+        return header;
+    }
+
+    const std::atomic<bool> *cancelFlag_ = nullptr;
+    bool keyCheck_ = false;
+    bool compress_ = false;
+    int eccParity_ = 0;
+    uint8_t extractedFlags_ = 0;
+    std::size_t memoryLimit_ = 0;
+    std::size_t estimatedMemory_ = 0;
+    MemoryArena *arena_ = nullptr;
 };
 
 
@@ -0,0 +1,352 @@
+#include "DCTStegoHandler.h"
+#include "../../utils/ImageIO.h"
+#include "../../utils/Stats.h"
+
+#include <array>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+/**
+ * Only AC coefficients with |v| >= 2 carry data: their magnitude LSB can change
+ * without changing the Huffman category or turning them into 0 / +-1.
+ */
+inline bool IsUsable(int16_t value) {
+    return value >= 2 || value <= -2;
+}
+
+inline uint32_t GetMagnitudeLSB(int16_t value) {
+    return static_cast<uint32_t>(value < 0 ? -value : value) & 1;
+}
+
+inline int16_t SetMagnitudeLSB(int16_t value, uint32_t bit) {
+    int magnitude = value < 0 ? -value : value;
+    magnitude = (magnitude & ~1) | static_cast<int>(bit);
+    return static_cast<int16_t>(value < 0 ? -magnitude : magnitude);
+}
+
+/**
+ * Visit usable coefficients in embedding order until fn returns false.
+ */
+template <typename Data, typename Fn>
+void ForEachUsableCoefficient(Data &data, Fn &&fn) {
+    for (auto &component : data.components) {
+        auto *coefficients = component.coefficients.data();
+        std::size_t count = component.coefficients.size();
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            if (idx % JpegComponent::BLOCK_SIZE == 0 || !IsUsable(coefficients[idx])) {
+                continue; // DC or unusable AC
+            }
+            if (!fn(coefficients[idx])) {
+                return;
+            }
+        }
+    }
+}
+
+bool HasJpegExtension(const std::string &filename) {
+    std::size_t dotPos = filename.find_last_of(".");
+    if (dotPos == std::string::npos) {
+        return false;
+    }
+    std::string ext = filename.substr(dotPos + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext == "jpg" || ext == "jpeg";
+}
+
+Result<JpegCoefficientData> LoadJpegCover(const std::string &filename) {
+    if (!JpegCodec::IsJpegFile(filename)) {
+        return Result<JpegCoefficientData>(
+            ErrorCode::UnsupportedImageFormat,
+            "DCT method requires a JPEG image, '" + filename + "' is not a JPEG file"
+        );
+    }
+    return JpegCodec::Load(filename);
+}
+
+/**
+ * Bytes the usable coefficients hold after a header of 'headerBits'.
+ */
+std::size_t CapacityAfterHeader(const JpegCoefficientData &data, std::size_t headerBits) {
+    std::size_t usable = 0;
+    ForEachUsableCoefficient(data, [&usable](const int16_t &) {
+        ++usable;
+        return true;
+    });
+    if (usable <= headerBits) {
+        return 0;
+    }
+    return (usable - headerBits) / 8;
+}
+
+} // namespace
+
+std::size_t DCTStegoHandler::CalculateCapacity(const JpegCoefficientData &data) {
+    return CapacityAfterHeader(data, HEADER_SIZE_BITS);
+}
+
+Result<> DCTStegoHandler::EmbedCoefficients(JpegCoefficientData &data, const std::vector<uint8_t> &dataToEmbed) {
+
+    StageTimer timer(Stats::Stage::Embed, dataToEmbed.size());
+    Stats::Add(Stats::Counter::SamplesTouched, data.GetCoefficientCount());
+
+    if (dataToEmbed.empty()) {
+        return Result<>(ErrorCode::InvalidArgument, "Cannot embed empty data");
+    }
+
+    if (dataToEmbed.size() > MAX_REASONABLE_SIZE) {
+        std::ostringstream oss;
+        oss << "Data size (" << dataToEmbed.size() << " bytes) exceeds maximum allowed size ("
+            << MAX_REASONABLE_SIZE << " bytes)";
+        return Result<>(ErrorCode::DataTooLarge, oss.str());
+    }
+
+    // Validate capacity
+    std::size_t availableCapacity = CalculateCapacity(data);
+    if (dataToEmbed.size() > availableCapacity) {
+        std::ostringstream oss;
+        oss << "Data size (" << dataToEmbed.size() << " bytes) exceeds JPEG capacity (" << availableCapacity
+            << " bytes).\n"
+            << "    Only AC coefficients with magnitude >= 2 can carry data.";
+        return Result<>(ErrorCode::InsufficientCapacity, oss.str());
+    }
+
+    std::vector<uint8_t> stream = BuildPayload(dataToEmbed);
+    std::size_t totalBits = stream.size() * 8;
+    std::size_t bitIdx = 0;
+
+    ForEachUsableCoefficient(data, [&](int16_t &coefficient) {
+        uint32_t bit = (stream[bitIdx >> 3] >> (bitIdx & 7)) & 1;
+        coefficient = SetMagnitudeLSB(coefficient, bit);
+        return ++bitIdx < totalBits;
+    });
+
+    return Result<>();
+}
+
+Result<std::vector<uint8_t>> DCTStegoHandler::ExtractCoefficients(const JpegCoefficientData &data) {
+
+    StageTimer timer(Stats::Stage::Extract);
+    Stats::Add(Stats::Counter::SamplesTouched, data.GetCoefficientCount());
+
+    // Stream holds the payload header, and the copies of an error corrected one, until it is known
+    std::vector<uint8_t> stream(PayloadHeader::PROTECTED_SIZE_BYTES, 0);
+    const std::size_t headerBits = PayloadHeader::SIZE_BITS;
+    Result<PayloadHeader> headerResult(ErrorCode::ImageTooSmall, "JPEG too small to contain embedded data");
+    bool headerRead = false;
+
+    std::size_t availableCapacity = 0;
+    uint32_t dataSize = 0;
+    std::size_t totalBits = PayloadHeader::PROTECTED_SIZE_BITS;
+    std::size_t bitIdx = 0;
+
+    ForEachUsableCoefficient(data, [&](const int16_t &coefficient) {
+        uint32_t bit = GetMagnitudeLSB(coefficient);
+        stream[bitIdx >> 3] |= static_cast<uint8_t>(bit << (bitIdx & 7));
+        ++bitIdx;
+        if (headerRead || (bitIdx != headerBits && bitIdx != PayloadHeader::PROTECTED_SIZE_BITS)) {
+            return bitIdx < totalBits;
+        }
+
+        // Header complete: stop early on a bad header or an implausible size.
+        // A damaged first copy gets another try once all copies are in.
+        headerResult = ParsePayloadHeader(stream.data(), bitIdx / 8);
+        if (!headerResult && headerResult.GetErrorCode() == ErrorCode::CorruptedPayload && bitIdx == headerBits) {
+            return true;
+        }
+        headerRead = true;
+        if (!headerResult) {
+            return false;
+        }
+        dataSize = headerResult.GetValue().dataSize;
+        availableCapacity = CapacityAfterHeader(data, headerBits);
+        if (dataSize == 0 || dataSize > availableCapacity) {
+            return false;
+        }
+        stream.resize(PayloadHeader::SIZE_BYTES + static_cast<std::size_t>(dataSize));
+        totalBits = stream.size() * 8;
+        return bitIdx < totalBits;
+    });
+
+    // Validate header
+    if (!headerRead && bitIdx < headerBits) {
+        std::ostringstream oss;
+        oss << "JPEG too small to contain embedded data. "
+            << "Has " << bitIdx << " usable coefficients, needs at least " << headerBits;
+        return Result<std::vector<uint8_t>>(ErrorCode::ImageTooSmall, oss.str());
+    }
+
+    if (!headerRead || !headerResult) {
+        return Result<std::vector<uint8_t>>(headerResult.GetErrorCode(), headerResult.GetErrorMessage());
+    }
+
+    if (dataSize == 0) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::NoEmbeddedData,
+            "Extracted size is 0. Image may not contain embedded data."
+        );
+    }
+
+    if (dataSize > MAX_REASONABLE_SIZE) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) is unreasonably large (max "
+            << MAX_REASONABLE_SIZE << " bytes). Data is likely corrupted or password is wrong.";
+        return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, oss.str());
+    }
+
+    if (dataSize > availableCapacity) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) exceeds JPEG capacity (" << availableCapacity << " bytes). "
+            << "Data is corrupted or image does not contain DCT embedded data.";
+        return Result<std::vector<uint8_t>>(ErrorCode::InvalidDataSize, oss.str());
+    }
+
+    return Result<std::vector<uint8_t>>(std::vector<uint8_t>(stream.begin() + PayloadHeader::SIZE_BYTES, stream.end()));
+}
+
+Result<> DCTStegoHandler::Embed(const std::string &coverFile,
+                                const std::string &dataFile,
+                                const std::string &outputFile,
+                                const std::string &password) {
+
+    if (!HasJpegExtension(outputFile)) {
+        return Result<>(
+            ErrorCode::UnsupportedImageFormat,
+            "DCT method writes JPEG files, output '" + outputFile + "' must have a .jpg/.jpeg extension"
+        );
+    }
+
+    // Load cover coefficients
+    auto coverResult = LoadJpegCover(coverFile);
+    if (!coverResult) {
+        return Result<>(coverResult.GetErrorCode(), coverResult.GetErrorMessage());
+    }
+
+    auto coefficientData = coverResult.GetValue();
+
+    // Load and encrypt data
+    auto encryptResult = LoadEncryptedData(dataFile, password);
+    if (!encryptResult) {
+        return Result<>(encryptResult.GetErrorCode(), encryptResult.GetErrorMessage());
+    }
+
+    // Embed data into coefficients
+    auto embedResult = EmbedCoefficients(coefficientData, encryptResult.GetValue());
+    if (!embedResult) {
+        return embedResult;
+    }
+
+    // Save stego JPEG
+    return JpegCodec::Save(outputFile, coefficientData);
+}
+
+Result<> DCTStegoHandler::Extract(const std::string &stegoFile,
+                                  const std::string &outputFile,
+                                  const std::string &password) {
+
+    // Load stego coefficients
+    auto stegoResult = LoadJpegCover(stegoFile);
+    if (!stegoResult) {
+        return Result<>(stegoResult.GetErrorCode(), stegoResult.GetErrorMessage());
+    }
+
+    // Extract encrypted data
+    auto extractResult = ExtractCoefficients(stegoResult.GetValue());
+    if (!extractResult) {
+        return Result<>(
+            extractResult.GetErrorCode(),
+            "Extraction failed: " + extractResult.GetErrorMessage()
+        );
+    }
+
+    // Decrypt data and write output file
+    return SaveDecryptedData(extractResult.GetValue(), outputFile, password);
+}
+
+Result<> DCTStegoHandler::Visual(const std::string &coverFile,
+                                 const std::string &dataFile,
+                                 const std::string &outputFile,
+                                 const std::string &password) {
+
+    // Load cover coefficients and pixels (for the output layout)
+    auto coverResult = LoadJpegCover(coverFile);
+    if (!coverResult) {
+        return Result<>(coverResult.GetErrorCode(), coverResult.GetErrorMessage());
+    }
+    auto imageResult = ImageIO::Load(coverFile);
+    if (!imageResult) {
+        return Result<>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
+    }
+
+    const auto &original = coverResult.GetValue();
+    auto coefficientData = original;
+    const auto &inputImage = imageResult.GetValue();
+
+    // Load and encrypt data
+    auto encryptResult = LoadEncryptedData(dataFile, password);
+    if (!encryptResult) {
+        return Result<>(encryptResult.GetErrorCode(), encryptResult.GetErrorMessage());
+    }
+
+    auto embedResult = EmbedCoefficients(coefficientData, encryptResult.GetValue());
+    if (!embedResult) {
+        return embedResult;
+    }
+
+    // Paint the pixel area of every changed block
+    ImageData imageData(std::vector<uint8_t>(inputImage.GetPixelCount(), 0),
+                        inputImage.width, inputImage.height, inputImage.channels);
+
+    for (std::size_t compIdx = 0; compIdx < coefficientData.components.size(); ++compIdx) {
+        const auto &before = original.components[compIdx];
+        const auto &after = coefficientData.components[compIdx];
+        int blockWidth = 8 * coefficientData.maxHSampling / after.hSampling;
+        int blockHeight = 8 * coefficientData.maxVSampling / after.vSampling;
+
+        for (int blockY = 0; blockY < after.blocksHigh; ++blockY) {
+            for (int blockX = 0; blockX < after.blocksWide; ++blockX) {
+                if (std::equal(after.Block(blockX, blockY), after.Block(blockX, blockY) + JpegComponent::BLOCK_SIZE,
+                               before.Block(blockX, blockY))) {
+                    continue;
+                }
+                int yEnd = std::min(imageData.height, (blockY + 1) * blockHeight);
+                int xEnd = std::min(imageData.width, (blockX + 1) * blockWidth);
+                for (int y = blockY * blockHeight; y < yEnd; ++y) {
+                    for (int x = blockX * blockWidth; x < xEnd; ++x) {
+                        std::size_t pixel = (static_cast<std::size_t>(y) * imageData.width + x) * imageData.channels;
+                        std::fill_n(imageData.pixels.begin() + static_cast<std::ptrdiff_t>(pixel), imageData.channels, static_cast<uint8_t>(255));
+                    }
+                }
+            }
+        }
+    }
+
+    // Save visualization image
+    return ImageIO::Save(outputFile, imageData);
+}
+
+Result<> DCTStegoHandler::EmbedMethod(ImageData &imageData,
+                                      const std::vector<uint8_t> &dataToEmbed,
+                                      const std::string &password) {
+    (void) imageData;
+    (void) dataToEmbed;
+    (void) password;
+    return Result<>(ErrorCode::NotImplemented, "DCT method embeds into JPEG files, not decoded pixels");
+}
+
+Result<std::vector<uint8_t>> DCTStegoHandler::ExtractMethod(const ImageData &imageData,
+                                                            const std::string &password) {
+    (void) imageData;
+    (void) password;
+    return Result<std::vector<uint8_t>>(ErrorCode::NotImplemented, "DCT method extracts from JPEG files, not decoded pixels");
+}
+
+Result<> DCTStegoHandler::VisualizeMethod(ImageData &imageData) {
+    (void) imageData;
+    return Result<>(ErrorCode::NotImplemented, "DCT method visualizes JPEG files, not decoded pixels");
+}
@@ -0,0 +1,94 @@
+#ifndef __DCT_STEGO_HANDLER_H_
+#define __DCT_STEGO_HANDLER_H_
+
+#include "../StegoHandler.h"
+#include "../../utils/JpegCodec.h"
+
+#include <vector>
+#include <string>
+
+/**
+ * @brief JSteg-style steganography in the quantized DCT domain of baseline JPEGs.
+ *
+ * Payload bits replace the magnitude LSB of AC coefficients with |v| >= 2.
+ * Such a change never alters the coefficient's Huffman category, so the file is
+ * written back with its own tables and scan layout, without IDCT/DCT round trips
+ * or requantization. Coefficients 0 and +-1 are skipped, which keeps the set of
+ * usable coefficients identical before and after embedding.
+ *
+ * Format: [payload header | data bits], in component, block raster and
+ * zigzag order. Works on JPEG files only; the pixel-level methods are not available.
+ */
+class DCTStegoHandler : public StegoHandler {
+public:
+    /**
+    * Size of the header for steganography decoding
+    **/
+    static constexpr uint32_t HEADER_SIZE_BITS = static_cast<uint32_t>(PayloadHeader::SIZE_BITS);
+
+    /**
+     * @brief Calculate DCT capacity in bytes of a decoded JPEG.
+     *
+     * @param data Quantized coefficients of the cover
+     * @return Maximum bytes that can be embedded
+     */
+    static std::size_t CalculateCapacity(const JpegCoefficientData &data);
+
+    /**
+     * @brief Embeds data into quantized DCT coefficients.
+     *
+     * @param data Coefficient data to modify (in-place)
+     * @param dataToEmbed Data to embed (already encrypted)
+     * @return Result indicating success or embedding error
+     */
+    Result<> EmbedCoefficients(JpegCoefficientData &data, const std::vector<uint8_t> &dataToEmbed);
+
+    /**
+     * @brief Extracts data from quantized DCT coefficients.
+     *
+     * @param data Coefficient data to read from
+     * @return Result containing extracted data (encrypted) or error
+     */
+    Result<std::vector<uint8_t>> ExtractCoefficients(const JpegCoefficientData &data);
+
+    Result<> Embed(const std::string &coverFile,
+                   const std::string &dataFile,
+                   const std::string &outputFile,
+                   const std::string &password) override;
+
+    Result<> Extract(const std::string &stegoFile,
+                     const std::string &outputFile,
+                     const std::string &password) override;
+
+    /**
+     * @brief Marks every 8x8 block area whose coefficients were changed by embedding.
+     */
+    Result<> Visual(const std::string &coverFile,
+                    const std::string &dataFile,
+                    const std::string &outputFile,
+                    const std::string &password) override;
+
+    /**
+     * @brief Not available: DCT embedding needs the JPEG file, not decoded pixels.
+     */
+    Result<> EmbedMethod(ImageData &imageData,
+                         const std::vector<uint8_t> &dataToEmbed,
+                         const std::string &password ) override;
+
+    /**
+     * @brief Not available: DCT extraction needs the JPEG file, not decoded pixels.
+     */
+    Result<std::vector<uint8_t>> ExtractMethod(const ImageData &imageData,
+                                               const std::string &password ) override;
+
+    /**
+     * @brief Not available: see Visual.
+     */
+    Result<> VisualizeMethod(ImageData &imageData) override;
+
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::DCT; }
+
+    ~DCTStegoHandler() override = default;
+};
+
+#endif // __DCT_STEGO_HANDLER_H_
@@ -0,0 +1,353 @@
+#include "FrameStegoHandler.h"
+#include "../../utils/Parallel.h"
+#include "../../utils/Stats.h"
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+
+/**
+ * Read frames until the batch is full or the sequence ends.
+ */
+Result<bool> ReadBatch(FrameSequence &sequence, std::size_t batchSize, std::size_t &byteOffset,
+                       std::vector<SequenceFrame> &batch, SequenceFrame &trailer) {
+    batch.clear();
+    while (batch.size() < batchSize) {
+        SequenceFrame frame;
+        auto readResult = sequence.ReadFrame(frame);
+        if (!readResult) {
+            return readResult;
+        }
+        if (!readResult.GetValue()) {
+            trailer = std::move(frame);
+            return Result<bool>(false);
+        }
+        frame.byteOffset = byteOffset;
+        byteOffset += frame.GetCapacity();
+        batch.push_back(std::move(frame));
+    }
+    return Result<bool>(true);
+}
+
+} // namespace
+
+void FrameStegoHandler::EmbedFrame(SequenceFrame &frame, const std::vector<uint8_t> &stream) {
+    if (frame.byteOffset >= stream.size()) {
+        return;
+    }
+
+    std::size_t count = std::min(frame.GetCapacity(), stream.size() - frame.byteOffset);
+    uint8_t *carrier = frame.samples.data() + frame.lowByte;
+    std::size_t stride = frame.sampleStride;
+
+    StageTimer timer(Stats::Stage::Embed, count);
+    Stats::Add(Stats::Counter::SamplesTouched, frame.sampleCount);
+    for (std::size_t byteIdx = 0; byteIdx < count; ++byteIdx) {
+        uint8_t byte = stream[frame.byteOffset + byteIdx];
+        uint8_t *sample = carrier + byteIdx * 8 * stride;
+        for (std::size_t bit = 0; bit < 8; ++bit, sample += stride) {
+            *sample = static_cast<uint8_t>((*sample & 0xFE) | ((byte >> bit) & 1));
+        }
+    }
+}
+
+void FrameStegoHandler::ExtractFrame(const SequenceFrame &frame, std::vector<uint8_t> &stream) {
+    if (frame.byteOffset >= stream.size()) {
+        return;
+    }
+
+    std::size_t count = std::min(frame.GetCapacity(), stream.size() - frame.byteOffset);
+    const uint8_t *carrier = frame.samples.data() + frame.lowByte;
+    std::size_t stride = frame.sampleStride;
+
+    StageTimer timer(Stats::Stage::Extract, count);
+    Stats::Add(Stats::Counter::SamplesTouched, frame.sampleCount);
+    for (std::size_t byteIdx = 0; byteIdx < count; ++byteIdx) {
+        const uint8_t *sample = carrier + byteIdx * 8 * stride;
+        uint32_t byte = 0;
+        for (std::size_t bit = 0; bit < 8; ++bit, sample += stride) {
+            byte |= static_cast<uint32_t>(*sample & 1) << bit;
+        }
+        stream[frame.byteOffset + byteIdx] = static_cast<uint8_t>(byte);
+    }
+}
+
+Result<> FrameStegoHandler::Embed(const std::string &coverFile,
+                                  const std::string &dataFile,
+                                  const std::string &outputFile,
+                                  const std::string &password) {
+    namespace fs = std::filesystem;
+
+    if (!IsValidOutputName(outputFile)) {
+        return Result<>(
+            ErrorCode::UnsupportedImageFormat,
+            GetFormatName() + " method cannot write output '" + outputFile + "', use the cover's file extension"
+        );
+    }
+
+    // Open cover sequence
+    std::ifstream in(coverFile, std::ios::binary);
+    if (!in) {
+        return Result<>(ErrorCode::FileNotFound, "Failed to open cover file '" + coverFile + "'");
+    }
+    auto sequenceResult = OpenSequence(in);
+    if (!sequenceResult) {
+        return Result<>(sequenceResult.GetErrorCode(), "'" + coverFile + "': " + sequenceResult.GetErrorMessage());
+    }
+    std::unique_ptr<FrameSequence> sequence = std::move(sequenceResult.GetValue());
+
+    // Load and encrypt data
+    auto encryptResult = LoadEncryptedData(dataFile, password);
+    if (!encryptResult) {
+        return Result<>(encryptResult.GetErrorCode(), encryptResult.GetErrorMessage());
+    }
+    const auto &encryptedData = encryptResult.GetValue();
+
+    if (encryptedData.size() > MAX_REASONABLE_SIZE) {
+        std::ostringstream oss;
+        oss << "Data size (" << encryptedData.size() << " bytes) exceeds maximum allowed size ("
+            << MAX_REASONABLE_SIZE << " bytes)";
+        return Result<>(ErrorCode::DataTooLarge, oss.str());
+    }
+
+    // Payload stream: [payload header | data]
+    std::vector<uint8_t> stream = BuildPayload(encryptedData);
+
+    // Output may be the cover itself: write beside it, then replace
+    std::string tempFile = outputFile + ".tmp";
+    std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return Result<>(ErrorCode::FileWriteError, "Failed to open output file '" + outputFile + "' for writing");
+    }
+    auto fail = [&](const Result<> &error) {
+        out.close();
+        std::error_code ignored;
+        fs::remove(tempFile, ignored);
+        return error;
+    };
+
+    std::size_t batchSize = Parallel::GetThreadCount();
+    std::vector<SequenceFrame> batch;
+    std::vector<Result<>> results;
+    SequenceFrame trailer;
+    std::size_t byteOffset = 0;
+    bool moreFrames = true;
+
+    while (moreFrames) {
+        auto readResult = ReadBatch(*sequence, batchSize, byteOffset, batch, trailer);
+        if (!readResult) {
+            return fail(Result<>(readResult.GetErrorCode(), "'" + coverFile + "': " + readResult.GetErrorMessage()));
+        }
+        moreFrames = readResult.GetValue();
+
+        // Frames past the payload are copied through still encoded
+        results.assign(batch.size(), Result<>());
+        Parallel::For(batch.size(), [&](std::size_t idx) {
+            SequenceFrame &frame = batch[idx];
+            if (frame.byteOffset >= stream.size() || frame.GetCapacity() == 0) {
+                return;
+            }
+            auto decodeResult = sequence->Decode(frame);
+            if (!decodeResult) {
+                results[idx] = decodeResult;
+                return;
+            }
+            EmbedFrame(frame, stream);
+            results[idx] = sequence->Encode(frame);
+        });
+
+        for (std::size_t idx = 0; idx < batch.size(); ++idx) {
+            if (!results[idx]) {
+                return fail(results[idx]);
+            }
+            auto writeResult = sequence->WriteFrame(out, batch[idx]);
+            if (!writeResult) {
+                return fail(writeResult);
+            }
+        }
+    }
+
+    if (byteOffset < stream.size()) {
+        std::size_t headerBytes = HEADER_SIZE_BITS / 8;
+        std::size_t capacity = byteOffset > headerBytes ? byteOffset - headerBytes : 0;
+        std::ostringstream oss;
+        oss << "Data size (" << encryptedData.size() << " bytes) exceeds " << GetFormatName() << " capacity ("
+            << capacity << " bytes).\n"
+            << "    Every frame sample carries one bit.";
+        return fail(Result<>(ErrorCode::InsufficientCapacity, oss.str()));
+    }
+
+    auto trailerResult = sequence->WriteFrame(out, trailer);
+    if (!trailerResult) {
+        return fail(trailerResult);
+    }
+
+    out.close();
+    in.close();
+    if (!out) {
+        return fail(Result<>(ErrorCode::FileWriteError, "Failed to write data to '" + outputFile + "'"));
+    }
+
+    std::error_code renameError;
+    fs::rename(tempFile, outputFile, renameError);
+    if (renameError) {
+        return fail(Result<>(
+            ErrorCode::FileWriteError,
+            "Failed to write '" + outputFile + "': " + renameError.message()
+        ));
+    }
+
+    return Result<>();
+}
+
+Result<> FrameStegoHandler::Extract(const std::string &stegoFile,
+                                    const std::string &outputFile,
+                                    const std::string &password) {
+
+    // Open stego sequence
+    std::ifstream in(stegoFile, std::ios::binary);
+    if (!in) {
+        return Result<>(ErrorCode::FileNotFound, "Failed to open stego file '" + stegoFile + "'");
+    }
+    auto sequenceResult = OpenSequence(in);
+    if (!sequenceResult) {
+        return Result<>(sequenceResult.GetErrorCode(), "'" + stegoFile + "': " + sequenceResult.GetErrorMessage());
+    }
+    std::unique_ptr<FrameSequence> sequence = std::move(sequenceResult.GetValue());
+
+    // Stream holds the payload header, and the copies of an error corrected one, until it is known
+    const std::size_t headerBytes = PayloadHeader::SIZE_BYTES;
+    std::vector<uint8_t> stream(PayloadHeader::PROTECTED_SIZE_BYTES);
+    bool sizeKnown = false;
+
+    std::size_t batchSize = Parallel::GetThreadCount();
+    std::vector<SequenceFrame> batch;
+    std::vector<Result<>> results;
+    SequenceFrame trailer;
+    std::size_t byteOffset = 0;
+    bool moreFrames = true;
+
+    while (moreFrames && byteOffset < stream.size()) {
+        if (IsCancelled()) {
+            return Result<>(ErrorCode::OperationCancelled, "Extraction cancelled");
+        }
+
+        auto readResult = ReadBatch(*sequence, batchSize, byteOffset, batch, trailer);
+        if (!readResult) {
+            return Result<>(readResult.GetErrorCode(), "'" + stegoFile + "': " + readResult.GetErrorMessage());
+        }
+        moreFrames = readResult.GetValue();
+
+        // While the size is unknown every frame of the batch may be needed
+        std::size_t neededBytes = sizeKnown ? stream.size() : static_cast<std::size_t>(-1);
+        results.assign(batch.size(), Result<>());
+        Parallel::For(batch.size(), [&](std::size_t idx) {
+            SequenceFrame &frame = batch[idx];
+            if (frame.byteOffset < neededBytes && frame.GetCapacity() > 0) {
+                results[idx] = sequence->Decode(frame);
+            }
+        });
+        for (const auto &result : results) {
+            if (!result) {
+                return Result<>(result.GetErrorCode(), "Extraction failed: " + result.GetErrorMessage());
+            }
+        }
+
+        if (!sizeKnown) {
+            for (const auto &frame : batch) {
+                ExtractFrame(frame, stream);
+            }
+            if (byteOffset < stream.size() && moreFrames) {
+                continue; // header spans into the next batch
+            }
+            if (byteOffset < headerBytes) {
+                break;
+            }
+
+            auto headerResult = ParsePayloadHeader(stream.data(), std::min(byteOffset, stream.size()));
+            if (!headerResult) {
+                return Result<>(headerResult.GetErrorCode(), "Extraction failed: " + headerResult.GetErrorMessage());
+            }
+            uint32_t dataSize = headerResult.GetValue().dataSize;
+            if (dataSize == 0) {
+                return Result<>(
+                    ErrorCode::NoEmbeddedData,
+                    "Extraction failed: Extracted size is 0. File may not contain embedded data."
+                );
+            }
+            if (dataSize > MAX_REASONABLE_SIZE) {
+                std::ostringstream oss;
+                oss << "Extraction failed: Extracted size (" << dataSize << " bytes) exceeds maximum reasonable size ("
+                    << MAX_REASONABLE_SIZE << " bytes). Data is likely corrupted.";
+                return Result<>(ErrorCode::CorruptedPayload, oss.str());
+            }
+            stream.resize(headerBytes + dataSize);
+            sizeKnown = true;
+        }
+
+        // Frames fill disjoint byte ranges of the stream
+        Parallel::For(batch.size(), [&](std::size_t idx) {
+            if (!batch[idx].samples.empty()) {
+                ExtractFrame(batch[idx], stream);
+            }
+        });
+    }
+
+    if (byteOffset < stream.size()) {
+        if (!sizeKnown) {
+            return Result<>(
+                ErrorCode::ImageTooSmall,
+                "Extraction failed: " + GetFormatName() + " file is too small to contain a payload header"
+            );
+        }
+        std::ostringstream oss;
+        oss << "Extraction failed: Extracted size (" << (stream.size() - headerBytes) << " bytes) exceeds "
+            << GetFormatName() << " capacity (" << (byteOffset - headerBytes) << " bytes). "
+            << "Data is corrupted or file does not contain embedded data.";
+        return Result<>(ErrorCode::InvalidDataSize, oss.str());
+    }
+
+    // Decrypt data and write output file
+    std::vector<uint8_t> encryptedData(stream.begin() + static_cast<std::ptrdiff_t>(headerBytes), stream.end());
+    return SaveDecryptedData(encryptedData, outputFile, password);
+}
+
+Result<> FrameStegoHandler::Visual(const std::string &coverFile,
+                                   const std::string &dataFile,
+                                   const std::string &outputFile,
+                                   const std::string &password) {
+    (void) coverFile;
+    (void) dataFile;
+    (void) outputFile;
+    (void) password;
+    return Result<>(ErrorCode::NotImplemented, GetFormatName() + " method has no single image to visualize");
+}
+
+Result<> FrameStegoHandler::EmbedMethod(ImageData &imageData,
+                                        const std::vector<uint8_t> &dataToEmbed,
+                                        const std::string &password) {
+    (void) imageData;
+    (void) dataToEmbed;
+    (void) password;
+    return Result<>(ErrorCode::NotImplemented, GetFormatName() + " method embeds into frame sequences, not decoded pixels");
+}
+
+Result<std::vector<uint8_t>> FrameStegoHandler::ExtractMethod(const ImageData &imageData,
+                                                              const std::string &password) {
+    (void) imageData;
+    (void) password;
+    return Result<std::vector<uint8_t>>(
+        ErrorCode::NotImplemented,
+        GetFormatName() + " method extracts from frame sequences, not decoded pixels"
+    );
+}
+
+Result<> FrameStegoHandler::VisualizeMethod(ImageData &imageData) {
+    (void) imageData;
+    return Result<>(ErrorCode::NotImplemented, GetFormatName() + " method visualizes frame sequences, not decoded pixels");
+}
@@ -0,0 +1,162 @@
+#ifndef __FRAME_STEGO_HANDLER_H_
+#define __FRAME_STEGO_HANDLER_H_
+
+#include "../StegoHandler.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+#include <string>
+
+/**
+ * @brief One frame of a sequence file while it passes through a handler.
+ */
+struct SequenceFrame {
+    std::vector<uint8_t> passthrough;  // Container bytes before the frame, written unchanged
+    std::vector<uint8_t> dataPrefix;   // Container bytes stored with the frame data (e.g. fdAT sequence number)
+    std::vector<uint8_t> encoded;      // Frame data as stored in the file
+    std::vector<uint8_t> samples;      // Decoded frame bytes (filled by Decode)
+    int width = 0;
+    int height = 0;
+    std::size_t sampleCount = 0;       // Carrier samples, known before decoding
+    std::size_t sampleStride = 1;      // Bytes per sample in samples
+    std::size_t lowByte = 0;           // Offset of the byte holding bit 0 within a sample
+    std::size_t byteOffset = 0;        // First payload stream byte carried by this frame
+
+    /**
+     * @brief Payload bytes this frame carries (whole bytes only).
+     */
+    std::size_t GetCapacity() const { return sampleCount / 8; }
+};
+
+/**
+ * @brief Reads and writes the frames of one open sequence file.
+ *
+ * ReadFrame and WriteFrame run sequentially in file order; Decode and Encode
+ * are called concurrently on different frames.
+ */
+class FrameSequence {
+public:
+    virtual ~FrameSequence() = default;
+
+    /**
+     * @brief Read the next frame (still encoded).
+     *
+     * At the end of the sequence returns false and leaves the bytes after the
+     * last frame in frame.passthrough.
+     *
+     * @param frame Frame to fill
+     * @return Result containing true if a frame was read, or error
+     */
+    virtual Result<bool> ReadFrame(SequenceFrame &frame) = 0;
+
+    /**
+     * @brief Turn frame.encoded into frame.samples.
+     */
+    virtual Result<> Decode(SequenceFrame &frame) const = 0;
+
+    /**
+     * @brief Turn frame.samples back into frame.encoded.
+     */
+    virtual Result<> Encode(SequenceFrame &frame) const = 0;
+
+    /**
+     * @brief Write passthrough, prefix and encoded data of a frame (or the trailer).
+     */
+    virtual Result<> WriteFrame(std::ostream &out, const SequenceFrame &frame) = 0;
+};
+
+/**
+ * @brief Base class for carriers made of a sequence of frames (animations, raw video).
+ *
+ * The payload stream [payload header | data] is cut into per-frame slices: every
+ * frame carries the next GetCapacity() bytes in bit 0 of its samples, so frames
+ * are independent embedding regions. Frames are streamed in batches of one per
+ * thread, decoded, embedded and re-encoded in parallel and written in order;
+ * only one batch is held in memory at a time. Frames past the end of the
+ * payload are copied through without being decoded.
+ *
+ * Subclasses only provide the container format through OpenSequence.
+ */
+class FrameStegoHandler : public StegoHandler {
+public:
+    /**
+    * Size of the header for steganography decoding
+    **/
+    static constexpr uint32_t HEADER_SIZE_BITS = static_cast<uint32_t>(PayloadHeader::SIZE_BITS);
+
+    /**
+     * @brief Write a slice of the payload stream into a decoded frame.
+     *
+     * @param frame Decoded frame; carries stream bytes from frame.byteOffset
+     * @param stream Complete payload stream (size header and data)
+     */
+    static void EmbedFrame(SequenceFrame &frame, const std::vector<uint8_t> &stream);
+
+    /**
+     * @brief Read the payload stream slice carried by a decoded frame.
+     *
+     * @param frame Decoded frame
+     * @param stream Stream buffer; bytes [frame.byteOffset, ...) up to its size are filled
+     */
+    static void ExtractFrame(const SequenceFrame &frame, std::vector<uint8_t> &stream);
+
+    Result<> Embed(const std::string &coverFile,
+                   const std::string &dataFile,
+                   const std::string &outputFile,
+                   const std::string &password) override;
+
+    Result<> Extract(const std::string &stegoFile,
+                     const std::string &outputFile,
+                     const std::string &password) override;
+
+    /**
+     * @brief Not available: sequences have no single image to mark.
+     */
+    Result<> Visual(const std::string &coverFile,
+                    const std::string &dataFile,
+                    const std::string &outputFile,
+                    const std::string &password) override;
+
+    /**
+     * @brief Not available: frame carriers embed into sequence files, not pixels.
+     */
+    Result<> EmbedMethod(ImageData &imageData,
+                         const std::vector<uint8_t> &dataToEmbed,
+                         const std::string &password ) override;
+
+    /**
+     * @brief Not available: frame carriers extract from sequence files, not pixels.
+     */
+    Result<std::vector<uint8_t>> ExtractMethod(const ImageData &imageData,
+                                               const std::string &password ) override;
+
+    /**
+     * @brief Not available: see Visual.
+     */
+    Result<> VisualizeMethod(ImageData &imageData) override;
+
+    ~FrameStegoHandler() override = default;
+
+protected:
+    /**
+     * @brief Parse the stream header and prepare to read frames.
+     *
+     * @param in Sequence file, positioned at the start
+     * @return Result containing the frame reader/writer or error
+     */
+    virtual Result<std::unique_ptr<FrameSequence>> OpenSequence(std::istream &in) const = 0;
+
+    /**
+     * @brief Whether the output file name fits the container format.
+     */
+    virtual bool IsValidOutputName(const std::string &filename) const = 0;
+
+    /**
+     * @brief Short format name for messages (e.g. "APNG").
+     */
+    virtual std::string GetFormatName() const = 0;
+};
+
+#endif // __FRAME_STEGO_HANDLER_H_
@@ -0,0 +1,450 @@
+#include "APNGStegoHandler.h"
+#include "../../../utils/ImageIO.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t PNG_SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+/**
+ * Largest chunk payload allowed by the PNG specification
+ */
+constexpr uint32_t MAX_CHUNK_LENGTH = 0x7FFFFFFFu;
+
+struct PngChunk {
+    char type[4] = {};
+    std::vector<uint8_t> data;
+
+    bool Is(const char *name) const { return std::memcmp(type, name, 4) == 0; }
+};
+
+inline uint32_t ReadBE32(const uint8_t *ptr) {
+    return (static_cast<uint32_t>(ptr[0]) << 24) | (static_cast<uint32_t>(ptr[1]) << 16) |
+           (static_cast<uint32_t>(ptr[2]) << 8) | static_cast<uint32_t>(ptr[3]);
+}
+
+inline void WriteBE32(uint8_t *ptr, uint32_t value) {
+    ptr[0] = static_cast<uint8_t>(value >> 24);
+    ptr[1] = static_cast<uint8_t>(value >> 16);
+    ptr[2] = static_cast<uint8_t>(value >> 8);
+    ptr[3] = static_cast<uint8_t>(value);
+}
+
+/**
+ * Chunk payload read per step, so a chunk never allocates far beyond the bytes the stream holds
+ */
+constexpr std::size_t CHUNK_READ_STEP = std::size_t(1) << 20;
+
+/**
+ * Bytes left in the stream, or -1 when it cannot seek.
+ */
+std::streamoff RemainingBytes(std::istream &in) {
+    std::streampos current = in.tellg();
+    if (current == std::streampos(-1)) {
+        in.clear();
+        return -1;
+    }
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.clear();
+    in.seekg(current);
+    return end == std::streampos(-1) ? -1 : static_cast<std::streamoff>(end - current);
+}
+
+/**
+ * Read the next chunk; false at a clean end of file.
+ */
+Result<bool> ReadChunk(std::istream &in, PngChunk &chunk) {
+    uint8_t header[8];
+    in.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (in.gcount() == 0) {
+        return Result<bool>(false);
+    }
+    if (in.gcount() != static_cast<std::streamsize>(sizeof(header))) {
+        return Result<bool>(ErrorCode::ImageCorrupted, "PNG chunk header is truncated");
+    }
+
+    uint32_t length = ReadBE32(header);
+    if (length > MAX_CHUNK_LENGTH) {
+        return Result<bool>(ErrorCode::ImageCorrupted, "PNG chunk length is invalid");
+    }
+    std::memcpy(chunk.type, header + 4, 4);
+
+    // The length is untrusted: check it against what is left before allocating, and where
+    // the stream cannot tell, grow the buffer only as the data arrives
+    if (length > CHUNK_READ_STEP) {
+        std::streamoff remaining = RemainingBytes(in);
+        if (remaining >= 0 && static_cast<uint64_t>(length) + 4 > static_cast<uint64_t>(remaining)) {
+            return Result<bool>(ErrorCode::ImageCorrupted, "PNG chunk is truncated");
+        }
+    }
+
+    // Payload and CRC; the CRC is recomputed on write
+    chunk.data.clear();
+    for (std::size_t done = 0; done < length && in;) {
+        std::size_t step = std::min<std::size_t>(length - done, CHUNK_READ_STEP);
+        chunk.data.resize(done + step);
+        in.read(reinterpret_cast<char *>(chunk.data.data() + done), static_cast<std::streamsize>(step));
+        done += step;
+    }
+    uint8_t crc[4];
+    in.read(reinterpret_cast<char *>(crc), sizeof(crc));
+    if (!in) {
+        return Result<bool>(ErrorCode::ImageCorrupted, "PNG chunk is truncated");
+    }
+    return Result<bool>(true);
+}
+
+void AppendChunk(std::vector<uint8_t> &out, const PngChunk &chunk) {
+    std::size_t start = out.size();
+    out.resize(start + 8);
+    WriteBE32(out.data() + start, static_cast<uint32_t>(chunk.data.size()));
+    std::memcpy(out.data() + start + 4, chunk.type, 4);
+    out.insert(out.end(), chunk.data.begin(), chunk.data.end());
+
+    uint32_t crc = ImageIO::PngCrc(out.data() + start + 4, chunk.data.size() + 4);
+    out.resize(out.size() + 4);
+    WriteBE32(out.data() + out.size() - 4, crc);
+}
+
+inline int PaethPredictor(int left, int up, int upLeft) {
+    int estimate = left + up - upLeft;
+    int distLeft = std::abs(estimate - left);
+    int distUp = std::abs(estimate - up);
+    int distUpLeft = std::abs(estimate - upLeft);
+    if (distLeft <= distUp && distLeft <= distUpLeft) {
+        return left;
+    }
+    return distUp <= distUpLeft ? up : upLeft;
+}
+
+/**
+ * Predictor of PNG filter type Filter for byte idx of a row.
+ */
+template <int Filter>
+inline uint8_t Predict(const uint8_t *row, const uint8_t *prev, std::size_t idx, std::size_t bpp) {
+    int left = idx >= bpp ? row[idx - bpp] : 0;
+    int up = prev[idx];
+    switch (Filter) {
+    case 1:
+        return static_cast<uint8_t>(left);
+    case 2:
+        return static_cast<uint8_t>(up);
+    case 3:
+        return static_cast<uint8_t>((left + up) / 2);
+    case 4:
+        return static_cast<uint8_t>(PaethPredictor(left, up, idx >= bpp ? prev[idx - bpp] : 0));
+    default:
+        return 0;
+    }
+}
+
+template <int Filter>
+void UnfilterRow(const uint8_t *in, uint8_t *row, const uint8_t *prev, std::size_t rowBytes, std::size_t bpp) {
+    for (std::size_t idx = 0; idx < rowBytes; ++idx) {
+        row[idx] = static_cast<uint8_t>(in[idx] + Predict<Filter>(row, prev, idx, bpp));
+    }
+}
+
+/**
+ * Filter a row, returning the sum of absolute residuals (libpng's heuristic).
+ */
+template <int Filter>
+uint64_t FilterRow(const uint8_t *row, const uint8_t *prev, uint8_t *out, std::size_t rowBytes, std::size_t bpp) {
+    uint64_t cost = 0;
+    for (std::size_t idx = 0; idx < rowBytes; ++idx) {
+        out[idx] = static_cast<uint8_t>(row[idx] - Predict<Filter>(row, prev, idx, bpp));
+        cost += static_cast<uint64_t>(std::abs(static_cast<int8_t>(out[idx])));
+    }
+    return cost;
+}
+
+class APNGSequence : public FrameSequence {
+public:
+    APNGSequence(std::istream &in, std::vector<uint8_t> header, int width, int height,
+                 std::size_t channels, std::size_t bytesPerSample)
+        : in_(in),
+          passthrough_(std::move(header)),
+          width_(width),
+          height_(height),
+          channels_(channels),
+          bytesPerSample_(bytesPerSample)
+    {   }
+
+    Result<bool> ReadFrame(SequenceFrame &frame) override {
+        frame.passthrough = std::move(passthrough_);
+        passthrough_.clear();
+
+        PngChunk chunk;
+        for (;;) {
+            auto chunkResult = NextChunk(chunk);
+            if (!chunkResult) {
+                return chunkResult;
+            }
+            if (!chunkResult.GetValue()) {
+                return Result<bool>(ErrorCode::ImageCorrupted, "PNG file ends without IEND chunk");
+            }
+
+            if (chunk.Is("IEND")) {
+                AppendChunk(frame.passthrough, chunk);
+                return Result<bool>(false);
+            }
+            if (chunk.Is("IDAT") || chunk.Is("fdAT")) {
+                break;
+            }
+
+            if (chunk.Is("fcTL")) {
+                if (chunk.data.size() < 26) {
+                    return Result<bool>(ErrorCode::ImageCorrupted, "APNG fcTL chunk is truncated");
+                }
+                // One data chunk is written per frame, so sequence numbers are reassigned
+                WriteBE32(chunk.data.data(), sequence_++);
+                frameWidth_ = ReadBE32(chunk.data.data() + 4);
+                frameHeight_ = ReadBE32(chunk.data.data() + 8);
+                if (frameWidth_ == 0 || frameHeight_ == 0 ||
+                    frameWidth_ > static_cast<uint32_t>(width_) || frameHeight_ > static_cast<uint32_t>(height_)) {
+                    return Result<bool>(ErrorCode::InvalidImageDimensions, "APNG frame dimensions are invalid");
+                }
+            }
+            AppendChunk(frame.passthrough, chunk);
+        }
+
+        // Frame data: consecutive chunks of one type
+        bool isDefaultImage = chunk.Is("IDAT");
+        if (isDefaultImage) {
+            frame.width = width_;
+            frame.height = height_;
+        } else {
+            if (frameWidth_ == 0) {
+                return Result<bool>(ErrorCode::ImageCorrupted, "APNG fdAT chunk without preceding fcTL");
+            }
+            frame.width = static_cast<int>(frameWidth_);
+            frame.height = static_cast<int>(frameHeight_);
+            frame.dataPrefix.resize(4);
+            WriteBE32(frame.dataPrefix.data(), sequence_++);
+        }
+
+        std::string type(chunk.type, 4);
+        do {
+            std::size_t skip = isDefaultImage ? 0 : 4; // fdAT sequence number
+            if (chunk.data.size() < skip) {
+                return Result<bool>(ErrorCode::ImageCorrupted, "APNG fdAT chunk is truncated");
+            }
+            frame.encoded.insert(frame.encoded.end(), chunk.data.begin() + static_cast<std::ptrdiff_t>(skip), chunk.data.end());
+
+            auto chunkResult = NextChunk(chunk);
+            if (!chunkResult) {
+                return chunkResult;
+            }
+            if (!chunkResult.GetValue()) {
+                return Result<bool>(ErrorCode::ImageCorrupted, "PNG file ends without IEND chunk");
+            }
+        } while (chunk.Is(type.c_str()));
+        pending_ = std::move(chunk);
+        hasPending_ = true;
+
+        frame.sampleStride = bytesPerSample_;
+        frame.lowByte = bytesPerSample_ - 1; // samples are big-endian
+        frame.sampleCount = static_cast<std::size_t>(frame.width) * frame.height * channels_;
+        return Result<bool>(true);
+    }
+
+    Result<> Decode(SequenceFrame &frame) const override {
+        std::size_t bpp = channels_ * bytesPerSample_;
+        std::size_t rowBytes = static_cast<std::size_t>(frame.width) * bpp;
+        std::size_t height = static_cast<std::size_t>(frame.height);
+
+        auto inflateResult = ImageIO::ZlibDecompress(frame.encoded, (rowBytes + 1) * height);
+        if (!inflateResult) {
+            return Result<>(inflateResult.GetErrorCode(), "APNG frame: " + inflateResult.GetErrorMessage());
+        }
+        const auto &filtered = inflateResult.GetValue();
+
+        // Undo the per-row filters
+        frame.samples.resize(rowBytes * height);
+        std::vector<uint8_t> zeroRow(rowBytes, 0);
+        for (std::size_t y = 0; y < height; ++y) {
+            const uint8_t *in = filtered.data() + y * (rowBytes + 1);
+            uint8_t *row = frame.samples.data() + y * rowBytes;
+            const uint8_t *prev = y == 0 ? zeroRow.data() : row - rowBytes;
+            switch (in[0]) {
+            case 0: UnfilterRow<0>(in + 1, row, prev, rowBytes, bpp); break;
+            case 1: UnfilterRow<1>(in + 1, row, prev, rowBytes, bpp); break;
+            case 2: UnfilterRow<2>(in + 1, row, prev, rowBytes, bpp); break;
+            case 3: UnfilterRow<3>(in + 1, row, prev, rowBytes, bpp); break;
+            case 4: UnfilterRow<4>(in + 1, row, prev, rowBytes, bpp); break;
+            default:
+                return Result<>(ErrorCode::ImageCorrupted, "APNG frame uses an unknown filter type");
+            }
+        }
+
+        frame.encoded.clear();
+        frame.encoded.shrink_to_fit();
+        return Result<>();
+    }
+
+    Result<> Encode(SequenceFrame &frame) const override {
+        std::size_t bpp = channels_ * bytesPerSample_;
+        std::size_t rowBytes = static_cast<std::size_t>(frame.width) * bpp;
+        std::size_t height = static_cast<std::size_t>(frame.height);
+
+        // Per row, keep the filter with the smallest sum of absolute residuals
+        std::vector<uint8_t> filtered((rowBytes + 1) * height);
+        std::vector<uint8_t> zeroRow(rowBytes, 0);
+        std::vector<uint8_t> candidate(rowBytes);
+        for (std::size_t y = 0; y < height; ++y) {
+            const uint8_t *row = frame.samples.data() + y * rowBytes;
+            const uint8_t *prev = y == 0 ? zeroRow.data() : row - rowBytes;
+            uint8_t *out = filtered.data() + y * (rowBytes + 1);
+
+            out[0] = 0;
+            uint64_t bestCost = FilterRow<0>(row, prev, out + 1, rowBytes, bpp);
+            auto tryFilter = [&](uint8_t filter, uint64_t cost) {
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    out[0] = filter;
+                    std::copy(candidate.begin(), candidate.end(), out + 1);
+                }
+            };
+            tryFilter(1, FilterRow<1>(row, prev, candidate.data(), rowBytes, bpp));
+            tryFilter(2, FilterRow<2>(row, prev, candidate.data(), rowBytes, bpp));
+            tryFilter(3, FilterRow<3>(row, prev, candidate.data(), rowBytes, bpp));
+            tryFilter(4, FilterRow<4>(row, prev, candidate.data(), rowBytes, bpp));
+        }
+
+        auto deflateResult = ImageIO::ZlibCompress(filtered);
+        if (!deflateResult) {
+            return Result<>(deflateResult.GetErrorCode(), "APNG frame: " + deflateResult.GetErrorMessage());
+        }
+        if (deflateResult.GetValue().size() + frame.dataPrefix.size() > MAX_CHUNK_LENGTH) {
+            return Result<>(ErrorCode::ImageSaveFailed, "APNG frame does not fit into a single chunk");
+        }
+
+        frame.encoded = std::move(deflateResult.GetValue());
+        frame.samples.clear();
+        frame.samples.shrink_to_fit();
+        return Result<>();
+    }
+
+    Result<> WriteFrame(std::ostream &out, const SequenceFrame &frame) override {
+        out.write(reinterpret_cast<const char *>(frame.passthrough.data()),
+                  static_cast<std::streamsize>(frame.passthrough.size()));
+
+        if (frame.sampleCount > 0) {
+            // Single IDAT/fdAT chunk: [length | type | prefix | data | CRC]
+            const char *type = frame.dataPrefix.empty() ? "IDAT" : "fdAT";
+            uint8_t header[8];
+            WriteBE32(header, static_cast<uint32_t>(frame.dataPrefix.size() + frame.encoded.size()));
+            std::memcpy(header + 4, type, 4);
+
+            uint32_t crc = ImageIO::PngCrc(header + 4, 4);
+            crc = ImageIO::PngCrc(frame.dataPrefix.data(), frame.dataPrefix.size(), crc);
+            crc = ImageIO::PngCrc(frame.encoded.data(), frame.encoded.size(), crc);
+            uint8_t trailer[4];
+            WriteBE32(trailer, crc);
+
+            out.write(reinterpret_cast<const char *>(header), sizeof(header));
+            out.write(reinterpret_cast<const char *>(frame.dataPrefix.data()),
+                      static_cast<std::streamsize>(frame.dataPrefix.size()));
+            out.write(reinterpret_cast<const char *>(frame.encoded.data()),
+                      static_cast<std::streamsize>(frame.encoded.size()));
+            out.write(reinterpret_cast<const char *>(trailer), sizeof(trailer));
+        }
+
+        if (!out) {
+            return Result<>(ErrorCode::FileWriteError, "Failed to write APNG frame");
+        }
+        return Result<>();
+    }
+
+private:
+    Result<bool> NextChunk(PngChunk &chunk) {
+        if (hasPending_) {
+            chunk = std::move(pending_);
+            hasPending_ = false;
+            return Result<bool>(true);
+        }
+        return ReadChunk(in_, chunk);
+    }
+
+    std::istream &in_;
+    std::vector<uint8_t> passthrough_;
+    int width_;
+    int height_;
+    std::size_t channels_;
+    std::size_t bytesPerSample_;
+    uint32_t frameWidth_ = 0;
+    uint32_t frameHeight_ = 0;
+    uint32_t sequence_ = 0;
+    PngChunk pending_;
+    bool hasPending_ = false;
+};
+
+} // namespace
+
+Result<std::unique_ptr<FrameSequence>> APNGStegoHandler::OpenSequence(std::istream &in) const {
+    using SequenceResult = Result<std::unique_ptr<FrameSequence>>;
+
+    uint8_t signature[sizeof(PNG_SIGNATURE)];
+    in.read(reinterpret_cast<char *>(signature), sizeof(signature));
+    if (!in || std::memcmp(signature, PNG_SIGNATURE, sizeof(signature)) != 0) {
+        return SequenceResult(ErrorCode::UnsupportedImageFormat, "APNG method requires a PNG file");
+    }
+
+    PngChunk header;
+    auto chunkResult = ReadChunk(in, header);
+    if (!chunkResult || !chunkResult.GetValue() || !header.Is("IHDR") || header.data.size() < 13) {
+        return SequenceResult(ErrorCode::ImageCorrupted, "PNG file does not start with an IHDR chunk");
+    }
+
+    uint32_t width = ReadBE32(header.data.data());
+    uint32_t height = ReadBE32(header.data.data() + 4);
+    int bitDepth = header.data[8];
+    int colorType = header.data[9];
+    int interlace = header.data[12];
+
+    if (width == 0 || height == 0 || width > (1u << 24) || height > (1u << 24)) {
+        return SequenceResult(ErrorCode::InvalidImageDimensions, "PNG image dimensions are invalid");
+    }
+
+    std::size_t channels = 0;
+    switch (colorType) {
+    case 0: channels = 1; break; // grey
+    case 2: channels = 3; break; // RGB
+    case 4: channels = 2; break; // grey+alpha
+    case 6: channels = 4; break; // RGBA
+    default: break;
+    }
+    if (channels == 0 || (bitDepth != 8 && bitDepth != 16) || interlace != 0) {
+        return SequenceResult(
+            ErrorCode::UnsupportedImageFormat,
+            "APNG method supports non-interlaced 8/16-bit grey, grey+alpha, RGB and RGBA (no palettes)"
+        );
+    }
+
+    std::vector<uint8_t> passthrough(PNG_SIGNATURE, PNG_SIGNATURE + sizeof(PNG_SIGNATURE));
+    AppendChunk(passthrough, header);
+
+    return SequenceResult(std::make_unique<APNGSequence>(
+        in, std::move(passthrough), static_cast<int>(width), static_cast<int>(height),
+        channels, static_cast<std::size_t>(bitDepth / 8)
+    ));
+}
+
+bool APNGStegoHandler::IsValidOutputName(const std::string &filename) const {
+    std::size_t dotPos = filename.find_last_of(".");
+    if (dotPos == std::string::npos) {
+        return false;
+    }
+    std::string ext = filename.substr(dotPos + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext == "png" || ext == "apng";
+}
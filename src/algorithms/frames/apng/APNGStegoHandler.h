@@ -0,0 +1,29 @@
+#ifndef __APNG_STEGO_HANDLER_H_
+#define __APNG_STEGO_HANDLER_H_
+
+#include "../FrameStegoHandler.h"
+
+/**
+ * @brief Frame carrier for animated PNG files.
+ *
+ * The default image (IDAT) and every fdAT frame are independent embedding
+ * regions: each is inflated and unfiltered, carries payload in bit 0 of its
+ * samples (low byte for 16-bit), and is refiltered and recompressed into a
+ * single data chunk. Sequence numbers are renumbered accordingly; all other
+ * chunks are copied unchanged. A plain PNG is handled as a one-frame sequence.
+ *
+ * Supports non-interlaced 8 and 16-bit greyscale, grey+alpha, RGB and RGBA.
+ */
+class APNGStegoHandler : public FrameStegoHandler {
+public:
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::APNG; }
+
+    ~APNGStegoHandler() override = default;
+
+protected:
+    Result<std::unique_ptr<FrameSequence>> OpenSequence(std::istream &in) const override;
+    bool IsValidOutputName(const std::string &filename) const override;
+    std::string GetFormatName() const override { return "APNG"; }
+};
+
+#endif // __APNG_STEGO_HANDLER_H_
@@ -0,0 +1,200 @@
+#include "Y4MStegoHandler.h"
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr char STREAM_MAGIC[] = "YUV4MPEG2 ";
+constexpr char FRAME_MAGIC[] = "FRAME";
+
+/**
+ * Longest header line accepted, guards against reading binary data as text
+ */
+constexpr std::size_t MAX_HEADER_LENGTH = 4096;
+
+bool ReadLine(std::istream &in, std::string &line) {
+    line.clear();
+    for (int c = in.get(); c != std::char_traits<char>::eof(); c = in.get()) {
+        if (c == '\n') {
+            return true;
+        }
+        if (line.size() >= MAX_HEADER_LENGTH) {
+            return false;
+        }
+        line.push_back(static_cast<char>(c));
+    }
+    return false;
+}
+
+/**
+ * Frame bytes read per step, so a frame never allocates far beyond the bytes the stream holds
+ */
+constexpr std::size_t FRAME_READ_STEP = std::size_t(1) << 20;
+
+/**
+ * Bytes of one frame for the C (colour space) tag, 0 if unsupported.
+ */
+std::size_t GetFrameSize(const std::string &colorSpace, std::size_t width, std::size_t height) {
+    std::size_t luma = width * height;
+    std::size_t halfWidth = (width + 1) / 2;
+    if (colorSpace == "420" || colorSpace == "420jpeg" || colorSpace == "420paldv" || colorSpace == "420mpeg2") {
+        return luma + 2 * halfWidth * ((height + 1) / 2);
+    }
+    if (colorSpace == "422") {
+        return luma + 2 * halfWidth * height;
+    }
+    if (colorSpace == "411") {
+        return luma + 2 * ((width + 3) / 4) * height;
+    }
+    if (colorSpace == "444") {
+        return 3 * luma;
+    }
+    if (colorSpace == "444alpha") {
+        return 4 * luma;
+    }
+    if (colorSpace == "mono") {
+        return luma;
+    }
+    return 0;
+}
+
+class Y4MSequence : public FrameSequence {
+public:
+    Y4MSequence(std::istream &in, std::string header, int width, int height, std::size_t frameSize)
+        : in_(in),
+          header_(header.begin(), header.end()),
+          width_(width),
+          height_(height),
+          frameSize_(frameSize)
+    {   }
+
+    Result<bool> ReadFrame(SequenceFrame &frame) override {
+        frame.passthrough = std::move(header_);
+        header_.clear();
+
+        if (in_.peek() == std::char_traits<char>::eof()) {
+            return Result<bool>(false);
+        }
+
+        std::string line;
+        if (!ReadLine(in_, line) || line.compare(0, std::strlen(FRAME_MAGIC), FRAME_MAGIC) != 0) {
+            return Result<bool>(ErrorCode::ImageCorrupted, "Y4M frame header is missing or malformed");
+        }
+        frame.dataPrefix.assign(line.begin(), line.end());
+        frame.dataPrefix.push_back('\n');
+
+        // The frame size comes from the untrusted stream header: grow the buffer only as the data arrives
+        frame.encoded.clear();
+        std::size_t done = 0;
+        while (done < frameSize_) {
+            std::size_t step = std::min(frameSize_ - done, FRAME_READ_STEP);
+            frame.encoded.resize(done + step);
+            in_.read(reinterpret_cast<char *>(frame.encoded.data() + done), static_cast<std::streamsize>(step));
+            done += static_cast<std::size_t>(in_.gcount());
+            if (static_cast<std::size_t>(in_.gcount()) != step) {
+                break;
+            }
+        }
+        if (done != frameSize_) {
+            return Result<bool>(ErrorCode::ImageCorrupted, "Y4M stream ends inside a frame");
+        }
+
+        frame.width = width_;
+        frame.height = height_;
+        frame.sampleCount = frameSize_;
+        return Result<bool>(true);
+    }
+
+    Result<> Decode(SequenceFrame &frame) const override {
+        // Planes are stored raw, one byte per sample
+        frame.samples = std::move(frame.encoded);
+        frame.encoded.clear();
+        return Result<>();
+    }
+
+    Result<> Encode(SequenceFrame &frame) const override {
+        frame.encoded = std::move(frame.samples);
+        frame.samples.clear();
+        return Result<>();
+    }
+
+    Result<> WriteFrame(std::ostream &out, const SequenceFrame &frame) override {
+        for (const auto *bytes : {&frame.passthrough, &frame.dataPrefix, &frame.encoded}) {
+            out.write(reinterpret_cast<const char *>(bytes->data()), static_cast<std::streamsize>(bytes->size()));
+        }
+        if (!out) {
+            return Result<>(ErrorCode::FileWriteError, "Failed to write Y4M frame");
+        }
+        return Result<>();
+    }
+
+private:
+    std::istream &in_;
+    std::vector<uint8_t> header_;
+    int width_;
+    int height_;
+    std::size_t frameSize_;
+};
+
+} // namespace
+
+Result<std::unique_ptr<FrameSequence>> Y4MStegoHandler::OpenSequence(std::istream &in) const {
+
+    std::string line;
+    if (!ReadLine(in, line) || line.compare(0, std::strlen(STREAM_MAGIC), STREAM_MAGIC) != 0) {
+        return Result<std::unique_ptr<FrameSequence>>(
+            ErrorCode::UnsupportedImageFormat,
+            "Y4M method requires a YUV4MPEG2 stream"
+        );
+    }
+
+    // Parameters: W<width> H<height> C<colour space>, others are kept as is
+    long width = 0;
+    long height = 0;
+    std::string colorSpace = "420jpeg";
+    std::istringstream params(line.substr(std::strlen(STREAM_MAGIC)));
+    std::string token;
+    while (params >> token) {
+        if (token[0] == 'W') {
+            width = std::strtol(token.c_str() + 1, nullptr, 10);
+        } else if (token[0] == 'H') {
+            height = std::strtol(token.c_str() + 1, nullptr, 10);
+        } else if (token[0] == 'C') {
+            colorSpace = token.substr(1);
+        }
+    }
+
+    if (width <= 0 || height <= 0 || width > (1 << 16) || height > (1 << 16)) {
+        return Result<std::unique_ptr<FrameSequence>>(ErrorCode::InvalidImageDimensions, "Y4M stream has invalid frame dimensions");
+    }
+
+    std::size_t frameSize = GetFrameSize(colorSpace, static_cast<std::size_t>(width), static_cast<std::size_t>(height));
+    if (frameSize == 0) {
+        return Result<std::unique_ptr<FrameSequence>>(
+            ErrorCode::UnsupportedImageFormat,
+            "Y4M colour space '" + colorSpace + "' is not supported (8-bit mono, 411, 420, 422, 444 and 444alpha only)"
+        );
+    }
+
+    return Result<std::unique_ptr<FrameSequence>>(
+        std::make_unique<Y4MSequence>(in, line + "\n", static_cast<int>(width), static_cast<int>(height), frameSize)
+    );
+}
+
+bool Y4MStegoHandler::IsValidOutputName(const std::string &filename) const {
+    std::size_t dotPos = filename.find_last_of(".");
+    if (dotPos == std::string::npos) {
+        return false;
+    }
+    std::string ext = filename.substr(dotPos + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext == "y4m";
+}
@@ -0,0 +1,25 @@
+#ifndef __Y4M_STEGO_HANDLER_H_
+#define __Y4M_STEGO_HANDLER_H_
+
+#include "../FrameStegoHandler.h"
+
+/**
+ * @brief Frame carrier for raw YUV4MPEG2 (.y4m) video streams.
+ *
+ * Every frame is one embedding region covering all of its Y, Cb, Cr (and alpha)
+ * samples in file order. Supports 8-bit mono, 4:2:0, 4:2:2, 4:4:4 and 4:4:4
+ * with alpha; the stream and frame headers are copied unchanged.
+ */
+class Y4MStegoHandler : public FrameStegoHandler {
+public:
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::Y4M; }
+
+    ~Y4MStegoHandler() override = default;
+
+protected:
+    Result<std::unique_ptr<FrameSequence>> OpenSequence(std::istream &in) const override;
+    bool IsValidOutputName(const std::string &filename) const override;
+    std::string GetFormatName() const override { return "Y4M"; }
+};
+
+#endif // __Y4M_STEGO_HANDLER_H_
@@ -1,7 +1,962 @@
 ﻿#include "LSBStegoHandler.h"
 #include "../../utils/ImageIO.h"
+#include "../../utils/Stats.h"
+#include "../../utils/Parallel.h"
+#include "../../utils/ImageDiff.h"
+#include "../../utils/CpuFeatures.h"
 
 #include <sstream>
+#include <cctype>
+#include <algorithm>
+#include <type_traits>
+#include <array>
+
+namespace {
+
+/**
+ * Channel offsets selected by a mask within one pixel of 'stride' channels.
+ */
+struct SampleLayout {
+    std::vector<std::size_t> offsets;
+    std::size_t stride = 0;
+    std::size_t pixelCount = 0;
+};
+
+Result<SampleLayout> ResolveLayout(const EmbeddingMask &mask, int width, int height, int channels, int depth) {
+    if (mask.bitPlane < 0 || mask.bitCount < 1 || mask.bitCount > EmbeddingMask::MAX_BIT_COUNT ||
+        mask.bitPlane + mask.bitCount > depth) {
+        std::ostringstream oss;
+        oss << "Invalid bit planes " << mask.bitPlane << " to " << (mask.bitPlane + mask.bitCount - 1)
+            << " for " << depth << "-bit samples";
+        return Result<SampleLayout>(ErrorCode::InvalidArgument, oss.str());
+    }
+
+    SampleLayout layout;
+    layout.stride = static_cast<std::size_t>(channels);
+    layout.pixelCount = static_cast<std::size_t>(width) * height;
+    for (int channel = 0; channel < channels && channel < EmbeddingMask::MAX_CHANNELS; ++channel) {
+        if (mask.channels & (1u << channel)) {
+            layout.offsets.push_back(static_cast<std::size_t>(channel));
+        }
+    }
+
+    if (layout.offsets.empty()) {
+        std::ostringstream oss;
+        oss << "Embedding mask selects none of the image's " << channels << " channel(s)";
+        return Result<SampleLayout>(ErrorCode::InvalidArgument, oss.str());
+    }
+    return Result<SampleLayout>(layout);
+}
+
+template <typename T>
+Result<SampleLayout> ResolveLayout(const EmbeddingMask &mask, const BasicImageData<T> &imageData) {
+    auto layoutResult = ResolveLayout(mask, imageData.width, imageData.height, imageData.channels,
+                                      BasicImageData<T>::BIT_DEPTH);
+    if (layoutResult && layoutResult.GetValue().pixelCount * layoutResult.GetValue().stride != imageData.pixels.size()) {
+        return Result<SampleLayout>(ErrorCode::InvalidImageDimensions, "Pixel data size does not match image dimensions");
+    }
+    return layoutResult;
+}
+
+// Portable kernels for the common layouts, with the channel stride fixed at compile time
+
+template <std::size_t Stride>
+void GatherStrided(const uint8_t *src, uint8_t *dst, std::size_t count, int plane) {
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        dst[idx] = static_cast<uint8_t>(src[idx * Stride] >> plane);
+    }
+}
+
+template <std::size_t Stride>
+void ScatterStrided(const uint8_t *src, uint8_t *dst, std::size_t count, int plane, uint8_t keepMask, uint8_t valueMask) {
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        dst[idx * Stride] = static_cast<uint8_t>((dst[idx * Stride] & keepMask) | ((src[idx] & valueMask) << plane));
+    }
+}
+
+void GatherRGBOfRGBA(const uint8_t *src, uint8_t *dst, std::size_t pixelCount, int plane) {
+    for (std::size_t idx = 0; idx < pixelCount; ++idx) {
+        dst[idx * 3 + 0] = static_cast<uint8_t>(src[idx * 4 + 0] >> plane);
+        dst[idx * 3 + 1] = static_cast<uint8_t>(src[idx * 4 + 1] >> plane);
+        dst[idx * 3 + 2] = static_cast<uint8_t>(src[idx * 4 + 2] >> plane);
+    }
+}
+
+void ScatterRGBOfRGBA(const uint8_t *src, uint8_t *dst, std::size_t pixelCount, int plane, uint8_t keepMask, uint8_t valueMask) {
+    for (std::size_t idx = 0; idx < pixelCount; ++idx) {
+        dst[idx * 4 + 0] = static_cast<uint8_t>((dst[idx * 4 + 0] & keepMask) | ((src[idx * 3 + 0] & valueMask) << plane));
+        dst[idx * 4 + 1] = static_cast<uint8_t>((dst[idx * 4 + 1] & keepMask) | ((src[idx * 3 + 1] & valueMask) << plane));
+        dst[idx * 4 + 2] = static_cast<uint8_t>((dst[idx * 4 + 2] & keepMask) | ((src[idx * 3 + 2] & valueMask) << plane));
+    }
+}
+
+bool IsRGBOfRGBA(const SampleLayout &layout) {
+    return layout.stride == 4 && layout.offsets.size() == 3 &&
+           layout.offsets[0] == 0 && layout.offsets[1] == 1 && layout.offsets[2] == 2;
+}
+
+// Any channel set, from pixel 'first' to the end
+void GatherPixels(const SampleLayout &layout, const uint8_t *src, uint8_t *dst, std::size_t first, int plane) {
+    std::size_t selected = layout.offsets.size();
+    for (std::size_t pixel = first; pixel < layout.pixelCount; ++pixel) {
+        for (std::size_t idx = 0; idx < selected; ++idx) {
+            dst[pixel * selected + idx] = static_cast<uint8_t>(src[pixel * layout.stride + layout.offsets[idx]] >> plane);
+        }
+    }
+}
+
+void ScatterPixels(const SampleLayout &layout, const uint8_t *src, uint8_t *dst, std::size_t first, int plane,
+                   uint8_t keepMask, uint8_t valueMask) {
+    std::size_t selected = layout.offsets.size();
+    for (std::size_t pixel = first; pixel < layout.pixelCount; ++pixel) {
+        for (std::size_t idx = 0; idx < selected; ++idx) {
+            uint8_t &value = dst[pixel * layout.stride + layout.offsets[idx]];
+            value = static_cast<uint8_t>((value & keepMask) | ((src[pixel * selected + idx] & valueMask) << plane));
+        }
+    }
+}
+
+// Multi-bit / 16-bit path: one 8-bit sample per selected bit. Bit 0 is the embedding bit,
+// bits 1-7 hold the sample's top bits above the embedding planes so cost maps stay stable
+template <typename T>
+int HighShift(int planeEnd) {
+    return std::max(planeEnd, BasicImageData<T>::BIT_DEPTH - 7);
+}
+
+inline void ExpandSample(uint32_t value, uint8_t *out, int planeBegin, int planeEnd, int highShift) {
+    uint8_t high = static_cast<uint8_t>((value >> highShift) << 1);
+    for (int plane = planeBegin; plane < planeEnd; ++plane) {
+        *out++ = static_cast<uint8_t>(high | ((value >> plane) & 1u));
+    }
+}
+
+template <typename T>
+T CollapseSample(T sample, const uint8_t *in, int planeBegin, int planeEnd) {
+    uint32_t value = sample;
+    for (int plane = planeBegin; plane < planeEnd; ++plane) {
+        value = (value & ~(1u << plane)) | ((*in++ & 1u) << plane);
+    }
+    return static_cast<T>(value);
+}
+
+template <typename T>
+void GatherBitsScalar(const SampleLayout &layout, const T *src, uint8_t *dst, int planeBegin, int planeCount) {
+    const int planeEnd = planeBegin + planeCount;
+    const int highShift = HighShift<T>(planeEnd);
+    std::size_t out = 0;
+
+    for (std::size_t pixel = 0; pixel < layout.pixelCount; ++pixel) {
+        for (std::size_t offset : layout.offsets) {
+            ExpandSample(src[pixel * layout.stride + offset], dst + out, planeBegin, planeEnd, highShift);
+            out += static_cast<std::size_t>(planeCount);
+        }
+    }
+}
+
+template <typename T>
+void ScatterBitsScalar(const SampleLayout &layout, const uint8_t *src, T *dst, int planeBegin, int planeCount) {
+    const int planeEnd = planeBegin + planeCount;
+    std::size_t in = 0;
+
+    for (std::size_t pixel = 0; pixel < layout.pixelCount; ++pixel) {
+        for (std::size_t offset : layout.offsets) {
+            T &sample = dst[pixel * layout.stride + offset];
+            sample = CollapseSample(sample, src + in, planeBegin, planeEnd);
+            in += static_cast<std::size_t>(planeCount);
+        }
+    }
+}
+
+#ifdef STEGTOOL_X86_SIMD
+
+// Vector kernels work on blocks of 16 bytes per channel (16 pixels, or 8 of 16-bit samples):
+// the selected bytes of a block fill whole vectors for every layout, so a block moves with
+// a fixed set of pshufb routes. The byte order of 16-bit samples is x86's, little endian.
+
+/**
+ * Pixels gathered into the local buffer at a time by the multi-bit path
+ */
+constexpr std::size_t CHUNK_PIXELS = 1024;
+
+using Lanes = std::array<uint8_t, 16>;
+
+/**
+ * pshufb routes between the image bytes of a block and its selected bytes, packed.
+ * A block is 16 bytes of every channel, so it spans 'stride' image vectors and
+ * 'selected' packed vectors; route [v][w] moves the bytes vector v receives from
+ * vector w and leaves the other lanes (0x80) zero.
+ */
+struct BlockRoutes {
+    std::size_t pixels = 0;
+    std::array<std::array<Lanes, EmbeddingMask::MAX_CHANNELS>, EmbeddingMask::MAX_CHANNELS> gather{};  // [packed][image]
+    std::array<std::array<Lanes, EmbeddingMask::MAX_CHANNELS>, EmbeddingMask::MAX_CHANNELS> scatter{}; // [image][packed]
+    std::array<Lanes, EmbeddingMask::MAX_CHANNELS> keep{};  // image bits a scatter leaves as they are
+};
+
+BlockRoutes BuildRoutes(const SampleLayout &layout, std::size_t sampleBytes, uint8_t keepMask) {
+    const std::size_t selected = layout.offsets.size();
+    BlockRoutes block;
+    block.pixels = 16 / sampleBytes;
+    for (std::size_t first = 0; first < EmbeddingMask::MAX_CHANNELS; ++first) {
+        for (std::size_t second = 0; second < EmbeddingMask::MAX_CHANNELS; ++second) {
+            block.gather[first][second].fill(0x80);
+            block.scatter[first][second].fill(0x80);
+        }
+        block.keep[first].fill(0xFF);
+    }
+
+    for (std::size_t pixel = 0; pixel < block.pixels; ++pixel) {
+        for (std::size_t idx = 0; idx < selected; ++idx) {
+            for (std::size_t byte = 0; byte < sampleBytes; ++byte) {
+                std::size_t packed = (pixel * selected + idx) * sampleBytes + byte;
+                std::size_t image = (pixel * layout.stride + layout.offsets[idx]) * sampleBytes + byte;
+                block.gather[packed / 16][image / 16][packed % 16] = static_cast<uint8_t>(image % 16);
+                block.scatter[image / 16][packed / 16][image % 16] = static_cast<uint8_t>(packed % 16);
+                block.keep[image / 16][image % 16] = keepMask;
+            }
+        }
+    }
+    return block;
+}
+
+/**
+ * Lanes of the bit expansion of 16 samples into 16 * planeCount bytes: output
+ * byte t of vector j belongs to sample (16j + t) / planeCount and its plane
+ * planeBegin + (16j + t) % planeCount.
+ */
+struct BitRoutes {
+    struct Collect {
+        std::size_t vector = 0;
+        bool lowByte = true;
+        Lanes lanes{};
+    };
+
+    std::size_t vectors = 0;
+    std::array<Lanes, EmbeddingMask::MAX_BIT_COUNT> repeat{};   // sample of each output byte
+    std::array<Lanes, EmbeddingMask::MAX_BIT_COUNT> test{};     // its plane's bit within the sample byte
+    std::array<Lanes, EmbeddingMask::MAX_BIT_COUNT> lowByte{};  // 0xFF where that plane is in the low byte
+    std::vector<Collect> collect;                               // one plane of every sample back to lane 'sample'
+};
+
+BitRoutes BuildBitRoutes(int planeBegin, int planeCount) {
+    const std::size_t count = static_cast<std::size_t>(planeCount);
+    BitRoutes bits;
+    bits.vectors = count;
+    for (std::size_t vector = 0; vector < count; ++vector) {
+        for (std::size_t lane = 0; lane < 16; ++lane) {
+            std::size_t byte = vector * 16 + lane;
+            int plane = planeBegin + static_cast<int>(byte % count);
+            bits.repeat[vector][lane] = static_cast<uint8_t>(byte / count);
+            bits.test[vector][lane] = static_cast<uint8_t>(1u << (plane % 8));
+            bits.lowByte[vector][lane] = plane < 8 ? 0xFF : 0x00;
+        }
+    }
+
+    for (std::size_t offset = 0; offset < count; ++offset) {
+        for (std::size_t vector = 0; vector < count; ++vector) {
+            BitRoutes::Collect route;
+            route.vector = vector;
+            route.lowByte = planeBegin + static_cast<int>(offset) < 8;
+            route.lanes.fill(0x80);
+            bool any = false;
+            for (std::size_t sample = 0; sample < 16; ++sample) {
+                std::size_t byte = sample * count + offset;
+                if (byte / 16 == vector) {
+                    route.lanes[sample] = static_cast<uint8_t>(byte % 16);
+                    any = true;
+                }
+            }
+            if (any) {
+                bits.collect.push_back(route);
+            }
+        }
+    }
+    return bits;
+}
+
+__attribute__((target("ssse3")))
+inline __m128i LoadLanes(const Lanes &lanes) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes.data()));
+}
+
+/**
+ * Selected bytes of whole blocks, each shifted right by 'plane'
+ */
+template <std::size_t Stride, std::size_t Selected>
+__attribute__((target("ssse3")))
+void GatherBlocksSsse3(const BlockRoutes &block, const uint8_t *src, uint8_t *dst, std::size_t blocks, int plane) {
+    const __m128i shift = _mm_cvtsi32_si128(plane);
+    const __m128i low = _mm_set1_epi8(static_cast<char>(0xFF >> plane));
+    __m128i routes[Selected][Stride];
+    for (std::size_t packed = 0; packed < Selected; ++packed) {
+        for (std::size_t image = 0; image < Stride; ++image) {
+            routes[packed][image] = LoadLanes(block.gather[packed][image]);
+        }
+    }
+
+    for (std::size_t idx = 0; idx < blocks; ++idx) {
+        const uint8_t *in = src + idx * Stride * 16;
+        uint8_t *out = dst + idx * Selected * 16;
+        __m128i image[Stride];
+        for (std::size_t vector = 0; vector < Stride; ++vector) {
+            image[vector] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + vector * 16));
+        }
+        for (std::size_t packed = 0; packed < Selected; ++packed) {
+            __m128i value = _mm_shuffle_epi8(image[0], routes[packed][0]);
+            for (std::size_t vector = 1; vector < Stride; ++vector) {
+                value = _mm_or_si128(value, _mm_shuffle_epi8(image[vector], routes[packed][vector]));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + packed * 16),
+                             _mm_and_si128(_mm_srl_epi16(value, shift), low));
+        }
+    }
+}
+
+/**
+ * Writes (value & valueMask) << plane over the image bits that block.keep clears
+ */
+template <std::size_t Stride, std::size_t Selected>
+__attribute__((target("ssse3")))
+void ScatterBlocksSsse3(const BlockRoutes &block, const uint8_t *src, uint8_t *dst, std::size_t blocks, int plane,
+                        uint8_t valueMask) {
+    const __m128i shift = _mm_cvtsi32_si128(plane);
+    const __m128i mask = _mm_set1_epi8(static_cast<char>(valueMask));
+    __m128i routes[Stride][Selected];
+    __m128i keep[Stride];
+    for (std::size_t image = 0; image < Stride; ++image) {
+        for (std::size_t packed = 0; packed < Selected; ++packed) {
+            routes[image][packed] = LoadLanes(block.scatter[image][packed]);
+        }
+        keep[image] = LoadLanes(block.keep[image]);
+    }
+
+    for (std::size_t idx = 0; idx < blocks; ++idx) {
+        const uint8_t *in = src + idx * Selected * 16;
+        uint8_t *out = dst + idx * Stride * 16;
+        // Either all 8 bits at plane 0 or a single bit, which the 16-bit shift keeps within its byte
+        __m128i packed[Selected];
+        for (std::size_t vector = 0; vector < Selected; ++vector) {
+            packed[vector] = _mm_sll_epi16(
+                _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + vector * 16)), mask), shift);
+        }
+        for (std::size_t image = 0; image < Stride; ++image) {
+            __m128i *target = reinterpret_cast<__m128i *>(out + image * 16);
+            __m128i value = _mm_and_si128(_mm_loadu_si128(target), keep[image]);
+            for (std::size_t vector = 0; vector < Selected; ++vector) {
+                value = _mm_or_si128(value, _mm_shuffle_epi8(packed[vector], routes[image][vector]));
+            }
+            _mm_storeu_si128(target, value);
+        }
+    }
+}
+
+/**
+ * Low bytes, high bytes and top bits (already shifted left by one) of 16 packed samples
+ */
+struct SampleBytes {
+    __m128i low;
+    __m128i high;
+    __m128i top;
+};
+
+__attribute__((target("ssse3")))
+inline SampleBytes LoadSamplesSsse3(const uint8_t *values, std::size_t sampleBytes, int highShift) {
+    const __m128i shift = _mm_cvtsi32_si128(highShift);
+    SampleBytes bytes;
+    if (sampleBytes == 1) {
+        bytes.low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+        bytes.high = _mm_setzero_si128();
+        bytes.top = _mm_and_si128(_mm_srl_epi16(bytes.low, shift), _mm_set1_epi8(static_cast<char>(0xFF >> highShift)));
+    } else {
+        const __m128i lowByte = _mm_set1_epi16(0x00FF);
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+        __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + 16));
+        bytes.low = _mm_packus_epi16(_mm_and_si128(first, lowByte), _mm_and_si128(second, lowByte));
+        bytes.high = _mm_packus_epi16(_mm_srli_epi16(first, 8), _mm_srli_epi16(second, 8));
+        bytes.top = _mm_packus_epi16(_mm_srl_epi16(first, shift), _mm_srl_epi16(second, shift));
+    }
+    bytes.top = _mm_add_epi8(bytes.top, bytes.top);
+    return bytes;
+}
+
+/**
+ * One output byte per sample and plane, from whole blocks of 16 packed samples
+ */
+__attribute__((target("ssse3")))
+void ExpandBitsSsse3(const BitRoutes &bits, const uint8_t *values, uint8_t *out, std::size_t blocks,
+                     std::size_t sampleBytes, int highShift) {
+    const __m128i one = _mm_set1_epi8(1);
+    for (std::size_t idx = 0; idx < blocks; ++idx) {
+        SampleBytes samples = LoadSamplesSsse3(values + idx * 16 * sampleBytes, sampleBytes, highShift);
+        for (std::size_t vector = 0; vector < bits.vectors; ++vector) {
+            __m128i repeat = LoadLanes(bits.repeat[vector]);
+            __m128i test = LoadLanes(bits.test[vector]);
+            __m128i lowByte = LoadLanes(bits.lowByte[vector]);
+            __m128i source = _mm_or_si128(_mm_and_si128(_mm_shuffle_epi8(samples.low, repeat), lowByte),
+                                          _mm_andnot_si128(lowByte, _mm_shuffle_epi8(samples.high, repeat)));
+            __m128i bit = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(source, test), test), one);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + (idx * bits.vectors + vector) * 16),
+                             _mm_or_si128(_mm_shuffle_epi8(samples.top, repeat), bit));
+        }
+    }
+}
+
+/**
+ * Writes bit 0 of every output byte back to its plane of the packed samples
+ */
+__attribute__((target("ssse3")))
+void CollapseBitsSsse3(const BitRoutes &bits, const uint8_t *in, uint8_t *values, std::size_t blocks,
+                       std::size_t sampleBytes, uint16_t planes) {
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i set[EmbeddingMask::MAX_BIT_COUNT];
+
+    for (std::size_t idx = 0; idx < blocks; ++idx) {
+        for (std::size_t vector = 0; vector < bits.vectors; ++vector) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + (idx * bits.vectors + vector) * 16));
+            set[vector] = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(bytes, one), one), LoadLanes(bits.test[vector]));
+        }
+        __m128i low = _mm_setzero_si128();
+        __m128i high = _mm_setzero_si128();
+        for (const auto &route : bits.collect) {
+            __m128i collected = _mm_shuffle_epi8(set[route.vector], LoadLanes(route.lanes));
+            if (route.lowByte) {
+                low = _mm_or_si128(low, collected);
+            } else {
+                high = _mm_or_si128(high, collected);
+            }
+        }
+
+        __m128i *samples = reinterpret_cast<__m128i *>(values + idx * 16 * sampleBytes);
+        if (sampleBytes == 1) {
+            __m128i keep = _mm_set1_epi8(static_cast<char>(~planes));
+            _mm_storeu_si128(samples, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(samples), keep), low));
+        } else {
+            __m128i keep = _mm_set1_epi16(static_cast<short>(~planes));
+            _mm_storeu_si128(samples, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(samples), keep),
+                                                   _mm_unpacklo_epi8(low, high)));
+            _mm_storeu_si128(samples + 1, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(samples + 1), keep),
+                                                       _mm_unpackhi_epi8(low, high)));
+        }
+    }
+}
+
+// AVX2 runs two blocks side by side, one per 128-bit lane, since vpshufb cannot cross lanes
+
+__attribute__((target("avx2")))
+inline __m256i LoadPair(const uint8_t *first, const uint8_t *second) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(first))),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(second)), 1);
+}
+
+__attribute__((target("avx2")))
+inline void StorePair(uint8_t *first, uint8_t *second, __m256i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(first), _mm256_castsi256_si128(value));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(second), _mm256_extracti128_si256(value, 1));
+}
+
+__attribute__((target("avx2")))
+inline __m256i LoadLanesAvx2(const Lanes &lanes) {
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes.data())));
+}
+
+template <std::size_t Stride, std::size_t Selected>
+__attribute__((target("avx2")))
+void GatherBlocksAvx2(const BlockRoutes &block, const uint8_t *src, uint8_t *dst, std::size_t blocks, int plane) {
+    const __m128i shift = _mm_cvtsi32_si128(plane);
+    const __m256i low = _mm256_set1_epi8(static_cast<char>(0xFF >> plane));
+    __m256i routes[Selected][Stride];
+    for (std::size_t packed = 0; packed < Selected; ++packed) {
+        for (std::size_t image = 0; image < Stride; ++image) {
+            routes[packed][image] = LoadLanesAvx2(block.gather[packed][image]);
+        }
+    }
+
+    std::size_t idx = 0;
+    for (; idx + 2 <= blocks; idx += 2) {
+        const uint8_t *in = src + idx * Stride * 16;
+        uint8_t *out = dst + idx * Selected * 16;
+        __m256i image[Stride];
+        for (std::size_t vector = 0; vector < Stride; ++vector) {
+            image[vector] = LoadPair(in + vector * 16, in + (Stride + vector) * 16);
+        }
+        for (std::size_t packed = 0; packed < Selected; ++packed) {
+            __m256i value = _mm256_shuffle_epi8(image[0], routes[packed][0]);
+            for (std::size_t vector = 1; vector < Stride; ++vector) {
+                value = _mm256_or_si256(value, _mm256_shuffle_epi8(image[vector], routes[packed][vector]));
+            }
+            StorePair(out + packed * 16, out + (Selected + packed) * 16,
+                      _mm256_and_si256(_mm256_srl_epi16(value, shift), low));
+        }
+    }
+    GatherBlocksSsse3<Stride, Selected>(block, src + idx * Stride * 16, dst + idx * Selected * 16, blocks - idx, plane);
+}
+
+template <std::size_t Stride, std::size_t Selected>
+__attribute__((target("avx2")))
+void ScatterBlocksAvx2(const BlockRoutes &block, const uint8_t *src, uint8_t *dst, std::size_t blocks, int plane,
+                       uint8_t valueMask) {
+    const __m128i shift = _mm_cvtsi32_si128(plane);
+    const __m256i mask = _mm256_set1_epi8(static_cast<char>(valueMask));
+    __m256i routes[Stride][Selected];
+    __m256i keep[Stride];
+    for (std::size_t image = 0; image < Stride; ++image) {
+        for (std::size_t packed = 0; packed < Selected; ++packed) {
+            routes[image][packed] = LoadLanesAvx2(block.scatter[image][packed]);
+        }
+        keep[image] = LoadLanesAvx2(block.keep[image]);
+    }
+
+    std::size_t idx = 0;
+    for (; idx + 2 <= blocks; idx += 2) {
+        const uint8_t *in = src + idx * Selected * 16;
+        uint8_t *out = dst + idx * Stride * 16;
+        __m256i packed[Selected];
+        for (std::size_t vector = 0; vector < Selected; ++vector) {
+            packed[vector] = _mm256_sll_epi16(
+                _mm256_and_si256(LoadPair(in + vector * 16, in + (Selected + vector) * 16), mask), shift);
+        }
+        for (std::size_t image = 0; image < Stride; ++image) {
+            uint8_t *first = out + image * 16;
+            uint8_t *second = out + (Stride + image) * 16;
+            __m256i value = _mm256_and_si256(LoadPair(first, second), keep[image]);
+            for (std::size_t vector = 0; vector < Selected; ++vector) {
+                value = _mm256_or_si256(value, _mm256_shuffle_epi8(packed[vector], routes[image][vector]));
+            }
+            StorePair(first, second, value);
+        }
+    }
+    ScatterBlocksSsse3<Stride, Selected>(block, src + idx * Selected * 16, dst + idx * Stride * 16, blocks - idx,
+                                         plane, valueMask);
+}
+
+__attribute__((target("avx2")))
+void ExpandBitsAvx2(const BitRoutes &bits, const uint8_t *values, uint8_t *out, std::size_t blocks,
+                    std::size_t sampleBytes, int highShift) {
+    const __m128i shift = _mm_cvtsi32_si128(highShift);
+    const __m256i one = _mm256_set1_epi8(1);
+    const std::size_t outBytes = bits.vectors * 16;
+
+    std::size_t idx = 0;
+    for (; idx + 2 <= blocks; idx += 2) {
+        // 32 samples: the first block in the low lane, the second in the high lane
+        __m256i low;
+        __m256i high;
+        __m256i top;
+        if (sampleBytes == 1) {
+            low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + idx * 16));
+            high = _mm256_setzero_si256();
+            top = _mm256_and_si256(_mm256_srl_epi16(low, shift), _mm256_set1_epi8(static_cast<char>(0xFF >> highShift)));
+        } else {
+            const __m256i lowByte = _mm256_set1_epi16(0x00FF);
+            __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + idx * 32));
+            __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + idx * 32 + 32));
+            // packus works within lanes: pair the halves of each block first
+            __m256i front = _mm256_permute2x128_si256(first, second, 0x20);
+            __m256i back = _mm256_permute2x128_si256(first, second, 0x31);
+            low = _mm256_packus_epi16(_mm256_and_si256(front, lowByte), _mm256_and_si256(back, lowByte));
+            high = _mm256_packus_epi16(_mm256_srli_epi16(front, 8), _mm256_srli_epi16(back, 8));
+            top = _mm256_packus_epi16(_mm256_srl_epi16(front, shift), _mm256_srl_epi16(back, shift));
+        }
+        top = _mm256_add_epi8(top, top);
+
+        uint8_t *dst = out + idx * outBytes;
+        for (std::size_t vector = 0; vector < bits.vectors; ++vector) {
+            __m256i repeat = LoadLanesAvx2(bits.repeat[vector]);
+            __m256i test = LoadLanesAvx2(bits.test[vector]);
+            __m256i lowByte = LoadLanesAvx2(bits.lowByte[vector]);
+            __m256i source = _mm256_or_si256(_mm256_and_si256(_mm256_shuffle_epi8(low, repeat), lowByte),
+                                             _mm256_andnot_si256(lowByte, _mm256_shuffle_epi8(high, repeat)));
+            __m256i bit = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(source, test), test), one);
+            StorePair(dst + vector * 16, dst + outBytes + vector * 16,
+                      _mm256_or_si256(_mm256_shuffle_epi8(top, repeat), bit));
+        }
+    }
+    ExpandBitsSsse3(bits, values + idx * 16 * sampleBytes, out + idx * outBytes, blocks - idx, sampleBytes, highShift);
+}
+
+__attribute__((target("avx2")))
+void CollapseBitsAvx2(const BitRoutes &bits, const uint8_t *in, uint8_t *values, std::size_t blocks,
+                      std::size_t sampleBytes, uint16_t planes) {
+    const __m256i one = _mm256_set1_epi8(1);
+    const std::size_t inBytes = bits.vectors * 16;
+    __m256i set[EmbeddingMask::MAX_BIT_COUNT];
+
+    std::size_t idx = 0;
+    for (; idx + 2 <= blocks; idx += 2) {
+        const uint8_t *src = in + idx * inBytes;
+        for (std::size_t vector = 0; vector < bits.vectors; ++vector) {
+            __m256i bytes = LoadPair(src + vector * 16, src + inBytes + vector * 16);
+            set[vector] = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(bytes, one), one),
+                                           LoadLanesAvx2(bits.test[vector]));
+        }
+        __m256i low = _mm256_setzero_si256();
+        __m256i high = _mm256_setzero_si256();
+        for (const auto &route : bits.collect) {
+            __m256i collected = _mm256_shuffle_epi8(set[route.vector], LoadLanesAvx2(route.lanes));
+            if (route.lowByte) {
+                low = _mm256_or_si256(low, collected);
+            } else {
+                high = _mm256_or_si256(high, collected);
+            }
+        }
+
+        if (sampleBytes == 1) {
+            __m256i *samples = reinterpret_cast<__m256i *>(values + idx * 16);
+            __m256i keep = _mm256_set1_epi8(static_cast<char>(~planes));
+            _mm256_storeu_si256(samples, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(samples), keep), low));
+        } else {
+            // Words 0-7 of both blocks, then words 8-15
+            uint8_t *samples = values + idx * 32;
+            __m256i keep = _mm256_set1_epi16(static_cast<short>(~planes));
+            __m256i front = _mm256_and_si256(LoadPair(samples, samples + 32), keep);
+            __m256i back = _mm256_and_si256(LoadPair(samples + 16, samples + 48), keep);
+            StorePair(samples, samples + 32, _mm256_or_si256(front, _mm256_unpacklo_epi8(low, high)));
+            StorePair(samples + 16, samples + 48, _mm256_or_si256(back, _mm256_unpackhi_epi8(low, high)));
+        }
+    }
+    CollapseBitsSsse3(bits, in + idx * inBytes, values + idx * 16 * sampleBytes, blocks - idx, sampleBytes, planes);
+}
+
+#endif
+
+#ifdef STEGTOOL_X86_SIMD
+
+using GatherBlocksFn = void (*)(const BlockRoutes &, const uint8_t *, uint8_t *, std::size_t, int);
+using ScatterBlocksFn = void (*)(const BlockRoutes &, const uint8_t *, uint8_t *, std::size_t, int, uint8_t);
+
+struct MaskKernels {
+    GatherBlocksFn gather[EmbeddingMask::MAX_CHANNELS][EmbeddingMask::MAX_CHANNELS];  // [stride - 1][selected - 1]
+    ScatterBlocksFn scatter[EmbeddingMask::MAX_CHANNELS][EmbeddingMask::MAX_CHANNELS];
+    void (*expand)(const BitRoutes &, const uint8_t *, uint8_t *, std::size_t, std::size_t, int);
+    void (*collapse)(const BitRoutes &, const uint8_t *, uint8_t *, std::size_t, std::size_t, uint16_t);
+
+    GatherBlocksFn Gather(const SampleLayout &layout) const {
+        return gather[layout.stride - 1][layout.offsets.size() - 1];
+    }
+
+    ScatterBlocksFn Scatter(const SampleLayout &layout) const {
+        return scatter[layout.stride - 1][layout.offsets.size() - 1];
+    }
+};
+
+const MaskKernels SSSE3_KERNELS = {
+    {{GatherBlocksSsse3<1, 1>},
+     {GatherBlocksSsse3<2, 1>, GatherBlocksSsse3<2, 2>},
+     {GatherBlocksSsse3<3, 1>, GatherBlocksSsse3<3, 2>, GatherBlocksSsse3<3, 3>},
+     {GatherBlocksSsse3<4, 1>, GatherBlocksSsse3<4, 2>, GatherBlocksSsse3<4, 3>, GatherBlocksSsse3<4, 4>}},
+    {{ScatterBlocksSsse3<1, 1>},
+     {ScatterBlocksSsse3<2, 1>, ScatterBlocksSsse3<2, 2>},
+     {ScatterBlocksSsse3<3, 1>, ScatterBlocksSsse3<3, 2>, ScatterBlocksSsse3<3, 3>},
+     {ScatterBlocksSsse3<4, 1>, ScatterBlocksSsse3<4, 2>, ScatterBlocksSsse3<4, 3>, ScatterBlocksSsse3<4, 4>}},
+    ExpandBitsSsse3,
+    CollapseBitsSsse3};
+
+const MaskKernels AVX2_KERNELS = {
+    {{GatherBlocksAvx2<1, 1>},
+     {GatherBlocksAvx2<2, 1>, GatherBlocksAvx2<2, 2>},
+     {GatherBlocksAvx2<3, 1>, GatherBlocksAvx2<3, 2>, GatherBlocksAvx2<3, 3>},
+     {GatherBlocksAvx2<4, 1>, GatherBlocksAvx2<4, 2>, GatherBlocksAvx2<4, 3>, GatherBlocksAvx2<4, 4>}},
+    {{ScatterBlocksAvx2<1, 1>},
+     {ScatterBlocksAvx2<2, 1>, ScatterBlocksAvx2<2, 2>},
+     {ScatterBlocksAvx2<3, 1>, ScatterBlocksAvx2<3, 2>, ScatterBlocksAvx2<3, 3>},
+     {ScatterBlocksAvx2<4, 1>, ScatterBlocksAvx2<4, 2>, ScatterBlocksAvx2<4, 3>, ScatterBlocksAvx2<4, 4>}},
+    ExpandBitsAvx2,
+    CollapseBitsAvx2};
+
+const MaskKernels *SelectMaskKernels() {
+    switch (CpuFeatures::GetSimdLevel()) {
+        case SimdLevel::Avx2: return &AVX2_KERNELS;
+        case SimdLevel::Ssse3: return &SSSE3_KERNELS;
+        case SimdLevel::Portable: break;
+    }
+    return nullptr;
+}
+
+// Kernels for the layout, or nullptr to take the portable path
+const MaskKernels *VectorKernels(const SampleLayout &layout) {
+    return layout.stride <= EmbeddingMask::MAX_CHANNELS ? SelectMaskKernels() : nullptr;
+}
+
+// Selected samples of pixels [first, last) to and from a packed buffer starting at pixel 'first'
+template <typename T>
+void PackPixels(const SampleLayout &layout, const T *src, T *dst, std::size_t first, std::size_t last) {
+    std::size_t selected = layout.offsets.size();
+    for (std::size_t pixel = first; pixel < last; ++pixel) {
+        for (std::size_t idx = 0; idx < selected; ++idx) {
+            dst[(pixel - first) * selected + idx] = src[pixel * layout.stride + layout.offsets[idx]];
+        }
+    }
+}
+
+template <typename T>
+void UnpackPixels(const SampleLayout &layout, const T *src, T *dst, std::size_t first, std::size_t last) {
+    std::size_t selected = layout.offsets.size();
+    for (std::size_t pixel = first; pixel < last; ++pixel) {
+        for (std::size_t idx = 0; idx < selected; ++idx) {
+            dst[pixel * layout.stride + layout.offsets[idx]] = src[(pixel - first) * selected + idx];
+        }
+    }
+}
+
+// Multi-bit path: every chunk of pixels is packed with the byte routes, then
+// expanded to (or collapsed from) one byte per bit
+template <typename T>
+void GatherBitsVector(const MaskKernels &kernels, const SampleLayout &layout, const T *src, uint8_t *dst,
+                      int planeBegin, int planeCount) {
+    const std::size_t selected = layout.offsets.size();
+    const std::size_t perSample = static_cast<std::size_t>(planeCount);
+    const int planeEnd = planeBegin + planeCount;
+    const int highShift = HighShift<T>(planeEnd);
+    const BlockRoutes block = BuildRoutes(layout, sizeof(T), 0x00);
+    const BitRoutes bits = BuildBitRoutes(planeBegin, planeCount);
+    std::vector<T> packed(CHUNK_PIXELS * selected);
+
+    for (std::size_t first = 0; first < layout.pixelCount; first += CHUNK_PIXELS) {
+        std::size_t pixels = std::min(CHUNK_PIXELS, layout.pixelCount - first);
+        std::size_t blocks = pixels / block.pixels;
+        kernels.Gather(layout)(block, reinterpret_cast<const uint8_t *>(src + first * layout.stride),
+                       reinterpret_cast<uint8_t *>(packed.data()), blocks, 0);
+        PackPixels(layout, src, packed.data() + blocks * block.pixels * selected,
+                   first + blocks * block.pixels, first + pixels);
+
+        std::size_t samples = pixels * selected;
+        std::size_t sampleBlocks = samples / 16;
+        uint8_t *out = dst + first * selected * perSample;
+        kernels.expand(bits, reinterpret_cast<const uint8_t *>(packed.data()), out, sampleBlocks, sizeof(T), highShift);
+        for (std::size_t sample = sampleBlocks * 16; sample < samples; ++sample) {
+            ExpandSample(packed[sample], out + sample * perSample, planeBegin, planeEnd, highShift);
+        }
+    }
+}
+
+template <typename T>
+void ScatterBitsVector(const MaskKernels &kernels, const SampleLayout &layout, const uint8_t *src, T *dst,
+                       int planeBegin, int planeCount) {
+    const std::size_t selected = layout.offsets.size();
+    const std::size_t perSample = static_cast<std::size_t>(planeCount);
+    const int planeEnd = planeBegin + planeCount;
+    const uint16_t planes = static_cast<uint16_t>(((1u << planeCount) - 1) << planeBegin);
+    const BlockRoutes block = BuildRoutes(layout, sizeof(T), 0x00);
+    const BitRoutes bits = BuildBitRoutes(planeBegin, planeCount);
+    std::vector<T> packed(CHUNK_PIXELS * selected);
+
+    for (std::size_t first = 0; first < layout.pixelCount; first += CHUNK_PIXELS) {
+        std::size_t pixels = std::min(CHUNK_PIXELS, layout.pixelCount - first);
+        std::size_t blocks = pixels / block.pixels;
+        std::size_t tail = first + blocks * block.pixels;
+        uint8_t *image = reinterpret_cast<uint8_t *>(dst + first * layout.stride);
+        kernels.Gather(layout)(block, image, reinterpret_cast<uint8_t *>(packed.data()), blocks, 0);
+        PackPixels(layout, dst, packed.data() + blocks * block.pixels * selected, tail, first + pixels);
+
+        std::size_t samples = pixels * selected;
+        std::size_t sampleBlocks = samples / 16;
+        const uint8_t *in = src + first * selected * perSample;
+        kernels.collapse(bits, in, reinterpret_cast<uint8_t *>(packed.data()), sampleBlocks, sizeof(T), planes);
+        for (std::size_t sample = sampleBlocks * 16; sample < samples; ++sample) {
+            packed[sample] = CollapseSample(packed[sample], in + sample * perSample, planeBegin, planeEnd);
+        }
+
+        kernels.Scatter(layout)(block, reinterpret_cast<const uint8_t *>(packed.data()), image, blocks, 0, 0xFF);
+        UnpackPixels(layout, packed.data() + blocks * block.pixels * selected, dst, tail, first + pixels);
+    }
+}
+
+#endif
+
+void GatherSamples(const SampleLayout &layout, const uint8_t *src, uint8_t *dst, int plane) {
+    std::size_t selected = layout.offsets.size();
+
+#ifdef STEGTOOL_X86_SIMD
+    if (const MaskKernels *kernels = VectorKernels(layout)) {
+        BlockRoutes block = BuildRoutes(layout, 1, 0x00);
+        std::size_t blocks = layout.pixelCount / block.pixels;
+        kernels->Gather(layout)(block, src, dst, blocks, plane);
+        GatherPixels(layout, src, dst, blocks * block.pixels, plane);
+        return;
+    }
+#endif
+
+    if (selected == layout.stride) {
+        // Every channel: contiguous
+        GatherStrided<1>(src, dst, layout.pixelCount * layout.stride, plane);
+    } else if (selected == 1) {
+        const uint8_t *channel = src + layout.offsets[0];
+        switch (layout.stride) {
+            case 2: GatherStrided<2>(channel, dst, layout.pixelCount, plane); break;
+            case 3: GatherStrided<3>(channel, dst, layout.pixelCount, plane); break;
+            default: GatherStrided<4>(channel, dst, layout.pixelCount, plane); break;
+        }
+    } else if (IsRGBOfRGBA(layout)) {
+        GatherRGBOfRGBA(src, dst, layout.pixelCount, plane);
+    } else {
+        GatherPixels(layout, src, dst, 0, plane);
+    }
+}
+
+void ScatterSamples(const SampleLayout &layout, const uint8_t *src, uint8_t *dst, int plane) {
+    std::size_t selected = layout.offsets.size();
+
+    // Plane 0 writes the whole sample back (so +-1 methods work), higher planes only their bit
+    uint8_t keepMask = (plane == 0) ? 0x00 : static_cast<uint8_t>(~(1u << plane));
+    uint8_t valueMask = (plane == 0) ? 0xFF : 0x01;
+
+#ifdef STEGTOOL_X86_SIMD
+    if (const MaskKernels *kernels = VectorKernels(layout)) {
+        BlockRoutes block = BuildRoutes(layout, 1, keepMask);
+        std::size_t blocks = layout.pixelCount / block.pixels;
+        kernels->Scatter(layout)(block, src, dst, blocks, plane, valueMask);
+        ScatterPixels(layout, src, dst, blocks * block.pixels, plane, keepMask, valueMask);
+        return;
+    }
+#endif
+
+    if (selected == layout.stride) {
+        ScatterStrided<1>(src, dst, layout.pixelCount * layout.stride, plane, keepMask, valueMask);
+    } else if (selected == 1) {
+        uint8_t *channel = dst + layout.offsets[0];
+        switch (layout.stride) {
+            case 2: ScatterStrided<2>(src, channel, layout.pixelCount, plane, keepMask, valueMask); break;
+            case 3: ScatterStrided<3>(src, channel, layout.pixelCount, plane, keepMask, valueMask); break;
+            default: ScatterStrided<4>(src, channel, layout.pixelCount, plane, keepMask, valueMask); break;
+        }
+    } else if (IsRGBOfRGBA(layout)) {
+        ScatterRGBOfRGBA(src, dst, layout.pixelCount, plane, keepMask, valueMask);
+    } else {
+        ScatterPixels(layout, src, dst, 0, plane, keepMask, valueMask);
+    }
+}
+
+template <typename T>
+void GatherBits(const SampleLayout &layout, const T *src, uint8_t *dst, int planeBegin, int planeCount) {
+#ifdef STEGTOOL_X86_SIMD
+    if (const MaskKernels *kernels = VectorKernels(layout)) {
+        GatherBitsVector(*kernels, layout, src, dst, planeBegin, planeCount);
+        return;
+    }
+#endif
+    GatherBitsScalar(layout, src, dst, planeBegin, planeCount);
+}
+
+template <typename T>
+void ScatterBits(const SampleLayout &layout, const uint8_t *src, T *dst, int planeBegin, int planeCount) {
+#ifdef STEGTOOL_X86_SIMD
+    if (const MaskKernels *kernels = VectorKernels(layout)) {
+        ScatterBitsVector(*kernels, layout, src, dst, planeBegin, planeCount);
+        return;
+    }
+#endif
+    ScatterBitsScalar(layout, src, dst, planeBegin, planeCount);
+}
+
+template <typename T>
+T EmbeddingPlanes(const EmbeddingMask &mask) {
+    uint32_t planes = ((1u << mask.bitCount) - 1) << mask.bitPlane;
+    return static_cast<T>(planes);
+}
+
+// Samples with any embedding bit set become full intensity, others 0
+template <typename T>
+void MarkEmbeddingPlanes(BasicImageData<T> &imageData, const EmbeddingMask &mask) {
+    const T planes = EmbeddingPlanes<T>(mask);
+    for (auto &value : imageData.pixels) {
+        value = (value & planes) ? static_cast<T>(~T(0)) : T(0);
+    }
+}
+
+// Keep the brightest sample of every scale x scale block, per channel
+template <typename T>
+BasicImageData<T> DownscaleMax(const BasicImageData<T> &image, int scale) {
+    // Rounded up without forming width + scale, which overflows for huge scales
+    int width = (image.width - 1) / scale + 1;
+    int height = (image.height - 1) / scale + 1;
+    std::size_t channels = static_cast<std::size_t>(image.channels);
+    BasicImageData<T> reduced(std::vector<T>(static_cast<std::size_t>(width) * height * channels),
+                              width, height, image.channels);
+
+    Parallel::For(static_cast<std::size_t>(height), [&](std::size_t outRow) {
+        T *out = reduced.pixels.data() + outRow * width * channels;
+        std::size_t rowEnd = std::min(static_cast<std::size_t>(image.height), (outRow + 1) * scale);
+        for (std::size_t row = outRow * scale; row < rowEnd; ++row) {
+            const T *in = image.pixels.data() + row * image.width * channels;
+            for (std::size_t x = 0; x < static_cast<std::size_t>(image.width); ++x) {
+                T *pixel = out + (x / scale) * channels;
+                for (std::size_t channel = 0; channel < channels; ++channel) {
+                    pixel[channel] = std::max(pixel[channel], in[x * channels + channel]);
+                }
+            }
+        }
+    });
+    return reduced;
+}
+
+/**
+ * Embedding map from per-sample marks: a pixel channel is 255 when any of its selected
+ * bit planes carries a payload bit. With the default mask the marks already are the map.
+ */
+ImageData RenderPositionMap(std::vector<uint8_t> marks, const SampleLayout &layout, int width, int height,
+                            int bitCount, int scale) {
+    std::size_t perPixel = layout.offsets.size() * static_cast<std::size_t>(bitCount);
+    int channels = static_cast<int>(layout.stride);
+
+    ImageData map;
+    if (perPixel == layout.stride && bitCount == 1) {
+        map = ImageData(std::move(marks), width, height, channels);
+    } else {
+        map = ImageData(std::vector<uint8_t>(layout.pixelCount * layout.stride), width, height, channels);
+        Parallel::For(static_cast<std::size_t>(height), [&](std::size_t row) {
+            std::size_t first = row * static_cast<std::size_t>(width);
+            for (std::size_t pixel = first; pixel < first + static_cast<std::size_t>(width); ++pixel) {
+                const uint8_t *sampleMarks = marks.data() + pixel * perPixel;
+                uint8_t *out = map.pixels.data() + pixel * layout.stride;
+                for (std::size_t idx = 0; idx < layout.offsets.size(); ++idx) {
+                    uint8_t any = 0;
+                    for (int plane = 0; plane < bitCount; ++plane) {
+                        any |= sampleMarks[idx * bitCount + plane];
+                    }
+                    out[layout.offsets[idx]] = any;
+                }
+            }
+        });
+    }
+    return scale > 1 ? DownscaleMax(map, scale) : map;
+}
+
+} // namespace
+
+Result<EmbeddingMask> EmbeddingMask::Parse(const std::string &channelSpec, int bitPlane, int bitCount) {
+    if (channelSpec.empty()) {
+        return Result<EmbeddingMask>(ErrorCode::InvalidArgument, "Channel selection is empty");
+    }
+    if (bitPlane < 0 || bitPlane > MAX_BIT_PLANE) {
+        std::ostringstream oss;
+        oss << "Invalid bit plane " << bitPlane << " (supported: 0 to " << MAX_BIT_PLANE << ")";
+        return Result<EmbeddingMask>(ErrorCode::InvalidArgument, oss.str());
+    }
+    if (bitCount < 1 || bitCount > MAX_BIT_COUNT) {
+        std::ostringstream oss;
+        oss << "Invalid bit count " << bitCount << " (supported: 1 to " << MAX_BIT_COUNT << ")";
+        return Result<EmbeddingMask>(ErrorCode::InvalidArgument, oss.str());
+    }
+
+    EmbeddingMask mask;
+    mask.channels = 0;
+    mask.bitPlane = bitPlane;
+    mask.bitCount = bitCount;
+    for (char c : channelSpec) {
+        switch (std::tolower(static_cast<unsigned char>(c))) {
+            case 'r': case '0': mask.channels |= 0x01; break;
+            case 'g': case '1': mask.channels |= 0x02; break;
+            case 'b': case '2': mask.channels |= 0x04; break;
+            case 'a': case '3': mask.channels |= 0x08; break;
+            default:
+                return Result<EmbeddingMask>(
+                    ErrorCode::InvalidArgument,
+                    "Invalid channel selection \"" + channelSpec + "\" (use letters r, g, b, a or indexes 0-3)"
+                );
+        }
+    }
+    return Result<EmbeddingMask>(mask);
+}
 
 std::size_t LSBStegoHandler::CalculateCapacity(std::size_t pixelCount, std::size_t headerBits) {
     if (pixelCount <= headerBits) {
@@ -45,18 +1000,356 @@ Result<> LSBStegoHandler::ValidateCapacity(std::size_t pixelCount, std::size_t d
     return Result<>();
 }
 
-Result<> LSBStegoHandler::VisualizeMethod(ImageData &imageData) {
+std::size_t LSBStegoHandler::CountSamples(const ImageData &header) const {
+    std::size_t channels = 0;
+    for (int channel = 0; channel < header.channels && channel < EmbeddingMask::MAX_CHANNELS; ++channel) {
+        channels += (mask_.channels >> channel) & 1u;
+    }
+    return static_cast<std::size_t>(header.width) * header.height * channels * static_cast<std::size_t>(mask_.bitCount);
+}
+
+std::size_t LSBStegoHandler::EstimateEmbedMemory(const ImageData &header, std::size_t sampleBytes,
+                                                 std::size_t dataBytes) const {
+    std::size_t estimate = StegoHandler::EstimateEmbedMemory(header, sampleBytes, dataBytes);
+    // Masks and 16-bit images embed into a gathered copy of the samples
+    if (!mask_.IsDefault() || sampleBytes != sizeof(uint8_t)) {
+        estimate += CountSamples(header);
+    }
+    return estimate;
+}
+
+template <typename T>
+Result<> LSBStegoHandler::EmbedImage(BasicImageData<T> &imageData,
+                                     const std::vector<uint8_t> &dataToEmbed,
+                                     const std::string &password) {
+
+    constexpr bool EIGHT_BIT = std::is_same<T, uint8_t>::value;
+    if (RequiresWholeSamples() && !(EIGHT_BIT && mask_.bitPlane == 0 && mask_.bitCount == 1)) {
+        return Result<>(ErrorCode::InvalidArgument, "This method only supports bit plane 0 of 8-bit images");
+    }
+
+    auto layoutResult = ResolveLayout(mask_, imageData);
+    if (!layoutResult) {
+        return Result<>(layoutResult.GetErrorCode(), layoutResult.GetErrorMessage());
+    }
+    const auto &layout = layoutResult.GetValue();
+    std::size_t perPixel = layout.offsets.size() * static_cast<std::size_t>(mask_.bitCount);
+
+    ImageData samples(std::vector<uint8_t>(layout.pixelCount * perPixel),
+                      imageData.width, imageData.height, static_cast<int>(perPixel));
+
+    if constexpr (EIGHT_BIT) {
+        if (mask_.bitCount == 1) {
+            GatherSamples(layout, imageData.pixels.data(), samples.pixels.data(), mask_.bitPlane);
+            auto embedResult = EmbedSamples(samples, dataToEmbed, password);
+            if (!embedResult) {
+                return embedResult;
+            }
+            ScatterSamples(layout, samples.pixels.data(), imageData.pixels.data(), mask_.bitPlane);
+            return Result<>();
+        }
+    }
+
+    GatherBits(layout, imageData.pixels.data(), samples.pixels.data(), mask_.bitPlane, mask_.bitCount);
+    auto embedResult = EmbedSamples(samples, dataToEmbed, password);
+    if (!embedResult) {
+        return embedResult;
+    }
+    ScatterBits(layout, samples.pixels.data(), imageData.pixels.data(), mask_.bitPlane, mask_.bitCount);
+    return Result<>();
+}
+
+template <typename T>
+Result<std::vector<uint8_t>> LSBStegoHandler::ExtractImage(const BasicImageData<T> &imageData,
+                                                           const std::string &password) {
+
+    auto layoutResult = ResolveLayout(mask_, imageData);
+    if (!layoutResult) {
+        return Result<std::vector<uint8_t>>(layoutResult.GetErrorCode(), layoutResult.GetErrorMessage());
+    }
+    const auto &layout = layoutResult.GetValue();
+    std::size_t perPixel = layout.offsets.size() * static_cast<std::size_t>(mask_.bitCount);
+
+    ImageData samples(std::vector<uint8_t>(layout.pixelCount * perPixel),
+                      imageData.width, imageData.height, static_cast<int>(perPixel));
+
+    bool gathered = false;
+    if constexpr (std::is_same<T, uint8_t>::value) {
+        if (mask_.bitCount == 1) {
+            GatherSamples(layout, imageData.pixels.data(), samples.pixels.data(), mask_.bitPlane);
+            gathered = true;
+        }
+    }
+    if (!gathered) {
+        GatherBits(layout, imageData.pixels.data(), samples.pixels.data(), mask_.bitPlane, mask_.bitCount);
+    }
+
+    if (IsCancelled()) {
+        return Result<std::vector<uint8_t>>(ErrorCode::OperationCancelled, "Extraction cancelled");
+    }
+    return ExtractSamples(samples, password);
+}
+
+template <typename T>
+Result<> LSBStegoHandler::VisualImage(BasicImageData<T> &imageData,
+                                      const std::string &dataFile,
+                                      const std::string &outputFile,
+                                      const std::string &password) {
+
+    if (VisualizeOnCover()) {
+        // Clearing the embedding planes leaves only the written 1 bits set
+        const T planes = EmbeddingPlanes<T>(mask_);
+        for (auto &value : imageData.pixels) {
+            value = static_cast<T>(value & ~planes);
+        }
+    } else {
+        std::fill(imageData.pixels.begin(), imageData.pixels.end(), T(0));
+    }
+
+    auto encryptResult = LoadEncryptedData(dataFile, password);
+    if (!encryptResult) {
+        return Result<>(encryptResult.GetErrorCode(), encryptResult.GetErrorMessage());
+    }
+
+    auto embedResult = EmbedMethod(imageData, encryptResult.GetValue(), password);
+    if (!embedResult) {
+        return embedResult;
+    }
+
+    MarkEmbeddingPlanes(imageData, mask_);
+    if (visualScale_ > 1) {
+        return ImageIO::Save(outputFile, DownscaleMax(imageData, visualScale_));
+    }
+    return ImageIO::Save(outputFile, imageData);
+}
+
+Result<> LSBStegoHandler::EmbedMethod(ImageData &imageData,
+                                      const std::vector<uint8_t> &dataToEmbed,
+                                      const std::string &password) {
     
-    auto &pixels = imageData.pixels;
-    std::size_t imgSize = pixels.size();
+    OperationScope scope(*this);
+    StageTimer timer(Stats::Stage::Embed, dataToEmbed.size());
+    Stats::Add(Stats::Counter::SamplesTouched, imageData.pixels.size());
+
+    // Whole image: samples are the pixels themselves
+    if (mask_.IsDefault()) {
+        return EmbedSamples(imageData, dataToEmbed, password);
+    }
+    return EmbedImage(imageData, dataToEmbed, password);
+}
+
+Result<> LSBStegoHandler::EmbedMethod(ImageData16 &imageData,
+                                      const std::vector<uint8_t> &dataToEmbed,
+                                      const std::string &password) {
+    OperationScope scope(*this);
+    StageTimer timer(Stats::Stage::Embed, dataToEmbed.size());
+    Stats::Add(Stats::Counter::SamplesTouched, imageData.pixels.size());
+    return EmbedImage(imageData, dataToEmbed, password);
+}
+
+Result<std::vector<uint8_t>> LSBStegoHandler::ExtractMethod(const ImageData &imageData,
+                                                            const std::string &password) {
+    
+    if (IsCancelled()) {
+        return Result<std::vector<uint8_t>>(ErrorCode::OperationCancelled, "Extraction cancelled");
+    }
+
+    StageTimer timer(Stats::Stage::Extract);
+    Stats::Add(Stats::Counter::SamplesTouched, imageData.pixels.size());
+
+    // Whole image: samples are the pixels themselves
+    if (mask_.IsDefault()) {
+        return ExtractSamples(imageData, password);
+    }
+    return ExtractImage(imageData, password);
+}
+
+Result<std::vector<uint8_t>> LSBStegoHandler::ExtractMethod(const ImageData16 &imageData,
+                                                            const std::string &password) {
+    StageTimer timer(Stats::Stage::Extract);
+    Stats::Add(Stats::Counter::SamplesTouched, imageData.pixels.size());
+    return ExtractImage(imageData, password);
+}
+
+Result<> LSBStegoHandler::Embed(const std::string &coverFile,
+                                const std::string &dataFile,
+                                const std::string &outputFile,
+                                const std::string &password) {
+
+    if (!ImageIO::Is16Bit(coverFile)) {
+        return StegoHandler::Embed(coverFile, dataFile, outputFile, password);
+    }
+
+    auto memoryCheck = CheckMemoryLimit(coverFile, dataFile, sizeof(uint16_t));
+    if (!memoryCheck) {
+        return memoryCheck;
+    }
+
+    // Keep 16-bit covers at full precision
+    auto imageResult = ImageIO::Load16(coverFile);
+    if (!imageResult) {
+        return Result<>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
+    }
+
+    auto imageData = std::move(imageResult.GetValue());
+
+    auto encryptResult = LoadEncryptedData(dataFile, password);
+    if (!encryptResult) {
+        return Result<>(encryptResult.GetErrorCode(), encryptResult.GetErrorMessage());
+    }
+
+    auto embedResult = EmbedMethod(imageData, encryptResult.GetValue(), password);
+    if (!embedResult) {
+        return embedResult;
+    }
+
+    return ImageIO::Save(outputFile, imageData);
+}
+
+Result<> LSBStegoHandler::Extract(const std::string &stegoFile,
+                                  const std::string &outputFile,
+                                  const std::string &password) {
+
+    if (!ImageIO::Is16Bit(stegoFile)) {
+        return StegoHandler::Extract(stegoFile, outputFile, password);
+    }
+
+    auto imageResult = ImageIO::Load16(stegoFile);
+    if (!imageResult) {
+        return Result<>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
+    }
+
+    auto extractResult = ExtractMethod(imageResult.GetValue(), password);
+    if (!extractResult) {
+        return Result<>(
+            extractResult.GetErrorCode(),
+            "Extraction failed: " + extractResult.GetErrorMessage()
+        );
+    }
+
+    return SaveDecryptedData(extractResult.GetValue(), outputFile, password);
+}
+
+Result<> LSBStegoHandler::Visual(const std::string &coverFile,
+                                 const std::string &dataFile,
+                                 const std::string &outputFile,
+                                 const std::string &password) {
+
+    const bool sixteenBit = ImageIO::Is16Bit(coverFile);
+    auto memoryCheck = CheckMemoryLimit(coverFile, dataFile, sixteenBit ? sizeof(uint16_t) : sizeof(uint8_t));
+    if (!memoryCheck) {
+        return memoryCheck;
+    }
+
+    if (visualMode_ == VisualMode::Map && HasPositionMap()) {
+        return VisualPositions(coverFile, dataFile, outputFile, password, sixteenBit);
+    }
 
-    for (std::size_t byteIdx = 0; byteIdx < imgSize; ++byteIdx) {
-        if (pixels[byteIdx] & 0x01) {
-            pixels[byteIdx] = (uint8_t)255; 
+    if (sixteenBit) {
+        auto imageResult = ImageIO::Load16(coverFile);
+        if (!imageResult) {
+            return Result<>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
+        }
+        auto imageData = std::move(imageResult.GetValue());
+        if (visualMode_ != VisualMode::Map) {
+            return VisualCompare(imageData, dataFile, outputFile, password);
         }
-        else {
-            pixels[byteIdx] = (uint8_t)0;
-        }   
+        return VisualImage(imageData, dataFile, outputFile, password);
+    }
+
+    auto imageResult = ImageIO::Load(coverFile);
+    if (!imageResult) {
+        return Result<>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
+    }
+    auto imageData = std::move(imageResult.GetValue());
+    if (visualMode_ != VisualMode::Map) {
+        return VisualCompare(imageData, dataFile, outputFile, password);
+    }
+    return VisualImage(imageData, dataFile, outputFile, password);
+}
+
+template <typename T>
+Result<> LSBStegoHandler::VisualCompare(const BasicImageData<T> &cover,
+                                        const std::string &dataFile,
+                                        const std::string &outputFile,
+                                        const std::string &password) {
+
+    auto layoutResult = ResolveLayout(mask_, cover);
+    if (!layoutResult) {
+        return Result<>(layoutResult.GetErrorCode(), layoutResult.GetErrorMessage());
+    }
+    const int bitsPerPixel = static_cast<int>(layoutResult.GetValue().offsets.size()) * mask_.bitCount;
+
+    auto encryptResult = LoadEncryptedData(dataFile, password);
+    if (!encryptResult) {
+        return Result<>(encryptResult.GetErrorCode(), encryptResult.GetErrorMessage());
     }
+
+    // The real embedding, so methods that pick positions or change values by content show as they are
+    BasicImageData<T> stego = cover;
+    auto embedResult = EmbedMethod(stego, encryptResult.GetValue(), password);
+    if (!embedResult) {
+        return embedResult;
+    }
+
+    auto mapResult = visualMode_ == VisualMode::Diff
+        ? ImageDiff::Difference(cover, stego, visualScale_)
+        : ImageDiff::Heatmap(cover, stego, EmbeddingPlanes<T>(mask_), bitsPerPixel, visualScale_);
+    if (!mapResult) {
+        return Result<>(mapResult.GetErrorCode(), mapResult.GetErrorMessage());
+    }
+    return ImageIO::Save(outputFile, mapResult.GetValue());
+}
+
+Result<> LSBStegoHandler::VisualPositions(const std::string &coverFile,
+                                          const std::string &dataFile,
+                                          const std::string &outputFile,
+                                          const std::string &password,
+                                          bool sixteenBit) {
+
+    // Dimensions only: the map does not depend on the cover's pixels
+    auto headerResult = ImageIO::Probe(coverFile);
+    if (!headerResult) {
+        return Result<>(headerResult.GetErrorCode(), headerResult.GetErrorMessage());
+    }
+    const ImageData &header = headerResult.GetValue();
+
+    if (RequiresWholeSamples() && (sixteenBit || mask_.bitPlane != 0 || mask_.bitCount != 1)) {
+        return Result<>(ErrorCode::InvalidArgument, "This method only supports bit plane 0 of 8-bit images");
+    }
+    auto layoutResult = ResolveLayout(mask_, header.width, header.height, header.channels, sixteenBit ? 16 : 8);
+    if (!layoutResult) {
+        return Result<>(layoutResult.GetErrorCode(), layoutResult.GetErrorMessage());
+    }
+
+    // Only the payload length matters, nothing is encrypted
+    auto sizeResult = GetEncryptedDataSize(dataFile);
+    if (!sizeResult) {
+        return Result<>(sizeResult.GetErrorCode(), sizeResult.GetErrorMessage());
+    }
+
+    StageTimer timer(Stats::Stage::Embed, sizeResult.GetValue());
+    std::vector<uint8_t> marks(CountSamples(header), 0);
+    auto markResult = MarkPositions(marks, sizeResult.GetValue(), password);
+    if (!markResult) {
+        return markResult;
+    }
+    ImageData map = RenderPositionMap(std::move(marks), layoutResult.GetValue(), header.width, header.height,
+                                      mask_.bitCount, visualScale_);
+    timer.Stop();
+
+    return ImageIO::Save(outputFile, map);
+}
+
+Result<> LSBStegoHandler::MarkPositions(std::vector<uint8_t> &marks, std::size_t dataBytes,
+                                        const std::string &password) const {
+    (void) marks;
+    (void) dataBytes;
+    (void) password;
+    return Result<>(ErrorCode::InvalidArgument, "This method has no position map");
+}
+
+Result<> LSBStegoHandler::VisualizeMethod(ImageData &imageData) {
+    MarkEmbeddingPlanes(imageData, mask_);
     return Result<>();
 }
@@ -7,20 +7,62 @@
 #include <vector>
 #include <string>
 
+/**
+ * @brief Selects which samples of an image LSB methods may use.
+ *
+ * Channels are enabled per index (0..3, i.e. R, G, B, A for colour images) and
+ * 'bitCount' consecutive bit planes starting at 'bitPlane' are used (0 = LSB).
+ * Channels the image does not have are ignored. Each selected bit of a sample
+ * becomes one embedding position, so 16-bit images can carry several bits per sample.
+ */
+struct EmbeddingMask {
+    static constexpr uint8_t ALL_CHANNELS = 0x0F;
+    static constexpr int MAX_CHANNELS = 4;
+    static constexpr int MAX_BIT_PLANE = 15;
+    static constexpr int MAX_BIT_COUNT = 8;
+
+    uint8_t channels = ALL_CHANNELS;  // bit c enables channel c
+    int bitPlane = 0;
+    int bitCount = 1;
+
+    /**
+     * @brief Check whether the mask uses every channel's LSB (no gather needed).
+     */
+    bool IsDefault() const {
+        return channels == ALL_CHANNELS && bitPlane == 0 && bitCount == 1;
+    }
+
+    /**
+     * @brief Parse a channel specification and bit planes.
+     *
+     * The specification lists channels by letter ("rgb", "b", "a") or index ("012").
+     * Whether the planes fit the image's sample depth is checked when embedding.
+     *
+     * @param channelSpec Channels to enable
+     * @param bitPlane Lowest bit plane to use (0 = LSB)
+     * @param bitCount Number of consecutive bit planes to use
+     * @return Result containing the mask or InvalidArgument
+     */
+    static Result<EmbeddingMask> Parse(const std::string &channelSpec, int bitPlane, int bitCount = 1);
+};
+
 /**
  * @brief Abstract base class for LSB (Least Significant Bit) steganography algorithms.
  *
  * This handler provides common functionality for LSB-based steganography methods,
  * including capacity calculation and validation. Concrete implementations define
- * the specific embedding and extraction strategies.
+ * the specific embedding and extraction strategies on a flat array of 8-bit samples;
+ * the base class gathers the samples selected by the embedding mask and scatters
+ * them back afterwards. 16-bit images go through the same path, one sample per
+ * selected bit, and are written back as 16-bit PNG.
  */
 class LSBStegoHandler : public StegoHandler {
 public:
     /**
     * Size of the header for steganography decoding
     **/
-    static constexpr uint32_t HEADER_SIZE_BITS = 32;  
-    static constexpr uint32_t HEADER_SIZE_BYTES = 4;
+    static constexpr uint32_t HEADER_SIZE_BITS = static_cast<uint32_t>(PayloadHeader::SIZE_BITS);
+    static constexpr uint32_t HEADER_SIZE_BYTES = static_cast<uint32_t>(PayloadHeader::SIZE_BYTES);
     
     /**
      * @brief Calculate LSB steganography capacity in bytes for a given pixel count.
@@ -54,6 +96,105 @@ public:
     static Result<> ValidateCapacity(std::size_t pixelCount, std::size_t dataSize, 
                                      std::size_t headerBits, std::size_t fileMaxSize);
 
+    /**
+     * @brief Set the channels and bit plane used by Embed/Extract (all channels' LSB by default).
+     */
+    void SetEmbeddingMask(const EmbeddingMask &mask) { mask_ = mask; }
+
+    const EmbeddingMask &GetEmbeddingMask() const { return mask_; }
+
+    /**
+     * @brief Draw Visual's map at 1/scale of the cover's width and height (1 by default).
+     *
+     * Each map pixel shows the brightest of the scale x scale pixels it covers, so no
+     * carrying sample is lost.
+     */
+    void SetVisualScale(int scale) { visualScale_ = scale < 1 ? 1 : scale; }
+    int GetVisualScale() const { return visualScale_; }
+
+    /**
+     * @brief What Visual draws, see ImageDiff.
+     *
+     * Map shows the samples that carry the payload. Diff embeds into the cover and
+     * lights the samples that changed; Heatmap shows the share of embedding bits that
+     * changed per visual scale block. Both compare the real cover with its stego image.
+     */
+    enum class VisualMode {
+        Map,
+        Diff,
+        Heatmap
+    };
+
+    /**
+     * @brief Select what Visual draws (Map by default).
+     */
+    void SetVisualMode(VisualMode mode) { visualMode_ = mode; }
+    VisualMode GetVisualMode() const { return visualMode_; }
+
+    /**
+     * @brief Embeds data into the samples selected by the embedding mask.
+     * 
+     * @param imageData Image data to modify (in-place)
+     * @param dataToEmbed Data to embed (already encrypted)
+     * @param password Password that may be used in Extraction
+     * @return Result indicating success or embedding error
+     */
+    Result<> EmbedMethod(ImageData &imageData,
+                         const std::vector<uint8_t> &dataToEmbed,
+                         const std::string &password ) override;
+
+    /**
+     * @brief Embeds data into the bits of a 16-bit image selected by the embedding mask.
+     */
+    Result<> EmbedMethod(ImageData16 &imageData,
+                         const std::vector<uint8_t> &dataToEmbed,
+                         const std::string &password );
+
+    /**
+     * @brief Extracts data from the samples selected by the embedding mask.
+     * 
+     * @param imageData Image data to read from
+     * @param password Password that may be used in Extraction
+     * @return Result containing extracted data (encrypted) or error
+     */
+    Result<std::vector<uint8_t>> ExtractMethod(const ImageData &imageData,
+                                               const std::string &password ) override;
+
+    /**
+     * @brief Extracts data from the bits of a 16-bit image selected by the embedding mask.
+     */
+    Result<std::vector<uint8_t>> ExtractMethod(const ImageData16 &imageData,
+                                               const std::string &password );
+
+    /**
+     * @brief Embed, keeping 16-bit PNG covers at 16 bits.
+     */
+    Result<> Embed(const std::string &coverFile,
+                   const std::string &dataFile,
+                   const std::string &outputFile,
+                   const std::string &password) override;
+
+    /**
+     * @brief Extract, reading 16-bit PNGs at full precision.
+     */
+    Result<> Extract(const std::string &stegoFile,
+                     const std::string &outputFile,
+                     const std::string &password) override;
+
+    /**
+     * @brief Draws the samples that carry the payload.
+     *
+     * Methods with a position map (see HasPositionMap) draw it from the cover's
+     * dimensions, the password and the payload length, without decoding the cover
+     * or encrypting the data. Others embed into the cover and mark the samples
+     * whose embedding bits are set. In Diff and Heatmap mode (see SetVisualMode)
+     * the data is embedded into the cover and the result compared with it.
+     */
+    Result<> Visual(const std::string &coverFile,
+                    const std::string &dataFile,
+                    const std::string &outputFile,
+                    const std::string &password) override;
+
     /**
      * @brief Visualizes data stored into pixel array using LSB technique.
      * 
@@ -61,8 +202,110 @@ public:
      * @return Result indicating success or error
      */
     Result<> VisualizeMethod( ImageData &imageData) override;
+
+    /**
+     * @brief Base estimate plus the gathered copy of the samples, when the mask needs one.
+     */
+    std::size_t EstimateEmbedMemory(const ImageData &header, std::size_t sampleBytes,
+                                    std::size_t dataBytes) const override;
     
     virtual ~LSBStegoHandler() = default;
+
+protected:
+    /**
+     * @brief Number of samples EmbedSamples gets for an image of these dimensions.
+     */
+    std::size_t CountSamples(const ImageData &header) const;
+
+    /**
+     * @brief Whether EmbedSamples changes whole sample values rather than bit 0.
+     *
+     * Such methods (e.g. +-1 embedding) only work on bit plane 0 of 8-bit images.
+     */
+    virtual bool RequiresWholeSamples() const { return false; }
+
+    /**
+     * @brief Whether Visual must embed into the cover itself rather than a blank image.
+     *
+     * Needed when embedding positions depend on the cover content.
+     */
+    virtual bool VisualizeOnCover() const { return false; }
+
+    /**
+     * @brief Whether MarkPositions can draw where this method embeds.
+     *
+     * False for methods whose positions depend on the cover or on the data; Visual
+     * embeds for those.
+     */
+    virtual bool HasPositionMap() const { return false; }
+
+    /**
+     * @brief Mark the samples EmbedSamples writes for dataBytes of encrypted data.
+     *
+     * @param marks One entry per sample, zero on entry; set to 0xFF where a payload bit goes
+     * @param dataBytes Size of the encrypted data, payload header excluded
+     * @param password Password the positions may depend on
+     * @return Result indicating success or a capacity error
+     */
+    virtual Result<> MarkPositions(std::vector<uint8_t> &marks, std::size_t dataBytes,
+                                   const std::string &password) const;
+
+    /**
+     * @brief Embeds data into a flat array of samples.
+     * 
+     * Only bit 0 of each sample carries data. For masks other than plane 0 of
+     * 8-bit samples, only bit 0 is written back, into the selected bit plane.
+     * 
+     * @param samples Samples selected by the embedding mask (modified in-place)
+     * @param dataToEmbed Data to embed (already encrypted)
+     * @param password Password that may be used in Extraction
+     * @return Result indicating success or embedding error
+     */
+    virtual Result<> EmbedSamples(ImageData &samples,
+                                  const std::vector<uint8_t> &dataToEmbed,
+                                  const std::string &password ) = 0;
+
+    /**
+     * @brief Extracts data from a flat array of samples.
+     * 
+     * @param samples Samples selected by the embedding mask
+     * @param password Password that may be used in Extraction
+     * @return Result containing extracted data (encrypted) or error
+     */
+    virtual Result<std::vector<uint8_t>> ExtractSamples(const ImageData &samples,
+                                                        const std::string &password ) = 0;
+
+private:
+    template <typename T>
+    Result<> EmbedImage(BasicImageData<T> &imageData,
+                        const std::vector<uint8_t> &dataToEmbed,
+                        const std::string &password);
+
+    template <typename T>
+    Result<std::vector<uint8_t>> ExtractImage(const BasicImageData<T> &imageData,
+                                              const std::string &password);
+
+    template <typename T>
+    Result<> VisualImage(BasicImageData<T> &imageData,
+                         const std::string &dataFile,
+                         const std::string &outputFile,
+                         const std::string &password);
+
+    template <typename T>
+    Result<> VisualCompare(const BasicImageData<T> &cover,
+                           const std::string &dataFile,
+                           const std::string &outputFile,
+                           const std::string &password);
+
+    Result<> VisualPositions(const std::string &coverFile,
+                             const std::string &dataFile,
+                             const std::string &outputFile,
+                             const std::string &password,
+                             bool sixteenBit);
+
+    EmbeddingMask mask_;
+    int visualScale_ = 1;
+    VisualMode visualMode_ = VisualMode::Map;
 };
 
 #endif // __LSB_STEGO_HANDLER_H_
@@ -0,0 +1,579 @@
+#include "LSBStegoHandlerAdaptive.h"
+#include "../../../utils/CpuFeatures.h"
+#include "../../../utils/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+using LevelCounts = std::array<uint64_t, LSBStegoHandlerAdaptive::COST_LEVELS>;
+
+/**
+ * Everything needed to map a sample rank to a position and back, per tile.
+ * Ranks count pixels by descending cost level, raster order within a level.
+ */
+struct CostRanking {
+    std::vector<uint8_t> costs;
+    std::size_t channels = 0;
+    std::size_t pixelCount = 0;
+    std::size_t tilePixels = 0;
+    std::size_t tileCount = 0;
+    std::vector<LevelCounts> tileCounts;   // pixels per level in each tile
+    std::vector<LevelCounts> tileRanks;    // rank of each tile's first pixel per level
+};
+
+std::size_t TileCount(int height) {
+    return (static_cast<std::size_t>(height) + LSBStegoHandlerAdaptive::TILE_ROWS - 1) / LSBStegoHandlerAdaptive::TILE_ROWS;
+}
+
+// Scale |gx| + |gy| (up to 8 * 127 * channels) to one byte
+int CostShift(int channels) {
+    int shift = 2;
+    while ((1 << (shift - 2)) < channels) {
+        ++shift;
+    }
+    return shift;
+}
+
+// Channel sum of the 7 high bits of pixels [first, width) of one row, after the left pad
+template <typename T, int Channels>
+void LoadRowFixed(const uint8_t *row, int first, int width, T *out) {
+    for (int x = first; x < width; ++x) {
+        int sum = 0;
+        for (int c = 0; c < Channels; ++c) {
+            sum += row[x * Channels + c] >> 1;
+        }
+        out[x + 1] = static_cast<T>(sum);
+    }
+}
+
+// Replicates the edge pixels into the pad on each side
+template <typename T>
+void PadRow(int width, T *out) {
+    out[0] = out[1];
+    out[width + 1] = out[width];
+}
+
+void LoadRow(const uint8_t *row, int width, int channels, int32_t *out) {
+    switch (channels) {
+        case 1: LoadRowFixed<int32_t, 1>(row, 0, width, out); break;
+        case 2: LoadRowFixed<int32_t, 2>(row, 0, width, out); break;
+        case 3: LoadRowFixed<int32_t, 3>(row, 0, width, out); break;
+        case 4: LoadRowFixed<int32_t, 4>(row, 0, width, out); break;
+        default:
+            for (int x = 0; x < width; ++x) {
+                int32_t sum = 0;
+                for (int c = 0; c < channels; ++c) {
+                    sum += row[x * channels + c] >> 1;
+                }
+                out[x + 1] = sum;
+            }
+            break;
+    }
+    PadRow(width, out);
+}
+
+// Cost of pixels [first, width) of the middle row
+template <typename T>
+void SobelRow(const T *up, const T *mid, const T *down, int first, int width, int shift, uint8_t *cost) {
+    for (int x = first + 1; x <= width; ++x) {
+        int gx = (up[x + 1] + 2 * mid[x + 1] + down[x + 1]) - (up[x - 1] + 2 * mid[x - 1] + down[x - 1]);
+        int gy = (down[x - 1] + 2 * down[x] + down[x + 1]) - (up[x - 1] + 2 * up[x] + up[x + 1]);
+        int level = (std::abs(gx) + std::abs(gy)) >> shift;
+        cost[x - 1] = static_cast<uint8_t>(std::min(level, LSBStegoHandlerAdaptive::COST_LEVELS - 1));
+    }
+}
+
+#ifdef STEGTOOL_X86_SIMD
+
+// Vector kernels keep rows as 16-bit sums: with up to four channels a sum is at most 508 and
+// |gx| + |gy| at most 4064, so Sobel runs in 16-bit lanes. The channel sums come from pmaddubsw
+// on byte pairs, after pshufb widens RGB pixels to four bytes. Tails take the scalar loops.
+
+__attribute__((target("ssse3")))
+inline __m128i LoadBytes(const void *src) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+}
+
+__attribute__((target("ssse3")))
+inline void StoreWords(int16_t *dst, __m128i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), value);
+}
+
+// Every byte shifted right by one
+__attribute__((target("ssse3")))
+inline __m128i HighBitsSsse3(__m128i value) {
+    return _mm_and_si128(_mm_srli_epi16(value, 1), _mm_set1_epi8(0x7F));
+}
+
+// Sums of the four bytes of each 32-bit pixel, the pixels of 'first' then those of 'second'
+__attribute__((target("ssse3")))
+inline __m128i SumQuadsSsse3(__m128i first, __m128i second) {
+    const __m128i ones = _mm_set1_epi8(1);
+    return _mm_hadd_epi16(_mm_maddubs_epi16(HighBitsSsse3(first), ones),
+                          _mm_maddubs_epi16(HighBitsSsse3(second), ones));
+}
+
+// pshufb route widening four RGB pixels to four bytes each, the fourth zero
+__attribute__((target("ssse3")))
+inline __m128i RgbToQuadsSsse3() {
+    return _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+}
+
+template <int Channels>
+__attribute__((target("ssse3")))
+void LoadRowSsse3(const uint8_t *row, int width, int16_t *out) {
+    int x = 0;
+    if constexpr (Channels == 1) {
+        for (; x + 16 <= width; x += 16) {
+            __m128i values = HighBitsSsse3(LoadBytes(row + x));
+            StoreWords(out + 1 + x, _mm_unpacklo_epi8(values, _mm_setzero_si128()));
+            StoreWords(out + 9 + x, _mm_unpackhi_epi8(values, _mm_setzero_si128()));
+        }
+    } else if constexpr (Channels == 2) {
+        const __m128i ones = _mm_set1_epi8(1);
+        for (; x + 8 <= width; x += 8) {
+            StoreWords(out + 1 + x, _mm_maddubs_epi16(HighBitsSsse3(LoadBytes(row + 2 * x)), ones));
+        }
+    } else if constexpr (Channels == 3) {
+        // The second load ends four bytes past the eight pixels
+        const __m128i route = RgbToQuadsSsse3();
+        for (; 3 * x + 28 <= 3 * width; x += 8) {
+            StoreWords(out + 1 + x, SumQuadsSsse3(_mm_shuffle_epi8(LoadBytes(row + 3 * x), route),
+                                                  _mm_shuffle_epi8(LoadBytes(row + 3 * x + 12), route)));
+        }
+    } else {
+        for (; x + 8 <= width; x += 8) {
+            StoreWords(out + 1 + x, SumQuadsSsse3(LoadBytes(row + 4 * x), LoadBytes(row + 4 * x + 16)));
+        }
+    }
+    LoadRowFixed<int16_t, Channels>(row, x, width, out);
+    PadRow(width, out);
+}
+
+__attribute__((target("ssse3")))
+void SobelRowSsse3(const int16_t *up, const int16_t *mid, const int16_t *down, int width, int shift, uint8_t *cost) {
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    int x = 1;
+    for (; x + 8 <= width + 1; x += 8) {
+        __m128i upLeft = LoadBytes(up + x - 1);
+        __m128i upRight = LoadBytes(up + x + 1);
+        __m128i downLeft = LoadBytes(down + x - 1);
+        __m128i downRight = LoadBytes(down + x + 1);
+        __m128i left = _mm_add_epi16(_mm_add_epi16(upLeft, downLeft), _mm_slli_epi16(LoadBytes(mid + x - 1), 1));
+        __m128i right = _mm_add_epi16(_mm_add_epi16(upRight, downRight), _mm_slli_epi16(LoadBytes(mid + x + 1), 1));
+        __m128i top = _mm_add_epi16(_mm_add_epi16(upLeft, upRight), _mm_slli_epi16(LoadBytes(up + x), 1));
+        __m128i bottom = _mm_add_epi16(_mm_add_epi16(downLeft, downRight), _mm_slli_epi16(LoadBytes(down + x), 1));
+        __m128i magnitude = _mm_add_epi16(_mm_abs_epi16(_mm_sub_epi16(right, left)), _mm_abs_epi16(_mm_sub_epi16(bottom, top)));
+        __m128i level = _mm_srl_epi16(magnitude, count);
+
+        // Saturating pack clamps the levels to one byte
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(cost + x - 1), _mm_packus_epi16(level, level));
+    }
+    SobelRow(up, mid, down, x - 1, width, shift, cost);
+}
+
+// AVX2 lanes work in 128-bit halves: hadd and pack interleave the halves of their two
+// inputs, so the results are put back in pixel order with vpermq
+
+__attribute__((target("avx2")))
+inline __m256i LoadBytesAvx2(const void *src) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+}
+
+__attribute__((target("avx2")))
+inline __m256i LoadPairAvx2(const uint8_t *first, const uint8_t *second) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(LoadBytes(first)), LoadBytes(second), 1);
+}
+
+__attribute__((target("avx2")))
+inline void StoreWordsAvx2(int16_t *dst, __m256i value) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), value);
+}
+
+__attribute__((target("avx2")))
+inline __m256i HighBitsAvx2(__m256i value) {
+    return _mm256_and_si256(_mm256_srli_epi16(value, 1), _mm256_set1_epi8(0x7F));
+}
+
+__attribute__((target("avx2")))
+inline __m256i SumQuadsAvx2(__m256i first, __m256i second) {
+    const __m256i ones = _mm256_set1_epi8(1);
+    __m256i sums = _mm256_hadd_epi16(_mm256_maddubs_epi16(HighBitsAvx2(first), ones),
+                                     _mm256_maddubs_epi16(HighBitsAvx2(second), ones));
+    return _mm256_permute4x64_epi64(sums, 0xD8);
+}
+
+template <int Channels>
+__attribute__((target("avx2")))
+void LoadRowAvx2(const uint8_t *row, int width, int16_t *out) {
+    int x = 0;
+    if constexpr (Channels == 1) {
+        for (; x + 16 <= width; x += 16) {
+            StoreWordsAvx2(out + 1 + x, _mm256_srli_epi16(_mm256_cvtepu8_epi16(LoadBytes(row + x)), 1));
+        }
+    } else if constexpr (Channels == 2) {
+        const __m256i ones = _mm256_set1_epi8(1);
+        for (; x + 16 <= width; x += 16) {
+            StoreWordsAvx2(out + 1 + x, _mm256_maddubs_epi16(HighBitsAvx2(LoadBytesAvx2(row + 2 * x)), ones));
+        }
+    } else if constexpr (Channels == 3) {
+        // Four RGB pixels per lane; the last load ends four bytes past the sixteen pixels
+        const __m256i route = _mm256_broadcastsi128_si256(RgbToQuadsSsse3());
+        for (; 3 * x + 52 <= 3 * width; x += 16) {
+            const uint8_t *in = row + 3 * x;
+            StoreWordsAvx2(out + 1 + x, SumQuadsAvx2(_mm256_shuffle_epi8(LoadPairAvx2(in, in + 12), route),
+                                                     _mm256_shuffle_epi8(LoadPairAvx2(in + 24, in + 36), route)));
+        }
+    } else {
+        for (; x + 16 <= width; x += 16) {
+            StoreWordsAvx2(out + 1 + x, SumQuadsAvx2(LoadBytesAvx2(row + 4 * x), LoadBytesAvx2(row + 4 * x + 32)));
+        }
+    }
+    LoadRowFixed<int16_t, Channels>(row, x, width, out);
+    PadRow(width, out);
+}
+
+__attribute__((target("avx2")))
+void SobelRowAvx2(const int16_t *up, const int16_t *mid, const int16_t *down, int width, int shift, uint8_t *cost) {
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    int x = 1;
+    for (; x + 16 <= width + 1; x += 16) {
+        __m256i upLeft = LoadBytesAvx2(up + x - 1);
+        __m256i upRight = LoadBytesAvx2(up + x + 1);
+        __m256i downLeft = LoadBytesAvx2(down + x - 1);
+        __m256i downRight = LoadBytesAvx2(down + x + 1);
+        __m256i left = _mm256_add_epi16(_mm256_add_epi16(upLeft, downLeft), _mm256_slli_epi16(LoadBytesAvx2(mid + x - 1), 1));
+        __m256i right = _mm256_add_epi16(_mm256_add_epi16(upRight, downRight), _mm256_slli_epi16(LoadBytesAvx2(mid + x + 1), 1));
+        __m256i top = _mm256_add_epi16(_mm256_add_epi16(upLeft, upRight), _mm256_slli_epi16(LoadBytesAvx2(up + x), 1));
+        __m256i bottom = _mm256_add_epi16(_mm256_add_epi16(downLeft, downRight), _mm256_slli_epi16(LoadBytesAvx2(down + x), 1));
+        __m256i magnitude = _mm256_add_epi16(_mm256_abs_epi16(_mm256_sub_epi16(right, left)),
+                                             _mm256_abs_epi16(_mm256_sub_epi16(bottom, top)));
+        __m256i level = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_srl_epi16(magnitude, count), _mm256_setzero_si256()), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(cost + x - 1), _mm256_castsi256_si128(level));
+    }
+    SobelRow(up, mid, down, x - 1, width, shift, cost);
+}
+
+struct CostKernels {
+    void (*load[4])(const uint8_t *, int, int16_t *);  // [channels - 1]
+    void (*sobel)(const int16_t *, const int16_t *, const int16_t *, int, int, uint8_t *);
+};
+
+const CostKernels SSSE3_COST_KERNELS = {
+    {LoadRowSsse3<1>, LoadRowSsse3<2>, LoadRowSsse3<3>, LoadRowSsse3<4>},
+    SobelRowSsse3};
+
+const CostKernels AVX2_COST_KERNELS = {
+    {LoadRowAvx2<1>, LoadRowAvx2<2>, LoadRowAvx2<3>, LoadRowAvx2<4>},
+    SobelRowAvx2};
+
+// Kernels for the channel count, or nullptr to take the portable path
+const CostKernels *SelectCostKernels(int channels) {
+    if (channels > 4) {
+        return nullptr;
+    }
+    switch (CpuFeatures::GetSimdLevel()) {
+        case SimdLevel::Avx2: return &AVX2_COST_KERNELS;
+        case SimdLevel::Ssse3: return &SSSE3_COST_KERNELS;
+        case SimdLevel::Portable: break;
+    }
+    return nullptr;
+}
+
+#endif
+
+/**
+ * Cost rows of one tile. load(row, out) fills a padded row of channel sums and
+ * sobel(up, mid, down, cost) writes the costs of the middle row.
+ */
+template <typename T, typename LoadFn, typename SobelFn>
+void CostTile(const ImageData &imageData, std::size_t tile, const LoadFn &load, const SobelFn &sobel, uint8_t *costs) {
+    const int width = imageData.width;
+    const int height = imageData.height;
+    const std::size_t rowStride = static_cast<std::size_t>(width) * imageData.channels;
+    const uint8_t *pixels = imageData.pixels.data();
+
+    int rowBegin = static_cast<int>(tile) * LSBStegoHandlerAdaptive::TILE_ROWS;
+    int rowEnd = std::min(rowBegin + LSBStegoHandlerAdaptive::TILE_ROWS, height);
+
+    // Three padded rows, rotated as the window moves down
+    std::vector<T> buffer(3 * static_cast<std::size_t>(width + 2));
+    T *up = buffer.data();
+    T *mid = up + width + 2;
+    T *down = mid + width + 2;
+
+    load(pixels + std::max(rowBegin - 1, 0) * rowStride, up);
+    load(pixels + rowBegin * rowStride, mid);
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        load(pixels + std::min(y + 1, height - 1) * rowStride, down);
+        sobel(up, mid, down, costs + static_cast<std::size_t>(y) * width);
+
+        T *recycled = up;
+        up = mid;
+        mid = down;
+        down = recycled;
+    }
+}
+
+CostRanking BuildRanking(const ImageData &imageData) {
+    CostRanking ranking;
+    ranking.costs = LSBStegoHandlerAdaptive::ComputeCostMap(imageData);
+    ranking.channels = static_cast<std::size_t>(imageData.channels);
+    ranking.pixelCount = ranking.costs.size();
+    ranking.tilePixels = static_cast<std::size_t>(LSBStegoHandlerAdaptive::TILE_ROWS) * imageData.width;
+    ranking.tileCount = TileCount(imageData.height);
+    ranking.tileCounts.assign(ranking.tileCount, LevelCounts{});
+
+    Parallel::For(ranking.tileCount, [&](std::size_t tile) {
+        std::size_t begin = tile * ranking.tilePixels;
+        std::size_t end = std::min(begin + ranking.tilePixels, ranking.pixelCount);
+        LevelCounts &counts = ranking.tileCounts[tile];
+        for (std::size_t idx = begin; idx < end; ++idx) {
+            ++counts[ranking.costs[idx]];
+        }
+    });
+
+    // Levels are ranked from the highest down, tiles in raster order within a level
+    ranking.tileRanks.assign(ranking.tileCount, LevelCounts{});
+    uint64_t rank = 0;
+    for (int level = LSBStegoHandlerAdaptive::COST_LEVELS - 1; level >= 0; --level) {
+        for (std::size_t tile = 0; tile < ranking.tileCount; ++tile) {
+            ranking.tileRanks[tile][level] = rank;
+            rank += ranking.tileCounts[tile][level];
+        }
+    }
+    return ranking;
+}
+
+uint64_t Overlap(uint64_t begin, uint64_t end, uint64_t rangeBegin, uint64_t rangeEnd) {
+    uint64_t low = std::max(begin, rangeBegin);
+    uint64_t high = std::min(end, rangeEnd);
+    return high > low ? high - low : 0;
+}
+
+/**
+ * Calls func(sampleIndex, bitIndex) for every sample whose rank is in [rankBegin, rankEnd).
+ * Bit indexes follow raster order of the selected samples. Tiles run in parallel.
+ */
+template <typename Func>
+void ForEachRankedSample(const CostRanking &ranking, uint64_t rankBegin, uint64_t rankEnd, const Func &func) {
+    const uint64_t channels = ranking.channels;
+
+    // Selected samples before each tile, straight from the histograms
+    std::vector<uint64_t> tileBits(ranking.tileCount + 1, 0);
+    for (std::size_t tile = 0; tile < ranking.tileCount; ++tile) {
+        uint64_t selected = 0;
+        for (int level = 0; level < LSBStegoHandlerAdaptive::COST_LEVELS; ++level) {
+            uint64_t first = ranking.tileRanks[tile][level] * channels;
+            uint64_t last = first + ranking.tileCounts[tile][level] * channels;
+            selected += Overlap(first, last, rankBegin, rankEnd);
+        }
+        tileBits[tile + 1] = tileBits[tile] + selected;
+    }
+
+    Parallel::For(ranking.tileCount, [&](std::size_t tile) {
+        uint64_t bit = tileBits[tile];
+        if (bit == tileBits[tile + 1]) {
+            return;
+        }
+
+        LevelCounts next = ranking.tileRanks[tile];
+        std::size_t begin = tile * ranking.tilePixels;
+        std::size_t end = std::min(begin + ranking.tilePixels, ranking.pixelCount);
+        for (std::size_t pixel = begin; pixel < end; ++pixel) {
+            uint64_t sampleRank = next[ranking.costs[pixel]]++ * channels;
+            if (sampleRank + channels <= rankBegin || sampleRank >= rankEnd) {
+                continue;
+            }
+            for (uint64_t c = 0; c < channels; ++c) {
+                if (sampleRank + c >= rankBegin && sampleRank + c < rankEnd) {
+                    func(static_cast<std::size_t>(pixel * channels + c), static_cast<std::size_t>(bit++));
+                }
+            }
+        }
+    });
+}
+
+Result<> ValidateLayout(const ImageData &imageData) {
+    if (imageData.width <= 0 || imageData.height <= 0 || imageData.channels <= 0 ||
+        static_cast<std::size_t>(imageData.width) * imageData.height * imageData.channels != imageData.pixels.size()) {
+        return Result<>(ErrorCode::InvalidImageDimensions, "Adaptive embedding needs pixel data matching the image dimensions");
+    }
+    return Result<>();
+}
+
+} // namespace
+
+std::vector<uint8_t> LSBStegoHandlerAdaptive::ComputeCostMap(const ImageData &imageData) {
+    const int width = imageData.width;
+    const int channels = imageData.channels;
+    const int shift = CostShift(channels);
+
+    std::vector<uint8_t> costs(static_cast<std::size_t>(width) * imageData.height);
+    uint8_t *costData = costs.data();
+
+#ifdef STEGTOOL_X86_SIMD
+    if (const CostKernels *kernels = SelectCostKernels(channels)) {
+        auto load = kernels->load[channels - 1];
+        auto sobel = kernels->sobel;
+        Parallel::For(TileCount(imageData.height), [&](std::size_t tile) {
+            CostTile<int16_t>(imageData, tile,
+                [&](const uint8_t *row, int16_t *out) { load(row, width, out); },
+                [&](const int16_t *up, const int16_t *mid, const int16_t *down, uint8_t *cost) {
+                    sobel(up, mid, down, width, shift, cost);
+                },
+                costData);
+        });
+        return costs;
+    }
+#endif
+
+    Parallel::For(TileCount(imageData.height), [&](std::size_t tile) {
+        CostTile<int32_t>(imageData, tile,
+            [&](const uint8_t *row, int32_t *out) { LoadRow(row, width, channels, out); },
+            [&](const int32_t *up, const int32_t *mid, const int32_t *down, uint8_t *cost) {
+                SobelRow(up, mid, down, 0, width, shift, cost);
+            },
+            costData);
+    });
+
+    return costs;
+}
+
+Result<> LSBStegoHandlerAdaptive::EmbedSamples(ImageData &imageData,
+                                               const std::vector<uint8_t> &dataToEmbed,
+                                               const std::string &password) {
+
+    (void) password; // Positions depend on the image only
+
+    if (dataToEmbed.empty()) {
+        return Result<>(ErrorCode::InvalidArgument, "Cannot embed empty data");
+    }
+
+    auto layoutCheck = ValidateLayout(imageData);
+    if (!layoutCheck) {
+        return layoutCheck;
+    }
+
+    auto &pixels = imageData.pixels;
+
+    // Validate capacity
+    auto capacityCheck = LSBStegoHandler::ValidateCapacity(pixels.size(), dataToEmbed.size(), HEADER_SIZE_BITS, MAX_REASONABLE_SIZE);
+    if (!capacityCheck) {
+        return capacityCheck;
+    }
+
+    // The ranking ignores bit 0, so it stays valid while bits are written
+    CostRanking ranking = BuildRanking(imageData);
+
+    // Bits [firstBit, ...) of 'bytes' go to the ranks [rankBegin, rankEnd)
+    auto writeRankedBits = [&](uint64_t rankBegin, uint64_t rankEnd, const uint8_t *bytes, uint64_t firstBit) {
+        ForEachRankedSample(ranking, rankBegin, rankEnd, [&](std::size_t sample, std::size_t bit) {
+            uint64_t source = firstBit + bit;
+            uint8_t value = static_cast<uint8_t>((bytes[source / 8] >> (source % 8)) & 1);
+            pixels[sample] = static_cast<uint8_t>((pixels[sample] & 0xFE) | value);
+        });
+    };
+
+    // Header, the header copies of an error corrected payload and the rest of the data are
+    // separate rank ranges, so the header and its copies read back without knowing the size
+    auto header = EncodePayloadHeader(static_cast<uint32_t>(dataToEmbed.size()));
+    writeRankedBits(0, HEADER_SIZE_BITS, header.data(), 0);
+
+    uint64_t dataBits = static_cast<uint64_t>(dataToEmbed.size()) * 8;
+    uint64_t copiesBits = GetErrorCorrection() > 0 ? std::min<uint64_t>(dataBits, PayloadHeader::COPIES_SIZE_BYTES * 8) : 0;
+    writeRankedBits(HEADER_SIZE_BITS, HEADER_SIZE_BITS + copiesBits, dataToEmbed.data(), 0);
+    writeRankedBits(HEADER_SIZE_BITS + copiesBits, HEADER_SIZE_BITS + dataBits, dataToEmbed.data(), copiesBits);
+
+    return Result<>();
+}
+
+Result<std::vector<uint8_t>> LSBStegoHandlerAdaptive::ExtractSamples(const ImageData &imageData,
+                                                                     const std::string &password) {
+
+    (void) password; // Positions depend on the image only
+
+    auto layoutCheck = ValidateLayout(imageData);
+    if (!layoutCheck) {
+        return Result<std::vector<uint8_t>>(layoutCheck.GetErrorCode(), layoutCheck.GetErrorMessage());
+    }
+
+    auto &pixels = imageData.pixels;
+
+    std::size_t imgSize = pixels.size();
+
+    CostRanking ranking = BuildRanking(imageData);
+
+    // One byte per bit: tiles write disjoint entries
+    auto readRankedBits = [&](uint64_t rankBegin, uint64_t rankEnd, std::vector<uint8_t> &bits, std::size_t firstBit) {
+        ForEachRankedSample(ranking, rankBegin, rankEnd, [&](std::size_t sample, std::size_t bit) {
+            bits[firstBit + bit] = pixels[sample] & 1;
+        });
+    };
+
+    // Header and the range the copies of an error corrected header would be in
+    std::vector<uint8_t> headerBits(std::min<std::size_t>(imgSize, PayloadHeader::PROTECTED_SIZE_BITS), 0);
+    std::size_t firstCopyBits = std::min<std::size_t>(headerBits.size(), HEADER_SIZE_BITS);
+    readRankedBits(0, firstCopyBits, headerBits, 0);
+    readRankedBits(firstCopyBits, headerBits.size(), headerBits, firstCopyBits);
+
+    auto headerResult = ReadPayloadHeader(headerBits.size(), [&](std::size_t bit) {
+        return headerBits[bit];
+    });
+    if (!headerResult) {
+        return Result<std::vector<uint8_t>>(headerResult.GetErrorCode(), headerResult.GetErrorMessage());
+    }
+    uint32_t dataSize = headerResult.GetValue().dataSize;
+    uint64_t dataOffset = headerResult.GetValue().GetSizeBits();
+
+    // Validate size
+    if (dataSize == 0) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::NoEmbeddedData,
+            "Extracted size is 0. Image may not contain embedded data."
+        );
+    }
+
+    if (dataSize > MAX_REASONABLE_SIZE) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) is unreasonably large (max "
+            << MAX_REASONABLE_SIZE << " bytes). Data is likely corrupted or password is wrong.";
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::CorruptedPayload,
+            oss.str()
+        );
+    }
+
+    uint64_t dataBits = static_cast<uint64_t>(dataSize) * 8;
+    if (dataBits + dataOffset > imgSize) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) exceeds image capacity. "
+            << "Image has " << imgSize << " pixel values, "
+            << "but would need " << (dataBits + dataOffset) << " values. "
+            << "Data is corrupted or password may be wrong.";
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::InvalidDataSize,
+            oss.str()
+        );
+    }
+
+    // Header copies were already read with the header
+    uint64_t copiesBits = 0;
+    if (headerResult.GetValue().flags & PayloadHeader::FLAG_ERROR_CORRECTION) {
+        copiesBits = std::min<uint64_t>(dataBits, PayloadHeader::COPIES_SIZE_BYTES * 8);
+    }
+    std::vector<uint8_t> dataBitValues(static_cast<std::size_t>(dataBits), 0);
+    std::copy(headerBits.begin() + dataOffset, headerBits.begin() + dataOffset + copiesBits, dataBitValues.begin());
+    readRankedBits(dataOffset + copiesBits, dataOffset + dataBits, dataBitValues, copiesBits);
+
+    std::vector<uint8_t> extractedData(dataSize, 0);
+    for (std::size_t bit = 0; bit < dataBitValues.size(); ++bit) {
+        extractedData[bit / 8] |= static_cast<uint8_t>(dataBitValues[bit] << (bit % 8));
+    }
+
+    return Result<std::vector<uint8_t>>(extractedData);
+}
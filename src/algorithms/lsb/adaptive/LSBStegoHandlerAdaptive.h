@@ -0,0 +1,82 @@
+#ifndef __LSB_STEGO_HANDLER_ADAPTIVE_H_
+#define __LSB_STEGO_HANDLER_ADAPTIVE_H_
+
+#include "../LSBStegoHandler.h"
+#include "../../../utils/ImageIO.h"
+
+#include <vector>
+#include <string>
+
+/**
+ * @brief Edge-adaptive LSB replacement driven by a gradient cost map.
+ *
+ * Every pixel gets a cost level from the Sobel gradient magnitude of the image
+ * with bit 0 cleared, so the map is identical for cover and stego image. Samples
+ * are ranked by descending level (ties in raster order): the header takes ranks
+ * [0, 32) and the data the following ranks. Small payloads therefore land on
+ * edges and texture first and leave flat regions untouched.
+ *
+ * Within a rank range bits are written in raster order; the thresholds
+ * follow from the level histogram, so no position list is stored.
+ */
+class LSBStegoHandlerAdaptive : public LSBStegoHandler {
+public:
+    /**
+     * Number of distinct cost levels (one byte per pixel)
+     **/
+    static constexpr int COST_LEVELS = 256;
+
+    /**
+     * Image rows per tile of the parallel passes
+     **/
+    static constexpr int TILE_ROWS = 64;
+
+    /**
+     * @brief Compute the cost level of every pixel.
+     *
+     * Level = Sobel |gx| + |gy| of the channel sum of (value >> 1), scaled to
+     * one byte. Borders replicate the edge pixels. Runs tiled across threads.
+     * Any channel count is accepted (gathered multi-bit samples use several per pixel);
+     * up to four channels run on the SSSE3/AVX2 row kernels when the CPU has them.
+     *
+     * @param imageData Samples to analyse
+     * @return One level per pixel, higher = better place to embed
+     */
+    static std::vector<uint8_t> ComputeCostMap(const ImageData &imageData);
+
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::LSBAdaptive; }
+
+    ~LSBStegoHandlerAdaptive() override = default;
+
+protected:
+    /**
+     * @brief Positions depend on the cover content, so Visual embeds into the cover itself.
+     */
+    bool VisualizeOnCover() const override { return true; }
+
+    /**
+     * @brief Embeds data into the highest-cost samples.
+     *
+     * Format: [payload header | data bits]
+     *
+     * @param imageData Samples to modify (in-place)
+     * @param dataToEmbed Data to embed (already encrypted)
+     * @param password unused
+     * @return Result indicating success or embedding error
+     */
+    Result<> EmbedSamples(ImageData &imageData,
+                          const std::vector<uint8_t> &dataToEmbed,
+                          const std::string &password ) override;
+
+    /**
+     * @brief Extracts data from the highest-cost samples.
+     *
+     * @param imageData Samples to read from
+     * @param password unused
+     * @return Result containing extracted data or error
+     */
+    Result<std::vector<uint8_t>> ExtractSamples(const ImageData &imageData,
+                                                const std::string &password ) override;
+};
+
+#endif // __LSB_STEGO_HANDLER_ADAPTIVE_H_
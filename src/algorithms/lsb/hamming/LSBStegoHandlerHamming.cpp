@@ -0,0 +1,374 @@
+#include "LSBStegoHandlerHamming.h"
+#include "../../../utils/ImageIO.h"
+#include "../../../utils/CpuFeatures.h"
+
+#include <vector>
+#include <string>
+#include <array>
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+constexpr int MAX_P = LSBStegoHandlerHamming::MAX_CODE_PARAM;
+constexpr std::size_t PREFIX_BITS = LSBStegoHandler::HEADER_SIZE_BITS + LSBStegoHandlerHamming::CODE_PARAM_BITS;
+
+/**
+ * The syndrome of a block is the XOR of the positions i + 1 of its set LSBs. Within byte k
+ * of the positions, 8k + r == 8k ^ r, so each byte adds the XOR of its r values, plus 8k
+ * when it holds an odd number of set bits. Entry: XOR of r in bits 0-2, parity in bit 3.
+ */
+constexpr std::array<uint8_t, 256> BuildSyndromeTable() {
+    std::array<uint8_t, 256> table{};
+    for (uint32_t value = 0; value < 256; ++value) {
+        uint32_t positions = 0;
+        uint32_t parity = 0;
+        for (uint32_t r = 0; r < 8; ++r) {
+            if ((value >> r) & 1) {
+                positions ^= r;
+                parity ^= 1;
+            }
+        }
+        table[value] = static_cast<uint8_t>(positions | (parity << 3));
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> SYNDROME_TABLE = BuildSyndromeTable();
+
+/**
+ * Values packed per chunk before its blocks are coded, keeps the packed LSBs in L1
+ */
+constexpr std::size_t CHUNK_VALUES = 64 * 1024;
+constexpr std::size_t CHUNK_WORDS = CHUNK_VALUES / 64;
+
+inline std::size_t BlockSize(int codeParam) {
+    return (std::size_t(1) << codeParam) - 1;
+}
+
+inline uint32_t Syndrome(uint64_t block, std::size_t blockSize) {
+    uint64_t positions = block << 1;
+    uint32_t syndrome = 0;
+    for (uint32_t base = 0; base <= blockSize; base += 8) {
+        uint32_t entry = SYNDROME_TABLE[(positions >> base) & 0xFF];
+        syndrome ^= (entry & 7) ^ (base & (0u - (entry >> 3)));
+    }
+    return syndrome;
+}
+
+/**
+ * LSBs of 'count' values, packed LSB first into whole 64-bit words.
+ */
+void PackLSBsScalar(const uint8_t *values, std::size_t count, uint64_t *words) {
+    for (std::size_t first = 0; first < count; first += 64) {
+        std::size_t size = std::min<std::size_t>(64, count - first);
+        uint64_t word = 0;
+        for (std::size_t idx = 0; idx < size; ++idx) {
+            word |= static_cast<uint64_t>(values[first + idx] & 1) << idx;
+        }
+        words[first / 64] = word;
+    }
+}
+
+#ifdef STEGTOOL_X86_SIMD
+
+// Shifting each 64-bit lane left by 7 moves the LSB of every byte to its sign bit for movemask
+__attribute__((target("ssse3")))
+void PackLSBsSsse3(const uint8_t *values, std::size_t count, uint64_t *words) {
+    std::size_t idx = 0;
+    for (; idx + 64 <= count; idx += 64) {
+        uint64_t word = 0;
+        for (std::size_t part = 0; part < 4; ++part) {
+            __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + idx + 16 * part));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_slli_epi64(lanes, 7)));
+            word |= static_cast<uint64_t>(mask) << (16 * part);
+        }
+        words[idx / 64] = word;
+    }
+    PackLSBsScalar(values + idx, count - idx, words + idx / 64);
+}
+
+__attribute__((target("avx2")))
+void PackLSBsAvx2(const uint8_t *values, std::size_t count, uint64_t *words) {
+    std::size_t idx = 0;
+    for (; idx + 64 <= count; idx += 64) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + idx));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + idx + 32));
+        uint32_t lowMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi64(low, 7)));
+        uint32_t highMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi64(high, 7)));
+        words[idx / 64] = lowMask | (static_cast<uint64_t>(highMask) << 32);
+    }
+    PackLSBsScalar(values + idx, count - idx, words + idx / 64);
+}
+
+#endif
+
+using PackLSBsFn = void (*)(const uint8_t *, std::size_t, uint64_t *);
+
+PackLSBsFn SelectPackLSBs() {
+#ifdef STEGTOOL_X86_SIMD
+    switch (CpuFeatures::GetSimdLevel()) {
+        case SimdLevel::Avx2: return PackLSBsAvx2;
+        case SimdLevel::Ssse3: return PackLSBsSsse3;
+        case SimdLevel::Portable: break;
+    }
+#endif
+    return PackLSBsScalar;
+}
+
+/**
+ * Calls func(blockIdx, lsbs) for 'blockCount' blocks of 'blockSize' values starting at
+ * 'values', with the block's LSBs packed into a word. Blocks are packed a chunk at a time
+ * before func sees them, so func may change the values of its own block.
+ */
+template <typename Func>
+void ForEachBlock(const uint8_t *values, std::size_t blockSize, std::size_t blockCount, const Func &func) {
+    const PackLSBsFn pack = SelectPackLSBs();
+    const std::size_t chunkBlocks = CHUNK_VALUES / blockSize;
+    const uint64_t blockMask = (uint64_t(1) << blockSize) - 1;
+
+    // One spare word: a block may read past the last packed word, those bits are masked off
+    std::array<uint64_t, CHUNK_WORDS + 1> lsbs{};
+    for (std::size_t first = 0; first < blockCount; first += chunkBlocks) {
+        std::size_t blocks = std::min(chunkBlocks, blockCount - first);
+        pack(values + first * blockSize, blocks * blockSize, lsbs.data());
+
+        for (std::size_t idx = 0, bitPos = 0; idx < blocks; ++idx, bitPos += blockSize) {
+            std::size_t word = bitPos >> 6;
+            std::size_t shift = bitPos & 63;
+            uint64_t block = (lsbs[word] >> shift) | ((lsbs[word + 1] << 1) << (63 - shift));
+            func(first + idx, block & blockMask);
+        }
+    }
+}
+
+/**
+ * Syndromes of the blocks starting at 'block', as a stream of 'size' bytes.
+ * The caller checks that enough blocks follow.
+ */
+std::vector<uint8_t> DecodeBlocks(const uint8_t *block, int codeParam, std::size_t size) {
+    std::size_t blockSize = BlockSize(codeParam);
+    std::size_t blockCount = (size * 8 + codeParam - 1) / codeParam;
+
+    // Syndromes collect in a register and leave 32 bits at a time; the last block may
+    // overshoot 'size' by a few bytes
+    std::vector<uint8_t> stream(size + 8, 0);
+    uint64_t pending = 0;
+    uint32_t pendingBits = 0;
+    std::size_t byteIdx = 0;
+    ForEachBlock(block, blockSize, blockCount, [&](std::size_t, uint64_t lsbs) {
+        pending |= static_cast<uint64_t>(Syndrome(lsbs, blockSize)) << pendingBits;
+        pendingBits += static_cast<uint32_t>(codeParam);
+        if (pendingBits >= 32) {
+            for (std::size_t idx = 0; idx < 4; ++idx) {
+                stream[byteIdx + idx] = static_cast<uint8_t>(pending >> (8 * idx));
+            }
+            byteIdx += 4;
+            pending >>= 32;
+            pendingBits -= 32;
+        }
+    });
+    for (std::size_t idx = 0; idx * 8 < pendingBits; ++idx) {
+        stream[byteIdx + idx] = static_cast<uint8_t>(pending >> (8 * idx));
+    }
+    stream.resize(size);
+    return stream;
+}
+
+/**
+ * Bytes the syndrome blocks after a prefix of 'prefixBits' plain LSBs can carry.
+ */
+std::size_t BlockCapacity(std::size_t pixelCount, int codeParam, std::size_t prefixBits) {
+    if (codeParam < LSBStegoHandlerHamming::MIN_CODE_PARAM || codeParam > MAX_P || pixelCount <= prefixBits) {
+        return 0;
+    }
+    std::size_t blocks = (pixelCount - prefixBits) / BlockSize(codeParam);
+    return (blocks * static_cast<std::size_t>(codeParam)) / 8;
+}
+
+} // namespace
+
+LSBStegoHandlerHamming::LSBStegoHandlerHamming(int codeParam)
+    : codeParam_(codeParam)
+{   }
+
+std::size_t LSBStegoHandlerHamming::CalculateCapacity(std::size_t pixelCount, int codeParam) {
+    return BlockCapacity(pixelCount, codeParam, PREFIX_BITS);
+}
+
+int LSBStegoHandlerHamming::ChooseCodeParam(std::size_t pixelCount, std::size_t dataSize) {
+    for (int codeParam = MAX_CODE_PARAM; codeParam >= MIN_CODE_PARAM; --codeParam) {
+        if (dataSize <= CalculateCapacity(pixelCount, codeParam)) {
+            return codeParam;
+        }
+    }
+    return AUTO_CODE_PARAM;
+}
+
+Result<> LSBStegoHandlerHamming::EmbedSamples(ImageData &imageData,
+                                              const std::vector<uint8_t> &dataToEmbed,
+                                              const std::string &password) {
+
+    (void) password; //Avoid unused parameter warning for Hamming Method
+
+    if (dataToEmbed.empty()) {
+        return Result<>(ErrorCode::InvalidArgument, "Cannot embed empty data");
+    }
+
+    if (codeParam_ != AUTO_CODE_PARAM && (codeParam_ < MIN_CODE_PARAM || codeParam_ > MAX_CODE_PARAM)) {
+        std::ostringstream oss;
+        oss << "Invalid Hamming code parameter p = " << codeParam_
+            << " (supported: " << MIN_CODE_PARAM << " to " << MAX_CODE_PARAM << ")";
+        return Result<>(ErrorCode::InvalidArgument, oss.str());
+    }
+
+    auto &pixels = imageData.pixels;
+    std::size_t imgSize = pixels.size();
+
+    if (dataToEmbed.size() > MAX_REASONABLE_SIZE) {
+        std::ostringstream oss;
+        oss << "Data size (" << dataToEmbed.size() << " bytes) exceeds maximum allowed size (" 
+            << MAX_REASONABLE_SIZE << " bytes)";
+        return Result<>(ErrorCode::DataTooLarge, oss.str());
+    }
+
+    int codeParam = codeParam_;
+    if (codeParam == AUTO_CODE_PARAM) {
+        codeParam = ChooseCodeParam(imgSize, dataToEmbed.size());
+        if (codeParam == AUTO_CODE_PARAM) {
+            codeParam = MIN_CODE_PARAM; // report capacity error for the densest code
+        }
+    }
+
+    // Validate capacity
+    std::size_t availableCapacity = CalculateCapacity(imgSize, codeParam);
+    if (dataToEmbed.size() > availableCapacity) {
+        std::ostringstream oss;
+        oss << "Data size (" << dataToEmbed.size() << " bytes) exceeds Image capacity (" << availableCapacity 
+            << " bytes) for Hamming code p = " << codeParam << ".\n"
+            << "    Image has " << imgSize << " pixel values.";
+        return Result<>(availableCapacity == 0 ? ErrorCode::ImageTooSmall : ErrorCode::InsufficientCapacity, oss.str());
+    }
+
+    uint32_t dataSize = static_cast<uint32_t>(dataToEmbed.size());
+
+    // Embed payload header and code parameter in plain LSBs
+    auto header = EncodePayloadHeader(dataSize);
+    for (std::size_t idx = 0; idx < HEADER_SIZE_BITS; ++idx) {
+        uint8_t bit = (header[idx / 8] >> (idx % 8)) & 1;
+        pixels[idx] = (pixels[idx] & 0xFE) | bit;
+    }
+    for (std::size_t idx = 0; idx < CODE_PARAM_BITS; ++idx) {
+        uint8_t bit = (static_cast<uint32_t>(codeParam) >> idx) & 1;
+        pixels[HEADER_SIZE_BITS + idx] = (pixels[HEADER_SIZE_BITS + idx] & 0xFE) | bit;
+    }
+
+    // Data stream with padding for the bit reader
+    std::vector<uint8_t> stream(dataToEmbed);
+    stream.resize(stream.size() + 4, 0);
+
+    std::size_t blockSize = BlockSize(codeParam);
+    std::size_t dataBits = static_cast<std::size_t>(dataSize) * 8;
+    std::size_t blockCount = (dataBits + codeParam - 1) / codeParam;
+
+    // Message bits enter a register 32 at a time, the stream has padding for the last refill
+    uint8_t *blocks = pixels.data() + PREFIX_BITS;
+    const uint8_t *message = stream.data();
+    const uint32_t messageMask = (1u << codeParam) - 1;
+    uint64_t pending = 0;
+    uint32_t pendingBits = 0;
+    ForEachBlock(blocks, blockSize, blockCount, [&](std::size_t blockIdx, uint64_t lsbs) {
+        if (pendingBits < static_cast<uint32_t>(codeParam)) {
+            uint64_t next = 0;
+            for (std::size_t idx = 0; idx < 4; ++idx) {
+                next |= static_cast<uint64_t>(message[idx]) << (8 * idx);
+            }
+            message += 4;
+            pending |= next << pendingBits;
+            pendingBits += 32;
+        }
+        uint32_t syndrome = Syndrome(lsbs, blockSize);
+
+        // Flipping the LSB at position (s ^ m) - 1 turns the syndrome into m; nothing to do when 0
+        uint32_t target = syndrome ^ (static_cast<uint32_t>(pending) & messageMask);
+        pending >>= codeParam;
+        pendingBits -= static_cast<uint32_t>(codeParam);
+        std::size_t flipPos = target - (target != 0);
+        blocks[blockIdx * blockSize + flipPos] ^= static_cast<uint8_t>(target != 0);
+    });
+
+    return Result<>();
+}
+
+Result<std::vector<uint8_t>> LSBStegoHandlerHamming::ExtractSamples(const ImageData &imageData, 
+                                                                    const std::string &password) {
+
+    (void) password; //Avoid unused parameter warning for Hamming Method
+
+    auto &pixels = imageData.pixels;
+    std::size_t imgSize = pixels.size();
+
+    int codeParam = 0;
+    for (std::size_t idx = 0; idx < CODE_PARAM_BITS && PREFIX_BITS <= imgSize; ++idx) {
+        codeParam |= (pixels[HEADER_SIZE_BITS + idx] & 1) << idx;
+    }
+
+    // The copies of an error corrected header lead the data, so they are in the syndromes
+    std::vector<uint8_t> copies;
+    if (BlockCapacity(imgSize, codeParam, PREFIX_BITS) >= PayloadHeader::COPIES_SIZE_BYTES) {
+        copies = DecodeBlocks(pixels.data() + PREFIX_BITS, codeParam, PayloadHeader::COPIES_SIZE_BYTES);
+    }
+
+    // Payload header first: rejects carriers without a payload before decoding blocks
+    auto headerResult = ReadPayloadHeader(std::min<std::size_t>(imgSize, HEADER_SIZE_BITS) + copies.size() * 8, [&](std::size_t bit) {
+        if (bit < HEADER_SIZE_BITS) {
+            return static_cast<uint32_t>(pixels[bit]);
+        }
+        bit -= HEADER_SIZE_BITS;
+        return static_cast<uint32_t>(copies[bit / 8] >> (bit % 8));
+    });
+    if (!headerResult) {
+        return Result<std::vector<uint8_t>>(headerResult.GetErrorCode(), headerResult.GetErrorMessage());
+    }
+    uint32_t dataSize = headerResult.GetValue().dataSize;
+
+    if (imgSize < PREFIX_BITS) {
+        std::ostringstream oss;
+        oss << "Image too small to contain embedded data. "
+            << "Has " << imgSize << " pixels, needs at least " << PREFIX_BITS;
+        return Result<std::vector<uint8_t>>(ErrorCode::ImageTooSmall, oss.str());
+    }
+
+    // Validate header
+    if (dataSize == 0) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::NoEmbeddedData,
+            "Extracted size is 0. Image may not contain embedded data."
+        );
+    }
+
+    if (codeParam < MIN_CODE_PARAM || codeParam > MAX_CODE_PARAM) {
+        std::ostringstream oss;
+        oss << "Extracted Hamming code parameter (" << codeParam << ") is invalid. "
+            << "Image may not contain Hamming embedded data.";
+        return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, oss.str());
+    }
+
+    if (dataSize > MAX_REASONABLE_SIZE) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) is unreasonably large (max " 
+            << MAX_REASONABLE_SIZE << " bytes). Data is likely corrupted or password is wrong.";
+        return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, oss.str());
+    }
+
+    std::size_t availableCapacity = BlockCapacity(imgSize, codeParam, PREFIX_BITS);
+    if (dataSize > availableCapacity) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) exceeds image capacity (" << availableCapacity
+            << " bytes for Hamming code p = " << codeParam << "). "
+            << "Data is corrupted or password may be wrong.";
+        return Result<std::vector<uint8_t>>(ErrorCode::InvalidDataSize, oss.str());
+    }
+
+    return Result<std::vector<uint8_t>>(DecodeBlocks(pixels.data() + PREFIX_BITS, codeParam, dataSize));
+}
@@ -0,0 +1,96 @@
+#ifndef __LSB_STEGO_HANDLER_HAMMING_H_
+#define __LSB_STEGO_HANDLER_HAMMING_H_
+
+#include "../LSBStegoHandler.h"
+#include "../../../utils/ImageIO.h"
+
+#include <vector>
+#include <string>
+
+/**
+ * @brief Implements matrix embedding (syndrome coding) with binary Hamming codes.
+ *
+ * The LSBs of each block of n = 2^p - 1 pixel values carry p payload bits as the
+ * Hamming syndrome of the block. Embedding changes at most one value per block,
+ * so far fewer pixels are touched per payload bit than with plain LSB replacement
+ * (e.g. p = 3 stores 3 bits in 7 values with <= 1 change).
+ *
+ * Format: [payload header | 8-bit code parameter p | syndrome coded data]
+ * The payload header and code parameter are stored in plain LSBs.
+ */
+class LSBStegoHandlerHamming : public LSBStegoHandler {
+public:
+    /**
+    * Size of the code parameter field (plain LSB, after the payload header)
+    **/
+    static constexpr uint32_t CODE_PARAM_BITS = 8;
+
+    /**
+    * Supported range of the code parameter p. Blocks of up to 63 values fit a 64-bit word.
+    **/
+    static constexpr int MIN_CODE_PARAM = 1;
+    static constexpr int MAX_CODE_PARAM = 6;
+
+    /**
+    * Pick the largest p that still fits the payload (fewest changes per bit)
+    **/
+    static constexpr int AUTO_CODE_PARAM = 0;
+
+    /**
+     * @brief Create a Hamming handler.
+     *
+     * @param codeParam Code parameter p in [MIN_CODE_PARAM, MAX_CODE_PARAM],
+     *                  or AUTO_CODE_PARAM to choose per payload
+     */
+    explicit LSBStegoHandlerHamming(int codeParam = AUTO_CODE_PARAM);
+
+    /**
+     * @brief Calculate matrix embedding capacity in bytes for a given pixel count and p.
+     * 
+     * @param pixelCount Total number of pixel values (width * height * channels)
+     * @param codeParam Code parameter p
+     * @return Maximum bytes that can be embedded
+     */
+    static std::size_t CalculateCapacity(std::size_t pixelCount, int codeParam);
+
+    /**
+     * @brief Choose the largest code parameter that fits the data.
+     *
+     * @param pixelCount Total number of pixel values
+     * @param dataSize Size of data to embed (in bytes)
+     * @return p in [MIN_CODE_PARAM, MAX_CODE_PARAM], or AUTO_CODE_PARAM if nothing fits
+     */
+    static int ChooseCodeParam(std::size_t pixelCount, std::size_t dataSize);
+
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::LSBHamming; }
+
+    ~LSBStegoHandlerHamming() override = default;
+
+protected:
+    /**
+     * @brief Embeds data into pixel array using Hamming matrix embedding.
+     * 
+     * @param imageData Samples to modify (in-place)
+     * @param dataToEmbed Data to embed (already encrypted)
+     * @param password unused
+     * @return Result indicating success or embedding error
+     */
+    Result<> EmbedSamples(ImageData &imageData,
+                          const std::vector<uint8_t> &dataToEmbed,
+                          const std::string &password ) override;
+
+    /**
+     * @brief Extracts data from pixel array using Hamming syndromes.
+     * 
+     * @param imageData Samples to read from
+     * @param password unused
+     * @return Result containing extracted data or error
+     */
+    Result<std::vector<uint8_t>> ExtractSamples(const ImageData &imageData,
+                                                const std::string &password ) override;
+
+private:
+    int codeParam_;
+};
+
+#endif // __LSB_STEGO_HANDLER_HAMMING_H_
@@ -0,0 +1,167 @@
+#include "LSBStegoHandlerMatching.h"
+#include "../../../utils/ImageIO.h"
+#include "../../../utils/CryptoModule.h"
+#include "../../../utils/CounterRNG.h"
+#include "../../../utils/CpuFeatures.h"
+
+#include <vector>
+#include <string>
+#include <array>
+#include <algorithm>
+
+namespace {
+
+constexpr std::size_t BITS_PER_RNG_BLOCK = CounterRNG::WORDS_PER_BLOCK * 32;
+
+/**
+ * +-1 kernel on samples [first, first + count) of a chunk. Payload bits and
+ * +-1 decisions are packed LSB first. For every value whose LSB differs from
+ * the wanted bit, add +1 when the sign bit is set (or the value is 0) and -1
+ * otherwise (or at 255).
+ */
+void MatchScalar(uint8_t *pixels, const uint8_t *bits, const uint32_t *signs, std::size_t first, std::size_t count) {
+    for (std::size_t idx = first; idx < first + count; ++idx) {
+        uint8_t value  = pixels[idx];
+        uint8_t change = (value ^ (bits[idx >> 3] >> (idx & 7))) & 1;
+        uint8_t sign   = (signs[idx >> 5] >> (idx & 31)) & 1;
+        uint8_t up     = (sign | (value == 0)) & (value != 255);
+        uint8_t step   = static_cast<uint8_t>((up << 1) - 1);      // 0x01 or 0xFF
+        pixels[idx]    = static_cast<uint8_t>(value + (step & (0 - change)));
+    }
+}
+
+#ifdef STEGTOOL_X86_SIMD
+
+/**
+ * 0xFF in the lanes whose bit is set, for 16 bits packed LSB first: pshufb
+ * spreads the 2 bytes over 16 lanes, each lane then tests its own bit
+ */
+__attribute__((target("ssse3")))
+inline __m128i ExpandBitsSsse3(const uint8_t *packed) {
+    const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m128i lanes = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    __m128i word = _mm_shuffle_epi8(_mm_cvtsi32_si128(packed[0] | (packed[1] << 8)), spread);
+    return _mm_cmpeq_epi8(_mm_and_si128(word, lanes), lanes);
+}
+
+/**
+ * 16 samples per step. x86 is little endian, so the sign words read as packed
+ * bytes in stream order.
+ */
+__attribute__((target("ssse3")))
+void MatchSsse3(uint8_t *pixels, const uint8_t *bits, const uint32_t *signs, std::size_t count) {
+    const uint8_t *signBytes = reinterpret_cast<const uint8_t *>(signs);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi8(-1);
+
+    std::size_t idx = 0;
+    for (; idx + 16 <= count; idx += 16) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + idx));
+        __m128i wanted = ExpandBitsSsse3(bits + idx / 8);
+        __m128i sign = ExpandBitsSsse3(signBytes + idx / 8);
+        __m128i change = _mm_cmpeq_epi8(_mm_and_si128(_mm_xor_si128(value, wanted), one), one);
+        __m128i up = _mm_andnot_si128(_mm_cmpeq_epi8(value, full), _mm_or_si128(sign, _mm_cmpeq_epi8(value, zero)));
+        __m128i step = _mm_sub_epi8(_mm_and_si128(up, two), one);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pixels + idx), _mm_add_epi8(value, _mm_and_si128(step, change)));
+    }
+    MatchScalar(pixels, bits, signs, idx, count - idx);
+}
+
+__attribute__((target("avx2")))
+inline __m256i ExpandBitsAvx2(const uint8_t *packed) {
+    // vpshufb works within each 128-bit lane: the low lane spreads bytes 0-1, the high lane bytes 2-3
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i lanes = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                           1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    uint32_t word = static_cast<uint32_t>(packed[0]) | (static_cast<uint32_t>(packed[1]) << 8) |
+                    (static_cast<uint32_t>(packed[2]) << 16) | (static_cast<uint32_t>(packed[3]) << 24);
+    __m256i spreadWord = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(word)), spread);
+    return _mm256_cmpeq_epi8(_mm256_and_si256(spreadWord, lanes), lanes);
+}
+
+__attribute__((target("avx2")))
+void MatchAvx2(uint8_t *pixels, const uint8_t *bits, const uint32_t *signs, std::size_t count) {
+    const uint8_t *signBytes = reinterpret_cast<const uint8_t *>(signs);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi8(2);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i full = _mm256_set1_epi8(-1);
+
+    std::size_t idx = 0;
+    for (; idx + 32 <= count; idx += 32) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + idx));
+        __m256i wanted = ExpandBitsAvx2(bits + idx / 8);
+        __m256i sign = ExpandBitsAvx2(signBytes + idx / 8);
+        __m256i change = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_xor_si256(value, wanted), one), one);
+        __m256i up = _mm256_andnot_si256(_mm256_cmpeq_epi8(value, full), _mm256_or_si256(sign, _mm256_cmpeq_epi8(value, zero)));
+        __m256i step = _mm256_sub_epi8(_mm256_and_si256(up, two), one);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(pixels + idx), _mm256_add_epi8(value, _mm256_and_si256(step, change)));
+    }
+    MatchScalar(pixels, bits, signs, idx, count - idx);
+}
+
+#endif
+
+void MatchPortable(uint8_t *pixels, const uint8_t *bits, const uint32_t *signs, std::size_t count) {
+    MatchScalar(pixels, bits, signs, 0, count);
+}
+
+using MatchFn = void (*)(uint8_t *, const uint8_t *, const uint32_t *, std::size_t);
+
+MatchFn SelectMatch() {
+#ifdef STEGTOOL_X86_SIMD
+    switch (CpuFeatures::GetSimdLevel()) {
+        case SimdLevel::Avx2: return MatchAvx2;
+        case SimdLevel::Ssse3: return MatchSsse3;
+        case SimdLevel::Portable: break;
+    }
+#endif
+    return MatchPortable;
+}
+
+} // namespace
+
+Result<> LSBStegoHandlerMatching::EmbedSamples(ImageData &imageData,
+                                               const std::vector<uint8_t> &dataToEmbed,
+                                               const std::string &password) {
+
+    if (dataToEmbed.empty()) {
+        return Result<>(ErrorCode::InvalidArgument, "Cannot embed empty data");
+    }
+
+    auto &pixels = imageData.pixels;
+
+    // Validate capacity
+    auto capacityCheck = LSBStegoHandler::ValidateCapacity(pixels.size(), dataToEmbed.size(), HEADER_SIZE_BITS, MAX_REASONABLE_SIZE);
+    if (!capacityCheck) {
+        return capacityCheck;
+    }
+
+    auto keyResult = CryptoModule::DeriveSubkey(password, "stegtool/lsb-matching/sign", CounterRNG::KEY_SIZE);
+    if (!keyResult) {
+        return Result<>(keyResult.GetErrorCode(), keyResult.GetErrorMessage());
+    }
+    CounterRNG rng(keyResult.GetValue());
+
+    // Bit stream: [payload header | data], bit k goes to pixel k
+    std::vector<uint8_t> stream = BuildPayload(dataToEmbed);
+
+    std::array<uint32_t, CHUNK_SIZE / 32> signs;
+    const MatchFn kernel = SelectMatch();
+
+    std::size_t totalBits = stream.size() * 8;
+    for (std::size_t chunkStart = 0; chunkStart < totalBits; chunkStart += CHUNK_SIZE) {
+        std::size_t count = std::min(CHUNK_SIZE, totalBits - chunkStart);
+
+        // +-1 decisions from the keyed counter stream (chunkStart is block aligned)
+        rng.Fill(chunkStart / BITS_PER_RNG_BLOCK, signs.data(), (count + 31) / 32);
+
+        // Payload bits stay packed, chunkStart is byte aligned
+        kernel(pixels.data() + chunkStart, stream.data() + chunkStart / 8, signs.data(), count);
+    }
+
+    return Result<>();
+}
@@ -0,0 +1,60 @@
+#ifndef __LSB_STEGO_HANDLER_MATCHING_H_
+#define __LSB_STEGO_HANDLER_MATCHING_H_
+
+#include "../ordered/LSBStegoHandlerOrdered.h"
+#include "../../../utils/ImageIO.h"
+
+#include <vector>
+#include <string>
+
+/**
+ * @brief Implements LSB matching (+-1 embedding) for images.
+ *
+ * Uses the same bit layout as LSBStegoHandlerOrdered, so extraction is
+ * inherited unchanged. Instead of overwriting the LSB, a pixel value whose
+ * LSB differs from the payload bit is randomly incremented or decremented
+ * (saturating at 0/255). This avoids the pairs-of-values asymmetry that
+ * makes plain LSB replacement trivially detectable.
+ *
+ * The +-1 choices come from a counter-based PRNG keyed from the password,
+ * and the embedding runs per chunk on packed bits, with SSSE3 or AVX2 when
+ * the CPU has them.
+ */
+class LSBStegoHandlerMatching : public LSBStegoHandlerOrdered {
+public:
+    /**
+     * Number of pixel values processed per kernel invocation
+     **/
+    static constexpr std::size_t CHUNK_SIZE = 4096;
+
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::LSBMatching; }
+
+    ~LSBStegoHandlerMatching() override = default;
+
+protected:
+    /**
+     * @brief +-1 changes carry into higher bits, so only bit plane 0 of 8-bit images works.
+     */
+    bool RequiresWholeSamples() const override { return true; }
+
+    /**
+     * @brief Newer than the payload header, unlike the ordered LSB it extends.
+     */
+    bool AcceptsLegacyHeader() const override { return false; }
+
+    /**
+     * @brief Embeds data into pixel array using LSB matching.
+     * 
+     * Format: [payload header | data bits]
+     * 
+     * @param imageData Samples to modify (in-place)
+     * @param dataToEmbed Data to embed (already encrypted)
+     * @param password Password used to key the +-1 decisions
+     * @return Result indicating success or embedding error
+     */
+    Result<> EmbedSamples(ImageData &imageData,
+                          const std::vector<uint8_t> &dataToEmbed,
+                          const std::string &password ) override;
+};
+
+#endif // __LSB_STEGO_HANDLER_MATCHING_H_
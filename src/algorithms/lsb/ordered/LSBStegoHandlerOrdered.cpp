@@ -2,14 +2,15 @@
 #include "../../../utils/ImageIO.h"
 #include "../../../utils/CryptoModule.h"
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <sstream>
 
-Result<> LSBStegoHandlerOrdered::EmbedMethod(ImageData &imageData,
-                                             const std::vector<uint8_t> &dataToEmbed,
-                                             const std::string &password ) {
+Result<> LSBStegoHandlerOrdered::EmbedSamples(ImageData &imageData,
+                                              const std::vector<uint8_t> &dataToEmbed,
+                                              const std::string &password ) {
     
     (void) password; //Avoid unused parameter warning for LSB Method
     
@@ -25,19 +26,12 @@ Result<> LSBStegoHandlerOrdered::EmbedMethod(ImageData &imageData,
         return capacityCheck;
     }
 
-    uint32_t dataSize = static_cast<uint32_t>(dataToEmbed.size());
-
-    // Embed size header
-    for (std::size_t idx = 0; idx < HEADER_SIZE_BITS; ++idx) {
-        uint8_t bit = (dataSize >> idx) & 1;
-        pixels[idx] = (pixels[idx] & 0xFE) | bit;
-    }
-    
-    // Embed data bits
-    for (std::size_t byteIdx = 0; byteIdx < dataSize; ++byteIdx) {
+    // Bit stream: [payload header | data], bit k goes to pixel k
+    std::vector<uint8_t> stream = BuildPayload(dataToEmbed);
+    for (std::size_t byteIdx = 0; byteIdx < stream.size(); ++byteIdx) {
         for (int bitIdx = 0; bitIdx < 8; ++bitIdx) {
-            uint8_t bit = (dataToEmbed[byteIdx] >> bitIdx) & 1;
-            std::size_t pixelIdx = HEADER_SIZE_BITS + (byteIdx * 8) + bitIdx;
+            uint8_t bit = (stream[byteIdx] >> bitIdx) & 1;
+            std::size_t pixelIdx = (byteIdx * 8) + bitIdx;
             pixels[pixelIdx] = (pixels[pixelIdx] & 0xFE) | bit;
         }
     }
@@ -45,27 +39,39 @@ Result<> LSBStegoHandlerOrdered::EmbedMethod(ImageData &imageData,
     return Result<>();
 }
 
-Result<std::vector<uint8_t>> LSBStegoHandlerOrdered::ExtractMethod(const ImageData &imageData, 
-                                                                   const std::string &password ) {
+Result<> LSBStegoHandlerOrdered::MarkPositions(std::vector<uint8_t> &marks, std::size_t dataBytes,
+                                               const std::string &password) const {
+
+    (void) password; //Avoid unused parameter warning for LSB Method
+
+    auto capacityCheck = LSBStegoHandler::ValidateCapacity(marks.size(), dataBytes, HEADER_SIZE_BITS, MAX_REASONABLE_SIZE);
+    if (!capacityCheck) {
+        return capacityCheck;
+    }
+
+    std::size_t bitCount = (dataBytes + HEADER_SIZE_BYTES) * 8;
+    std::fill(marks.begin(), marks.begin() + bitCount, 0xFF);
+    return Result<>();
+}
+
+Result<std::vector<uint8_t>> LSBStegoHandlerOrdered::ExtractSamples(const ImageData &imageData, 
+                                                                    const std::string &password ) {
     
     (void) password; //Avoid unused parameter warning for LSB Method
 
     auto &pixels = imageData.pixels;
 
     std::size_t imgSize = pixels.size();
-    // Validate minimum size
-    if (imgSize < HEADER_SIZE_BITS) {
-        std::ostringstream oss;
-        oss << "Image too small to contain embedded data. "
-            << "Has " << imgSize << " pixels, needs at least " << HEADER_SIZE_BITS;
-        return Result<std::vector<uint8_t>>(ErrorCode::ImageTooSmall, oss.str());
-    }
 
-    // Extract size header
-    uint32_t dataSize = 0;
-    for (std::size_t idx = 0; idx < HEADER_SIZE_BITS; ++idx) {
-        dataSize |= (pixels[idx] & 1) << idx;
+    // Header first: rejects carriers without a payload before reading the rest
+    auto headerResult = ReadPayloadHeader(imgSize, [&](std::size_t bit) {
+        return pixels[bit];
+    });
+    if (!headerResult) {
+        return Result<std::vector<uint8_t>>(headerResult.GetErrorCode(), headerResult.GetErrorMessage());
     }
+    uint32_t dataSize = headerResult.GetValue().dataSize;
+    std::size_t headerBits = headerResult.GetValue().GetSizeBits();
 
     // Validate size
     if (dataSize == 0) {
@@ -85,11 +91,12 @@ Result<std::vector<uint8_t>> LSBStegoHandlerOrdered::ExtractMethod(const ImageDa
         );
     }
     
-    if (dataSize * 8 + HEADER_SIZE_BITS > imgSize) {
+    std::size_t neededBits = static_cast<std::size_t>(dataSize) * 8 + headerBits;
+    if (neededBits > imgSize) {
         std::ostringstream oss;
         oss << "Extracted size (" << dataSize << " bytes) exceeds image capacity. "
             << "Image has " << imgSize << " pixel values, "
-            << "but would need " << (dataSize * 8 + HEADER_SIZE_BITS) << " values. "
+            << "but would need " << neededBits << " values. "
             << "Data is corrupted or password may be wrong.";
         return Result<std::vector<uint8_t>>(
             ErrorCode::InvalidDataSize,
@@ -101,7 +108,7 @@ Result<std::vector<uint8_t>> LSBStegoHandlerOrdered::ExtractMethod(const ImageDa
     std::vector<uint8_t> extractedData(dataSize, 0);
     for (std::size_t byteIdx = 0; byteIdx < dataSize; ++byteIdx) {
         for (int bitIdx = 0; bitIdx < 8; ++bitIdx) {
-            std::size_t pixelIdx = HEADER_SIZE_BITS + (byteIdx * 8) + bitIdx;
+            std::size_t pixelIdx = headerBits + (byteIdx * 8) + bitIdx;
             uint8_t bit = pixels[pixelIdx] & 1;
             extractedData[byteIdx] |= (bit << bitIdx);
         }
@@ -16,33 +16,47 @@
  */
 class LSBStegoHandlerOrdered : public LSBStegoHandler {
 public:
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::LSB; }
+
+    ~LSBStegoHandlerOrdered() override = default;
+
+protected:
+    /**
+     * @brief Payloads embedded before the header existed start with a bare size.
+     */
+    bool AcceptsLegacyHeader() const override { return true; }
+
     /**
      * @brief Embeds data into pixel array using LSB technique.
      * 
-     * Format: [32-bit size header | data bits]
+     * Format: [payload header | data bits]
      * 
-     * @param pixels Pixel data to modify (in-place)
+     * @param imageData Samples to modify (in-place)
      * @param dataToEmbed Data to embed (already encrypted)
      * @param password unused
      * @return Result indicating success or embedding error
      */
-    Result<> EmbedMethod(ImageData &imageData,
-                         const std::vector<uint8_t> &dataToEmbed,
-                         const std::string &password ) override;
-    
+    Result<> EmbedSamples(ImageData &imageData,
+                          const std::vector<uint8_t> &dataToEmbed,
+                          const std::string &password ) override;
+
     /**
      * @brief Extracts data from pixel array using LSB technique.
      * 
-     * @param pixels Pixel data to read from
+     * @param imageData Samples to read from
      * @param password unused
      * @return Result containing extracted data or error
      */
-    Result<std::vector<uint8_t>> ExtractMethod(const ImageData &imageData,
-                                               const std::string &password ) override;
+    Result<std::vector<uint8_t>> ExtractSamples(const ImageData &imageData,
+                                                const std::string &password ) override;
 
-    ~LSBStegoHandlerOrdered() override = default;
+    bool HasPositionMap() const override { return true; }
 
+    /**
+     * @brief Marks the first (header + data) bits' samples, the password is unused.
+     */
+    Result<> MarkPositions(std::vector<uint8_t> &marks, std::size_t dataBytes,
+                           const std::string &password) const override;
 };
 
-
 #endif // __LSB_STEGO_HANDLER_ORDERED_H_
@@ -1,18 +1,23 @@
 #include "LSBStegoHandlerShuffle.h"
 #include "../../../utils/ImageIO.h"
-#include "../../../utils/CryptoModule.h"
 
 #include <vector>
 #include <string>
-#include <fstream>
+#include <limits>
 #include <sstream>
-#include <random>
-#include <algorithm>
-#include <iostream>
 
-Result<> LSBStegoHandlerShuffle::EmbedMethod(ImageData &imageData,
-                                             const std::vector<uint8_t> &dataToEmbed,
-                                             const std::string &password) {
+namespace {
+
+// 32-bit positions whenever the image allows, half the memory and bandwidth of 64-bit ones
+bool FitsIndex32(std::size_t imgSize) {
+    return imgSize <= static_cast<std::size_t>(std::numeric_limits<uint32_t>::max());
+}
+
+} // namespace
+
+Result<> LSBStegoHandlerShuffle::EmbedSamples(ImageData &imageData,
+                                              const std::vector<uint8_t> &dataToEmbed,
+                                              const std::string &password) {
     
     auto &pixels = imageData.pixels;
 
@@ -28,76 +33,171 @@ Result<> LSBStegoHandlerShuffle::EmbedMethod(ImageData &imageData,
 
     std::size_t imgSize = pixels.size();
     
-    //start shuffling img bit locations
-    std::size_t seed = std::hash<std::string>{}(password);
-    std::mt19937_64 shuffler(seed);
+    // Header and data, LSB first
+    std::vector<uint8_t> dataVector = BuildPayload(dataToEmbed);
+
+    return FitsIndex32(imgSize) ? EmbedWith<uint32_t>(pixels, dataVector, password)
+                                : EmbedWith<uint64_t>(pixels, dataVector, password);
+}
+
+std::size_t LSBStegoHandlerShuffle::EstimateEmbedMemory(const ImageData &header, std::size_t sampleBytes,
+                                                        std::size_t dataBytes) const {
+    std::size_t samples = CountSamples(header);
+    std::size_t indexBytes = FitsIndex32(samples) ? sizeof(uint32_t) : sizeof(uint64_t);
+    return LSBStegoHandler::EstimateEmbedMemory(header, sampleBytes, dataBytes) + samples * indexBytes;
+}
 
-    std::vector<std::size_t> imgBitLocationList(imgSize);
-    for (std::size_t i = 0; i < imgSize; ++i) {
-        imgBitLocationList[i] = i;
+bool LSBStegoHandlerShuffle::UsePartitioned(std::size_t sampleCount, std::size_t bitCount, bool writing) const {
+    if (sampleCount > PartitionedAccess::MAX_SAMPLES) {
+        return false;
     }
-    std::shuffle(imgBitLocationList.begin(), imgBitLocationList.end(), shuffler);
-    
-    uint32_t dataSize = static_cast<uint32_t>(dataToEmbed.size());
-    uint64_t binarySize = (dataSize * 8) + HEADER_SIZE_BITS;
-
-    std::vector<uint8_t> dataVector(binarySize);
-    // Store datasize LSB first to simplify reading
-    dataVector[0] = static_cast<uint8_t>(dataSize         & 0xFF);
-    dataVector[1] = static_cast<uint8_t>((dataSize >>  8) & 0xFF);
-    dataVector[2] = static_cast<uint8_t>((dataSize >> 16) & 0xFF);
-    dataVector[3] = static_cast<uint8_t>((dataSize >> 24) & 0xFF);
-    // Copy dataToEmbed into dataVector after header
-    std::copy(dataToEmbed.begin(), dataToEmbed.end(), dataVector.begin() + HEADER_SIZE_BYTES);
-    
-    // Embed data bits
-    for (std::size_t byteIdx = 0; byteIdx < (dataSize + HEADER_SIZE_BYTES); ++byteIdx) {
+    // Direct random reads overlap well enough, only writes pay off by default
+    if (access_ == AccessMode::Auto) {
+        return writing && sampleCount >= PartitionedAccess::MIN_SAMPLES &&
+               FitsMemoryLimit(bitCount * sizeof(uint32_t));
+    }
+    return access_ == AccessMode::Partitioned;
+}
+
+template <typename Index>
+Result<std::shared_ptr<const Index>> LSBStegoHandlerShuffle::LoadPermutation(std::size_t size,
+                                                                              const std::string &password,
+                                                                              ShuffleMode mode,
+                                                                              std::pmr::memory_resource *resource) const {
+    auto build = [&]() {
+        if (mode == ShuffleMode::Legacy) {
+            return Result<std::vector<Index>>(ShufflePermutation::BuildLegacy<Index>(size, password));
+        }
+        return ShufflePermutation::BuildKeyed<Index>(size, password);
+    };
+
+    if (!cache_ && mode == ShuffleMode::Keyed) {
+        auto owner = std::make_shared<std::pmr::vector<Index>>(size, resource);
+        auto buildResult = ShufflePermutation::BuildKeyed(size, password, owner->data());
+        if (!buildResult) {
+            return Result<std::shared_ptr<const Index>>(buildResult.GetErrorCode(), buildResult.GetErrorMessage());
+        }
+        return Result<std::shared_ptr<const Index>>(std::shared_ptr<const Index>(owner, owner->data()));
+    }
+    if (!cache_) {
+        auto permResult = build();
+        if (!permResult) {
+            return Result<std::shared_ptr<const Index>>(permResult.GetErrorCode(), permResult.GetErrorMessage());
+        }
+        auto owner = std::make_shared<const std::vector<Index>>(std::move(permResult.GetValue()));
+        return Result<std::shared_ptr<const Index>>(std::shared_ptr<const Index>(owner, owner->data()));
+    }
+
+    auto digestResult = cache_->Digest(password, mode == ShuffleMode::Legacy ? "legacy" : "keyed");
+    if (!digestResult) {
+        return Result<std::shared_ptr<const Index>>(digestResult.GetErrorCode(), digestResult.GetErrorMessage());
+    }
+    return cache_->GetOrBuild<Index>(digestResult.GetValue(), size, build);
+}
+
+template <typename Index>
+Result<> LSBStegoHandlerShuffle::EmbedWith(std::vector<uint8_t> &pixels, const std::vector<uint8_t> &dataVector,
+                                           const std::string &password) const {
+    // Lives until the embed phase ends, a fit for its arena
+    auto permResult = LoadPermutation<Index>(pixels.size(), password, mode_, GetArena());
+    if (!permResult) {
+        return Result<>(permResult.GetErrorCode(), permResult.GetErrorMessage());
+    }
+    EmbedPermuted(pixels, dataVector, permResult.GetValue().get());
+    return Result<>();
+}
+
+template <typename Index>
+void LSBStegoHandlerShuffle::EmbedPermuted(std::vector<uint8_t> &pixels, const std::vector<uint8_t> &dataVector,
+                                           const Index *perm) const {
+    if (UsePartitioned(pixels.size(), dataVector.size() * 8, true)) {
+        PartitionedAccess::Write(pixels, dataVector, perm, GetArena());
+        return;
+    }
+    for (std::size_t byteIdx = 0; byteIdx < dataVector.size(); ++byteIdx) {
         for (uint8_t bitIdx = 0; bitIdx < 8; ++bitIdx) {
-            size_t bitIndex = (byteIdx * 8) + bitIdx;           //get location of bit
+            std::size_t location = static_cast<std::size_t>(perm[(byteIdx * 8) + bitIdx]);
             uint8_t bit = (dataVector[byteIdx] >> bitIdx) & 1; //fetch data from linear data location 
-            pixels[imgBitLocationList[bitIndex]] = (pixels[imgBitLocationList[bitIndex]] & 0xFE) | bit; // insert data on shuffled pixel location
+            pixels[location] = (pixels[location] & 0xFE) | bit; // insert data on shuffled pixel location
         }   
     }
+}
+
+Result<> LSBStegoHandlerShuffle::MarkPositions(std::vector<uint8_t> &marks, std::size_t dataBytes,
+                                               const std::string &password) const {
+
+    auto capacityCheck = LSBStegoHandler::ValidateCapacity(marks.size(), dataBytes, HEADER_SIZE_BITS, MAX_REASONABLE_SIZE);
+    if (!capacityCheck) {
+        return capacityCheck;
+    }
 
+    std::size_t bitCount = (dataBytes + HEADER_SIZE_BYTES) * 8;
+    return FitsIndex32(marks.size()) ? MarkWith<uint32_t>(marks, bitCount, password)
+                                     : MarkWith<uint64_t>(marks, bitCount, password);
+}
+
+template <typename Index>
+Result<> LSBStegoHandlerShuffle::MarkWith(std::vector<uint8_t> &marks, std::size_t bitCount,
+                                          const std::string &password) const {
+    auto permResult = LoadPermutation<Index>(marks.size(), password, mode_, std::pmr::get_default_resource());
+    if (!permResult) {
+        return Result<>(permResult.GetErrorCode(), permResult.GetErrorMessage());
+    }
+    const Index *perm = permResult.GetValue().get();
+    for (std::size_t bitIdx = 0; bitIdx < bitCount; ++bitIdx) {
+        marks[static_cast<std::size_t>(perm[bitIdx])] = 0xFF;
+    }
     return Result<>();
 }
 
-Result<std::vector<uint8_t>> LSBStegoHandlerShuffle::ExtractMethod(const ImageData &imageData, 
-                                                                   const std::string &password) {
+Result<std::vector<uint8_t>> LSBStegoHandlerShuffle::ExtractSamples(const ImageData &imageData, 
+                                                                    const std::string &password) {
     
+    std::size_t imgSize = imageData.pixels.size();
 
-    auto &pixels = imageData.pixels;                                                    
-                    
-    std::size_t imgSize = pixels.size();
-    
-    // Validate minimum size
-    if (imgSize < HEADER_SIZE_BITS) {
-        std::ostringstream oss;
-        oss << "Image too small to contain embedded data. "
-            << "Has " << imgSize << " pixels, needs at least " << HEADER_SIZE_BITS;
-        return Result<std::vector<uint8_t>>(ErrorCode::ImageTooSmall, oss.str());
+    auto extract = [&](ShuffleMode mode) {
+        return FitsIndex32(imgSize) ? ExtractWith<uint32_t>(imageData, password, mode)
+                                    : ExtractWith<uint64_t>(imageData, password, mode);
+    };
+
+    // Keyed permutation first, then the one older versions embedded with
+    auto keyedResult = extract(ShuffleMode::Keyed);
+    if (keyedResult || IsCancelled()) {
+        return keyedResult;
     }
 
-    // Extract size header
-    uint32_t dataSize = 0;
-    
-    //start shuffling pixel list
-    std::size_t seed = std::hash<std::string>{}(password);
-    std::mt19937_64 shuffler(seed);
-    
-    std::vector<std::size_t> imgBitLocationList(imgSize);
-    for (std::size_t i = 0; i < imgSize; ++i) {
-        imgBitLocationList[i] = i;
+    auto legacyResult = extract(ShuffleMode::Legacy);
+    return legacyResult ? legacyResult : keyedResult;
+}
+
+template <typename Index>
+Result<std::vector<uint8_t>> LSBStegoHandlerShuffle::ExtractWith(const ImageData &imageData,
+                                                                 const std::string &password, ShuffleMode mode) {
+    // Extract may build a second permutation after this one, the heap lets the first go
+    auto permResult = LoadPermutation<Index>(imageData.pixels.size(), password, mode,
+                                             std::pmr::get_default_resource());
+    if (!permResult) {
+        return Result<std::vector<uint8_t>>(permResult.GetErrorCode(), permResult.GetErrorMessage());
     }
-    std::shuffle(imgBitLocationList.begin(), imgBitLocationList.end(), shuffler);
+    return ExtractPermuted(imageData, permResult.GetValue().get());
+}
+
+template <typename Index>
+Result<std::vector<uint8_t>> LSBStegoHandlerShuffle::ExtractPermuted(const ImageData &imageData,
+                                                                     const Index *perm) {
+
+    auto &pixels = imageData.pixels;
+    std::size_t imgSize = pixels.size();
     
-    // Extract img datasize bits in reverse 1st is msb
-    for (std::size_t byteIdx = 0; byteIdx < HEADER_SIZE_BYTES; ++byteIdx) {
-        for (uint8_t bitIdx = 0; bitIdx < 8; ++bitIdx) {
-            size_t bitIndex = (byteIdx * 8) + bitIdx;           //get location of bit
-            dataSize |= (pixels[imgBitLocationList[bitIndex]] & 1) << bitIndex; // insert data on shuffled pixel location
-        }   
+    // Header first: rejects carriers without a payload before reading the rest
+    auto headerResult = ReadPayloadHeader(imgSize, [&](std::size_t bitIndex) {
+        return pixels[perm[bitIndex]];
+    });
+    if (!headerResult) {
+        return Result<std::vector<uint8_t>>(headerResult.GetErrorCode(), headerResult.GetErrorMessage());
     }
+    uint32_t dataSize = headerResult.GetValue().dataSize;
+    std::size_t headerBytes = headerResult.GetValue().GetSizeBytes();
 
     // Validate size
     if (dataSize == 0) {
@@ -117,11 +217,12 @@ Result<std::vector<uint8_t>> LSBStegoHandlerShuffle::ExtractMethod(const ImageDa
         );
     }
     
-    if (dataSize * 8 + HEADER_SIZE_BITS > imgSize) {
+    std::size_t neededBits = (static_cast<std::size_t>(dataSize) + headerBytes) * 8;
+    if (neededBits > imgSize) {
         std::ostringstream oss;
         oss << "Extracted size (" << dataSize << " bytes) exceeds image capacity. "
             << "Image has " << imgSize << " pixel values, "
-            << "but would need " << (dataSize * 8 + HEADER_SIZE_BITS) << " values. "
+            << "but would need " << neededBits << " values. "
             << "Data is corrupted or password may be wrong.";
         return Result<std::vector<uint8_t>>(
             ErrorCode::InvalidDataSize,
@@ -130,11 +231,14 @@ Result<std::vector<uint8_t>> LSBStegoHandlerShuffle::ExtractMethod(const ImageDa
     }
     
     // Extract the data bits
+    if (UsePartitioned(imgSize, neededBits - headerBytes * 8, false)) {
+        return Result<std::vector<uint8_t>>(PartitionedAccess::Read(pixels, perm, headerBytes * 8, dataSize));
+    }
     std::vector<uint8_t> extractedData(dataSize, 0);
     for (std::size_t byteIdx = 0; byteIdx < dataSize ; ++byteIdx) {
         for (uint8_t bitIdx = 0; bitIdx < 8; ++bitIdx) {
-            size_t bitIndex = ((byteIdx + HEADER_SIZE_BYTES) * 8) + bitIdx; //provide offset from HEADER location
-            uint8_t bit = (pixels[imgBitLocationList[bitIndex]] & 1); //retrieve location based on locationlist
+            std::size_t bitIndex = ((byteIdx + headerBytes) * 8) + bitIdx; //provide offset from HEADER location
+            uint8_t bit = (pixels[perm[bitIndex]] & 1); //retrieve location based on locationlist
             extractedData[byteIdx] |= (bit << bitIdx);
         }
     }
@@ -3,6 +3,11 @@
 
 #include "../LSBStegoHandler.h"
 #include "../../../utils/ImageIO.h"
+#include "ShufflePermutation.h"
+#include "PartitionedAccess.h"
+#include "PermutationCache.h"
+
+#include <memory>
 
 /**
  * @brief Implements LSB (Least Significant Bit) steganography for images with password-based pixel shuffling.
@@ -14,32 +19,150 @@
  */
 class LSBStegoHandlerShuffle : public LSBStegoHandler {
 public:
+    /**
+     * @brief How embedding positions are permuted, see ShufflePermutation.
+     *
+     * Keyed is portable and parallel; Legacy reproduces older versions, whose
+     * permutation depended on the standard library. Extract tries both.
+     */
+    enum class ShuffleMode {
+        Keyed,
+        Legacy
+    };
+
+    /**
+     * @brief How bits reach their shuffled samples, see PartitionedAccess.
+     *
+     * Auto partitions embedding from PartitionedAccess::MIN_SAMPLES samples on,
+     * unless its slots would exceed the memory limit, and extracts directly.
+     * All modes give the same output.
+     */
+    enum class AccessMode {
+        Auto,
+        Direct,
+        Partitioned
+    };
+
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::LSBShuffle; }
+
+    /**
+     * @brief Select the permutation Embed uses (Keyed by default).
+     */
+    void SetShuffleMode(ShuffleMode mode) { mode_ = mode; }
+    ShuffleMode GetShuffleMode() const { return mode_; }
+
+    /**
+     * @brief Select how Embed and Extract access samples (Auto by default).
+     */
+    void SetAccessMode(AccessMode mode) { access_ = mode; }
+    AccessMode GetAccessMode() const { return access_; }
+
+    /**
+     * @brief Reuse permutations through a cache (none by default).
+     *
+     * Worth it when many images of the same size are processed with one
+     * password. The cache may be shared by several handlers.
+     */
+    void SetPermutationCache(std::shared_ptr<PermutationCache> cache) { cache_ = std::move(cache); }
+    const std::shared_ptr<PermutationCache> &GetPermutationCache() const { return cache_; }
+
+    /**
+     * @brief Adds the permutation, 4 or 8 bytes per sample, to the LSB estimate.
+     */
+    std::size_t EstimateEmbedMemory(const ImageData &header, std::size_t sampleBytes,
+                                    std::size_t dataBytes) const override;
+
+    ~LSBStegoHandlerShuffle() override = default;
+
+protected:
+    /**
+     * @brief Payloads embedded before the header existed start with a bare size.
+     */
+    bool AcceptsLegacyHeader() const override { return true; }
+
     /**
      * @brief Embeds data into pixel array using LSB Shuffled technique.
      * 
-     * Format: [32-bit size header | data bits]
+     * Format: [payload header | data bits]
      * 
-     * @param pixels Pixel data to modify (in-place)
+     * @param imageData Samples to modify (in-place)
      * @param dataToEmbed Data to embed (already encrypted)
      * @param password Password used to shuffle the data
      * @return Result indicating success or embedding error
      */
-    Result<> EmbedMethod(ImageData &imageData,
-                         const std::vector<uint8_t> &dataToEmbed,
-                         const std::string &password ) override;
-    
+    Result<> EmbedSamples(ImageData &imageData,
+                          const std::vector<uint8_t> &dataToEmbed,
+                          const std::string &password ) override;
+
     /**
      * @brief Extracts data from pixel array using LSB Shuffled technique.
      * 
-     * @param pixels Pixel data to read from
+     * @param imageData Samples to read from
      * @param password Password used to unshuffle the data
      * @return Result containing extracted data or error
      */
-    Result<std::vector<uint8_t>> ExtractMethod(const ImageData &imageData,
-                                               const std::string &password ) override;     
+    Result<std::vector<uint8_t>> ExtractSamples(const ImageData &imageData,
+                                                const std::string &password ) override;     
 
-    ~LSBStegoHandlerShuffle() override = default;
+    bool HasPositionMap() const override { return true; }
+
+    /**
+     * @brief Marks the samples the permutation of mode_ gives to the header and data bits.
+     */
+    Result<> MarkPositions(std::vector<uint8_t> &marks, std::size_t dataBytes,
+                           const std::string &password) const override;
+
+private:
+    /**
+     * @brief Build a permutation with Index sized positions, or take it from the cache.
+     *
+     * Built keyed permutations are allocated from resource.
+     */
+    template <typename Index>
+    Result<std::shared_ptr<const Index>> LoadPermutation(std::size_t size, const std::string &password,
+                                                         ShuffleMode mode, std::pmr::memory_resource *resource) const;
+
+    /**
+     * @brief Embed through the permutation of mode_ with Index sized positions.
+     */
+    template <typename Index>
+    Result<> EmbedWith(std::vector<uint8_t> &pixels, const std::vector<uint8_t> &dataVector,
+                       const std::string &password) const;
+
+    /**
+     * @brief Extract through the permutation of 'mode' with Index sized positions.
+     */
+    template <typename Index>
+    Result<std::vector<uint8_t>> ExtractWith(const ImageData &imageData, const std::string &password,
+                                             ShuffleMode mode);
+
+    /**
+     * @brief Mark bitCount positions of the permutation of mode_ with Index sized positions.
+     */
+    template <typename Index>
+    Result<> MarkWith(std::vector<uint8_t> &marks, std::size_t bitCount, const std::string &password) const;
+
+    /**
+     * @brief Write the payload through a permutation.
+     */
+    template <typename Index>
+    void EmbedPermuted(std::vector<uint8_t> &pixels, const std::vector<uint8_t> &dataVector,
+                       const Index *perm) const;
+
+    /**
+     * @brief Read the payload header and data through a permutation.
+     */
+    template <typename Index>
+    Result<std::vector<uint8_t>> ExtractPermuted(const ImageData &imageData, const Index *perm);
+
+    /**
+     * @brief Whether to use PartitionedAccess for writing or reading bitCount bits among sampleCount samples.
+     */
+    bool UsePartitioned(std::size_t sampleCount, std::size_t bitCount, bool writing) const;
 
+    ShuffleMode mode_ = ShuffleMode::Keyed;
+    AccessMode access_ = AccessMode::Auto;
+    std::shared_ptr<PermutationCache> cache_;
 };
 
 #endif // __LSB_SHUFFLE_STEGO_HANDLER_H_
@@ -0,0 +1,243 @@
+#include "PartitionedAccess.h"
+#include "../../../utils/Parallel.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+constexpr unsigned FANOUT_BITS = 6;                      // regions per partitioning pass: 64 write streams
+constexpr unsigned MIN_REGION_BITS = 12;                 // log2 of PartitionedAccess::MIN_REGION
+constexpr std::size_t MIN_CHUNK = std::size_t(1) << 16;  // permutation entries per partitioning chunk, at least
+constexpr std::size_t CHUNK_ALIGN = 1024;                // keeps chunks on whole output bytes
+constexpr std::size_t PREFETCH_DISTANCE = 16;            // entries between a prefetch and its use
+
+static_assert((std::size_t(1) << MIN_REGION_BITS) == PartitionedAccess::MIN_REGION, "region size mismatch");
+
+/**
+ * Cache hint for a sample read (or, with forWrite, written) PREFETCH_DISTANCE entries later; a no-op
+ * where the compiler has no prefetch intrinsic
+ */
+template <bool forWrite = false>
+inline void Prefetch(const uint8_t *address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, forWrite ? 1 : 0);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(reinterpret_cast<const char *>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+/**
+ * Bits needed to address 'count' positions
+ */
+unsigned AddressBits(std::size_t count) {
+    unsigned bits = 0;
+    while (bits < 64 && (count - 1) >> bits) {
+        ++bits;
+    }
+    return bits;
+}
+
+/**
+ * First pass: entries of perm, starting at firstBit, split by the top bits of their position.
+ * cursors[chunk * regionCount + region] is where that chunk's first entry for
+ * that region goes; region r owns slots [regionStart[r], regionStart[r + 1]).
+ */
+struct Partition {
+    unsigned shift = 0;
+    std::size_t regionCount = 0;
+    std::size_t chunkSize = 0;
+    std::size_t chunkCount = 0;
+    std::vector<std::size_t> cursors;
+    std::vector<std::size_t> regionStart;
+};
+
+template <typename Index>
+Partition MakePartition(std::size_t sampleCount, const Index *perm,
+                        std::size_t firstBit, std::size_t bitCount) {
+    Partition partition;
+    unsigned addressBits = AddressBits(sampleCount);
+    partition.shift = std::max(MIN_REGION_BITS, addressBits > FANOUT_BITS ? addressBits - FANOUT_BITS : 0);
+    partition.regionCount = ((sampleCount - 1) >> partition.shift) + 1;
+
+    std::size_t threads = Parallel::GetThreadCount();
+    partition.chunkSize = std::max(MIN_CHUNK, (bitCount + threads - 1) / threads);
+    partition.chunkSize = (partition.chunkSize + CHUNK_ALIGN - 1) / CHUNK_ALIGN * CHUNK_ALIGN;
+    partition.chunkCount = (bitCount + partition.chunkSize - 1) / partition.chunkSize;
+
+    const std::size_t regionCount = partition.regionCount;
+    const unsigned shift = partition.shift;
+    auto &cursors = partition.cursors;
+    cursors.assign(partition.chunkCount * regionCount, 0);
+
+    // Entries per chunk and region
+    Parallel::For(partition.chunkCount, [&](std::size_t chunk) {
+        std::size_t *counts = cursors.data() + chunk * regionCount;
+        std::size_t end = std::min(bitCount, (chunk + 1) * partition.chunkSize);
+        for (std::size_t k = chunk * partition.chunkSize; k < end; ++k) {
+            ++counts[static_cast<std::size_t>(perm[firstBit + k]) >> shift];
+        }
+    });
+
+    // Regions in order, chunks in order within a region
+    partition.regionStart.assign(regionCount + 1, 0);
+    std::size_t running = 0;
+    for (std::size_t region = 0; region < regionCount; ++region) {
+        partition.regionStart[region] = running;
+        for (std::size_t chunk = 0; chunk < partition.chunkCount; ++chunk) {
+            std::size_t count = cursors[chunk * regionCount + region];
+            cursors[chunk * regionCount + region] = running;
+            running += count;
+        }
+    }
+    partition.regionStart[regionCount] = running;
+    return partition;
+}
+
+/**
+ * Call func(k, sampleOffset, slot) for the chunk's entries, slot being where the entry
+ * was partitioned to; sampleOffset is relative to the start of its region.
+ */
+template <typename Index, typename Func>
+void ForEachEntry(const Partition &partition, const Index *perm, std::size_t firstBit,
+                  std::size_t bitCount, std::size_t chunk, const Func &func) {
+    std::vector<std::size_t> cursor(partition.cursors.begin() + chunk * partition.regionCount,
+                                    partition.cursors.begin() + (chunk + 1) * partition.regionCount);
+    const std::size_t mask = (std::size_t(1) << partition.shift) - 1;
+    std::size_t end = std::min(bitCount, (chunk + 1) * partition.chunkSize);
+    for (std::size_t k = chunk * partition.chunkSize; k < end; ++k) {
+        std::size_t position = static_cast<std::size_t>(perm[firstBit + k]);
+        func(k, static_cast<uint32_t>(position & mask), cursor[position >> partition.shift]++);
+    }
+}
+
+/**
+ * Shift that splits a first pass region of 2^shift samples into the second pass subregions
+ */
+unsigned SubShift(unsigned shift) {
+    return std::max(MIN_REGION_BITS, shift > FANOUT_BITS ? shift - FANOUT_BITS : 0);
+}
+
+/**
+ * Second pass over one first pass region: stable counting sort of its entries by
+ * subregion, so they are applied one cache sized subregion at a time.
+ * offsetOf(entry) gives an entry's sample offset within the region.
+ * Returns where each subregion starts in 'sorted'.
+ */
+template <typename OffsetOf>
+std::vector<std::size_t> SortRegion(const uint32_t *entries, std::size_t count, unsigned shift,
+                                    const OffsetOf &offsetOf, std::vector<uint32_t> &sorted) {
+    const unsigned subShift = SubShift(shift);
+    std::vector<std::size_t> subStart((((std::size_t(1) << shift) - 1) >> subShift) + 2, 0);
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        ++subStart[(offsetOf(entries[idx]) >> subShift) + 1];
+    }
+    for (std::size_t sub = 1; sub < subStart.size(); ++sub) {
+        subStart[sub] += subStart[sub - 1];
+    }
+
+    std::vector<std::size_t> cursor(subStart);
+    sorted.resize(count);
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        sorted[cursor[offsetOf(entries[idx]) >> subShift]++] = entries[idx];
+    }
+    return subStart;
+}
+
+} // namespace
+
+template <typename Index>
+void PartitionedAccess::Write(std::vector<uint8_t> &samples, const std::vector<uint8_t> &bits,
+                              const Index *perm, std::pmr::memory_resource *resource) {
+    const std::size_t bitCount = bits.size() * 8;
+    if (bitCount == 0) {
+        return;
+    }
+    Partition partition = MakePartition(samples.size(), perm, 0, bitCount);
+
+    // Slots hold the sample offset within the region and the bit
+    std::pmr::vector<uint32_t> slots(bitCount, resource);
+    Parallel::For(partition.chunkCount, [&](std::size_t chunk) {
+        ForEachEntry(partition, perm, 0, bitCount, chunk, [&](std::size_t k, uint32_t offset, std::size_t slot) {
+            slots[slot] = (offset << 1) | ((bits[k / 8] >> (k % 8)) & 1);
+        });
+    });
+
+    Parallel::For(partition.regionCount, [&](std::size_t region) {
+        uint8_t *base = samples.data() + (region << partition.shift);
+        std::size_t begin = partition.regionStart[region];
+        std::size_t count = partition.regionStart[region + 1] - begin;
+
+        std::vector<uint32_t> sorted;
+        SortRegion(slots.data() + begin, count, partition.shift, [](uint32_t entry) { return entry >> 1; }, sorted);
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            if (idx + PREFETCH_DISTANCE < count) {
+                Prefetch<true>(base + (sorted[idx + PREFETCH_DISTANCE] >> 1));
+            }
+            uint8_t &sample = base[sorted[idx] >> 1];
+            sample = static_cast<uint8_t>((sample & 0xFE) | (sorted[idx] & 1));
+        }
+    });
+}
+
+template <typename Index>
+std::vector<uint8_t> PartitionedAccess::Read(const std::vector<uint8_t> &samples, const Index *perm,
+                                             std::size_t firstBit, std::size_t byteCount) {
+    const std::size_t bitCount = byteCount * 8;
+    std::vector<uint8_t> bytes(byteCount, 0);
+    if (bitCount == 0) {
+        return bytes;
+    }
+    Partition partition = MakePartition(samples.size(), perm, firstBit, bitCount);
+
+    // Slots hold the sample offset within the region, then the bit read from it
+    std::vector<uint32_t> slots(bitCount);
+    Parallel::For(partition.chunkCount, [&](std::size_t chunk) {
+        ForEachEntry(partition, perm, firstBit, bitCount, chunk,
+                     [&](std::size_t, uint32_t offset, std::size_t slot) { slots[slot] = offset; });
+    });
+
+    Parallel::For(partition.regionCount, [&](std::size_t region) {
+        const uint8_t *base = samples.data() + (region << partition.shift);
+        std::size_t begin = partition.regionStart[region];
+        std::size_t count = partition.regionStart[region + 1] - begin;
+
+        std::vector<uint32_t> sorted;
+        auto cursor = SortRegion(slots.data() + begin, count, partition.shift, [](uint32_t entry) { return entry; },
+                                 sorted);
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            if (idx + PREFETCH_DISTANCE < count) {
+                Prefetch(base + sorted[idx + PREFETCH_DISTANCE]);
+            }
+            sorted[idx] = base[sorted[idx]] & 1;
+        }
+
+        // Back to first pass order, the sort being stable
+        const unsigned subShift = SubShift(partition.shift);
+        for (std::size_t idx = begin; idx < begin + count; ++idx) {
+            slots[idx] = sorted[cursor[slots[idx] >> subShift]++];
+        }
+    });
+
+    // Walk the permutation again to take the bits back out in stream order
+    Parallel::For(partition.chunkCount, [&](std::size_t chunk) {
+        ForEachEntry(partition, perm, firstBit, bitCount, chunk, [&](std::size_t k, uint32_t, std::size_t slot) {
+            bytes[k / 8] |= static_cast<uint8_t>(slots[slot] << (k % 8));
+        });
+    });
+    return bytes;
+}
+
+template void PartitionedAccess::Write<uint32_t>(std::vector<uint8_t> &, const std::vector<uint8_t> &,
+                                                 const uint32_t *, std::pmr::memory_resource *);
+template void PartitionedAccess::Write<uint64_t>(std::vector<uint8_t> &, const std::vector<uint8_t> &,
+                                                 const uint64_t *, std::pmr::memory_resource *);
+template std::vector<uint8_t> PartitionedAccess::Read<uint32_t>(const std::vector<uint8_t> &,
+                                                                const uint32_t *, std::size_t, std::size_t);
+template std::vector<uint8_t> PartitionedAccess::Read<uint64_t>(const std::vector<uint8_t> &,
+                                                                const uint64_t *, std::size_t, std::size_t);
@@ -0,0 +1,60 @@
+#ifndef __PARTITIONED_ACCESS_H_
+#define __PARTITIONED_ACCESS_H_
+
+#include <vector>
+#include <memory_resource>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Cache friendly LSB writes and reads through a permutation.
+ *
+ * Going straight through a permutation touches a random sample for every
+ * bit, which misses cache and TLB once the image is larger than the cache.
+ * Instead, bits are radix partitioned by the position of their sample in two
+ * passes of 64 regions each (64 append streams stay in cache), and each of the
+ * resulting subregions, at least a page, is applied while it is in cache.
+ *
+ * Results are bit-identical to the direct loops: a permutation never sends
+ * two bits to the same sample, so the order of writes does not matter.
+ */
+class PartitionedAccess {
+public:
+    PartitionedAccess() = delete;
+
+    /** Smallest region, one page of 8-bit samples **/
+    static constexpr std::size_t MIN_REGION = std::size_t(1) << 12;
+
+    /** Largest sample count supported; offsets within a first pass region must fit 31 bits **/
+    static constexpr std::size_t MAX_SAMPLES = std::size_t(1) << 37;
+
+    /** Sample count from which partitioning pays off; smaller images stay in cache **/
+    static constexpr std::size_t MIN_SAMPLES = std::size_t(1) << 22;
+
+    /**
+     * @brief Write bit k of bits (LSB first) into the LSB of samples[perm[k]].
+     *
+     * @param samples Samples to modify (in-place), at most MAX_SAMPLES
+     * @param bits Bits to write
+     * @param perm Permutation of sample positions, at least bits.size() * 8 of them
+     * @param resource Resource for the 4 bytes per bit of slots, allocated by the calling thread
+     */
+    template <typename Index>
+    static void Write(std::vector<uint8_t> &samples, const std::vector<uint8_t> &bits, const Index *perm,
+                      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Read byteCount bytes whose bit k is the LSB of samples[perm[firstBit + k]].
+     *
+     * @param samples Samples to read from, at most MAX_SAMPLES
+     * @param perm Permutation of sample positions, at least firstBit + byteCount * 8 of them
+     * @param firstBit First permutation entry to read, a multiple of 8
+     * @param byteCount Number of bytes to read
+     * @return The bytes read
+     */
+    template <typename Index>
+    static std::vector<uint8_t> Read(const std::vector<uint8_t> &samples, const Index *perm,
+                                     std::size_t firstBit, std::size_t byteCount);
+};
+
+#endif // __PARTITIONED_ACCESS_H_
@@ -0,0 +1,265 @@
+#include "PermutationCache.h"
+#include "../../../utils/Checksum.h"
+#include "../../../utils/CryptoModule.h"
+#include "../../../utils/MappedFile.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * Cache file layout (integers in host byte order, checked through BYTE_ORDER_MARK):
+ *   [0..7]   magic "STGPERM1"
+ *   [8..11]  BYTE_ORDER_MARK
+ *   [12..15] index width in bytes
+ *   [16..23] number of positions
+ *   [24..27] CRC-32C of the positions
+ *   [28..63] zero
+ *   [64..]   positions
+ * The 64-byte header keeps the positions aligned in the mapping.
+ */
+constexpr char FILE_MAGIC[8] = {'S', 'T', 'G', 'P', 'E', 'R', 'M', '1'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr std::size_t FILE_HEADER_SIZE = 64;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t indexBytes;
+    uint64_t size;
+    uint32_t checksum;
+};
+
+static_assert(sizeof(FileHeader) <= FILE_HEADER_SIZE, "cache file header too large");
+
+// Empty unless the file holds exactly one salt
+std::vector<uint8_t> ReadSalt(const fs::path &path) {
+    std::vector<uint8_t> salt(CryptoModule::SALT_SIZE);
+    std::ifstream inFile(path, std::ios::binary);
+    if (!inFile.read(reinterpret_cast<char *>(salt.data()), static_cast<std::streamsize>(salt.size())) ||
+        inFile.peek() != std::ifstream::traits_type::eof()) {
+        return {};
+    }
+    return salt;
+}
+
+// '<base>.<random>.tmp', so processes writing the same entry never share a temporary file
+std::string TemporaryName(const std::string &base) {
+    uint64_t suffix = 0;
+    auto randomResult = CryptoModule::RandomBytes(sizeof(suffix));
+    if (!randomResult) {
+        return {};
+    }
+    std::memcpy(&suffix, randomResult.GetValue().data(), sizeof(suffix));
+    std::ostringstream name;
+    name << base << "." << std::hex << suffix << ".tmp";
+    return name.str();
+}
+
+} // namespace
+
+PermutationCache::PermutationCache(std::size_t maxBytes, std::string directory)
+    : maxBytes_(maxBytes), directory_(std::move(directory)) {   }
+
+Result<std::vector<uint8_t>> PermutationCache::GetSalt() {
+    std::lock_guard<std::mutex> lock(saltMutex_);
+    if (!salt_.empty()) {
+        return Result<std::vector<uint8_t>>(salt_);
+    }
+
+    auto randomResult = CryptoModule::RandomBytes(CryptoModule::SALT_SIZE);
+    if (!randomResult) {
+        return randomResult;
+    }
+    salt_ = randomResult.GetValue();
+    if (directory_.empty()) {
+        return Result<std::vector<uint8_t>>(salt_);
+    }
+
+    // Linking fails when the salt exists, so the first of several processes decides it
+    fs::path saltPath = fs::path(directory_) / SALT_FILE;
+    std::vector<uint8_t> stored = ReadSalt(saltPath);
+    if (stored.empty()) {
+        std::error_code error;
+        fs::create_directories(directory_, error);
+        std::ostringstream name;
+        name << SALT_FILE << "." << std::hex << Checksum::Crc32c(salt_.data(), salt_.size()) << ".tmp";
+        fs::path temporary = fs::path(directory_) / name.str();
+        {
+            std::ofstream outFile(temporary, std::ios::binary | std::ios::trunc);
+            outFile.write(reinterpret_cast<const char *>(salt_.data()), static_cast<std::streamsize>(salt_.size()));
+        }
+        fs::create_hard_link(temporary, saltPath, error);
+        fs::remove(temporary, error);
+        stored = ReadSalt(saltPath);
+    }
+
+    // Without a readable salt file only this cache's own files are found again
+    if (!stored.empty()) {
+        salt_ = stored;
+    }
+    return Result<std::vector<uint8_t>>(salt_);
+}
+
+Result<std::string> PermutationCache::Digest(const std::string &password, const std::string &scheme) {
+    auto saltResult = GetSalt();
+    if (!saltResult) {
+        return Result<std::string>(saltResult.GetErrorCode(), saltResult.GetErrorMessage());
+    }
+    std::vector<uint8_t> salt = std::move(saltResult.GetValue());
+    const std::string context = "stegtool/lsb-shuffle/cache-id/" + scheme;
+    salt.insert(salt.end(), context.begin(), context.end());
+
+    auto digestResult = CryptoModule::DeriveSlowKey(password, salt, 16);
+    if (!digestResult) {
+        return Result<std::string>(digestResult.GetErrorCode(), digestResult.GetErrorMessage());
+    }
+
+    static const char HEX[] = "0123456789abcdef";
+    std::string digest;
+    for (uint8_t byte : digestResult.GetValue()) {
+        digest += HEX[byte >> 4];
+        digest += HEX[byte & 0x0F];
+    }
+    return Result<std::string>(digest);
+}
+
+std::string PermutationCache::MakeKey(const std::string &digest, std::size_t size, std::size_t indexBytes) {
+    std::ostringstream key;
+    key << digest << "-" << size << "-u" << indexBytes * 8;
+    return key.str();
+}
+
+std::size_t PermutationCache::GetMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usedBytes_;
+}
+
+std::size_t PermutationCache::GetEntryCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+std::shared_ptr<const void> PermutationCache::Find(const std::string &key, std::size_t size, std::size_t indexBytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = index_.find(key);
+        if (found != index_.end()) {
+            entries_.splice(entries_.begin(), entries_, found->second);
+            return found->second->data;
+        }
+    }
+
+    // Mapping and checking a file can take a while, other lookups need not wait for it
+    auto loaded = Load(key, size, indexBytes);
+    if (loaded) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Insert(key, loaded, size * indexBytes);
+    }
+    return loaded;
+}
+
+void PermutationCache::Store(const std::string &key, std::shared_ptr<const void> data, std::size_t size,
+                             std::size_t indexBytes) {
+    Persist(key, data.get(), size, indexBytes);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Insert(key, std::move(data), size * indexBytes);
+}
+
+void PermutationCache::Insert(const std::string &key, std::shared_ptr<const void> data, std::size_t bytes) {
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return;
+    }
+    if (bytes > maxBytes_) {
+        return;
+    }
+
+    entries_.push_front(Entry{key, std::move(data), bytes});
+    index_[key] = entries_.begin();
+    usedBytes_ += bytes;
+
+    while (usedBytes_ > maxBytes_) {
+        usedBytes_ -= entries_.back().bytes;
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+}
+
+std::shared_ptr<const void> PermutationCache::Load(const std::string &key, std::size_t size,
+                                                   std::size_t indexBytes) const {
+    if (directory_.empty()) {
+        return nullptr;
+    }
+    const std::size_t bytes = size * indexBytes;
+
+    auto mapResult = MappedFile::Open((fs::path(directory_) / (key + ".perm")).string(), MappedFile::Mode::ReadOnly);
+    if (!mapResult || mapResult.GetValue().Size() != FILE_HEADER_SIZE + bytes) {
+        return nullptr;
+    }
+    auto file = std::make_shared<MappedFile>(std::move(mapResult.GetValue()));
+
+    FileHeader header;
+    std::memcpy(&header, file->Data(), sizeof(header));
+    const uint8_t *positions = file->Data() + FILE_HEADER_SIZE;
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || header.byteOrder != BYTE_ORDER_MARK ||
+        header.indexBytes != indexBytes || header.size != size ||
+        header.checksum != Checksum::Crc32c(positions, bytes)) {
+        return nullptr;
+    }
+
+    // The positions live as long as anyone holds them, and the mapping with them
+    return std::shared_ptr<const void>(file, positions);
+}
+
+void PermutationCache::Persist(const std::string &key, const void *data, std::size_t size,
+                               std::size_t indexBytes) const {
+    if (directory_.empty()) {
+        return;
+    }
+    const std::size_t bytes = size * indexBytes;
+
+    std::error_code error;
+    fs::create_directories(directory_, error);
+    if (error) {
+        return;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.indexBytes = static_cast<uint32_t>(indexBytes);
+    header.size = size;
+    header.checksum = Checksum::Crc32c(static_cast<const uint8_t *>(data), bytes);
+
+    std::vector<char> headerBytes(FILE_HEADER_SIZE, 0);
+    std::memcpy(headerBytes.data(), &header, sizeof(header));
+
+    // Written under a temporary name, so readers never map a partial file
+    fs::path target = fs::path(directory_) / (key + ".perm");
+    std::string temporaryName = TemporaryName(key);
+    if (temporaryName.empty()) {
+        return;
+    }
+    fs::path temporary = fs::path(directory_) / temporaryName;
+    {
+        std::ofstream outFile(temporary, std::ios::binary | std::ios::trunc);
+        outFile.write(headerBytes.data(), static_cast<std::streamsize>(headerBytes.size()));
+        outFile.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        if (!outFile) {
+            outFile.close();
+            fs::remove(temporary, error);
+            return;
+        }
+    }
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef __PERMUTATION_CACHE_H_
+#define __PERMUTATION_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../../../utils/ErrorHandler.h"
+
+/**
+ * @brief Memory-bounded cache of shuffle permutations, optionally persisted on disk.
+ *
+ * Permutations are keyed by a digest of the password (PBKDF2 with a random
+ * salt of this cache, so the digest says nothing about the permutation key),
+ * the permutation scheme, the sample count and the index width. The least
+ * recently used permutations are dropped once the memory budget is exceeded;
+ * callers that still hold one keep it alive.
+ *
+ * With a directory, every built permutation is also written there and later
+ * runs map it read-only instead of building it. Files carry a CRC-32C and are
+ * ignored when it does not match; failing to write one only costs the
+ * persistence. The salt is kept in the directory as well. The files reveal
+ * the positions data is hidden in, and their names confirm a guessed password
+ * at the cost of one PBKDF2 run, so the directory must be as private as the
+ * passwords.
+ *
+ * Safe to share between handlers and threads.
+ */
+class PermutationCache {
+public:
+    /** Default memory budget **/
+    static constexpr std::size_t DEFAULT_MAX_BYTES = std::size_t(256) << 20;
+
+    /**
+     * @param maxBytes Memory budget for cached permutations
+     * @param directory Directory for persisted permutations, empty to keep them in memory only
+     */
+    explicit PermutationCache(std::size_t maxBytes = DEFAULT_MAX_BYTES, std::string directory = "");
+
+    /** Name of the file keeping the salt in the directory **/
+    static constexpr const char *SALT_FILE = "salt";
+
+    /**
+     * @brief Cache key part identifying a password and permutation scheme.
+     *
+     * Salted with this cache's salt and as slow to compute as the payload key, so
+     * file names are no cheaper to attack than the payload, and the same password
+     * gets unrelated names in different directories.
+     *
+     * @param password Password the permutation is derived from
+     * @param scheme Permutation scheme, e.g. "keyed" or "legacy"
+     * @return Result containing the digest in hex, or the key derivation error
+     */
+    Result<std::string> Digest(const std::string &password, const std::string &scheme);
+
+    /**
+     * @brief Look up a permutation, building and caching it on a miss.
+     *
+     * @param digest Result of Digest
+     * @param size Number of positions
+     * @param build Callable returning Result<std::vector<Index>> with size entries
+     * @return Result containing the positions, or the error of build
+     */
+    template <typename Index, typename Build>
+    Result<std::shared_ptr<const Index>> GetOrBuild(const std::string &digest, std::size_t size, const Build &build) {
+        const std::string key = MakeKey(digest, size, sizeof(Index));
+        if (auto cached = Find(key, size, sizeof(Index))) {
+            return Result<std::shared_ptr<const Index>>(std::static_pointer_cast<const Index>(cached));
+        }
+
+        Result<std::vector<Index>> built = build();
+        if (!built) {
+            return Result<std::shared_ptr<const Index>>(built.GetErrorCode(), built.GetErrorMessage());
+        }
+        auto owner = std::make_shared<const std::vector<Index>>(std::move(built.GetValue()));
+        std::shared_ptr<const Index> positions(owner, owner->data());
+        Store(key, positions, size, sizeof(Index));
+        return Result<std::shared_ptr<const Index>>(positions);
+    }
+
+    /**
+     * @brief Bytes of permutations currently held.
+     */
+    std::size_t GetMemoryUsage() const;
+
+    /**
+     * @brief Number of permutations currently held.
+     */
+    std::size_t GetEntryCount() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const void> data;
+        std::size_t bytes;
+    };
+
+    static std::string MakeKey(const std::string &digest, std::size_t size, std::size_t indexBytes);
+
+    /**
+     * @brief Salt for Digest: the directory's, created on first use, or random per cache without one.
+     */
+    Result<std::vector<uint8_t>> GetSalt();
+
+    /**
+     * @brief Permutation from memory, or mapped from the directory; null on a miss.
+     */
+    std::shared_ptr<const void> Find(const std::string &key, std::size_t size, std::size_t indexBytes);
+
+    /**
+     * @brief Keep a built permutation in memory and persist it.
+     */
+    void Store(const std::string &key, std::shared_ptr<const void> data, std::size_t size, std::size_t indexBytes);
+
+    /**
+     * @brief Map a persisted permutation; null when missing or damaged.
+     */
+    std::shared_ptr<const void> Load(const std::string &key, std::size_t size, std::size_t indexBytes) const;
+
+    /**
+     * @brief Write a permutation to the directory, if there is one.
+     */
+    void Persist(const std::string &key, const void *data, std::size_t size, std::size_t indexBytes) const;
+
+    /**
+     * @brief Insert at the front of the LRU list and evict beyond the budget. Needs mutex_.
+     */
+    void Insert(const std::string &key, std::shared_ptr<const void> data, std::size_t bytes);
+
+    const std::size_t maxBytes_;
+    const std::string directory_;
+
+    std::mutex saltMutex_;
+    std::vector<uint8_t> salt_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    std::size_t usedBytes_ = 0;
+};
+
+#endif // __PERMUTATION_CACHE_H_
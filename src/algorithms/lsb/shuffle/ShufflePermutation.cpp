@@ -0,0 +1,167 @@
+#include "ShufflePermutation.h"
+#include "../../../utils/CryptoModule.h"
+#include "../../../utils/CounterRNG.h"
+#include "../../../utils/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+namespace {
+
+constexpr std::size_t WORD_BATCH = 1024;                       // stream words generated per Fill call
+constexpr std::size_t MIN_CHUNK = std::size_t(1) << 16;        // positions per scatter chunk, at least
+constexpr unsigned BUCKET_STREAM_SHIFT = 32;                   // bucket b shuffles with blocks [b << 32, ...)
+
+/**
+ * Number of bucket bits for 'size' positions: buckets are a power of two,
+ * so the top bits of a uniform word pick one exactly.
+ */
+unsigned BucketBits(std::size_t size) {
+    unsigned bits = 0;
+    while ((size >> bits) > ShufflePermutation::BUCKET_SIZE) {
+        ++bits;
+    }
+    return bits;
+}
+
+/**
+ * Call func(position, word) for positions [begin, end), word being stream word 'position'.
+ * begin must be a multiple of CounterRNG::WORDS_PER_BLOCK.
+ */
+template <typename Func>
+void ForEachWord(const CounterRNG &rng, std::size_t begin, std::size_t end, const Func &func) {
+    std::array<uint32_t, WORD_BATCH> words;
+    for (std::size_t batch = begin; batch < end; batch += WORD_BATCH) {
+        std::size_t count = std::min(WORD_BATCH, end - batch);
+        rng.Fill(batch / CounterRNG::WORDS_PER_BLOCK, words.data(), count);
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            func(batch + idx, words[idx]);
+        }
+    }
+}
+
+/**
+ * Fisher-Yates with words from 'firstBlock' on. j = word * (k + 1) >> 32 picks from [0, k];
+ * its bias is below k / 2^32, negligible for bucket sized ranges.
+ */
+template <typename Index>
+void ShuffleRange(Index *values, std::size_t count, const CounterRNG &rng, uint64_t firstBlock) {
+    if (count < 2) {
+        return;
+    }
+    std::array<uint32_t, WORD_BATCH> words;
+    std::size_t used = WORD_BATCH;
+    uint64_t block = firstBlock;
+    for (std::size_t k = count - 1; k > 0; --k) {
+        if (used == WORD_BATCH) {
+            rng.Fill(block, words.data(), WORD_BATCH);
+            block += WORD_BATCH / CounterRNG::WORDS_PER_BLOCK;
+            used = 0;
+        }
+        std::size_t j = static_cast<std::size_t>((static_cast<uint64_t>(words[used++]) * (k + 1)) >> 32);
+        std::swap(values[k], values[j]);
+    }
+}
+
+} // namespace
+
+template <typename Index>
+Result<std::vector<Index>> ShufflePermutation::BuildKeyed(std::size_t size, const std::string &password) {
+    std::vector<Index> perm(size);
+    auto buildResult = BuildKeyed(size, password, perm.data());
+    if (!buildResult) {
+        return Result<std::vector<Index>>(buildResult.GetErrorCode(), buildResult.GetErrorMessage());
+    }
+    return Result<std::vector<Index>>(std::move(perm));
+}
+
+template <typename Index>
+Result<> ShufflePermutation::BuildKeyed(std::size_t size, const std::string &password, Index *perm) {
+    auto keyResult = CryptoModule::DeriveSubkey(password, "stegtool/lsb-shuffle/permutation", 2 * CounterRNG::KEY_SIZE);
+    if (!keyResult) {
+        return Result<>(keyResult.GetErrorCode(), keyResult.GetErrorMessage());
+    }
+    const auto &key = keyResult.GetValue();
+    CounterRNG bucketRng(std::vector<uint8_t>(key.begin(), key.begin() + CounterRNG::KEY_SIZE));
+    CounterRNG shuffleRng(std::vector<uint8_t>(key.begin() + CounterRNG::KEY_SIZE, key.end()));
+
+    const unsigned bucketBits = BucketBits(size);
+    const std::size_t bucketCount = std::size_t(1) << bucketBits;
+
+    if (bucketCount == 1) {
+        for (std::size_t idx = 0; idx < size; ++idx) {
+            perm[idx] = static_cast<Index>(idx);
+        }
+        ShuffleRange(perm, size, shuffleRng, 0);
+        return Result<>();
+    }
+
+    auto bucketOf = [bucketBits](uint32_t word) {
+        return static_cast<std::size_t>(word >> (32 - bucketBits));
+    };
+
+    // Chunks only split the work; positions keep their order within a bucket either way
+    std::size_t chunkSize = std::max(MIN_CHUNK, (size + Parallel::GetThreadCount() - 1) / Parallel::GetThreadCount());
+    chunkSize = (chunkSize + WORD_BATCH - 1) / WORD_BATCH * WORD_BATCH;
+    const std::size_t chunkCount = (size + chunkSize - 1) / chunkSize;
+
+    // 1. Bucket sizes per chunk
+    std::vector<std::size_t> offsets(chunkCount * bucketCount, 0);
+    Parallel::For(chunkCount, [&](std::size_t chunk) {
+        std::size_t *counts = offsets.data() + chunk * bucketCount;
+        ForEachWord(bucketRng, chunk * chunkSize, std::min(size, (chunk + 1) * chunkSize),
+                    [&](std::size_t, uint32_t word) { ++counts[bucketOf(word)]; });
+    });
+
+    // 2. Where each chunk writes into each bucket: buckets in order, chunks in order within a bucket
+    std::vector<std::size_t> bucketStart(bucketCount + 1, 0);
+    std::size_t running = 0;
+    for (std::size_t bucket = 0; bucket < bucketCount; ++bucket) {
+        bucketStart[bucket] = running;
+        for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            std::size_t count = offsets[chunk * bucketCount + bucket];
+            offsets[chunk * bucketCount + bucket] = running;
+            running += count;
+        }
+    }
+    bucketStart[bucketCount] = running;
+
+    // 3. Scatter positions into their buckets
+    Parallel::For(chunkCount, [&](std::size_t chunk) {
+        std::size_t *cursor = offsets.data() + chunk * bucketCount;
+        ForEachWord(bucketRng, chunk * chunkSize, std::min(size, (chunk + 1) * chunkSize),
+                    [&](std::size_t position, uint32_t word) {
+                        perm[cursor[bucketOf(word)]++] = static_cast<Index>(position);
+                    });
+    });
+
+    // 4. Shuffle every bucket with its own part of the second stream
+    Parallel::For(bucketCount, [&](std::size_t bucket) {
+        ShuffleRange(perm + bucketStart[bucket], bucketStart[bucket + 1] - bucketStart[bucket],
+                     shuffleRng, static_cast<uint64_t>(bucket) << BUCKET_STREAM_SHIFT);
+    });
+
+    return Result<>();
+}
+
+template Result<std::vector<uint32_t>> ShufflePermutation::BuildKeyed<uint32_t>(std::size_t, const std::string &);
+template Result<std::vector<uint64_t>> ShufflePermutation::BuildKeyed<uint64_t>(std::size_t, const std::string &);
+template Result<> ShufflePermutation::BuildKeyed<uint32_t>(std::size_t, const std::string &, uint32_t *);
+template Result<> ShufflePermutation::BuildKeyed<uint64_t>(std::size_t, const std::string &, uint64_t *);
+
+template <typename Index>
+std::vector<Index> ShufflePermutation::BuildLegacy(std::size_t size, const std::string &password) {
+    std::size_t seed = std::hash<std::string>{}(password);
+    std::mt19937_64 shuffler(seed);
+
+    std::vector<Index> perm(size);
+    for (std::size_t idx = 0; idx < size; ++idx) {
+        perm[idx] = static_cast<Index>(idx);
+    }
+    std::shuffle(perm.begin(), perm.end(), shuffler);
+    return perm;
+}
+
+template std::vector<uint32_t> ShufflePermutation::BuildLegacy<uint32_t>(std::size_t, const std::string &);
+template std::vector<uint64_t> ShufflePermutation::BuildLegacy<uint64_t>(std::size_t, const std::string &);
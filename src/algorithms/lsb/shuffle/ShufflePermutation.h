@@ -0,0 +1,67 @@
+#ifndef __SHUFFLE_PERMUTATION_H_
+#define __SHUFFLE_PERMUTATION_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "../../../utils/ErrorHandler.h"
+
+/**
+ * @brief Password-keyed permutations of embedding positions for shuffled LSB.
+ *
+ * The keyed permutation is derived with HKDF from the password and drawn from
+ * Philox counter streams (see CounterRNG), so it is identical on every platform
+ * and standard library, and can be built by several threads:
+ *   1. every position i gets a bucket from word i of the first stream
+ *   2. positions are scattered into their buckets, keeping their order
+ *   3. each bucket is Fisher-Yates shuffled with its own range of the second stream
+ * Uniform buckets followed by uniform shuffles give a uniform permutation, and
+ * the result does not depend on the number of threads.
+ *
+ * The legacy permutation (std::hash seed, mt19937_64, std::shuffle) is what
+ * older versions wrote; it is kept so their stego files still extract.
+ */
+class ShufflePermutation {
+public:
+    ShufflePermutation() = delete;
+
+    /** Target positions per bucket; a bucket then fits in L2 while it is shuffled **/
+    static constexpr std::size_t BUCKET_SIZE = std::size_t(1) << 16;
+
+    /**
+     * @brief Build the keyed permutation of [0, size).
+     *
+     * Index must be able to hold size - 1: uint32_t halves the memory of the
+     * 64-bit table for every image below 4G samples.
+     *
+     * @param size Number of positions
+     * @param password Password the permutation is derived from
+     * @return Result containing perm, where stream bit k goes to position perm[k]
+     */
+    template <typename Index>
+    static Result<std::vector<Index>> BuildKeyed(std::size_t size, const std::string &password);
+
+    /**
+     * @brief Build the keyed permutation of [0, size) into caller owned storage.
+     *
+     * @param size Number of positions
+     * @param password Password the permutation is derived from
+     * @param perm Storage for size positions
+     * @return Result indicating success or the key derivation error
+     */
+    template <typename Index>
+    static Result<> BuildKeyed(std::size_t size, const std::string &password, Index *perm);
+
+    /**
+     * @brief Build the permutation used by versions before the keyed one.
+     *
+     * Depends on the standard library's std::hash and std::shuffle, so it is
+     * only reproducible with the library that embedded the data. The index
+     * type does not change the result.
+     */
+    template <typename Index>
+    static std::vector<Index> BuildLegacy(std::size_t size, const std::string &password);
+};
+
+#endif // __SHUFFLE_PERMUTATION_H_
@@ -0,0 +1,121 @@
+#include "LSBStegoHandlerTiled.h"
+#include "../../../utils/ImageIO.h"
+
+#include <vector>
+#include <string>
+#include <sstream>
+
+Result<> LSBStegoHandlerTiled::EmbedSamples(ImageData &imageData,
+                                            const std::vector<uint8_t> &dataToEmbed,
+                                            const std::string &password) {
+
+    auto &pixels = imageData.pixels;
+
+    if (dataToEmbed.empty()) {
+        return Result<>(ErrorCode::InvalidArgument, "Cannot embed empty data");
+    }
+
+    auto permResult = TilePermutation::Create(pixels.size(), password);
+    if (!permResult) {
+        return Result<>(permResult.GetErrorCode(), permResult.GetErrorMessage());
+    }
+    const TilePermutation &perm = permResult.GetValue();
+
+    // Validate capacity, without the samples left over by the tiling
+    auto capacityCheck = LSBStegoHandler::ValidateCapacity(perm.GetCapacity(), dataToEmbed.size(), HEADER_SIZE_BITS, MAX_REASONABLE_SIZE);
+    if (!capacityCheck) {
+        return capacityCheck;
+    }
+
+    // Header and data, LSB first
+    std::vector<uint8_t> dataVector = BuildPayload(dataToEmbed);
+    perm.ForEachBit(0, dataVector.size() * 8, [&](std::size_t bitIndex, std::size_t location) {
+        uint8_t bit = (dataVector[bitIndex / 8] >> (bitIndex % 8)) & 1;
+        pixels[location] = (pixels[location] & 0xFE) | bit;
+    });
+
+    return Result<>();
+}
+
+Result<> LSBStegoHandlerTiled::MarkPositions(std::vector<uint8_t> &marks, std::size_t dataBytes,
+                                             const std::string &password) const {
+
+    auto permResult = TilePermutation::Create(marks.size(), password);
+    if (!permResult) {
+        return Result<>(permResult.GetErrorCode(), permResult.GetErrorMessage());
+    }
+    const TilePermutation &perm = permResult.GetValue();
+
+    auto capacityCheck = LSBStegoHandler::ValidateCapacity(perm.GetCapacity(), dataBytes, HEADER_SIZE_BITS, MAX_REASONABLE_SIZE);
+    if (!capacityCheck) {
+        return capacityCheck;
+    }
+
+    perm.ForEachBit(0, (dataBytes + HEADER_SIZE_BYTES) * 8, [&](std::size_t bitIndex, std::size_t location) {
+        (void) bitIndex;
+        marks[location] = 0xFF;
+    });
+    return Result<>();
+}
+
+Result<std::vector<uint8_t>> LSBStegoHandlerTiled::ExtractSamples(const ImageData &imageData,
+                                                                  const std::string &password) {
+
+    auto &pixels = imageData.pixels;
+
+    auto permResult = TilePermutation::Create(pixels.size(), password);
+    if (!permResult) {
+        return Result<std::vector<uint8_t>>(permResult.GetErrorCode(), permResult.GetErrorMessage());
+    }
+    const TilePermutation &perm = permResult.GetValue();
+    std::size_t capacity = perm.GetCapacity();
+
+    // Header first: rejects carriers without a payload before reading the rest
+    auto headerResult = ReadPayloadHeader(capacity, [&](std::size_t bitIndex) {
+        return pixels[perm.Position(bitIndex)];
+    });
+    if (!headerResult) {
+        return Result<std::vector<uint8_t>>(headerResult.GetErrorCode(), headerResult.GetErrorMessage());
+    }
+    uint32_t dataSize = headerResult.GetValue().dataSize;
+    std::size_t headerBytes = headerResult.GetValue().GetSizeBytes();
+
+    // Validate size
+    if (dataSize == 0) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::NoEmbeddedData,
+            "Extracted size is 0. Image may not contain embedded data."
+        );
+    }
+
+    if (dataSize > MAX_REASONABLE_SIZE) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) is unreasonably large (max "
+            << MAX_REASONABLE_SIZE << " bytes). Data is likely corrupted or password is wrong.";
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::CorruptedPayload,
+            oss.str()
+        );
+    }
+
+    std::size_t neededBits = (static_cast<std::size_t>(dataSize) + headerBytes) * 8;
+    if (neededBits > capacity) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) exceeds image capacity. "
+            << "Image has " << capacity << " usable pixel values, "
+            << "but would need " << neededBits << " values. "
+            << "Data is corrupted or password may be wrong.";
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::InvalidDataSize,
+            oss.str()
+        );
+    }
+
+    // Extract the data bits, tile by tile
+    std::vector<uint8_t> extractedData(dataSize, 0);
+    perm.ForEachBit(headerBytes * 8, neededBits, [&](std::size_t bitIndex, std::size_t location) {
+        extractedData[bitIndex / 8 - headerBytes] |= static_cast<uint8_t>((pixels[location] & 1) << (bitIndex % 8));
+    });
+
+    return Result<std::vector<uint8_t>>(extractedData);
+}
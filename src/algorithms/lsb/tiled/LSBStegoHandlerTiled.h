@@ -0,0 +1,57 @@
+#ifndef __LSB_TILED_STEGO_HANDLER_H_
+#define __LSB_TILED_STEGO_HANDLER_H_
+
+#include "../LSBStegoHandler.h"
+#include "../../../utils/ImageIO.h"
+#include "TilePermutation.h"
+
+/**
+ * @brief Implements LSB steganography with a password-keyed, tile structured shuffle.
+ *
+ * Like lsbshuffle the payload is scattered over the whole image in a
+ * password dependent order, but the order is built from tiles (see
+ * TilePermutation): embedding and extraction walk the image one 4 KB tile at
+ * a time, in parallel, and need no table of positions. The data is encrypted
+ * with AES-256-CBC before embedding, as for the other methods.
+ */
+class LSBStegoHandlerTiled : public LSBStegoHandler {
+public:
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::LSBTiled; }
+
+    ~LSBStegoHandlerTiled() override = default;
+
+protected:
+    /**
+     * @brief Embeds data into pixel array along the tiled permutation.
+     *
+     * Format: [payload header | data bits]
+     *
+     * @param imageData Samples to modify (in-place)
+     * @param dataToEmbed Data to embed (already encrypted)
+     * @param password Password the permutation is derived from
+     * @return Result indicating success or embedding error
+     */
+    Result<> EmbedSamples(ImageData &imageData,
+                          const std::vector<uint8_t> &dataToEmbed,
+                          const std::string &password ) override;
+
+    /**
+     * @brief Extracts data from pixel array along the tiled permutation.
+     *
+     * @param imageData Samples to read from
+     * @param password Password the permutation is derived from
+     * @return Result containing extracted data or error
+     */
+    Result<std::vector<uint8_t>> ExtractSamples(const ImageData &imageData,
+                                                const std::string &password ) override;
+
+    bool HasPositionMap() const override { return true; }
+
+    /**
+     * @brief Marks the samples the tiled permutation gives to the header and data bits.
+     */
+    Result<> MarkPositions(std::vector<uint8_t> &marks, std::size_t dataBytes,
+                           const std::string &password) const override;
+};
+
+#endif // __LSB_TILED_STEGO_HANDLER_H_
@@ -0,0 +1,100 @@
+#include "TilePermutation.h"
+#include "../../../utils/CryptoModule.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t KEY_BYTES = 8;
+constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+/**
+ * SplitMix64 finalizer: a cheap 64-bit mixing bijection
+ */
+uint64_t Mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    value ^= value >> 31;
+    return value;
+}
+
+/**
+ * Bits needed to address 'count' positions
+ */
+unsigned AddressBits(std::size_t count) {
+    unsigned bits = 0;
+    while (bits < 64 && (count - 1) >> bits) {
+        ++bits;
+    }
+    return bits;
+}
+
+} // namespace
+
+Result<TilePermutation> TilePermutation::Create(std::size_t sampleCount, const std::string &password) {
+    // Tile count rounded up to a multiple of 8 so stream bytes never span task groups
+    std::size_t tileCount = (sampleCount + TILE_SIZE - 1) / TILE_SIZE;
+    tileCount = (tileCount + 7) / 8 * 8;
+    if (tileCount == 0 || sampleCount / tileCount == 0) {
+        return Result<TilePermutation>(ErrorCode::ImageTooSmall, "Image is too small for tiled embedding");
+    }
+
+    auto keyResult = CryptoModule::DeriveSubkey(password, "stegtool/lsb-tile/permutation", 2 * KEY_BYTES);
+    if (!keyResult) {
+        return Result<TilePermutation>(keyResult.GetErrorCode(), keyResult.GetErrorMessage());
+    }
+    uint64_t tileKey = 0;
+    uint64_t orderKey = 0;
+    std::memcpy(&tileKey, keyResult.GetValue().data(), KEY_BYTES);
+    std::memcpy(&orderKey, keyResult.GetValue().data() + KEY_BYTES, KEY_BYTES);
+
+    TilePermutation perm;
+    perm.tileCount_ = tileCount;
+    perm.tileSize_ = sampleCount / tileCount;
+    perm.halfBits_ = (AddressBits(tileCount) + 1) / 2;
+    for (std::size_t idx = 0; idx < FEISTEL_ROUNDS; ++idx) {
+        perm.roundKeys_[idx] = Mix(tileKey + idx * GOLDEN_GAMMA);
+    }
+    perm.orderKey_ = orderKey;
+    return Result<TilePermutation>(perm);
+}
+
+uint64_t TilePermutation::Feistel(uint64_t value) const {
+    const uint64_t halfMask = (uint64_t(1) << halfBits_) - 1;
+    uint64_t left = value >> halfBits_;
+    uint64_t right = value & halfMask;
+    for (uint64_t key : roundKeys_) {
+        uint64_t next = left ^ (Mix(right ^ key) & halfMask);
+        left = right;
+        right = next;
+    }
+    return (left << halfBits_) | right;
+}
+
+std::size_t TilePermutation::TileOfRank(std::size_t rank) const {
+    // Cycle walking: the network permutes a power of two range, at most 4x tileCount
+    uint64_t tile = rank;
+    do {
+        tile = Feistel(tile);
+    } while (tile >= tileCount_);
+    return static_cast<std::size_t>(tile);
+}
+
+TilePermutation::TileOrder TilePermutation::GetTileOrder(std::size_t tile) const {
+    const unsigned bits = AddressBits(tileSize_);
+
+    TileOrder order;
+    order.size_ = static_cast<uint32_t>(tileSize_);
+    order.mask_ = static_cast<uint32_t>((uint64_t(1) << bits) - 1);
+    order.shift_ = (bits + 1) / 2;
+
+    uint64_t state = Mix(orderKey_ ^ Mix(tile + GOLDEN_GAMMA));
+    for (std::size_t idx = 0; idx < TileOrder::ROUNDS; ++idx) {
+        state = Mix(state + GOLDEN_GAMMA);
+        order.multipliers_[idx] = static_cast<uint32_t>(state) | 1u;
+        order.addends_[idx] = static_cast<uint32_t>(state >> 32);
+    }
+    return order;
+}
@@ -0,0 +1,142 @@
+#ifndef __TILE_PERMUTATION_H_
+#define __TILE_PERMUTATION_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "../../../utils/ErrorHandler.h"
+#include "../../../utils/Parallel.h"
+
+/**
+ * @brief Password-keyed two level permutation of embedding positions for tiled LSB.
+ *
+ * The samples are cut into tileCount equal tiles of at most TILE_SIZE samples
+ * (the few samples left over are not used). Stream bit k goes to:
+ *   - the tile of rank k % tileCount, ranks being a keyed permutation of the tiles
+ *   - round k / tileCount of that tile, rounds being a keyed permutation of its samples
+ * Consecutive bits therefore land in different tiles all over the image, while
+ * a tile's bits can be handled while that tile is in L1.
+ *
+ * Both levels are bijections evaluated on the fly (a Feistel network over the
+ * tiles, multiply/xorshift rounds within a tile, both cycle-walked into range),
+ * so no index table is built. The positions are keyed through HKDF from the
+ * password and do not depend on the platform or the number of threads.
+ */
+class TilePermutation {
+public:
+    /** Samples per tile, at most: 4 KB of 8-bit samples **/
+    static constexpr std::size_t TILE_SIZE = 4096;
+
+    /** Tile ranks handled per parallel task; a multiple of 8, see ForEachBit **/
+    static constexpr std::size_t RANKS_PER_TASK = 64;
+
+    /**
+     * @brief Keyed permutation of one tile's samples: round -> sample within the tile.
+     */
+    class TileOrder {
+    public:
+        uint32_t operator()(uint32_t round) const {
+            uint32_t position = round;
+            do {
+                for (std::size_t idx = 0; idx < ROUNDS; ++idx) {
+                    position = (position * multipliers_[idx] + addends_[idx]) & mask_;
+                    position ^= position >> shift_;
+                }
+            } while (position >= size_);
+            return position;
+        }
+
+    private:
+        friend class TilePermutation;
+        static constexpr std::size_t ROUNDS = 3;
+
+        std::array<uint32_t, ROUNDS> multipliers_{};  // odd, so invertible modulo 2^bits
+        std::array<uint32_t, ROUNDS> addends_{};
+        uint32_t mask_ = 0;
+        uint32_t size_ = 0;
+        unsigned shift_ = 0;
+    };
+
+    /**
+     * @brief Derive the permutation of 'sampleCount' samples from a password.
+     *
+     * @param sampleCount Number of samples
+     * @param password Password the permutation is derived from
+     * @return Result containing the permutation, ImageTooSmall or the key derivation error
+     */
+    static Result<TilePermutation> Create(std::size_t sampleCount, const std::string &password);
+
+    std::size_t GetTileCount() const { return tileCount_; }
+    std::size_t GetTileSize() const { return tileSize_; }
+
+    /**
+     * @brief Number of stream bits the samples hold (every sample of every tile).
+     */
+    std::size_t GetCapacity() const { return tileCount_ * tileSize_; }
+
+    /**
+     * @brief Tile holding stream bits rank, rank + tileCount, rank + 2 * tileCount, ...
+     */
+    std::size_t TileOfRank(std::size_t rank) const;
+
+    /**
+     * @brief In-tile order of a tile.
+     */
+    TileOrder GetTileOrder(std::size_t tile) const;
+
+    /**
+     * @brief Sample holding stream bit 'bit'; for single bits such as the header.
+     */
+    std::size_t Position(std::size_t bit) const {
+        std::size_t tile = TileOfRank(bit % tileCount_);
+        return tile * tileSize_ + GetTileOrder(tile)(static_cast<uint32_t>(bit / tileCount_));
+    }
+
+    /**
+     * @brief Call func(bit, sample) for the stream bits [firstBit, endBit), one tile at a time.
+     *
+     * Tiles are spread over threads by groups of ranks. Since tileCount and
+     * the groups are multiples of 8, the bits of one stream byte always belong
+     * to the same group: func may write whole bytes without locking.
+     */
+    template <typename Func>
+    void ForEachBit(std::size_t firstBit, std::size_t endBit, const Func &func) const {
+        const std::size_t taskCount = (tileCount_ + RANKS_PER_TASK - 1) / RANKS_PER_TASK;
+        Parallel::For(taskCount, [&](std::size_t task) {
+            std::size_t lastRank = std::min(tileCount_, (task + 1) * RANKS_PER_TASK);
+            for (std::size_t rank = task * RANKS_PER_TASK; rank < lastRank; ++rank) {
+                std::size_t round = firstBit > rank ? (firstBit - rank + tileCount_ - 1) / tileCount_ : 0;
+                std::size_t bit = round * tileCount_ + rank;
+                if (bit >= endBit) {
+                    continue;
+                }
+                const std::size_t tile = TileOfRank(rank);
+                const std::size_t base = tile * tileSize_;
+                const TileOrder order = GetTileOrder(tile);
+                for (; bit < endBit; bit += tileCount_, ++round) {
+                    func(bit, base + order(static_cast<uint32_t>(round)));
+                }
+            }
+        });
+    }
+
+private:
+    static constexpr std::size_t FEISTEL_ROUNDS = 4;
+
+    TilePermutation() = default;
+
+    /**
+     * @brief One pass of the Feistel network over [0, 2^(2 * halfBits_)).
+     */
+    uint64_t Feistel(uint64_t value) const;
+
+    std::size_t tileCount_ = 0;
+    std::size_t tileSize_ = 0;
+    unsigned halfBits_ = 0;
+    std::array<uint64_t, FEISTEL_ROUNDS> roundKeys_{};
+    uint64_t orderKey_ = 0;
+};
+
+#endif // __TILE_PERMUTATION_H_
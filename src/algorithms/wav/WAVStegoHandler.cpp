@@ -0,0 +1,387 @@
+#include "WAVStegoHandler.h"
+#include "../../utils/MappedFile.h"
+#include "../../utils/Parallel.h"
+#include "../../utils/Stats.h"
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+/**
+ * Payload bytes handled per parallel work item (8 samples each)
+ */
+constexpr std::size_t BYTES_PER_TASK = std::size_t(1) << 16;
+
+inline uint16_t ReadLE16(const uint8_t *ptr) {
+    return static_cast<uint16_t>(ptr[0] | (ptr[1] << 8));
+}
+
+inline uint32_t ReadLE32(const uint8_t *ptr) {
+    return static_cast<uint32_t>(ptr[0]) | (static_cast<uint32_t>(ptr[1]) << 8) |
+           (static_cast<uint32_t>(ptr[2]) << 16) | (static_cast<uint32_t>(ptr[3]) << 24);
+}
+
+/**
+ * Little-endian samples keep bit 0 in their first byte, whatever the width.
+ */
+inline void SetSampleLSB(uint8_t *samples, std::size_t stride, std::size_t sampleIdx, uint32_t bit) {
+    uint8_t &low = samples[sampleIdx * stride];
+    uint8_t value = static_cast<uint8_t>((low & 0xFE) | bit);
+    if (low != value) {
+        low = value; // untouched pages stay shared with the file
+    }
+}
+
+inline uint32_t GetSampleLSB(const uint8_t *samples, std::size_t stride, std::size_t sampleIdx) {
+    return samples[sampleIdx * stride] & 1u;
+}
+
+bool HasWavExtension(const std::string &filename) {
+    std::size_t dotPos = filename.find_last_of(".");
+    if (dotPos == std::string::npos) {
+        return false;
+    }
+    std::string ext = filename.substr(dotPos + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext == "wav" || ext == "wave";
+}
+
+Result<WavLayout> LoadLayout(const MappedFile &file, const std::string &filename) {
+    auto layoutResult = WAVStegoHandler::ParseLayout(file.Data(), file.Size());
+    if (!layoutResult) {
+        return Result<WavLayout>(layoutResult.GetErrorCode(),
+                                 "'" + filename + "': " + layoutResult.GetErrorMessage());
+    }
+    return layoutResult;
+}
+
+} // namespace
+
+Result<WavLayout> WAVStegoHandler::ParseLayout(const uint8_t *file, std::size_t size) {
+
+    if (size < 12 || std::memcmp(file, "RIFF", 4) != 0 || std::memcmp(file + 8, "WAVE", 4) != 0) {
+        return Result<WavLayout>(ErrorCode::UnsupportedImageFormat, "WAV method requires a RIFF/WAVE file");
+    }
+
+    WavLayout layout;
+    uint16_t format = 0;
+    uint16_t blockAlign = 0;
+    bool hasFormat = false;
+
+    std::size_t pos = 12;
+    while (size - pos >= 8) {
+        const uint8_t *chunk = file + pos;
+        std::size_t chunkSize = ReadLE32(chunk + 4);
+        std::size_t body = pos + 8;
+        std::size_t available = std::min(chunkSize, size - body);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (available < 16) {
+                return Result<WavLayout>(ErrorCode::ImageCorrupted, "WAV format chunk is truncated");
+            }
+            format = ReadLE16(file + body);
+            layout.channels = ReadLE16(file + body + 2);
+            layout.sampleRate = ReadLE32(file + body + 4);
+            blockAlign = ReadLE16(file + body + 12);
+            layout.bitsPerSample = ReadLE16(file + body + 14);
+
+            // Extensible headers carry the real format code in the sub-format GUID
+            if (format == WAVE_FORMAT_EXTENSIBLE && available >= 40) {
+                format = ReadLE16(file + body + 24);
+            }
+            hasFormat = true;
+
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!hasFormat) {
+                return Result<WavLayout>(ErrorCode::ImageCorrupted, "WAV data chunk precedes the format chunk");
+            }
+            layout.dataOffset = body;
+            layout.dataSize = available;
+            break;
+        }
+
+        if (chunkSize > size - body) {
+            break; // truncated chunk before any data
+        }
+        pos = body + chunkSize + (chunkSize & 1); // chunks are word aligned
+        if (pos > size) {
+            break;
+        }
+    }
+
+    if (!hasFormat || layout.dataOffset == 0) {
+        return Result<WavLayout>(ErrorCode::ImageCorrupted, "WAV file has no format or data chunk");
+    }
+
+    if (format != WAVE_FORMAT_PCM) {
+        std::ostringstream oss;
+        oss << "WAV method requires integer PCM samples (format code " << format << " is not supported)";
+        return Result<WavLayout>(ErrorCode::UnsupportedImageFormat, oss.str());
+    }
+
+    if (layout.bitsPerSample != 8 && layout.bitsPerSample != 16 &&
+        layout.bitsPerSample != 24 && layout.bitsPerSample != 32) {
+        std::ostringstream oss;
+        oss << "WAV method supports 8, 16, 24 and 32-bit PCM (file has " << layout.bitsPerSample << " bits)";
+        return Result<WavLayout>(ErrorCode::UnsupportedImageFormat, oss.str());
+    }
+
+    layout.bytesPerSample = static_cast<uint16_t>(layout.bitsPerSample / 8);
+    if (layout.channels == 0 || blockAlign != layout.channels * layout.bytesPerSample) {
+        return Result<WavLayout>(ErrorCode::ImageCorrupted, "WAV format chunk has an invalid channel count or block alignment");
+    }
+
+    // Ignore a trailing partial frame
+    layout.dataSize -= layout.dataSize % blockAlign;
+    return Result<WavLayout>(layout);
+}
+
+std::size_t WAVStegoHandler::CalculateCapacity(const WavLayout &layout) {
+    std::size_t samples = layout.GetSampleCount();
+    if (samples <= HEADER_SIZE_BITS) {
+        return 0;
+    }
+    return (samples - HEADER_SIZE_BITS) / 8;
+}
+
+Result<> WAVStegoHandler::EmbedSamples(uint8_t *file, const WavLayout &layout, const std::vector<uint8_t> &dataToEmbed) {
+
+    StageTimer timer(Stats::Stage::Embed, dataToEmbed.size());
+    Stats::Add(Stats::Counter::SamplesTouched, layout.GetSampleCount());
+
+    if (dataToEmbed.empty()) {
+        return Result<>(ErrorCode::InvalidArgument, "Cannot embed empty data");
+    }
+
+    if (dataToEmbed.size() > MAX_REASONABLE_SIZE) {
+        std::ostringstream oss;
+        oss << "Data size (" << dataToEmbed.size() << " bytes) exceeds maximum allowed size ("
+            << MAX_REASONABLE_SIZE << " bytes)";
+        return Result<>(ErrorCode::DataTooLarge, oss.str());
+    }
+
+    // Validate capacity
+    std::size_t availableCapacity = CalculateCapacity(layout);
+    if (dataToEmbed.size() > availableCapacity) {
+        std::ostringstream oss;
+        oss << "Data size (" << dataToEmbed.size() << " bytes) exceeds WAV capacity (" << availableCapacity
+            << " bytes).\n"
+            << "    Every PCM sample carries one bit.";
+        return Result<>(ErrorCode::InsufficientCapacity, oss.str());
+    }
+
+    uint8_t *samples = file + layout.dataOffset;
+    std::size_t stride = layout.bytesPerSample;
+
+    auto header = EncodePayloadHeader(static_cast<uint32_t>(dataToEmbed.size()));
+    for (std::size_t bitIdx = 0; bitIdx < HEADER_SIZE_BITS; ++bitIdx) {
+        SetSampleLSB(samples, stride, bitIdx, (header[bitIdx / 8] >> (bitIdx % 8)) & 1u);
+    }
+
+    // Work items cover disjoint sample ranges
+    std::size_t taskCount = (dataToEmbed.size() + BYTES_PER_TASK - 1) / BYTES_PER_TASK;
+    Parallel::For(taskCount, [&](std::size_t task) {
+        std::size_t begin = task * BYTES_PER_TASK;
+        std::size_t end = std::min(begin + BYTES_PER_TASK, dataToEmbed.size());
+        for (std::size_t byteIdx = begin; byteIdx < end; ++byteIdx) {
+            std::size_t sampleIdx = HEADER_SIZE_BITS + byteIdx * 8;
+            uint8_t byte = dataToEmbed[byteIdx];
+            for (std::size_t bit = 0; bit < 8; ++bit) {
+                SetSampleLSB(samples, stride, sampleIdx + bit, (byte >> bit) & 1u);
+            }
+        }
+    });
+
+    return Result<>();
+}
+
+Result<std::vector<uint8_t>> WAVStegoHandler::ExtractSamples(const uint8_t *file, const WavLayout &layout) {
+
+    StageTimer timer(Stats::Stage::Extract);
+    Stats::Add(Stats::Counter::SamplesTouched, layout.GetSampleCount());
+
+    const uint8_t *samples = file + layout.dataOffset;
+    std::size_t stride = layout.bytesPerSample;
+    std::size_t sampleCount = layout.GetSampleCount();
+
+    // Header first: rejects files without a payload before reading the rest
+    auto headerResult = ReadPayloadHeader(sampleCount, [&](std::size_t bitIdx) {
+        return GetSampleLSB(samples, stride, bitIdx);
+    });
+    if (!headerResult) {
+        return Result<std::vector<uint8_t>>(headerResult.GetErrorCode(), headerResult.GetErrorMessage());
+    }
+    uint32_t dataSize = headerResult.GetValue().dataSize;
+    std::size_t headerBits = headerResult.GetValue().GetSizeBits();
+    std::size_t availableCapacity = sampleCount > headerBits ? (sampleCount - headerBits) / 8 : 0;
+
+    if (dataSize == 0) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::NoEmbeddedData,
+            "Extracted size is 0. File may not contain embedded data."
+        );
+    }
+
+    if (dataSize > MAX_REASONABLE_SIZE) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) exceeds maximum reasonable size ("
+            << MAX_REASONABLE_SIZE << " bytes). Data is likely corrupted.";
+        return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, oss.str());
+    }
+
+    if (dataSize > availableCapacity) {
+        std::ostringstream oss;
+        oss << "Extracted size (" << dataSize << " bytes) exceeds WAV capacity (" << availableCapacity << " bytes). "
+            << "Data is corrupted or file does not contain WAV embedded data.";
+        return Result<std::vector<uint8_t>>(ErrorCode::InvalidDataSize, oss.str());
+    }
+
+    std::vector<uint8_t> extractedData(dataSize);
+    std::size_t taskCount = (extractedData.size() + BYTES_PER_TASK - 1) / BYTES_PER_TASK;
+    Parallel::For(taskCount, [&](std::size_t task) {
+        std::size_t begin = task * BYTES_PER_TASK;
+        std::size_t end = std::min(begin + BYTES_PER_TASK, extractedData.size());
+        for (std::size_t byteIdx = begin; byteIdx < end; ++byteIdx) {
+            std::size_t sampleIdx = headerBits + byteIdx * 8;
+            uint32_t byte = 0;
+            for (std::size_t bit = 0; bit < 8; ++bit) {
+                byte |= GetSampleLSB(samples, stride, sampleIdx + bit) << bit;
+            }
+            extractedData[byteIdx] = static_cast<uint8_t>(byte);
+        }
+    });
+
+    return Result<std::vector<uint8_t>>(extractedData);
+}
+
+Result<> WAVStegoHandler::Embed(const std::string &coverFile,
+                                const std::string &dataFile,
+                                const std::string &outputFile,
+                                const std::string &password) {
+    namespace fs = std::filesystem;
+
+    if (!HasWavExtension(outputFile)) {
+        return Result<>(
+            ErrorCode::UnsupportedImageFormat,
+            "WAV method writes WAV files, output '" + outputFile + "' must have a .wav extension"
+        );
+    }
+
+    // Map cover privately, embedding never touches the file on disk
+    auto mapResult = MappedFile::Open(coverFile, MappedFile::Mode::CopyOnWrite);
+    if (!mapResult) {
+        return Result<>(mapResult.GetErrorCode(), mapResult.GetErrorMessage());
+    }
+    MappedFile cover = std::move(mapResult.GetValue());
+
+    auto layoutResult = LoadLayout(cover, coverFile);
+    if (!layoutResult) {
+        return Result<>(layoutResult.GetErrorCode(), layoutResult.GetErrorMessage());
+    }
+
+    // Load and encrypt data
+    auto encryptResult = LoadEncryptedData(dataFile, password);
+    if (!encryptResult) {
+        return Result<>(encryptResult.GetErrorCode(), encryptResult.GetErrorMessage());
+    }
+
+    // Embed data into the mapped samples
+    auto embedResult = EmbedSamples(cover.Data(), layoutResult.GetValue(), encryptResult.GetValue());
+    if (!embedResult) {
+        return embedResult;
+    }
+
+    // Output may be the cover itself: write beside it, unmap, then replace
+    std::string tempFile = outputFile + ".tmp";
+    auto writeResult = cover.WriteTo(tempFile);
+    cover.Close();
+    if (!writeResult) {
+        std::error_code ignored;
+        fs::remove(tempFile, ignored);
+        return writeResult;
+    }
+
+    std::error_code renameError;
+    fs::rename(tempFile, outputFile, renameError);
+    if (renameError) {
+        std::error_code ignored;
+        fs::remove(tempFile, ignored);
+        return Result<>(
+            ErrorCode::FileWriteError,
+            "Failed to write '" + outputFile + "': " + renameError.message()
+        );
+    }
+
+    return Result<>();
+}
+
+Result<> WAVStegoHandler::Extract(const std::string &stegoFile,
+                                  const std::string &outputFile,
+                                  const std::string &password) {
+
+    // Map stego file
+    auto mapResult = MappedFile::Open(stegoFile, MappedFile::Mode::ReadOnly);
+    if (!mapResult) {
+        return Result<>(mapResult.GetErrorCode(), mapResult.GetErrorMessage());
+    }
+    const MappedFile &stego = mapResult.GetValue();
+
+    auto layoutResult = LoadLayout(stego, stegoFile);
+    if (!layoutResult) {
+        return Result<>(layoutResult.GetErrorCode(), layoutResult.GetErrorMessage());
+    }
+
+    // Extract encrypted data
+    auto extractResult = ExtractSamples(stego.Data(), layoutResult.GetValue());
+    if (!extractResult) {
+        return Result<>(
+            extractResult.GetErrorCode(),
+            "Extraction failed: " + extractResult.GetErrorMessage()
+        );
+    }
+
+    // Decrypt data and write output file
+    return SaveDecryptedData(extractResult.GetValue(), outputFile, password);
+}
+
+Result<> WAVStegoHandler::Visual(const std::string &coverFile,
+                                 const std::string &dataFile,
+                                 const std::string &outputFile,
+                                 const std::string &password) {
+    (void) coverFile;
+    (void) dataFile;
+    (void) outputFile;
+    (void) password;
+    return Result<>(ErrorCode::NotImplemented, "WAV method has no image to visualize");
+}
+
+Result<> WAVStegoHandler::EmbedMethod(ImageData &imageData,
+                                      const std::vector<uint8_t> &dataToEmbed,
+                                      const std::string &password) {
+    (void) imageData;
+    (void) dataToEmbed;
+    (void) password;
+    return Result<>(ErrorCode::NotImplemented, "WAV method embeds into WAV files, not decoded pixels");
+}
+
+Result<std::vector<uint8_t>> WAVStegoHandler::ExtractMethod(const ImageData &imageData,
+                                                            const std::string &password) {
+    (void) imageData;
+    (void) password;
+    return Result<std::vector<uint8_t>>(ErrorCode::NotImplemented, "WAV method extracts from WAV files, not decoded pixels");
+}
+
+Result<> WAVStegoHandler::VisualizeMethod(ImageData &imageData) {
+    (void) imageData;
+    return Result<>(ErrorCode::NotImplemented, "WAV method visualizes WAV files, not decoded pixels");
+}
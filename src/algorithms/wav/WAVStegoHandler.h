@@ -0,0 +1,126 @@
+#ifndef __WAV_STEGO_HANDLER_H_
+#define __WAV_STEGO_HANDLER_H_
+
+#include "../StegoHandler.h"
+
+#include <cstddef>
+#include <vector>
+#include <string>
+
+/**
+ * @brief Position of the PCM samples inside a WAV file.
+ */
+struct WavLayout {
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint16_t bitsPerSample = 0;
+    uint16_t bytesPerSample = 0;
+    std::size_t dataOffset = 0;  // Byte offset of the first sample in the file
+    std::size_t dataSize = 0;    // Bytes of whole frames in the data chunk
+
+    std::size_t GetSampleCount() const { return bytesPerSample == 0 ? 0 : dataSize / bytesPerSample; }
+};
+
+/**
+ * @brief LSB steganography in the samples of uncompressed PCM WAV files.
+ *
+ * Payload bits replace bit 0 of every sample (all channels, in file order).
+ * Samples are little-endian, so that bit lives in the first byte of each
+ * sample for 8, 16, 24 and 32-bit PCM alike.
+ *
+ * The cover is memory-mapped copy-on-write and modified in place: only touched
+ * pages are copied, nothing is decoded into a sample vector, and the stego file
+ * is written from the mapping in one sequential pass. Multi-GB recordings
+ * therefore cost little more than the pages actually changed.
+ *
+ * Format: [payload header | data bits]. Works on WAV files only; the
+ * pixel-level methods are not available.
+ */
+class WAVStegoHandler : public StegoHandler {
+public:
+    /**
+    * Size of the header for steganography decoding
+    **/
+    static constexpr uint32_t HEADER_SIZE_BITS = static_cast<uint32_t>(PayloadHeader::SIZE_BITS);
+
+    /**
+     * @brief Locate the fmt and data chunks of a RIFF/WAVE file.
+     *
+     * Accepts integer PCM (plain or WAVE_FORMAT_EXTENSIBLE) with 8, 16, 24 or
+     * 32 bits per sample. A data chunk that claims more bytes than the file
+     * holds (e.g. an unfinished recording) is clamped to the bytes present.
+     *
+     * @param file Start of the file contents
+     * @param size File size in bytes
+     * @return Result containing the sample layout or error
+     */
+    static Result<WavLayout> ParseLayout(const uint8_t *file, std::size_t size);
+
+    /**
+     * @brief Calculate WAV capacity in bytes.
+     *
+     * @param layout Sample layout of the cover
+     * @return Maximum bytes that can be embedded
+     */
+    static std::size_t CalculateCapacity(const WavLayout &layout);
+
+    /**
+     * @brief Embeds data into the sample LSBs of a WAV file image.
+     *
+     * @param file File contents to modify (in-place)
+     * @param layout Sample layout from ParseLayout
+     * @param dataToEmbed Data to embed (already encrypted)
+     * @return Result indicating success or embedding error
+     */
+    Result<> EmbedSamples(uint8_t *file, const WavLayout &layout, const std::vector<uint8_t> &dataToEmbed);
+
+    /**
+     * @brief Extracts data from the sample LSBs of a WAV file image.
+     *
+     * @param file File contents to read from
+     * @param layout Sample layout from ParseLayout
+     * @return Result containing extracted data (encrypted) or error
+     */
+    Result<std::vector<uint8_t>> ExtractSamples(const uint8_t *file, const WavLayout &layout);
+
+    Result<> Embed(const std::string &coverFile,
+                   const std::string &dataFile,
+                   const std::string &outputFile,
+                   const std::string &password) override;
+
+    Result<> Extract(const std::string &stegoFile,
+                     const std::string &outputFile,
+                     const std::string &password) override;
+
+    /**
+     * @brief Not available: WAV files have no image to mark.
+     */
+    Result<> Visual(const std::string &coverFile,
+                    const std::string &dataFile,
+                    const std::string &outputFile,
+                    const std::string &password) override;
+
+    /**
+     * @brief Not available: WAV embedding works on audio files, not pixels.
+     */
+    Result<> EmbedMethod(ImageData &imageData,
+                         const std::vector<uint8_t> &dataToEmbed,
+                         const std::string &password ) override;
+
+    /**
+     * @brief Not available: WAV extraction works on audio files, not pixels.
+     */
+    Result<std::vector<uint8_t>> ExtractMethod(const ImageData &imageData,
+                                               const std::string &password ) override;
+
+    /**
+     * @brief Not available: see Visual.
+     */
+    Result<> VisualizeMethod(ImageData &imageData) override;
+
+    PayloadMethod GetPayloadMethod() const override { return PayloadMethod::WAV; }
+
+    ~WAVStegoHandler() override = default;
+};
+
+#endif // __WAV_STEGO_HANDLER_H_
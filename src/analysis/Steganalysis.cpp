@@ -0,0 +1,758 @@
+#include "Steganalysis.h"
+#include "../utils/Parallel.h"
+#include "../utils/CpuFeatures.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * Pairs with fewer samples are left out of the chi-square sum
+ */
+constexpr uint64_t MIN_PAIR_SAMPLES = 10;
+
+/**
+ * Shifted LSB flip F-1: -1 <-> 0, 1 <-> 2, ..., 255 <-> 256
+ */
+std::array<int, 256> MakeShiftedFlip() {
+    std::array<int, 256> table{};
+    for (int value = 0; value < 256; ++value) {
+        table[static_cast<std::size_t>(value)] = (value & 1) ? value + 1 : value - 1;
+    }
+    return table;
+}
+
+const std::array<int, 256> SHIFTED_FLIP = MakeShiftedFlip();
+
+inline int Smoothness(int v0, int v1, int v2, int v3) {
+    return std::abs(v1 - v0) + std::abs(v2 - v1) + std::abs(v3 - v2);
+}
+
+void CountRSGroupsScalar(const uint8_t *samples, std::size_t groups, RSCounts &counts) {
+    for (std::size_t group = 0; group < groups; ++group) {
+        const uint8_t *s = samples + group * 4;
+        int v0 = s[0];
+        int v1 = s[1];
+        int v2 = s[2];
+        int v3 = s[3];
+
+        // Group as is, with F1 and F-1 applied to the inner samples
+        int f = Smoothness(v0, v1, v2, v3);
+        int fM = Smoothness(v0, v1 ^ 1, v2 ^ 1, v3);
+        int fNegM = Smoothness(v0, SHIFTED_FLIP[static_cast<std::size_t>(v1)], SHIFTED_FLIP[static_cast<std::size_t>(v2)], v3);
+
+        // Same group after flipping every LSB of the image
+        int w0 = v0 ^ 1;
+        int w1 = v1 ^ 1;
+        int w2 = v2 ^ 1;
+        int w3 = v3 ^ 1;
+        int g = Smoothness(w0, w1, w2, w3);
+        int gM = Smoothness(w0, v1, v2, w3);
+        int gNegM = Smoothness(w0, SHIFTED_FLIP[static_cast<std::size_t>(w1)], SHIFTED_FLIP[static_cast<std::size_t>(w2)], w3);
+
+        counts.regularM += fM > f;
+        counts.singularM += fM < f;
+        counts.regularNegM += fNegM > f;
+        counts.singularNegM += fNegM < f;
+        counts.flippedRegularM += gM > g;
+        counts.flippedSingularM += gM < g;
+        counts.flippedRegularNegM += gNegM > g;
+        counts.flippedSingularNegM += gNegM < g;
+    }
+    counts.groups += groups;
+}
+
+#ifdef STEGTOOL_X86_SIMD
+
+/**
+ * Vector iterations between two flushes of the 16-bit counters; every lane
+ * gains at most 2 per iteration, so they stay below 65536
+ */
+constexpr std::size_t RS_FLUSH_ITERATIONS = 8192;
+
+/**
+ * Order of the count lanes, as the members of RSCounts after 'groups'
+ */
+enum RSLane { REGULAR_M, SINGULAR_M, REGULAR_NEG_M, SINGULAR_NEG_M,
+              FLIPPED_REGULAR_M, FLIPPED_SINGULAR_M, FLIPPED_REGULAR_NEG_M, FLIPPED_SINGULAR_NEG_M, RS_LANES };
+
+void AddLanes(const uint16_t *lanes, std::size_t width, RSCounts &counts) {
+    uint64_t *totals[RS_LANES] = {&counts.regularM, &counts.singularM, &counts.regularNegM, &counts.singularNegM,
+                                  &counts.flippedRegularM, &counts.flippedSingularM,
+                                  &counts.flippedRegularNegM, &counts.flippedSingularNegM};
+    for (std::size_t lane = 0; lane < RS_LANES; ++lane) {
+        for (std::size_t idx = 0; idx < width; ++idx) {
+            *totals[lane] += lanes[lane * width + idx];
+        }
+    }
+}
+
+__attribute__((target("ssse3")))
+inline __m128i SmoothnessSsse3(__m128i v0, __m128i v1, __m128i v2, __m128i v3) {
+    return _mm_add_epi16(_mm_add_epi16(_mm_abs_epi16(_mm_sub_epi16(v1, v0)), _mm_abs_epi16(_mm_sub_epi16(v2, v1))),
+                         _mm_abs_epi16(_mm_sub_epi16(v3, v2)));
+}
+
+/**
+ * F-1(v) = ((v + 1) ^ 1) - 1 on 16-bit samples
+ */
+__attribute__((target("ssse3")))
+inline __m128i ShiftedFlipSsse3(__m128i v, __m128i one) {
+    return _mm_sub_epi16(_mm_xor_si128(_mm_add_epi16(v, one), one), one);
+}
+
+/**
+ * Regular (changed > base) and singular (changed < base) hits; the counters go down by one per hit
+ */
+__attribute__((target("ssse3")))
+inline void TallySsse3(__m128i changed, __m128i base, __m128i *acc) {
+    acc[0] = _mm_add_epi16(acc[0], _mm_cmpgt_epi16(changed, base));
+    acc[1] = _mm_add_epi16(acc[1], _mm_cmpgt_epi16(base, changed));
+}
+
+/**
+ * Counts 8 groups held as 16-bit samples
+ */
+__attribute__((target("ssse3")))
+inline void CountGroupsSsse3(__m128i v0, __m128i v1, __m128i v2, __m128i v3, __m128i *acc) {
+    const __m128i one = _mm_set1_epi16(1);
+
+    __m128i f = SmoothnessSsse3(v0, v1, v2, v3);
+    TallySsse3(SmoothnessSsse3(v0, _mm_xor_si128(v1, one), _mm_xor_si128(v2, one), v3), f, acc + REGULAR_M);
+    TallySsse3(SmoothnessSsse3(v0, ShiftedFlipSsse3(v1, one), ShiftedFlipSsse3(v2, one), v3), f, acc + REGULAR_NEG_M);
+
+    __m128i w0 = _mm_xor_si128(v0, one);
+    __m128i w1 = _mm_xor_si128(v1, one);
+    __m128i w2 = _mm_xor_si128(v2, one);
+    __m128i w3 = _mm_xor_si128(v3, one);
+    __m128i g = SmoothnessSsse3(w0, w1, w2, w3);
+    TallySsse3(SmoothnessSsse3(w0, v1, v2, w3), g, acc + FLIPPED_REGULAR_M);
+    TallySsse3(SmoothnessSsse3(w0, ShiftedFlipSsse3(w1, one), ShiftedFlipSsse3(w2, one), w3), g, acc + FLIPPED_REGULAR_NEG_M);
+}
+
+/**
+ * 16 groups per iteration: pshufb sorts each register's 4 groups by position,
+ * a 4x4 transpose of 32-bit words gathers the same position of all 16 groups
+ * into one register, which is then widened to 16 bits in two halves. The
+ * groups end up permuted, which the totals do not care about.
+ */
+__attribute__((target("ssse3")))
+void CountRSGroupsSsse3(const uint8_t *samples, std::size_t groups, RSCounts &counts) {
+    const __m128i byPosition = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc[RS_LANES];
+    alignas(16) uint16_t lanes[RS_LANES * 8];
+
+    std::size_t group = 0;
+    while (group + 16 <= groups) {
+        for (auto &lane : acc) {
+            lane = _mm_setzero_si128();
+        }
+        for (std::size_t iteration = 0; iteration < RS_FLUSH_ITERATIONS && group + 16 <= groups; ++iteration, group += 16) {
+            const __m128i *block = reinterpret_cast<const __m128i *>(samples + group * 4);
+            __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(block), byPosition);
+            __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(block + 1), byPosition);
+            __m128i c = _mm_shuffle_epi8(_mm_loadu_si128(block + 2), byPosition);
+            __m128i d = _mm_shuffle_epi8(_mm_loadu_si128(block + 3), byPosition);
+            __m128i ab01 = _mm_unpacklo_epi32(a, b);
+            __m128i cd01 = _mm_unpacklo_epi32(c, d);
+            __m128i ab23 = _mm_unpackhi_epi32(a, b);
+            __m128i cd23 = _mm_unpackhi_epi32(c, d);
+            __m128i p0 = _mm_unpacklo_epi64(ab01, cd01);
+            __m128i p1 = _mm_unpackhi_epi64(ab01, cd01);
+            __m128i p2 = _mm_unpacklo_epi64(ab23, cd23);
+            __m128i p3 = _mm_unpackhi_epi64(ab23, cd23);
+
+            CountGroupsSsse3(_mm_unpacklo_epi8(p0, zero), _mm_unpacklo_epi8(p1, zero),
+                             _mm_unpacklo_epi8(p2, zero), _mm_unpacklo_epi8(p3, zero), acc);
+            CountGroupsSsse3(_mm_unpackhi_epi8(p0, zero), _mm_unpackhi_epi8(p1, zero),
+                             _mm_unpackhi_epi8(p2, zero), _mm_unpackhi_epi8(p3, zero), acc);
+        }
+        for (std::size_t lane = 0; lane < RS_LANES; ++lane) {
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes + lane * 8), _mm_sub_epi16(zero, acc[lane]));
+        }
+        AddLanes(lanes, 8, counts);
+    }
+
+    counts.groups += group;
+    CountRSGroupsScalar(samples + group * 4, groups - group, counts);
+}
+
+__attribute__((target("avx2")))
+inline __m256i SmoothnessAvx2(__m256i v0, __m256i v1, __m256i v2, __m256i v3) {
+    return _mm256_add_epi16(_mm256_add_epi16(_mm256_abs_epi16(_mm256_sub_epi16(v1, v0)),
+                                             _mm256_abs_epi16(_mm256_sub_epi16(v2, v1))),
+                            _mm256_abs_epi16(_mm256_sub_epi16(v3, v2)));
+}
+
+__attribute__((target("avx2")))
+inline __m256i ShiftedFlipAvx2(__m256i v, __m256i one) {
+    return _mm256_sub_epi16(_mm256_xor_si256(_mm256_add_epi16(v, one), one), one);
+}
+
+__attribute__((target("avx2")))
+inline void TallyAvx2(__m256i changed, __m256i base, __m256i *acc) {
+    acc[0] = _mm256_add_epi16(acc[0], _mm256_cmpgt_epi16(changed, base));
+    acc[1] = _mm256_add_epi16(acc[1], _mm256_cmpgt_epi16(base, changed));
+}
+
+__attribute__((target("avx2")))
+inline void CountGroupsAvx2(__m256i v0, __m256i v1, __m256i v2, __m256i v3, __m256i *acc) {
+    const __m256i one = _mm256_set1_epi16(1);
+
+    __m256i f = SmoothnessAvx2(v0, v1, v2, v3);
+    TallyAvx2(SmoothnessAvx2(v0, _mm256_xor_si256(v1, one), _mm256_xor_si256(v2, one), v3), f, acc + REGULAR_M);
+    TallyAvx2(SmoothnessAvx2(v0, ShiftedFlipAvx2(v1, one), ShiftedFlipAvx2(v2, one), v3), f, acc + REGULAR_NEG_M);
+
+    __m256i w0 = _mm256_xor_si256(v0, one);
+    __m256i w1 = _mm256_xor_si256(v1, one);
+    __m256i w2 = _mm256_xor_si256(v2, one);
+    __m256i w3 = _mm256_xor_si256(v3, one);
+    __m256i g = SmoothnessAvx2(w0, w1, w2, w3);
+    TallyAvx2(SmoothnessAvx2(w0, v1, v2, w3), g, acc + FLIPPED_REGULAR_M);
+    TallyAvx2(SmoothnessAvx2(w0, ShiftedFlipAvx2(w1, one), ShiftedFlipAvx2(w2, one), w3), g, acc + FLIPPED_REGULAR_NEG_M);
+}
+
+__attribute__((target("avx2")))
+void CountRSGroupsAvx2(const uint8_t *samples, std::size_t groups, RSCounts &counts) {
+    // vpshufb and the unpacks work within each 128-bit lane, which sorts both lanes alike
+    const __m256i byPosition = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+                                                0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc[RS_LANES];
+    alignas(32) uint16_t lanes[RS_LANES * 16];
+
+    std::size_t group = 0;
+    while (group + 32 <= groups) {
+        for (auto &lane : acc) {
+            lane = _mm256_setzero_si256();
+        }
+        for (std::size_t iteration = 0; iteration < RS_FLUSH_ITERATIONS && group + 32 <= groups; ++iteration, group += 32) {
+            const __m256i *block = reinterpret_cast<const __m256i *>(samples + group * 4);
+            __m256i a = _mm256_shuffle_epi8(_mm256_loadu_si256(block), byPosition);
+            __m256i b = _mm256_shuffle_epi8(_mm256_loadu_si256(block + 1), byPosition);
+            __m256i c = _mm256_shuffle_epi8(_mm256_loadu_si256(block + 2), byPosition);
+            __m256i d = _mm256_shuffle_epi8(_mm256_loadu_si256(block + 3), byPosition);
+            __m256i ab01 = _mm256_unpacklo_epi32(a, b);
+            __m256i cd01 = _mm256_unpacklo_epi32(c, d);
+            __m256i ab23 = _mm256_unpackhi_epi32(a, b);
+            __m256i cd23 = _mm256_unpackhi_epi32(c, d);
+            __m256i p0 = _mm256_unpacklo_epi64(ab01, cd01);
+            __m256i p1 = _mm256_unpackhi_epi64(ab01, cd01);
+            __m256i p2 = _mm256_unpacklo_epi64(ab23, cd23);
+            __m256i p3 = _mm256_unpackhi_epi64(ab23, cd23);
+
+            CountGroupsAvx2(_mm256_unpacklo_epi8(p0, zero), _mm256_unpacklo_epi8(p1, zero),
+                            _mm256_unpacklo_epi8(p2, zero), _mm256_unpacklo_epi8(p3, zero), acc);
+            CountGroupsAvx2(_mm256_unpackhi_epi8(p0, zero), _mm256_unpackhi_epi8(p1, zero),
+                            _mm256_unpackhi_epi8(p2, zero), _mm256_unpackhi_epi8(p3, zero), acc);
+        }
+        for (std::size_t lane = 0; lane < RS_LANES; ++lane) {
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes + lane * 16), _mm256_sub_epi16(zero, acc[lane]));
+        }
+        AddLanes(lanes, 16, counts);
+    }
+
+    counts.groups += group;
+    CountRSGroupsScalar(samples + group * 4, groups - group, counts);
+}
+
+#endif
+
+using CountRSGroupsFn = void (*)(const uint8_t *, std::size_t, RSCounts &);
+
+CountRSGroupsFn SelectCountRSGroups() {
+#ifdef STEGTOOL_X86_SIMD
+    switch (CpuFeatures::GetSimdLevel()) {
+        case SimdLevel::Avx2: return CountRSGroupsAvx2;
+        case SimdLevel::Ssse3: return CountRSGroupsSsse3;
+        case SimdLevel::Portable: break;
+    }
+#endif
+    return CountRSGroupsScalar;
+}
+
+/**
+ * Regularized upper incomplete gamma function Q(a, x)
+ */
+double UpperGammaRegularized(double a, double x) {
+    if (x <= 0.0) {
+        return 1.0;
+    }
+
+    constexpr int MAX_ITERATIONS = 1000;
+    constexpr double EPSILON = 1e-14;
+    constexpr double TINY = 1e-300;
+    double logPrefix = -x + a * std::log(x) - std::lgamma(a);
+
+    if (x < a + 1.0) {
+        // Series expansion of the lower function P
+        double term = 1.0 / a;
+        double sum = term;
+        for (int n = 1; n < MAX_ITERATIONS; ++n) {
+            term *= x / (a + n);
+            sum += term;
+            if (std::fabs(term) < std::fabs(sum) * EPSILON) {
+                break;
+            }
+        }
+        return std::clamp(1.0 - sum * std::exp(logPrefix), 0.0, 1.0);
+    }
+
+    // Continued fraction for Q (modified Lentz)
+    double b = x + 1.0 - a;
+    double c = 1.0 / TINY;
+    double d = 1.0 / b;
+    double h = d;
+    for (int n = 1; n < MAX_ITERATIONS; ++n) {
+        double an = -n * (n - a);
+        b += 2.0;
+        d = an * d + b;
+        if (std::fabs(d) < TINY) {
+            d = TINY;
+        }
+        c = b + an / c;
+        if (std::fabs(c) < TINY) {
+            c = TINY;
+        }
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1.0) < EPSILON) {
+            break;
+        }
+    }
+    return std::clamp(std::exp(logPrefix) * h, 0.0, 1.0);
+}
+
+/**
+ * Statistics of one row band, per analyzed channel
+ */
+struct BandStats {
+    std::vector<std::array<uint64_t, 256>> histograms;
+    std::vector<RSCounts> rs;
+    std::vector<SPACounts> spa;
+    std::vector<WSSums> ws;
+};
+
+void AnalyzeBand(const ImageData &image, int analyzed, int band, BandStats &stats) {
+    const std::size_t width = static_cast<std::size_t>(image.width);
+    const std::size_t stride = static_cast<std::size_t>(image.channels);
+    const int firstRow = band * Steganalysis::TILE_ROWS;
+    const int lastRow = std::min(image.height, firstRow + Steganalysis::TILE_ROWS);
+
+    stats.histograms.assign(static_cast<std::size_t>(analyzed), {});
+    stats.rs.assign(static_cast<std::size_t>(analyzed), RSCounts{});
+    stats.spa.assign(static_cast<std::size_t>(analyzed), SPACounts{});
+    stats.ws.assign(static_cast<std::size_t>(analyzed), WSSums{});
+
+    // Four sub-histograms break the dependency between neighboring increments.
+    // They stay scalar: a vector histogram needs conflict detection (AVX-512CD)
+    // to merge equal values within a register, and the increments take about 4%
+    // of the pass (58 of 1505 ms on a 24 MP RGB photo), so there is little to win.
+    std::vector<uint32_t> lanes(4 * 256);
+    // Samples of one channel row, contiguous for the RS kernel
+    std::vector<uint8_t> packed(stride == 1 ? 0 : width);
+
+    for (int channel = 0; channel < analyzed; ++channel) {
+        std::fill(lanes.begin(), lanes.end(), 0u);
+        uint32_t *h0 = lanes.data();
+        uint32_t *h1 = h0 + 256;
+        uint32_t *h2 = h1 + 256;
+        uint32_t *h3 = h2 + 256;
+        RSCounts &counts = stats.rs[static_cast<std::size_t>(channel)];
+        SPACounts &pairs = stats.spa[static_cast<std::size_t>(channel)];
+        WSSums &ws = stats.ws[static_cast<std::size_t>(channel)];
+
+        for (int y = firstRow; y < lastRow; ++y) {
+            const std::size_t rowStride = width * stride;
+            const uint8_t *row = image.pixels.data() + static_cast<std::size_t>(y) * rowStride + channel;
+            const bool interiorRow = y > 0 && y + 1 < image.height;
+
+            const uint8_t *samples = row;
+            if (stride != 1) {
+                for (std::size_t x = 0; x < width; ++x) {
+                    packed[x] = row[x * stride];
+                }
+                samples = packed.data();
+            }
+
+            // SPA pair with the left neighbor and WS residual against the 4-neighbor mean
+            auto visit = [&](std::size_t x, int v) {
+                if (x == 0) {
+                    return;
+                }
+                int u = samples[x - 1];
+                ++pairs.pairs;
+                if (u == v) {
+                    ++pairs.z;
+                } else {
+                    bool towards = (v & 1) ? u > v : u < v;
+                    pairs.x += towards;
+                    pairs.y += !towards;
+                    pairs.w += (u >> 1) == (v >> 1);
+                }
+
+                if (interiorRow && x + 1 < width) {
+                    int left = u;
+                    int right = samples[x + 1];
+                    int up = row[x * stride - rowStride];
+                    int down = row[x * stride + rowStride];
+                    double mean = (left + right + up + down) / 4.0;
+                    double variance = (left * left + right * right + up * up + down * down) / 4.0 - mean * mean;
+                    double weight = 1.0 / (5.0 + variance);
+                    ws.weighted += weight * ((v & 1) ? 1.0 : -1.0) * (v - mean);
+                    ws.weights += weight;
+                }
+            };
+
+            std::size_t x = 0;
+            for (; x + 4 <= width; x += 4) {
+                int v0 = samples[x];
+                int v1 = samples[x + 1];
+                int v2 = samples[x + 2];
+                int v3 = samples[x + 3];
+                ++h0[v0];
+                ++h1[v1];
+                ++h2[v2];
+                ++h3[v3];
+                visit(x, v0);
+                visit(x + 1, v1);
+                visit(x + 2, v2);
+                visit(x + 3, v3);
+            }
+            for (; x < width; ++x) {
+                ++h0[samples[x]];
+                visit(x, samples[x]);
+            }
+
+            // Groups of 4 from the left edge, the leftover samples form none
+            Steganalysis::CountRSGroups(samples, width / 4, counts);
+        }
+
+        auto &histogram = stats.histograms[static_cast<std::size_t>(channel)];
+        for (std::size_t value = 0; value < 256; ++value) {
+            histogram[value] = static_cast<uint64_t>(h0[value]) + h1[value] + h2[value] + h3[value];
+        }
+    }
+}
+
+std::string EscapeJson(const std::string &text) {
+    std::ostringstream out;
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        } else {
+            out << c;
+        }
+    }
+    return out.str();
+}
+
+} // namespace
+
+RSCounts &RSCounts::operator+=(const RSCounts &other) {
+    groups += other.groups;
+    regularM += other.regularM;
+    singularM += other.singularM;
+    regularNegM += other.regularNegM;
+    singularNegM += other.singularNegM;
+    flippedRegularM += other.flippedRegularM;
+    flippedSingularM += other.flippedSingularM;
+    flippedRegularNegM += other.flippedRegularNegM;
+    flippedSingularNegM += other.flippedSingularNegM;
+    return *this;
+}
+
+SPACounts &SPACounts::operator+=(const SPACounts &other) {
+    pairs += other.pairs;
+    x += other.x;
+    y += other.y;
+    z += other.z;
+    w += other.w;
+    return *this;
+}
+
+WSSums &WSSums::operator+=(const WSSums &other) {
+    weighted += other.weighted;
+    weights += other.weights;
+    return *this;
+}
+
+void Steganalysis::CountRSGroups(const uint8_t *samples, std::size_t groups, RSCounts &counts) {
+    const CountRSGroupsFn kernel = SelectCountRSGroups();
+    kernel(samples, groups, counts);
+}
+
+double Steganalysis::ChiSquareProbability(const std::array<uint64_t, 256> &histogram) {
+    double chiSquare = 0.0;
+    int categories = 0;
+    for (std::size_t value = 0; value < 256; value += 2) {
+        uint64_t total = histogram[value] + histogram[value + 1];
+        if (total < MIN_PAIR_SAMPLES) {
+            continue;
+        }
+        double expected = static_cast<double>(total) / 2.0;
+        double difference = static_cast<double>(histogram[value]) - expected;
+        chiSquare += difference * difference / expected;
+        ++categories;
+    }
+
+    if (categories < 2) {
+        return 0.0;
+    }
+    return UpperGammaRegularized((categories - 1) / 2.0, chiSquare / 2.0);
+}
+
+double Steganalysis::EstimateRS(const RSCounts &counts) {
+    if (counts.groups == 0) {
+        return 0.0;
+    }
+
+    auto difference = [&](uint64_t regular, uint64_t singular) {
+        return (static_cast<double>(regular) - static_cast<double>(singular)) / static_cast<double>(counts.groups);
+    };
+    double d0 = difference(counts.regularM, counts.singularM);
+    double d1 = difference(counts.flippedRegularM, counts.flippedSingularM);
+    double negD0 = difference(counts.regularNegM, counts.singularNegM);
+    double negD1 = difference(counts.flippedRegularNegM, counts.flippedSingularNegM);
+
+    // 2(d1 + d0) x^2 + (d-0 - d-1 - d1 - 3 d0) x + d0 - d-0 = 0, take the root closest to 0
+    double a = 2.0 * (d1 + d0);
+    double b = negD0 - negD1 - d1 - 3.0 * d0;
+    double c = d0 - negD0;
+
+    double x = 0.0;
+    if (std::fabs(a) < 1e-12) {
+        if (std::fabs(b) < 1e-12) {
+            return 0.0;
+        }
+        x = -c / b;
+    } else {
+        double discriminant = std::max(0.0, b * b - 4.0 * a * c);
+        double root = std::sqrt(discriminant);
+        double x1 = (-b + root) / (2.0 * a);
+        double x2 = (-b - root) / (2.0 * a);
+        x = std::fabs(x1) < std::fabs(x2) ? x1 : x2;
+    }
+
+    if (std::fabs(x - 0.5) < 1e-12) {
+        return 1.0;
+    }
+    return std::clamp(x / (x - 0.5), 0.0, 1.0);
+}
+
+double Steganalysis::EstimateSPA(const SPACounts &counts) {
+    if (counts.pairs == 0) {
+        return 0.0;
+    }
+
+    // (w + z) / 2 p^2 + (2x - P) p + y - x = 0
+    double a = 0.5 * static_cast<double>(counts.w + counts.z);
+    double b = 2.0 * static_cast<double>(counts.x) - static_cast<double>(counts.pairs);
+    double c = static_cast<double>(counts.y) - static_cast<double>(counts.x);
+
+    double p = 0.0;
+    if (a < 1e-12) {
+        if (std::fabs(b) < 1e-12) {
+            return 0.0;
+        }
+        p = -c / b;
+    } else {
+        double discriminant = std::max(0.0, b * b - 4.0 * a * c);
+        p = (-b - std::sqrt(discriminant)) / (2.0 * a);
+    }
+    return std::clamp(p, 0.0, 1.0);
+}
+
+double Steganalysis::EstimateWS(const WSSums &sums) {
+    if (sums.weights <= 0.0) {
+        return 0.0;
+    }
+    return std::clamp(2.0 * sums.weighted / sums.weights, 0.0, 1.0);
+}
+
+Result<ImageAnalysis> Steganalysis::AnalyzeImage(const ImageData &image, bool parallel) {
+
+    if (!image.IsValid() || image.pixels.size() < image.GetPixelCount()) {
+        return Result<ImageAnalysis>(ErrorCode::InvalidImageDimensions, "Cannot analyze an empty or truncated image");
+    }
+
+    // Alpha carries no natural LSB statistics worth testing
+    int analyzed = (image.channels == 2 || image.channels == 4) ? image.channels - 1 : image.channels;
+
+    std::size_t bandCount = static_cast<std::size_t>((image.height + TILE_ROWS - 1) / TILE_ROWS);
+    std::vector<BandStats> bands(bandCount);
+    auto analyzeBand = [&](std::size_t band) {
+        AnalyzeBand(image, analyzed, static_cast<int>(band), bands[band]);
+    };
+    if (parallel) {
+        Parallel::For(bandCount, analyzeBand);
+    } else {
+        for (std::size_t band = 0; band < bandCount; ++band) {
+            analyzeBand(band);
+        }
+    }
+
+    ImageAnalysis report;
+    report.width = image.width;
+    report.height = image.height;
+    report.channels = image.channels;
+
+    for (std::size_t channel = 0; channel < static_cast<std::size_t>(analyzed); ++channel) {
+        ChannelAnalysis scores;
+        std::array<uint64_t, 256> histogram{};
+        RSCounts rs;
+        SPACounts spa;
+        WSSums ws;
+        for (const auto &band : bands) {
+            for (std::size_t value = 0; value < 256; ++value) {
+                histogram[value] += band.histograms[channel][value];
+            }
+            rs += band.rs[channel];
+            spa += band.spa[channel];
+            ws += band.ws[channel];
+        }
+        scores.chiSquare = ChiSquareProbability(histogram);
+        scores.rs = EstimateRS(rs);
+        scores.spa = EstimateSPA(spa);
+        scores.ws = EstimateWS(ws);
+
+        report.chiSquare = std::max(report.chiSquare, scores.chiSquare);
+        report.rs = std::max(report.rs, scores.rs);
+        report.spa = std::max(report.spa, scores.spa);
+        report.ws = std::max(report.ws, scores.ws);
+        report.payloadBytes += static_cast<uint64_t>(scores.ws * image.width * image.height / 8.0);
+        report.channelScores.push_back(scores);
+    }
+
+    double payload = std::max({report.rs, report.spa, report.ws});
+    report.suspicious = report.chiSquare >= CHI_SQUARE_THRESHOLD || payload >= PAYLOAD_THRESHOLD;
+    return Result<ImageAnalysis>(report);
+}
+
+Result<ImageAnalysis> Steganalysis::AnalyzeFile(const std::string &filename, bool parallel) {
+
+    // ImageIO::Load keeps the high byte of 16-bit samples, which would hide the LSB plane entirely
+    if (ImageIO::Is16Bit(filename)) {
+        return Result<ImageAnalysis>(ErrorCode::UnsupportedImageFormat,
+                                     "'" + filename + "': 16-bit images are not supported by the analysis");
+    }
+
+    auto imageResult = ImageIO::Load(filename);
+    if (!imageResult) {
+        return Result<ImageAnalysis>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
+    }
+
+    auto analysis = AnalyzeImage(imageResult.GetValue(), parallel);
+    if (!analysis) {
+        return Result<ImageAnalysis>(analysis.GetErrorCode(), "'" + filename + "': " + analysis.GetErrorMessage());
+    }
+    analysis.GetValue().file = filename;
+    return analysis;
+}
+
+std::vector<ImageAnalysis> Steganalysis::AnalyzeFiles(const std::vector<std::string> &files) {
+
+    std::vector<ImageAnalysis> reports(files.size());
+
+    // A single image spreads its bands instead
+    bool parallelBands = files.size() == 1;
+    auto analyzeFile = [&](std::size_t idx) {
+        auto result = AnalyzeFile(files[idx], parallelBands);
+        if (result) {
+            reports[idx] = std::move(result.GetValue());
+        } else {
+            reports[idx].file = files[idx];
+            reports[idx].error = result.GetErrorMessage();
+        }
+    };
+
+    if (parallelBands) {
+        analyzeFile(0);
+    } else {
+        Parallel::For(files.size(), analyzeFile);
+    }
+    return reports;
+}
+
+Result<std::vector<std::string>> Steganalysis::CollectImages(const std::string &path) {
+
+    std::error_code error;
+    if (fs::is_regular_file(path, error)) {
+        return Result<std::vector<std::string>>(std::vector<std::string>{path});
+    }
+    if (!fs::is_directory(path, error)) {
+        return Result<std::vector<std::string>>(ErrorCode::FileNotFound, "Path not found: '" + path + "'");
+    }
+
+    std::vector<std::string> files;
+    for (fs::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+        if (!it->is_regular_file(error)) {
+            continue;
+        }
+        std::string ext = it->path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        if (ext == ".png" || ext == ".bmp" || ext == ".tga" || ext == ".jpg" || ext == ".jpeg") {
+            files.push_back(it->path().string());
+        }
+    }
+    if (error) {
+        return Result<std::vector<std::string>>(ErrorCode::FileReadError, "Failed to scan '" + path + "': " + error.message());
+    }
+
+    std::sort(files.begin(), files.end());
+    return Result<std::vector<std::string>>(files);
+}
+
+std::string Steganalysis::ToJson(const std::vector<ImageAnalysis> &reports) {
+
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out << std::fixed << std::setprecision(6);
+
+    auto writeScores = [&](const auto &scores) {
+        out << "\"chiSquare\": " << scores.chiSquare
+            << ", \"rs\": " << scores.rs
+            << ", \"spa\": " << scores.spa
+            << ", \"ws\": " << scores.ws;
+    };
+
+    out << "{\n  \"images\": [";
+    for (std::size_t idx = 0; idx < reports.size(); ++idx) {
+        const auto &report = reports[idx];
+        out << (idx == 0 ? "\n" : ",\n") << "    {\"file\": \"" << EscapeJson(report.file) << "\", ";
+        if (!report.error.empty()) {
+            out << "\"error\": \"" << EscapeJson(report.error) << "\"}";
+            continue;
+        }
+
+        out << "\"width\": " << report.width
+            << ", \"height\": " << report.height
+            << ", \"channels\": " << report.channels << ", ";
+        writeScores(report);
+        out << ", \"payloadBytes\": " << report.payloadBytes
+            << ", \"suspicious\": " << (report.suspicious ? "true" : "false")
+            << ", \"channelScores\": [";
+        for (std::size_t channel = 0; channel < report.channelScores.size(); ++channel) {
+            out << (channel == 0 ? "{" : ", {");
+            writeScores(report.channelScores[channel]);
+            out << "}";
+        }
+        out << "]}";
+    }
+    out << (reports.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    return out.str();
+}
@@ -0,0 +1,207 @@
+#ifndef __STEGANALYSIS_H_
+#define __STEGANALYSIS_H_
+
+#include "../utils/ImageIO.h"
+#include "../utils/ErrorHandler.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Regular/singular group counts of one channel for RS analysis.
+ *
+ * Groups are 4 horizontally adjacent samples with mask [0 1 1 0]. Counts are
+ * taken for the mask M (flip LSB) and -M (shifted flip) on the image as is
+ * and on the image with every LSB flipped. All counts are additive over tiles.
+ */
+struct RSCounts {
+    uint64_t groups = 0;
+    uint64_t regularM = 0;
+    uint64_t singularM = 0;
+    uint64_t regularNegM = 0;
+    uint64_t singularNegM = 0;
+    uint64_t flippedRegularM = 0;
+    uint64_t flippedSingularM = 0;
+    uint64_t flippedRegularNegM = 0;
+    uint64_t flippedSingularNegM = 0;
+
+    RSCounts &operator+=(const RSCounts &other);
+};
+
+/**
+ * @brief Sample pair counts of one channel for SPA.
+ *
+ * Pairs are horizontally adjacent samples (u, v). x and y split the pairs with
+ * u != v by whether the LSB of v points towards or away from u; w are the
+ * pairs differing only in the LSB and z the equal pairs.
+ */
+struct SPACounts {
+    uint64_t pairs = 0;
+    uint64_t x = 0;
+    uint64_t y = 0;
+    uint64_t z = 0;
+    uint64_t w = 0;
+
+    SPACounts &operator+=(const SPACounts &other);
+};
+
+/**
+ * @brief Weighted-stego sums of one channel.
+ *
+ * Every interior sample adds w * (s - flip(s)) * (s - prediction), with the
+ * 4-neighbor mean as prediction and w = 1 / (5 + local variance).
+ */
+struct WSSums {
+    double weighted = 0.0;
+    double weights = 0.0;
+
+    WSSums &operator+=(const WSSums &other);
+};
+
+/**
+ * @brief Detection scores of one color channel.
+ *
+ * The RS, SPA and WS estimates are payload sizes in bits per pixel of this
+ * channel (0 = clean, 1 = every LSB carries payload).
+ */
+struct ChannelAnalysis {
+    double chiSquare = 0.0; // probability that LSB pairs were equalized by embedding
+    double rs = 0.0;
+    double spa = 0.0;
+    double ws = 0.0;
+};
+
+/**
+ * @brief Detection report of one image; channel scores are combined by maximum.
+ */
+struct ImageAnalysis {
+    std::string file;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<ChannelAnalysis> channelScores;
+    double chiSquare = 0.0;
+    double rs = 0.0;
+    double spa = 0.0;
+    double ws = 0.0;
+    uint64_t payloadBytes = 0; // WS estimate summed over the analyzed channels
+    bool suspicious = false;
+    std::string error; // set instead of the scores when the file could not be analyzed
+};
+
+/**
+ * @brief Blind LSB steganalysis for screening image corpora.
+ *
+ * Implements the chi-square pair-of-values attack (Westfeld & Pfitzmann), RS
+ * analysis (Fridrich et al.), sample pair analysis (Dumitrescu et al.) and
+ * weighted-stego estimation (Fridrich & Goljan) on 8-bit images. Alpha
+ * channels are skipped. All statistics come from a single pass over row
+ * bands: every band builds unrolled sub-histograms, RS group counts, SPA pair
+ * counts and WS sums independently, so bands run across threads and the
+ * totals are plain sums.
+ */
+class Steganalysis {
+public:
+    Steganalysis() = delete;
+
+    /**
+     * Image rows per band of the analysis pass
+     **/
+    static constexpr int TILE_ROWS = 16;
+
+    /**
+     * Chi-square probability at which a channel is reported as suspicious
+     **/
+    static constexpr double CHI_SQUARE_THRESHOLD = 0.95;
+
+    /**
+     * Payload estimate (bits per pixel, RS, SPA or WS) at which a channel is reported as suspicious
+     **/
+    static constexpr double PAYLOAD_THRESHOLD = 0.1;
+
+    /**
+     * @brief Analyze an image already in memory.
+     *
+     * @param image 8-bit image
+     * @param parallel Spread row bands across threads (disable when the caller
+     *                 already runs one image per thread)
+     * @return Report without file name, or error if the image is invalid
+     */
+    static Result<ImageAnalysis> AnalyzeImage(const ImageData &image, bool parallel = true);
+
+    /**
+     * @brief Load and analyze one image file.
+     *
+     * 16-bit PNGs fail with UnsupportedImageFormat: the detectors model 8-bit
+     * samples, and the LSB of a 16-bit sample is not in their high byte.
+     */
+    static Result<ImageAnalysis> AnalyzeFile(const std::string &filename, bool parallel = true);
+
+    /**
+     * @brief Analyze many files, one image per thread.
+     *
+     * Files that fail to load are reported with their error set; the
+     * order of the reports follows the input.
+     */
+    static std::vector<ImageAnalysis> AnalyzeFiles(const std::vector<std::string> &files);
+
+    /**
+     * @brief Expand a path to the image files to analyze.
+     *
+     * A regular file is returned as is; a directory is searched recursively
+     * for PNG, BMP, TGA and JPEG files, sorted by path.
+     */
+    static Result<std::vector<std::string>> CollectImages(const std::string &path);
+
+    /**
+     * @brief Chi-square pair-of-values probability of a sample histogram.
+     *
+     * Pairs (2k, 2k+1) with fewer than 10 samples are left out, the test is
+     * not reliable for them.
+     *
+     * @return p in [0, 1]; close to 1 when every pair is evenly populated
+     */
+    static double ChiSquareProbability(const std::array<uint64_t, 256> &histogram);
+
+    /**
+     * @brief Add the RS counts of consecutive groups of 4 samples.
+     *
+     * Uses SSSE3 or AVX2 when the CPU has them, scalar code otherwise.
+     *
+     * @param samples groups * 4 samples of one channel
+     * @param groups Number of groups
+     * @param counts Counts to add to, including 'groups'
+     */
+    static void CountRSGroups(const uint8_t *samples, std::size_t groups, RSCounts &counts);
+
+    /**
+     * @brief Solve the RS quadratic for the embedding rate.
+     *
+     * @return Estimated fraction of samples carrying payload, clamped to [0, 1]
+     */
+    static double EstimateRS(const RSCounts &counts);
+
+    /**
+     * @brief Solve the SPA quadratic for the embedding rate (smaller root).
+     *
+     * @return Estimated fraction of samples carrying payload, clamped to [0, 1]
+     */
+    static double EstimateSPA(const SPACounts &counts);
+
+    /**
+     * @brief Weighted-stego embedding rate from the accumulated sums.
+     *
+     * @return Estimated fraction of samples carrying payload, clamped to [0, 1]
+     */
+    static double EstimateWS(const WSSums &sums);
+
+    /**
+     * @brief Serialize reports as a JSON document {"images": [...]}.
+     */
+    static std::string ToJson(const std::vector<ImageAnalysis> &reports);
+};
+
+#endif // __STEGANALYSIS_H_
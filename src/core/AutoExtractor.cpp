@@ -0,0 +1,225 @@
+#include "AutoExtractor.h"
+#include "../algorithms/lsb/LSBStegoHandler.h"
+#include "../utils/ImageIO.h"
+#include "../utils/Parallel.h"
+#include "../utils/TraceRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::size_t NO_WINNER = static_cast<std::size_t>(-1);
+
+Result<> WriteOutput(const std::string &outputFile, const std::vector<uint8_t> &data) {
+    std::ofstream outFile(outputFile, std::ios::binary);
+    if (!outFile) {
+        return Result<>(
+            ErrorCode::FileWriteError,
+            "Failed to open output file '" + outputFile + "' for writing"
+        );
+    }
+
+    outFile.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!outFile) {
+        // Leave no partial plaintext behind
+        outFile.close();
+        std::error_code ignored;
+        fs::remove(outputFile, ignored);
+        return Result<>(
+            ErrorCode::FileWriteError,
+            "Failed to write data to '" + outputFile + "'"
+        );
+    }
+    return Result<>();
+}
+
+} // namespace
+
+Result<std::size_t> AutoExtractor::Extract(const std::string &stegoFile,
+                                           const std::string &outputFile,
+                                           const std::string &password,
+                                           const std::vector<Candidate> &candidates) {
+
+    if (candidates.empty()) {
+        return Result<std::size_t>(ErrorCode::InvalidArgument, "No extraction methods to try");
+    }
+
+    // Decode the image once for every pixel-domain candidate
+    bool needsPixels = false;
+    for (const auto &candidate : candidates) {
+        needsPixels |= dynamic_cast<LSBStegoHandler *>(candidate.handler.get()) != nullptr;
+    }
+
+    std::optional<ImageData> image;
+    std::optional<ImageData16> image16;
+    Result<> loadResult;
+    if (needsPixels) {
+        if (ImageIO::Is16Bit(stegoFile)) {
+            auto imageResult = ImageIO::Load16(stegoFile);
+            if (imageResult) {
+                image16 = std::move(imageResult.GetValue());
+            } else {
+                loadResult = Result<>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
+            }
+        } else {
+            auto imageResult = ImageIO::Load(stegoFile);
+            if (imageResult) {
+                image = std::move(imageResult.GetValue());
+            } else {
+                loadResult = Result<>(imageResult.GetErrorCode(), imageResult.GetErrorMessage());
+            }
+        }
+    }
+
+    std::atomic<bool> cancel{false};
+    std::atomic<std::size_t> winner{NO_WINNER};
+    std::vector<Result<>> results(candidates.size());
+    std::vector<uint8_t> winnerData;
+
+    // The first verified payload claims the output and cancels everyone else
+    auto claim = [&](std::size_t idx) {
+        std::size_t expected = NO_WINNER;
+        if (!winner.compare_exchange_strong(expected, idx)) {
+            return false;
+        }
+        cancel = true;
+        return true;
+    };
+
+    auto tempName = [&](std::size_t idx) {
+        return outputFile + "." + candidates[idx].name + ".tmp";
+    };
+
+    auto extract = [&](std::size_t idx) {
+        TraceSpan span("candidate", "autoExtract");
+        StegoHandler *handler = candidates[idx].handler.get();
+        auto *lsbHandler = dynamic_cast<LSBStegoHandler *>(handler);
+
+        if (lsbHandler == nullptr) {
+            auto extractResult = handler->Extract(stegoFile, tempName(idx), password);
+            if (!extractResult || !claim(idx)) {
+                std::error_code ignored;
+                fs::remove(tempName(idx), ignored);
+            }
+            results[idx] = extractResult;
+            return;
+        }
+
+        if (!loadResult) {
+            results[idx] = loadResult;
+            return;
+        }
+        auto extractResult = image16 ? lsbHandler->ExtractMethod(*image16, password)
+                                     : lsbHandler->ExtractMethod(*image, password);
+        if (!extractResult) {
+            results[idx] = Result<>(extractResult.GetErrorCode(), extractResult.GetErrorMessage());
+            return;
+        }
+        if (cancel) {
+            results[idx] = Result<>(ErrorCode::OperationCancelled, "Extraction cancelled");
+            return;
+        }
+
+        // HMAC verification decides whether this candidate found the payload
+        auto decryptResult = handler->DecryptPayload(extractResult.GetValue(), password);
+        if (!decryptResult) {
+            results[idx] = Result<>(decryptResult.GetErrorCode(), "Decryption failed: " + decryptResult.GetErrorMessage());
+            return;
+        }
+        if (claim(idx)) {
+            winnerData = std::move(decryptResult.GetValue());
+        }
+    };
+
+    // Candidates split the caller's threads, so the Parallel::For loops inside the
+    // handlers add up to the machine instead of each one taking every core
+    const std::size_t threadCount = Parallel::GetThreadCount();
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto run = [&](std::size_t idx) {
+        std::size_t share = threadCount / candidates.size() + (idx < threadCount % candidates.size() ? 1 : 0);
+        Parallel::ScopedThreadBudget budget(static_cast<unsigned>(std::max<std::size_t>(share, 1)));
+        try {
+            extract(idx);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            cancel = true;
+        }
+    };
+
+    for (const auto &candidate : candidates) {
+        candidate.handler->SetCancelFlag(&cancel);
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(candidates.size() - 1);
+    for (std::size_t idx = 1; idx < candidates.size(); ++idx) {
+        threads.emplace_back(run, idx);
+    }
+    run(0);
+    {
+        TraceSpan wait("join", "wait");
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    for (const auto &candidate : candidates) {
+        candidate.handler->SetCancelFlag(nullptr);
+    }
+
+    // A candidate that threw is rethrown here, after a file-level winner's output is gone
+    std::size_t winnerIdx = winner;
+    if (error) {
+        if (winnerIdx != NO_WINNER && dynamic_cast<LSBStegoHandler *>(candidates[winnerIdx].handler.get()) == nullptr) {
+            std::error_code ignored;
+            fs::remove(tempName(winnerIdx), ignored);
+        }
+        std::rethrow_exception(error);
+    }
+
+    if (winnerIdx == NO_WINNER) {
+        std::ostringstream oss;
+        oss << "No method could extract data from '" << stegoFile << "'";
+        for (std::size_t idx = 0; idx < candidates.size(); ++idx) {
+            oss << "\n  " << candidates[idx].name << ": " << results[idx].GetErrorMessage();
+        }
+        return Result<std::size_t>(ErrorCode::ExtractionFailed, oss.str());
+    }
+
+    // File-level winners wrote a temporary output, pixel-domain ones hold the data
+    if (dynamic_cast<LSBStegoHandler *>(candidates[winnerIdx].handler.get()) == nullptr) {
+        std::error_code renameError;
+        fs::remove(outputFile, renameError);
+        fs::rename(tempName(winnerIdx), outputFile, renameError);
+        if (renameError) {
+            // The temporary output holds the decrypted data, never leave it behind
+            std::error_code ignored;
+            fs::remove(tempName(winnerIdx), ignored);
+            return Result<std::size_t>(
+                ErrorCode::FileWriteError,
+                "Failed to write '" + outputFile + "': " + renameError.message()
+            );
+        }
+    } else {
+        auto writeResult = WriteOutput(outputFile, winnerData);
+        if (!writeResult) {
+            return Result<std::size_t>(writeResult.GetErrorCode(), writeResult.GetErrorMessage());
+        }
+    }
+
+    return Result<std::size_t>(winnerIdx);
+}
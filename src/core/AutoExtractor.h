@@ -0,0 +1,44 @@
+#ifndef __AUTO_EXTRACTOR_H_
+#define __AUTO_EXTRACTOR_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "../algorithms/StegoHandler.h"
+
+/**
+ * @brief Extraction that tries several steganography methods at once.
+ *
+ * Every candidate runs on its own thread, with an even share of the caller's
+ * Parallel threads for its own loops. Pixel-domain (LSB) candidates share
+ * one decoded copy of the image; the others extract from the file into a
+ * temporary output. The first candidate whose payload passes the size header
+ * checks and decrypts with a valid HMAC wins, and the rest are cancelled.
+ */
+class AutoExtractor {
+public:
+    AutoExtractor() = delete;
+
+    struct Candidate {
+        std::string name;
+        std::unique_ptr<StegoHandler> handler;
+    };
+
+    /**
+     * @brief Extract with whichever candidate recognizes the stego file.
+     *
+     * @param stegoFile Path to the stego file
+     * @param outputFile Path to save the recovered file
+     * @param password Password used for AES decryption
+     * @param candidates Methods to try
+     * @return Index of the winning candidate, or ExtractionFailed listing every
+     *         candidate's error. An exception thrown by a candidate is rethrown
+     *         once every candidate has stopped.
+     */
+    static Result<std::size_t> Extract(const std::string &stegoFile,
+                                       const std::string &outputFile,
+                                       const std::string &password,
+                                       const std::vector<Candidate> &candidates);
+};
+
+#endif // __AUTO_EXTRACTOR_H_
@@ -1,13 +1,59 @@
 #include "CLI.h"
 #include "../algorithms/lsb/ordered/LSBStegoHandlerOrdered.h"
 #include "../algorithms/lsb/shuffle/LSBStegoHandlerShuffle.h"
+#include "../algorithms/lsb/tiled/LSBStegoHandlerTiled.h"
+#include "../algorithms/lsb/matching/LSBStegoHandlerMatching.h"
+#include "../algorithms/lsb/hamming/LSBStegoHandlerHamming.h"
+#include "../algorithms/lsb/adaptive/LSBStegoHandlerAdaptive.h"
+#include "../algorithms/dct/DCTStegoHandler.h"
+#include "../algorithms/wav/WAVStegoHandler.h"
+#include "../algorithms/frames/apng/APNGStegoHandler.h"
+#include "../algorithms/frames/y4m/Y4MStegoHandler.h"
+#include "../analysis/Steganalysis.h"
+#include "../utils/Stats.h"
+#include "../utils/TraceRecorder.h"
+#include "AutoExtractor.h"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
 #include <memory>
 #include <cctype>
+#include <cstdint>
 
+namespace {
+
+/**
+ * Parse a byte count such as 512M: digits with an optional K, M or G suffix (powers of 1024)
+ */
+bool ParseByteSize(const std::string &text, std::size_t &bytes) {
+    std::size_t digits = 0;
+    while (digits < text.size() && std::isdigit(static_cast<unsigned char>(text[digits]))) {
+        ++digits;
+    }
+    if (digits == 0 || digits > 12 || text.size() - digits > 1) {
+        return false;
+    }
+
+    unsigned shift = 0;
+    if (digits < text.size()) {
+        switch (std::toupper(static_cast<unsigned char>(text[digits]))) {
+        case 'K': shift = 10; break;
+        case 'M': shift = 20; break;
+        case 'G': shift = 30; break;
+        default: return false;
+        }
+    }
+    // Twelve digits fit in 64 bits, but the shifted value may not fit in size_t
+    unsigned long long value = std::stoull(text.substr(0, digits));
+    if (value == 0 || value > (SIZE_MAX >> shift)) {
+        return false;
+    }
+    bytes = static_cast<std::size_t>(value) << shift;
+    return true;
+}
+
+} // namespace
 
 int CLI::Run(int argc, char *argv[]) {
     try {
@@ -37,20 +83,29 @@ int CLI::Run(int argc, char *argv[]) {
         }
 
         std::string command = argv[1];
+        Stats::SetEnabled(parsedOptions.count("stats") || parsedOptions.count("stats-json"));
+        if (parsedOptions.count("trace")) {
+            TraceRecorder::Start();
+        }
 
         // Handle embed command
         if (command == "embed") {
-            return HandleEmbedCommand(parsedOptions);
+            return ReportInstrumentation(HandleEmbedCommand(parsedOptions), parsedOptions);
         }
 
         // Handle extract command
         else if (command == "extract") {
-            return HandleExtractCommand(parsedOptions);
+            return ReportInstrumentation(HandleExtractCommand(parsedOptions), parsedOptions);
         }
 
         //Handle visualize command
         else if (command == "visual") {
-            return HandleVisualCommand(parsedOptions);
+            return ReportInstrumentation(HandleVisualCommand(parsedOptions), parsedOptions);
+        }
+
+        //Handle analyze command
+        else if (command == "analyze") {
+            return HandleAnalyzeCommand(parsedOptions);
         }
         
         else {
@@ -78,18 +133,6 @@ int CLI::HandleEmbedCommand(const cxxopts::ParseResult& parsedOptions) {
         return 1;
     }
     
-    std::string outputFile = "";
-    if (!parsedOptions.count("output")){
-
-        outputFile = DEFAULT_IMAGE_NAME;
-        std::cout << "Missing output file arguments for 'embed' command.\n";
-        std::cout << "Using following name:  " << outputFile << " \n\n";
-
-    } else {
-        
-        outputFile = parsedOptions["output"].as<std::string>();
-    }
-
     StegoMethod stegoMethod;
     if (!parsedOptions.count("method")){
 
@@ -100,6 +143,27 @@ int CLI::HandleEmbedCommand(const cxxopts::ParseResult& parsedOptions) {
 
         stegoMethod = ParseStegoMethod(parsedOptions["method"].as<std::string>());
     }
+
+    std::string outputFile = "";
+    if (!parsedOptions.count("output")){
+
+        // DCT, WAV and Y4M methods write their own container format
+        if (stegoMethod == StegoMethod::DCT) {
+            outputFile = DEFAULT_JPEG_IMAGE_NAME;
+        } else if (stegoMethod == StegoMethod::WAV) {
+            outputFile = DEFAULT_WAV_NAME;
+        } else if (stegoMethod == StegoMethod::Y4M) {
+            outputFile = DEFAULT_Y4M_NAME;
+        } else {
+            outputFile = DEFAULT_IMAGE_NAME;
+        }
+        std::cout << "Missing output file arguments for 'embed' command.\n";
+        std::cout << "Using following name:  " << outputFile << " \n\n";
+
+    } else {
+        
+        outputFile = parsedOptions["output"].as<std::string>();
+    }
      
     std::string inputFile = parsedOptions["input"].as<std::string>();
     std::string dataFile = parsedOptions["data"].as<std::string>();
@@ -125,6 +189,18 @@ int CLI::HandleEmbedCommand(const cxxopts::ParseResult& parsedOptions) {
     std::cout << "  Output file: " << outputFile << "\n";
 
     std::unique_ptr<StegoHandler> handler = ChooseHandlerMethod(stegoMethod);
+    if (!ConfigureEmbeddingMask(handler.get(), parsedOptions)) {
+        return 1;
+    }
+    handler->SetKeyCheck(parsedOptions.count("key-check") > 0);
+    handler->SetCompression(parsedOptions.count("compress") > 0);
+    if (!ConfigureErrorCorrection(handler.get(), parsedOptions)) {
+        return 1;
+    }
+    ConfigurePermutationCache(handler.get(), parsedOptions);
+    if (!ConfigureMemoryLimit(handler.get(), parsedOptions)) {
+        return 1;
+    }
     
     auto embedResult = handler->Embed(inputFile, dataFile, outputFile, password);
     if (!embedResult) {
@@ -194,6 +270,20 @@ int CLI::HandleVisualCommand(const cxxopts::ParseResult& parsedOptions) {
     std::cout << "  Output file: " << outputFile << "\n";
 
     std::unique_ptr<StegoHandler> handler = ChooseHandlerMethod(stegoMethod);
+    if (!ConfigureEmbeddingMask(handler.get(), parsedOptions)) {
+        return 1;
+    }
+    handler->SetKeyCheck(parsedOptions.count("key-check") > 0);
+    handler->SetCompression(parsedOptions.count("compress") > 0);
+    if (!ConfigureErrorCorrection(handler.get(), parsedOptions)) {
+        return 1;
+    }
+    if (!ConfigureMemoryLimit(handler.get(), parsedOptions)) {
+        return 1;
+    }
+    if (!ConfigureVisualOutput(handler.get(), parsedOptions)) {
+        return 1;
+    }
     
     auto visualResult = handler->Visual(inputFile, dataFile, outputFile, password);
     if (!visualResult) {
@@ -225,13 +315,12 @@ int CLI::HandleExtractCommand(const cxxopts::ParseResult& parsedOptions) {
         outputFile = parsedOptions["output"].as<std::string>();
     }
 
-    // Handle lack of method selection
-    StegoMethod stegoMethod;
-    if (!parsedOptions.count("method")) {
-        stegoMethod = StegoMethod::LSB;
-    } else { 
-        stegoMethod = ParseStegoMethod(parsedOptions["method"].as<std::string>());
-    }
+    // Handle lack of method selection: detect it
+    std::string methodName = parsedOptions.count("method") ? parsedOptions["method"].as<std::string>() : AUTO_METHOD;
+    std::transform(methodName.begin(), methodName.end(), methodName.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    bool autoDetect = methodName == AUTO_METHOD;
+    StegoMethod stegoMethod = autoDetect ? StegoMethod::LSB : ParseStegoMethod(methodName);
 
     std::string inputFile = parsedOptions["input"].as<std::string>();
     std::string password = "";
@@ -251,10 +340,22 @@ int CLI::HandleExtractCommand(const cxxopts::ParseResult& parsedOptions) {
 
     std::cout << "\nExtracting data...\n";
     std::cout << "  Stego image: " << inputFile << "\n";
-    std::cout << "  Method: " << stegoMethod << " - " << StegoMethodToString(stegoMethod) << "\n";
+    if (autoDetect) {
+        std::cout << "  Method: " << AUTO_METHOD << "\n";
+    } else {
+        std::cout << "  Method: " << stegoMethod << " - " << StegoMethodToString(stegoMethod) << "\n";
+    }
     std::cout << "  Output file: " << outputFile << "\n";
 
+    if (autoDetect) {
+        return HandleAutoExtract(inputFile, outputFile, password, parsedOptions);
+    }
+
     std::unique_ptr<StegoHandler> handler = ChooseHandlerMethod(stegoMethod);
+    if (!ConfigureEmbeddingMask(handler.get(), parsedOptions)) {
+        return 1;
+    }
+    ConfigurePermutationCache(handler.get(), parsedOptions);
     
     auto extractResult = handler->Extract(inputFile, outputFile, password);
     if (!extractResult) {
@@ -267,6 +368,270 @@ int CLI::HandleExtractCommand(const cxxopts::ParseResult& parsedOptions) {
     return 0;
 }
 
+int CLI::HandleAutoExtract(const std::string& inputFile, const std::string& outputFile,
+                           const std::string& password, const cxxopts::ParseResult& parsedOptions) {
+
+    bool hasMask = parsedOptions.count("channels") || parsedOptions.count("bit-plane") || parsedOptions.count("bit-count");
+
+    std::vector<AutoExtractor::Candidate> candidates;
+    for (StegoMethod method : DetectCandidateMethods(inputFile)) {
+        auto handler = ChooseHandlerMethod(method);
+        auto *lsbHandler = dynamic_cast<LSBStegoHandler *>(handler.get());
+
+        // A mask only makes sense for LSB methods, which all share it
+        if (hasMask) {
+            if (lsbHandler == nullptr) {
+                continue;
+            }
+            if (candidates.empty()) {
+                if (!ConfigureEmbeddingMask(lsbHandler, parsedOptions)) {
+                    return 1;
+                }
+            } else {
+                auto *first = static_cast<LSBStegoHandler *>(candidates.front().handler.get());
+                lsbHandler->SetEmbeddingMask(first->GetEmbeddingMask());
+            }
+        }
+        ConfigurePermutationCache(handler.get(), parsedOptions);
+        candidates.push_back({StegoMethodToString(method), std::move(handler)});
+    }
+
+    auto extractResult = AutoExtractor::Extract(inputFile, outputFile, password, candidates);
+    if (!extractResult) {
+        std::cerr << "\nExtraction Failed\n";
+        std::cerr << "Error: " << extractResult.GetErrorMessage() << "\n";
+        return 1;
+    }
+
+    std::cout << "\nDetected method: " << candidates[extractResult.GetValue()].name << "\n";
+    std::cout << "Data extracted successfully to " << outputFile << "\n";
+    return 0;
+}
+
+std::vector<StegoMethod> CLI::DetectCandidateMethods(const std::string& inputFile) {
+
+    // Container signature decides which methods can apply
+    char magic[12] = {};
+    std::ifstream in(inputFile, std::ios::binary);
+    in.read(magic, sizeof(magic));
+    std::string signature(magic, static_cast<std::size_t>(in.gcount()));
+
+    if (signature.rfind("\xFF\xD8", 0) == 0) {
+        return {StegoMethod::DCT};
+    }
+    if (signature.size() == sizeof(magic) && signature.rfind("RIFF", 0) == 0 && signature.compare(8, 4, "WAVE") == 0) {
+        return {StegoMethod::WAV};
+    }
+    if (signature.rfind("YUV4MPEG2", 0) == 0) {
+        return {StegoMethod::Y4M};
+    }
+
+    // lsbmatch shares the ordered layout, the lsb candidate covers it
+    std::vector<StegoMethod> methods = {
+        StegoMethod::LSB,
+        StegoMethod::LSBShuffle,
+        StegoMethod::LSBHamming,
+        StegoMethod::LSBAdaptive,
+        StegoMethod::LSBTiled
+    };
+    if (signature.rfind("\x89PNG", 0) == 0) {
+        methods.push_back(StegoMethod::APNG);
+    }
+    return methods;
+}
+
+int CLI::HandleAnalyzeCommand(const cxxopts::ParseResult& parsedOptions) {
+
+    if (!parsedOptions.count("input")) {
+        std::cerr << "Error: Missing required arguments for 'analyze' command.\n\n";
+        PrintAnalyzeUsage();
+        return 1;
+    }
+
+    std::string inputPath = parsedOptions["input"].as<std::string>();
+    auto filesResult = Steganalysis::CollectImages(inputPath);
+    if (!filesResult) {
+        std::cerr << "Error: " << filesResult.GetErrorMessage() << "\n";
+        return 1;
+    }
+
+    auto reports = Steganalysis::AnalyzeFiles(filesResult.GetValue());
+    std::string json = Steganalysis::ToJson(reports);
+
+    std::size_t suspicious = 0;
+    std::size_t failed = 0;
+    for (const auto &report : reports) {
+        if (!report.error.empty()) {
+            ++failed;
+        } else if (report.suspicious) {
+            ++suspicious;
+        }
+    }
+
+    // Without an output file the report goes to stdout, so it can be piped
+    if (!parsedOptions.count("output")) {
+        std::cout << json;
+        if (failed > 0) {
+            std::cerr << "Error: " << failed << " of " << reports.size() << " image(s) could not be analyzed\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    std::string outputFile = parsedOptions["output"].as<std::string>();
+    std::ofstream out(outputFile, std::ios::binary);
+    if (!out || !out.write(json.data(), static_cast<std::streamsize>(json.size()))) {
+        std::cerr << "Error: Failed to write report to " << outputFile << "\n";
+        return 1;
+    }
+
+    std::cout << "Analyzed " << reports.size() - failed << " image(s): "
+              << suspicious << " suspicious, " << failed << " failed to load\n";
+    std::cout << "Report written to " << outputFile << "\n";
+    return failed > 0 ? 1 : 0;
+}
+
+bool CLI::ConfigureEmbeddingMask(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions) {
+
+    if (!parsedOptions.count("channels") && !parsedOptions.count("bit-plane") && !parsedOptions.count("bit-count")) {
+        return true;
+    }
+
+    auto *lsbHandler = dynamic_cast<LSBStegoHandler *>(handler);
+    if (lsbHandler == nullptr) {
+        std::cerr << "Error: --channels, --bit-plane and --bit-count are only supported by LSB-based methods\n";
+        return false;
+    }
+
+    std::string channels = parsedOptions.count("channels") ? parsedOptions["channels"].as<std::string>() : "rgba";
+    int bitPlane = parsedOptions.count("bit-plane") ? parsedOptions["bit-plane"].as<int>() : 0;
+    int bitCount = parsedOptions.count("bit-count") ? parsedOptions["bit-count"].as<int>() : 1;
+
+    auto maskResult = EmbeddingMask::Parse(channels, bitPlane, bitCount);
+    if (!maskResult) {
+        std::cerr << "Error: " << maskResult.GetErrorMessage() << "\n";
+        return false;
+    }
+
+    lsbHandler->SetEmbeddingMask(maskResult.GetValue());
+    std::cout << "  Channels: " << channels << ", bit planes: " << bitPlane << " to " << (bitPlane + bitCount - 1) << "\n";
+    return true;
+}
+
+void CLI::ConfigurePermutationCache(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions) {
+
+    auto *shuffleHandler = dynamic_cast<LSBStegoHandlerShuffle *>(handler);
+    if (shuffleHandler == nullptr || !parsedOptions.count("perm-cache")) {
+        return;
+    }
+
+    shuffleHandler->SetPermutationCache(std::make_shared<PermutationCache>(
+        PermutationCache::DEFAULT_MAX_BYTES, parsedOptions["perm-cache"].as<std::string>()));
+}
+
+bool CLI::ConfigureVisualOutput(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions) {
+
+    if (!parsedOptions.count("mode") && !parsedOptions.count("downscale")) {
+        return true;
+    }
+
+    auto *lsbHandler = dynamic_cast<LSBStegoHandler *>(handler);
+    if (lsbHandler == nullptr) {
+        std::cerr << "Error: --mode and --downscale are only supported by LSB-based methods\n";
+        return false;
+    }
+
+    std::string mode = parsedOptions.count("mode") ? parsedOptions["mode"].as<std::string>() : "map";
+    if (mode == "map") {
+        lsbHandler->SetVisualMode(LSBStegoHandler::VisualMode::Map);
+    } else if (mode == "diff") {
+        lsbHandler->SetVisualMode(LSBStegoHandler::VisualMode::Diff);
+    } else if (mode == "heatmap") {
+        lsbHandler->SetVisualMode(LSBStegoHandler::VisualMode::Heatmap);
+    } else {
+        std::cerr << "Error: Invalid visual mode '" << mode << "' (use map, diff or heatmap)\n";
+        return false;
+    }
+
+    // A heatmap of single pixels says nothing, its blocks default to 16 x 16
+    int scale = mode == "heatmap" ? DEFAULT_HEATMAP_BLOCK : 1;
+    if (parsedOptions.count("downscale")) {
+        scale = parsedOptions["downscale"].as<int>();
+    }
+    if (scale < 1) {
+        std::cerr << "Error: --downscale must be at least 1\n";
+        return false;
+    }
+
+    lsbHandler->SetVisualScale(scale);
+    std::cout << "  Visual mode: " << mode << ", block: " << scale << "x" << scale << "\n";
+    return true;
+}
+
+int CLI::ReportInstrumentation(int status, const cxxopts::ParseResult& parsedOptions) {
+
+    if (parsedOptions.count("stats")) {
+        std::cout << "\nStage statistics:\n" << Stats::FormatTable();
+    }
+
+    if (parsedOptions.count("stats-json")) {
+        std::string statsFile = parsedOptions["stats-json"].as<std::string>();
+        std::string json = Stats::FormatJson();
+        std::ofstream out(statsFile, std::ios::binary);
+        if (!out || !out.write(json.data(), static_cast<std::streamsize>(json.size()))) {
+            std::cerr << "Error: Failed to write statistics to " << statsFile << "\n";
+            return status != 0 ? status : 1;
+        }
+    }
+
+    if (parsedOptions.count("trace")) {
+        TraceRecorder::Stop();
+        auto saveResult = TraceRecorder::Save(parsedOptions["trace"].as<std::string>());
+        if (!saveResult) {
+            std::cerr << "Error: " << saveResult.GetErrorMessage() << "\n";
+            return status != 0 ? status : 1;
+        }
+    }
+    return status;
+}
+
+bool CLI::ConfigureErrorCorrection(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions) {
+    if (!parsedOptions.count("ecc")) {
+        return true;
+    }
+
+    auto result = handler->SetErrorCorrection(parsedOptions["ecc"].as<int>());
+    if (!result) {
+        std::cerr << "Error: " << result.GetErrorMessage() << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool CLI::ConfigureMemoryLimit(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions) {
+
+    if (!parsedOptions.count("max-memory")) {
+        return true;
+    }
+
+    // Other methods load their covers their own way and ignore the limit
+    if (dynamic_cast<LSBStegoHandler *>(handler) == nullptr) {
+        std::cerr << "Error: --max-memory is only supported by LSB-based methods\n";
+        return false;
+    }
+
+    std::size_t bytes = 0;
+    std::string limit = parsedOptions["max-memory"].as<std::string>();
+    if (!ParseByteSize(limit, bytes)) {
+        std::cerr << "Error: Invalid memory limit '" << limit << "', expected e.g. 512M or 2G\n";
+        return false;
+    }
+
+    handler->SetMemoryLimit(bytes);
+    std::cout << "  Memory limit: " << limit << "\n";
+    return true;
+}
+
 std::unique_ptr<StegoHandler> CLI::ChooseHandlerMethod(StegoMethod method){
     switch (method)
     {
@@ -275,6 +640,30 @@ std::unique_ptr<StegoHandler> CLI::ChooseHandlerMethod(StegoMethod method){
 
     case StegoMethod::LSBShuffle:
         return std::make_unique<LSBStegoHandlerShuffle>();
+
+    case StegoMethod::LSBMatching:
+        return std::make_unique<LSBStegoHandlerMatching>();
+
+    case StegoMethod::LSBHamming:
+        return std::make_unique<LSBStegoHandlerHamming>();
+
+    case StegoMethod::DCT:
+        return std::make_unique<DCTStegoHandler>();
+
+    case StegoMethod::LSBAdaptive:
+        return std::make_unique<LSBStegoHandlerAdaptive>();
+
+    case StegoMethod::WAV:
+        return std::make_unique<WAVStegoHandler>();
+
+    case StegoMethod::APNG:
+        return std::make_unique<APNGStegoHandler>();
+
+    case StegoMethod::Y4M:
+        return std::make_unique<Y4MStegoHandler>();
+
+    case StegoMethod::LSBTiled:
+        return std::make_unique<LSBStegoHandlerTiled>();
     
     default:
         return std::make_unique<LSBStegoHandlerOrdered>();
@@ -288,6 +677,22 @@ std::string CLI::StegoMethodToString(StegoMethod method){
         return LSB_METHOD;
     case StegoMethod::LSBShuffle:
         return LSB_SHUFFLE_METHOD;
+    case StegoMethod::LSBMatching:
+        return LSB_MATCHING_METHOD;
+    case StegoMethod::LSBHamming:
+        return LSB_HAMMING_METHOD;
+    case StegoMethod::DCT:
+        return DCT_METHOD;
+    case StegoMethod::LSBAdaptive:
+        return LSB_ADAPTIVE_METHOD;
+    case StegoMethod::WAV:
+        return WAV_METHOD;
+    case StegoMethod::APNG:
+        return APNG_METHOD;
+    case StegoMethod::Y4M:
+        return Y4M_METHOD;
+    case StegoMethod::LSBTiled:
+        return LSB_TILED_METHOD;
     default:
         return LSB_METHOD;
     }
@@ -317,6 +722,22 @@ StegoMethod CLI::ParseStegoMethod(const std::string& encodingMethod){
             return StegoMethod::LSB;
         } else if (methodNum == StegoMethod::LSBShuffle) {
             return StegoMethod::LSBShuffle;
+        } else if (methodNum == StegoMethod::LSBMatching) {
+            return StegoMethod::LSBMatching;
+        } else if (methodNum == StegoMethod::LSBHamming) {
+            return StegoMethod::LSBHamming;
+        } else if (methodNum == StegoMethod::DCT) {
+            return StegoMethod::DCT;
+        } else if (methodNum == StegoMethod::LSBAdaptive) {
+            return StegoMethod::LSBAdaptive;
+        } else if (methodNum == StegoMethod::WAV) {
+            return StegoMethod::WAV;
+        } else if (methodNum == StegoMethod::APNG) {
+            return StegoMethod::APNG;
+        } else if (methodNum == StegoMethod::Y4M) {
+            return StegoMethod::Y4M;
+        } else if (methodNum == StegoMethod::LSBTiled) {
+            return StegoMethod::LSBTiled;
         } else {
             std::cout << "\nInvalid steganography method: \"" << encodingMethod << "\"\n";
             std::cout << "Steganography method selection defaulted to: \"" << LSB_METHOD << "\"\n\n";
@@ -333,6 +754,22 @@ StegoMethod CLI::ParseStegoMethod(const std::string& encodingMethod){
         return StegoMethod::LSB;
     } else if (commandMethod == LSB_SHUFFLE_METHOD) { 
         return StegoMethod::LSBShuffle;
+    } else if (commandMethod == LSB_MATCHING_METHOD) { 
+        return StegoMethod::LSBMatching;
+    } else if (commandMethod == LSB_HAMMING_METHOD) { 
+        return StegoMethod::LSBHamming;
+    } else if (commandMethod == DCT_METHOD) { 
+        return StegoMethod::DCT;
+    } else if (commandMethod == LSB_ADAPTIVE_METHOD) { 
+        return StegoMethod::LSBAdaptive;
+    } else if (commandMethod == WAV_METHOD) { 
+        return StegoMethod::WAV;
+    } else if (commandMethod == APNG_METHOD) { 
+        return StegoMethod::APNG;
+    } else if (commandMethod == Y4M_METHOD) { 
+        return StegoMethod::Y4M;
+    } else if (commandMethod == LSB_TILED_METHOD) { 
+        return StegoMethod::LSBTiled;
     } else {
         std::cout << "\nInvalid steganography method: \"" << encodingMethod << "\"\n";
         std::cout << "Steganography method selection defaulted to: \"" << LSB_METHOD << "\"\n\n";
@@ -348,7 +785,10 @@ cxxopts::Options CLI::BuildCxxOptions()
     // Add global options
     options.add_options()
         ("h,help", "Display this help message")
-        ("v,version", "Display version information");
+        ("v,version", "Display version information")
+        ("stats", "Print time, bytes and counters per stage after embed, extract or visual")
+        ("stats-json", "Write the stage statistics as JSON to a file", cxxopts::value<std::string>())
+        ("trace", "Write a Chrome trace of the stages per thread to a file", cxxopts::value<std::string>());
 
     // Add subcommand options
     options.add_options("Embed")
@@ -357,7 +797,15 @@ cxxopts::Options CLI::BuildCxxOptions()
         ("d,data", "Data file to hide in the image", cxxopts::value<std::string>())
         ("m,method", "Steganography method selection", cxxopts::value<std::string>())
         ("o,output", "Output stego image file", cxxopts::value<std::string>())
-        ("p,password", "Password for encryption", cxxopts::value<std::string>());
+        ("p,password", "Password for encryption", cxxopts::value<std::string>())
+        ("c,channels", "Channels used by LSB methods (e.g. rgb, b)", cxxopts::value<std::string>())
+        ("b,bit-plane", "Lowest bit plane used by LSB methods (0 = LSB)", cxxopts::value<int>())
+        ("n,bit-count", "Number of bit planes used per sample by LSB methods", cxxopts::value<int>())
+        ("k,key-check", "Store a fast password check; also makes offline guessing about 10^4x cheaper")
+        ("z,compress", "Compress the data before encryption so it needs less capacity")
+        ("e,ecc", "Reed-Solomon parity bytes per 255-byte codeword (e.g. 32)", cxxopts::value<int>())
+        ("perm-cache", "Directory keeping lsbshuffle permutations for later runs", cxxopts::value<std::string>())
+        ("max-memory", "Memory limit for LSB embedding (e.g. 512M), fails early if the estimate exceeds it", cxxopts::value<std::string>());
 
     options.add_options("Extract")
         ("extract", "Extract data from an image")
@@ -367,7 +815,12 @@ cxxopts::Options CLI::BuildCxxOptions()
         ("P,password-extract", "Password for decryption", cxxopts::value<std::string>());
     
     options.add_options("Visual")
-        ("visual", "Visualize stego data output");
+        ("visual", "Visualize stego data output")
+        ("mode", "What visual draws: map, diff or heatmap (LSB methods only)", cxxopts::value<std::string>())
+        ("downscale", "Draw the visual map at 1/N of the cover's size, LSB methods only", cxxopts::value<int>());
+
+    options.add_options("Analyze")
+        ("analyze", "Screen images (-i file or directory) for LSB payloads, JSON report");
 
     // Custom help message
     options.custom_help("[COMMAND] [OPTIONS]");
@@ -396,37 +849,88 @@ void CLI::PrintExamples() {
 
 void CLI::PrintEmbedUsage() {
     std::cout << "Embed Usage:\n"
-              << "  stegtool embed -i <cover_image> -d <data_file> [-m <stego_method>] [-o <output_image>] [-p <password>]\n\n"
+              << "  stegtool embed -i <cover_image> -d <data_file> [-m <stego_method>] [-o <output_image>] [-c <channels>] [-b <bit_plane>] [-n <bit_count>] [-p <password>] [-k] [-z] [-e <parity>] [--perm-cache <dir>] [--max-memory <size>] [--stats] [--stats-json <file>] [--trace <file>]\n\n"
               << "  Required arguments:\n"
               << "    -i, --input <file>     Cover image (PNG format) to hide data in\n"
               << "    -d, --data <file>      File containing data to hide\n\n"
               << "  Optional arguments:\n"
               << "    -m, --method <method>  Steganography method used to imprint data ( defaults to \"" << LSB_METHOD << "\" if not provided)\n"
               << "    -o, --output <file>    Output stego image ( defaults to \"" << DEFAULT_IMAGE_NAME << "\" if not provided)\n\n"
-              << "    -p, --password <pass>  Password for encrypting the data (empty if not provided)\n";
+              << "    -c, --channels <rgba>  Channels that carry data, LSB methods only (defaults to all)\n"
+              << "    -b, --bit-plane <0-15> Lowest bit plane that carries data, LSB methods only (defaults to 0)\n"
+              << "    -n, --bit-count <1-8>  Bit planes per sample that carry data, LSB methods only (defaults to 1)\n"
+              << "    -p, --password <pass>  Password for encrypting the data (empty if not provided)\n"
+              << "    -k, --key-check        Store a 16-bit password check so extraction skips PBKDF2 for most wrong passwords\n"
+              << "                           (offline password guessing gets about 10^4x cheaper too)\n"
+              << "    -z, --compress         Compress the data before encryption (LZ4) so it needs less capacity\n"
+              << "    -e, --ecc <parity>     Add Reed-Solomon error correction: even parity bytes per 255-byte\n"
+              << "                           codeword (2-128), each codeword survives parity/2 damaged bytes\n"
+              << "    --perm-cache <dir>     Keep lsbshuffle permutations in <dir>, so later runs on images of the\n"
+              << "                           same size and password skip building them (the files are as secret as the password)\n"
+              << "    --max-memory <size>    Keep the estimated memory below <size> (K, M or G suffix), LSB methods only:\n"
+              << "                           the embed fails before loading the cover if its estimate is larger\n"
+              << "                           (lsbshuffle first drops its partitioned writes to fit)\n"
+              << "    --stats                Print time, bytes and counters per stage (decode, key derivation, cipher, embed, ...)\n"
+              << "    --stats-json <file>    Write the same statistics as JSON to <file>\n"
+              << "    --trace <file>         Write the stages and waits of every thread as a Chrome trace\n"
+              << "                           (open in chrome://tracing or ui.perfetto.dev)\n";
 }
 
 void CLI::PrintExtractUsage() {
     std::cout << "Extract Usage:\n"
-              << "  stegtool extract -i <stego_image> [-m <stego_method>] [-o <output_file>] [-p <password>]\n\n"
+              << "  stegtool extract -i <stego_image> [-m <stego_method>] [-o <output_file>] [-c <channels>] [-b <bit_plane>] [-n <bit_count>] [-p <password>] [--perm-cache <dir>] [--stats] [--stats-json <file>] [--trace <file>]\n\n"
               << "  Required arguments:\n"
               << "    -i, --input <file>     Stego image (PNG format) with hidden data\n\n"
               << "  Optional arguments:\n"
-              << "    -m, --method <method>  Steganography method used to extract data ( defaults to \"" << LSB_METHOD << "\" if not provided)\n"
+              << "    -m, --method <method>  Steganography method used to extract data ( defaults to \"" << AUTO_METHOD << "\", which tries every method that fits the file)\n"
               << "    -o, --output <file>  Output file for extracted data ( defaults to \"" << DEFAULT_EXTRACTION_NAME << "\" if not provided)\n"
-              << "    -p, --password <pass>  Password for decrypting the data (empty if not provided)\n";;
+              << "    -c, --channels <rgba>  Channels that carry data, LSB methods only (defaults to all)\n"
+              << "    -b, --bit-plane <0-15> Lowest bit plane that carries data, LSB methods only (defaults to 0)\n"
+              << "    -n, --bit-count <1-8>  Bit planes per sample that carry data, LSB methods only (defaults to 1)\n"
+              << "    -p, --password <pass>  Password for decrypting the data (empty if not provided)\n"
+              << "    --perm-cache <dir>     Keep lsbshuffle permutations in <dir> for later runs, see embed\n"
+              << "    --stats, --stats-json <file>  Print or write statistics per stage, see embed\n"
+              << "    --trace <file>                Write a Chrome trace of the stages per thread, see embed\n";
 }
 
 void CLI::PrintVisualUsage() {
     std::cout << "Visualize Usage:\n"
-              << "  stegtool visual -i <cover_image> -d <data_file> [-m <stego_method>] [-o <output_image>] [-p <password>]\n\n"
+              << "  stegtool visual -i <cover_image> -d <data_file> [-m <stego_method>] [-o <output_image>] [-c <channels>] [-b <bit_plane>] [-n <bit_count>] [-p <password>] [-k] [-z] [-e <parity>] [--max-memory <size>] [--mode <mode>] [--downscale <n>] [--stats] [--stats-json <file>] [--trace <file>]\n\n"
               << "  Required arguments:\n"
               << "    -i, --input <file>     Cover image (PNG format) to hide data in\n"
               << "    -d, --data <file>      File containing data to hide\n\n"
               << "  Optional arguments:\n"
               << "    -m, --method <method>  Steganography method used to imprint data ( defaults to \"" << LSB_METHOD << "\" if not provided)\n"
               << "    -o, --output <file>    Output stego image ( defaults to \"" << DEFAULT_IMAGE_VISUAL_NAME << "\" if not provided)\n\n"
-              << "    -p, --password <pass>  Password for encrypting the data (empty if not provided)\n";
+              << "    -c, --channels <rgba>  Channels that carry data, LSB methods only (defaults to all)\n"
+              << "    -b, --bit-plane <0-15> Lowest bit plane that carries data, LSB methods only (defaults to 0)\n"
+              << "    -n, --bit-count <1-8>  Bit planes per sample that carry data, LSB methods only (defaults to 1)\n"
+              << "    -p, --password <pass>  Password for encrypting the data (empty if not provided)\n"
+              << "    -k, --key-check        Store a 16-bit password check so extraction skips PBKDF2 for most wrong passwords\n"
+              << "                           (offline password guessing gets about 10^4x cheaper too)\n"
+              << "    -z, --compress         Compress the data before encryption (LZ4) so it needs less capacity\n"
+              << "    -e, --ecc <parity>     Add Reed-Solomon error correction: even parity bytes per 255-byte\n"
+              << "                           codeword (2-128), each codeword survives parity/2 damaged bytes\n"
+              << "    --max-memory <size>    Keep the estimated memory below <size> (K, M or G suffix), see embed\n"
+              << "    --mode <mode>          What to draw, LSB methods only (defaults to map):\n"
+              << "                             map      samples that carry the payload\n"
+              << "                             diff     samples the embedding changed in the cover\n"
+              << "                             heatmap  share of embedding bits changed per block, grayscale\n"
+              << "    --downscale <n>        Draw at 1/n of the cover's width and height, a pixel lights up if any\n"
+              << "                           of the n x n it covers does (LSB methods; heatmap blocks, default "
+              << DEFAULT_HEATMAP_BLOCK << ")\n"
+              << "    --stats, --stats-json <file>  Print or write statistics per stage, see embed\n"
+              << "    --trace <file>                Write a Chrome trace of the stages per thread, see embed\n";
+}
+
+void CLI::PrintAnalyzeUsage() {
+    std::cout << "Analyze Usage:\n"
+              << "  stegtool analyze -i <image_or_directory> [-o <report.json>]\n\n"
+              << "  Required arguments:\n"
+              << "    -i, --input <path>     Image, or directory searched recursively for images\n\n"
+              << "  Optional arguments:\n"
+              << "    -o, --output <file>    JSON report file (printed to stdout if not provided)\n\n"
+              << "  Exits with 1 if any image could not be analyzed; the report still lists it.\n";
 }
 
 bool CLI::ConfirmOverwrite(const std::string& inputFile, const std::string& outputFile) {
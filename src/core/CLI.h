@@ -7,22 +7,43 @@
 #include "../algorithms/StegoHandler.h"
 
 #define DEFAULT_IMAGE_NAME "embedded-steno.png"
+#define DEFAULT_JPEG_IMAGE_NAME "embedded-steno.jpg"
+#define DEFAULT_WAV_NAME "embedded-steno.wav"
+#define DEFAULT_Y4M_NAME "embedded-steno.y4m"
 #define DEFAULT_EXTRACTION_NAME  "extracted.steno"
 #define DEFAULT_IMAGE_VISUAL_NAME "visualization-steno.png"
+#define DEFAULT_HEATMAP_BLOCK 16
 
 #define LSB_METHOD "lsb"
 #define LSB_SHUFFLE_METHOD "lsbshuffle"
+#define LSB_MATCHING_METHOD "lsbmatch"
+#define LSB_HAMMING_METHOD "hamming"
+#define DCT_METHOD "dct"
+#define LSB_ADAPTIVE_METHOD "adaptive"
+#define WAV_METHOD "wav"
+#define APNG_METHOD "apng"
+#define Y4M_METHOD "y4m"
+#define LSB_TILED_METHOD "lsbtile"
+#define AUTO_METHOD "auto"
 
 typedef enum {
    LSB = 0,
-   LSBShuffle
+   LSBShuffle,
+   LSBMatching,
+   LSBHamming,
+   DCT,
+   LSBAdaptive,
+   WAV,
+   APNG,
+   Y4M,
+   LSBTiled
 } StegoMethod;
 
 /**
  * @brief Command-line interface handler for stegtool.
  *
  * Parses arguments and dispatches to the appropriate
- * steganography operations (embed/extract).
+ * steganography operations (embed/extract/visual/analyze).
  */
 class CLI
 {
@@ -44,13 +65,24 @@ private:
    static void PrintEmbedUsage();
    static void PrintExtractUsage();
    static void PrintVisualUsage();
+   static void PrintAnalyzeUsage();
    static bool ConfirmOverwrite(const std::string& inputFile, const std::string& outputFile);
    static int HandleEmbedCommand(const cxxopts::ParseResult& parsedOptions);
    static int HandleVisualCommand(const cxxopts::ParseResult& parsedOptions);
    static int HandleExtractCommand(const cxxopts::ParseResult& parsedOptions);
+   static int HandleAnalyzeCommand(const cxxopts::ParseResult& parsedOptions);
+   static int HandleAutoExtract(const std::string& inputFile, const std::string& outputFile,
+                                const std::string& password, const cxxopts::ParseResult& parsedOptions);
+   static std::vector<StegoMethod> DetectCandidateMethods(const std::string& inputFile);
    static std::string StegoMethodToString(StegoMethod method);
    static StegoMethod ParseStegoMethod(const std::string& methodStr);
    static std::unique_ptr<StegoHandler> ChooseHandlerMethod(StegoMethod method);
+   static bool ConfigureEmbeddingMask(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions);
+   static void ConfigurePermutationCache(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions);
+   static bool ConfigureErrorCorrection(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions);
+   static bool ConfigureMemoryLimit(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions);
+   static bool ConfigureVisualOutput(StegoHandler *handler, const cxxopts::ParseResult& parsedOptions);
+   static int ReportInstrumentation(int status, const cxxopts::ParseResult& parsedOptions);
 };
 
 #endif // __STEGO_CLI_H_
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "Checksum.h"
+#include "CpuFeatures.h"
+
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t CRC32C_POLY = 0x82F63B78u;
+
+constexpr std::array<uint32_t, 256> BuildCrc32cTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t value = 0; value < 256; ++value) {
+        uint32_t crc = value;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1u)));
+        }
+        table[value] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<uint32_t, 256> CRC32C_TABLE = BuildCrc32cTable();
+
+uint32_t Crc32cTable(const uint8_t *data, std::size_t size, uint32_t crc) {
+    for (std::size_t idx = 0; idx < size; ++idx) {
+        crc = (crc >> 8) ^ CRC32C_TABLE[(crc ^ data[idx]) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef STEGTOOL_X86_SIMD
+
+// SSE4.2 crc32 instruction, 8 bytes per step on 64-bit targets. Only called after the CPU check
+__attribute__((target("sse4.2")))
+uint32_t Crc32cHardware(const uint8_t *data, std::size_t size, uint32_t crc) {
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    for (; size >= 8; size -= 8, data += 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+    for (; size >= 4; size -= 4, data += 4) {
+        uint32_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; size > 0; --size, ++data) {
+        crc = _mm_crc32_u8(crc, *data);
+    }
+    return crc;
+}
+
+#endif
+
+} // namespace
+
+uint32_t Checksum::Crc32c(const uint8_t *data, std::size_t size, uint32_t crc) {
+#ifdef STEGTOOL_X86_SIMD
+    if (CpuFeatures::HasSse42()) {
+        return ~Crc32cHardware(data, size, ~crc);
+    }
+#endif
+    return ~Crc32cTable(data, size, ~crc);
+}
+
+bool Checksum::HasHardwareCrc32c() {
+#ifdef STEGTOOL_X86_SIMD
+    return CpuFeatures::HasSse42();
+#else
+    return false;
+#endif
+}
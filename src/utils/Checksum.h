@@ -0,0 +1,33 @@
+#ifndef __CHECKSUM_H_
+#define __CHECKSUM_H_
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Static class providing non-cryptographic checksums for integrity checks.
+ */
+class Checksum {
+public:
+    Checksum() = delete;
+
+    /**
+     * @brief Compute CRC-32C (Castagnoli, reflected polynomial 0x82F63B78).
+     *
+     * Chain calls by passing the previous result as 'crc'. Uses the SSE4.2
+     * crc32 instruction when the CPU has it, a lookup table otherwise.
+     *
+     * @param data Bytes to checksum
+     * @param size Number of bytes
+     * @param crc Result of the previous call, 0 to start
+     * @return CRC-32C of all bytes seen so far
+     */
+    static uint32_t Crc32c(const uint8_t *data, std::size_t size, uint32_t crc = 0);
+
+    /**
+     * @brief Whether Crc32c runs on the hardware instruction on this machine.
+     */
+    static bool HasHardwareCrc32c();
+};
+
+#endif // __CHECKSUM_H_
@@ -0,0 +1,252 @@
+#include "Compression.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+// LZ4 block format constants
+constexpr std::size_t MIN_MATCH = 4;
+constexpr std::size_t LAST_LITERALS = 5;   // the block always ends with this many literals
+constexpr std::size_t MATCH_LIMIT = 12;    // no match may start closer than this to the end
+constexpr std::size_t MAX_OFFSET = 65535;
+constexpr uint32_t RUN_MASK = 15;
+
+constexpr int HASH_LOG = 16;
+constexpr int SKIP_TRIGGER = 6;            // search step grows every 2^6 misses
+
+inline uint32_t Read32(const uint8_t *ptr) {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+inline uint32_t Hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+void WriteU32(uint8_t *out, uint32_t value) {
+    for (int idx = 0; idx < 4; ++idx) {
+        out[idx] = static_cast<uint8_t>(value >> (8 * idx));
+    }
+}
+
+uint32_t ReadU32(const uint8_t *in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Lengths of 15 and more continue in 255-valued bytes after the token
+void WriteLength(std::vector<uint8_t> &out, std::size_t length) {
+    for (; length >= 255; length -= 255) {
+        out.push_back(255);
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+void WriteSequence(std::vector<uint8_t> &out, const uint8_t *literals, std::size_t literalCount,
+                   std::size_t offset, std::size_t matchLength) {
+    std::size_t matchCode = matchLength - MIN_MATCH;
+    uint8_t token = static_cast<uint8_t>((std::min<std::size_t>(literalCount, RUN_MASK) << 4) |
+                                         std::min<std::size_t>(matchCode, RUN_MASK));
+    out.push_back(token);
+    if (literalCount >= RUN_MASK) {
+        WriteLength(out, literalCount - RUN_MASK);
+    }
+    out.insert(out.end(), literals, literals + literalCount);
+    out.push_back(static_cast<uint8_t>(offset));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (matchCode >= RUN_MASK) {
+        WriteLength(out, matchCode - RUN_MASK);
+    }
+}
+
+void WriteLastLiterals(std::vector<uint8_t> &out, const uint8_t *literals, std::size_t literalCount) {
+    out.push_back(static_cast<uint8_t>(std::min<std::size_t>(literalCount, RUN_MASK) << 4));
+    if (literalCount >= RUN_MASK) {
+        WriteLength(out, literalCount - RUN_MASK);
+    }
+    out.insert(out.end(), literals, literals + literalCount);
+}
+
+/**
+ * Greedy single-probe LZ4 compression. The search step grows on runs of misses,
+ * so incompressible input passes through at close to memcpy speed.
+ */
+std::vector<uint8_t> CompressLz4(const uint8_t *src, std::size_t size) {
+    std::vector<uint8_t> out;
+    out.reserve(size + size / 255 + 16);
+
+    const uint8_t *anchor = src;
+    if (size >= MATCH_LIMIT + 1) {
+        std::vector<uint32_t> table(std::size_t(1) << HASH_LOG, 0);
+        const uint8_t *matchEnd = src + size - LAST_LITERALS;
+        const uint8_t *searchEnd = src + size - MATCH_LIMIT;
+
+        const uint8_t *ip = src + 1;
+        table[Hash(Read32(src))] = 0;
+        std::size_t misses = std::size_t(1) << SKIP_TRIGGER;
+
+        while (ip < searchEnd) {
+            uint32_t hash = Hash(Read32(ip));
+            const uint8_t *candidate = src + table[hash];
+            table[hash] = static_cast<uint32_t>(ip - src);
+
+            if (candidate >= ip || static_cast<std::size_t>(ip - candidate) > MAX_OFFSET ||
+                Read32(candidate) != Read32(ip)) {
+                ip += misses++ >> SKIP_TRIGGER;
+                continue;
+            }
+            misses = std::size_t(1) << SKIP_TRIGGER;
+
+            // Extend backwards over literals, then forwards up to the last literals
+            while (ip > anchor && candidate > src && ip[-1] == candidate[-1]) {
+                --ip;
+                --candidate;
+            }
+            const uint8_t *scan = ip + MIN_MATCH;
+            const uint8_t *ref = candidate + MIN_MATCH;
+            while (scan < matchEnd && *scan == *ref) {
+                ++scan;
+                ++ref;
+            }
+
+            WriteSequence(out, anchor, static_cast<std::size_t>(ip - anchor),
+                          static_cast<std::size_t>(ip - candidate), static_cast<std::size_t>(scan - ip));
+
+            ip = scan;
+            anchor = ip;
+            if (ip < searchEnd) {
+                table[Hash(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+            }
+        }
+    }
+
+    WriteLastLiterals(out, anchor, static_cast<std::size_t>(src + size - anchor));
+    return out;
+}
+
+// Read an extended length; false when the input runs out
+bool ReadLength(const uint8_t *&ip, const uint8_t *end, std::size_t &length) {
+    uint8_t byte;
+    do {
+        if (ip >= end) {
+            return false;
+        }
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool DecompressLz4(const uint8_t *ip, const uint8_t *end, std::vector<uint8_t> &out) {
+    std::size_t pos = 0;
+    const std::size_t size = out.size();
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        std::size_t literalCount = token >> 4;
+        if (literalCount == RUN_MASK && !ReadLength(ip, end, literalCount)) {
+            return false;
+        }
+        if (literalCount > static_cast<std::size_t>(end - ip) || literalCount > size - pos) {
+            return false;
+        }
+        std::memcpy(out.data() + pos, ip, literalCount);
+        ip += literalCount;
+        pos += literalCount;
+
+        // Last sequence carries literals only
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        std::size_t offset = ip[0] | (static_cast<std::size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > pos) {
+            return false;
+        }
+
+        std::size_t matchLength = token & RUN_MASK;
+        if (matchLength == RUN_MASK && !ReadLength(ip, end, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > size - pos) {
+            return false;
+        }
+
+        // Overlapping matches repeat the last 'offset' bytes, so copy forwards
+        uint8_t *dst = out.data() + pos;
+        const uint8_t *ref = dst - offset;
+        if (offset >= matchLength) {
+            std::memcpy(dst, ref, matchLength);
+        } else {
+            for (std::size_t idx = 0; idx < matchLength; ++idx) {
+                dst[idx] = ref[idx];
+            }
+        }
+        pos += matchLength;
+    }
+
+    return pos == size;
+}
+
+} // namespace
+
+std::vector<uint8_t> Compression::Compress(const std::vector<uint8_t> &data) {
+    StageTimer timer(Stats::Stage::Compress, data.size());
+    std::vector<uint8_t> compressed = CompressLz4(data.data(), data.size());
+    bool stored = compressed.size() >= data.size();
+    const std::vector<uint8_t> &body = stored ? data : compressed;
+
+    std::vector<uint8_t> block(HEADER_SIZE + body.size());
+    block[0] = stored ? MODE_STORED : MODE_LZ4;
+    WriteU32(block.data() + 1, static_cast<uint32_t>(data.size()));
+    std::copy(body.begin(), body.end(), block.begin() + HEADER_SIZE);
+    return block;
+}
+
+Result<std::vector<uint8_t>> Compression::Decompress(const std::vector<uint8_t> &block, std::size_t maxSize) {
+    StageTimer timer(Stats::Stage::Decompress, block.size());
+    if (block.size() < HEADER_SIZE) {
+        return Result<std::vector<uint8_t>>(ErrorCode::InvalidDataSize, "Compressed data is too small");
+    }
+
+    uint8_t mode = block[0];
+    std::size_t originalSize = ReadU32(block.data() + 1);
+    if (originalSize > maxSize) {
+        std::ostringstream oss;
+        oss << "Decompressed size (" << originalSize << " bytes) exceeds maximum allowed size ("
+            << maxSize << " bytes)";
+        return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, oss.str());
+    }
+
+    const uint8_t *body = block.data() + HEADER_SIZE;
+    const uint8_t *end = block.data() + block.size();
+
+    if (mode == MODE_STORED) {
+        if (static_cast<std::size_t>(end - body) != originalSize) {
+            return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, "Stored data size mismatch");
+        }
+        return Result<std::vector<uint8_t>>(std::vector<uint8_t>(body, end));
+    }
+
+    if (mode != MODE_LZ4) {
+        std::ostringstream oss;
+        oss << "Unknown compression mode " << static_cast<int>(mode);
+        return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, oss.str());
+    }
+
+    std::vector<uint8_t> out(originalSize);
+    if (!DecompressLz4(body, end, out)) {
+        return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, "Compressed data is corrupted");
+    }
+    return Result<std::vector<uint8_t>>(out);
+}
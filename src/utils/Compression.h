@@ -0,0 +1,51 @@
+#ifndef __COMPRESSION_H_
+#define __COMPRESSION_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "ErrorHandler.h"
+
+/**
+ * @brief Static class providing a fast lossless block compressor for payloads.
+ *
+ * Output layout (little endian):
+ *   [0]     mode (MODE_STORED or MODE_LZ4)
+ *   [1..4]  size of the original data
+ *   [5..]   original bytes (stored) or an LZ4 block (raw LZ4 block format,
+ *           no frame), whichever is smaller
+ *
+ * Compression runs before encryption: ciphertext does not compress, and every
+ * byte saved is a byte the carrier does not have to hold.
+ */
+class Compression {
+public:
+    Compression() = delete;
+
+    static constexpr uint8_t MODE_STORED = 0;
+    static constexpr uint8_t MODE_LZ4 = 1;
+
+    /** Size of the mode byte and original size prefix **/
+    static constexpr std::size_t HEADER_SIZE = 5;
+
+    /**
+     * @brief Compress data, falling back to a stored copy when it does not shrink.
+     *
+     * @param data Bytes to compress (at most 4 GB)
+     * @return Compressed block, never more than HEADER_SIZE bytes larger than data
+     */
+    static std::vector<uint8_t> Compress(const std::vector<uint8_t> &data);
+
+    /**
+     * @brief Reverse Compress.
+     *
+     * Every length and offset is bounds checked, so corrupted input fails cleanly.
+     *
+     * @param block Output of Compress
+     * @param maxSize Largest original size accepted
+     * @return Result containing the original data, or InvalidDataSize / CorruptedPayload
+     */
+    static Result<std::vector<uint8_t>> Decompress(const std::vector<uint8_t> &block, std::size_t maxSize);
+};
+
+#endif // __COMPRESSION_H_
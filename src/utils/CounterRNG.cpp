@@ -0,0 +1,71 @@
+#include "CounterRNG.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53u;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57u;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9u; // golden ratio
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85u; // sqrt(3) - 1
+constexpr int PHILOX_ROUNDS = 10;
+
+inline void MulHiLo(uint32_t a, uint32_t b, uint32_t &hi, uint32_t &lo) {
+    uint64_t product = static_cast<uint64_t>(a) * b;
+    hi = static_cast<uint32_t>(product >> 32);
+    lo = static_cast<uint32_t>(product);
+}
+
+inline CounterRNG::Block Philox(uint32_t key0, uint32_t key1, uint64_t counter) {
+    uint32_t c0 = static_cast<uint32_t>(counter);
+    uint32_t c1 = static_cast<uint32_t>(counter >> 32);
+    uint32_t c2 = 0;
+    uint32_t c3 = 0;
+
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        uint32_t hi0, lo0, hi1, lo1;
+        MulHiLo(PHILOX_M0, c0, hi0, lo0);
+        MulHiLo(PHILOX_M1, c2, hi1, lo1);
+        c0 = hi1 ^ c1 ^ key0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ key1;
+        c3 = lo0;
+        key0 += PHILOX_W0;
+        key1 += PHILOX_W1;
+    }
+    return CounterRNG::Block{c0, c1, c2, c3};
+}
+
+} // namespace
+
+CounterRNG::CounterRNG(const std::vector<uint8_t> &key) : key0_(0), key1_(0) {
+    uint8_t padded[KEY_SIZE] = {0};
+    std::copy_n(key.begin(), std::min(key.size(), KEY_SIZE), padded);
+    key0_ = static_cast<uint32_t>(padded[0])       | (static_cast<uint32_t>(padded[1]) << 8) |
+            (static_cast<uint32_t>(padded[2]) << 16) | (static_cast<uint32_t>(padded[3]) << 24);
+    key1_ = static_cast<uint32_t>(padded[4])       | (static_cast<uint32_t>(padded[5]) << 8) |
+            (static_cast<uint32_t>(padded[6]) << 16) | (static_cast<uint32_t>(padded[7]) << 24);
+}
+
+CounterRNG::CounterRNG(uint64_t key)
+    : key0_(static_cast<uint32_t>(key)),
+      key1_(static_cast<uint32_t>(key >> 32))
+{   }
+
+CounterRNG::Block CounterRNG::Generate(uint64_t counter) const {
+    return Philox(key0_, key1_, counter);
+}
+
+void CounterRNG::Fill(uint64_t firstBlock, uint32_t *out, std::size_t wordCount) const {
+    std::size_t fullBlocks = wordCount / WORDS_PER_BLOCK;
+    for (std::size_t blockIdx = 0; blockIdx < fullBlocks; ++blockIdx) {
+        Block block = Philox(key0_, key1_, firstBlock + blockIdx);
+        std::copy(block.begin(), block.end(), out + blockIdx * WORDS_PER_BLOCK);
+    }
+
+    std::size_t remaining = wordCount % WORDS_PER_BLOCK;
+    if (remaining != 0) {
+        Block block = Philox(key0_, key1_, firstBlock + fullBlocks);
+        std::copy_n(block.begin(), remaining, out + fullBlocks * WORDS_PER_BLOCK);
+    }
+}
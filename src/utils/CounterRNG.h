@@ -0,0 +1,64 @@
+#ifndef __COUNTER_RNG_H_
+#define __COUNTER_RNG_H_
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Keyed counter-based pseudo random generator (Philox4x32-10).
+ *
+ * Every 128-bit output block is a pure function of (key, counter), so any
+ * part of the stream can be generated independently. This lets kernels
+ * draw random bits for block N without generating blocks 0..N-1 first.
+ *
+ * Not a cryptographic generator: keys should come from a proper KDF
+ * (see CryptoModule::DeriveSubkey) when the stream must stay secret.
+ */
+class CounterRNG {
+public:
+    static constexpr std::size_t KEY_SIZE = 8;          // Key bytes consumed (2 x 32-bit words)
+    static constexpr std::size_t WORDS_PER_BLOCK = 4;   // 32-bit words produced per counter value
+
+    using Block = std::array<uint32_t, WORDS_PER_BLOCK>;
+
+    /**
+     * @brief Create a generator from raw key material.
+     *
+     * Only the first KEY_SIZE bytes are used; shorter keys are zero padded.
+     *
+     * @param key Key bytes
+     */
+    explicit CounterRNG(const std::vector<uint8_t> &key);
+
+    /**
+     * @brief Create a generator from a 64-bit key.
+     */
+    explicit CounterRNG(uint64_t key);
+
+    /**
+     * @brief Generate the 128-bit block for a given counter value.
+     *
+     * @param counter Block index in the stream
+     * @return Four 32-bit random words
+     */
+    Block Generate(uint64_t counter) const;
+
+    /**
+     * @brief Fill a buffer with consecutive stream words.
+     *
+     * Word i of the buffer equals word (i % 4) of block (firstBlock + i / 4).
+     *
+     * @param firstBlock Counter of the first block to generate
+     * @param out Destination buffer
+     * @param wordCount Number of 32-bit words to write
+     */
+    void Fill(uint64_t firstBlock, uint32_t *out, std::size_t wordCount) const;
+
+private:
+    uint32_t key0_;
+    uint32_t key1_;
+};
+
+#endif // __COUNTER_RNG_H_
@@ -0,0 +1,56 @@
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+// Level forced by ScopedSimdLevel, -1 when none
+std::atomic<int> forcedLevel{-1};
+
+SimdLevel DetectSimdLevel() {
+#ifdef STEGTOOL_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return SimdLevel::Ssse3;
+    }
+#endif
+    return SimdLevel::Portable;
+}
+
+SimdLevel GetDetectedLevel() {
+    static const SimdLevel detected = DetectSimdLevel();
+    return detected;
+}
+
+} // namespace
+
+bool CpuFeatures::Supports(SimdLevel level) {
+    return level <= GetDetectedLevel();
+}
+
+bool CpuFeatures::HasSse42() {
+#ifdef STEGTOOL_X86_SIMD
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+SimdLevel CpuFeatures::GetSimdLevel() {
+    int forced = forcedLevel.load(std::memory_order_relaxed);
+    return forced < 0 ? GetDetectedLevel() : static_cast<SimdLevel>(forced);
+}
+
+CpuFeatures::ScopedSimdLevel::ScopedSimdLevel(SimdLevel level)
+    : previous_(forcedLevel.load())
+{
+    forcedLevel.store(static_cast<int>(std::min(level, GetDetectedLevel())));
+}
+
+CpuFeatures::ScopedSimdLevel::~ScopedSimdLevel() {
+    forcedLevel.store(previous_);
+}
@@ -0,0 +1,66 @@
+#ifndef __CPU_FEATURES_H_
+#define __CPU_FEATURES_H_
+
+// x86 builds with GCC or Clang compile the SSSE3/AVX2/SSE4.2 kernels through
+// target attributes and choose between them at run time
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define STEGTOOL_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Vector instruction sets the SIMD kernels dispatch on, in ascending order.
+ */
+enum class SimdLevel {
+    Portable,
+    Ssse3,
+    Avx2
+};
+
+/**
+ * @brief Static class answering which vector instructions the CPU has.
+ *
+ * Kernels ask GetSimdLevel on every dispatch rather than caching their choice,
+ * so tests can force a lower level with ScopedSimdLevel and cover the SSSE3 and
+ * portable paths on machines that have AVX2.
+ */
+class CpuFeatures {
+public:
+    CpuFeatures() = delete;
+
+    /**
+     * @brief Whether the CPU can run kernels of the given level.
+     */
+    static bool Supports(SimdLevel level);
+
+    /**
+     * @brief Whether the CPU has the SSE4.2 crc32 instruction.
+     */
+    static bool HasSse42();
+
+    /**
+     * @brief Level the kernels dispatch on: the highest the CPU supports,
+     * unless a ScopedSimdLevel is active.
+     */
+    static SimdLevel GetSimdLevel();
+
+    /**
+     * @brief Test seam: forces GetSimdLevel to a lower level while in scope.
+     *
+     * Levels the CPU lacks are capped at the highest it has, so check Supports
+     * first. Set it before the work starts, not while kernels run.
+     */
+    class ScopedSimdLevel {
+    public:
+        explicit ScopedSimdLevel(SimdLevel level);
+        ~ScopedSimdLevel();
+
+        ScopedSimdLevel(const ScopedSimdLevel &) = delete;
+        ScopedSimdLevel &operator=(const ScopedSimdLevel &) = delete;
+
+    private:
+        int previous_;
+    };
+};
+
+#endif // __CPU_FEATURES_H_
@@ -1,5 +1,10 @@
 #include "CryptoModule.h"
+#include "Checksum.h"
+#include "Stats.h"
 
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <iostream>
 #include <sstream>
 #include <cstring>
@@ -7,6 +12,7 @@
 #include <openssl/rand.h>
 #include <openssl/hmac.h>
 #include <openssl/err.h>
+#include <openssl/crypto.h>
 
 std::string CryptoModule::GetOpenSSLError() {
     BIO *bio = BIO_new(BIO_s_mem());
@@ -22,18 +28,31 @@ Result<std::vector<uint8_t>> CryptoModule::EncryptData(
     const std::vector<uint8_t> &plainData,
     const std::string &password) {
     
+    const std::size_t plainSize = plainData.size();
+
     // Validate input
-    if (plainData.empty()) {
+    if (plainSize == 0) {
         return Result<std::vector<uint8_t>>(
             ErrorCode::InvalidArgument,
             "Cannot encrypt empty data"
         );
     }
-    
+    if (plainSize > static_cast<std::size_t>(std::numeric_limits<int>::max() - EVP_MAX_BLOCK_LENGTH)) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::DataTooLarge,
+            "Data too large to encrypt in one piece"
+        );
+    }
+
+    // Output is built in place: [salt | IV | ciphertext | HMAC], padding adds at most one block
+    const std::size_t blockSize = static_cast<std::size_t>(EVP_CIPHER_block_size(EVP_aes_256_cbc()));
+    std::vector<uint8_t> encryptedData(SALT_SIZE + IV_SIZE + plainSize + blockSize + HMAC_SIZE);
+    uint8_t *salt = encryptedData.data();
+    uint8_t *iv = salt + SALT_SIZE;
+    uint8_t *ciphertext = iv + IV_SIZE;
+
     // Generate random salt and IV
-    std::vector<uint8_t> salt(SALT_SIZE);
-    std::vector<uint8_t> iv(IV_SIZE);
-    if (RAND_bytes(salt.data(), SALT_SIZE) != 1 || RAND_bytes(iv.data(), IV_SIZE) != 1) {
+    if (RAND_bytes(salt, SALT_SIZE) != 1 || RAND_bytes(iv, IV_SIZE) != 1) {
         return Result<std::vector<uint8_t>>(
             ErrorCode::EncryptionFailed,
             "Cryptographic random number generation failed"
@@ -41,9 +60,10 @@ Result<std::vector<uint8_t>> CryptoModule::EncryptData(
     }
 
     // Derive key from password + salt using PBKDF2-HMAC-SHA256
-    std::vector<uint8_t> key(KEY_SIZE);
+    std::array<uint8_t, KEY_SIZE> key{};
+    StageTimer keyTimer(Stats::Stage::KeyDerivation);
     if (PKCS5_PBKDF2_HMAC(password.c_str(), static_cast<int>(password.size()),
-                          salt.data(), SALT_SIZE,
+                          salt, SALT_SIZE,
                           PBKDF2_ITERATIONS, EVP_sha256(),
                           KEY_SIZE, key.data()) != 1) {
         return Result<std::vector<uint8_t>>(
@@ -51,18 +71,22 @@ Result<std::vector<uint8_t>> CryptoModule::EncryptData(
             "Key derivation failed"
         );
     }
+    keyTimer.Stop();
 
     // Create and initialize encryption context
+    StageTimer cipherTimer(Stats::Stage::Cipher, plainSize);
     EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
     if (!ctx) {
+        OPENSSL_cleanse(key.data(), key.size());
         return Result<std::vector<uint8_t>>(
             ErrorCode::EncryptionFailed,
             "Failed to create encryption context"
         );
     }
 
-    if (EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr, key.data(), iv.data()) != 1) {
+    if (EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr, key.data(), iv) != 1) {
         EVP_CIPHER_CTX_free(ctx);
+        OPENSSL_cleanse(key.data(), key.size());
         return Result<std::vector<uint8_t>>(
             ErrorCode::EncryptionFailed,
             "Failed to initialize AES-256-CBC encryption"
@@ -70,12 +94,12 @@ Result<std::vector<uint8_t>> CryptoModule::EncryptData(
     }
 
     // Perform encryption
-    std::vector<uint8_t> ciphertext(plainData.size() + EVP_CIPHER_block_size(EVP_aes_256_cbc()));
     int len = 0, ciphertext_len = 0;
 
-    if (EVP_EncryptUpdate(ctx, ciphertext.data(), &len,
-                          plainData.data(), static_cast<int>(plainData.size())) != 1) {
+    if (EVP_EncryptUpdate(ctx, ciphertext, &len,
+                          plainData.data(), static_cast<int>(plainSize)) != 1) {
         EVP_CIPHER_CTX_free(ctx);
+        OPENSSL_cleanse(key.data(), key.size());
         return Result<std::vector<uint8_t>>(
             ErrorCode::EncryptionFailed,
             "Encryption failed"
@@ -83,8 +107,9 @@ Result<std::vector<uint8_t>> CryptoModule::EncryptData(
     }
     ciphertext_len = len;
 
-    if (EVP_EncryptFinal_ex(ctx, ciphertext.data() + len, &len) != 1) {
+    if (EVP_EncryptFinal_ex(ctx, ciphertext + len, &len) != 1) {
         EVP_CIPHER_CTX_free(ctx);
+        OPENSSL_cleanse(key.data(), key.size());
         return Result<std::vector<uint8_t>>(
             ErrorCode::EncryptionFailed,
             "Encryption failed"
@@ -93,38 +118,27 @@ Result<std::vector<uint8_t>> CryptoModule::EncryptData(
     ciphertext_len += len;
 
     EVP_CIPHER_CTX_free(ctx);
+    cipherTimer.Stop();
 
-    // Resize ciphertext to actual length
-    ciphertext.resize(ciphertext_len);
-
-    // Build authenticated data: [salt | IV | ciphertext]
-    std::vector<uint8_t> dataToAuth;
-    dataToAuth.reserve(SALT_SIZE + IV_SIZE + ciphertext_len);
-    dataToAuth.insert(dataToAuth.end(), salt.begin(), salt.end());
-    dataToAuth.insert(dataToAuth.end(), iv.begin(), iv.end());
-    dataToAuth.insert(dataToAuth.end(), ciphertext.begin(), ciphertext.end());
-
-    // Compute HMAC-SHA256 over [salt | IV | ciphertext] using derived key
-    std::vector<uint8_t> hmac(HMAC_SIZE);
+    // Compute HMAC-SHA256 over [salt | IV | ciphertext] using derived key, right behind the ciphertext
+    const std::size_t authSize = SALT_SIZE + IV_SIZE + static_cast<std::size_t>(ciphertext_len);
     uint32_t hmac_len = 0;
-    if (HMAC(EVP_sha256(), key.data(), KEY_SIZE,
-             dataToAuth.data(), dataToAuth.size(),
-             hmac.data(), &hmac_len) == nullptr || hmac_len != HMAC_SIZE) {
+    StageTimer macTimer(Stats::Stage::Mac, authSize);
+    bool macced = HMAC(EVP_sha256(), key.data(), KEY_SIZE,
+                       encryptedData.data(), authSize,
+                       encryptedData.data() + authSize, &hmac_len) != nullptr && hmac_len == HMAC_SIZE;
+    macTimer.Stop();
+    OPENSSL_cleanse(key.data(), key.size());
+    if (!macced) {
         return Result<std::vector<uint8_t>>(
             ErrorCode::EncryptionFailed,
             "HMAC computation failed"
         );
     }
 
-    // Build final output: [salt | IV | ciphertext | HMAC]
-    std::vector<uint8_t> encryptedData;
-    encryptedData.reserve(SALT_SIZE + IV_SIZE + ciphertext_len + HMAC_SIZE);
-    encryptedData.insert(encryptedData.end(), salt.begin(), salt.end());
-    encryptedData.insert(encryptedData.end(), iv.begin(), iv.end());
-    encryptedData.insert(encryptedData.end(), ciphertext.begin(), ciphertext.end());
-    encryptedData.insert(encryptedData.end(), hmac.begin(), hmac.end());
-
-    return Result<std::vector<uint8_t>>(encryptedData);
+    // Drop the unused padding room
+    encryptedData.resize(authSize + HMAC_SIZE);
+    return Result<std::vector<uint8_t>>(std::move(encryptedData));
 }
 
 Result<std::vector<uint8_t>> CryptoModule::DecryptData(
@@ -142,23 +156,18 @@ Result<std::vector<uint8_t>> CryptoModule::DecryptData(
         );
     }
 
-    std::vector<uint8_t> salt(encryptedData.begin(), encryptedData.begin() + SALT_SIZE);
-    std::vector<uint8_t> iv(encryptedData.begin() + SALT_SIZE, 
-                            encryptedData.begin() + SALT_SIZE + IV_SIZE);
-    
-    // Ciphertext is between IV and HMAC
-    const size_t ciphertext_start = SALT_SIZE + IV_SIZE;
-    const size_t ciphertext_end = encryptedData.size() - HMAC_SIZE;
-    std::vector<uint8_t> ciphertext(encryptedData.begin() + ciphertext_start,
-                                    encryptedData.begin() + ciphertext_end);
-    
-    // HMAC is the last HMAC_SIZE bytes
-    std::vector<uint8_t> receivedHmac(encryptedData.end() - HMAC_SIZE, encryptedData.end());
+    // Fields are read in place: [salt | IV | ciphertext | HMAC]
+    const uint8_t *salt = encryptedData.data();
+    const uint8_t *iv = salt + SALT_SIZE;
+    const uint8_t *ciphertext = iv + IV_SIZE;
+    const std::size_t ciphertext_size = encryptedData.size() - SALT_SIZE - IV_SIZE - HMAC_SIZE;
+    const uint8_t *receivedHmac = ciphertext + ciphertext_size;
 
     // Derive key from password + salt
-    std::vector<uint8_t> key(KEY_SIZE);
+    std::array<uint8_t, KEY_SIZE> key{};
+    StageTimer keyTimer(Stats::Stage::KeyDerivation);
     if (PKCS5_PBKDF2_HMAC(password.c_str(), static_cast<int>(password.size()),
-                          salt.data(), SALT_SIZE,
+                          salt, SALT_SIZE,
                           PBKDF2_ITERATIONS, EVP_sha256(),
                           KEY_SIZE, key.data()) != 1) {
         return Result<std::vector<uint8_t>>(
@@ -166,28 +175,28 @@ Result<std::vector<uint8_t>> CryptoModule::DecryptData(
             "Key derivation failed"
         );
     }
+    keyTimer.Stop();
 
     // Verify HMAC before decrypting (Encrypt-then-MAC)
     // Compute HMAC over [salt | IV | ciphertext]
-    std::vector<uint8_t> dataToAuth;
-    dataToAuth.reserve(SALT_SIZE + IV_SIZE + ciphertext.size());
-    dataToAuth.insert(dataToAuth.end(), salt.begin(), salt.end());
-    dataToAuth.insert(dataToAuth.end(), iv.begin(), iv.end());
-    dataToAuth.insert(dataToAuth.end(), ciphertext.begin(), ciphertext.end());
-
-    std::vector<uint8_t> computedHmac(HMAC_SIZE);
+    std::array<uint8_t, HMAC_SIZE> computedHmac{};
     unsigned int hmac_len = 0;
+    StageTimer macTimer(Stats::Stage::Mac, SALT_SIZE + IV_SIZE + ciphertext_size);
     if (HMAC(EVP_sha256(), key.data(), KEY_SIZE,
-             dataToAuth.data(), dataToAuth.size(),
+             encryptedData.data(), SALT_SIZE + IV_SIZE + ciphertext_size,
              computedHmac.data(), &hmac_len) == nullptr || hmac_len != HMAC_SIZE) {
+        OPENSSL_cleanse(key.data(), key.size());
         return Result<std::vector<uint8_t>>(
             ErrorCode::DecryptionFailed,
             "HMAC computation failed"
         );
     }
 
+    macTimer.Stop();
+
     // Constant-time comparison to prevent timing attacks
-    if (CRYPTO_memcmp(computedHmac.data(), receivedHmac.data(), HMAC_SIZE) != 0) {
+    if (CRYPTO_memcmp(computedHmac.data(), receivedHmac, HMAC_SIZE) != 0) {
+        OPENSSL_cleanse(key.data(), key.size());
         return Result<std::vector<uint8_t>>(
             ErrorCode::AuthenticationFailed,
             "HMAC verification failed (incorrect password or corrupted data)"
@@ -195,15 +204,19 @@ Result<std::vector<uint8_t>> CryptoModule::DecryptData(
     }
 
     // Create and initialize decryption context
+    StageTimer cipherTimer(Stats::Stage::Cipher, ciphertext_size);
     EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
     if (!ctx) {
+        OPENSSL_cleanse(key.data(), key.size());
         return Result<std::vector<uint8_t>>(
             ErrorCode::DecryptionFailed,
             "Failed to create decryption context"
         );
     }
 
-    if (EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr, key.data(), iv.data()) != 1) {
+    bool initialized = EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr, key.data(), iv) == 1;
+    OPENSSL_cleanse(key.data(), key.size());
+    if (!initialized) {
         EVP_CIPHER_CTX_free(ctx);
         return Result<std::vector<uint8_t>>(
             ErrorCode::DecryptionFailed,
@@ -212,11 +225,11 @@ Result<std::vector<uint8_t>> CryptoModule::DecryptData(
     }
 
     // Perform decryption
-    std::vector<uint8_t> plaintext(ciphertext.size() + EVP_CIPHER_block_size(EVP_aes_256_cbc()));
+    std::vector<uint8_t> plaintext(ciphertext_size + EVP_CIPHER_block_size(EVP_aes_256_cbc()));
     int len = 0, plaintext_len = 0;
 
     if (EVP_DecryptUpdate(ctx, plaintext.data(), &len,
-                          ciphertext.data(), static_cast<int>(ciphertext.size())) != 1) {
+                          ciphertext, static_cast<int>(ciphertext_size)) != 1) {
         EVP_CIPHER_CTX_free(ctx);
         return Result<std::vector<uint8_t>>(
             ErrorCode::DecryptionFailed,
@@ -241,5 +254,161 @@ Result<std::vector<uint8_t>> CryptoModule::DecryptData(
     // Resize to actual plaintext length
     plaintext.resize(plaintext_len);
 
-    return Result<std::vector<uint8_t>>(plaintext);
+    return Result<std::vector<uint8_t>>(std::move(plaintext));
+}
+
+Result<std::vector<uint8_t>> CryptoModule::DeriveSubkey(
+    const std::string &password,
+    const std::string &context,
+    std::size_t size) {
+
+    StageTimer timer(Stats::Stage::KeyDerivation);
+    constexpr std::size_t HASH_SIZE = 32;
+    if (size == 0 || size > 255 * HASH_SIZE) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::InvalidArgument,
+            "Invalid derived key size"
+        );
+    }
+
+    // HKDF-Extract: PRK = HMAC(salt, password), salt defaults to HashLen zero bytes (RFC 5869)
+    std::vector<uint8_t> salt(HASH_SIZE, 0);
+    std::vector<uint8_t> prk(HASH_SIZE);
+    unsigned int prk_len = 0;
+    if (HMAC(EVP_sha256(), salt.data(), static_cast<int>(salt.size()),
+             reinterpret_cast<const unsigned char *>(password.data()), password.size(),
+             prk.data(), &prk_len) == nullptr || prk_len != HASH_SIZE) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::EncryptionFailed,
+            "HKDF extract failed"
+        );
+    }
+
+    // HKDF-Expand: T(i) = HMAC(PRK, T(i-1) | info | i)
+    std::vector<uint8_t> output;
+    output.reserve(size + HASH_SIZE);
+    std::vector<uint8_t> block;
+    for (uint8_t counter = 1; output.size() < size; ++counter) {
+        std::vector<uint8_t> message(block);
+        message.insert(message.end(), context.begin(), context.end());
+        message.push_back(counter);
+
+        block.assign(HASH_SIZE, 0);
+        unsigned int block_len = 0;
+        if (HMAC(EVP_sha256(), prk.data(), static_cast<int>(prk.size()),
+                 message.data(), message.size(),
+                 block.data(), &block_len) == nullptr || block_len != HASH_SIZE) {
+            return Result<std::vector<uint8_t>>(
+                ErrorCode::EncryptionFailed,
+                "HKDF expand failed"
+            );
+        }
+        output.insert(output.end(), block.begin(), block.end());
+    }
+
+    output.resize(size);
+    return Result<std::vector<uint8_t>>(output);
+}
+
+Result<std::vector<uint8_t>> CryptoModule::DeriveSlowKey(
+    const std::string &password,
+    const std::vector<uint8_t> &salt,
+    std::size_t size) {
+
+    StageTimer timer(Stats::Stage::KeyDerivation);
+    std::vector<uint8_t> output(size);
+    if (size == 0 || size > static_cast<std::size_t>(std::numeric_limits<int>::max()) ||
+        PKCS5_PBKDF2_HMAC(password.c_str(), static_cast<int>(password.size()),
+                          salt.data(), static_cast<int>(salt.size()),
+                          PBKDF2_ITERATIONS, EVP_sha256(),
+                          static_cast<int>(size), output.data()) != 1) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::EncryptionFailed,
+            "Key derivation failed"
+        );
+    }
+    return Result<std::vector<uint8_t>>(output);
+}
+
+Result<std::vector<uint8_t>> CryptoModule::RandomBytes(std::size_t size) {
+    std::vector<uint8_t> output(size);
+    if (size > static_cast<std::size_t>(std::numeric_limits<int>::max()) ||
+        RAND_bytes(output.data(), static_cast<int>(size)) != 1) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::EncryptionFailed,
+            "Cryptographic random number generation failed"
+        );
+    }
+    return Result<std::vector<uint8_t>>(output);
+}
+
+Result<uint16_t> CryptoModule::ComputeKeyCheck(const uint8_t *encryptedData, std::size_t size,
+                                               const std::string &password) {
+
+    if (size < static_cast<std::size_t>(MIN_SIZE)) {
+        return Result<uint16_t>(
+            ErrorCode::InvalidDataSize,
+            "Encrypted data too small for a key check"
+        );
+    }
+
+    // Salting the subkey keeps checks of different payloads independent
+    std::string context = "stegtool key check";
+    context.append(reinterpret_cast<const char *>(encryptedData), SALT_SIZE);
+    auto subkeyResult = DeriveSubkey(password, context, sizeof(uint32_t));
+    if (!subkeyResult) {
+        return Result<uint16_t>(subkeyResult.GetErrorCode(), subkeyResult.GetErrorMessage());
+    }
+
+    const auto &subkey = subkeyResult.GetValue();
+    uint32_t seed = static_cast<uint32_t>(subkey[0]) | (static_cast<uint32_t>(subkey[1]) << 8) |
+                    (static_cast<uint32_t>(subkey[2]) << 16) | (static_cast<uint32_t>(subkey[3]) << 24);
+    return Result<uint16_t>(static_cast<uint16_t>(Checksum::Crc32c(encryptedData, size, seed)));
+}
+
+Result<std::vector<uint8_t>> CryptoModule::AddKeyCheck(
+    const std::vector<uint8_t> &encryptedData,
+    const std::string &password) {
+
+    auto checkResult = ComputeKeyCheck(encryptedData.data(), encryptedData.size(), password);
+    if (!checkResult) {
+        return Result<std::vector<uint8_t>>(checkResult.GetErrorCode(), checkResult.GetErrorMessage());
+    }
+
+    uint16_t check = checkResult.GetValue();
+    std::vector<uint8_t> checkedData(KEY_CHECK_SIZE + encryptedData.size());
+    checkedData[0] = static_cast<uint8_t>(check);
+    checkedData[1] = static_cast<uint8_t>(check >> 8);
+    std::copy(encryptedData.begin(), encryptedData.end(), checkedData.begin() + KEY_CHECK_SIZE);
+    return Result<std::vector<uint8_t>>(checkedData);
+}
+
+Result<std::vector<uint8_t>> CryptoModule::VerifyKeyCheck(
+    const std::vector<uint8_t> &checkedData,
+    const std::string &password) {
+
+    if (checkedData.size() < static_cast<std::size_t>(KEY_CHECK_SIZE + MIN_SIZE)) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::InvalidDataSize,
+            "Encrypted data too small (corrupted or not encrypted)"
+        );
+    }
+
+    auto checkResult = ComputeKeyCheck(checkedData.data() + KEY_CHECK_SIZE,
+                                       checkedData.size() - KEY_CHECK_SIZE, password);
+    if (!checkResult) {
+        return Result<std::vector<uint8_t>>(checkResult.GetErrorCode(), checkResult.GetErrorMessage());
+    }
+
+    uint16_t stored = static_cast<uint16_t>(checkedData[0] | (checkedData[1] << 8));
+    if (stored != checkResult.GetValue()) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::AuthenticationFailed,
+            "Key check failed (incorrect password or corrupted data)"
+        );
+    }
+
+    return Result<std::vector<uint8_t>>(
+        std::vector<uint8_t>(checkedData.begin() + KEY_CHECK_SIZE, checkedData.end())
+    );
 }
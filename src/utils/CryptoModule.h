@@ -24,6 +24,7 @@ public:
     static constexpr int MIN_SIZE = SALT_SIZE + IV_SIZE + HMAC_SIZE + 1;        // At least 1 byte of ciphertext
     static constexpr int PBKDF2_ITERATIONS = 10000;                             // PBKDF2 iteration count
     static constexpr int ENCRYPTION_OVERHEAD = SALT_SIZE + IV_SIZE + HMAC_SIZE; // Bytes added during encryption
+    static constexpr int KEY_CHECK_SIZE = 2;                                    // Fast password check prefix (16 bits)
     
     CryptoModule() = delete;
     
@@ -32,6 +33,7 @@ public:
     *
     * The output format is: [salt | iv | ciphertext | hmac].
     * HMAC authenticates salt + iv + ciphertext using Encrypt-then-MAC.
+    * The output is the only allocation, every part is written into it in place.
     *
     * @param plainData Input plaintext data.
     * @param password Password used for key derivation.
@@ -57,7 +59,92 @@ public:
         const std::string &password
     );
 
+    /**
+    * @brief Derives deterministic key material from a password (HKDF-SHA256).
+    *
+    * Used for non-secret-at-rest keys such as PRNG seeds for embedding
+    * position/sign selection. The context string separates independent
+    * uses of the same password. Not a substitute for the PBKDF2 key used
+    * by EncryptData/DecryptData.
+    *
+    * @param password Input keying material.
+    * @param context Domain separation label (HKDF info).
+    * @param size Number of output bytes (at most 255 * 32).
+    * @return Result containing derived bytes or error
+    */
+    static Result<std::vector<uint8_t>> DeriveSubkey(
+        const std::string &password,
+        const std::string &context,
+        std::size_t size
+    );
+
+    /**
+    * @brief Derives key material from a password and salt (PBKDF2-HMAC-SHA256).
+    *
+    * Runs PBKDF2_ITERATIONS like EncryptData, for values stored in the clear
+    * that must cost a password guesser as much as the payload itself.
+    *
+    * @param password Input keying material.
+    * @param salt Salt, unique per use.
+    * @param size Number of output bytes.
+    * @return Result containing derived bytes or error
+    */
+    static Result<std::vector<uint8_t>> DeriveSlowKey(
+        const std::string &password,
+        const std::vector<uint8_t> &salt,
+        std::size_t size
+    );
+
+    /**
+    * @brief Cryptographically secure random bytes.
+    *
+    * @param size Number of bytes.
+    * @return Result containing the bytes or error
+    */
+    static Result<std::vector<uint8_t>> RandomBytes(std::size_t size);
+
+    /**
+    * @brief Prefixes encrypted data with a fast keyed check.
+    *
+    * The check is the low 16 bits of a CRC-32C over [salt | iv | ciphertext | hmac],
+    * seeded from an HKDF subkey of the password and salt. VerifyKeyCheck can then
+    * reject a wrong password with one HKDF call instead of the full PBKDF2 run.
+    * Being only 16 bits, the check lets through 1 in 65536 wrong passwords (the
+    * HMAC still rejects those).
+    *
+    * This weakens offline guessing: anyone holding the stego image can also test
+    * guesses with one HKDF call, which discards 65535 of 65536 wrong guesses, and
+    * run PBKDF2 only on the rest. A brute force against a checked payload is about
+    * 10^4 times cheaper than one against the HMAC alone, so use it only with
+    * passwords strong enough to survive that.
+    *
+    * @param encryptedData Output of EncryptData.
+    * @param password Password used for EncryptData.
+    * @return Result containing [check | encryptedData] or error
+    */
+    static Result<std::vector<uint8_t>> AddKeyCheck(
+        const std::vector<uint8_t> &encryptedData,
+        const std::string &password
+    );
+
+    /**
+    * @brief Verifies and strips the prefix written by AddKeyCheck.
+    *
+    * @param checkedData Data starting with the key check.
+    * @param password Password to test.
+    * @return Result containing the encrypted data for DecryptData, or
+    *         AuthenticationFailed when the check does not match
+    */
+    static Result<std::vector<uint8_t>> VerifyKeyCheck(
+        const std::vector<uint8_t> &checkedData,
+        const std::string &password
+    );
+
 private:
+    // Helper function to compute the AddKeyCheck value
+    static Result<uint16_t> ComputeKeyCheck(const uint8_t *encryptedData, std::size_t size,
+                                            const std::string &password);
+
     // Helper function to get OpenSSL error string
     static std::string GetOpenSSLError();
 };
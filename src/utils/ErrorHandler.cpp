@@ -68,6 +68,8 @@ std::string ErrorHandler::GetErrorDescription(ErrorCode code) {
             return "Data structure is corrupted or invalid";
         case ErrorCode::NoEmbeddedData:
             return "No embedded data found in image";
+        case ErrorCode::MethodMismatch:
+            return "Data was embedded with a different method";
             
         // General errors
         case ErrorCode::UnknownError:
@@ -76,6 +78,10 @@ std::string ErrorHandler::GetErrorDescription(ErrorCode code) {
             return "Invalid argument provided";
         case ErrorCode::NotImplemented:
             return "Feature not implemented";
+        case ErrorCode::OperationCancelled:
+            return "Operation was cancelled";
+        case ErrorCode::MemoryLimitExceeded:
+            return "Operation would exceed the memory limit";
             
         default:
             return "Undefined error";
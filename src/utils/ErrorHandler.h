@@ -38,11 +38,14 @@ enum class ErrorCode {
     InvalidDataSize = 502,
     CorruptedPayload = 503,
     NoEmbeddedData = 504,
+    MethodMismatch = 505,
     
     // General errors
     UnknownError = 900,
     InvalidArgument = 901,
-    NotImplemented = 902
+    NotImplemented = 902,
+    OperationCancelled = 903,
+    MemoryLimitExceeded = 904
 };
 
 
@@ -0,0 +1,229 @@
+#include "ImageDiff.h"
+#include "Parallel.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+constexpr std::array<uint8_t, 256> BuildBitCounts() {
+    std::array<uint8_t, 256> counts{};
+    for (std::size_t value = 1; value < counts.size(); ++value) {
+        counts[value] = static_cast<uint8_t>(counts[value / 2] + (value & 1));
+    }
+    return counts;
+}
+
+constexpr std::array<uint8_t, 256> BIT_COUNTS = BuildBitCounts();
+
+template <typename T>
+std::size_t CountChangedBitsScalar(const T *a, const T *b, std::size_t count, T planes) {
+    std::size_t total = 0;
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        T diff = static_cast<T>((a[idx] ^ b[idx]) & planes);
+        for (std::size_t shift = 0; shift < sizeof(T) * 8; shift += 8) {
+            total += BIT_COUNTS[(diff >> shift) & 0xFF];
+        }
+    }
+    return total;
+}
+
+#ifdef STEGTOOL_X86_SIMD
+
+/**
+ * Bit count per byte from two nibble lookups (pshufb), summed over 8 bytes at a time
+ * by psadbw against zero, so the accumulator never overflows.
+ */
+__attribute__((target("ssse3")))
+std::size_t CountChangedBitsSsse3(const uint8_t *a, const uint8_t *b, std::size_t count, uint8_t planes) {
+    const __m128i lookup = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i keep = _mm_set1_epi8(static_cast<char>(planes));
+    __m128i total = _mm_setzero_si128();
+
+    std::size_t idx = 0;
+    for (; idx + 16 <= count; idx += 16) {
+        __m128i diff = _mm_and_si128(_mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + idx)),
+                                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + idx))), keep);
+        __m128i bits = _mm_add_epi8(_mm_shuffle_epi8(lookup, _mm_and_si128(diff, nibble)),
+                                    _mm_shuffle_epi8(lookup, _mm_and_si128(_mm_srli_epi16(diff, 4), nibble)));
+        total = _mm_add_epi64(total, _mm_sad_epu8(bits, _mm_setzero_si128()));
+    }
+
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), total);
+    return static_cast<std::size_t>(lanes[0] + lanes[1]) + CountChangedBitsScalar(a + idx, b + idx, count - idx, planes);
+}
+
+__attribute__((target("avx2")))
+std::size_t CountChangedBitsAvx2(const uint8_t *a, const uint8_t *b, std::size_t count, uint8_t planes) {
+    // vpshufb looks up within each 128-bit lane, so both lanes get the same table
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i keep = _mm256_set1_epi8(static_cast<char>(planes));
+    __m256i total = _mm256_setzero_si256();
+
+    std::size_t idx = 0;
+    for (; idx + 32 <= count; idx += 32) {
+        __m256i diff = _mm256_and_si256(
+            _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + idx)),
+                             _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + idx))), keep);
+        __m256i bits = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(diff, nibble)),
+                                       _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(diff, 4), nibble)));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(bits, _mm256_setzero_si256()));
+    }
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), total);
+    return static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]) +
+           CountChangedBitsScalar(a + idx, b + idx, count - idx, planes);
+}
+
+#endif
+
+std::size_t CountChangedBitsPortable(const uint8_t *a, const uint8_t *b, std::size_t count, uint8_t planes) {
+    return CountChangedBitsScalar(a, b, count, planes);
+}
+
+using CountChangedBitsFn = std::size_t (*)(const uint8_t *, const uint8_t *, std::size_t, uint8_t);
+
+CountChangedBitsFn SelectCountChangedBits() {
+#ifdef STEGTOOL_X86_SIMD
+    switch (CpuFeatures::GetSimdLevel()) {
+        case SimdLevel::Avx2: return CountChangedBitsAvx2;
+        case SimdLevel::Ssse3: return CountChangedBitsSsse3;
+        case SimdLevel::Portable: break;
+    }
+#endif
+    return CountChangedBitsPortable;
+}
+
+std::size_t CountChangedBitsOf(const uint8_t *a, const uint8_t *b, std::size_t count, uint8_t planes) {
+    return ImageDiff::CountChangedBits(a, b, count, planes);
+}
+
+std::size_t CountChangedBitsOf(const uint16_t *a, const uint16_t *b, std::size_t count, uint16_t planes) {
+    return CountChangedBitsScalar(a, b, count, planes);
+}
+
+template <typename T>
+Result<> CheckPair(const BasicImageData<T> &cover, const BasicImageData<T> &stego, int block) {
+    if (cover.width != stego.width || cover.height != stego.height || cover.channels != stego.channels ||
+        cover.pixels.size() != stego.pixels.size()) {
+        return Result<>(ErrorCode::InvalidArgument, "Cover and stego image differ in size");
+    }
+    if (cover.pixels.size() != cover.GetPixelCount() || cover.pixels.empty()) {
+        return Result<>(ErrorCode::InvalidArgument, "Image has no samples or a wrong sample count");
+    }
+    if (block < 1) {
+        return Result<>(ErrorCode::InvalidArgument, "Block size must be at least 1");
+    }
+    return Result<>();
+}
+
+template <typename T>
+Result<ImageData> DifferenceOf(const BasicImageData<T> &cover, const BasicImageData<T> &stego, int block) {
+    auto check = CheckPair(cover, stego, block);
+    if (!check) {
+        return Result<ImageData>(check.GetErrorCode(), check.GetErrorMessage());
+    }
+
+    const std::size_t width = static_cast<std::size_t>(cover.width);
+    const std::size_t channels = static_cast<std::size_t>(cover.channels);
+    const std::size_t scale = static_cast<std::size_t>(block);
+    // Rounded up without forming width + block, which overflows for huge blocks
+    const int outWidth = (cover.width - 1) / block + 1;
+    const int outHeight = (cover.height - 1) / block + 1;
+    ImageData map(std::vector<uint8_t>(static_cast<std::size_t>(outWidth) * outHeight * channels),
+                  outWidth, outHeight, cover.channels);
+
+    // One task per block row: its rows of the output belong to it alone
+    Parallel::For(static_cast<std::size_t>(outHeight), [&](std::size_t outRow) {
+        uint8_t *out = map.pixels.data() + outRow * outWidth * channels;
+        std::size_t rowEnd = std::min(static_cast<std::size_t>(cover.height), (outRow + 1) * scale);
+        for (std::size_t row = outRow * scale; row < rowEnd; ++row) {
+            const T *a = cover.pixels.data() + row * width * channels;
+            const T *b = stego.pixels.data() + row * width * channels;
+            for (std::size_t x = 0; x < width; ++x) {
+                uint8_t *pixel = out + (x / scale) * channels;
+                for (std::size_t channel = 0; channel < channels; ++channel) {
+                    std::size_t idx = x * channels + channel;
+                    pixel[channel] |= static_cast<uint8_t>(-static_cast<int>(a[idx] != b[idx]));
+                }
+            }
+        }
+    });
+    return Result<ImageData>(std::move(map));
+}
+
+template <typename T>
+Result<ImageData> HeatmapOf(const BasicImageData<T> &cover, const BasicImageData<T> &stego, T planes,
+                            int bitsPerPixel, int block) {
+    auto check = CheckPair(cover, stego, block);
+    if (!check) {
+        return Result<ImageData>(check.GetErrorCode(), check.GetErrorMessage());
+    }
+    if (bitsPerPixel < 1) {
+        return Result<ImageData>(ErrorCode::InvalidArgument, "Pixels must carry at least one bit");
+    }
+
+    const std::size_t width = static_cast<std::size_t>(cover.width);
+    const std::size_t height = static_cast<std::size_t>(cover.height);
+    const std::size_t channels = static_cast<std::size_t>(cover.channels);
+    const std::size_t scale = static_cast<std::size_t>(block);
+    const int outWidth = (cover.width - 1) / block + 1;
+    const int outHeight = (cover.height - 1) / block + 1;
+    ImageData map(std::vector<uint8_t>(static_cast<std::size_t>(outWidth) * outHeight),
+                  outWidth, outHeight, 1);
+
+    Parallel::For(static_cast<std::size_t>(outHeight), [&](std::size_t outRow) {
+        std::vector<std::size_t> changed(static_cast<std::size_t>(outWidth), 0);
+        std::size_t rowBegin = outRow * scale;
+        std::size_t rowEnd = std::min(height, rowBegin + scale);
+        for (std::size_t row = rowBegin; row < rowEnd; ++row) {
+            const T *a = cover.pixels.data() + row * width * channels;
+            const T *b = stego.pixels.data() + row * width * channels;
+            for (std::size_t column = 0; column < changed.size(); ++column) {
+                std::size_t first = column * scale * channels;
+                std::size_t last = std::min(width, (column + 1) * scale) * channels;
+                changed[column] += CountChangedBitsOf(a + first, b + first, last - first, planes);
+            }
+        }
+
+        // Edge blocks are smaller, scale by the bits they actually have
+        uint8_t *out = map.pixels.data() + outRow * outWidth;
+        for (std::size_t column = 0; column < changed.size(); ++column) {
+            std::size_t blockWidth = std::min(width, (column + 1) * scale) - column * scale;
+            std::size_t bits = blockWidth * (rowEnd - rowBegin) * static_cast<std::size_t>(bitsPerPixel);
+            out[column] = static_cast<uint8_t>(std::min<std::size_t>(255, (changed[column] * 255 + bits / 2) / bits));
+        }
+    });
+    return Result<ImageData>(std::move(map));
+}
+
+} // namespace
+
+Result<ImageData> ImageDiff::Difference(const ImageData &cover, const ImageData &stego, int block) {
+    return DifferenceOf(cover, stego, block);
+}
+
+Result<ImageData> ImageDiff::Difference(const ImageData16 &cover, const ImageData16 &stego, int block) {
+    return DifferenceOf(cover, stego, block);
+}
+
+Result<ImageData> ImageDiff::Heatmap(const ImageData &cover, const ImageData &stego, uint8_t planes,
+                                     int bitsPerPixel, int block) {
+    return HeatmapOf(cover, stego, planes, bitsPerPixel, block);
+}
+
+Result<ImageData> ImageDiff::Heatmap(const ImageData16 &cover, const ImageData16 &stego, uint16_t planes,
+                                     int bitsPerPixel, int block) {
+    return HeatmapOf(cover, stego, planes, bitsPerPixel, block);
+}
+
+std::size_t ImageDiff::CountChangedBits(const uint8_t *a, const uint8_t *b, std::size_t count, uint8_t planes) {
+    const CountChangedBitsFn kernel = SelectCountChangedBits();
+    return kernel(a, b, count, planes);
+}
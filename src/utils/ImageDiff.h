@@ -0,0 +1,59 @@
+#ifndef __IMAGE_DIFF_H_
+#define __IMAGE_DIFF_H_
+
+#include "ErrorHandler.h"
+#include "ImageIO.h"
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Static class comparing a cover with its stego image, at reduced resolution.
+ *
+ * Both images are walked once in parallel tiles of whole block rows; each tile
+ * reduces its blocks on its own, so no full resolution result is ever built.
+ */
+class ImageDiff {
+public:
+    ImageDiff() = delete;
+
+    /**
+     * @brief Difference map: a sample is 255 where any sample of its block changed.
+     *
+     * @param cover Original image
+     * @param stego Same image after embedding
+     * @param block Width and height of the blocks, 1 for full resolution
+     * @return Result containing an 8-bit image of ceil(width/block) x ceil(height/block)
+     *         with the cover's channels, or an error if the images do not match
+     */
+    static Result<ImageData> Difference(const ImageData &cover, const ImageData &stego, int block);
+    static Result<ImageData> Difference(const ImageData16 &cover, const ImageData16 &stego, int block);
+
+    /**
+     * @brief Heatmap: share of the embedding bits each block had changed, 0 (none) to 255 (all).
+     *
+     * A payload of random bits changes about half of the bits it is written to,
+     * so fully used blocks show as mid gray.
+     *
+     * @param cover Original image
+     * @param stego Same image after embedding
+     * @param planes Bits of each sample that carry data
+     * @param bitsPerPixel Bits of each pixel that carry data, over all its channels
+     * @param block Width and height of the blocks
+     * @return Result containing a grayscale image of ceil(width/block) x ceil(height/block),
+     *         or an error if the images do not match
+     */
+    static Result<ImageData> Heatmap(const ImageData &cover, const ImageData &stego, uint8_t planes,
+                                     int bitsPerPixel, int block);
+    static Result<ImageData> Heatmap(const ImageData16 &cover, const ImageData16 &stego, uint16_t planes,
+                                     int bitsPerPixel, int block);
+
+    /**
+     * @brief Count the bits within 'planes' that differ between a and b.
+     *
+     * Uses SSSE3 or AVX2 when the CPU has them, a lookup table otherwise.
+     */
+    static std::size_t CountChangedBits(const uint8_t *a, const uint8_t *b, std::size_t count, uint8_t planes);
+};
+
+#endif // __IMAGE_DIFF_H_
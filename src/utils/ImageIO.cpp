@@ -1,4 +1,5 @@
 #include "ImageIO.h"
+#include "Stats.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -7,10 +8,33 @@
 #include "stb_image_write.h"
 
 #include <sstream>
+#include <fstream>
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <limits>
+
+namespace {
+
+void AppendUint32BE(std::vector<uint8_t> &out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void AppendChunk(std::vector<uint8_t> &png, const char *type, const uint8_t *payload, std::size_t length) {
+    AppendUint32BE(png, static_cast<uint32_t>(length));
+    std::size_t typeStart = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), payload, payload + length);
+    AppendUint32BE(png, ImageIO::PngCrc(png.data() + typeStart, length + 4));
+}
+
+} // namespace
 
 Result<ImageData> ImageIO::Load(const std::string &filename) {
+    StageTimer timer(Stats::Stage::ImageDecode);
     int width = 0, height = 0, channels = 0;
     
     unsigned char *data = stbi_load(filename.c_str(), &width, &height, &channels, 0);
@@ -45,7 +69,164 @@ Result<ImageData> ImageIO::Load(const std::string &filename) {
     
     stbi_image_free(data);
     
-    return Result<ImageData>(imageData);
+    timer.AddBytes(dataSize);
+    return Result<ImageData>(std::move(imageData));
+}
+
+Result<ImageData> ImageIO::Probe(const std::string &filename) {
+    int width = 0, height = 0, channels = 0;
+    if (!stbi_info(filename.c_str(), &width, &height, &channels) || width <= 0 || height <= 0 || channels <= 0) {
+        const char* stbError = stbi_failure_reason();
+        std::ostringstream oss;
+        oss << "Failed to read image header of '" << filename << "'. ";
+        if (stbError) {
+            oss << "Reason: " << stbError;
+        } else {
+            oss << "File may not exist or format is unsupported.";
+        }
+        return Result<ImageData>(ErrorCode::ImageLoadFailed, oss.str());
+    }
+
+    ImageData header;
+    header.width = width;
+    header.height = height;
+    header.channels = channels;
+    return Result<ImageData>(std::move(header));
+}
+
+Result<ImageData16> ImageIO::Load16(const std::string &filename) {
+    StageTimer timer(Stats::Stage::ImageDecode);
+    int width = 0, height = 0, channels = 0;
+    
+    stbi_us *data = stbi_load_16(filename.c_str(), &width, &height, &channels, 0);
+    
+    if (!data) {
+        const char* stbError = stbi_failure_reason();
+        std::ostringstream oss;
+        oss << "Failed to load image '" << filename << "'. ";
+        if (stbError) {
+            oss << "Reason: " << stbError;
+        } else {
+            oss << "File may not exist or format is unsupported.";
+        }
+        return Result<ImageData16>(ErrorCode::ImageLoadFailed, oss.str());
+    }
+    
+    if (width <= 0 || height <= 0 || channels <= 0) {
+        stbi_image_free(data);
+        std::ostringstream oss;
+        oss << "Image loaded but has invalid dimensions: " 
+            << width << "x" << height << "x" << channels;
+        return Result<ImageData16>(ErrorCode::InvalidImageDimensions, oss.str());
+    }
+    
+    ImageData16 imageData;
+    imageData.width = width;
+    imageData.height = height;
+    imageData.channels = channels;
+    
+    std::size_t dataSize = static_cast<std::size_t>(width) * height * channels;
+    imageData.pixels.assign(data, data + dataSize);
+    
+    stbi_image_free(data);
+    
+    timer.AddBytes(dataSize * sizeof(uint16_t));
+    return Result<ImageData16>(std::move(imageData));
+}
+
+bool ImageIO::Is16Bit(const std::string &filename) {
+    return stbi_is_16_bit(filename.c_str()) != 0;
+}
+
+Result<> ImageIO::Save(const std::string &filename, const ImageData16 &data) {
+    
+    StageTimer timer(Stats::Stage::ImageEncode, data.pixels.size() * sizeof(uint16_t));
+
+    if (data.pixels.empty()) {
+        return Result<>(ErrorCode::InvalidArgument, "Cannot save image: pixel data is empty");
+    }
+    
+    if (data.width <= 0 || data.height <= 0 || data.channels <= 0 || data.channels > 4) {
+        std::ostringstream oss;
+        oss << "Cannot save image: invalid dimensions " 
+            << data.width << "x" << data.height << "x" << data.channels;
+        return Result<>(ErrorCode::InvalidImageDimensions, oss.str());
+    }
+    
+    if (data.pixels.size() != data.GetPixelCount()) {
+        std::ostringstream oss;
+        oss << "Cannot save image: pixel data size mismatch. "
+            << "Expected " << data.GetPixelCount() << " samples, got " << data.pixels.size() << " samples";
+        return Result<>(ErrorCode::ImageCorrupted, oss.str());
+    }
+    
+    if (GetExtension(filename) != "png") {
+        return Result<>(
+            ErrorCode::UnsupportedImageFormat,
+            "16-bit images can only be saved as PNG, not '" + filename + "'"
+        );
+    }
+
+    // Scanlines: Sub filter on big-endian samples (bytes per pixel = 2 * channels)
+    std::size_t bytesPerPixel = static_cast<std::size_t>(data.channels) * 2;
+    std::size_t rowBytes = static_cast<std::size_t>(data.width) * bytesPerPixel;
+    std::size_t rawSize = (rowBytes + 1) * data.height;
+    if (rawSize > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        return Result<>(ErrorCode::ImageSaveFailed, "Cannot save image: 16-bit PNG data exceeds 2 GB");
+    }
+
+    std::vector<uint8_t> raw(rawSize);
+    std::vector<uint8_t> row(rowBytes);
+    for (int y = 0; y < data.height; ++y) {
+        const uint16_t *samples = data.pixels.data() + static_cast<std::size_t>(y) * data.width * data.channels;
+        for (std::size_t idx = 0; idx < rowBytes / 2; ++idx) {
+            row[idx * 2] = static_cast<uint8_t>(samples[idx] >> 8);
+            row[idx * 2 + 1] = static_cast<uint8_t>(samples[idx] & 0xFF);
+        }
+
+        uint8_t *out = raw.data() + static_cast<std::size_t>(y) * (rowBytes + 1);
+        out[0] = 1;
+        for (std::size_t idx = 0; idx < rowBytes; ++idx) {
+            uint8_t left = idx >= bytesPerPixel ? row[idx - bytesPerPixel] : 0;
+            out[idx + 1] = static_cast<uint8_t>(row[idx] - left);
+        }
+    }
+
+    int compressedSize = 0;
+    unsigned char *compressed = stbi_zlib_compress(raw.data(), static_cast<int>(raw.size()), &compressedSize, 8);
+    if (!compressed) {
+        return Result<>(ErrorCode::ImageSaveFailed, "Failed to compress 16-bit PNG data");
+    }
+
+    static const uint8_t COLOR_TYPES[] = {0, 4, 2, 6};  // grey, grey+alpha, RGB, RGBA
+    std::vector<uint8_t> header;
+    AppendUint32BE(header, static_cast<uint32_t>(data.width));
+    AppendUint32BE(header, static_cast<uint32_t>(data.height));
+    header.push_back(16);                               // bit depth
+    header.push_back(COLOR_TYPES[data.channels - 1]);
+    header.push_back(0);                                // deflate
+    header.push_back(0);                                // adaptive filtering
+    header.push_back(0);                                // no interlace
+
+    static const uint8_t SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> png(SIGNATURE, SIGNATURE + sizeof(SIGNATURE));
+    AppendChunk(png, "IHDR", header.data(), header.size());
+    AppendChunk(png, "IDAT", compressed, static_cast<std::size_t>(compressedSize));
+    AppendChunk(png, "IEND", nullptr, 0);
+    STBIW_FREE(compressed);
+
+    std::ofstream file(filename, std::ios::binary);
+    if (file) {
+        file.write(reinterpret_cast<const char *>(png.data()), static_cast<std::streamsize>(png.size()));
+    }
+    if (!file) {
+        return Result<>(
+            ErrorCode::ImageSaveFailed,
+            "Failed to save image to '" + filename + "'. Check write permissions and disk space."
+        );
+    }
+    
+    return Result<>();
 }
 
 Result<> ImageIO::Save(const std::string &filename, const ImageData &data) {
@@ -56,6 +237,8 @@ Result<> ImageIO::Save(const std::string &filename,
                        const std::vector<uint8_t> &pixels,
                        int width, int height, int channels) {
     
+    StageTimer timer(Stats::Stage::ImageEncode, pixels.size());
+
     if (pixels.empty()) {
         return Result<>(ErrorCode::InvalidArgument, "Cannot save image: pixel data is empty");
     }
@@ -133,3 +316,58 @@ std::string ImageIO::GetExtension(const std::string &filename) {
     
     return ext;
 }
+
+Result<std::vector<uint8_t>> ImageIO::ZlibCompress(const std::vector<uint8_t> &data) {
+
+    if (data.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        return Result<std::vector<uint8_t>>(ErrorCode::InvalidArgument, "Cannot compress more than 2 GB at once");
+    }
+
+    int compressedSize = 0;
+    unsigned char *compressed = stbi_zlib_compress(const_cast<unsigned char *>(data.data()),
+                                                   static_cast<int>(data.size()), &compressedSize, 8);
+    if (!compressed) {
+        return Result<std::vector<uint8_t>>(ErrorCode::ImageSaveFailed, "zlib compression failed");
+    }
+
+    std::vector<uint8_t> result(compressed, compressed + compressedSize);
+    STBIW_FREE(compressed);
+    return Result<std::vector<uint8_t>>(std::move(result));
+}
+
+Result<std::vector<uint8_t>> ImageIO::ZlibDecompress(const std::vector<uint8_t> &data, std::size_t decodedSize) {
+
+    if (data.size() > static_cast<std::size_t>(std::numeric_limits<int>::max()) ||
+        decodedSize > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        return Result<std::vector<uint8_t>>(ErrorCode::InvalidArgument, "Cannot decompress more than 2 GB at once");
+    }
+
+    std::vector<uint8_t> result(decodedSize);
+    int written = stbi_zlib_decode_buffer(reinterpret_cast<char *>(result.data()), static_cast<int>(result.size()),
+                                          reinterpret_cast<const char *>(data.data()), static_cast<int>(data.size()));
+    if (written < 0 || static_cast<std::size_t>(written) != decodedSize) {
+        return Result<std::vector<uint8_t>>(ErrorCode::ImageCorrupted, "zlib stream is corrupted or has an unexpected size");
+    }
+    return Result<std::vector<uint8_t>>(std::move(result));
+}
+
+uint32_t ImageIO::PngCrc(const uint8_t *data, std::size_t length, uint32_t crc) {
+    // CRC-32, polynomial 0xEDB88320
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> entries{};
+        for (uint32_t idx = 0; idx < 256; ++idx) {
+            uint32_t value = idx;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            entries[idx] = value;
+        }
+        return entries;
+    }();
+
+    crc = ~crc;
+    for (std::size_t idx = 0; idx < length; ++idx) {
+        crc = table[(crc ^ data[idx]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
@@ -4,20 +4,25 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <utility>
 #include "ErrorHandler.h"
 
-// Represents image data with metadata.
-struct ImageData {
+// Represents image data with metadata, for 8-bit (uint8_t) or 16-bit (uint16_t) samples.
+template <typename T>
+struct BasicImageData {
 public:
-    std::vector<uint8_t> pixels;
+    using SampleType = T;
+    static constexpr int BIT_DEPTH = static_cast<int>(sizeof(T) * 8);
+
+    std::vector<T> pixels;
     int width;
     int height;
     int channels;
 
-    ImageData() = default;
+    BasicImageData() = default;
 
-    explicit ImageData( std::vector<uint8_t> pixels, int width, int height, int channels )
-        : pixels (pixels),
+    explicit BasicImageData( std::vector<T> pixels, int width, int height, int channels )
+        : pixels (std::move(pixels)),
           width (width),
           height (height),
           channels (channels) 
@@ -81,10 +86,13 @@ public:
     }
 };
 
+using ImageData = BasicImageData<uint8_t>;
+using ImageData16 = BasicImageData<uint16_t>;
+
 /**
  * @brief Image I/O operations with comprehensive error handling.
  * 
- * Supports PNG, BMP, and JPEG formats.
+ * Supports PNG, BMP, and JPEG formats. 16-bit samples are supported for PNG only.
  */
 class ImageIO {
 public:
@@ -95,6 +103,32 @@ public:
      * @return Result containing ImageData on success or detailed error
      */
     static Result<ImageData> Load(const std::string &filename);
+
+    /**
+     * @brief Read an image's dimensions without decoding its pixels.
+     * 
+     * @param filename Path to the image file
+     * @return Result containing ImageData with width, height and channels set and no pixels
+     */
+    static Result<ImageData> Probe(const std::string &filename);
+
+    /**
+     * @brief Load an image file with 16-bit samples.
+     * 
+     * 16-bit PNGs keep their full precision; 8-bit images are scaled to 16 bits.
+     * 
+     * @param filename Path to the image file
+     * @return Result containing ImageData16 on success or detailed error
+     */
+    static Result<ImageData16> Load16(const std::string &filename);
+
+    /**
+     * @brief Check whether an image file stores 16-bit samples.
+     * 
+     * @param filename Path to the image file
+     * @return true for 16-bit images (e.g. 16-bit PNG)
+     */
+    static bool Is16Bit(const std::string &filename);
     
     /**
      * @brief Save image data to a file.
@@ -106,6 +140,15 @@ public:
      * @return Result indicating success or detailed error
      */
     static Result<> Save(const std::string &filename, const ImageData &data);
+
+    /**
+     * @brief Save 16-bit image data to a PNG file.
+     * 
+     * @param filename Output file path (.png)
+     * @param data Image data to save
+     * @return Result indicating success or detailed error
+     */
+    static Result<> Save(const std::string &filename, const ImageData16 &data);
     
     /**
      * @brief Save image data to a file
@@ -120,6 +163,33 @@ public:
     static Result<> Save(const std::string &filename,
                          const std::vector<uint8_t> &pixels,
                          int width, int height, int channels);
+
+    /**
+     * @brief zlib-compress a buffer (PNG IDAT/fdAT payload).
+     * 
+     * @param data Bytes to compress
+     * @return Result containing the zlib stream or error
+     */
+    static Result<std::vector<uint8_t>> ZlibCompress(const std::vector<uint8_t> &data);
+
+    /**
+     * @brief Decompress a zlib stream whose decoded size is known in advance.
+     * 
+     * @param data zlib stream (e.g. concatenated IDAT payloads)
+     * @param decodedSize Expected number of decoded bytes
+     * @return Result containing exactly decodedSize bytes or error
+     */
+    static Result<std::vector<uint8_t>> ZlibDecompress(const std::vector<uint8_t> &data, std::size_t decodedSize);
+
+    /**
+     * @brief CRC-32 of a PNG chunk (type and payload bytes).
+     * 
+     * @param data Bytes to checksum
+     * @param length Number of bytes
+     * @param crc CRC of the preceding bytes, to continue a running checksum
+     * @return Updated CRC
+     */
+    static uint32_t PngCrc(const uint8_t *data, std::size_t length, uint32_t crc = 0);
     
                          
     private:
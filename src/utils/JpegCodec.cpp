@@ -0,0 +1,771 @@
+#include "JpegCodec.h"
+#include "Stats.h"
+
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+namespace {
+
+constexpr uint8_t MARKER_SOF0 = 0xC0;   // Baseline DCT
+constexpr uint8_t MARKER_SOF1 = 0xC1;   // Extended sequential DCT, Huffman
+constexpr uint8_t MARKER_DHT  = 0xC4;
+constexpr uint8_t MARKER_DAC  = 0xCC;
+constexpr uint8_t MARKER_RST0 = 0xD0;
+constexpr uint8_t MARKER_RST7 = 0xD7;
+constexpr uint8_t MARKER_SOI  = 0xD8;
+constexpr uint8_t MARKER_EOI  = 0xD9;
+constexpr uint8_t MARKER_SOS  = 0xDA;
+constexpr uint8_t MARKER_DRI  = 0xDD;
+constexpr uint8_t MARKER_TEM  = 0x01;
+
+constexpr int MAX_HUFFMAN_TABLES = 4;
+constexpr int MAX_CODE_LENGTH = 16;
+constexpr int LOOKUP_BITS = 9;
+constexpr uint8_t SYMBOL_EOB = 0x00;
+constexpr uint8_t SYMBOL_ZRL = 0xF0;
+
+/**
+ * Canonical Huffman table with both decoding and encoding views.
+ */
+struct HuffmanTable {
+    bool defined = false;
+    std::vector<uint8_t> symbols;
+    std::array<int32_t, MAX_CODE_LENGTH + 2> maxCode{};     // Largest code of each length, -1 if none
+    std::array<int32_t, MAX_CODE_LENGTH + 1> valueOffset{}; // symbols index = code + valueOffset[length]
+    std::array<uint16_t, 1 << LOOKUP_BITS> lookup{};        // (length << 8) | symbol for short codes, 0 if long
+    std::array<uint16_t, 256> code{};
+    std::array<uint8_t, 256> codeSize{};                    // 0 if the symbol is not in the table
+};
+
+struct HuffmanTableSet {
+    std::array<HuffmanTable, MAX_HUFFMAN_TABLES> dc;
+    std::array<HuffmanTable, MAX_HUFFMAN_TABLES> ac;
+    int restartInterval = 0;
+};
+
+struct ScanComponent {
+    std::size_t index;
+    const HuffmanTable *dcTable;
+    const HuffmanTable *acTable;
+};
+
+struct ScanLayout {
+    std::vector<ScanComponent> components;
+    int mcusX = 0;
+    int mcusY = 0;
+};
+
+inline uint16_t ReadBE16(const uint8_t *bytes) {
+    return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+}
+
+inline int CeilDiv(int value, int divisor) {
+    return (value + divisor - 1) / divisor;
+}
+
+inline int BitLength(uint32_t value) {
+    int length = 0;
+    while (value != 0) {
+        ++length;
+        value >>= 1;
+    }
+    return length;
+}
+
+inline bool IsUnsupportedFrame(uint8_t marker) {
+    // Progressive, lossless, hierarchical and arithmetic coded frames
+    return (marker >= 0xC2 && marker <= 0xCF) && marker != MARKER_DHT && marker != 0xC8 && marker != MARKER_DAC;
+}
+
+bool BuildHuffmanTable(HuffmanTable &table, const uint8_t *counts, const uint8_t *symbols, std::size_t symbolCount) {
+    table = HuffmanTable();
+    table.symbols.assign(symbols, symbols + symbolCount);
+    table.maxCode.fill(-1);
+
+    uint32_t code = 0;
+    std::size_t symbolIdx = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; ++length) {
+        table.valueOffset[length] = static_cast<int32_t>(symbolIdx) - static_cast<int32_t>(code);
+        for (int count = 0; count < counts[length - 1]; ++count, ++symbolIdx, ++code) {
+            // Codes of this length must fit in 'length' bits
+            if (code >= (1u << length)) {
+                return false;
+            }
+            uint8_t symbol = symbols[symbolIdx];
+            table.code[symbol] = static_cast<uint16_t>(code);
+            table.codeSize[symbol] = static_cast<uint8_t>(length);
+
+            if (length <= LOOKUP_BITS) {
+                uint32_t first = code << (LOOKUP_BITS - length);
+                uint32_t span = 1u << (LOOKUP_BITS - length);
+                for (uint32_t entry = first; entry < first + span; ++entry) {
+                    table.lookup[entry] = static_cast<uint16_t>((length << 8) | symbol);
+                }
+            }
+        }
+        if (counts[length - 1] != 0) {
+            table.maxCode[length] = static_cast<int32_t>(code) - 1;
+        }
+        code <<= 1;
+    }
+
+    table.defined = true;
+    return true;
+}
+
+Result<> ParseHuffmanTables(const std::vector<uint8_t> &payload, HuffmanTableSet &tables) {
+    std::size_t pos = 0;
+    while (pos < payload.size()) {
+        if (pos + 1 + MAX_CODE_LENGTH > payload.size()) {
+            return Result<>(ErrorCode::ImageCorrupted, "Truncated DHT segment");
+        }
+        uint8_t tableClass = payload[pos] >> 4;
+        uint8_t tableId = payload[pos] & 0x0F;
+        if (tableClass > 1 || tableId >= MAX_HUFFMAN_TABLES) {
+            return Result<>(ErrorCode::ImageCorrupted, "Invalid Huffman table class or id in DHT segment");
+        }
+
+        const uint8_t *counts = payload.data() + pos + 1;
+        std::size_t symbolCount = 0;
+        for (int length = 0; length < MAX_CODE_LENGTH; ++length) {
+            symbolCount += counts[length];
+        }
+        pos += 1 + MAX_CODE_LENGTH;
+        if (symbolCount > 256 || pos + symbolCount > payload.size()) {
+            return Result<>(ErrorCode::ImageCorrupted, "Invalid symbol count in DHT segment");
+        }
+
+        HuffmanTable &table = (tableClass == 0) ? tables.dc[tableId] : tables.ac[tableId];
+        if (!BuildHuffmanTable(table, counts, payload.data() + pos, symbolCount)) {
+            return Result<>(ErrorCode::ImageCorrupted, "Huffman table in DHT segment is not a valid prefix code");
+        }
+        pos += symbolCount;
+    }
+    return Result<>();
+}
+
+Result<> ParseFrameHeader(const std::vector<uint8_t> &payload, JpegCoefficientData &data) {
+    if (payload.size() < 6) {
+        return Result<>(ErrorCode::ImageCorrupted, "Truncated SOF segment");
+    }
+    if (payload[0] != 8) {
+        std::ostringstream oss;
+        oss << "Unsupported JPEG sample precision: " << static_cast<int>(payload[0]) << " bits (only 8-bit supported)";
+        return Result<>(ErrorCode::UnsupportedImageFormat, oss.str());
+    }
+
+    data.height = ReadBE16(payload.data() + 1);
+    data.width = ReadBE16(payload.data() + 3);
+    std::size_t componentCount = payload[5];
+    if (data.width == 0 || data.height == 0) {
+        return Result<>(ErrorCode::InvalidImageDimensions, "JPEG frame has zero width or height (DNL not supported)");
+    }
+    if (componentCount == 0 || payload.size() < 6 + componentCount * 3) {
+        return Result<>(ErrorCode::ImageCorrupted, "Invalid component list in SOF segment");
+    }
+
+    data.components.resize(componentCount);
+    for (std::size_t idx = 0; idx < componentCount; ++idx) {
+        const uint8_t *entry = payload.data() + 6 + idx * 3;
+        JpegComponent &component = data.components[idx];
+        component.id = entry[0];
+        component.hSampling = entry[1] >> 4;
+        component.vSampling = entry[1] & 0x0F;
+        if (component.hSampling < 1 || component.hSampling > 4 ||
+            component.vSampling < 1 || component.vSampling > 4) {
+            return Result<>(ErrorCode::ImageCorrupted, "Invalid sampling factors in SOF segment");
+        }
+        data.maxHSampling = std::max(data.maxHSampling, component.hSampling);
+        data.maxVSampling = std::max(data.maxVSampling, component.vSampling);
+    }
+
+    // Allocate the MCU-padded block grid of every component
+    int mcusX = CeilDiv(data.width, 8 * data.maxHSampling);
+    int mcusY = CeilDiv(data.height, 8 * data.maxVSampling);
+    for (auto &component : data.components) {
+        component.blocksWide = mcusX * component.hSampling;
+        component.blocksHigh = mcusY * component.vSampling;
+        component.coefficients.assign(component.GetBlockCount() * JpegComponent::BLOCK_SIZE, 0);
+    }
+    return Result<>();
+}
+
+Result<ScanLayout> ParseScanHeader(const std::vector<uint8_t> &payload,
+                                   const JpegCoefficientData &data,
+                                   const HuffmanTableSet &tables) {
+    if (data.components.empty()) {
+        return Result<ScanLayout>(ErrorCode::ImageCorrupted, "SOS segment found before SOF segment");
+    }
+    if (payload.empty() || payload.size() < 1 + payload[0] * 2u + 3) {
+        return Result<ScanLayout>(ErrorCode::ImageCorrupted, "Truncated SOS segment");
+    }
+
+    ScanLayout layout;
+    std::size_t componentCount = payload[0];
+    if (componentCount == 0 || componentCount > 4) {
+        return Result<ScanLayout>(ErrorCode::ImageCorrupted, "Invalid component count in SOS segment");
+    }
+
+    for (std::size_t idx = 0; idx < componentCount; ++idx) {
+        uint8_t id = payload[1 + idx * 2];
+        uint8_t dcId = payload[2 + idx * 2] >> 4;
+        uint8_t acId = payload[2 + idx * 2] & 0x0F;
+
+        std::size_t componentIdx = 0;
+        while (componentIdx < data.components.size() && data.components[componentIdx].id != id) {
+            ++componentIdx;
+        }
+        if (componentIdx == data.components.size()) {
+            return Result<ScanLayout>(ErrorCode::ImageCorrupted, "SOS segment references an unknown component");
+        }
+        if (dcId >= MAX_HUFFMAN_TABLES || acId >= MAX_HUFFMAN_TABLES ||
+            !tables.dc[dcId].defined || !tables.ac[acId].defined) {
+            return Result<ScanLayout>(ErrorCode::ImageCorrupted, "SOS segment references an undefined Huffman table");
+        }
+        layout.components.push_back({componentIdx, &tables.dc[dcId], &tables.ac[acId]});
+    }
+
+    const uint8_t *spectral = payload.data() + 1 + componentCount * 2;
+    if (spectral[0] != 0 || spectral[1] != 63 || spectral[2] != 0) {
+        return Result<ScanLayout>(ErrorCode::UnsupportedImageFormat, "Only sequential JPEG scans are supported");
+    }
+
+    if (componentCount == 1) {
+        // Non-interleaved scan: one block per MCU over the component's own extent
+        const JpegComponent &component = data.components[layout.components[0].index];
+        layout.mcusX = CeilDiv(CeilDiv(data.width * component.hSampling, data.maxHSampling), 8);
+        layout.mcusY = CeilDiv(CeilDiv(data.height * component.vSampling, data.maxVSampling), 8);
+    } else {
+        layout.mcusX = CeilDiv(data.width, 8 * data.maxHSampling);
+        layout.mcusY = CeilDiv(data.height, 8 * data.maxVSampling);
+    }
+    return Result<ScanLayout>(layout);
+}
+
+/**
+ * Visit every block of a scan in coding order.
+ * blockFn(scanComponent, block) codes one block, restartFn() handles a restart marker.
+ */
+template <typename Data, typename BlockFn, typename RestartFn>
+bool ForEachScanBlock(Data &data, const ScanLayout &layout, int restartInterval,
+                      BlockFn &&blockFn, RestartFn &&restartFn) {
+    bool interleaved = layout.components.size() > 1;
+    std::size_t mcuCount = static_cast<std::size_t>(layout.mcusX) * layout.mcusY;
+
+    for (std::size_t mcu = 0; mcu < mcuCount; ++mcu) {
+        if (restartInterval > 0 && mcu > 0 && mcu % static_cast<std::size_t>(restartInterval) == 0) {
+            if (!restartFn()) {
+                return false;
+            }
+        }
+
+        int mcuX = static_cast<int>(mcu % static_cast<std::size_t>(layout.mcusX));
+        int mcuY = static_cast<int>(mcu / static_cast<std::size_t>(layout.mcusX));
+        for (const auto &scanComponent : layout.components) {
+            auto &component = data.components[scanComponent.index];
+            if (!interleaved) {
+                if (!blockFn(scanComponent, component.Block(mcuX, mcuY))) {
+                    return false;
+                }
+                continue;
+            }
+            for (int v = 0; v < component.vSampling; ++v) {
+                for (int h = 0; h < component.hSampling; ++h) {
+                    int blockX = mcuX * component.hSampling + h;
+                    int blockY = mcuY * component.vSampling + v;
+                    if (!blockFn(scanComponent, component.Block(blockX, blockY))) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * MSB-first bit reader over entropy coded data. Removes 0xFF00 stuffing and
+ * stops at the next marker, feeding zero bits past it.
+ */
+class BitReader {
+public:
+    BitReader(const uint8_t *data, std::size_t end, std::size_t start)
+        : data_(data), end_(end), pos_(start) {}
+
+    inline void Ensure(int bits) {
+        while (bitCount_ < bits) {
+            uint8_t byte = 0;
+            if (!atMarker_ && pos_ < end_) {
+                byte = data_[pos_];
+                if (byte == 0xFF) {
+                    uint8_t next = (pos_ + 1 < end_) ? data_[pos_ + 1] : 0xD9;
+                    if (next == 0x00) {
+                        pos_ += 2;
+                    } else {
+                        atMarker_ = true;
+                        byte = 0;
+                        ++phantomBytes_;
+                    }
+                } else {
+                    ++pos_;
+                }
+            } else {
+                ++phantomBytes_;
+            }
+            buffer_ |= static_cast<uint64_t>(byte) << (56 - bitCount_);
+            bitCount_ += 8;
+        }
+    }
+
+    inline uint32_t Peek(int bits) const {
+        return static_cast<uint32_t>(buffer_ >> (64 - bits));
+    }
+
+    inline void Skip(int bits) {
+        buffer_ <<= bits;
+        bitCount_ -= bits;
+    }
+
+    inline uint32_t Get(int bits) {
+        Ensure(bits);
+        uint32_t value = Peek(bits);
+        Skip(bits);
+        return value;
+    }
+
+    /**
+     * True once bits past the end of the entropy coded data have been consumed.
+     */
+    bool Overrun() const {
+        return static_cast<int64_t>(phantomBytes_) * 8 > bitCount_;
+    }
+
+    /**
+     * Discard the remaining bits of this interval and step over the RSTn marker.
+     */
+    bool Restart() {
+        if (Overrun()) {
+            return false;
+        }
+        buffer_ = 0;
+        bitCount_ = 0;
+        phantomBytes_ = 0;
+        while (pos_ + 1 < end_ && !(data_[pos_] == 0xFF && data_[pos_ + 1] >= MARKER_RST0 && data_[pos_ + 1] <= MARKER_RST7)) {
+            ++pos_;
+        }
+        if (pos_ + 1 >= end_) {
+            return false;
+        }
+        pos_ += 2;
+        atMarker_ = false;
+        return true;
+    }
+
+private:
+    const uint8_t *data_;
+    std::size_t end_;
+    std::size_t pos_;
+    uint64_t buffer_ = 0;
+    int bitCount_ = 0;
+    std::size_t phantomBytes_ = 0;
+    bool atMarker_ = false;
+};
+
+/**
+ * MSB-first bit writer with 0xFF byte stuffing.
+ */
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t> &out) : out_(out) {}
+
+    inline void Put(uint32_t bits, int count) {
+        buffer_ = (buffer_ << count) | (bits & ((1u << count) - 1));
+        bitCount_ += count;
+        while (bitCount_ >= 8) {
+            uint8_t byte = static_cast<uint8_t>(buffer_ >> (bitCount_ - 8));
+            out_.push_back(byte);
+            if (byte == 0xFF) {
+                out_.push_back(0x00);
+            }
+            bitCount_ -= 8;
+        }
+    }
+
+    /**
+     * Pad the last byte with 1 bits.
+     */
+    void Flush() {
+        if (bitCount_ > 0) {
+            Put(0xFF, 8 - bitCount_);
+        }
+    }
+
+private:
+    std::vector<uint8_t> &out_;
+    uint64_t buffer_ = 0;
+    int bitCount_ = 0;
+};
+
+inline int DecodeSymbol(BitReader &reader, const HuffmanTable &table) {
+    reader.Ensure(MAX_CODE_LENGTH);
+    uint16_t entry = table.lookup[reader.Peek(LOOKUP_BITS)];
+    if (entry != 0) {
+        reader.Skip(entry >> 8);
+        return entry & 0xFF;
+    }
+
+    uint32_t bits = reader.Peek(MAX_CODE_LENGTH);
+    for (int length = LOOKUP_BITS + 1; length <= MAX_CODE_LENGTH; ++length) {
+        int32_t code = static_cast<int32_t>(bits >> (MAX_CODE_LENGTH - length));
+        if (code <= table.maxCode[length]) {
+            reader.Skip(length);
+            return table.symbols[static_cast<std::size_t>(code + table.valueOffset[length])];
+        }
+    }
+    return -1;
+}
+
+inline int ReceiveExtend(BitReader &reader, int category) {
+    if (category == 0) {
+        return 0;
+    }
+    int value = static_cast<int>(reader.Get(category));
+    if (value < (1 << (category - 1))) {
+        value -= (1 << category) - 1;
+    }
+    return value;
+}
+
+inline bool DecodeBlock(BitReader &reader, const ScanComponent &scanComponent, int &dcPredictor, int16_t *block) {
+    int category = DecodeSymbol(reader, *scanComponent.dcTable);
+    if (category < 0 || category > 11) {
+        return false;
+    }
+    dcPredictor += ReceiveExtend(reader, category);
+    if (dcPredictor < INT16_MIN || dcPredictor > INT16_MAX) {
+        return false;
+    }
+    block[0] = static_cast<int16_t>(dcPredictor);
+
+    for (int k = 1; k < 64; ++k) {
+        int symbol = DecodeSymbol(reader, *scanComponent.acTable);
+        if (symbol < 0) {
+            return false;
+        }
+        int run = symbol >> 4;
+        int size = symbol & 0x0F;
+        if (size == 0) {
+            if (run != 15) {
+                break; // EOB
+            }
+            k += 15;   // ZRL
+            continue;
+        }
+        k += run;
+        if (k > 63) {
+            return false;
+        }
+        block[k] = static_cast<int16_t>(ReceiveExtend(reader, size));
+    }
+    return true;
+}
+
+inline bool PutSymbol(BitWriter &writer, const HuffmanTable &table, uint8_t symbol) {
+    if (table.codeSize[symbol] == 0) {
+        return false;
+    }
+    writer.Put(table.code[symbol], table.codeSize[symbol]);
+    return true;
+}
+
+inline bool PutValue(BitWriter &writer, const HuffmanTable &table, int run, int value) {
+    int magnitude = std::abs(value);
+    int category = BitLength(static_cast<uint32_t>(magnitude));
+    if (!PutSymbol(writer, table, static_cast<uint8_t>((run << 4) | category))) {
+        return false;
+    }
+    if (category > 0) {
+        writer.Put(static_cast<uint32_t>(value < 0 ? value - 1 : value), category);
+    }
+    return true;
+}
+
+inline bool EncodeBlock(BitWriter &writer, const ScanComponent &scanComponent, int &dcPredictor, const int16_t *block) {
+    int diff = block[0] - dcPredictor;
+    dcPredictor = block[0];
+    if (!PutValue(writer, *scanComponent.dcTable, 0, diff)) {
+        return false;
+    }
+
+    int run = 0;
+    for (int k = 1; k < 64; ++k) {
+        if (block[k] == 0) {
+            ++run;
+            continue;
+        }
+        while (run > 15) {
+            if (!PutSymbol(writer, *scanComponent.acTable, SYMBOL_ZRL)) {
+                return false;
+            }
+            run -= 16;
+        }
+        if (!PutValue(writer, *scanComponent.acTable, run, block[k])) {
+            return false;
+        }
+        run = 0;
+    }
+    if (run > 0) {
+        return PutSymbol(writer, *scanComponent.acTable, SYMBOL_EOB);
+    }
+    return true;
+}
+
+/**
+ * Find the end of the entropy coded data that starts at 'pos' (the next non-RST marker).
+ */
+std::size_t FindScanEnd(const std::vector<uint8_t> &fileData, std::size_t pos) {
+    while (pos + 1 < fileData.size()) {
+        if (fileData[pos] == 0xFF) {
+            uint8_t next = fileData[pos + 1];
+            if (next == 0x00 || (next >= MARKER_RST0 && next <= MARKER_RST7)) {
+                pos += 2;
+                continue;
+            }
+            return pos;
+        }
+        ++pos;
+    }
+    return fileData.size();
+}
+
+Result<> DecodeScan(const std::vector<uint8_t> &fileData, std::size_t start, std::size_t end,
+                    const ScanLayout &layout, int restartInterval, JpegCoefficientData &data) {
+    BitReader reader(fileData.data(), end, start);
+    std::vector<int> predictors(layout.components.size(), 0);
+
+    auto decodeBlock = [&](const ScanComponent &scanComponent, int16_t *block) {
+        std::size_t slot = static_cast<std::size_t>(&scanComponent - layout.components.data());
+        return DecodeBlock(reader, scanComponent, predictors[slot], block);
+    };
+    auto restart = [&]() {
+        std::fill(predictors.begin(), predictors.end(), 0);
+        return reader.Restart();
+    };
+
+    if (!ForEachScanBlock(data, layout, restartInterval, decodeBlock, restart) || reader.Overrun()) {
+        return Result<>(ErrorCode::ImageCorrupted, "JPEG entropy coded data is corrupted or truncated");
+    }
+    return Result<>();
+}
+
+Result<> EncodeScan(std::vector<uint8_t> &out, const ScanLayout &layout, int restartInterval,
+                    const JpegCoefficientData &data) {
+    BitWriter writer(out);
+    std::vector<int> predictors(layout.components.size(), 0);
+    int restartIdx = 0;
+
+    auto encodeBlock = [&](const ScanComponent &scanComponent, const int16_t *block) {
+        std::size_t slot = static_cast<std::size_t>(&scanComponent - layout.components.data());
+        return EncodeBlock(writer, scanComponent, predictors[slot], block);
+    };
+    auto restart = [&]() {
+        writer.Flush();
+        out.push_back(0xFF);
+        out.push_back(static_cast<uint8_t>(MARKER_RST0 + (restartIdx++ & 7)));
+        std::fill(predictors.begin(), predictors.end(), 0);
+        return true;
+    };
+
+    if (!ForEachScanBlock(data, layout, restartInterval, encodeBlock, restart)) {
+        return Result<>(ErrorCode::ImageSaveFailed,
+                        "Coefficient value cannot be encoded with the image's Huffman tables");
+    }
+    writer.Flush();
+    return Result<>();
+}
+
+} // namespace
+
+Result<JpegCoefficientData> JpegCodec::Load(const std::string &filename) {
+    StageTimer timer(Stats::Stage::ImageDecode);
+    std::ifstream inFile(filename, std::ios::binary);
+    if (!inFile) {
+        return Result<JpegCoefficientData>(ErrorCode::FileNotFound, "Failed to open JPEG file '" + filename + "'");
+    }
+    std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(inFile)),
+                                   std::istreambuf_iterator<char>());
+    timer.AddBytes(fileData.size());
+
+    auto decodeResult = Decode(fileData);
+    if (!decodeResult) {
+        return Result<JpegCoefficientData>(
+            decodeResult.GetErrorCode(),
+            "Failed to decode JPEG '" + filename + "'. Reason: " + decodeResult.GetErrorMessage()
+        );
+    }
+    return decodeResult;
+}
+
+Result<JpegCoefficientData> JpegCodec::Decode(const std::vector<uint8_t> &fileData) {
+    if (fileData.size() < 4 || fileData[0] != 0xFF || fileData[1] != MARKER_SOI) {
+        return Result<JpegCoefficientData>(ErrorCode::UnsupportedImageFormat, "Not a JPEG file (missing SOI marker)");
+    }
+
+    JpegCoefficientData data;
+    HuffmanTableSet tables;
+    bool haveFrame = false;
+    bool haveScan = false;
+    std::size_t pos = 2;
+
+    while (true) {
+        if (pos >= fileData.size() || fileData[pos] != 0xFF) {
+            return Result<JpegCoefficientData>(ErrorCode::ImageCorrupted, "Expected JPEG marker (file truncated or corrupted)");
+        }
+        while (pos < fileData.size() && fileData[pos] == 0xFF) {
+            ++pos; // fill bytes
+        }
+        if (pos >= fileData.size()) {
+            return Result<JpegCoefficientData>(ErrorCode::ImageCorrupted, "JPEG file ends without EOI marker");
+        }
+
+        uint8_t marker = fileData[pos++];
+        if (marker == MARKER_EOI) {
+            break;
+        }
+        if (marker == MARKER_TEM || (marker >= MARKER_RST0 && marker <= MARKER_RST7)) {
+            continue; // standalone markers without payload
+        }
+
+        if (pos + 2 > fileData.size()) {
+            return Result<JpegCoefficientData>(ErrorCode::ImageCorrupted, "Truncated JPEG segment header");
+        }
+        std::size_t length = ReadBE16(fileData.data() + pos);
+        if (length < 2 || pos + length > fileData.size()) {
+            return Result<JpegCoefficientData>(ErrorCode::ImageCorrupted, "Invalid JPEG segment length");
+        }
+
+        JpegSegment segment;
+        segment.marker = marker;
+        segment.payload.assign(fileData.begin() + static_cast<std::ptrdiff_t>(pos + 2),
+                               fileData.begin() + static_cast<std::ptrdiff_t>(pos + length));
+        pos += length;
+
+        if (marker == MARKER_SOF0 || marker == MARKER_SOF1) {
+            if (haveFrame) {
+                return Result<JpegCoefficientData>(ErrorCode::ImageCorrupted, "JPEG contains more than one frame");
+            }
+            auto frameResult = ParseFrameHeader(segment.payload, data);
+            if (!frameResult) {
+                return Result<JpegCoefficientData>(frameResult.GetErrorCode(), frameResult.GetErrorMessage());
+            }
+            haveFrame = true;
+        } else if (IsUnsupportedFrame(marker)) {
+            return Result<JpegCoefficientData>(
+                ErrorCode::UnsupportedImageFormat,
+                "Only baseline/sequential Huffman JPEGs are supported (progressive, lossless and arithmetic coding are not)"
+            );
+        } else if (marker == MARKER_DHT) {
+            auto tableResult = ParseHuffmanTables(segment.payload, tables);
+            if (!tableResult) {
+                return Result<JpegCoefficientData>(tableResult.GetErrorCode(), tableResult.GetErrorMessage());
+            }
+        } else if (marker == MARKER_DRI) {
+            if (segment.payload.size() < 2) {
+                return Result<JpegCoefficientData>(ErrorCode::ImageCorrupted, "Truncated DRI segment");
+            }
+            tables.restartInterval = ReadBE16(segment.payload.data());
+        } else if (marker == MARKER_SOS) {
+            auto layoutResult = ParseScanHeader(segment.payload, data, tables);
+            if (!layoutResult) {
+                return Result<JpegCoefficientData>(layoutResult.GetErrorCode(), layoutResult.GetErrorMessage());
+            }
+            std::size_t scanEnd = FindScanEnd(fileData, pos);
+            auto scanResult = DecodeScan(fileData, pos, scanEnd, layoutResult.GetValue(), tables.restartInterval, data);
+            if (!scanResult) {
+                return Result<JpegCoefficientData>(scanResult.GetErrorCode(), scanResult.GetErrorMessage());
+            }
+            pos = scanEnd;
+            haveScan = true;
+        }
+
+        data.segments.push_back(std::move(segment));
+    }
+
+    if (!haveFrame || !haveScan) {
+        return Result<JpegCoefficientData>(ErrorCode::ImageCorrupted, "JPEG file has no frame or no scan data");
+    }
+    return Result<JpegCoefficientData>(std::move(data));
+}
+
+Result<std::vector<uint8_t>> JpegCodec::Encode(const JpegCoefficientData &data) {
+    std::vector<uint8_t> out;
+    out.reserve(data.GetCoefficientCount() / 4 + 1024);
+    out.push_back(0xFF);
+    out.push_back(MARKER_SOI);
+
+    HuffmanTableSet tables;
+    for (const auto &segment : data.segments) {
+        std::size_t length = segment.payload.size() + 2;
+        if (length > 0xFFFF) {
+            return Result<std::vector<uint8_t>>(ErrorCode::ImageSaveFailed, "JPEG segment too large");
+        }
+        out.push_back(0xFF);
+        out.push_back(segment.marker);
+        out.push_back(static_cast<uint8_t>(length >> 8));
+        out.push_back(static_cast<uint8_t>(length & 0xFF));
+        out.insert(out.end(), segment.payload.begin(), segment.payload.end());
+
+        if (segment.marker == MARKER_DHT) {
+            auto tableResult = ParseHuffmanTables(segment.payload, tables);
+            if (!tableResult) {
+                return Result<std::vector<uint8_t>>(tableResult.GetErrorCode(), tableResult.GetErrorMessage());
+            }
+        } else if (segment.marker == MARKER_DRI && segment.payload.size() >= 2) {
+            tables.restartInterval = ReadBE16(segment.payload.data());
+        } else if (segment.marker == MARKER_SOS) {
+            auto layoutResult = ParseScanHeader(segment.payload, data, tables);
+            if (!layoutResult) {
+                return Result<std::vector<uint8_t>>(layoutResult.GetErrorCode(), layoutResult.GetErrorMessage());
+            }
+            auto scanResult = EncodeScan(out, layoutResult.GetValue(), tables.restartInterval, data);
+            if (!scanResult) {
+                return Result<std::vector<uint8_t>>(scanResult.GetErrorCode(), scanResult.GetErrorMessage());
+            }
+        }
+    }
+
+    out.push_back(0xFF);
+    out.push_back(MARKER_EOI);
+    return Result<std::vector<uint8_t>>(std::move(out));
+}
+
+Result<> JpegCodec::Save(const std::string &filename, const JpegCoefficientData &data) {
+    StageTimer timer(Stats::Stage::ImageEncode);
+    auto encodeResult = Encode(data);
+    if (!encodeResult) {
+        return Result<>(encodeResult.GetErrorCode(), encodeResult.GetErrorMessage());
+    }
+    const auto &fileData = encodeResult.GetValue();
+    timer.AddBytes(fileData.size());
+
+    std::ofstream outFile(filename, std::ios::binary);
+    if (!outFile) {
+        return Result<>(ErrorCode::FileWriteError, "Failed to open output file '" + filename + "' for writing");
+    }
+    outFile.write(reinterpret_cast<const char *>(fileData.data()), static_cast<std::streamsize>(fileData.size()));
+    if (!outFile) {
+        return Result<>(ErrorCode::FileWriteError, "Failed to write JPEG data to '" + filename + "'");
+    }
+    return Result<>();
+}
+
+bool JpegCodec::IsJpegFile(const std::string &filename) {
+    std::ifstream inFile(filename, std::ios::binary);
+    unsigned char signature[3] = {0, 0, 0};
+    inFile.read(reinterpret_cast<char *>(signature), sizeof(signature));
+    return inFile && signature[0] == 0xFF && signature[1] == MARKER_SOI && signature[2] == 0xFF;
+}
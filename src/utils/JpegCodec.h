@@ -0,0 +1,131 @@
+#ifndef __JPEG_CODEC_H_
+#define __JPEG_CODEC_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "ErrorHandler.h"
+
+/**
+ * @brief One colour component of a JPEG image in the quantized DCT domain.
+ *
+ * Blocks cover the full MCU-padded grid of the component and are stored row by row.
+ * Each block holds its 64 quantized coefficients in zigzag order (index 0 is DC).
+ */
+struct JpegComponent {
+    static constexpr std::size_t BLOCK_SIZE = 64;
+
+    uint8_t id = 0;
+    int hSampling = 1;
+    int vSampling = 1;
+    int blocksWide = 0;
+    int blocksHigh = 0;
+    std::vector<int16_t> coefficients;
+
+    /**
+     * @brief Get total number of blocks in the component grid.
+     */
+    std::size_t GetBlockCount() const {
+        return static_cast<std::size_t>(blocksWide) * blocksHigh;
+    }
+
+    int16_t *Block(int blockX, int blockY) {
+        return coefficients.data() + (static_cast<std::size_t>(blockY) * blocksWide + blockX) * BLOCK_SIZE;
+    }
+
+    const int16_t *Block(int blockX, int blockY) const {
+        return coefficients.data() + (static_cast<std::size_t>(blockY) * blocksWide + blockX) * BLOCK_SIZE;
+    }
+};
+
+/**
+ * @brief A raw marker segment kept verbatim so the file can be written back unchanged.
+ *
+ * For SOS segments the payload is only the scan header; the entropy coded data
+ * is regenerated from the coefficients on save.
+ */
+struct JpegSegment {
+    uint8_t marker = 0;
+    std::vector<uint8_t> payload;
+};
+
+/**
+ * @brief Quantized DCT coefficients of a baseline JPEG plus the structure needed to rewrite it.
+ */
+struct JpegCoefficientData {
+    int width = 0;
+    int height = 0;
+    int maxHSampling = 1;
+    int maxVSampling = 1;
+    std::vector<JpegComponent> components;
+    std::vector<JpegSegment> segments;
+
+    /**
+     * @brief Get total number of coefficients over all components.
+     */
+    std::size_t GetCoefficientCount() const {
+        std::size_t count = 0;
+        for (const auto &component : components) {
+            count += component.coefficients.size();
+        }
+        return count;
+    }
+};
+
+/**
+ * @brief Baseline JPEG Huffman decoder/encoder working on quantized DCT coefficients.
+ *
+ * Reads the entropy coded data into coefficient blocks and writes it back with the
+ * file's own Huffman tables, quantization tables and scan layout. No IDCT/DCT or
+ * requantization happens, so unmodified coefficients are written back bit-exact.
+ *
+ * Supports baseline and extended sequential Huffman JPEGs with 8-bit samples,
+ * interleaved or single-component scans and restart intervals. Progressive and
+ * arithmetic coded files are rejected.
+ */
+class JpegCodec {
+public:
+    JpegCodec() = delete;
+
+    /**
+     * @brief Decode the quantized DCT coefficients of a JPEG file.
+     *
+     * @param filename Path to the JPEG file
+     * @return Result containing coefficient data or detailed error
+     */
+    static Result<JpegCoefficientData> Load(const std::string &filename);
+
+    /**
+     * @brief Decode the quantized DCT coefficients of an in-memory JPEG.
+     *
+     * @param fileData Complete JPEG file contents
+     * @return Result containing coefficient data or detailed error
+     */
+    static Result<JpegCoefficientData> Decode(const std::vector<uint8_t> &fileData);
+
+    /**
+     * @brief Encode coefficient data back into a JPEG file.
+     *
+     * Every coefficient must be representable with the file's original Huffman tables.
+     *
+     * @param filename Output file path
+     * @param data Coefficient data (from Load/Decode, possibly modified)
+     * @return Result indicating success or detailed error
+     */
+    static Result<> Save(const std::string &filename, const JpegCoefficientData &data);
+
+    /**
+     * @brief Encode coefficient data into an in-memory JPEG.
+     *
+     * @param data Coefficient data (from Load/Decode, possibly modified)
+     * @return Result containing the JPEG file contents or detailed error
+     */
+    static Result<std::vector<uint8_t>> Encode(const JpegCoefficientData &data);
+
+    /**
+     * @brief Check whether a file starts with the JPEG SOI marker.
+     */
+    static bool IsJpegFile(const std::string &filename);
+};
+
+#endif // __JPEG_CODEC_H_
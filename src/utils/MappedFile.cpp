@@ -0,0 +1,137 @@
+#include "MappedFile.h"
+
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Result<MappedFile> MappedFile::Open(const std::string &filename, Mode mode) {
+
+    MappedFile file;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return Result<MappedFile>(ErrorCode::FileNotFound, "Failed to open file '" + filename + "'");
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(handle);
+        return Result<MappedFile>(ErrorCode::FileReadError, "File '" + filename + "' is empty or unreadable");
+    }
+
+    // Copy-on-write views need a read-only mapping object opened with PAGE_WRITECOPY
+    HANDLE mapping = CreateFileMappingA(handle, nullptr,
+                                        mode == Mode::CopyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY,
+                                        0, 0, nullptr);
+    CloseHandle(handle); // the mapping keeps the file open
+    if (mapping == nullptr) {
+        return Result<MappedFile>(ErrorCode::FileReadError, "Failed to map file '" + filename + "'");
+    }
+
+    void *view = MapViewOfFile(mapping, mode == Mode::CopyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return Result<MappedFile>(ErrorCode::FileReadError, "Failed to map file '" + filename + "'");
+    }
+
+    file.mappingHandle_ = mapping;
+    file.data_ = static_cast<uint8_t *>(view);
+    file.size_ = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return Result<MappedFile>(ErrorCode::FileNotFound, "Failed to open file '" + filename + "'");
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return Result<MappedFile>(ErrorCode::FileReadError, "File '" + filename + "' is empty or unreadable");
+    }
+
+    // MAP_PRIVATE: writes land in private page copies, never in the file
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    int protection = mode == Mode::CopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *view = mmap(nullptr, size, protection, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (view == MAP_FAILED) {
+        return Result<MappedFile>(ErrorCode::FileReadError, "Failed to map file '" + filename + "'");
+    }
+
+    // Both carriers walk the samples front to back
+    madvise(view, size, MADV_SEQUENTIAL);
+
+    file.data_ = static_cast<uint8_t *>(view);
+    file.size_ = size;
+#endif
+
+    return Result<MappedFile>(std::move(file));
+}
+
+Result<> MappedFile::WriteTo(const std::string &filename) const {
+
+    std::ofstream outFile(filename, std::ios::binary | std::ios::trunc);
+    if (!outFile) {
+        return Result<>(ErrorCode::FileWriteError, "Failed to open output file '" + filename + "' for writing");
+    }
+
+    outFile.write(reinterpret_cast<const char *>(data_), static_cast<std::streamsize>(size_));
+    outFile.close();
+
+    if (!outFile) {
+        return Result<>(ErrorCode::FileWriteError, "Failed to write data to '" + filename + "'");
+    }
+    return Result<>();
+}
+
+void MappedFile::Close() {
+    if (data_ == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mappingHandle_);
+    mappingHandle_ = nullptr;
+#else
+    munmap(data_, size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0))
+#ifdef _WIN32
+    , mappingHandle_(std::exchange(other.mappingHandle_, nullptr))
+#endif
+{   }
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        Close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+        mappingHandle_ = std::exchange(other.mappingHandle_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
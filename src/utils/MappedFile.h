@@ -0,0 +1,66 @@
+#ifndef __MAPPED_FILE_H_
+#define __MAPPED_FILE_H_
+
+#include "ErrorHandler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Read-only or copy-on-write memory mapping of a whole file.
+ *
+ * CopyOnWrite mappings are writable, but changes stay private to the process:
+ * only touched pages are copied and the file on disk is never modified. The
+ * result is persisted with WriteTo, in one sequential pass. Move-only.
+ */
+class MappedFile {
+public:
+    enum class Mode {
+        ReadOnly,
+        CopyOnWrite
+    };
+
+    /**
+     * @brief Map a file into memory.
+     *
+     * @param filename Path to the file
+     * @param mode ReadOnly, or CopyOnWrite for private in-memory edits
+     * @return Result containing the mapping or error (empty files cannot be mapped)
+     */
+    static Result<MappedFile> Open(const std::string &filename, Mode mode);
+
+    /**
+     * @brief Write the mapped bytes (including private changes) to a file.
+     *
+     * @param filename Output path; must not be the mapped file itself
+     * @return Result indicating success or error
+     */
+    Result<> WriteTo(const std::string &filename) const;
+
+    /**
+     * @brief Unmap the file early (also done by the destructor).
+     */
+    void Close();
+
+    uint8_t *Data() { return data_; }
+    const uint8_t *Data() const { return data_; }
+    std::size_t Size() const { return size_; }
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+private:
+    MappedFile() = default;
+
+    uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void *mappingHandle_ = nullptr;
+#endif
+};
+
+#endif // __MAPPED_FILE_H_
@@ -0,0 +1,33 @@
+#include "MemoryArena.h"
+#include "Stats.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr std::size_t MIN_BLOCK = std::size_t(64) << 10;
+
+} // namespace
+
+MemoryArena::MemoryArena(std::size_t initialBytes) : buffer_(std::max(initialBytes, MIN_BLOCK)) {   }
+
+void MemoryArena::Release() {
+    buffer_.release();
+    allocated_ = 0;
+}
+
+void *MemoryArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void *pointer = buffer_.allocate(bytes, alignment);
+    allocated_ += bytes;
+    Stats::Add(Stats::Counter::ArenaAllocations, 1);
+    Stats::Add(Stats::Counter::ArenaBytes, bytes);
+    return pointer;
+}
+
+void MemoryArena::do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) {
+    buffer_.deallocate(pointer, bytes, alignment);
+}
+
+bool MemoryArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,46 @@
+#ifndef __MEMORY_ARENA_H_
+#define __MEMORY_ARENA_H_
+
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * @brief Arena for the large buffers of one phase of an operation.
+ *
+ * A std::pmr::monotonic_buffer_resource with accounting: freeing is a no-op
+ * and every block goes back at once when the arena is released or destroyed,
+ * so a finished phase leaves no half-freed buffers behind in the heap.
+ *
+ * Not thread-safe: only the thread running the operation may allocate from
+ * it, parallel workers use the default resource.
+ */
+class MemoryArena : public std::pmr::memory_resource {
+public:
+    /**
+     * @param initialBytes Size of the first block (at least 64 KB)
+     */
+    explicit MemoryArena(std::size_t initialBytes = 0);
+
+    MemoryArena(const MemoryArena &) = delete;
+    MemoryArena &operator=(const MemoryArena &) = delete;
+
+    /**
+     * @brief Bytes handed out since construction or the last Release.
+     */
+    std::size_t GetAllocatedBytes() const { return allocated_; }
+
+    /**
+     * @brief Return every block; memory allocated before must no longer be used.
+     */
+    void Release();
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    std::pmr::monotonic_buffer_resource buffer_;
+    std::size_t allocated_ = 0;
+};
+
+#endif // __MEMORY_ARENA_H_
@@ -0,0 +1,28 @@
+#include "Parallel.h"
+
+namespace {
+
+// Threads For may use on this thread, 0 when no budget is set
+thread_local unsigned threadBudget = 0;
+
+} // namespace
+
+unsigned Parallel::GetThreadCount() {
+    if (threadBudget != 0) {
+        return threadBudget;
+    }
+
+    // hardware_concurrency may return 0 when unknown
+    unsigned count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+Parallel::ScopedThreadBudget::ScopedThreadBudget(unsigned threads)
+    : previous_(threadBudget)
+{
+    threadBudget = threads == 0 ? 1 : threads;
+}
+
+Parallel::ScopedThreadBudget::~ScopedThreadBudget() {
+    threadBudget = previous_;
+}
@@ -0,0 +1,111 @@
+#ifndef __PARALLEL_H_
+#define __PARALLEL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TraceRecorder.h"
+
+/**
+ * @brief Minimal fork-join helper for data-parallel loops.
+ *
+ * Work items are handed out through a shared counter, so uneven items
+ * (e.g. image tiles at the border) balance across threads. Results must not
+ * depend on which thread runs an item. A For called from the items of one that
+ * spread across threads runs inline, since the outer loop occupies them all.
+ */
+class Parallel {
+public:
+    Parallel() = delete;
+
+    /**
+     * @brief Number of worker threads For uses on the calling thread (at least 1).
+     *
+     * The hardware thread count, unless a ScopedThreadBudget is active. Inside
+     * the items of a For that spread across threads it is 1.
+     */
+    static unsigned GetThreadCount();
+
+    /**
+     * @brief Limits the threads For uses on the calling thread while in scope.
+     *
+     * Callers running several parallel jobs at once give each job's thread a
+     * share of the cores, so the loops inside the jobs add up to the machine.
+     */
+    class ScopedThreadBudget {
+    public:
+        explicit ScopedThreadBudget(unsigned threads);
+        ~ScopedThreadBudget();
+
+        ScopedThreadBudget(const ScopedThreadBudget &) = delete;
+        ScopedThreadBudget &operator=(const ScopedThreadBudget &) = delete;
+
+    private:
+        unsigned previous_;
+    };
+
+    /**
+     * @brief Run func(index) for every index in [0, count), spread across threads.
+     *
+     * Returns once every call has completed. func must be safe to call
+     * concurrently for different indexes. If a call throws, the items not yet
+     * started are skipped and the first exception is rethrown here.
+     *
+     * @param count Number of work items
+     * @param func Callable taking the work item index
+     */
+    template <typename Func>
+    static void For(std::size_t count, const Func &func) {
+        std::size_t threadCount = GetThreadCount();
+        if (threadCount > count) {
+            threadCount = count;
+        }
+
+        if (threadCount <= 1) {
+            for (std::size_t idx = 0; idx < count; ++idx) {
+                func(idx);
+            }
+            return;
+        }
+
+        std::atomic<std::size_t> next{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        auto worker = [&]() {
+            TraceSpan span("worker", "parallel");
+            ScopedThreadBudget nested(1);
+            try {
+                for (std::size_t idx = next++; idx < count; idx = next++) {
+                    func(idx);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next = count;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (std::size_t idx = 1; idx < threadCount; ++idx) {
+            threads.emplace_back(worker);
+        }
+        worker();
+
+        TraceSpan wait("join", "wait");
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+#endif // __PARALLEL_H_
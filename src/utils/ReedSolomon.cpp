@@ -0,0 +1,538 @@
+#include "ReedSolomon.h"
+#include "Stats.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+
+namespace {
+
+constexpr std::size_t FIELD_SIZE = 255;
+constexpr std::size_t PARAM_SIZE = 5;          // parity byte + LE32 data size
+constexpr std::size_t COLUMN_BLOCK = 4096;     // codewords decoded together, keeps syndromes in L2
+
+/**
+ * GF(2^8) with primitive polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11D) and generator 2.
+ * exp is doubled so exp[log a + log b] needs no reduction.
+ */
+struct GaloisTables {
+    std::array<uint8_t, 2 * FIELD_SIZE> exp{};
+    std::array<uint8_t, 256> log{};
+};
+
+constexpr GaloisTables BuildGaloisTables() {
+    GaloisTables tables{};
+    uint32_t value = 1;
+    for (std::size_t power = 0; power < FIELD_SIZE; ++power) {
+        tables.exp[power] = static_cast<uint8_t>(value);
+        tables.exp[power + FIELD_SIZE] = static_cast<uint8_t>(value);
+        tables.log[value] = static_cast<uint8_t>(power);
+        value <<= 1;
+        if (value & 0x100) {
+            value ^= 0x11D;
+        }
+    }
+    return tables;
+}
+
+constexpr GaloisTables GF = BuildGaloisTables();
+
+constexpr uint8_t Mul(uint8_t a, uint8_t b) {
+    return (a == 0 || b == 0) ? 0 : GF.exp[GF.log[a] + GF.log[b]];
+}
+
+inline uint8_t Div(uint8_t a, uint8_t b) {
+    return a == 0 ? 0 : GF.exp[GF.log[a] + FIELD_SIZE - GF.log[b]];
+}
+
+inline uint8_t Pow(std::size_t power) {
+    return GF.exp[power % FIELD_SIZE];
+}
+
+/**
+ * Products of a constant with every low and high nibble: c * v = lo[v & 15] ^ hi[v >> 4].
+ * Sixteen entries each, so a pshufb can do sixteen (or thirty-two) lookups at once.
+ */
+struct alignas(32) NibbleTables {
+    uint8_t lo[16];
+    uint8_t hi[16];
+};
+
+constexpr std::array<NibbleTables, 256> BuildNibbleTables() {
+    std::array<NibbleTables, 256> tables{};
+    for (std::size_t constant = 0; constant < 256; ++constant) {
+        for (uint8_t nibble = 0; nibble < 16; ++nibble) {
+            tables[constant].lo[nibble] = Mul(static_cast<uint8_t>(constant), nibble);
+            tables[constant].hi[nibble] = Mul(static_cast<uint8_t>(constant), static_cast<uint8_t>(nibble << 4));
+        }
+    }
+    return tables;
+}
+
+constexpr std::array<NibbleTables, 256> NIBBLE_TABLES = BuildNibbleTables();
+
+constexpr std::size_t TILE = 512;   // columns per pass, a multiple of every vector width
+constexpr std::size_t GROUP = 4;    // outputs updated per pass over the inputs
+
+/**
+ * out[t][x] ^= XOR over r of coeffs[r * outCount + t] * in[r][x], for x < width.
+ * Both encoding (parity = M * data) and syndromes (S = V * codeword) have this form.
+ */
+struct DotProduct {
+    uint8_t *out;
+    std::size_t outStride;
+    std::size_t outCount;
+    const uint8_t *in;
+    std::size_t inStride;
+    std::size_t inCount;
+    const uint8_t *coeffs;
+    std::size_t width;
+};
+
+void DotProductScalar(const DotProduct &job, std::size_t begin, std::size_t end) {
+    for (std::size_t t = 0; t < job.outCount; ++t) {
+        uint8_t *out = job.out + t * job.outStride;
+        for (std::size_t r = 0; r < job.inCount; ++r) {
+            const NibbleTables &table = NIBBLE_TABLES[job.coeffs[r * job.outCount + t]];
+            const uint8_t *in = job.in + r * job.inStride;
+            for (std::size_t x = begin; x < end; ++x) {
+                out[x] ^= table.lo[in[x] & 0x0F] ^ table.hi[in[x] >> 4];
+            }
+        }
+    }
+}
+
+#ifdef STEGTOOL_X86_SIMD
+
+/**
+ * One tile of Count outputs. Count is a template argument so the tables and output
+ * pointers stay in registers; each input vector is loaded and split into nibbles once.
+ */
+template <std::size_t Count>
+__attribute__((target("ssse3")))
+void DotProductTileSsse3(const DotProduct &job, std::size_t first, std::size_t begin, std::size_t end) {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    uint8_t *out[Count];
+    for (std::size_t t = 0; t < Count; ++t) {
+        out[t] = job.out + (first + t) * job.outStride;
+    }
+
+    for (std::size_t r = 0; r < job.inCount; ++r) {
+        __m128i lo[Count];
+        __m128i hi[Count];
+        for (std::size_t t = 0; t < Count; ++t) {
+            const NibbleTables &table = NIBBLE_TABLES[job.coeffs[r * job.outCount + first + t]];
+            lo[t] = _mm_load_si128(reinterpret_cast<const __m128i *>(table.lo));
+            hi[t] = _mm_load_si128(reinterpret_cast<const __m128i *>(table.hi));
+        }
+        const uint8_t *in = job.in + r * job.inStride;
+        for (std::size_t x = begin; x < end; x += 16) {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x));
+            __m128i low = _mm_and_si128(value, mask);
+            __m128i high = _mm_and_si128(_mm_srli_epi16(value, 4), mask);
+            for (std::size_t t = 0; t < Count; ++t) {
+                __m128i *target = reinterpret_cast<__m128i *>(out[t] + x);
+                __m128i product = _mm_xor_si128(_mm_shuffle_epi8(lo[t], low), _mm_shuffle_epi8(hi[t], high));
+                _mm_storeu_si128(target, _mm_xor_si128(_mm_loadu_si128(target), product));
+            }
+        }
+    }
+}
+
+template <std::size_t Count>
+__attribute__((target("avx2")))
+void DotProductTileAvx2(const DotProduct &job, std::size_t first, std::size_t begin, std::size_t end) {
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    uint8_t *out[Count];
+    for (std::size_t t = 0; t < Count; ++t) {
+        out[t] = job.out + (first + t) * job.outStride;
+    }
+
+    for (std::size_t r = 0; r < job.inCount; ++r) {
+        // vpshufb looks up within each 128-bit lane, so both lanes get the same table
+        __m256i lo[Count];
+        __m256i hi[Count];
+        for (std::size_t t = 0; t < Count; ++t) {
+            const NibbleTables &table = NIBBLE_TABLES[job.coeffs[r * job.outCount + first + t]];
+            lo[t] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(table.lo)));
+            hi[t] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(table.hi)));
+        }
+        const uint8_t *in = job.in + r * job.inStride;
+        for (std::size_t x = begin; x < end; x += 32) {
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + x));
+            __m256i low = _mm256_and_si256(value, mask);
+            __m256i high = _mm256_and_si256(_mm256_srli_epi16(value, 4), mask);
+            for (std::size_t t = 0; t < Count; ++t) {
+                __m256i *target = reinterpret_cast<__m256i *>(out[t] + x);
+                __m256i product = _mm256_xor_si256(_mm256_shuffle_epi8(lo[t], low), _mm256_shuffle_epi8(hi[t], high));
+                _mm256_storeu_si256(target, _mm256_xor_si256(_mm256_loadu_si256(target), product));
+            }
+        }
+    }
+}
+
+using DotProductTileFn = void (*)(const DotProduct &, std::size_t, std::size_t, std::size_t);
+
+/**
+ * Walk the columns in TILE-wide slices (inputs of a slice stay in L2 while every
+ * output group passes over them), vector part only; the scalar loop takes the tail.
+ */
+void DotProductTiled(const DotProduct &job, std::size_t vectorWidth, const DotProductTileFn (&tiles)[GROUP]) {
+    const std::size_t vectorEnd = job.width - job.width % vectorWidth;
+    for (std::size_t tile = 0; tile < vectorEnd; tile += TILE) {
+        const std::size_t tileEnd = std::min(tile + TILE, vectorEnd);
+        for (std::size_t first = 0; first < job.outCount; first += GROUP) {
+            tiles[std::min(GROUP, job.outCount - first) - 1](job, first, tile, tileEnd);
+        }
+    }
+    DotProductScalar(job, vectorEnd, job.width);
+}
+
+void DotProductSsse3(const DotProduct &job) {
+    static const DotProductTileFn tiles[GROUP] = {
+        DotProductTileSsse3<1>, DotProductTileSsse3<2>, DotProductTileSsse3<3>, DotProductTileSsse3<4>
+    };
+    DotProductTiled(job, 16, tiles);
+}
+
+void DotProductAvx2(const DotProduct &job) {
+    static const DotProductTileFn tiles[GROUP] = {
+        DotProductTileAvx2<1>, DotProductTileAvx2<2>, DotProductTileAvx2<3>, DotProductTileAvx2<4>
+    };
+    DotProductTiled(job, 32, tiles);
+}
+
+#endif
+
+void DotProductPortable(const DotProduct &job) {
+    DotProductScalar(job, 0, job.width);
+}
+
+using DotProductFn = void (*)(const DotProduct &);
+
+DotProductFn SelectDotProduct() {
+#ifdef STEGTOOL_X86_SIMD
+    switch (CpuFeatures::GetSimdLevel()) {
+        case SimdLevel::Avx2: return DotProductAvx2;
+        case SimdLevel::Ssse3: return DotProductSsse3;
+        case SimdLevel::Portable: break;
+    }
+#endif
+    return DotProductPortable;
+}
+
+void RunDotProduct(const DotProduct &job) {
+    SelectDotProduct()(job);
+}
+
+/**
+ * Generator polynomial prod (x - a^i) for i < parity, highest power first.
+ */
+std::vector<uint8_t> BuildGenerator(int parity) {
+    std::vector<uint8_t> generator{1};
+    for (int root = 0; root < parity; ++root) {
+        std::vector<uint8_t> next(generator.size() + 1, 0);
+        for (std::size_t idx = 0; idx < next.size(); ++idx) {
+            if (idx < generator.size()) {
+                next[idx] ^= generator[idx];
+            }
+            if (idx > 0) {
+                next[idx] ^= Mul(generator[idx - 1], Pow(root));
+            }
+        }
+        generator = std::move(next);
+    }
+    return generator;
+}
+
+struct Layout {
+    std::size_t codewords = 0;      // D, also the length of a row
+    std::size_t dataSymbols = 0;    // data rows per codeword
+    std::size_t length = 0;         // data + parity rows per codeword
+};
+
+// Callers check the parity first; an empty layout otherwise
+Layout ComputeLayout(std::size_t dataSize, int parity) {
+    Layout layout;
+    if (dataSize == 0 || !ReedSolomon::IsValidParity(parity)) {
+        return layout;
+    }
+    std::size_t maxData = FIELD_SIZE - static_cast<std::size_t>(parity);
+    layout.codewords = (dataSize + maxData - 1) / maxData;
+    layout.dataSymbols = (dataSize + layout.codewords - 1) / layout.codewords;
+    layout.length = layout.dataSymbols + static_cast<std::size_t>(parity);
+    return layout;
+}
+
+/**
+ * Encoding matrix, row major (data symbol r, parity symbol t): coefficient of x^(parity-1-t)
+ * in x^(length-1-r) mod g(x). Parity is then the sum of data symbols times their row.
+ */
+std::vector<uint8_t> BuildEncodeMatrix(const Layout &layout, int parity) {
+    const std::size_t paritySize = static_cast<std::size_t>(parity);
+    auto generator = BuildGenerator(parity);
+    std::vector<uint8_t> matrix(layout.dataSymbols * paritySize);
+
+    // x^parity mod g is g without its leading term; each further power shifts and reduces once
+    std::vector<uint8_t> remainder(generator.begin() + 1, generator.end());
+    for (std::size_t power = paritySize; power < layout.length; ++power) {
+        std::copy(remainder.begin(), remainder.end(), matrix.begin() + (layout.length - 1 - power) * paritySize);
+        uint8_t carry = remainder[0];
+        for (std::size_t t = 0; t + 1 < paritySize; ++t) {
+            remainder[t] = remainder[t + 1] ^ Mul(carry, generator[t + 1]);
+        }
+        remainder[paritySize - 1] = Mul(carry, generator[paritySize]);
+    }
+    return matrix;
+}
+
+/**
+ * Syndrome matrix, row major (codeword symbol r, syndrome i): a^(i * (length-1-r)).
+ */
+std::vector<uint8_t> BuildSyndromeMatrix(const Layout &layout, int parity) {
+    const std::size_t paritySize = static_cast<std::size_t>(parity);
+    std::vector<uint8_t> matrix(layout.length * paritySize);
+    for (std::size_t row = 0; row < layout.length; ++row) {
+        for (std::size_t i = 0; i < paritySize; ++i) {
+            matrix[row * paritySize + i] = Pow(i * (layout.length - 1 - row));
+        }
+    }
+    return matrix;
+}
+
+/**
+ * Correct one codeword in place from its syndromes (Berlekamp-Massey, Chien search, Forney).
+ * Polynomials are stored lowest power first. Symbol r has power length - 1 - r.
+ * Returns the number of corrected symbols, or -1 when the errors exceed the code.
+ */
+int CorrectCodeword(std::vector<uint8_t> &symbols, const std::vector<uint8_t> &syndromes) {
+    const std::size_t parity = syndromes.size();
+    const std::size_t length = symbols.size();
+
+    // Berlekamp-Massey: error locator Lambda
+    std::vector<uint8_t> locator{1};
+    std::vector<uint8_t> previous{1};
+    std::size_t errors = 0;
+    std::size_t shift = 1;
+    uint8_t previousDiscrepancy = 1;
+
+    for (std::size_t step = 0; step < parity; ++step) {
+        uint8_t discrepancy = syndromes[step];
+        for (std::size_t idx = 1; idx <= errors && idx < locator.size(); ++idx) {
+            discrepancy ^= Mul(locator[idx], syndromes[step - idx]);
+        }
+        if (discrepancy == 0) {
+            ++shift;
+            continue;
+        }
+
+        uint8_t scale = Div(discrepancy, previousDiscrepancy);
+        std::vector<uint8_t> updated = locator;
+        if (updated.size() < previous.size() + shift) {
+            updated.resize(previous.size() + shift, 0);
+        }
+        for (std::size_t idx = 0; idx < previous.size(); ++idx) {
+            updated[idx + shift] ^= Mul(scale, previous[idx]);
+        }
+
+        if (2 * errors <= step) {
+            previous = std::move(locator);
+            errors = step + 1 - errors;
+            previousDiscrepancy = discrepancy;
+            shift = 1;
+        } else {
+            ++shift;
+        }
+        locator = std::move(updated);
+    }
+
+    if (2 * errors > parity) {
+        return -1;
+    }
+    locator.resize(errors + 1);
+
+    // Error evaluator Omega = S * Lambda mod x^parity
+    std::vector<uint8_t> evaluator(parity, 0);
+    for (std::size_t i = 0; i < parity; ++i) {
+        for (std::size_t j = 0; j <= errors && i + j < parity; ++j) {
+            evaluator[i + j] ^= Mul(syndromes[i], locator[j]);
+        }
+    }
+
+    // Chien search over the positions this (shortened) codeword has, Forney for the values
+    std::size_t found = 0;
+    for (std::size_t power = 0; power < length && found < errors; ++power) {
+        uint8_t inverse = Pow(FIELD_SIZE - power % FIELD_SIZE);
+        // Lambda(X^-1) and its formal derivative, which keeps the odd terms one power lower
+        uint8_t term = 1;
+        uint8_t lowerTerm = 0;
+        uint8_t locatorValue = 0;
+        uint8_t derivativeValue = 0;
+        for (std::size_t idx = 0; idx <= errors; ++idx) {
+            locatorValue ^= Mul(locator[idx], term);
+            if (idx & 1) {
+                derivativeValue ^= Mul(locator[idx], lowerTerm);
+            }
+            lowerTerm = term;
+            term = Mul(term, inverse);
+        }
+        if (locatorValue != 0) {
+            continue;
+        }
+        if (derivativeValue == 0) {
+            return -1;
+        }
+
+        uint8_t evaluatorValue = 0;
+        term = 1;
+        for (std::size_t idx = 0; idx < parity; ++idx) {
+            evaluatorValue ^= Mul(evaluator[idx], term);
+            term = Mul(term, inverse);
+        }
+
+        uint8_t magnitude = Mul(Pow(power), Div(evaluatorValue, derivativeValue));
+        symbols[length - 1 - power] ^= magnitude;
+        ++found;
+    }
+
+    return found == errors ? static_cast<int>(errors) : -1;
+}
+
+void WriteU32(uint8_t *out, uint32_t value) {
+    for (int idx = 0; idx < 4; ++idx) {
+        out[idx] = static_cast<uint8_t>(value >> (8 * idx));
+    }
+}
+
+uint32_t ReadU32(const uint8_t *in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+} // namespace
+
+bool ReedSolomon::IsValidParity(int parity) {
+    return parity >= MIN_PARITY && parity <= MAX_PARITY && parity % 2 == 0;
+}
+
+std::size_t ReedSolomon::GetEncodedSize(std::size_t dataSize, int parity) {
+    if (!IsValidParity(parity)) {
+        return 0;
+    }
+    Layout layout = ComputeLayout(dataSize, parity);
+    return PREFIX_SIZE + layout.codewords * layout.length;
+}
+
+Result<std::vector<uint8_t>> ReedSolomon::Encode(const std::vector<uint8_t> &data, int parity) {
+    StageTimer timer(Stats::Stage::ErrorCorrection, data.size());
+    if (!IsValidParity(parity)) {
+        std::ostringstream oss;
+        oss << "Invalid error correction parity " << parity << " (supported: even values from "
+            << MIN_PARITY << " to " << MAX_PARITY << ")";
+        return Result<std::vector<uint8_t>>(ErrorCode::InvalidArgument, oss.str());
+    }
+
+    Layout layout = ComputeLayout(data.size(), parity);
+    const std::size_t rowSize = layout.codewords;
+    const std::size_t paritySize = static_cast<std::size_t>(parity);
+
+    std::vector<uint8_t> block(PREFIX_SIZE + rowSize * layout.length, 0);
+    for (std::size_t copy = 0; copy < 3; ++copy) {
+        block[copy * PARAM_SIZE] = static_cast<uint8_t>(parity);
+        WriteU32(block.data() + copy * PARAM_SIZE + 1, static_cast<uint32_t>(data.size()));
+    }
+
+    // Data rows keep the input order (codeword c owns bytes c, c + D, ...), zero padded
+    uint8_t *rows = block.data() + PREFIX_SIZE;
+    std::copy(data.begin(), data.end(), rows);
+
+    // Systematic encoding as a matrix product, all codewords at once: parity rows = M * data rows
+    auto matrix = BuildEncodeMatrix(layout, parity);
+    RunDotProduct({rows + layout.dataSymbols * rowSize, rowSize, paritySize,
+                   rows, rowSize, layout.dataSymbols, matrix.data(), rowSize});
+
+    return Result<std::vector<uint8_t>>(block);
+}
+
+Result<std::vector<uint8_t>> ReedSolomon::Decode(const std::vector<uint8_t> &block, std::size_t maxSize,
+                                                 std::size_t *correctedSymbols) {
+    StageTimer timer(Stats::Stage::ErrorCorrection, block.size());
+    if (correctedSymbols != nullptr) {
+        *correctedSymbols = 0;
+    }
+    if (block.size() < PREFIX_SIZE) {
+        return Result<std::vector<uint8_t>>(ErrorCode::InvalidDataSize, "Error correction block is too small");
+    }
+
+    // Bitwise majority of the three parameter copies
+    std::array<uint8_t, PARAM_SIZE> params{};
+    for (std::size_t idx = 0; idx < PARAM_SIZE; ++idx) {
+        uint8_t a = block[idx];
+        uint8_t b = block[PARAM_SIZE + idx];
+        uint8_t c = block[2 * PARAM_SIZE + idx];
+        params[idx] = static_cast<uint8_t>((a & b) | (a & c) | (b & c));
+    }
+    int parity = params[0];
+    std::size_t dataSize = ReadU32(params.data() + 1);
+
+    if (!IsValidParity(parity) || dataSize > maxSize || block.size() != GetEncodedSize(dataSize, parity)) {
+        return Result<std::vector<uint8_t>>(
+            ErrorCode::CorruptedPayload,
+            "Error correction parameters are damaged beyond repair"
+        );
+    }
+
+    Layout layout = ComputeLayout(dataSize, parity);
+    const std::size_t rowSize = layout.codewords;
+    const std::size_t paritySize = static_cast<std::size_t>(parity);
+
+    std::vector<uint8_t> rows(block.begin() + PREFIX_SIZE, block.end());
+    std::vector<uint8_t> syndromes(paritySize * COLUMN_BLOCK);
+    auto evaluation = BuildSyndromeMatrix(layout, parity);
+    std::vector<uint8_t> symbols(layout.length);
+    std::vector<uint8_t> codewordSyndromes(paritySize);
+    std::size_t corrected = 0;
+
+    for (std::size_t column = 0; column < rowSize; column += COLUMN_BLOCK) {
+        const std::size_t width = std::min(COLUMN_BLOCK, rowSize - column);
+        std::fill(syndromes.begin(), syndromes.end(), 0);
+
+        // S_i = sum over rows of symbol * a^(i * power), for every codeword of the block at once
+        RunDotProduct({syndromes.data(), COLUMN_BLOCK, paritySize,
+                       rows.data() + column, rowSize, layout.length, evaluation.data(), width});
+
+        for (std::size_t idx = 0; idx < width; ++idx) {
+            bool clean = true;
+            for (std::size_t i = 0; i < paritySize; ++i) {
+                codewordSyndromes[i] = syndromes[i * COLUMN_BLOCK + idx];
+                clean = clean && codewordSyndromes[i] == 0;
+            }
+            if (clean) {
+                continue;
+            }
+
+            std::size_t codeword = column + idx;
+            for (std::size_t row = 0; row < layout.length; ++row) {
+                symbols[row] = rows[row * rowSize + codeword];
+            }
+            int fixed = CorrectCodeword(symbols, codewordSyndromes);
+            if (fixed < 0) {
+                std::ostringstream oss;
+                oss << "Too many damaged bytes to correct (codeword " << codeword << " of " << rowSize
+                    << ", at most " << paritySize / 2 << " per codeword)";
+                return Result<std::vector<uint8_t>>(ErrorCode::CorruptedPayload, oss.str());
+            }
+            for (std::size_t row = 0; row < layout.dataSymbols; ++row) {
+                rows[row * rowSize + codeword] = symbols[row];
+            }
+            corrected += static_cast<std::size_t>(fixed);
+        }
+    }
+
+    if (correctedSymbols != nullptr) {
+        *correctedSymbols = corrected;
+    }
+    rows.resize(dataSize);
+    return Result<std::vector<uint8_t>>(rows);
+}
@@ -0,0 +1,71 @@
+#ifndef __REED_SOLOMON_H_
+#define __REED_SOLOMON_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "ErrorHandler.h"
+
+/**
+ * @brief Static class providing interleaved Reed-Solomon error correction for payloads.
+ *
+ * Data is split into D shortened RS(n, n - parity) codewords over GF(2^8)
+ * (n <= 255), written interleaved: symbol j of codeword c is stored at byte
+ * j * D + c. A burst of damaged bytes is spread over all codewords, and each
+ * codeword corrects up to parity / 2 damaged bytes.
+ *
+ * Output layout:
+ *   [0..14]  parity count (1 byte) and data size (LE32), stored three times;
+ *            the decoder takes a bitwise majority vote
+ *   [15..]   interleaved codewords
+ *
+ * GF(2^8) multiplication uses SSSE3 / AVX2 split-nibble table lookups when
+ * the CPU has them, log/exp tables otherwise.
+ */
+class ReedSolomon {
+public:
+    ReedSolomon() = delete;
+
+    /** Supported parity symbols per codeword; RS(255,223) uses 32 **/
+    static constexpr int MIN_PARITY = 2;
+    static constexpr int MAX_PARITY = 128;
+    static constexpr int DEFAULT_PARITY = 32;
+
+    /** Size of the triplicated parameter prefix **/
+    static constexpr std::size_t PREFIX_SIZE = 15;
+
+    /**
+     * @brief Whether a parity count can be used (even, MIN_PARITY to MAX_PARITY).
+     */
+    static bool IsValidParity(int parity);
+
+    /**
+     * @brief Size of Encode output for a given input size.
+     *
+     * @return Encoded size, or 0 when IsValidParity(parity) is false
+     */
+    static std::size_t GetEncodedSize(std::size_t dataSize, int parity);
+
+    /**
+     * @brief Add error correction to data.
+     *
+     * @param data Bytes to protect (at most 4 GB)
+     * @param parity Parity symbols per codeword, see IsValidParity
+     * @return Result containing the encoded block, or InvalidArgument for a bad parity
+     */
+    static Result<std::vector<uint8_t>> Encode(const std::vector<uint8_t> &data, int parity);
+
+    /**
+     * @brief Correct and strip the error correction added by Encode.
+     *
+     * @param block Output of Encode, possibly damaged
+     * @param maxSize Largest data size accepted
+     * @param correctedSymbols If not null, receives the number of bytes that were repaired
+     * @return Result containing the original data, or InvalidDataSize / CorruptedPayload
+     *         when the damage exceeds what the code can correct
+     */
+    static Result<std::vector<uint8_t>> Decode(const std::vector<uint8_t> &block, std::size_t maxSize,
+                                               std::size_t *correctedSymbols = nullptr);
+};
+
+#endif // __REED_SOLOMON_H_
@@ -0,0 +1,151 @@
+#include "Stats.h"
+
+#include <array>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+constexpr std::size_t STAGE_COUNT = static_cast<std::size_t>(Stats::Stage::Count);
+constexpr std::size_t COUNTER_COUNT = static_cast<std::size_t>(Stats::Counter::Count);
+
+struct AtomicTotals {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> nanoseconds{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+std::array<AtomicTotals, STAGE_COUNT> stages;
+std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+
+constexpr std::array<const char *, STAGE_COUNT> STAGE_NAMES = {
+    "imageDecode", "imageEncode", "dataRead", "dataWrite", "compress", "decompress",
+    "keyDerivation", "cipher", "mac", "errorCorrection", "embed", "extract"
+};
+
+constexpr std::array<const char *, COUNTER_COUNT> COUNTER_NAMES = {
+    "samplesTouched", "arenaAllocations", "arenaBytes"
+};
+
+double ToMilliseconds(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1e6;
+}
+
+} // namespace
+
+std::atomic<bool> Stats::enabled_{false};
+
+void Stats::Reset() {
+    for (auto &totals : stages) {
+        totals.calls.store(0, std::memory_order_relaxed);
+        totals.nanoseconds.store(0, std::memory_order_relaxed);
+        totals.bytes.store(0, std::memory_order_relaxed);
+    }
+    for (auto &counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Stats::Record(Stage stage, uint64_t nanoseconds, uint64_t bytes) {
+    auto &totals = stages[static_cast<std::size_t>(stage)];
+    totals.calls.fetch_add(1, std::memory_order_relaxed);
+    totals.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    totals.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Stats::AddCounter(Counter counter, uint64_t value) {
+    counters[static_cast<std::size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+Stats::StageTotals Stats::GetStage(Stage stage) {
+    const auto &totals = stages[static_cast<std::size_t>(stage)];
+    StageTotals result;
+    result.calls = totals.calls.load(std::memory_order_relaxed);
+    result.nanoseconds = totals.nanoseconds.load(std::memory_order_relaxed);
+    result.bytes = totals.bytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+uint64_t Stats::GetCounter(Counter counter) {
+    return counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+uint64_t Stats::GetPeakRss() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+const char *Stats::GetName(Stage stage) {
+    return STAGE_NAMES[static_cast<std::size_t>(stage)];
+}
+
+const char *Stats::GetName(Counter counter) {
+    return COUNTER_NAMES[static_cast<std::size_t>(counter)];
+}
+
+std::string Stats::FormatTable() {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out << std::fixed << std::setprecision(2);
+
+    out << std::left << std::setw(17) << "Stage" << std::right << std::setw(7) << "Calls"
+        << std::setw(12) << "Time (ms)" << std::setw(14) << "Bytes" << std::setw(10) << "MB/s" << "\n";
+    for (std::size_t idx = 0; idx < STAGE_COUNT; ++idx) {
+        StageTotals totals = GetStage(static_cast<Stage>(idx));
+        if (totals.calls == 0) {
+            continue;
+        }
+        out << std::left << std::setw(17) << STAGE_NAMES[idx] << std::right << std::setw(7) << totals.calls
+            << std::setw(12) << ToMilliseconds(totals.nanoseconds) << std::setw(14) << totals.bytes;
+        if (totals.bytes > 0 && totals.nanoseconds > 0) {
+            out << std::setw(10) << static_cast<double>(totals.bytes) * 1e3 / static_cast<double>(totals.nanoseconds);
+        }
+        out << "\n";
+    }
+
+    for (std::size_t idx = 0; idx < COUNTER_COUNT; ++idx) {
+        out << std::left << std::setw(17) << COUNTER_NAMES[idx] << std::right << std::setw(7) << ""
+            << std::setw(26) << GetCounter(static_cast<Counter>(idx)) << "\n";
+    }
+    if (uint64_t peakRss = GetPeakRss()) {
+        out << std::left << std::setw(17) << "peakRss (MB)" << std::right << std::setw(7) << ""
+            << std::setw(26) << static_cast<double>(peakRss) / (1024.0 * 1024.0) << "\n";
+    }
+    return out.str();
+}
+
+std::string Stats::FormatJson() {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out << std::fixed << std::setprecision(3);
+
+    out << "{\n  \"stages\": {";
+    for (std::size_t idx = 0; idx < STAGE_COUNT; ++idx) {
+        StageTotals totals = GetStage(static_cast<Stage>(idx));
+        out << (idx == 0 ? "\n" : ",\n") << "    \"" << STAGE_NAMES[idx] << "\": {\"calls\": " << totals.calls
+            << ", \"ms\": " << ToMilliseconds(totals.nanoseconds) << ", \"bytes\": " << totals.bytes << "}";
+    }
+    out << "\n  },\n  \"counters\": {";
+    for (std::size_t idx = 0; idx < COUNTER_COUNT; ++idx) {
+        out << (idx == 0 ? "\n" : ",\n") << "    \"" << COUNTER_NAMES[idx] << "\": "
+            << GetCounter(static_cast<Counter>(idx));
+    }
+    out << "\n  },\n  \"peakRssBytes\": " << GetPeakRss() << "\n}\n";
+    return out.str();
+}
@@ -0,0 +1,171 @@
+#ifndef __STATS_H_
+#define __STATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "TraceRecorder.h"
+
+/**
+ * @brief Process wide timers and counters for the stages of a job.
+ *
+ * Disabled by default: every probe then costs one relaxed atomic load and a
+ * branch. Once enabled, stages accumulate calls, wall time and bytes
+ * processed; totals are atomic, so handlers running concurrently (e.g. in
+ * AutoExtractor) add up. Nested stages are timed on their own as well, so
+ * stage times may overlap and need not add up to the total.
+ */
+class Stats {
+public:
+    Stats() = delete;
+
+    /**
+     * @brief Timed stages, in pipeline order.
+     */
+    enum class Stage : std::size_t {
+        ImageDecode,
+        ImageEncode,
+        DataRead,
+        DataWrite,
+        Compress,
+        Decompress,
+        KeyDerivation,
+        Cipher,
+        Mac,
+        ErrorCorrection,
+        Embed,
+        Extract,
+        Count
+    };
+
+    /**
+     * @brief Counted events without a time of their own.
+     *
+     * SamplesTouched counts the carrier samples (pixel values, audio samples,
+     * DCT coefficients) handed to the embed and extract stages.
+     */
+    enum class Counter : std::size_t {
+        SamplesTouched,
+        ArenaAllocations,
+        ArenaBytes,
+        Count
+    };
+
+    /**
+     * @brief Totals of one stage.
+     */
+    struct StageTotals {
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0;
+        uint64_t bytes = 0;
+    };
+
+    static void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Zero every stage and counter.
+     */
+    static void Reset();
+
+    /**
+     * @brief Add one call of a stage; see StageTimer.
+     */
+    static void Record(Stage stage, uint64_t nanoseconds, uint64_t bytes);
+
+    /**
+     * @brief Add to a counter when enabled.
+     */
+    static void Add(Counter counter, uint64_t value) {
+        if (IsEnabled()) {
+            AddCounter(counter, value);
+        }
+    }
+
+    static StageTotals GetStage(Stage stage);
+    static uint64_t GetCounter(Counter counter);
+
+    /**
+     * @brief Peak resident set size of the process in bytes, 0 where the platform does not report it.
+     */
+    static uint64_t GetPeakRss();
+
+    /**
+     * @brief Name of a stage or counter, as used in the table and the JSON output.
+     */
+    static const char *GetName(Stage stage);
+    static const char *GetName(Counter counter);
+
+    /**
+     * @brief Human readable table of the stages that ran, then the counters.
+     */
+    static std::string FormatTable();
+
+    /**
+     * @brief JSON document {"stages": {...}, "counters": {...}, "peakRssBytes": n} with every stage.
+     */
+    static std::string FormatJson();
+
+private:
+    static void AddCounter(Counter counter, uint64_t value);
+
+    static std::atomic<bool> enabled_;
+};
+
+/**
+ * @brief Times a scope as one call of a stage when Stats are enabled, and
+ * records it as a span when the TraceRecorder is.
+ */
+class StageTimer {
+public:
+    /**
+     * @param stage Stage the scope belongs to
+     * @param bytes Bytes the stage processes, if known up front (see AddBytes)
+     */
+    explicit StageTimer(Stats::Stage stage, uint64_t bytes = 0)
+        : stage_(stage), bytes_(bytes), stats_(Stats::IsEnabled()), trace_(TraceRecorder::IsEnabled()) {
+        if (stats_ || trace_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~StageTimer() { Stop(); }
+
+    StageTimer(const StageTimer &) = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+    /**
+     * @brief Count bytes only known once the stage has run, e.g. a decoded image.
+     */
+    void AddBytes(uint64_t bytes) { bytes_ += bytes; }
+
+    /**
+     * @brief End the stage before the scope does; later calls do nothing.
+     */
+    void Stop() {
+        if (stats_ || trace_) {
+            auto end = std::chrono::steady_clock::now();
+            if (stats_) {
+                Stats::Record(stage_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count()),
+                              bytes_);
+            }
+            if (trace_) {
+                TraceRecorder::Record(Stats::GetName(stage_), "stage", start_, end, bytes_);
+            }
+            stats_ = false;
+            trace_ = false;
+        }
+    }
+
+private:
+    Stats::Stage stage_;
+    uint64_t bytes_;
+    bool stats_;
+    bool trace_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#endif // __STATS_H_
@@ -0,0 +1,157 @@
+#include "TraceRecorder.h"
+
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <locale>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    const char *category;
+    int64_t begin;
+    int64_t duration;
+    uint64_t bytes;
+};
+
+// Written by one thread at a time: the thread holding it, or Start and FormatJson
+// while nothing records. A deque never moves recorded events when it grows.
+struct ThreadBuffer {
+    uint32_t tid = 0;
+    bool inUse = false;
+    std::deque<TraceEvent> events;
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+uint32_t mainTid = 0;
+TraceRecorder::Clock::time_point epoch;
+
+// Hands the buffer back to the registry when its thread exits
+struct BufferLease {
+    ThreadBuffer *buffer = nullptr;
+
+    ~BufferLease() {
+        if (buffer != nullptr) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer->inUse = false;
+        }
+    }
+};
+
+thread_local BufferLease lease;
+
+ThreadBuffer &AcquireBuffer() {
+    if (lease.buffer != nullptr) {
+        return *lease.buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto &buffer : buffers) {
+        if (!buffer->inUse) {
+            lease.buffer = buffer.get();
+            break;
+        }
+    }
+    if (lease.buffer == nullptr) {
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffers.back()->tid = static_cast<uint32_t>(buffers.size());
+        lease.buffer = buffers.back().get();
+    }
+    lease.buffer->inUse = true;
+    return *lease.buffer;
+}
+
+int64_t ToNanoseconds(TraceRecorder::Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+} // namespace
+
+std::atomic<bool> TraceRecorder::enabled_{false};
+
+void TraceRecorder::Start() {
+    mainTid = AcquireBuffer().tid;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto &buffer : buffers) {
+            buffer->events.clear();
+        }
+    }
+    epoch = Clock::now();
+    enabled_.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::Stop() {
+    enabled_.store(false, std::memory_order_release);
+}
+
+void TraceRecorder::Record(const char *name, const char *category, Clock::time_point begin, Clock::time_point end,
+                           uint64_t bytes) {
+    ThreadBuffer &buffer = AcquireBuffer();
+    buffer.events.push_back({name, category, ToNanoseconds(begin - epoch), ToNanoseconds(end - begin), bytes});
+}
+
+std::size_t TraceRecorder::GetEventCount() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::size_t count = 0;
+    for (const auto &buffer : buffers) {
+        count += buffer->events.size();
+    }
+    return count;
+}
+
+std::string TraceRecorder::FormatJson() {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out << std::fixed << std::setprecision(3);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    for (const auto &buffer : buffers) {
+        if (buffer->events.empty() && buffer->tid != mainTid) {
+            continue;
+        }
+        out << (first ? "\n" : ",\n") << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+            << buffer->tid << ", \"args\": {\"name\": \"";
+        if (buffer->tid == mainTid) {
+            out << "main";
+        } else {
+            out << "worker " << buffer->tid;
+        }
+        out << "\"}}";
+        first = false;
+
+        // Timestamps and durations are in microseconds
+        for (const auto &event : buffer->events) {
+            out << ",\n  {\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+                << "\", \"ph\": \"X\", \"ts\": " << static_cast<double>(event.begin) / 1e3
+                << ", \"dur\": " << static_cast<double>(event.duration) / 1e3 << ", \"pid\": 1, \"tid\": "
+                << buffer->tid;
+            if (event.bytes > 0) {
+                out << ", \"args\": {\"bytes\": " << event.bytes << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+Result<> TraceRecorder::Save(const std::string &filename) {
+    std::string json = FormatJson();
+    std::ofstream file(filename, std::ios::binary);
+    if (file) {
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    }
+    if (!file) {
+        return Result<>(ErrorCode::FileWriteError, "Failed to write trace to '" + filename + "'");
+    }
+    return Result<>();
+}
@@ -0,0 +1,106 @@
+#ifndef __TRACE_RECORDER_H_
+#define __TRACE_RECORDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "ErrorHandler.h"
+
+/**
+ * @brief Records spans per thread and writes them as Chrome trace-event JSON.
+ *
+ * The file opens in chrome://tracing or Perfetto and shows on which thread
+ * each stage ran, where stages overlap and where a thread waited for others.
+ *
+ * Every thread appends to a buffer of its own, so recording takes no lock;
+ * a thread only locks once to claim its buffer. Buffers of finished threads
+ * are reused by the next thread, which keeps the rows of short-lived workers
+ * (see Parallel::For) together. Disabled by default, a span then costs one
+ * relaxed atomic load and a branch.
+ *
+ * Start and Stop must be called while no other thread records, e.g. before
+ * and after a command.
+ */
+class TraceRecorder {
+public:
+    TraceRecorder() = delete;
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Drop earlier spans and start recording; the calling thread is named "main".
+     */
+    static void Start();
+
+    /**
+     * @brief Stop recording; the spans are kept until the next Start.
+     */
+    static void Stop();
+
+    static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Add a span to the buffer of the calling thread.
+     *
+     * @param name Span name, must outlive the recorder (string literal or stage name)
+     * @param category Span category, same lifetime as name
+     * @param begin Start of the span
+     * @param end End of the span
+     * @param bytes Bytes processed, 0 when unknown
+     */
+    static void Record(const char *name, const char *category, Clock::time_point begin, Clock::time_point end,
+                       uint64_t bytes = 0);
+
+    /**
+     * @brief Number of spans recorded since Start.
+     */
+    static std::size_t GetEventCount();
+
+    /**
+     * @brief Trace-event JSON of every span recorded since Start, plus thread names.
+     */
+    static std::string FormatJson();
+
+    /**
+     * @brief Write FormatJson to a file.
+     */
+    static Result<> Save(const std::string &filename);
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+/**
+ * @brief Records a scope as one span when tracing is enabled.
+ *
+ * For spans outside the stages of Stats (worker threads, waits); stages are
+ * traced by StageTimer.
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char *name, const char *category)
+        : name_(name), category_(category), enabled_(TraceRecorder::IsEnabled()) {
+        if (enabled_) {
+            begin_ = TraceRecorder::Clock::now();
+        }
+    }
+
+    ~TraceSpan() {
+        if (enabled_) {
+            TraceRecorder::Record(name_, category_, begin_, TraceRecorder::Clock::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name_;
+    const char *category_;
+    bool enabled_;
+    TraceRecorder::Clock::time_point begin_;
+};
+
+#endif // __TRACE_RECORDER_H_
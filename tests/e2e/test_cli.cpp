@@ -392,6 +392,404 @@ TEST_F(CLITest, E2E_MultipleFormats) {
     EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, bmpExtract));
 }
 
+TEST_F(CLITest, E2E_LSBMatchingWorkflow) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_gray.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_workflow_match.png").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_workflow_match.txt").string();
+
+    int embedCode = RunCLI({
+        "embed",
+        "-i", coverPath,
+        "-d", dataPath,
+        "-m", "lsbmatch",
+        "-o", stegoPath,
+        "-p", "matchpass"
+    });
+    ASSERT_EQ(embedCode, 0);
+
+    int extractCode = RunCLI({
+        "extract",
+        "-i", stegoPath,
+        "-m", "lsbmatch",
+        "-o", extractPath,
+        "-p", "matchpass"
+    });
+    ASSERT_EQ(extractCode, 0);
+
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, E2E_HammingWorkflow) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_gray.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_workflow_hamming.png").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_workflow_hamming.txt").string();
+
+    int embedCode = RunCLI({
+        "embed",
+        "-i", coverPath,
+        "-d", dataPath,
+        "-m", "3",
+        "-o", stegoPath,
+        "-p", "hammingpass"
+    });
+    ASSERT_EQ(embedCode, 0);
+
+    int extractCode = RunCLI({
+        "extract",
+        "-i", stegoPath,
+        "-m", "hamming",
+        "-o", extractPath,
+        "-p", "hammingpass"
+    });
+    ASSERT_EQ(extractCode, 0);
+
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, E2E_DCTWorkflow) {
+    auto coverPath = TestHelpers::GetOutputPath("cli_dct_cover.jpg").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_workflow_dct.jpg").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_workflow_dct.txt").string();
+
+    // JPEG cover with plenty of non-zero AC coefficients
+    auto pixels = TestHelpers::GenerateRandomData(128 * 128 * 3);
+    ASSERT_TRUE(ImageIO::Save(coverPath, pixels, 128, 128, 3).IsSuccess());
+
+    int embedCode = RunCLI({
+        "embed",
+        "-i", coverPath,
+        "-d", dataPath,
+        "-m", "dct",
+        "-o", stegoPath,
+        "-p", "dctpass"
+    });
+    ASSERT_EQ(embedCode, 0);
+
+    int extractCode = RunCLI({
+        "extract",
+        "-i", stegoPath,
+        "-m", "4",
+        "-o", extractPath,
+        "-p", "dctpass"
+    });
+    ASSERT_EQ(extractCode, 0);
+
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, E2E_AdaptiveWorkflow) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_rgb.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_workflow_adaptive.png").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_workflow_adaptive.txt").string();
+
+    int embedCode = RunCLI({
+        "embed",
+        "-i", coverPath,
+        "-d", dataPath,
+        "-m", "adaptive",
+        "-o", stegoPath,
+        "-p", "adaptivepass"
+    });
+    ASSERT_EQ(embedCode, 0);
+
+    int extractCode = RunCLI({
+        "extract",
+        "-i", stegoPath,
+        "-m", "5",
+        "-o", extractPath,
+        "-p", "adaptivepass"
+    });
+    ASSERT_EQ(extractCode, 0);
+
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, E2E_ChannelMaskWorkflow) {
+    auto coverPath = TestHelpers::GetFixturePath("rgba_test.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_workflow_mask.png").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_workflow_mask.txt").string();
+
+    int embedCode = RunCLI({
+        "embed",
+        "-i", coverPath,
+        "-d", dataPath,
+        "-m", "lsbshuffle",
+        "-c", "rgb",
+        "-b", "1",
+        "-o", stegoPath,
+        "-p", "maskpass"
+    });
+    ASSERT_EQ(embedCode, 0);
+
+    // Alpha channel must be untouched
+    auto cover = ImageIO::Load(coverPath);
+    auto stego = ImageIO::Load(stegoPath);
+    ASSERT_TRUE(cover.IsSuccess());
+    ASSERT_TRUE(stego.IsSuccess());
+    for (std::size_t idx = 3; idx < cover.GetValue().pixels.size(); idx += 4) {
+        ASSERT_EQ(cover.GetValue().pixels[idx], stego.GetValue().pixels[idx]);
+    }
+
+    int extractCode = RunCLI({
+        "extract",
+        "-i", stegoPath,
+        "-m", "lsbshuffle",
+        "--channels", "rgb",
+        "--bit-plane", "1",
+        "-o", extractPath,
+        "-p", "maskpass"
+    });
+    ASSERT_EQ(extractCode, 0);
+
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, E2E_SixteenBitWorkflow) {
+    auto coverPath = TestHelpers::GetOutputPath("cli_cover16.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_workflow_16bit.png").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_workflow_16bit.txt").string();
+
+    std::vector<uint16_t> pixels(64 * 64 * 3);
+    for (std::size_t idx = 0; idx < pixels.size(); ++idx) {
+        pixels[idx] = static_cast<uint16_t>(idx * 40503u);
+    }
+    ASSERT_TRUE(ImageIO::Save(coverPath, ImageData16(pixels, 64, 64, 3)).IsSuccess());
+
+    int embedCode = RunCLI({
+        "embed",
+        "-i", coverPath,
+        "-d", dataPath,
+        "-m", "lsbshuffle",
+        "-n", "8",
+        "-o", stegoPath,
+        "-p", "pass16"
+    });
+    ASSERT_EQ(embedCode, 0);
+
+    // Stego image stays 16-bit and only the low byte changes
+    ASSERT_TRUE(ImageIO::Is16Bit(stegoPath));
+    auto stego = ImageIO::Load16(stegoPath);
+    ASSERT_TRUE(stego.IsSuccess());
+    for (std::size_t idx = 0; idx < pixels.size(); ++idx) {
+        ASSERT_EQ(stego.GetValue().pixels[idx] & 0xFF00, pixels[idx] & 0xFF00);
+    }
+
+    int extractCode = RunCLI({
+        "extract",
+        "-i", stegoPath,
+        "-m", "lsbshuffle",
+        "--bit-count", "8",
+        "-o", extractPath,
+        "-p", "pass16"
+    });
+    ASSERT_EQ(extractCode, 0);
+
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, E2E_WAVWorkflow) {
+    auto coverPath = TestHelpers::GetOutputPath("cli_cover.wav").string();
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_workflow_wav.wav").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_workflow_wav.txt").string();
+
+    // 16-bit mono PCM: canonical 44-byte header followed by noise samples
+    auto samples = TestHelpers::GenerateRandomData(200000);
+    const uint8_t header[] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+                              'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 1, 0,
+                              0x44, 0xAC, 0, 0, 0x88, 0x58, 0x01, 0, 2, 0, 16, 0,
+                              'd', 'a', 't', 'a', 0x40, 0x0D, 0x03, 0};
+    std::vector<uint8_t> wav(sizeof(header) + samples.size());
+    std::copy(std::begin(header), std::end(header), wav.begin());
+    std::copy(samples.begin(), samples.end(), wav.begin() + sizeof(header));
+    TestHelpers::WriteBinaryFile(coverPath, wav);
+
+    int embedCode = RunCLI({
+        "embed",
+        "-i", coverPath,
+        "-d", dataPath,
+        "-m", "wav",
+        "-o", stegoPath,
+        "-p", "wavpass"
+    });
+    ASSERT_EQ(embedCode, 0);
+    EXPECT_EQ(TestHelpers::ReadBinaryFile(coverPath), wav); // cover is never written through the mapping
+
+    int extractCode = RunCLI({
+        "extract",
+        "-i", stegoPath,
+        "-m", "6",
+        "-o", extractPath,
+        "-p", "wavpass"
+    });
+    ASSERT_EQ(extractCode, 0);
+
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, E2E_Y4MWorkflow) {
+    auto coverPath = TestHelpers::GetOutputPath("cli_cover.y4m").string();
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_workflow_y4m.y4m").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_workflow_y4m.txt").string();
+
+    // 4:2:0 64x64 stream, the payload spans several frames
+    const std::string header = "YUV4MPEG2 W64 H64 F30:1 C420jpeg\n";
+    std::vector<uint8_t> y4m(header.begin(), header.end());
+    for (int frame = 0; frame < 30; ++frame) {
+        const std::string frameHeader = "FRAME\n";
+        auto samples = TestHelpers::GenerateRandomData(64 * 64 * 3 / 2);
+        y4m.insert(y4m.end(), frameHeader.begin(), frameHeader.end());
+        y4m.insert(y4m.end(), samples.begin(), samples.end());
+    }
+    TestHelpers::WriteBinaryFile(coverPath, y4m);
+
+    int embedCode = RunCLI({
+        "embed",
+        "-i", coverPath,
+        "-d", dataPath,
+        "-m", "y4m",
+        "-o", stegoPath,
+        "-p", "y4mpass"
+    });
+    ASSERT_EQ(embedCode, 0);
+
+    int extractCode = RunCLI({
+        "extract",
+        "-i", stegoPath,
+        "-m", "8",
+        "-o", extractPath,
+        "-p", "y4mpass"
+    });
+    ASSERT_EQ(extractCode, 0);
+
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, Embed_MaskRejectedForDCT) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_gray.jpg").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_mask_dct.jpg").string();
+
+    int exitCode = RunCLI({
+        "embed",
+        "-i", coverPath,
+        "-d", dataPath,
+        "-m", "dct",
+        "-c", "r",
+        "-o", stegoPath,
+        "-p", "pass"
+    });
+    EXPECT_NE(exitCode, 0);
+    EXPECT_FALSE(fs::exists(stegoPath));
+}
+
+TEST_F(CLITest, Embed_MemoryLimitRejectsZeroAndOverflow) {
+    auto coverPath = TestHelpers::GetFixturePath("small_gray.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_memory.png").string();
+
+    // 0, and sizes whose shift overflows size_t, must not become a limit of 0 or a wrapped value
+    for (const char *limit : {"0", "0G", "17179869184G", "999999999999G"}) {
+        int exitCode = RunCLI({"embed", "-i", coverPath, "-d", dataPath, "-o", stegoPath, "-p", "pass",
+                               "--max-memory", limit});
+        EXPECT_NE(exitCode, 0) << limit;
+        EXPECT_FALSE(fs::exists(stegoPath)) << limit;
+    }
+
+    EXPECT_EQ(RunCLI({"embed", "-i", coverPath, "-d", dataPath, "-o", stegoPath, "-p", "pass",
+                      "--max-memory", "512M"}), 0);
+    EXPECT_TRUE(fs::exists(stegoPath));
+}
+
+// Auto-detect Extraction Tests
+
+TEST_F(CLITest, Extract_AutoDetectsMethodWhenOmitted) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_rgb.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_auto_shuffle.png").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_auto_shuffle.txt").string();
+
+    ASSERT_EQ(RunCLI({"embed", "-i", coverPath, "-d", dataPath, "-m", "lsbshuffle", "-o", stegoPath, "-p", "autopass"}), 0);
+
+    int extractCode = RunCLI({"extract", "-i", stegoPath, "-o", extractPath, "-p", "autopass"});
+    ASSERT_EQ(extractCode, 0);
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, Extract_AutoDetectsDCT) {
+    auto coverPath = TestHelpers::GetOutputPath("cli_auto_cover.jpg").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, TestHelpers::GenerateRandomData(128 * 128 * 3), 128, 128, 3).IsSuccess());
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_auto_dct.jpg").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_auto_dct.txt").string();
+
+    ASSERT_EQ(RunCLI({"embed", "-i", coverPath, "-d", dataPath, "-m", "dct", "-o", stegoPath, "-p", "autopass"}), 0);
+
+    int extractCode = RunCLI({"extract", "-i", stegoPath, "-m", "auto", "-o", extractPath, "-p", "autopass"});
+    ASSERT_EQ(extractCode, 0);
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
+TEST_F(CLITest, Extract_AutoWithWrongPasswordFails) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_rgb.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("cli_auto_wrong.png").string();
+    auto extractPath = TestHelpers::GetOutputPath("cli_auto_wrong.txt").string();
+
+    ASSERT_EQ(RunCLI({"embed", "-i", coverPath, "-d", dataPath, "-m", "hamming", "-o", stegoPath, "-p", "right"}), 0);
+
+    EXPECT_NE(RunCLI({"extract", "-i", stegoPath, "-m", "auto", "-o", extractPath, "-p", "wrong"}), 0);
+    EXPECT_FALSE(fs::exists(extractPath));
+}
+
+// Analyze Tests
+
+TEST_F(CLITest, Analyze_FlagsStegoImageInDirectory) {
+    auto coverPath = TestHelpers::GetFixturePath("large_gray.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("large.txt").string();
+    auto corpusDir = TestHelpers::GetOutputPath("corpus");
+    auto stegoPath = (corpusDir / "stego.png").string();
+    auto reportPath = TestHelpers::GetOutputPath("report.json").string();
+    fs::create_directories(corpusDir);
+    fs::copy_file(coverPath, corpusDir / "cover.png");
+
+    ASSERT_EQ(RunCLI({"embed", "-i", coverPath, "-d", dataPath, "-m", "lsb", "-o", stegoPath, "-p", "pass"}), 0);
+
+    int exitCode = RunCLI({"analyze", "-i", corpusDir.string(), "-o", reportPath});
+    ASSERT_EQ(exitCode, 0);
+
+    std::string report = TestHelpers::ReadTextFile(reportPath);
+    EXPECT_NE(report.find("cover.png"), std::string::npos);
+    EXPECT_NE(report.find("stego.png"), std::string::npos);
+    EXPECT_NE(report.find("\"rs\": "), std::string::npos);
+}
+
+TEST_F(CLITest, Analyze_UnreadableImageFails) {
+    auto corpusDir = TestHelpers::GetOutputPath("corpus");
+    auto reportPath = TestHelpers::GetOutputPath("report.json").string();
+    fs::create_directories(corpusDir);
+    fs::copy_file(TestHelpers::GetFixturePath("small_rgb.png"), corpusDir / "good.png");
+    TestHelpers::WriteBinaryFile(corpusDir / "truncated.png", {0x89, 'P', 'N', 'G'});
+
+    // Every other image is still reported, but the command fails either way
+    EXPECT_NE(RunCLI({"analyze", "-i", corpusDir.string(), "-o", reportPath}), 0);
+    EXPECT_NE(TestHelpers::ReadTextFile(reportPath).find("good.png"), std::string::npos);
+    EXPECT_NE(RunCLI({"analyze", "-i", corpusDir.string()}), 0);
+    EXPECT_EQ(RunCLI({"analyze", "-i", TestHelpers::GetFixturePath("small_rgb.png").string()}), 0);
+}
+
+TEST_F(CLITest, Analyze_MissingPathFails) {
+    EXPECT_NE(RunCLI({"analyze", "-i", TestHelpers::GetOutputPath("missing_dir").string()}), 0);
+    EXPECT_NE(RunCLI({"analyze"}), 0);
+}
+
 // Version/Info Tests
 
 TEST_F(CLITest, Version_ShowsVersionInfo) {
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "algorithms/lsb/ordered/LSBStegoHandlerOrdered.h"
 #include "algorithms/lsb/shuffle/LSBStegoHandlerShuffle.h"
+#include "algorithms/lsb/matching/LSBStegoHandlerMatching.h"
+#include "algorithms/lsb/hamming/LSBStegoHandlerHamming.h"
+#include "algorithms/lsb/adaptive/LSBStegoHandlerAdaptive.h"
 #include "utils/CryptoModule.h"
 #include "utils/ImageIO.h"
 #include "../test_helpers.h"
@@ -413,6 +416,37 @@ TEST_P(EmbedExtractTest, TinyImageInsufficientCapacity) {
     EXPECT_EQ(embedResult.GetErrorCode(), ErrorCode::InsufficientCapacity);
 }
 
+TEST_P(EmbedExtractTest, MemoryLimitBelowEstimateFailsEarly) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_gray.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego_limited.png").string();
+
+    auto handler = CreateHandler();
+    handler->SetMemoryLimit(1024);
+
+    auto embedResult = handler->Embed(coverPath, dataPath, stegoPath, "limited");
+    EXPECT_EQ(embedResult.GetErrorCode(), ErrorCode::MemoryLimitExceeded);
+    EXPECT_FALSE(TestHelpers::FileExists(stegoPath));
+}
+
+TEST_P(EmbedExtractTest, MemoryLimitAboveEstimateRoundTrips) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_gray.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego_limited.png").string();
+    auto extractPath = TestHelpers::GetOutputPath("extracted_limited.txt").string();
+
+    auto handler = CreateHandler();
+    handler->SetMemoryLimit(std::size_t(256) << 20);
+
+    auto embedResult = handler->Embed(coverPath, dataPath, stegoPath, "limited");
+    ASSERT_TRUE(embedResult.IsSuccess()) << embedResult.GetErrorMessage();
+
+    auto extractResult = handler->Extract(stegoPath, extractPath, "limited");
+    ASSERT_TRUE(extractResult.IsSuccess());
+
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+}
+
 
 
 
@@ -422,6 +456,9 @@ INSTANTIATE_TEST_SUITE_P(
     EmbedExtractTest,
     ::testing::Values(
         []() { return std::make_unique<LSBStegoHandlerOrdered>(); },
-        []() { return std::make_unique<LSBStegoHandlerShuffle>(); }
+        []() { return std::make_unique<LSBStegoHandlerShuffle>(); },
+        []() { return std::make_unique<LSBStegoHandlerMatching>(); },
+        []() { return std::make_unique<LSBStegoHandlerHamming>(); },
+        []() { return std::make_unique<LSBStegoHandlerAdaptive>(); }
     )
 );
\ No newline at end of file
@@ -0,0 +1,98 @@
+// Writes synthetic covers and payloads, e.g. to reproduce a perf_regression scenario by hand:
+//   generate_covers --megapixels 24 --channels 3 --pattern photo -o cover.png
+//   generate_covers --payload 4M -o payload.bin
+#include "synthetic_cover.h"
+#include "test_helpers.h"
+
+#include <cxxopts.hpp>
+#include <iostream>
+
+namespace {
+
+std::size_t ParseSize(const std::string &text) {
+    std::size_t end = 0;
+    unsigned long long value = std::stoull(text, &end);
+    std::string suffix = text.substr(end);
+    if (suffix == "K" || suffix == "k") {
+        value <<= 10;
+    } else if (suffix == "M" || suffix == "m") {
+        value <<= 20;
+    } else if (suffix == "G" || suffix == "g") {
+        value <<= 30;
+    } else if (!suffix.empty()) {
+        throw std::invalid_argument("unknown size suffix '" + suffix + "'");
+    }
+    return static_cast<std::size_t>(value);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    cxxopts::Options options("generate_covers", "Generate deterministic synthetic covers and payloads");
+    options.add_options()
+        ("h,help", "Display this help message")
+        ("o,output", "Output file (.png for covers, anything else for payloads)", cxxopts::value<std::string>())
+        ("megapixels", "Cover size in million pixels, 4:3", cxxopts::value<double>())
+        ("width", "Cover width", cxxopts::value<int>())
+        ("height", "Cover height", cxxopts::value<int>())
+        ("channels", "Channels per pixel (1-4)", cxxopts::value<int>()->default_value("3"))
+        ("pattern", "noise, gradient or photo", cxxopts::value<std::string>()->default_value("photo"))
+        ("seed", "Seed; same seed, same output", cxxopts::value<uint64_t>()->default_value("1"))
+        ("payload", "Write a random payload of this size instead (e.g. 4M)", cxxopts::value<std::string>());
+
+    try {
+        auto parsed = options.parse(argc, argv);
+        if (parsed.count("help") || !parsed.count("output")) {
+            std::cout << options.help() << "\n";
+            return parsed.count("help") ? 0 : 1;
+        }
+        std::string output = parsed["output"].as<std::string>();
+        uint64_t seed = parsed["seed"].as<uint64_t>();
+
+        if (parsed.count("payload")) {
+            TestHelpers::WriteBinaryFile(output, SyntheticCover::GeneratePayload(ParseSize(parsed["payload"].as<std::string>()), seed));
+            return 0;
+        }
+
+        auto patternResult = SyntheticCover::ParsePattern(parsed["pattern"].as<std::string>());
+        if (!patternResult) {
+            std::cerr << "Error: " << patternResult.GetErrorMessage() << "\n";
+            return 1;
+        }
+        int channels = parsed["channels"].as<int>();
+        if (channels < 1 || channels > 4) {
+            std::cerr << "Error: --channels must be between 1 and 4\n";
+            return 1;
+        }
+
+        SyntheticCover::Spec spec;
+        if (parsed.count("megapixels")) {
+            spec = SyntheticCover::FromMegapixels(parsed["megapixels"].as<double>(), channels, patternResult.GetValue(), seed);
+        } else if (parsed.count("width") && parsed.count("height")) {
+            spec.width = parsed["width"].as<int>();
+            spec.height = parsed["height"].as<int>();
+            spec.channels = channels;
+            spec.pattern = patternResult.GetValue();
+            spec.seed = seed;
+        } else {
+            std::cerr << "Error: give --megapixels or --width and --height\n";
+            return 1;
+        }
+        if (spec.width < 1 || spec.height < 1) {
+            std::cerr << "Error: cover dimensions must be positive\n";
+            return 1;
+        }
+
+        auto saveResult = ImageIO::Save(output, SyntheticCover::Generate(spec));
+        if (!saveResult) {
+            std::cerr << "Error: " << saveResult.GetErrorMessage() << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << spec.width << "x" << spec.height << "x" << spec.channels << " "
+                  << SyntheticCover::GetPatternName(spec.pattern) << " cover to " << output << "\n";
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
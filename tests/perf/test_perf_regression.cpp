@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include "algorithms/lsb/ordered/LSBStegoHandlerOrdered.h"
+#include "algorithms/lsb/shuffle/LSBStegoHandlerShuffle.h"
+#include "algorithms/lsb/tiled/LSBStegoHandlerTiled.h"
+#include "utils/CryptoModule.h"
+#include "utils/ImageIO.h"
+#include "utils/Stats.h"
+#include "../synthetic_cover.h"
+#include "../test_helpers.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Budgets are the times and peaks measured on the reference machine (1 core, Release build).
+// A scenario fails when it takes more than budget * (1 + tolerance). After a change that is
+// meant to cost more, or on a machine that is slower, update the budget or use the environment:
+//   STEGTOOL_PERF_TOLERANCE   allowed regression as a fraction (default 0.25)
+//   STEGTOOL_PERF_TIME_SCALE  factor for the time budgets, for slower machines (default 1)
+//   STEGTOOL_PERF_HUGE        set to 1 to also run the 200 MP scenarios
+struct Scenario {
+    const char *name;
+    std::function<std::unique_ptr<StegoHandler>()> createHandler;
+    double megapixels;
+    int channels;
+    SyntheticCover::Pattern pattern;
+    double payloadFraction;     // Of one bit per sample
+    double embedBudgetMs;       // Load cover and payload, encrypt, embed, save
+    double extractBudgetMs;     // Load stego image, extract, decrypt, save
+    double peakBudgetMb;        // Peak resident memory over both
+    bool huge;
+};
+
+void PrintTo(const Scenario &scenario, std::ostream *out) {
+    *out << scenario.name;
+}
+
+double GetEnvDouble(const char *name, double fallback) {
+    const char *value = std::getenv(name);
+    return value != nullptr && *value != '\0' ? std::atof(value) : fallback;
+}
+
+// Peak RSS can only be measured per scenario where the kernel lets us reset it
+#ifdef __linux__
+bool ResetPeakMemory() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    return static_cast<bool>(clearRefs << "5");
+}
+
+uint64_t ReadPeakMemory() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+}
+#else
+bool ResetPeakMemory() {
+    return false;
+}
+
+uint64_t ReadPeakMemory() {
+    return Stats::GetPeakRss();
+}
+#endif
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+class PerfRegressionTest : public ::testing::TestWithParam<Scenario> {
+protected:
+    // Covers are deterministic, so they are generated once and kept in the build tree
+    static fs::path GetWorkDir() {
+        return fs::path(PERF_WORK_DIR);
+    }
+
+    static void EnsureCover(const Scenario &scenario, const fs::path &coverPath, const fs::path &payloadPath) {
+        SyntheticCover::Spec spec = SyntheticCover::FromMegapixels(scenario.megapixels, scenario.channels, scenario.pattern);
+        if (!fs::exists(coverPath)) {
+            fs::path partial = coverPath;
+            partial.replace_extension(".partial.png");
+            auto saveResult = ImageIO::Save(partial.string(), SyntheticCover::Generate(spec));
+            ASSERT_TRUE(saveResult.IsSuccess()) << saveResult.GetErrorMessage();
+            fs::rename(partial, coverPath);
+        }
+
+        std::size_t samples = static_cast<std::size_t>(spec.width) * spec.height * spec.channels;
+        std::size_t payloadSize = static_cast<std::size_t>(static_cast<double>(samples / 8) * scenario.payloadFraction);
+        if (!fs::exists(payloadPath) || fs::file_size(payloadPath) != payloadSize) {
+            TestHelpers::WriteBinaryFile(payloadPath, SyntheticCover::GeneratePayload(payloadSize));
+        }
+    }
+};
+
+TEST_P(PerfRegressionTest, StaysWithinBudget) {
+    const Scenario &scenario = GetParam();
+    if (scenario.huge && GetEnvDouble("STEGTOOL_PERF_HUGE", 0) == 0) {
+        GTEST_SKIP() << "Set STEGTOOL_PERF_HUGE=1 to run the 200 MP scenarios";
+    }
+
+    fs::create_directories(GetWorkDir());
+    fs::path coverPath = GetWorkDir() / (std::string(scenario.name) + "_cover.png");
+    fs::path payloadPath = GetWorkDir() / (std::string(scenario.name) + "_payload.bin");
+    fs::path stegoPath = GetWorkDir() / (std::string(scenario.name) + "_stego.png");
+    fs::path extractPath = GetWorkDir() / (std::string(scenario.name) + "_extracted.bin");
+    EnsureCover(scenario, coverPath, payloadPath);
+    if (HasFatalFailure()) {
+        return;
+    }
+
+    auto handler = scenario.createHandler();
+    bool peakMeasured = ResetPeakMemory();
+
+    auto start = std::chrono::steady_clock::now();
+    auto embedResult = handler->Embed(coverPath.string(), payloadPath.string(), stegoPath.string(), "perfpass");
+    double embedMs = MillisecondsSince(start);
+    ASSERT_TRUE(embedResult.IsSuccess()) << embedResult.GetErrorMessage();
+
+    start = std::chrono::steady_clock::now();
+    auto extractResult = handler->Extract(stegoPath.string(), extractPath.string(), "perfpass");
+    double extractMs = MillisecondsSince(start);
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+
+    double peakMb = static_cast<double>(ReadPeakMemory()) / (1024.0 * 1024.0);
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(payloadPath, extractPath));
+    fs::remove(stegoPath);
+    fs::remove(extractPath);
+
+    double tolerance = 1.0 + GetEnvDouble("STEGTOOL_PERF_TOLERANCE", 0.25);
+    double timeScale = GetEnvDouble("STEGTOOL_PERF_TIME_SCALE", 1.0);
+
+    std::cout << "[ PERF     ] " << scenario.name << ": embed " << embedMs << " ms (budget "
+              << scenario.embedBudgetMs * timeScale << "), extract " << extractMs << " ms (budget "
+              << scenario.extractBudgetMs * timeScale << "), peak " << peakMb << " MB (budget "
+              << scenario.peakBudgetMb << ")\n";
+    RecordProperty("embedMs", std::to_string(embedMs));
+    RecordProperty("extractMs", std::to_string(extractMs));
+    RecordProperty("peakMb", std::to_string(peakMb));
+
+    EXPECT_LE(embedMs, scenario.embedBudgetMs * timeScale * tolerance) << "Embedding got slower";
+    EXPECT_LE(extractMs, scenario.extractBudgetMs * timeScale * tolerance) << "Extraction got slower";
+    if (peakMeasured) {
+        EXPECT_LE(peakMb, scenario.peakBudgetMb * tolerance) << "Peak memory grew";
+    }
+}
+
+// Wrong-password extraction with and without the key check. Without it the full PBKDF2 run and
+// the HMAC check run before the password is rejected; with it one HKDF call and a CRC do. The
+// cover is small so that image decoding does not hide the difference, and each extraction is
+// repeated and the fastest run kept.
+TEST_F(PerfRegressionTest, KeyCheckRejectsWrongPasswordsEarly) {
+    constexpr int REPEATS = 7;
+    Scenario scenario{"lsb_rgb_photo_wrongpass_025mp", nullptr, 0.25, 3, SyntheticCover::Pattern::Photo,
+                      0.05, 0, 0, 0, false};
+
+    fs::create_directories(GetWorkDir());
+    fs::path coverPath = GetWorkDir() / (std::string(scenario.name) + "_cover.png");
+    fs::path payloadPath = GetWorkDir() / (std::string(scenario.name) + "_payload.bin");
+    fs::path extractPath = GetWorkDir() / (std::string(scenario.name) + "_extracted.bin");
+    EnsureCover(scenario, coverPath, payloadPath);
+    if (HasFatalFailure()) {
+        return;
+    }
+
+    double fastestMs[2] = {0, 0};
+    for (bool keyCheck : {false, true}) {
+        fs::path stegoPath = GetWorkDir() / (std::string(scenario.name) + (keyCheck ? "_k" : "") + "_stego.png");
+        LSBStegoHandlerOrdered handler;
+        handler.SetKeyCheck(keyCheck);
+        auto embedResult = handler.Embed(coverPath.string(), payloadPath.string(), stegoPath.string(), "perfpass");
+        ASSERT_TRUE(embedResult.IsSuccess()) << embedResult.GetErrorMessage();
+
+        double &fastest = fastestMs[keyCheck ? 1 : 0];
+        for (int run = 0; run < REPEATS; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            auto extractResult = handler.Extract(stegoPath.string(), extractPath.string(), "wrongpass");
+            double ms = MillisecondsSince(start);
+            ASSERT_EQ(extractResult.GetErrorCode(), ErrorCode::AuthenticationFailed);
+            fastest = run == 0 ? ms : std::min(fastest, ms);
+        }
+        fs::remove(stegoPath);
+    }
+    EXPECT_FALSE(fs::exists(extractPath));
+
+    std::cout << "[ PERF     ] " << scenario.name << ": wrong password rejected in " << fastestMs[0]
+              << " ms without -k, " << fastestMs[1] << " ms with -k (saves " << fastestMs[0] - fastestMs[1]
+              << " ms, " << CryptoModule::PBKDF2_ITERATIONS << " PBKDF2 iterations)\n";
+    RecordProperty("wrongPasswordMs", std::to_string(fastestMs[0]));
+    RecordProperty("wrongPasswordKeyCheckMs", std::to_string(fastestMs[1]));
+
+    EXPECT_LT(fastestMs[1], fastestMs[0]) << "The key check no longer rejects before the KDF";
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Scenarios,
+    PerfRegressionTest,
+    ::testing::Values(
+        Scenario{"lsb_gray_noise_16mp", []() { return std::make_unique<LSBStegoHandlerOrdered>(); },
+                 16, 1, SyntheticCover::Pattern::Noise, 0.9, 1100, 120, 45, false},
+        Scenario{"lsb_rgb_photo_24mp", []() { return std::make_unique<LSBStegoHandlerOrdered>(); },
+                 24, 3, SyntheticCover::Pattern::Photo, 0.5, 10000, 1000, 190, false},
+        Scenario{"lsb_rgb_photo_keycheck_8mp",
+                 []() {
+                     auto handler = std::make_unique<LSBStegoHandlerOrdered>();
+                     handler->SetKeyCheck(true);
+                     return handler;
+                 },
+                 8, 3, SyntheticCover::Pattern::Photo, 0.5, 3000, 310, 75, false},
+        Scenario{"lsbshuffle_rgb_photo_12mp", []() { return std::make_unique<LSBStegoHandlerShuffle>(); },
+                 12, 3, SyntheticCover::Pattern::Photo, 0.5, 6000, 2000, 300, false},
+        Scenario{"lsbtile_rgba_gradient_32mp", []() { return std::make_unique<LSBStegoHandlerTiled>(); },
+                 32, 4, SyntheticCover::Pattern::Gradient, 0.25, 20000, 1700, 300, false},
+        Scenario{"lsbtile_rgb_photo_200mp", []() { return std::make_unique<LSBStegoHandlerTiled>(); },
+                 200, 3, SyntheticCover::Pattern::Photo, 0.1, 85000, 9500, 1200, true}
+    ),
+    [](const ::testing::TestParamInfo<Scenario> &info) { return std::string(info.param.name); }
+);
@@ -0,0 +1,50 @@
+#ifndef __SIMD_LEVEL_TEST_H_
+#define __SIMD_LEVEL_TEST_H_
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <ostream>
+#include <string>
+#include "utils/CpuFeatures.h"
+
+inline std::string GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2: return "Avx2";
+        case SimdLevel::Ssse3: return "Ssse3";
+        case SimdLevel::Portable: break;
+    }
+    return "Portable";
+}
+
+inline void PrintTo(SimdLevel level, std::ostream *out) {
+    *out << GetSimdLevelName(level);
+}
+
+// Every kernel level, for INSTANTIATE_TEST_SUITE_P over a SimdLevelTest
+inline auto AllSimdLevels() {
+    return ::testing::Values(SimdLevel::Portable, SimdLevel::Ssse3, SimdLevel::Avx2);
+}
+
+inline std::string SimdLevelParamName(const ::testing::TestParamInfo<SimdLevel> &info) {
+    return GetSimdLevelName(info.param);
+}
+
+// Runs each test with the kernels forced to one level, skipping levels the CPU lacks
+class SimdLevelTest : public ::testing::TestWithParam<SimdLevel> {
+protected:
+    void SetUp() override {
+        if (!CpuFeatures::Supports(GetParam())) {
+            GTEST_SKIP() << "CPU has no " << GetSimdLevelName(GetParam()) << " support";
+        }
+        level_ = std::make_unique<CpuFeatures::ScopedSimdLevel>(GetParam());
+    }
+
+    void TearDown() override {
+        level_.reset();
+    }
+
+private:
+    std::unique_ptr<CpuFeatures::ScopedSimdLevel> level_;
+};
+
+#endif // __SIMD_LEVEL_TEST_H_
@@ -0,0 +1,242 @@
+#include "synthetic_cover.h"
+#include "utils/CounterRNG.h"
+#include "utils/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr std::size_t ROWS_PER_TASK = 64;
+constexpr std::size_t SHAPE_COUNT = 12;
+constexpr uint64_t SHAPE_STREAM = 0x5348415045ULL;   // Keeps shape parameters apart from the grain stream
+constexpr uint64_t PAYLOAD_STREAM = 0x5041594CULL;
+
+struct Ellipse {
+    double centerX;
+    double centerY;
+    double radiusX;
+    double radiusY;
+    std::array<int, 4> color;
+};
+
+// Uniform value in [0, 1) from a 32-bit word
+double Unit(uint32_t word) {
+    return static_cast<double>(word) / 4294967296.0;
+}
+
+uint8_t Clamp(int value) {
+    return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+}
+
+// Byte idx of a word stream, little endian on every host
+uint8_t ByteOf(const std::vector<uint32_t> &words, std::size_t idx) {
+    return static_cast<uint8_t>(words[idx / 4] >> (8 * (idx % 4)));
+}
+
+// Random words of one row, counters never overlap between rows
+void FillRow(const CounterRNG &rng, std::size_t row, std::size_t rowSamples, std::vector<uint32_t> &words) {
+    std::size_t wordCount = (rowSamples + 3) / 4;
+    std::size_t blocksPerRow = (wordCount + CounterRNG::WORDS_PER_BLOCK - 1) / CounterRNG::WORDS_PER_BLOCK;
+    words.resize(wordCount);
+    rng.Fill(static_cast<uint64_t>(row) * blocksPerRow, words.data(), wordCount);
+}
+
+void GenerateNoiseRow(const CounterRNG &rng, std::size_t row, uint8_t *out, std::size_t rowSamples,
+                      std::vector<uint32_t> &words) {
+    FillRow(rng, row, rowSamples, words);
+    for (std::size_t idx = 0; idx < rowSamples; ++idx) {
+        out[idx] = ByteOf(words, idx);
+    }
+}
+
+void GenerateGradientRow(const SyntheticCover::Spec &spec, std::size_t row, uint8_t *out) {
+    int width = spec.width;
+    int height = spec.height;
+    int y = static_cast<int>(row);
+    int yRamp = height > 1 ? y * 255 / (height - 1) : 0;
+
+    for (int x = 0; x < width; ++x) {
+        int xRamp = width > 1 ? x * 255 / (width - 1) : 0;
+        uint8_t *pixel = out + static_cast<std::size_t>(x) * spec.channels;
+        if (spec.channels == 1) {
+            pixel[0] = static_cast<uint8_t>((xRamp + yRamp) / 2);
+            continue;
+        }
+        pixel[0] = static_cast<uint8_t>(xRamp);
+        pixel[1] = static_cast<uint8_t>(yRamp);
+        if (spec.channels > 2) {
+            pixel[2] = static_cast<uint8_t>(255 - (xRamp + yRamp) / 2);
+        }
+        if (spec.channels > 3) {
+            pixel[3] = static_cast<uint8_t>(255 - xRamp / 4);
+        }
+    }
+}
+
+// Separable shading per channel: column and row waves are computed once
+struct PhotoModel {
+    std::vector<std::vector<int>> columnShade;
+    std::vector<std::vector<int>> rowShade;
+    std::vector<Ellipse> shapes;
+};
+
+PhotoModel BuildPhotoModel(const SyntheticCover::Spec &spec) {
+    CounterRNG rng(spec.seed ^ SHAPE_STREAM);
+    PhotoModel model;
+    model.columnShade.resize(spec.channels);
+    model.rowShade.resize(spec.channels);
+
+    for (int channel = 0; channel < spec.channels; ++channel) {
+        CounterRNG::Block wave = rng.Generate(static_cast<uint64_t>(channel));
+        double columnFrequency = 1.0 + 3.0 * Unit(wave[0]);
+        double rowFrequency = 1.0 + 3.0 * Unit(wave[1]);
+        double columnPhase = 2.0 * PI * Unit(wave[2]);
+        double rowPhase = 2.0 * PI * Unit(wave[3]);
+
+        model.columnShade[channel].resize(spec.width);
+        for (int x = 0; x < spec.width; ++x) {
+            double t = static_cast<double>(x) / spec.width;
+            model.columnShade[channel][x] = static_cast<int>(std::lround(
+                45.0 * std::sin(2.0 * PI * columnFrequency * t + columnPhase)));
+        }
+        model.rowShade[channel].resize(spec.height);
+        for (int y = 0; y < spec.height; ++y) {
+            double t = static_cast<double>(y) / spec.height;
+            model.rowShade[channel][y] = static_cast<int>(std::lround(
+                35.0 * std::sin(2.0 * PI * rowFrequency * t + rowPhase)));
+        }
+    }
+
+    for (std::size_t idx = 0; idx < SHAPE_COUNT; ++idx) {
+        CounterRNG::Block geometry = rng.Generate(1000 + 2 * idx);
+        CounterRNG::Block color = rng.Generate(1001 + 2 * idx);
+        Ellipse shape;
+        shape.centerX = Unit(geometry[0]) * spec.width;
+        shape.centerY = Unit(geometry[1]) * spec.height;
+        shape.radiusX = (0.04 + 0.2 * Unit(geometry[2])) * spec.width;
+        shape.radiusY = (0.04 + 0.2 * Unit(geometry[3])) * spec.height;
+        for (std::size_t channel = 0; channel < shape.color.size(); ++channel) {
+            shape.color[channel] = static_cast<int>(color[channel] % 200) - 100;
+        }
+        model.shapes.push_back(shape);
+    }
+    return model;
+}
+
+void GeneratePhotoRow(const SyntheticCover::Spec &spec, const PhotoModel &model, const CounterRNG &rng,
+                      std::size_t row, uint8_t *out, std::vector<int> &offsets, std::vector<uint32_t> &words) {
+    int width = spec.width;
+    int channels = spec.channels;
+    std::size_t rowSamples = static_cast<std::size_t>(width) * channels;
+    double y = static_cast<double>(row) + 0.5;
+
+    // Shapes are flat offsets over the shading; later shapes cover earlier ones
+    offsets.assign(rowSamples, 0);
+    for (const Ellipse &shape : model.shapes) {
+        double dy = (y - shape.centerY) / shape.radiusY;
+        if (dy <= -1.0 || dy >= 1.0) {
+            continue;
+        }
+        double halfWidth = shape.radiusX * std::sqrt(1.0 - dy * dy);
+        int first = std::max(0, static_cast<int>(std::ceil(shape.centerX - halfWidth - 0.5)));
+        int last = std::min(width - 1, static_cast<int>(std::floor(shape.centerX + halfWidth - 0.5)));
+        for (int x = first; x <= last; ++x) {
+            for (int channel = 0; channel < channels; ++channel) {
+                offsets[static_cast<std::size_t>(x) * channels + channel] = shape.color[channel];
+            }
+        }
+    }
+
+    // Fine grain of +-6 levels, like sensor noise
+    FillRow(rng, row, rowSamples, words);
+    bool hasAlpha = channels == 2 || channels == 4;
+
+    for (int x = 0; x < width; ++x) {
+        for (int channel = 0; channel < channels; ++channel) {
+            std::size_t idx = static_cast<std::size_t>(x) * channels + channel;
+            if (hasAlpha && channel == channels - 1) {
+                out[idx] = 255;
+                continue;
+            }
+            int value = 128 + model.columnShade[channel][x] + model.rowShade[channel][row] + offsets[idx]
+                      + static_cast<int>(ByteOf(words, idx) % 13) - 6;
+            out[idx] = Clamp(value);
+        }
+    }
+}
+
+} // namespace
+
+SyntheticCover::Spec SyntheticCover::FromMegapixels(double megapixels, int channels, Pattern pattern, uint64_t seed) {
+    Spec spec;
+    spec.width = std::max(1, static_cast<int>(std::lround(std::sqrt(megapixels * 1e6 * 4.0 / 3.0))));
+    spec.height = std::max(1, static_cast<int>(std::lround(spec.width * 3.0 / 4.0)));
+    spec.channels = channels;
+    spec.pattern = pattern;
+    spec.seed = seed;
+    return spec;
+}
+
+ImageData SyntheticCover::Generate(const Spec& spec) {
+    std::size_t rowSamples = static_cast<std::size_t>(spec.width) * spec.channels;
+    ImageData image(std::vector<uint8_t>(rowSamples * spec.height), spec.width, spec.height, spec.channels);
+
+    CounterRNG rng(spec.seed);
+    PhotoModel model;
+    if (spec.pattern == Pattern::Photo) {
+        model = BuildPhotoModel(spec);
+    }
+
+    std::size_t height = static_cast<std::size_t>(spec.height);
+    Parallel::For((height + ROWS_PER_TASK - 1) / ROWS_PER_TASK, [&](std::size_t task) {
+        std::vector<uint32_t> words;
+        std::vector<int> offsets;
+        std::size_t end = std::min(height, (task + 1) * ROWS_PER_TASK);
+        for (std::size_t row = task * ROWS_PER_TASK; row < end; ++row) {
+            uint8_t *out = image.pixels.data() + row * rowSamples;
+            switch (spec.pattern) {
+                case Pattern::Noise:
+                    GenerateNoiseRow(rng, row, out, rowSamples, words);
+                    break;
+                case Pattern::Gradient:
+                    GenerateGradientRow(spec, row, out);
+                    break;
+                case Pattern::Photo:
+                    GeneratePhotoRow(spec, model, rng, row, out, offsets, words);
+                    break;
+            }
+        }
+    });
+    return image;
+}
+
+std::vector<uint8_t> SyntheticCover::GeneratePayload(std::size_t size, uint64_t seed) {
+    std::vector<uint32_t> words((size + 3) / 4);
+    CounterRNG(seed ^ PAYLOAD_STREAM).Fill(0, words.data(), words.size());
+    std::vector<uint8_t> payload(size);
+    for (std::size_t idx = 0; idx < size; ++idx) {
+        payload[idx] = ByteOf(words, idx);
+    }
+    return payload;
+}
+
+const char* SyntheticCover::GetPatternName(Pattern pattern) {
+    switch (pattern) {
+        case Pattern::Noise: return "noise";
+        case Pattern::Gradient: return "gradient";
+        case Pattern::Photo: return "photo";
+    }
+    return "unknown";
+}
+
+Result<SyntheticCover::Pattern> SyntheticCover::ParsePattern(const std::string& name) {
+    for (Pattern pattern : {Pattern::Noise, Pattern::Gradient, Pattern::Photo}) {
+        if (name == GetPatternName(pattern)) {
+            return Result<Pattern>(pattern);
+        }
+    }
+    return Result<Pattern>(ErrorCode::InvalidArgument, "Unknown pattern '" + name + "' (use noise, gradient or photo)");
+}
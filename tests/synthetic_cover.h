@@ -0,0 +1,45 @@
+#ifndef __SYNTHETIC_COVER_H_
+#define __SYNTHETIC_COVER_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "utils/ErrorHandler.h"
+#include "utils/ImageIO.h"
+
+// Deterministic covers and payloads of any size, for tests that need more than the fixtures.
+// The same spec gives the same image on every run: randomness comes from CounterRNG, not std distributions.
+// Up to 4 channels; photo covers with 2 or 4 channels get an opaque alpha channel.
+class SyntheticCover {
+public:
+    SyntheticCover() = delete;
+
+    enum class Pattern {
+        Noise,      // Uniform random samples, worst case for compression
+        Gradient,   // Smooth ramps, best case for compression and visual detection
+        Photo       // Smooth shading, hard edged shapes and fine grain, like a photograph
+    };
+
+    struct Spec {
+        int width = 0;
+        int height = 0;
+        int channels = 1;
+        Pattern pattern = Pattern::Photo;
+        uint64_t seed = 1;
+    };
+
+    // Spec of a 4:3 image with about `megapixels` million pixels
+    static Spec FromMegapixels(double megapixels, int channels, Pattern pattern, uint64_t seed = 1);
+
+    // Generate the cover described by spec
+    static ImageData Generate(const Spec& spec);
+    // Generate `size` random bytes, incompressible like an encrypted payload
+    static std::vector<uint8_t> GeneratePayload(std::size_t size, uint64_t seed = 1);
+
+    // Pattern names as used on the command line: noise, gradient, photo
+    static const char* GetPatternName(Pattern pattern);
+    static Result<Pattern> ParsePattern(const std::string& name);
+};
+
+#endif // __SYNTHETIC_COVER_H_
@@ -84,7 +84,7 @@ void TestHelpers::CleanOutputDirectory() {
     
     // Clean existing files in the directory
     for (const auto& entry : std::filesystem::directory_iterator(outputDir)) {
-        std::filesystem::remove(entry);
+        std::filesystem::remove_all(entry);
     }
 }
 
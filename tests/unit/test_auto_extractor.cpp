@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "core/AutoExtractor.h"
+#include "algorithms/lsb/ordered/LSBStegoHandlerOrdered.h"
+#include "algorithms/lsb/shuffle/LSBStegoHandlerShuffle.h"
+#include "algorithms/lsb/hamming/LSBStegoHandlerHamming.h"
+#include "algorithms/lsb/adaptive/LSBStegoHandlerAdaptive.h"
+#include "algorithms/frames/apng/APNGStegoHandler.h"
+#include "utils/Parallel.h"
+#include "../test_helpers.h"
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+
+// File-level candidate that records the Parallel threads its loops would get
+class ThreadBudgetProbe : public APNGStegoHandler {
+public:
+    explicit ThreadBudgetProbe(unsigned &threads) : threads_(threads) {}
+
+    Result<> Extract(const std::string &, const std::string &, const std::string &) override {
+        threads_ = Parallel::GetThreadCount();
+        return Result<>(ErrorCode::ExtractionFailed, "probe");
+    }
+
+private:
+    unsigned &threads_;
+};
+
+class ThrowingHandler : public APNGStegoHandler {
+public:
+    Result<> Extract(const std::string &, const std::string &, const std::string &) override {
+        throw std::runtime_error("candidate failed");
+    }
+};
+
+} // namespace
+
+// Test fixture for auto-detect extraction tests with automatic output cleanup
+class AutoExtractorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    void TearDown() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    // Same candidate set the CLI uses for PNG files
+    static std::vector<AutoExtractor::Candidate> PngCandidates() {
+        std::vector<AutoExtractor::Candidate> candidates;
+        candidates.push_back({"lsb", std::make_unique<LSBStegoHandlerOrdered>()});
+        candidates.push_back({"lsbshuffle", std::make_unique<LSBStegoHandlerShuffle>()});
+        candidates.push_back({"hamming", std::make_unique<LSBStegoHandlerHamming>()});
+        candidates.push_back({"adaptive", std::make_unique<LSBStegoHandlerAdaptive>()});
+        candidates.push_back({"apng", std::make_unique<APNGStegoHandler>()});
+        return candidates;
+    }
+
+    static std::size_t CountOutputFiles() {
+        std::size_t count = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(TestHelpers::GetOutputDir())) {
+            (void) entry;
+            ++count;
+        }
+        return count;
+    }
+};
+
+TEST_F(AutoExtractorTest, DetectsEachMethod) {
+    // Noise cover, so the adaptive cost map does not collapse to raster order
+    auto coverPath = TestHelpers::GetOutputPath("cover.png").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, TestHelpers::GenerateRandomData(96 * 96 * 3), 96, 96, 3).IsSuccess());
+    auto dataPath = TestHelpers::GetFixturePath("small.txt");
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+
+    auto candidates = PngCandidates();
+    for (std::size_t method = 0; method < candidates.size(); ++method) {
+        ASSERT_TRUE(candidates[method].handler->Embed(coverPath, dataPath.string(), stegoPath, "pw").IsSuccess())
+            << candidates[method].name;
+
+        auto result = AutoExtractor::Extract(stegoPath, recovered, "pw", PngCandidates());
+        ASSERT_TRUE(result.IsSuccess()) << candidates[method].name << ": " << result.GetErrorMessage();
+        EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, recovered));
+        EXPECT_EQ(CountOutputFiles(), 3u); // no temporary outputs left behind
+
+        // The payload header names the method, even where layouts coincide (apng vs lsb)
+        EXPECT_EQ(result.GetValue(), method);
+    }
+}
+
+TEST_F(AutoExtractorTest, FailedRenameRemovesTemporaryOutput) {
+    auto coverPath = TestHelpers::GetOutputPath("cover.png").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, TestHelpers::GenerateRandomData(64 * 64 * 3), 64, 64, 3).IsSuccess());
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    APNGStegoHandler embedder;
+    ASSERT_TRUE(embedder.Embed(coverPath, TestHelpers::GetFixturePath("small.txt").string(), stegoPath, "pw").IsSuccess());
+
+    // A non-empty directory in place of the output can be neither removed nor replaced
+    auto blocked = TestHelpers::GetOutputPath("blocked");
+    std::filesystem::create_directories(blocked / "inside");
+
+    auto result = AutoExtractor::Extract(stegoPath, blocked.string(), "pw", PngCandidates());
+    EXPECT_EQ(result.GetErrorCode(), ErrorCode::FileWriteError);
+    EXPECT_EQ(CountOutputFiles(), 3u); // cover, stego and the directory, no decrypted temporary
+}
+
+TEST_F(AutoExtractorTest, WrongPasswordListsEveryCandidate) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_rgb.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+
+    LSBStegoHandlerShuffle handler;
+    ASSERT_TRUE(handler.Embed(coverPath, dataPath, stegoPath, "correct").IsSuccess());
+
+    auto result = AutoExtractor::Extract(stegoPath, recovered, "wrong", PngCandidates());
+    ASSERT_FALSE(result.IsSuccess());
+    EXPECT_EQ(result.GetErrorCode(), ErrorCode::ExtractionFailed);
+    for (const char *name : {"lsb:", "lsbshuffle:", "hamming:", "adaptive:", "apng:"}) {
+        EXPECT_NE(result.GetErrorMessage().find(name), std::string::npos) << name;
+    }
+    EXPECT_FALSE(TestHelpers::FileExists(recovered));
+    EXPECT_EQ(CountOutputFiles(), 1u); // only the stego image
+}
+
+TEST_F(AutoExtractorTest, RejectsEmptyCandidateList) {
+    auto stegoPath = TestHelpers::GetFixturePath("small_rgb.png").string();
+    auto result = AutoExtractor::Extract(stegoPath, TestHelpers::GetOutputPath("out.bin").string(), "", {});
+    EXPECT_EQ(result.GetErrorCode(), ErrorCode::InvalidArgument);
+}
+
+TEST_F(AutoExtractorTest, CancelFlagStopsExtraction) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_rgb.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+
+    LSBStegoHandlerOrdered handler;
+    ASSERT_TRUE(handler.Embed(coverPath, dataPath, stegoPath, "pw").IsSuccess());
+    auto image = ImageIO::Load(stegoPath).GetValue();
+
+    std::atomic<bool> cancel{true};
+    handler.SetCancelFlag(&cancel);
+    EXPECT_EQ(handler.ExtractMethod(image, "pw").GetErrorCode(), ErrorCode::OperationCancelled);
+
+    handler.SetCancelFlag(nullptr);
+    EXPECT_TRUE(handler.ExtractMethod(image, "pw").IsSuccess());
+}
+
+TEST_F(AutoExtractorTest, CandidatesSplitTheThreadBudget) {
+    auto stegoPath = TestHelpers::GetFixturePath("small_rgb.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+    Parallel::ScopedThreadBudget budget(5);
+
+    std::vector<unsigned> threads(3, 0);
+    std::vector<AutoExtractor::Candidate> candidates;
+    for (auto &count : threads) {
+        candidates.push_back({"probe", std::make_unique<ThreadBudgetProbe>(count)});
+    }
+    EXPECT_FALSE(AutoExtractor::Extract(stegoPath, recovered, "pw", candidates).IsSuccess());
+    EXPECT_EQ(threads, (std::vector<unsigned>{2, 2, 1}));
+
+    // More candidates than threads still leaves each one thread of its own
+    Parallel::ScopedThreadBudget single(1);
+    EXPECT_FALSE(AutoExtractor::Extract(stegoPath, recovered, "pw", candidates).IsSuccess());
+    EXPECT_EQ(threads, (std::vector<unsigned>{1, 1, 1}));
+}
+
+TEST_F(AutoExtractorTest, RethrowsCandidateExceptionsOnTheCaller) {
+    auto stegoPath = TestHelpers::GetFixturePath("small_rgb.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+
+    auto candidates = PngCandidates();
+    candidates.push_back({"throwing", std::make_unique<ThrowingHandler>()});
+    EXPECT_THROW(AutoExtractor::Extract(stegoPath, recovered, "pw", candidates), std::runtime_error);
+    EXPECT_FALSE(TestHelpers::FileExists(recovered));
+    EXPECT_EQ(CountOutputFiles(), 0u); // no temporary outputs left behind
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "utils/Compression.h"
+#include "algorithms/lsb/ordered/LSBStegoHandlerOrdered.h"
+#include "utils/ImageIO.h"
+#include "../test_helpers.h"
+
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::vector<uint8_t> RoundTrip(const std::vector<uint8_t> &data) {
+    auto block = Compression::Compress(data);
+    auto restored = Compression::Decompress(block, data.size());
+    EXPECT_TRUE(restored.IsSuccess()) << restored.GetErrorMessage();
+    return restored ? restored.GetValue() : std::vector<uint8_t>{};
+}
+
+std::vector<uint8_t> TextData(std::size_t size) {
+    const std::string line = "2024-01-01 12:00:00 INFO request handled in 12 ms\n";
+    std::vector<uint8_t> data(size);
+    for (std::size_t idx = 0; idx < size; ++idx) {
+        data[idx] = static_cast<uint8_t>(line[idx % line.size()]);
+    }
+    return data;
+}
+
+} // namespace
+
+// Block Format Tests
+
+TEST(Compression, RoundTripsEdgeSizes) {
+    for (std::size_t size : {0u, 1u, 4u, 12u, 13u, 17u, 255u, 256u, 70000u}) {
+        auto text = TextData(size);
+        EXPECT_EQ(RoundTrip(text), text) << "size " << size;
+        auto random = TestHelpers::GenerateRandomData(size);
+        EXPECT_EQ(RoundTrip(random), random) << "size " << size;
+    }
+}
+
+TEST(Compression, ShrinksRedundantData) {
+    auto data = TextData(100000);
+    auto block = Compression::Compress(data);
+    EXPECT_EQ(block[0], Compression::MODE_LZ4);
+    EXPECT_LT(block.size(), data.size() / 20);
+
+    // Long runs use overlapping matches and extended lengths
+    std::vector<uint8_t> zeros(100000, 0);
+    EXPECT_EQ(RoundTrip(zeros), zeros);
+    EXPECT_LT(Compression::Compress(zeros).size(), 1000u);
+}
+
+TEST(Compression, StoresIncompressibleData) {
+    auto data = TestHelpers::GenerateRandomData(5000);
+    auto block = Compression::Compress(data);
+    EXPECT_EQ(block[0], Compression::MODE_STORED);
+    EXPECT_EQ(block.size(), data.size() + Compression::HEADER_SIZE);
+}
+
+TEST(Compression, RejectsCorruptedBlocks) {
+    auto data = TextData(2000);
+    auto block = Compression::Compress(data);
+
+    EXPECT_EQ(Compression::Decompress({1, 2}, 100).GetErrorCode(), ErrorCode::InvalidDataSize);
+    EXPECT_EQ(Compression::Decompress(block, data.size() - 1).GetErrorCode(), ErrorCode::CorruptedPayload);
+
+    auto badMode = block;
+    badMode[0] = 7;
+    EXPECT_EQ(Compression::Decompress(badMode, data.size()).GetErrorCode(), ErrorCode::CorruptedPayload);
+
+    auto truncated = block;
+    truncated.resize(block.size() - 3);
+    EXPECT_EQ(Compression::Decompress(truncated, data.size()).GetErrorCode(), ErrorCode::CorruptedPayload);
+
+    // Arbitrary garbage must fail cleanly, never read or write out of bounds
+    for (int trial = 0; trial < 200; ++trial) {
+        auto garbage = block;
+        auto noise = TestHelpers::GenerateRandomData(8);
+        for (std::size_t idx = 0; idx < noise.size(); ++idx) {
+            garbage[Compression::HEADER_SIZE + (noise[idx] * 7 + idx * 131) % (garbage.size() - Compression::HEADER_SIZE)] ^= noise[idx];
+        }
+        auto result = Compression::Decompress(garbage, data.size());
+        if (result) {
+            EXPECT_EQ(result.GetValue().size(), data.size());
+        }
+    }
+}
+
+// Handler Integration Tests
+
+TEST(Compression, HandlerRoundTripsCompressedPayload) {
+    TestHelpers::CleanOutputDirectory();
+    auto coverPath = TestHelpers::GetOutputPath("cover.png").string();
+    auto dataPath = TestHelpers::GetOutputPath("log.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+
+    // 32 KB of text in a carrier that holds about 6 KB uncompressed
+    ASSERT_TRUE(ImageIO::Save(coverPath, TestHelpers::GenerateRandomData(128 * 128 * 3), 128, 128, 3).IsSuccess());
+    auto text = TextData(32 * 1024);
+    std::ofstream(dataPath, std::ios::binary).write(reinterpret_cast<const char *>(text.data()), text.size());
+
+    LSBStegoHandlerOrdered plain;
+    EXPECT_EQ(plain.Embed(coverPath, dataPath, stegoPath, "pw").GetErrorCode(), ErrorCode::InsufficientCapacity);
+
+    LSBStegoHandlerOrdered embedder;
+    embedder.SetCompression(true);
+    embedder.SetKeyCheck(true);
+    ASSERT_TRUE(embedder.Embed(coverPath, dataPath, stegoPath, "pw").IsSuccess());
+
+    LSBStegoHandlerOrdered extractor;
+    auto extractResult = extractor.Extract(stegoPath, recovered, "pw");
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, recovered));
+    TestHelpers::CleanOutputDirectory();
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "utils/CounterRNG.h"
+#include "../test_helpers.h"
+
+#include <set>
+
+// Known Answer Tests
+
+TEST(CounterRNG_KnownAnswer, MatchesPhiloxReferenceVector) {
+    // Random123 Philox4x32-10 known answer: counter = 0, key = 0
+    CounterRNG rng(static_cast<uint64_t>(0));
+    auto block = rng.Generate(0);
+
+    EXPECT_EQ(block[0], 0x6627e8d5u);
+    EXPECT_EQ(block[1], 0xe169c58du);
+    EXPECT_EQ(block[2], 0xbc57ac4cu);
+    EXPECT_EQ(block[3], 0x9b00dbd8u);
+}
+
+// Stream Properties Tests
+
+TEST(CounterRNG_Stream, IsDeterministicForSameKey) {
+    std::vector<uint8_t> key{1, 2, 3, 4, 5, 6, 7, 8};
+    CounterRNG rng1(key);
+    CounterRNG rng2(key);
+
+    for (uint64_t counter = 0; counter < 100; ++counter) {
+        EXPECT_EQ(rng1.Generate(counter), rng2.Generate(counter));
+    }
+}
+
+TEST(CounterRNG_Stream, DifferentKeysProduceDifferentStreams) {
+    CounterRNG rng1(std::vector<uint8_t>{1, 2, 3, 4, 5, 6, 7, 8});
+    CounterRNG rng2(std::vector<uint8_t>{1, 2, 3, 4, 5, 6, 7, 9});
+
+    EXPECT_NE(rng1.Generate(0), rng2.Generate(0));
+    EXPECT_NE(rng1.Generate(42), rng2.Generate(42));
+}
+
+TEST(CounterRNG_Stream, FillMatchesPerBlockGeneration) {
+    CounterRNG rng(static_cast<uint64_t>(0x0123456789ABCDEFull));
+
+    std::vector<uint32_t> words(4 * 10 + 3);
+    rng.Fill(7, words.data(), words.size());
+
+    for (std::size_t idx = 0; idx < words.size(); ++idx) {
+        auto block = rng.Generate(7 + idx / 4);
+        EXPECT_EQ(words[idx], block[idx % 4]);
+    }
+}
+
+TEST(CounterRNG_Stream, BlocksCanBeGeneratedOutOfOrder) {
+    CounterRNG rng(static_cast<uint64_t>(99));
+
+    std::vector<uint32_t> forward(64);
+    rng.Fill(0, forward.data(), forward.size());
+
+    // Generate second half first, then first half
+    std::vector<uint32_t> split(64);
+    rng.Fill(8, split.data() + 32, 32);
+    rng.Fill(0, split.data(), 32);
+
+    EXPECT_EQ(forward, split);
+}
+
+TEST(CounterRNG_Stream, OutputLooksUniform) {
+    CounterRNG rng(static_cast<uint64_t>(12345));
+    std::vector<uint32_t> words(4096);
+    rng.Fill(0, words.data(), words.size());
+
+    // Every bit position should be set roughly half the time
+    for (int bit = 0; bit < 32; ++bit) {
+        std::size_t ones = 0;
+        for (auto word : words) {
+            ones += (word >> bit) & 1;
+        }
+        EXPECT_NEAR(static_cast<double>(ones), words.size() / 2.0, words.size() * 0.05);
+    }
+
+    std::set<uint32_t> unique(words.begin(), words.end());
+    EXPECT_GT(unique.size(), words.size() - 5);
+}
+
+TEST(CounterRNG_Stream, ShortKeyIsZeroPadded) {
+    CounterRNG shortKey(std::vector<uint8_t>{0xAA, 0xBB});
+    CounterRNG paddedKey(std::vector<uint8_t>{0xAA, 0xBB, 0, 0, 0, 0, 0, 0});
+
+    EXPECT_EQ(shortKey.Generate(3), paddedKey.Generate(3));
+}
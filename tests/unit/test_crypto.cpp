@@ -465,4 +465,90 @@ TEST(CryptoModule_Compat, DecryptsDataEncryptedWithHMAC) {
     EXPECT_EQ(decrypted, expectedPlaintext);
 }
 
+// Subkey Derivation Tests
 
+TEST(CryptoModule_DeriveSubkey, MatchesRFC5869Vector) {
+    // RFC 5869 test case 3: IKM = 22 x 0x0b, no salt, no info
+    const std::string password(22, '\x0b');
+    auto result = CryptoModule::DeriveSubkey(password, "", 42);
+    ASSERT_TRUE(result.IsSuccess());
+
+    const std::vector<uint8_t> expected = {
+        0x8d, 0xa4, 0xe7, 0x75, 0xa5, 0x63, 0xc1, 0x8f, 0x71, 0x5f, 0x80, 0x2a,
+        0x06, 0x3c, 0x5a, 0x31, 0xb8, 0xa1, 0x1f, 0x5c, 0x5e, 0xe1, 0x87, 0x9e,
+        0xc3, 0x45, 0x4e, 0x5f, 0x3c, 0x73, 0x8d, 0x2d, 0x9d, 0x20, 0x13, 0x95,
+        0xfa, 0xa4, 0xb6, 0x1a, 0x96, 0xc8
+    };
+    EXPECT_EQ(result.GetValue(), expected);
+}
+
+TEST(CryptoModule_DeriveSubkey, IsDeterministic) {
+    auto res1 = CryptoModule::DeriveSubkey("password", "context", 32);
+    auto res2 = CryptoModule::DeriveSubkey("password", "context", 32);
+
+    ASSERT_TRUE(res1.IsSuccess());
+    ASSERT_TRUE(res2.IsSuccess());
+    EXPECT_EQ(res1.GetValue(), res2.GetValue());
+    EXPECT_EQ(res1.GetValue().size(), 32u);
+}
+
+TEST(CryptoModule_DeriveSubkey, ContextSeparatesKeys) {
+    auto res1 = CryptoModule::DeriveSubkey("password", "context-a", 16);
+    auto res2 = CryptoModule::DeriveSubkey("password", "context-b", 16);
+
+    ASSERT_TRUE(res1.IsSuccess());
+    ASSERT_TRUE(res2.IsSuccess());
+    EXPECT_NE(res1.GetValue(), res2.GetValue());
+}
+
+TEST(CryptoModule_DeriveSubkey, HandlesEmptyPassword) {
+    auto result = CryptoModule::DeriveSubkey("", "context", 8);
+    ASSERT_TRUE(result.IsSuccess());
+    EXPECT_EQ(result.GetValue().size(), 8u);
+}
+
+TEST(CryptoModule_DeriveSubkey, RejectsInvalidSize) {
+    auto result = CryptoModule::DeriveSubkey("password", "context", 0);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.GetErrorCode(), ErrorCode::InvalidArgument);
+}
+
+// Key Check Tests
+
+TEST(CryptoModule_KeyCheck, RoundTripsWithCorrectPassword) {
+    auto encrypted = CryptoModule::EncryptData({1, 2, 3, 4, 5}, "secret").GetValue();
+    auto checked = CryptoModule::AddKeyCheck(encrypted, "secret");
+    ASSERT_TRUE(checked.IsSuccess());
+    ASSERT_EQ(checked.GetValue().size(), encrypted.size() + CryptoModule::KEY_CHECK_SIZE);
+
+    auto verified = CryptoModule::VerifyKeyCheck(checked.GetValue(), "secret");
+    ASSERT_TRUE(verified.IsSuccess());
+    EXPECT_EQ(verified.GetValue(), encrypted);
+}
+
+TEST(CryptoModule_KeyCheck, RejectsAlmostAllWrongPasswords) {
+    auto encrypted = CryptoModule::EncryptData({1, 2, 3, 4, 5}, "secret").GetValue();
+    auto checked = CryptoModule::AddKeyCheck(encrypted, "secret").GetValue();
+
+    int accepted = 0;
+    const int attempts = 2000;
+    for (int idx = 0; idx < attempts; ++idx) {
+        accepted += CryptoModule::VerifyKeyCheck(checked, "guess" + std::to_string(idx)).IsSuccess();
+    }
+    EXPECT_LT(accepted, attempts / 100);
+}
+
+TEST(CryptoModule_KeyCheck, DetectsCorruptedData) {
+    auto encrypted = CryptoModule::EncryptData({1, 2, 3, 4, 5}, "secret").GetValue();
+    auto checked = CryptoModule::AddKeyCheck(encrypted, "secret").GetValue();
+    checked.back() ^= 0x01;
+
+    auto verified = CryptoModule::VerifyKeyCheck(checked, "secret");
+    EXPECT_EQ(verified.GetErrorCode(), ErrorCode::AuthenticationFailed);
+}
+
+TEST(CryptoModule_KeyCheck, RejectsTooSmallData) {
+    std::vector<uint8_t> tooSmall(CryptoModule::MIN_SIZE, 0);
+    EXPECT_EQ(CryptoModule::AddKeyCheck({1, 2, 3}, "secret").GetErrorCode(), ErrorCode::InvalidDataSize);
+    EXPECT_EQ(CryptoModule::VerifyKeyCheck(tooSmall, "secret").GetErrorCode(), ErrorCode::InvalidDataSize);
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "algorithms/dct/DCTStegoHandler.h"
+#include "algorithms/PayloadHeader.h"
+#include "utils/JpegCodec.h"
+#include "utils/ImageIO.h"
+#include "../test_helpers.h"
+#include <cstdlib>
+
+// Test fixture for DCT handler tests with automatic output cleanup
+class DCTHandlerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+    
+    void TearDown() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    // Write a noisy JPEG cover so that most AC coefficients are usable
+    static std::string WriteNoiseJpeg(const std::string &filename, int width, int height, int channels) {
+        auto pixels = TestHelpers::GenerateRandomData(static_cast<std::size_t>(width) * height * channels);
+        auto path = TestHelpers::GetOutputPath(filename).string();
+        EXPECT_TRUE(ImageIO::Save(path, pixels, width, height, channels).IsSuccess());
+        return path;
+    }
+};
+
+// Coefficient Level Tests
+
+TEST_F(DCTHandlerTest, RoundTripsThroughCoefficients) {
+    DCTStegoHandler handler;
+    auto cover = JpegCodec::Load(WriteNoiseJpeg("cover.jpg", 256, 256, 3));
+    ASSERT_TRUE(cover.IsSuccess());
+    auto data = cover.GetValue();
+    auto payload = TestHelpers::GenerateRandomData(2000);
+
+    ASSERT_GE(DCTStegoHandler::CalculateCapacity(data), payload.size());
+    ASSERT_TRUE(handler.EmbedCoefficients(data, payload).IsSuccess());
+
+    auto extractResult = handler.ExtractCoefficients(data);
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+    EXPECT_EQ(extractResult.GetValue(), payload);
+}
+
+TEST_F(DCTHandlerTest, OnlyChangesMagnitudeLSBOfLargeACCoefficients) {
+    DCTStegoHandler handler;
+    auto cover = JpegCodec::Load(WriteNoiseJpeg("cover.jpg", 128, 128, 1));
+    ASSERT_TRUE(cover.IsSuccess());
+    const auto &original = cover.GetValue().components[0].coefficients;
+    auto data = cover.GetValue();
+    auto payload = TestHelpers::GenerateRandomData(DCTStegoHandler::CalculateCapacity(data));
+
+    ASSERT_TRUE(handler.EmbedCoefficients(data, payload).IsSuccess());
+    const auto &modified = data.components[0].coefficients;
+
+    std::size_t changed = 0;
+    for (std::size_t idx = 0; idx < original.size(); ++idx) {
+        int before = original[idx];
+        int after = modified[idx];
+        if (idx % JpegComponent::BLOCK_SIZE == 0 || std::abs(before) < 2) {
+            EXPECT_EQ(after, before); // DC, zeros and +-1 are never touched
+            continue;
+        }
+        EXPECT_LE(std::abs(after - before), 1);
+        EXPECT_GE(std::abs(after), 2);
+        EXPECT_EQ(after < 0, before < 0);
+        changed += after != before;
+    }
+    EXPECT_GT(changed, 0u);
+}
+
+TEST_F(DCTHandlerTest, RecoversDamagedHeaderFromItsCopies) {
+    auto cover = JpegCodec::Load(WriteNoiseJpeg("cover.jpg", 128, 128, 1));
+    ASSERT_TRUE(cover.IsSuccess());
+    auto payload = PayloadHeader::AddCopies(PayloadMethod::DCT, TestHelpers::GenerateRandomData(300),
+                                            PayloadHeader::FLAG_ERROR_CORRECTION);
+
+    // Flip the magnitude LSB of usable coefficients 3 and 100, both in the first header copy
+    auto damageHeader = [](JpegCoefficientData &data) {
+        std::size_t usable = 0;
+        auto &coefficients = data.components[0].coefficients;
+        for (std::size_t idx = 0; idx < coefficients.size(); ++idx) {
+            int value = coefficients[idx];
+            if (idx % JpegComponent::BLOCK_SIZE == 0 || std::abs(value) < 2) {
+                continue;
+            }
+            if (usable == 3 || usable == 100) {
+                coefficients[idx] = static_cast<int16_t>(value < 0 ? -(-value ^ 1) : (value ^ 1));
+            }
+            ++usable;
+        }
+    };
+
+    DCTStegoHandler handler;
+    auto data = cover.GetValue();
+    ASSERT_TRUE(handler.EmbedCoefficients(data, TestHelpers::GenerateRandomData(340)).IsSuccess());
+    damageHeader(data);
+    EXPECT_EQ(handler.ExtractCoefficients(data).GetErrorCode(), ErrorCode::CorruptedPayload);
+
+    handler.SetErrorCorrection(16);
+    data = cover.GetValue();
+    ASSERT_TRUE(handler.EmbedCoefficients(data, payload).IsSuccess());
+    damageHeader(data);
+    auto extractResult = handler.ExtractCoefficients(data);
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+    EXPECT_EQ(extractResult.GetValue(), payload);
+}
+
+TEST_F(DCTHandlerTest, RejectsEmptyAndOversizedData) {
+    DCTStegoHandler handler;
+    auto cover = JpegCodec::Load(WriteNoiseJpeg("cover.jpg", 64, 64, 1));
+    ASSERT_TRUE(cover.IsSuccess());
+    auto data = cover.GetValue();
+
+    EXPECT_EQ(handler.EmbedCoefficients(data, {}).GetErrorCode(), ErrorCode::InvalidArgument);
+
+    std::vector<uint8_t> tooLarge(DCTStegoHandler::CalculateCapacity(data) + 1, 0x42);
+    EXPECT_EQ(handler.EmbedCoefficients(data, tooLarge).GetErrorCode(), ErrorCode::InsufficientCapacity);
+}
+
+TEST_F(DCTHandlerTest, FlatJpegHasNoCapacity) {
+    DCTStegoHandler handler;
+    auto cover = JpegCodec::Load(TestHelpers::GetFixturePath("medium_gray.jpg").string());
+    ASSERT_TRUE(cover.IsSuccess());
+    EXPECT_EQ(DCTStegoHandler::CalculateCapacity(cover.GetValue()), 0u);
+
+    auto extractResult = handler.ExtractCoefficients(cover.GetValue());
+    EXPECT_EQ(extractResult.GetErrorCode(), ErrorCode::ImageTooSmall);
+}
+
+// File Level Tests
+
+TEST_F(DCTHandlerTest, EmbedExtractFileRoundTrip) {
+    auto coverPath = WriteNoiseJpeg("cover.jpg", 256, 192, 3);
+    auto dataPath = TestHelpers::GetFixturePath("medium.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego.jpg").string();
+    auto extractPath = TestHelpers::GetOutputPath("extracted.txt").string();
+
+    DCTStegoHandler handler;
+    auto embedResult = handler.Embed(coverPath, dataPath, stegoPath, "dctpass");
+    ASSERT_TRUE(embedResult.IsSuccess()) << embedResult.GetErrorMessage();
+
+    // Stego file is still a regular JPEG; only byte stuffing can change its size
+    auto stegoImage = ImageIO::Load(stegoPath);
+    ASSERT_TRUE(stegoImage.IsSuccess());
+    EXPECT_EQ(stegoImage.GetValue().width, 256);
+    auto coverSize = static_cast<double>(TestHelpers::GetFileSize(coverPath));
+    EXPECT_NEAR(static_cast<double>(TestHelpers::GetFileSize(stegoPath)), coverSize, coverSize * 0.01);
+
+    auto extractResult = handler.Extract(stegoPath, extractPath, "dctpass");
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, extractPath));
+
+    auto wrongResult = handler.Extract(stegoPath, extractPath, "wrongpass");
+    EXPECT_TRUE(wrongResult.IsError());
+}
+
+TEST_F(DCTHandlerTest, RejectsNonJpegCoverAndOutput) {
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    DCTStegoHandler handler;
+
+    auto pngCover = handler.Embed(TestHelpers::GetFixturePath("medium_gray.png").string(), dataPath,
+                                  TestHelpers::GetOutputPath("stego.jpg").string(), "pass");
+    EXPECT_EQ(pngCover.GetErrorCode(), ErrorCode::UnsupportedImageFormat);
+
+    auto pngOutput = handler.Embed(WriteNoiseJpeg("cover.jpg", 64, 64, 1), dataPath,
+                                   TestHelpers::GetOutputPath("stego.png").string(), "pass");
+    EXPECT_EQ(pngOutput.GetErrorCode(), ErrorCode::UnsupportedImageFormat);
+}
+
+TEST_F(DCTHandlerTest, VisualMarksChangedBlocks) {
+    auto coverPath = WriteNoiseJpeg("cover.jpg", 128, 128, 1);
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto visualPath = TestHelpers::GetOutputPath("visual.png").string();
+
+    DCTStegoHandler handler;
+    ASSERT_TRUE(handler.Visual(coverPath, dataPath, visualPath, "pass").IsSuccess());
+
+    auto visual = ImageIO::Load(visualPath);
+    ASSERT_TRUE(visual.IsSuccess());
+    std::size_t marked = 0;
+    for (uint8_t value : visual.GetValue().pixels) {
+        EXPECT_TRUE(value == 0 || value == 255);
+        marked += value == 255;
+    }
+    // A small payload only touches the first blocks
+    EXPECT_GT(marked, 0u);
+    EXPECT_LT(marked, visual.GetValue().pixels.size());
+}
@@ -0,0 +1,366 @@
+#include <gtest/gtest.h>
+#include "algorithms/frames/apng/APNGStegoHandler.h"
+#include "algorithms/frames/y4m/Y4MStegoHandler.h"
+#include "utils/ImageIO.h"
+#include "../test_helpers.h"
+#include <cstring>
+#include <string>
+
+// Test fixture for frame sequence handler tests with automatic output cleanup
+class FrameHandlerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    void TearDown() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    static void PutBE32(std::vector<uint8_t> &out, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    static void PutChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data) {
+        PutBE32(png, static_cast<uint32_t>(data.size()));
+        std::size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        PutBE32(png, ImageIO::PngCrc(png.data() + start, data.size() + 4));
+    }
+
+    // Y4M stream with noise frames
+    static std::vector<uint8_t> BuildY4M(int width, int height, const std::string &colorSpace,
+                                         std::size_t frameSize, int frames) {
+        std::string header = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) +
+                             " F25:1 Ip A1:1 C" + colorSpace + "\n";
+        std::vector<uint8_t> y4m(header.begin(), header.end());
+        for (int idx = 0; idx < frames; ++idx) {
+            const char frameHeader[] = "FRAME\n";
+            y4m.insert(y4m.end(), frameHeader, frameHeader + 6);
+            auto samples = TestHelpers::GenerateRandomData(frameSize);
+            y4m.insert(y4m.end(), samples.begin(), samples.end());
+        }
+        return y4m;
+    }
+
+    // APNG with noise frames; every frame's data is split over two chunks
+    static std::vector<uint8_t> BuildAPNG(int width, int height, int channels, int bitDepth, int frames,
+                                          std::vector<std::vector<uint8_t>> &rawFrames) {
+        static const uint8_t COLOR_TYPES[] = {0, 4, 2, 6};
+        std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+        std::vector<uint8_t> header;
+        PutBE32(header, static_cast<uint32_t>(width));
+        PutBE32(header, static_cast<uint32_t>(height));
+        header.insert(header.end(), {static_cast<uint8_t>(bitDepth), COLOR_TYPES[channels - 1], 0, 0, 0});
+        PutChunk(png, "IHDR", header);
+
+        std::vector<uint8_t> control;
+        PutBE32(control, static_cast<uint32_t>(frames));
+        PutBE32(control, 0);
+        PutChunk(png, "acTL", control);
+
+        std::size_t rowBytes = static_cast<std::size_t>(width) * channels * (bitDepth / 8);
+        uint32_t sequence = 0;
+        rawFrames.clear();
+        for (int frame = 0; frame < frames; ++frame) {
+            std::vector<uint8_t> fctl;
+            PutBE32(fctl, sequence++);
+            PutBE32(fctl, static_cast<uint32_t>(width));
+            PutBE32(fctl, static_cast<uint32_t>(height));
+            PutBE32(fctl, 0);
+            PutBE32(fctl, 0);
+            fctl.insert(fctl.end(), {0, 1, 0, 10, 0, 0});
+            PutChunk(png, "fcTL", fctl);
+
+            // Unfiltered scanlines of noise
+            auto raw = TestHelpers::GenerateRandomData(rowBytes * height);
+            rawFrames.push_back(raw);
+            std::vector<uint8_t> scanlines;
+            for (int y = 0; y < height; ++y) {
+                scanlines.push_back(0);
+                scanlines.insert(scanlines.end(), raw.begin() + static_cast<std::ptrdiff_t>(y * rowBytes),
+                                 raw.begin() + static_cast<std::ptrdiff_t>((y + 1) * rowBytes));
+            }
+            auto compressed = ImageIO::ZlibCompress(scanlines).GetValue();
+            std::size_t half = compressed.size() / 2;
+            std::vector<uint8_t> parts[2] = {
+                std::vector<uint8_t>(compressed.begin(), compressed.begin() + static_cast<std::ptrdiff_t>(half)),
+                std::vector<uint8_t>(compressed.begin() + static_cast<std::ptrdiff_t>(half), compressed.end())
+            };
+            for (auto &part : parts) {
+                if (frame == 0) {
+                    PutChunk(png, "IDAT", part);
+                } else {
+                    std::vector<uint8_t> fdat;
+                    PutBE32(fdat, sequence++);
+                    fdat.insert(fdat.end(), part.begin(), part.end());
+                    PutChunk(png, "fdAT", fdat);
+                }
+            }
+        }
+        PutChunk(png, "IEND", {});
+        return png;
+    }
+
+    // Chunk types in file order, checking every CRC
+    static std::vector<std::string> ListChunks(const std::vector<uint8_t> &png, std::vector<uint32_t> &sequence) {
+        std::vector<std::string> types;
+        sequence.clear();
+        std::size_t pos = 8;
+        while (pos + 12 <= png.size()) {
+            uint32_t length = (static_cast<uint32_t>(png[pos]) << 24) | (png[pos + 1] << 16) | (png[pos + 2] << 8) | png[pos + 3];
+            std::string type(reinterpret_cast<const char *>(png.data() + pos + 4), 4);
+            const uint8_t *crcBytes = png.data() + pos + 8 + length;
+            uint32_t crc = (static_cast<uint32_t>(crcBytes[0]) << 24) | (crcBytes[1] << 16) | (crcBytes[2] << 8) | crcBytes[3];
+            EXPECT_EQ(crc, ImageIO::PngCrc(png.data() + pos + 4, length + 4)) << type;
+            if (type == "fcTL" || type == "fdAT") {
+                const uint8_t *data = png.data() + pos + 8;
+                sequence.push_back((static_cast<uint32_t>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3]);
+            }
+            types.push_back(type);
+            pos += 12 + length;
+        }
+        return types;
+    }
+
+    static std::string WriteFile(const std::string &filename, const std::vector<uint8_t> &data) {
+        auto path = TestHelpers::GetOutputPath(filename);
+        TestHelpers::WriteBinaryFile(path, data);
+        return path.string();
+    }
+};
+
+// Frame Level Tests
+
+TEST_F(FrameHandlerTest, FrameSlicesRoundTripWithStride) {
+    auto stream = TestHelpers::GenerateRandomData(300);
+
+    // Two 16-bit frames carrying consecutive slices in their low bytes
+    std::vector<SequenceFrame> frames(2);
+    std::size_t offset = 0;
+    for (auto &frame : frames) {
+        frame.sampleCount = 1203; // 150 whole bytes
+        frame.sampleStride = 2;
+        frame.lowByte = 1;
+        frame.samples = TestHelpers::GenerateRandomData(frame.sampleCount * 2);
+        frame.byteOffset = offset;
+        offset += frame.GetCapacity();
+    }
+    ASSERT_EQ(offset, stream.size());
+
+    auto originals = frames;
+    std::vector<uint8_t> extracted(stream.size());
+    for (std::size_t idx = 0; idx < frames.size(); ++idx) {
+        FrameStegoHandler::EmbedFrame(frames[idx], stream);
+        FrameStegoHandler::ExtractFrame(frames[idx], extracted);
+        for (std::size_t pos = 0; pos < frames[idx].samples.size(); ++pos) {
+            uint8_t mask = pos % 2 == 1 ? 0xFE : 0xFF;
+            ASSERT_EQ(frames[idx].samples[pos] & mask, originals[idx].samples[pos] & mask);
+        }
+    }
+    EXPECT_EQ(extracted, stream);
+}
+
+// Y4M Tests
+
+TEST_F(FrameHandlerTest, Y4MRoundTripSpansFrames) {
+    // 4:2:0 at 64x48: 3072 + 2 * 768 bytes per frame, ~576 payload bytes each
+    auto cover = BuildY4M(64, 48, "420jpeg", 4608, 12);
+    auto coverPath = WriteFile("cover.y4m", cover);
+    auto data = TestHelpers::CreateTempFile("secret.bin", TestHelpers::GenerateRandomData(3000));
+    auto stegoPath = TestHelpers::GetOutputPath("stego.y4m").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.bin").string();
+
+    Y4MStegoHandler handler;
+    auto embedResult = handler.Embed(coverPath, data.string(), stegoPath, "pw");
+    ASSERT_TRUE(embedResult.IsSuccess()) << embedResult.GetErrorMessage();
+
+    // Same layout, only sample LSBs differ
+    auto stego = TestHelpers::ReadBinaryFile(stegoPath);
+    ASSERT_EQ(stego.size(), cover.size());
+    std::size_t changed = 0;
+    for (std::size_t idx = 0; idx < cover.size(); ++idx) {
+        ASSERT_EQ(stego[idx] | 1, cover[idx] | 1);
+        changed += stego[idx] != cover[idx];
+    }
+    EXPECT_GT(changed, 0u);
+    EXPECT_EQ(std::memcmp(stego.data(), cover.data(), 40), 0);
+
+    auto extractResult = handler.Extract(stegoPath, recovered, "pw");
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(data, recovered));
+
+    // Error correction puts the header copies in front of the data
+    handler.SetErrorCorrection(16);
+    ASSERT_TRUE(handler.Embed(coverPath, data.string(), stegoPath, "pw").IsSuccess());
+    extractResult = handler.Extract(stegoPath, recovered, "pw");
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(data, recovered));
+}
+
+TEST_F(FrameHandlerTest, Y4MRejectsUnsupportedAndTruncatedStreams) {
+    auto data = TestHelpers::CreateTempFile("secret.bin", {1, 2, 3});
+    auto stegoPath = TestHelpers::GetOutputPath("stego.y4m").string();
+    Y4MStegoHandler handler;
+
+    auto highDepth = WriteFile("p10.y4m", BuildY4M(16, 16, "420p10", 768, 1));
+    EXPECT_EQ(handler.Embed(highDepth, data.string(), stegoPath, "").GetErrorCode(), ErrorCode::UnsupportedImageFormat);
+
+    auto truncated = BuildY4M(16, 16, "444", 768, 3);
+    truncated.resize(truncated.size() - 10);
+    auto truncatedPath = WriteFile("truncated.y4m", truncated);
+    EXPECT_EQ(handler.Embed(truncatedPath, data.string(), stegoPath, "").GetErrorCode(), ErrorCode::ImageCorrupted);
+    EXPECT_FALSE(TestHelpers::FileExists(stegoPath + ".tmp"));
+
+    auto png = TestHelpers::GetFixturePath("small_rgb.png").string();
+    EXPECT_EQ(handler.Embed(png, data.string(), stegoPath, "").GetErrorCode(), ErrorCode::UnsupportedImageFormat);
+}
+
+TEST_F(FrameHandlerTest, Y4MReportsInsufficientCapacity) {
+    auto coverPath = WriteFile("cover.y4m", BuildY4M(16, 16, "mono", 256, 2));
+    auto data = TestHelpers::CreateTempFile("secret.bin", TestHelpers::GenerateRandomData(500));
+    auto stegoPath = TestHelpers::GetOutputPath("stego.y4m").string();
+
+    Y4MStegoHandler handler;
+    EXPECT_EQ(handler.Embed(coverPath, data.string(), stegoPath, "").GetErrorCode(), ErrorCode::InsufficientCapacity);
+    EXPECT_FALSE(TestHelpers::FileExists(stegoPath));
+    EXPECT_FALSE(TestHelpers::FileExists(stegoPath + ".tmp"));
+}
+
+TEST_F(FrameHandlerTest, Y4MRejectsFrameSizesBeyondTheFile) {
+    auto data = TestHelpers::CreateTempFile("secret.bin", {1, 2, 3});
+    auto stegoPath = TestHelpers::GetOutputPath("stego.y4m").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.bin").string();
+    Y4MStegoHandler handler;
+
+    // Largest accepted header (16 GB frames) with only a frame header behind it
+    std::string header = "YUV4MPEG2 W65536 H65536 C444alpha\nFRAME\n";
+    auto path = WriteFile("huge_frame.y4m", std::vector<uint8_t>(header.begin(), header.end()));
+    EXPECT_EQ(handler.Embed(path, data.string(), stegoPath, "").GetErrorCode(), ErrorCode::ImageCorrupted);
+    EXPECT_EQ(handler.Extract(path, recovered, "").GetErrorCode(), ErrorCode::ImageCorrupted);
+}
+
+// APNG Tests
+
+TEST_F(FrameHandlerTest, APNGRoundTripRenumbersChunks) {
+    std::vector<std::vector<uint8_t>> rawFrames;
+    auto coverPath = WriteFile("cover.png", BuildAPNG(40, 30, 4, 8, 6, rawFrames));
+    auto data = TestHelpers::CreateTempFile("secret.bin", TestHelpers::GenerateRandomData(2500));
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.bin").string();
+
+    APNGStegoHandler handler;
+    auto embedResult = handler.Embed(coverPath, data.string(), stegoPath, "pw");
+    ASSERT_TRUE(embedResult.IsSuccess()) << embedResult.GetErrorMessage();
+
+    // One data chunk per frame, sequence numbers consecutive, CRCs valid
+    std::vector<uint32_t> sequence;
+    auto types = ListChunks(TestHelpers::ReadBinaryFile(stegoPath), sequence);
+    std::vector<std::string> expected = {"IHDR", "acTL", "fcTL", "IDAT"};
+    for (int frame = 1; frame < 6; ++frame) {
+        expected.insert(expected.end(), {"fcTL", "fdAT"});
+    }
+    expected.push_back("IEND");
+    EXPECT_EQ(types, expected);
+    for (std::size_t idx = 0; idx < sequence.size(); ++idx) {
+        EXPECT_EQ(sequence[idx], idx);
+    }
+
+    // Default image decodes with standard readers and only LSBs changed
+    auto image = ImageIO::Load(stegoPath);
+    ASSERT_TRUE(image.IsSuccess()) << image.GetErrorMessage();
+    ASSERT_EQ(image.GetValue().pixels.size(), rawFrames[0].size());
+    for (std::size_t idx = 0; idx < rawFrames[0].size(); ++idx) {
+        ASSERT_EQ(image.GetValue().pixels[idx] | 1, rawFrames[0][idx] | 1);
+    }
+
+    auto extractResult = handler.Extract(stegoPath, recovered, "pw");
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(data, recovered));
+}
+
+TEST_F(FrameHandlerTest, APNGSixteenBitChangesOnlyLowBytes) {
+    std::vector<std::vector<uint8_t>> rawFrames;
+    auto coverPath = WriteFile("cover16.png", BuildAPNG(32, 16, 3, 16, 3, rawFrames));
+    auto data = TestHelpers::CreateTempFile("secret.bin", TestHelpers::GenerateRandomData(300));
+    auto stegoPath = TestHelpers::GetOutputPath("stego16.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.bin").string();
+
+    APNGStegoHandler handler;
+    ASSERT_TRUE(handler.Embed(coverPath, data.string(), stegoPath, "pw").IsSuccess());
+
+    auto image = ImageIO::Load16(stegoPath);
+    ASSERT_TRUE(image.IsSuccess()) << image.GetErrorMessage();
+    const auto &raw = rawFrames[0];
+    for (std::size_t idx = 0; idx < image.GetValue().pixels.size(); ++idx) {
+        uint16_t original = static_cast<uint16_t>((raw[idx * 2] << 8) | raw[idx * 2 + 1]);
+        ASSERT_EQ(image.GetValue().pixels[idx] | 1, original | 1);
+    }
+
+    ASSERT_TRUE(handler.Extract(stegoPath, recovered, "pw").IsSuccess());
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(data, recovered));
+}
+
+TEST_F(FrameHandlerTest, APNGHandlesPlainPngAsOneFrame) {
+    auto coverPath = TestHelpers::GetFixturePath("medium_rgb.png").string();
+    auto data = TestHelpers::GetFixturePath("medium.txt");
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+
+    APNGStegoHandler handler;
+    auto embedResult = handler.Embed(coverPath, data.string(), stegoPath, "pw");
+    ASSERT_TRUE(embedResult.IsSuccess()) << embedResult.GetErrorMessage();
+    ASSERT_TRUE(handler.Extract(stegoPath, recovered, "pw").IsSuccess());
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(data, recovered));
+
+    // Overwriting the cover in place works as well
+    auto copyPath = WriteFile("copy.png", TestHelpers::ReadBinaryFile(coverPath));
+    ASSERT_TRUE(handler.Embed(copyPath, data.string(), copyPath, "pw").IsSuccess());
+    ASSERT_TRUE(handler.Extract(copyPath, recovered, "pw").IsSuccess());
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(data, recovered));
+}
+
+TEST_F(FrameHandlerTest, APNGRejectsChunkLengthsBeyondTheFile) {
+    std::vector<std::vector<uint8_t>> rawFrames;
+    auto png = BuildAPNG(8, 8, 3, 8, 1, rawFrames);
+    auto data = TestHelpers::CreateTempFile("secret.bin", {1, 2, 3});
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    APNGStegoHandler handler;
+
+    // Chunk lengths just under the 31-bit limit, in a file a few bytes long
+    std::vector<uint8_t> header(png.begin(), png.begin() + 40);
+    header[8] = 0x7F;
+    header[9] = header[10] = header[11] = 0xFF;
+    EXPECT_EQ(handler.Embed(WriteFile("huge_ihdr.png", header), data.string(), stegoPath, "").GetErrorCode(),
+              ErrorCode::ImageCorrupted);
+
+    // Same for the chunk after IHDR
+    png[33] = 0x7F;
+    png[34] = png[35] = png[36] = 0xFF;
+    EXPECT_EQ(handler.Embed(WriteFile("huge_chunk.png", png), data.string(), stegoPath, "").GetErrorCode(),
+              ErrorCode::ImageCorrupted);
+}
+
+TEST_F(FrameHandlerTest, APNGRejectsUnsupportedFilesAndPixelMethods) {
+    std::vector<std::vector<uint8_t>> rawFrames;
+    auto png = BuildAPNG(8, 8, 3, 8, 1, rawFrames);
+    png[25] = 3; // palette colour type
+    auto palettePath = WriteFile("palette.png", png);
+    auto data = TestHelpers::CreateTempFile("secret.bin", {1, 2, 3});
+
+    APNGStegoHandler handler;
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    EXPECT_EQ(handler.Embed(palettePath, data.string(), stegoPath, "").GetErrorCode(), ErrorCode::UnsupportedImageFormat);
+    EXPECT_EQ(handler.Embed(TestHelpers::GetFixturePath("medium_gray.jpg").string(), data.string(), stegoPath, "").GetErrorCode(),
+              ErrorCode::UnsupportedImageFormat);
+    EXPECT_EQ(handler.Embed(palettePath, data.string(), TestHelpers::GetOutputPath("stego.bmp").string(), "").GetErrorCode(),
+              ErrorCode::UnsupportedImageFormat);
+
+    ImageData image(std::vector<uint8_t>(16, 0), 4, 4, 1);
+    EXPECT_EQ(handler.EmbedMethod(image, {1}, "").GetErrorCode(), ErrorCode::NotImplemented);
+    EXPECT_EQ(handler.Visual(palettePath, data.string(), stegoPath, "").GetErrorCode(), ErrorCode::NotImplemented);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "utils/ImageDiff.h"
+#include "../test_helpers.h"
+
+#include <limits>
+
+namespace {
+
+std::size_t CountBitsNaively(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b, std::size_t first,
+                             std::size_t count, uint8_t planes) {
+    std::size_t total = 0;
+    for (std::size_t idx = first; idx < first + count; ++idx) {
+        for (int bit = 0; bit < 8; ++bit) {
+            total += (((a[idx] ^ b[idx]) & planes) >> bit) & 1;
+        }
+    }
+    return total;
+}
+
+} // namespace
+
+TEST(ImageDiffTest, CountsChangedBitsOnEveryLengthAndOffset) {
+    auto a = TestHelpers::GenerateRandomData(300);
+    auto b = TestHelpers::GenerateRandomData(300);
+    for (uint8_t planes : {uint8_t(0x01), uint8_t(0x06), uint8_t(0xFF)}) {
+        for (std::size_t first : {std::size_t(0), std::size_t(3)}) {
+            for (std::size_t count = 0; count <= 100; ++count) {
+                EXPECT_EQ(ImageDiff::CountChangedBits(a.data() + first, b.data() + first, count, planes),
+                          CountBitsNaively(a, b, first, count, planes)) << count;
+            }
+        }
+        EXPECT_EQ(ImageDiff::CountChangedBits(a.data(), b.data(), a.size(), planes),
+                  CountBitsNaively(a, b, 0, a.size(), planes));
+    }
+}
+
+TEST(ImageDiffTest, DifferenceMarksChangedSamplesPerBlock) {
+    ImageData cover(std::vector<uint8_t>(10 * 7 * 3, 100), 10, 7, 3);
+    ImageData stego = cover;
+    stego.pixels[(2 * 10 + 1) * 3 + 2] ^= 1;     // x 1, y 2, blue
+    stego.pixels[(6 * 10 + 9) * 3 + 0] += 1;     // x 9, y 6, red
+
+    auto full = ImageDiff::Difference(cover, stego, 1);
+    ASSERT_TRUE(full.IsSuccess());
+    std::size_t lit = 0;
+    for (uint8_t value : full.GetValue().pixels) {
+        lit += value == 255;
+        EXPECT_TRUE(value == 0 || value == 255);
+    }
+    EXPECT_EQ(lit, 2u);
+    EXPECT_EQ(full.GetValue().pixels[(2 * 10 + 1) * 3 + 2], 255);
+
+    // 10x7 in blocks of 4 is 3x2, the edge blocks are partial
+    auto reduced = ImageDiff::Difference(cover, stego, 4);
+    ASSERT_TRUE(reduced.IsSuccess());
+    const ImageData &map = reduced.GetValue();
+    ASSERT_EQ(map.width, 3);
+    ASSERT_EQ(map.height, 2);
+    ASSERT_EQ(map.channels, 3);
+    std::vector<uint8_t> expected(3 * 2 * 3, 0);
+    expected[(0 * 3 + 0) * 3 + 2] = 255;
+    expected[(1 * 3 + 2) * 3 + 0] = 255;
+    EXPECT_EQ(map.pixels, expected);
+}
+
+TEST(ImageDiffTest, HeatmapShowsShareOfChangedBits) {
+    ImageData cover(std::vector<uint8_t>(8 * 4, 0), 8, 4, 1);
+    ImageData stego = cover;
+    // Left 4x4 block: every LSB changed; right block: a quarter of them, plus bits outside the planes
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            stego.pixels[y * 8 + x] = 1;
+        }
+        stego.pixels[y * 8 + 4] = 0x81;
+    }
+
+    auto heatmap = ImageDiff::Heatmap(cover, stego, 0x01, 1, 4);
+    ASSERT_TRUE(heatmap.IsSuccess());
+    ASSERT_EQ(heatmap.GetValue().width, 2);
+    ASSERT_EQ(heatmap.GetValue().height, 1);
+    ASSERT_EQ(heatmap.GetValue().channels, 1);
+    EXPECT_EQ(heatmap.GetValue().pixels, (std::vector<uint8_t>{255, 64}));
+
+    // Two embedding bits per pixel halve the share
+    heatmap = ImageDiff::Heatmap(cover, stego, 0x03, 2, 4);
+    ASSERT_TRUE(heatmap.IsSuccess());
+    EXPECT_EQ(heatmap.GetValue().pixels, (std::vector<uint8_t>{128, 32}));
+}
+
+TEST(ImageDiffTest, HeatmapWorksOn16BitSamples) {
+    ImageData16 cover(std::vector<uint16_t>(6 * 6 * 2, 0x1234), 6, 6, 2);
+    ImageData16 stego = cover;
+    for (std::size_t idx = 0; idx < stego.pixels.size(); idx += 2) {
+        stego.pixels[idx] ^= 0x0100;
+    }
+
+    auto heatmap = ImageDiff::Heatmap(cover, stego, 0x0100, 2, 5);
+    ASSERT_TRUE(heatmap.IsSuccess());
+    ASSERT_EQ(heatmap.GetValue().width, 2);
+    EXPECT_EQ(heatmap.GetValue().pixels, (std::vector<uint8_t>(4, 128)));
+
+    auto diff = ImageDiff::Difference(cover, stego, 6);
+    ASSERT_TRUE(diff.IsSuccess());
+    EXPECT_EQ(diff.GetValue().pixels, (std::vector<uint8_t>{255, 0}));
+}
+
+TEST(ImageDiffTest, BlocksLargerThanTheImageLeaveOnePixel) {
+    ImageData cover(std::vector<uint8_t>(5 * 3, 0), 5, 3, 1);
+    ImageData stego = cover;
+    stego.pixels[7] = 1;
+
+    const int block = std::numeric_limits<int>::max();
+    auto diff = ImageDiff::Difference(cover, stego, block);
+    ASSERT_TRUE(diff.IsSuccess());
+    EXPECT_EQ(diff.GetValue().width, 1);
+    EXPECT_EQ(diff.GetValue().height, 1);
+    EXPECT_EQ(diff.GetValue().pixels, std::vector<uint8_t>{255});
+
+    auto heatmap = ImageDiff::Heatmap(cover, stego, 0x01, 1, block);
+    ASSERT_TRUE(heatmap.IsSuccess());
+    EXPECT_EQ(heatmap.GetValue().pixels, std::vector<uint8_t>{17});
+}
+
+TEST(ImageDiffTest, RejectsMismatchedImages) {
+    ImageData cover(std::vector<uint8_t>(16, 0), 4, 4, 1);
+    ImageData other(std::vector<uint8_t>(20, 0), 5, 4, 1);
+    EXPECT_EQ(ImageDiff::Difference(cover, other, 1).GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(ImageDiff::Heatmap(cover, other, 1, 1, 2).GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(ImageDiff::Difference(cover, cover, 0).GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(ImageDiff::Heatmap(cover, cover, 1, 0, 2).GetErrorCode(), ErrorCode::InvalidArgument);
+}
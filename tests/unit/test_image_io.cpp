@@ -333,6 +333,60 @@ TEST_F(ImageIOTest, FormatConversion) {
     EXPECT_EQ(asBmp.GetValue().height, original.GetValue().height);
 }
 
+// 16-bit PNG Tests
+
+TEST_F(ImageIOTest, SixteenBitPNGRoundTripForAllChannelCounts) {
+    for (int channels = 1; channels <= 4; ++channels) {
+        std::vector<uint16_t> pixels(static_cast<std::size_t>(37 * 23 * channels));
+        for (std::size_t idx = 0; idx < pixels.size(); ++idx) {
+            pixels[idx] = static_cast<uint16_t>(idx * 2654435761u >> 7);
+        }
+        ImageData16 original(pixels, 37, 23, channels);
+
+        auto outputPath = TestHelpers::GetOutputPath("roundtrip16_" + std::to_string(channels) + ".png").string();
+        auto saveResult = ImageIO::Save(outputPath, original);
+        ASSERT_TRUE(saveResult.IsSuccess()) << saveResult.GetErrorMessage();
+        EXPECT_TRUE(ImageIO::Is16Bit(outputPath));
+
+        auto reloaded = ImageIO::Load16(outputPath);
+        ASSERT_TRUE(reloaded.IsSuccess()) << reloaded.GetErrorMessage();
+        EXPECT_EQ(reloaded.GetValue().width, 37);
+        EXPECT_EQ(reloaded.GetValue().height, 23);
+        EXPECT_EQ(reloaded.GetValue().channels, channels);
+        EXPECT_EQ(reloaded.GetValue().pixels, pixels);
+    }
+}
+
+TEST_F(ImageIOTest, EightBitImagesAreNotSixteenBit) {
+    EXPECT_FALSE(ImageIO::Is16Bit(TestHelpers::GetFixturePath("small_rgb.png").string()));
+    EXPECT_FALSE(ImageIO::Is16Bit(TestHelpers::GetFixturePath("medium_gray.jpg").string()));
+    EXPECT_FALSE(ImageIO::Is16Bit(TestHelpers::GetFixturePath("nonexistent.png").string()));
+}
+
+TEST_F(ImageIOTest, Load16ScalesEightBitImages) {
+    auto eightBit = ImageIO::Load(TestHelpers::GetFixturePath("small_gray.png").string());
+    auto sixteenBit = ImageIO::Load16(TestHelpers::GetFixturePath("small_gray.png").string());
+    ASSERT_TRUE(eightBit.IsSuccess());
+    ASSERT_TRUE(sixteenBit.IsSuccess());
+    ASSERT_EQ(eightBit.GetValue().pixels.size(), sixteenBit.GetValue().pixels.size());
+    for (std::size_t idx = 0; idx < eightBit.GetValue().pixels.size(); ++idx) {
+        EXPECT_EQ(sixteenBit.GetValue().pixels[idx] >> 8, eightBit.GetValue().pixels[idx]);
+    }
+}
+
+TEST_F(ImageIOTest, SixteenBitSaveRejectsInvalidInput) {
+    ImageData16 image(std::vector<uint16_t>(16, 1000), 4, 4, 1);
+    EXPECT_EQ(ImageIO::Save(TestHelpers::GetOutputPath("image16.bmp").string(), image).GetErrorCode(),
+              ErrorCode::UnsupportedImageFormat);
+
+    ImageData16 mismatched(std::vector<uint16_t>(10, 1000), 4, 4, 1);
+    EXPECT_EQ(ImageIO::Save(TestHelpers::GetOutputPath("mismatched16.png").string(), mismatched).GetErrorCode(),
+              ErrorCode::ImageCorrupted);
+
+    auto missing = ImageIO::Load16(TestHelpers::GetFixturePath("nonexistent.png").string());
+    EXPECT_EQ(missing.GetErrorCode(), ErrorCode::ImageLoadFailed);
+}
+
 // ImageData Struct Tests
 
 TEST_F(ImageIOTest, GetPixelCountIsCorrect) {
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "utils/JpegCodec.h"
+#include "utils/ImageIO.h"
+#include "../test_helpers.h"
+#include <algorithm>
+
+// Test fixture for JpegCodec tests with automatic output cleanup
+class JpegCodecTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+    
+    void TearDown() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    // Write a noisy JPEG so that most AC coefficients are non-zero
+    static std::string WriteNoiseJpeg(const std::string &filename, int width, int height, int channels) {
+        auto pixels = TestHelpers::GenerateRandomData(static_cast<std::size_t>(width) * height * channels);
+        auto path = TestHelpers::GetOutputPath(filename).string();
+        EXPECT_TRUE(ImageIO::Save(path, pixels, width, height, channels).IsSuccess());
+        return path;
+    }
+};
+
+// Decoding Tests
+
+TEST_F(JpegCodecTest, DecodesFlatFixture) {
+    auto result = JpegCodec::Load(TestHelpers::GetFixturePath("medium_gray.jpg").string());
+    ASSERT_TRUE(result.IsSuccess()) << result.GetErrorMessage();
+
+    const auto &data = result.GetValue();
+    EXPECT_EQ(data.width, 512);
+    EXPECT_EQ(data.height, 512);
+    ASSERT_EQ(data.components.size(), 1u);
+
+    // Flat image: every AC coefficient is zero and all DC values are equal
+    const auto &component = data.components[0];
+    EXPECT_EQ(component.GetBlockCount(), 64u * 64u);
+    for (std::size_t idx = 0; idx < component.coefficients.size(); ++idx) {
+        if (idx % JpegComponent::BLOCK_SIZE == 0) {
+            EXPECT_EQ(component.coefficients[idx], component.coefficients[0]);
+        } else {
+            EXPECT_EQ(component.coefficients[idx], 0);
+        }
+    }
+}
+
+TEST_F(JpegCodecTest, RoundTripIsByteIdentical) {
+    for (int channels : {1, 3}) {
+        auto path = WriteNoiseJpeg("noise_" + std::to_string(channels) + ".jpg", 123, 77, channels);
+        auto original = TestHelpers::ReadBinaryFile(path);
+
+        auto decodeResult = JpegCodec::Decode(original);
+        ASSERT_TRUE(decodeResult.IsSuccess()) << decodeResult.GetErrorMessage();
+        EXPECT_EQ(decodeResult.GetValue().components.size(), static_cast<std::size_t>(channels));
+
+        auto encodeResult = JpegCodec::Encode(decodeResult.GetValue());
+        ASSERT_TRUE(encodeResult.IsSuccess()) << encodeResult.GetErrorMessage();
+        EXPECT_EQ(encodeResult.GetValue(), original) << "channels = " << channels;
+    }
+}
+
+TEST_F(JpegCodecTest, RoundTripsWithRestartIntervals) {
+    auto path = WriteNoiseJpeg("noise_restart.jpg", 200, 120, 3);
+    auto loadResult = JpegCodec::Load(path);
+    ASSERT_TRUE(loadResult.IsSuccess());
+
+    // Insert a DRI segment (restart every 3 MCUs) before the scan
+    auto data = loadResult.GetValue();
+    JpegSegment restartSegment;
+    restartSegment.marker = 0xDD;
+    restartSegment.payload = {0x00, 0x03};
+    auto sos = std::find_if(data.segments.begin(), data.segments.end(),
+                            [](const JpegSegment &segment) { return segment.marker == 0xDA; });
+    ASSERT_NE(sos, data.segments.end());
+    data.segments.insert(sos, restartSegment);
+
+    auto encodeResult = JpegCodec::Encode(data);
+    ASSERT_TRUE(encodeResult.IsSuccess());
+
+    auto decodeResult = JpegCodec::Decode(encodeResult.GetValue());
+    ASSERT_TRUE(decodeResult.IsSuccess()) << decodeResult.GetErrorMessage();
+    ASSERT_EQ(decodeResult.GetValue().components.size(), data.components.size());
+    for (std::size_t idx = 0; idx < data.components.size(); ++idx) {
+        EXPECT_EQ(decodeResult.GetValue().components[idx].coefficients, data.components[idx].coefficients);
+    }
+
+    // Other decoders read the restart markers too
+    auto savedPath = TestHelpers::GetOutputPath("restart_saved.jpg").string();
+    ASSERT_TRUE(JpegCodec::Save(savedPath, data).IsSuccess());
+    auto image = ImageIO::Load(savedPath);
+    ASSERT_TRUE(image.IsSuccess());
+    EXPECT_EQ(image.GetValue().width, 200);
+}
+
+TEST_F(JpegCodecTest, ModifiedCoefficientsStayDecodable) {
+    auto path = WriteNoiseJpeg("noise_modified.jpg", 64, 64, 1);
+    auto loadResult = JpegCodec::Load(path);
+    ASSERT_TRUE(loadResult.IsSuccess());
+
+    auto data = loadResult.GetValue();
+    auto &coefficients = data.components[0].coefficients;
+    for (std::size_t idx = 1; idx < coefficients.size(); idx += 7) {
+        if (coefficients[idx] >= 2) {
+            coefficients[idx] ^= 1;
+        }
+    }
+
+    auto savedPath = TestHelpers::GetOutputPath("modified.jpg").string();
+    ASSERT_TRUE(JpegCodec::Save(savedPath, data).IsSuccess());
+    EXPECT_TRUE(ImageIO::Load(savedPath).IsSuccess());
+
+    auto reloaded = JpegCodec::Load(savedPath);
+    ASSERT_TRUE(reloaded.IsSuccess());
+    EXPECT_EQ(reloaded.GetValue().components[0].coefficients, coefficients);
+}
+
+// Error Handling Tests
+
+TEST_F(JpegCodecTest, RejectsNonJpegFiles) {
+    auto result = JpegCodec::Load(TestHelpers::GetFixturePath("small_gray.png").string());
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.GetErrorCode(), ErrorCode::UnsupportedImageFormat);
+
+    EXPECT_FALSE(JpegCodec::IsJpegFile(TestHelpers::GetFixturePath("small_gray.png").string()));
+    EXPECT_TRUE(JpegCodec::IsJpegFile(TestHelpers::GetFixturePath("medium_gray.jpg").string()));
+}
+
+TEST_F(JpegCodecTest, RejectsMissingFile) {
+    auto result = JpegCodec::Load(TestHelpers::GetFixturePath("does_not_exist.jpg").string());
+    EXPECT_EQ(result.GetErrorCode(), ErrorCode::FileNotFound);
+}
+
+TEST_F(JpegCodecTest, RejectsTruncatedData) {
+    auto path = WriteNoiseJpeg("noise_truncated.jpg", 64, 64, 1);
+    auto fileData = TestHelpers::ReadBinaryFile(path);
+    fileData.resize(fileData.size() / 2);
+
+    auto result = JpegCodec::Decode(fileData);
+    EXPECT_TRUE(result.IsError());
+}
+
+TEST_F(JpegCodecTest, RejectsProgressiveFrames) {
+    auto fileData = TestHelpers::ReadBinaryFile(TestHelpers::GetFixturePath("medium_gray.jpg"));
+    for (std::size_t idx = 0; idx + 1 < fileData.size(); ++idx) {
+        if (fileData[idx] == 0xFF && fileData[idx + 1] == 0xC0) {
+            fileData[idx + 1] = 0xC2; // SOF0 -> SOF2
+            break;
+        }
+    }
+
+    auto result = JpegCodec::Decode(fileData);
+    EXPECT_EQ(result.GetErrorCode(), ErrorCode::UnsupportedImageFormat);
+}
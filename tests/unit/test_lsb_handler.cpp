@@ -2,17 +2,33 @@
 #include "algorithms/lsb/LSBStegoHandler.h"
 #include "algorithms/lsb/ordered/LSBStegoHandlerOrdered.h"
 #include "algorithms/lsb/shuffle/LSBStegoHandlerShuffle.h"
+#include "algorithms/lsb/shuffle/ShufflePermutation.h"
+#include "algorithms/lsb/shuffle/PartitionedAccess.h"
+#include "algorithms/lsb/shuffle/PermutationCache.h"
+#include "algorithms/lsb/tiled/LSBStegoHandlerTiled.h"
+#include "algorithms/lsb/tiled/TilePermutation.h"
+#include "algorithms/lsb/matching/LSBStegoHandlerMatching.h"
+#include "algorithms/lsb/hamming/LSBStegoHandlerHamming.h"
+#include "algorithms/lsb/adaptive/LSBStegoHandlerAdaptive.h"
+#include "utils/CryptoModule.h"
+#include "utils/CounterRNG.h"
 #include "utils/ImageIO.h"
 #include "../test_helpers.h"
+#include "../simd_level_test.h"
+
+#include <bitset>
+#include <fstream>
+#include <limits>
+#include <thread>
 
 // LSB Capacity Calculation Tests
 
 TEST(LSBHandler_Capacity, CalculatesCorrectCapacityFromPixelCount) {
-    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(100, LSBStegoHandler::HEADER_SIZE_BITS), 8);
-    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(1000, LSBStegoHandler::HEADER_SIZE_BITS), 121);
-    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(1000000, LSBStegoHandler::HEADER_SIZE_BITS), 124996);
-    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(32, LSBStegoHandler::HEADER_SIZE_BITS), 0);
-    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(40, LSBStegoHandler::HEADER_SIZE_BITS), 1);
+    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(100, LSBStegoHandler::HEADER_SIZE_BITS), 0);
+    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(1000, LSBStegoHandler::HEADER_SIZE_BITS), 105);
+    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(1000000, LSBStegoHandler::HEADER_SIZE_BITS), 124980);
+    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(160, LSBStegoHandler::HEADER_SIZE_BITS), 0);
+    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(168, LSBStegoHandler::HEADER_SIZE_BITS), 1);
 }
 
 TEST(LSBHandler_Capacity, CalculatesCorrectCapacityFromImageData) {
@@ -35,19 +51,19 @@ TEST(LSBHandler_Capacity, CalculatesCorrectCapacityFromImageData) {
 TEST(LSBHandler_Capacity, HandlesEdgeCasesCorrectly) {
     EXPECT_EQ(LSBStegoHandler::CalculateCapacity(0, LSBStegoHandler::HEADER_SIZE_BITS), 0);
     EXPECT_EQ(LSBStegoHandler::CalculateCapacity(10, LSBStegoHandler::HEADER_SIZE_BITS), 0);
-    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(31, LSBStegoHandler::HEADER_SIZE_BITS), 0);
+    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(159, LSBStegoHandler::HEADER_SIZE_BITS), 0);
     
     ImageData smallImage;
-    smallImage.width = 10;
-    smallImage.height = 10;
+    smallImage.width = 20;
+    smallImage.height = 20;
     smallImage.channels = 1;
-    smallImage.pixels.resize(100);
-    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(smallImage, LSBStegoHandler::HEADER_SIZE_BITS), 8);
+    smallImage.pixels.resize(400);
+    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(smallImage, LSBStegoHandler::HEADER_SIZE_BITS), 30);
     
     ImageData multiChannel = smallImage;
     multiChannel.channels = 3;
-    multiChannel.pixels.resize(300);
-    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(multiChannel, LSBStegoHandler::HEADER_SIZE_BITS), 33);
+    multiChannel.pixels.resize(1200);
+    EXPECT_EQ(LSBStegoHandler::CalculateCapacity(multiChannel, LSBStegoHandler::HEADER_SIZE_BITS), 130);
 }
 
 // LSB Capacity Validation Tests
@@ -56,17 +72,17 @@ TEST(LSBHandler_Validation, AcceptsValidDataSize) {
     auto result = LSBStegoHandler::ValidateCapacity(1000, 100, LSBStegoHandler::HEADER_SIZE_BITS, StegoHandler::MAX_REASONABLE_SIZE );
     EXPECT_TRUE(result.IsSuccess());
     
-    auto result2 = LSBStegoHandler::ValidateCapacity(1000, 121, LSBStegoHandler::HEADER_SIZE_BITS, StegoHandler::MAX_REASONABLE_SIZE );
+    auto result2 = LSBStegoHandler::ValidateCapacity(1000, 105, LSBStegoHandler::HEADER_SIZE_BITS, StegoHandler::MAX_REASONABLE_SIZE );
     EXPECT_TRUE(result2.IsSuccess());
 }
 
 TEST(LSBHandler_Validation, RejectsOversizedData) {
-    auto result = LSBStegoHandler::ValidateCapacity(1000, 122, LSBStegoHandler::HEADER_SIZE_BITS, StegoHandler::MAX_REASONABLE_SIZE );
+    auto result = LSBStegoHandler::ValidateCapacity(1000, 106, LSBStegoHandler::HEADER_SIZE_BITS, StegoHandler::MAX_REASONABLE_SIZE );
     EXPECT_TRUE(result.IsError());
     EXPECT_EQ(result.GetErrorCode(), ErrorCode::InsufficientCapacity);
     EXPECT_FALSE(result.GetErrorMessage().empty());
     
-    auto result2 = LSBStegoHandler::ValidateCapacity(100, 50, LSBStegoHandler::HEADER_SIZE_BITS, StegoHandler::MAX_REASONABLE_SIZE );
+    auto result2 = LSBStegoHandler::ValidateCapacity(300, 50, LSBStegoHandler::HEADER_SIZE_BITS, StegoHandler::MAX_REASONABLE_SIZE );
     EXPECT_TRUE(result2.IsError());
     EXPECT_EQ(result2.GetErrorCode(), ErrorCode::InsufficientCapacity);
 }
@@ -90,11 +106,12 @@ TEST(LSBHandler_Embed, EmbedsDataCorrectly) {
     auto result = handler.EmbedMethod(imgData, data, "");
     EXPECT_TRUE(result.IsSuccess());
     
-    uint32_t embeddedSize = 0;
-    for (int i = 0; i < 32; i++) {
-        embeddedSize |= ((imgData.pixels[i] & 1) << i);
-    }
-    EXPECT_EQ(embeddedSize, 2);
+    auto header = PayloadHeader::Read(imgData.pixels.size(), PayloadMethod::LSB, [&](std::size_t bit) {
+        return imgData.pixels[bit];
+    });
+    ASSERT_TRUE(header.IsSuccess());
+    EXPECT_EQ(header.GetValue().dataSize, 2u);
+    EXPECT_EQ(header.GetValue().method, PayloadMethod::LSB);
 }
 
 TEST(LSBHandler_Embed, ModifiesOnlyLSBs) {
@@ -124,11 +141,12 @@ TEST(LSBHandler_Embed, EmbedsSizeHeaderCorrectly) {
     auto result = handler.EmbedMethod(imgData, data, "");
     EXPECT_TRUE(result.IsSuccess());
     
-    uint32_t size = 0;
-    for (int i = 0; i < 32; i++) {
-        size |= ((imgData.pixels[i] & 1) << i);
-    }
-    EXPECT_EQ(size, 42);
+    auto header = PayloadHeader::Read(imgData.pixels.size(), PayloadMethod::LSB, [&](std::size_t bit) {
+        return imgData.pixels[bit];
+    });
+    ASSERT_TRUE(header.IsSuccess());
+    EXPECT_EQ(header.GetValue().version, PayloadHeader::VERSION);
+    EXPECT_EQ(header.GetValue().dataSize, 42u);
 }
 
 TEST(LSBHandler_Embed, HandlesSingleByteData) {
@@ -145,7 +163,7 @@ TEST(LSBHandler_Embed, HandlesSingleByteData) {
 
 TEST(LSBHandler_Embed, HandlesMaxCapacityData) {
     size_t pixelCount = 1000;
-    size_t maxCapacity = (pixelCount - 32) / 8;
+    size_t maxCapacity = (pixelCount - LSBStegoHandler::HEADER_SIZE_BITS) / 8;
     std::vector<uint8_t> pixels(pixelCount, 0);
     std::vector<uint8_t> data(maxCapacity, 0x42);
     
@@ -385,7 +403,7 @@ TEST(LSBHandler_Errors, RejectsEmptyData) {
 }
 
 TEST(LSBHandler_Errors, ProvidesDescriptiveErrorMessages) {
-    auto result = LSBStegoHandler::ValidateCapacity(100, 50, LSBStegoHandler::HEADER_SIZE_BITS, StegoHandler::MAX_REASONABLE_SIZE );
+    auto result = LSBStegoHandler::ValidateCapacity(300, 50, LSBStegoHandler::HEADER_SIZE_BITS, StegoHandler::MAX_REASONABLE_SIZE );
     EXPECT_TRUE(result.IsError());
     EXPECT_EQ(result.GetErrorCode(), ErrorCode::InsufficientCapacity);
     
@@ -393,3 +411,1338 @@ TEST(LSBHandler_Errors, ProvidesDescriptiveErrorMessages) {
     EXPECT_FALSE(msg.empty());
     EXPECT_NE(msg.find("capacity"), std::string::npos);
 }
+
+// LSB Matching Tests
+
+TEST(LSBHandler_Matching, RoundTripsWithOrderedExtraction) {
+    auto image = ImageIO::Load(TestHelpers::GetFixturePath("medium_gray.png").string());
+    ASSERT_TRUE(image.IsSuccess());
+    auto binaryData = TestHelpers::ReadBinaryFile(TestHelpers::GetFixturePath("binary_data.bin"));
+
+    LSBStegoHandlerMatching handler;
+    auto embedResult = handler.EmbedMethod(image.GetValue(), binaryData, "matchpass");
+    ASSERT_TRUE(embedResult.IsSuccess());
+
+    // Matching shares the ordered bit layout, so the ordered extractor reads it too
+    LSBStegoHandlerOrdered ordered;
+    auto extractResult = ordered.ExtractMethod(image.GetValue(), "");
+    ASSERT_TRUE(extractResult.IsSuccess());
+    EXPECT_EQ(extractResult.GetValue(), binaryData);
+}
+
+TEST(LSBHandler_Matching, ChangesValuesByAtMostOneInBothDirections) {
+    std::vector<uint8_t> original(20000, 128);
+    std::vector<uint8_t> data(2000, 0xFF); // every data bit differs from the even cover LSB
+
+    LSBStegoHandlerMatching handler;
+    ImageData imgData(original, static_cast<int>(original.size()), 1, 1);
+    ASSERT_TRUE(handler.EmbedMethod(imgData, data, "pass").IsSuccess());
+
+    std::size_t increments = 0, decrements = 0;
+    for (std::size_t i = 0; i < imgData.pixels.size(); ++i) {
+        int diff = static_cast<int>(imgData.pixels[i]) - static_cast<int>(original[i]);
+        EXPECT_LE(std::abs(diff), 1);
+        if (diff > 0) ++increments;
+        if (diff < 0) ++decrements;
+    }
+
+    // +1 and -1 should both be used, roughly evenly
+    EXPECT_GT(increments, 0u);
+    EXPECT_GT(decrements, 0u);
+    EXPECT_NEAR(static_cast<double>(increments), static_cast<double>(decrements),
+                (increments + decrements) * 0.1);
+}
+
+TEST(LSBHandler_Matching, SaturatesAtValueBoundaries) {
+    std::vector<uint8_t> pixels(1000);
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = (i % 2 == 0) ? 0 : 255;
+    }
+    std::vector<uint8_t> data(100);
+    for (auto &byte : data) byte = 0x55 ^ 0xFF; // bits opposite to the 0/255 parity pattern
+
+    LSBStegoHandlerMatching handler;
+    ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+    ASSERT_TRUE(handler.EmbedMethod(imgData, data, "").IsSuccess());
+
+    for (std::size_t i = 0; i < imgData.pixels.size(); ++i) {
+        if (pixels[i] == 0) {
+            EXPECT_LE(imgData.pixels[i], 1);   // never wraps to 255
+        } else {
+            EXPECT_GE(imgData.pixels[i], 254); // never wraps to 0
+        }
+    }
+
+    auto extractResult = handler.ExtractMethod(imgData, "");
+    ASSERT_TRUE(extractResult.IsSuccess());
+    EXPECT_EQ(extractResult.GetValue(), data);
+}
+
+// Runs once per +-1 kernel
+class LSBHandler_MatchingKernels : public SimdLevelTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, LSBHandler_MatchingKernels, AllSimdLevels(), SimdLevelParamName);
+
+TEST_P(LSBHandler_MatchingKernels, StepsFollowTheKeyedSignStream) {
+    // Odd sizes leave partial vector steps at the end of the last chunk
+    auto original = TestHelpers::GenerateRandomData(3 * LSBStegoHandlerMatching::CHUNK_SIZE + 77);
+    for (std::size_t i = 0; i < original.size(); i += 5) {
+        original[i] = (i % 2 == 0) ? 0 : 255;
+    }
+    auto data = TestHelpers::GenerateRandomData(1501);
+
+    LSBStegoHandlerMatching handler;
+    ImageData imgData(original, static_cast<int>(original.size()), 1, 1);
+    ASSERT_TRUE(handler.EmbedMethod(imgData, data, "signs").IsSuccess());
+
+    auto key = CryptoModule::DeriveSubkey("signs", "stegtool/lsb-matching/sign", CounterRNG::KEY_SIZE);
+    ASSERT_TRUE(key.IsSuccess());
+    std::vector<uint32_t> words((original.size() + 31) / 32);
+    CounterRNG(key.GetValue()).Fill(0, words.data(), words.size());
+
+    // A changed sample went up where its sign bit is set or it was 0, down otherwise or at 255
+    for (std::size_t i = 0; i < original.size(); ++i) {
+        int value = original[i];
+        int diff = static_cast<int>(imgData.pixels[i]) - value;
+        if (diff == 0) {
+            continue;
+        }
+        bool up = (((words[i / 32] >> (i % 32)) & 1) || value == 0) && value != 255;
+        EXPECT_EQ(diff, up ? 1 : -1) << i;
+    }
+
+    auto extractResult = handler.ExtractMethod(imgData, "");
+    ASSERT_TRUE(extractResult.IsSuccess());
+    EXPECT_EQ(extractResult.GetValue(), data);
+}
+
+TEST(LSBHandler_Matching, LeavesMatchingLSBsUntouched) {
+    std::vector<uint8_t> pixels(1000, 100);
+    std::vector<uint8_t> data(50, 0x00); // all zero bits match the even cover
+
+    LSBStegoHandlerMatching handler;
+    ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+    ASSERT_TRUE(handler.EmbedMethod(imgData, data, "").IsSuccess());
+
+    // Only the size header bits may differ
+    for (std::size_t i = LSBStegoHandler::HEADER_SIZE_BITS; i < imgData.pixels.size(); ++i) {
+        EXPECT_EQ(imgData.pixels[i], 100);
+    }
+}
+
+TEST(LSBHandler_Matching, IsDeterministicForSamePassword) {
+    std::vector<uint8_t> pixels(5000, 77);
+    auto data = TestHelpers::GenerateRandomData(500);
+
+    LSBStegoHandlerMatching handler;
+    ImageData imgData1(pixels, static_cast<int>(pixels.size()), 1, 1);
+    ImageData imgData2(pixels, static_cast<int>(pixels.size()), 1, 1);
+    ImageData imgData3(pixels, static_cast<int>(pixels.size()), 1, 1);
+    ASSERT_TRUE(handler.EmbedMethod(imgData1, data, "same").IsSuccess());
+    ASSERT_TRUE(handler.EmbedMethod(imgData2, data, "same").IsSuccess());
+    ASSERT_TRUE(handler.EmbedMethod(imgData3, data, "other").IsSuccess());
+
+    EXPECT_EQ(imgData1.pixels, imgData2.pixels);
+    EXPECT_NE(imgData1.pixels, imgData3.pixels);
+}
+
+TEST(LSBHandler_Matching, RejectsEmptyAndOversizedData) {
+    std::vector<uint8_t> pixels(1000, 0);
+    LSBStegoHandlerMatching handler;
+
+    ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+    auto emptyResult = handler.EmbedMethod(imgData, {}, "");
+    EXPECT_EQ(emptyResult.GetErrorCode(), ErrorCode::InvalidArgument);
+
+    std::vector<uint8_t> tooLarge(106, 0x42);
+    auto largeResult = handler.EmbedMethod(imgData, tooLarge, "");
+    EXPECT_EQ(largeResult.GetErrorCode(), ErrorCode::InsufficientCapacity);
+}
+
+// Hamming Matrix Embedding Tests
+
+TEST(LSBHandler_Hamming, CalculatesCapacityPerCodeParameter) {
+    // 168 prefix values, then blocks of 2^p - 1 values carrying p bits each
+    EXPECT_EQ(LSBStegoHandlerHamming::CalculateCapacity(1168, 1), 125u);
+    EXPECT_EQ(LSBStegoHandlerHamming::CalculateCapacity(1168, 3), 53u);  // 142 blocks * 3 bits
+    EXPECT_EQ(LSBStegoHandlerHamming::CalculateCapacity(1168, 6), 11u);  // 15 blocks * 6 bits
+    EXPECT_EQ(LSBStegoHandlerHamming::CalculateCapacity(168, 3), 0u);
+    EXPECT_EQ(LSBStegoHandlerHamming::CalculateCapacity(1168, 0), 0u);
+    EXPECT_EQ(LSBStegoHandlerHamming::CalculateCapacity(1168, 7), 0u);
+}
+
+TEST(LSBHandler_Hamming, ChoosesLargestCodeParameterThatFits) {
+    EXPECT_EQ(LSBStegoHandlerHamming::ChooseCodeParam(1168, 10), 6);
+    EXPECT_EQ(LSBStegoHandlerHamming::ChooseCodeParam(1168, 50), 3);
+    EXPECT_EQ(LSBStegoHandlerHamming::ChooseCodeParam(1168, 125), 1);
+    EXPECT_EQ(LSBStegoHandlerHamming::ChooseCodeParam(1168, 126), LSBStegoHandlerHamming::AUTO_CODE_PARAM);
+}
+
+// Runs once per LSB packing kernel
+class LSBHandler_HammingKernels : public SimdLevelTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, LSBHandler_HammingKernels, AllSimdLevels(), SimdLevelParamName);
+
+TEST_P(LSBHandler_HammingKernels, RoundTripsForEveryCodeParameter) {
+    std::vector<uint8_t> pixels = TestHelpers::GenerateRandomData(40000);
+    auto data = TestHelpers::GenerateRandomData(300);
+
+    for (int p = LSBStegoHandlerHamming::MIN_CODE_PARAM; p <= LSBStegoHandlerHamming::MAX_CODE_PARAM; ++p) {
+        LSBStegoHandlerHamming handler(p);
+        ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+        ASSERT_TRUE(handler.EmbedMethod(imgData, data, "").IsSuccess()) << "p = " << p;
+
+        // The extractor reads p from the image, so any instance decodes it
+        LSBStegoHandlerHamming extractor;
+        auto extractResult = extractor.ExtractMethod(imgData, "");
+        ASSERT_TRUE(extractResult.IsSuccess()) << "p = " << p;
+        EXPECT_EQ(extractResult.GetValue(), data) << "p = " << p;
+    }
+}
+
+TEST_P(LSBHandler_HammingKernels, SyndromesMatchTheDefinitionAcrossChunks) {
+    // Several 64K-value packing chunks, and block sizes that straddle them
+    std::vector<uint8_t> pixels = TestHelpers::GenerateRandomData(3 * 65536 + 1001);
+    const std::size_t prefix = LSBStegoHandler::HEADER_SIZE_BITS + LSBStegoHandlerHamming::CODE_PARAM_BITS;
+
+    for (int p = LSBStegoHandlerHamming::MIN_CODE_PARAM; p <= LSBStegoHandlerHamming::MAX_CODE_PARAM; ++p) {
+        auto data = TestHelpers::GenerateRandomData(LSBStegoHandlerHamming::CalculateCapacity(pixels.size(), p));
+        LSBStegoHandlerHamming handler(p);
+        ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+        ASSERT_TRUE(handler.EmbedMethod(imgData, data, "").IsSuccess()) << "p = " << p;
+
+        // Syndrome bit j is the parity of the LSBs at positions i where bit j of i + 1 is set
+        const std::size_t blockSize = (std::size_t(1) << p) - 1;
+        for (std::size_t bit = 0; bit < data.size() * 8; ++bit) {
+            std::size_t start = prefix + (bit / p) * blockSize;
+            uint32_t parity = 0;
+            for (std::size_t i = 0; i < blockSize; ++i) {
+                parity ^= (((i + 1) >> (bit % p)) & 1) & imgData.pixels[start + i];
+            }
+            ASSERT_EQ(parity, (data[bit / 8] >> (bit % 8)) & 1u) << "p = " << p << ", bit " << bit;
+        }
+
+        auto extractResult = handler.ExtractMethod(imgData, "");
+        ASSERT_TRUE(extractResult.IsSuccess()) << "p = " << p;
+        EXPECT_EQ(extractResult.GetValue(), data) << "p = " << p;
+    }
+}
+
+TEST(LSBHandler_Hamming, ChangesAtMostOneValuePerBlock) {
+    std::vector<uint8_t> pixels = TestHelpers::GenerateRandomData(20000);
+    auto data = TestHelpers::GenerateRandomData(500);
+    const int p = 4;
+    const std::size_t blockSize = 15;
+    const std::size_t prefix = LSBStegoHandler::HEADER_SIZE_BITS + LSBStegoHandlerHamming::CODE_PARAM_BITS;
+
+    LSBStegoHandlerHamming handler(p);
+    ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+    ASSERT_TRUE(handler.EmbedMethod(imgData, data, "").IsSuccess());
+
+    for (std::size_t start = prefix; start + blockSize <= pixels.size(); start += blockSize) {
+        std::size_t changes = 0;
+        for (std::size_t i = start; i < start + blockSize; ++i) {
+            EXPECT_LE(std::abs(static_cast<int>(imgData.pixels[i]) - static_cast<int>(pixels[i])), 1);
+            changes += imgData.pixels[i] != pixels[i];
+        }
+        EXPECT_LE(changes, 1u) << "block at " << start;
+    }
+}
+
+TEST(LSBHandler_Hamming, ChangesFewerValuesThanOrderedLSB) {
+    auto image = ImageIO::Load(TestHelpers::GetFixturePath("medium_gray.png").string());
+    ASSERT_TRUE(image.IsSuccess());
+    auto data = TestHelpers::GenerateRandomData(1000);
+
+    ImageData ordered = image.GetValue();
+    ImageData hamming = image.GetValue();
+    ASSERT_TRUE(LSBStegoHandlerOrdered().EmbedMethod(ordered, data, "").IsSuccess());
+    ASSERT_TRUE(LSBStegoHandlerHamming().EmbedMethod(hamming, data, "").IsSuccess());
+
+    std::size_t orderedChanges = 0, hammingChanges = 0;
+    for (std::size_t i = 0; i < image.GetValue().pixels.size(); ++i) {
+        orderedChanges += ordered.pixels[i] != image.GetValue().pixels[i];
+        hammingChanges += hamming.pixels[i] != image.GetValue().pixels[i];
+    }
+    EXPECT_LT(hammingChanges, orderedChanges);
+}
+
+TEST(LSBHandler_Hamming, RejectsInvalidInput) {
+    std::vector<uint8_t> pixels(1168, 0);
+    ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+
+    LSBStegoHandlerHamming handler;
+    EXPECT_EQ(handler.EmbedMethod(imgData, {}, "").GetErrorCode(), ErrorCode::InvalidArgument);
+
+    std::vector<uint8_t> tooLarge(126, 0x42);
+    EXPECT_EQ(handler.EmbedMethod(imgData, tooLarge, "").GetErrorCode(), ErrorCode::InsufficientCapacity);
+
+    LSBStegoHandlerHamming badParam(9);
+    EXPECT_EQ(badParam.EmbedMethod(imgData, {1, 2, 3}, "").GetErrorCode(), ErrorCode::InvalidArgument);
+}
+
+TEST(LSBHandler_Hamming, RejectsCorruptedCodeParameter) {
+    std::vector<uint8_t> pixels = TestHelpers::GenerateRandomData(5000);
+    ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+
+    LSBStegoHandlerHamming handler(3);
+    ASSERT_TRUE(handler.EmbedMethod(imgData, {1, 2, 3, 4}, "").IsSuccess());
+
+    // Force p = 7 (bits 0..2 set) in the plain LSB code parameter field
+    for (std::size_t i = 0; i < LSBStegoHandlerHamming::CODE_PARAM_BITS; ++i) {
+        uint8_t bit = i < 3 ? 1 : 0;
+        auto &value = imgData.pixels[LSBStegoHandler::HEADER_SIZE_BITS + i];
+        value = static_cast<uint8_t>((value & 0xFE) | bit);
+    }
+    auto extractResult = handler.ExtractMethod(imgData, "");
+    EXPECT_EQ(extractResult.GetErrorCode(), ErrorCode::CorruptedPayload);
+}
+
+// Embedding Mask Tests
+
+namespace {
+
+ImageData MakeNoiseImage(int width, int height, int channels, uint32_t seed) {
+    std::vector<uint8_t> pixels(static_cast<std::size_t>(width) * height * channels);
+    for (auto &value : pixels) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<uint8_t>(seed >> 24);
+    }
+    return ImageData(pixels, width, height, channels);
+}
+
+// Embeds at full capacity with every channel subset, checks only the selected bits changed
+template <typename Image>
+void ExpectEveryChannelSubsetRoundTrips(const Image &original, int bitPlane, int bitCount) {
+    using Sample = typename decltype(original.pixels)::value_type;
+    const std::size_t channels = static_cast<std::size_t>(original.channels);
+    const Sample planes = static_cast<Sample>(((1u << bitCount) - 1) << bitPlane);
+
+    for (uint8_t subset = 1; subset < (1u << channels); ++subset) {
+        LSBStegoHandlerOrdered handler;
+        EmbeddingMask mask;
+        mask.channels = subset;
+        mask.bitPlane = bitPlane;
+        mask.bitCount = bitCount;
+        handler.SetEmbeddingMask(mask);
+
+        std::size_t selected = std::bitset<8>(subset).count();
+        std::size_t bits = original.pixels.size() / channels * selected * static_cast<std::size_t>(bitCount);
+        auto data = TestHelpers::GenerateRandomData((bits - LSBStegoHandler::HEADER_SIZE_BITS) / 8);
+        Image stego = original;
+
+        ASSERT_TRUE(handler.EmbedMethod(stego, data, "").IsSuccess()) << int(subset);
+        for (std::size_t idx = 0; idx < stego.pixels.size(); ++idx) {
+            Sample keep = (subset & (1u << (idx % channels))) ? static_cast<Sample>(~planes) : static_cast<Sample>(~0u);
+            ASSERT_EQ(stego.pixels[idx] & keep, original.pixels[idx] & keep) << int(subset) << " " << idx;
+        }
+
+        auto extracted = handler.ExtractMethod(stego, "");
+        ASSERT_TRUE(extracted.IsSuccess()) << int(subset);
+        EXPECT_EQ(extracted.GetValue(), data) << int(subset);
+    }
+}
+
+} // namespace
+
+// Gather/scatter tests run once per kernel table
+class LSBHandler_MaskKernels : public SimdLevelTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, LSBHandler_MaskKernels, AllSimdLevels(), SimdLevelParamName);
+
+TEST(LSBHandler_Mask, ParsesChannelLettersAndIndexes) {
+    auto rgb = EmbeddingMask::Parse("rgb", 0);
+    ASSERT_TRUE(rgb.IsSuccess());
+    EXPECT_EQ(rgb.GetValue().channels, 0x07);
+    EXPECT_FALSE(rgb.GetValue().IsDefault());
+
+    auto blue = EmbeddingMask::Parse("B", 3);
+    ASSERT_TRUE(blue.IsSuccess());
+    EXPECT_EQ(blue.GetValue().channels, 0x04);
+    EXPECT_EQ(blue.GetValue().bitPlane, 3);
+
+    auto all = EmbeddingMask::Parse("0123", 0);
+    ASSERT_TRUE(all.IsSuccess());
+    EXPECT_TRUE(all.GetValue().IsDefault());
+}
+
+TEST(LSBHandler_Mask, RejectsInvalidSpecifications) {
+    EXPECT_EQ(EmbeddingMask::Parse("", 0).GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(EmbeddingMask::Parse("rgx", 0).GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(EmbeddingMask::Parse("rgb", 16).GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(EmbeddingMask::Parse("rgb", 0, 0).GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(EmbeddingMask::Parse("rgb", 0, 9).GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(EmbeddingMask::Parse("rgb", -1).GetErrorCode(), ErrorCode::InvalidArgument);
+}
+
+TEST_P(LSBHandler_MaskKernels, RGBOfRGBALeavesAlphaUntouchedForAllMethods) {
+    EmbeddingMask mask;
+    mask.channels = 0x07;
+    std::vector<uint8_t> data(200, 0x5A);
+
+    LSBStegoHandlerOrdered ordered;
+    LSBStegoHandlerShuffle shuffle;
+    LSBStegoHandlerMatching matching;
+    LSBStegoHandlerHamming hamming;
+    LSBStegoHandler *handlers[] = {&ordered, &shuffle, &matching, &hamming};
+
+    for (LSBStegoHandler *handler : handlers) {
+        handler->SetEmbeddingMask(mask);
+        ImageData original = MakeNoiseImage(64, 64, 4, 7);
+        ImageData stego = original;
+
+        ASSERT_TRUE(handler->EmbedMethod(stego, data, "pw").IsSuccess());
+        for (std::size_t idx = 3; idx < stego.pixels.size(); idx += 4) {
+            ASSERT_EQ(stego.pixels[idx], original.pixels[idx]);
+        }
+
+        auto extracted = handler->ExtractMethod(stego, "pw");
+        ASSERT_TRUE(extracted.IsSuccess());
+        EXPECT_EQ(extracted.GetValue(), data);
+    }
+}
+
+TEST_P(LSBHandler_MaskKernels, SingleChannelOnlyChangesThatChannel) {
+    LSBStegoHandlerOrdered handler;
+    EmbeddingMask mask;
+    mask.channels = 0x02;
+    handler.SetEmbeddingMask(mask);
+
+    ImageData original = MakeNoiseImage(64, 64, 3, 11);
+    ImageData stego = original;
+    std::vector<uint8_t> data(100, 0xC3);
+
+    ASSERT_TRUE(handler.EmbedMethod(stego, data, "").IsSuccess());
+    for (std::size_t idx = 0; idx < stego.pixels.size(); ++idx) {
+        if (idx % 3 != 1) {
+            ASSERT_EQ(stego.pixels[idx], original.pixels[idx]);
+        }
+    }
+
+    auto extracted = handler.ExtractMethod(stego, "");
+    ASSERT_TRUE(extracted.IsSuccess());
+    EXPECT_EQ(extracted.GetValue(), data);
+}
+
+TEST_P(LSBHandler_MaskKernels, BitPlaneOnlyChangesThatBit) {
+    LSBStegoHandlerShuffle handler;
+    EmbeddingMask mask;
+    mask.bitPlane = 2;
+    handler.SetEmbeddingMask(mask);
+
+    ImageData original = MakeNoiseImage(32, 32, 4, 3);
+    ImageData stego = original;
+    std::vector<uint8_t> data(150, 0x96);
+
+    ASSERT_TRUE(handler.EmbedMethod(stego, data, "pw").IsSuccess());
+    bool changed = false;
+    for (std::size_t idx = 0; idx < stego.pixels.size(); ++idx) {
+        ASSERT_EQ(stego.pixels[idx] & ~0x04, original.pixels[idx] & ~0x04);
+        changed = changed || stego.pixels[idx] != original.pixels[idx];
+    }
+    EXPECT_TRUE(changed);
+
+    auto extracted = handler.ExtractMethod(stego, "pw");
+    ASSERT_TRUE(extracted.IsSuccess());
+    EXPECT_EQ(extracted.GetValue(), data);
+}
+
+TEST_P(LSBHandler_MaskKernels, HandlesNonContiguousChannels) {
+    LSBStegoHandlerHamming handler;
+    auto mask = EmbeddingMask::Parse("rb", 1);
+    ASSERT_TRUE(mask.IsSuccess());
+    handler.SetEmbeddingMask(mask.GetValue());
+
+    ImageData original = MakeNoiseImage(64, 64, 4, 5);
+    ImageData stego = original;
+    std::vector<uint8_t> data(80, 0x21);
+
+    ASSERT_TRUE(handler.EmbedMethod(stego, data, "").IsSuccess());
+    for (std::size_t idx = 0; idx < stego.pixels.size(); ++idx) {
+        bool selected = (idx % 4 == 0) || (idx % 4 == 2);
+        uint8_t keep = selected ? static_cast<uint8_t>(~0x02) : static_cast<uint8_t>(0xFF);
+        ASSERT_EQ(stego.pixels[idx] & keep, original.pixels[idx] & keep);
+    }
+
+    auto extracted = handler.ExtractMethod(stego, "");
+    ASSERT_TRUE(extracted.IsSuccess());
+    EXPECT_EQ(extracted.GetValue(), data);
+}
+
+TEST(LSBHandler_Mask, RejectsMasksWithoutUsableSamples) {
+    LSBStegoHandlerOrdered handler;
+    EmbeddingMask mask;
+    mask.channels = 0x08;
+    handler.SetEmbeddingMask(mask);
+
+    // Alpha only, on an RGB image
+    ImageData image = MakeNoiseImage(16, 16, 3, 1);
+    std::vector<uint8_t> data{0x01};
+    EXPECT_EQ(handler.EmbedMethod(image, data, "").GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(handler.ExtractMethod(image, "").GetErrorCode(), ErrorCode::InvalidArgument);
+}
+
+TEST_P(LSBHandler_MaskKernels, MultiBitRoundTripsOnEightBitImages) {
+    LSBStegoHandlerOrdered handler;
+    auto mask = EmbeddingMask::Parse("rgb", 0, 2);
+    ASSERT_TRUE(mask.IsSuccess());
+    handler.SetEmbeddingMask(mask.GetValue());
+
+    ImageData original = MakeNoiseImage(32, 32, 3, 8);
+    ImageData stego = original;
+    // Twice the single-plane capacity
+    std::vector<uint8_t> data((32 * 32 * 3 * 2 - LSBStegoHandler::HEADER_SIZE_BITS) / 8, 0xA7);
+
+    ASSERT_TRUE(handler.EmbedMethod(stego, data, "").IsSuccess());
+    for (std::size_t idx = 0; idx < stego.pixels.size(); ++idx) {
+        ASSERT_EQ(stego.pixels[idx] & 0xFC, original.pixels[idx] & 0xFC);
+    }
+
+    auto extracted = handler.ExtractMethod(stego, "");
+    ASSERT_TRUE(extracted.IsSuccess());
+    EXPECT_EQ(extracted.GetValue(), data);
+}
+
+TEST_P(LSBHandler_MaskKernels, EveryChannelSubsetRoundTripsAtFullCapacity) {
+    // 37x29 leaves partial vector blocks and a partial chunk of pixels
+    for (int channels = 1; channels <= 4; ++channels) {
+        ImageData image = MakeNoiseImage(37, 29, channels, 40 + channels);
+        ExpectEveryChannelSubsetRoundTrips(image, 0, 1);
+        ExpectEveryChannelSubsetRoundTrips(image, 3, 1);
+        ExpectEveryChannelSubsetRoundTrips(image, 1, 3);
+
+        std::vector<uint16_t> pixels(image.pixels.size());
+        for (std::size_t idx = 0; idx < pixels.size(); ++idx) {
+            pixels[idx] = static_cast<uint16_t>(image.pixels[idx] * 257 + idx);
+        }
+        ImageData16 image16(pixels, 37, 29, channels);
+        ExpectEveryChannelSubsetRoundTrips(image16, 0, 1);
+        ExpectEveryChannelSubsetRoundTrips(image16, 9, 1);
+        ExpectEveryChannelSubsetRoundTrips(image16, 2, 5);
+    }
+}
+
+TEST_P(LSBHandler_MaskKernels, MatchesPortableKernelOutput) {
+    for (int channels = 2; channels <= 4; ++channels) {
+        EmbeddingMask mask;
+        mask.channels = 0x05;
+        mask.bitPlane = 1;
+        mask.bitCount = 2;
+        LSBStegoHandlerOrdered handler;
+        handler.SetEmbeddingMask(mask);
+
+        ImageData stego = MakeNoiseImage(45, 31, channels, 60 + channels);
+        ImageData portable = stego;
+        std::vector<uint8_t> data(300, 0x3C);
+
+        ASSERT_TRUE(handler.EmbedMethod(stego, data, "").IsSuccess());
+        {
+            CpuFeatures::ScopedSimdLevel level(SimdLevel::Portable);
+            ASSERT_TRUE(handler.EmbedMethod(portable, data, "").IsSuccess());
+        }
+        EXPECT_EQ(stego.pixels, portable.pixels) << channels;
+    }
+}
+
+TEST(LSBHandler_Mask, RejectsPlanesBeyondSampleDepth) {
+    LSBStegoHandlerOrdered handler;
+    EmbeddingMask mask;
+    mask.bitPlane = 6;
+    mask.bitCount = 3;
+    handler.SetEmbeddingMask(mask);
+
+    ImageData image = MakeNoiseImage(16, 16, 3, 1);
+    std::vector<uint8_t> data{0x01};
+    EXPECT_EQ(handler.EmbedMethod(image, data, "").GetErrorCode(), ErrorCode::InvalidArgument);
+
+    // Fine for 16-bit samples
+    ImageData16 image16(std::vector<uint16_t>(16 * 16 * 3, 4000), 16, 16, 3);
+    EXPECT_TRUE(handler.EmbedMethod(image16, data, "").IsSuccess());
+}
+
+TEST(LSBHandler_Mask, MatchingRejectsHigherBitPlanes) {
+    LSBStegoHandlerMatching handler;
+    EmbeddingMask mask;
+    mask.bitPlane = 1;
+    handler.SetEmbeddingMask(mask);
+
+    ImageData image = MakeNoiseImage(16, 16, 3, 1);
+    std::vector<uint8_t> data{0x01};
+    EXPECT_EQ(handler.EmbedMethod(image, data, "").GetErrorCode(), ErrorCode::InvalidArgument);
+}
+
+// 16-bit Sample Tests
+
+TEST(LSBHandler_16Bit, MultiBitRoundTripsForAllBitMethods) {
+    auto mask = EmbeddingMask::Parse("rgb", 0, 4);
+    ASSERT_TRUE(mask.IsSuccess());
+
+    LSBStegoHandlerOrdered ordered;
+    LSBStegoHandlerShuffle shuffle;
+    LSBStegoHandlerHamming hamming;
+    LSBStegoHandlerAdaptive adaptive;
+    LSBStegoHandler *handlers[] = {&ordered, &shuffle, &hamming, &adaptive};
+
+    std::vector<uint16_t> pixels(48 * 40 * 3);
+    uint32_t seed = 17;
+    for (auto &value : pixels) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<uint16_t>(seed >> 16);
+    }
+    std::vector<uint8_t> data(600, 0x4D);
+
+    for (LSBStegoHandler *handler : handlers) {
+        handler->SetEmbeddingMask(mask.GetValue());
+        ImageData16 stego(pixels, 48, 40, 3);
+
+        ASSERT_TRUE(handler->EmbedMethod(stego, data, "pw").IsSuccess());
+        for (std::size_t idx = 0; idx < pixels.size(); ++idx) {
+            ASSERT_EQ(stego.pixels[idx] & 0xFFF0, pixels[idx] & 0xFFF0);
+        }
+
+        auto extracted = handler->ExtractMethod(stego, "pw");
+        ASSERT_TRUE(extracted.IsSuccess());
+        EXPECT_EQ(extracted.GetValue(), data);
+    }
+}
+
+TEST(LSBHandler_16Bit, SingleBitCapacityMatchesEightBit) {
+    LSBStegoHandlerOrdered handler;
+    ImageData16 image(std::vector<uint16_t>(1000, 30000), 1000, 1, 1);
+
+    std::vector<uint8_t> fits(105, 0x11);
+    ASSERT_TRUE(handler.EmbedMethod(image, fits, "").IsSuccess());
+    auto extracted = handler.ExtractMethod(image, "");
+    ASSERT_TRUE(extracted.IsSuccess());
+    EXPECT_EQ(extracted.GetValue(), fits);
+
+    std::vector<uint8_t> tooLarge(106, 0x11);
+    EXPECT_EQ(handler.EmbedMethod(image, tooLarge, "").GetErrorCode(), ErrorCode::InsufficientCapacity);
+}
+
+TEST(LSBHandler_16Bit, MatchingRejectsSixteenBitImages) {
+    LSBStegoHandlerMatching handler;
+    ImageData16 image(std::vector<uint16_t>(1000, 30000), 1000, 1, 1);
+    std::vector<uint8_t> data{0x01};
+    EXPECT_EQ(handler.EmbedMethod(image, data, "").GetErrorCode(), ErrorCode::InvalidArgument);
+}
+
+// Adaptive Embedding Tests
+
+namespace {
+
+// Left half flat grey, right half noise
+ImageData MakeHalfTexturedImage(int width, int height, int channels) {
+    ImageData image = MakeNoiseImage(width, height, channels, 42);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width / 2; ++x) {
+            for (int c = 0; c < channels; ++c) {
+                image.pixels[(static_cast<std::size_t>(y) * width + x) * channels + c] = 128;
+            }
+        }
+    }
+    return image;
+}
+
+// Cost map straight from its definition: Sobel of the channel sums of (value >> 1), edges replicated
+std::vector<uint8_t> ReferenceCostMap(const ImageData &image) {
+    const int width = image.width;
+    const int height = image.height;
+    auto sum = [&](int x, int y) {
+        x = std::min(std::max(x, 0), width - 1);
+        y = std::min(std::max(y, 0), height - 1);
+        int total = 0;
+        for (int c = 0; c < image.channels; ++c) {
+            total += image.pixels[(static_cast<std::size_t>(y) * width + x) * image.channels + c] >> 1;
+        }
+        return total;
+    };
+
+    int shift = 2;
+    while ((1 << (shift - 2)) < image.channels) {
+        ++shift;
+    }
+
+    std::vector<uint8_t> costs(static_cast<std::size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int gx = (sum(x + 1, y - 1) + 2 * sum(x + 1, y) + sum(x + 1, y + 1)) -
+                     (sum(x - 1, y - 1) + 2 * sum(x - 1, y) + sum(x - 1, y + 1));
+            int gy = (sum(x - 1, y + 1) + 2 * sum(x, y + 1) + sum(x + 1, y + 1)) -
+                     (sum(x - 1, y - 1) + 2 * sum(x, y - 1) + sum(x + 1, y - 1));
+            costs[static_cast<std::size_t>(y) * width + x] = static_cast<uint8_t>(std::min((std::abs(gx) + std::abs(gy)) >> shift, 255));
+        }
+    }
+    return costs;
+}
+
+} // namespace
+
+class LSBHandler_AdaptiveKernels : public SimdLevelTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, LSBHandler_AdaptiveKernels, AllSimdLevels(), SimdLevelParamName);
+
+TEST_P(LSBHandler_AdaptiveKernels, CostMapMatchesTheDefinition) {
+    // Widths leave row tails after every vector step; five channels take the portable path
+    for (int channels = 1; channels <= 5; ++channels) {
+        for (int width : {1, 2, 7, 17, 33, 70}) {
+            ImageData image = MakeNoiseImage(width, 67, channels, static_cast<uint32_t>(width * 10 + channels));
+            EXPECT_EQ(LSBStegoHandlerAdaptive::ComputeCostMap(image), ReferenceCostMap(image))
+                << channels << " channels, width " << width;
+        }
+
+        // A black and white checkerboard of 2x2 squares gives the largest gradients
+        ImageData squares = MakeNoiseImage(40, 9, channels, 0);
+        for (std::size_t idx = 0; idx < squares.pixels.size(); ++idx) {
+            std::size_t pixel = idx / channels;
+            squares.pixels[idx] = ((pixel % 40) / 2 + (pixel / 40) / 2) % 2 ? 255 : 0;
+        }
+        EXPECT_EQ(LSBStegoHandlerAdaptive::ComputeCostMap(squares), ReferenceCostMap(squares)) << channels << " channels";
+    }
+}
+
+TEST_P(LSBHandler_AdaptiveKernels, CostMapIgnoresBitZero) {
+    ImageData image = MakeNoiseImage(150, 130, 3, 9);
+    ImageData flipped = image;
+    for (auto &value : flipped.pixels) {
+        value ^= 0x01;
+    }
+
+    auto costs = LSBStegoHandlerAdaptive::ComputeCostMap(image);
+    EXPECT_EQ(costs.size(), static_cast<std::size_t>(150 * 130));
+    EXPECT_EQ(costs, LSBStegoHandlerAdaptive::ComputeCostMap(flipped));
+}
+
+TEST_P(LSBHandler_AdaptiveKernels, CostMapIsZeroOnFlatImagesAndHighOnEdges) {
+    std::vector<uint8_t> pixels(100 * 100, 50);
+    for (int y = 0; y < 100; ++y) {
+        for (int x = 50; x < 100; ++x) {
+            pixels[y * 100 + x] = 200;
+        }
+    }
+    ImageData image(pixels, 100, 100, 1);
+
+    auto costs = LSBStegoHandlerAdaptive::ComputeCostMap(image);
+    EXPECT_EQ(costs[10 * 100 + 10], 0);
+    EXPECT_EQ(costs[10 * 100 + 90], 0);
+    EXPECT_GT(costs[10 * 100 + 49], 50);
+    EXPECT_GT(costs[10 * 100 + 50], 50);
+}
+
+TEST(LSBHandler_Adaptive, RoundTripsAcrossTileBoundaries) {
+    LSBStegoHandlerAdaptive handler;
+    // Heights that are not multiples of the tile size
+    for (int height : {1, 63, 65, 200}) {
+        ImageData image = MakeNoiseImage(97, height, 3, static_cast<uint32_t>(height));
+        std::vector<uint8_t> data(static_cast<std::size_t>(97 * height * 3 / 8 - PayloadHeader::SIZE_BYTES), 0x6B);
+
+        ASSERT_TRUE(handler.EmbedMethod(image, data, "").IsSuccess()) << "height " << height;
+        auto extracted = handler.ExtractMethod(image, "");
+        ASSERT_TRUE(extracted.IsSuccess()) << "height " << height;
+        EXPECT_EQ(extracted.GetValue(), data);
+    }
+}
+
+TEST(LSBHandler_Adaptive, SmallPayloadAvoidsFlatRegions) {
+    LSBStegoHandlerAdaptive handler;
+    ImageData original = MakeHalfTexturedImage(128, 128, 1);
+    ImageData stego = original;
+    std::vector<uint8_t> data(300, 0xFF);
+
+    ASSERT_TRUE(handler.EmbedMethod(stego, data, "").IsSuccess());
+    // The flat half (away from the boundary) must be untouched
+    for (int y = 0; y < 128; ++y) {
+        for (int x = 0; x < 60; ++x) {
+            ASSERT_EQ(stego.pixels[y * 128 + x], original.pixels[y * 128 + x]);
+        }
+    }
+
+    auto extracted = handler.ExtractMethod(stego, "");
+    ASSERT_TRUE(extracted.IsSuccess());
+    EXPECT_EQ(extracted.GetValue(), data);
+}
+
+TEST(LSBHandler_Adaptive, WorksWithEmbeddingMask) {
+    LSBStegoHandlerAdaptive handler;
+    auto mask = EmbeddingMask::Parse("gb", 0);
+    ASSERT_TRUE(mask.IsSuccess());
+    handler.SetEmbeddingMask(mask.GetValue());
+
+    ImageData original = MakeHalfTexturedImage(64, 64, 4);
+    ImageData stego = original;
+    std::vector<uint8_t> data(120, 0x3C);
+
+    ASSERT_TRUE(handler.EmbedMethod(stego, data, "").IsSuccess());
+    for (std::size_t idx = 0; idx < stego.pixels.size(); idx += 4) {
+        ASSERT_EQ(stego.pixels[idx], original.pixels[idx]);
+        ASSERT_EQ(stego.pixels[idx + 3], original.pixels[idx + 3]);
+    }
+
+    auto extracted = handler.ExtractMethod(stego, "");
+    ASSERT_TRUE(extracted.IsSuccess());
+    EXPECT_EQ(extracted.GetValue(), data);
+}
+
+TEST(LSBHandler_Adaptive, RejectsInvalidInput) {
+    LSBStegoHandlerAdaptive handler;
+    ImageData image = MakeNoiseImage(16, 16, 1, 2);
+
+    std::vector<uint8_t> empty;
+    EXPECT_EQ(handler.EmbedMethod(image, empty, "").GetErrorCode(), ErrorCode::InvalidArgument);
+
+    std::vector<uint8_t> tooLarge(64, 0x01);
+    EXPECT_EQ(handler.EmbedMethod(image, tooLarge, "").GetErrorCode(), ErrorCode::InsufficientCapacity);
+
+    ImageData mismatched(std::vector<uint8_t>(100, 0), 16, 16, 1);
+    std::vector<uint8_t> data{0x01};
+    EXPECT_EQ(handler.EmbedMethod(mismatched, data, "").GetErrorCode(), ErrorCode::InvalidImageDimensions);
+
+    // No magic: adaptive never wrote the legacy bare size, so this is no payload at all
+    ImageData blank(std::vector<uint8_t>(256, 0), 16, 16, 1);
+    EXPECT_EQ(handler.ExtractMethod(blank, "").GetErrorCode(), ErrorCode::CorruptedPayload);
+}
+
+// Shuffle Permutation Tests
+
+namespace {
+
+template <typename Index>
+bool IsPermutation(const std::vector<Index> &perm) {
+    std::vector<bool> seen(perm.size(), false);
+    for (Index value : perm) {
+        if (value >= perm.size() || seen[value]) {
+            return false;
+        }
+        seen[value] = true;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(LSBHandler_Shuffle, KeyedPermutationIsAPermutation) {
+    // Single bucket, and several buckets with a partial last chunk
+    for (std::size_t size : {std::size_t(1), std::size_t(1000), std::size_t(300007)}) {
+        auto perm = ShufflePermutation::BuildKeyed<uint32_t>(size, "pw");
+        ASSERT_TRUE(perm.IsSuccess());
+        ASSERT_EQ(perm.GetValue().size(), size);
+        EXPECT_TRUE(IsPermutation(perm.GetValue())) << size;
+    }
+    auto empty = ShufflePermutation::BuildKeyed<uint32_t>(0, "pw");
+    ASSERT_TRUE(empty.IsSuccess());
+    EXPECT_TRUE(empty.GetValue().empty());
+}
+
+TEST(LSBHandler_Shuffle, KeyedPermutationIsStableAndKeyed) {
+    auto first = ShufflePermutation::BuildKeyed<uint32_t>(200000, "pw");
+    auto second = ShufflePermutation::BuildKeyed<uint32_t>(200000, "pw");
+    auto other = ShufflePermutation::BuildKeyed<uint32_t>(200000, "pw2");
+    auto wide = ShufflePermutation::BuildKeyed<uint64_t>(200000, "pw");
+    ASSERT_TRUE(first.IsSuccess() && second.IsSuccess() && other.IsSuccess() && wide.IsSuccess());
+
+    EXPECT_EQ(first.GetValue(), second.GetValue());
+    EXPECT_NE(first.GetValue(), other.GetValue());
+    EXPECT_TRUE(std::equal(first.GetValue().begin(), first.GetValue().end(), wide.GetValue().begin()));
+
+    // Fixed output: stego files must extract on every platform and library
+    const std::vector<uint32_t> expected{73088, 4190, 160131, 118888, 75750, 106333, 6280, 165013};
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), first.GetValue().begin()));
+}
+
+TEST(LSBHandler_Shuffle, KeyedPermutationSpreadsPositions) {
+    // Where the first tenth of the stream lands should be close to uniform
+    const std::size_t size = 400000;
+    auto perm = ShufflePermutation::BuildKeyed<uint32_t>(size, "spread");
+    ASSERT_TRUE(perm.IsSuccess());
+
+    std::vector<std::size_t> deciles(10, 0);
+    for (std::size_t k = 0; k < size / 10; ++k) {
+        ++deciles[perm.GetValue()[k] * 10 / size];
+    }
+    for (std::size_t count : deciles) {
+        EXPECT_NEAR(static_cast<double>(count), size / 100.0, size / 1000.0);
+    }
+}
+
+TEST(LSBHandler_Shuffle, ExtractsLegacyPermutationPayloads) {
+    ImageData original = MakeNoiseImage(128, 128, 3, 21);
+    std::vector<uint8_t> data(500, 0xA5);
+
+    LSBStegoHandlerShuffle legacy;
+    legacy.SetShuffleMode(LSBStegoHandlerShuffle::ShuffleMode::Legacy);
+    ImageData legacyStego = original;
+    ASSERT_TRUE(legacy.EmbedMethod(legacyStego, data, "pw").IsSuccess());
+
+    LSBStegoHandlerShuffle keyed;
+    ImageData keyedStego = original;
+    ASSERT_TRUE(keyed.EmbedMethod(keyedStego, data, "pw").IsSuccess());
+    EXPECT_NE(legacyStego.pixels, keyedStego.pixels);
+
+    // The default handler reads both
+    for (const ImageData *stego : {&legacyStego, &keyedStego}) {
+        auto extracted = keyed.ExtractMethod(*stego, "pw");
+        ASSERT_TRUE(extracted.IsSuccess()) << extracted.GetErrorMessage();
+        EXPECT_EQ(extracted.GetValue(), data);
+    }
+    EXPECT_FALSE(keyed.ExtractMethod(keyedStego, "wrong").IsSuccess());
+}
+
+TEST(LSBHandler_Shuffle, PartitionedAccessMatchesDirectLoops) {
+    // One pass, and two passes with a partial last region
+    for (std::size_t size : {std::size_t(5000), (std::size_t(1) << 20) + 123}) {
+        auto perm = ShufflePermutation::BuildKeyed<uint32_t>(size, "partition");
+        ASSERT_TRUE(perm.IsSuccess());
+        auto samples = TestHelpers::GenerateRandomData(size);
+        auto bits = TestHelpers::GenerateRandomData(size / 8 - 3);
+
+        auto direct = samples;
+        for (std::size_t k = 0; k < bits.size() * 8; ++k) {
+            uint8_t &sample = direct[perm.GetValue()[k]];
+            sample = static_cast<uint8_t>((sample & 0xFE) | ((bits[k / 8] >> (k % 8)) & 1));
+        }
+        PartitionedAccess::Write(samples, bits, perm.GetValue().data());
+        ASSERT_EQ(samples, direct) << size;
+
+        auto read = PartitionedAccess::Read(samples, perm.GetValue().data(), 16, bits.size() - 2);
+        EXPECT_TRUE(std::equal(read.begin(), read.end(), bits.begin() + 2)) << size;
+    }
+}
+
+TEST(LSBHandler_Shuffle, AccessModesGiveIdenticalOutput) {
+    ImageData original = MakeNoiseImage(256, 256, 4, 5);
+    std::vector<uint8_t> data(20000, 0x3C);
+
+    LSBStegoHandlerShuffle direct;
+    direct.SetAccessMode(LSBStegoHandlerShuffle::AccessMode::Direct);
+    LSBStegoHandlerShuffle partitioned;
+    partitioned.SetAccessMode(LSBStegoHandlerShuffle::AccessMode::Partitioned);
+
+    ImageData directStego = original;
+    ImageData partitionedStego = original;
+    ASSERT_TRUE(direct.EmbedMethod(directStego, data, "pw").IsSuccess());
+    ASSERT_TRUE(partitioned.EmbedMethod(partitionedStego, data, "pw").IsSuccess());
+    EXPECT_EQ(directStego.pixels, partitionedStego.pixels);
+
+    auto extracted = partitioned.ExtractMethod(directStego, "pw");
+    ASSERT_TRUE(extracted.IsSuccess());
+    EXPECT_EQ(extracted.GetValue(), data);
+}
+
+TEST(LSBHandler_Shuffle, PermutationCacheReusesAndEvictsLeastRecentlyUsed) {
+    const std::size_t size = 1000;
+    PermutationCache cache(2 * size * sizeof(uint32_t));
+    int builds = 0;
+    auto get = [&](const std::string &digest) {
+        return cache.GetOrBuild<uint32_t>(digest, size, [&]() {
+            ++builds;
+            return ShufflePermutation::BuildKeyed<uint32_t>(size, digest);
+        });
+    };
+
+    auto first = get("a");
+    ASSERT_TRUE(first.IsSuccess());
+    ASSERT_TRUE(get("a").IsSuccess());
+    EXPECT_EQ(builds, 1);
+    EXPECT_EQ(get("a").GetValue().get(), first.GetValue().get());
+
+    // "a" is used more recently than "b" when "c" needs room
+    ASSERT_TRUE(get("b").IsSuccess());
+    ASSERT_TRUE(get("a").IsSuccess());
+    ASSERT_TRUE(get("c").IsSuccess());
+    EXPECT_EQ(builds, 3);
+    EXPECT_EQ(cache.GetEntryCount(), 2u);
+    EXPECT_EQ(cache.GetMemoryUsage(), 2 * size * sizeof(uint32_t));
+
+    ASSERT_TRUE(get("a").IsSuccess());
+    EXPECT_EQ(builds, 3);
+    ASSERT_TRUE(get("b").IsSuccess());
+    EXPECT_EQ(builds, 4);
+
+    // Evicted permutations stay valid for their holders
+    auto expected = ShufflePermutation::BuildKeyed<uint32_t>(size, "a");
+    EXPECT_TRUE(std::equal(expected.GetValue().begin(), expected.GetValue().end(), first.GetValue().get()));
+}
+
+TEST(LSBHandler_Shuffle, PermutationCachePersistsToDirectory) {
+    TestHelpers::CleanOutputDirectory();
+    const std::string directory = TestHelpers::GetOutputPath("perm-cache").string();
+    const std::size_t size = 5000;
+    int builds = 0;
+    auto build = [&]() {
+        ++builds;
+        return ShufflePermutation::BuildKeyed<uint32_t>(size, "pw");
+    };
+
+    PermutationCache cache(PermutationCache::DEFAULT_MAX_BYTES, directory);
+    auto digest = cache.Digest("pw", "keyed");
+    ASSERT_TRUE(digest.IsSuccess());
+    EXPECT_NE(digest.GetValue(), cache.Digest("pw", "legacy").GetValue());
+    ASSERT_TRUE(cache.GetOrBuild<uint32_t>(digest.GetValue(), size, build).IsSuccess());
+
+    // Names are salted per directory: a cache elsewhere names the same password differently
+    EXPECT_TRUE(std::filesystem::exists(std::filesystem::path(directory) / PermutationCache::SALT_FILE));
+    EXPECT_EQ(PermutationCache(PermutationCache::DEFAULT_MAX_BYTES, directory).Digest("pw", "keyed").GetValue(),
+              digest.GetValue());
+    EXPECT_NE(PermutationCache().Digest("pw", "keyed").GetValue(), digest.GetValue());
+
+    // A new cache, e.g. in the next process, maps the file instead of building
+    auto mapped = PermutationCache(PermutationCache::DEFAULT_MAX_BYTES, directory)
+                      .GetOrBuild<uint32_t>(digest.GetValue(), size, build);
+    ASSERT_TRUE(mapped.IsSuccess());
+    EXPECT_EQ(builds, 1);
+    auto expected = build();
+    EXPECT_TRUE(std::equal(expected.GetValue().begin(), expected.GetValue().end(), mapped.GetValue().get()));
+
+    // Damaged files are rebuilt
+    for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().filename() == PermutationCache::SALT_FILE) {
+            continue;
+        }
+        std::fstream file(entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(100);
+        file.put('\x5A');
+    }
+    builds = 0;
+    ASSERT_TRUE(PermutationCache(PermutationCache::DEFAULT_MAX_BYTES, directory)
+                    .GetOrBuild<uint32_t>(digest.GetValue(), size, build).IsSuccess());
+    EXPECT_EQ(builds, 1);
+    TestHelpers::CleanOutputDirectory();
+}
+
+TEST(LSBHandler_Shuffle, PermutationCachesRacingOnOneEntryPublishWholeFiles) {
+    TestHelpers::CleanOutputDirectory();
+    const std::string directory = TestHelpers::GetOutputPath("perm-cache").string();
+    const std::size_t size = 200000;
+    auto build = [&]() { return ShufflePermutation::BuildKeyed<uint32_t>(size, "pw"); };
+    auto digest = PermutationCache(PermutationCache::DEFAULT_MAX_BYTES, directory).Digest("pw", "keyed");
+    ASSERT_TRUE(digest.IsSuccess());
+
+    // Separate caches stand in for separate processes populating the same entry
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < 4; ++writer) {
+        writers.emplace_back([&]() {
+            PermutationCache(PermutationCache::DEFAULT_MAX_BYTES, directory).GetOrBuild<uint32_t>(digest.GetValue(), size, build);
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+
+    for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+        EXPECT_NE(entry.path().extension(), ".tmp") << entry.path();
+    }
+    int builds = 0;
+    auto mapped = PermutationCache(PermutationCache::DEFAULT_MAX_BYTES, directory)
+                      .GetOrBuild<uint32_t>(digest.GetValue(), size, [&]() { ++builds; return build(); });
+    ASSERT_TRUE(mapped.IsSuccess());
+    EXPECT_EQ(builds, 0);
+    auto expected = build();
+    EXPECT_TRUE(std::equal(expected.GetValue().begin(), expected.GetValue().end(), mapped.GetValue().get()));
+    TestHelpers::CleanOutputDirectory();
+}
+
+TEST(LSBHandler_Shuffle, HandlersShareAPermutationCache) {
+    auto cache = std::make_shared<PermutationCache>();
+    LSBStegoHandlerShuffle embedder;
+    LSBStegoHandlerShuffle extractor;
+    embedder.SetPermutationCache(cache);
+    extractor.SetPermutationCache(cache);
+    LSBStegoHandlerShuffle uncached;
+
+    std::vector<uint8_t> data(300, 0x6B);
+    for (uint32_t frame = 0; frame < 3; ++frame) {
+        ImageData stego = MakeNoiseImage(64, 64, 3, frame);
+        ImageData reference = stego;
+        ASSERT_TRUE(embedder.EmbedMethod(stego, data, "pw").IsSuccess());
+        ASSERT_TRUE(uncached.EmbedMethod(reference, data, "pw").IsSuccess());
+        EXPECT_EQ(stego.pixels, reference.pixels);
+
+        auto extracted = extractor.ExtractMethod(stego, "pw");
+        ASSERT_TRUE(extracted.IsSuccess());
+        EXPECT_EQ(extracted.GetValue(), data);
+    }
+    EXPECT_EQ(cache->GetEntryCount(), 1u);
+
+    // A wrong password also tries, and caches, the legacy permutation
+    EXPECT_FALSE(extractor.ExtractMethod(MakeNoiseImage(64, 64, 3, 0), "wrong").IsSuccess());
+    EXPECT_EQ(cache->GetEntryCount(), 3u);
+}
+
+// Tiled Shuffle Tests
+
+namespace {
+
+std::vector<std::size_t> TiledPositions(const TilePermutation &perm) {
+    std::vector<std::size_t> positions(perm.GetCapacity());
+    perm.ForEachBit(0, positions.size(), [&](std::size_t bit, std::size_t sample) { positions[bit] = sample; });
+    return positions;
+}
+
+} // namespace
+
+TEST(LSBHandler_Tiled, TilePermutationIsAPermutation) {
+    // Single tile group, whole tiles, and tiles with samples left over
+    for (std::size_t size : {std::size_t(1000), std::size_t(TilePermutation::TILE_SIZE * 16), std::size_t(300007)}) {
+        auto perm = TilePermutation::Create(size, "pw");
+        ASSERT_TRUE(perm.IsSuccess());
+        EXPECT_EQ(perm.GetValue().GetTileCount() % 8, 0u);
+        EXPECT_LE(perm.GetValue().GetTileSize(), TilePermutation::TILE_SIZE);
+        EXPECT_GT(perm.GetValue().GetCapacity(), size - perm.GetValue().GetTileCount());
+
+        auto positions = TiledPositions(perm.GetValue());
+        std::vector<bool> seen(size, false);
+        for (std::size_t bit = 0; bit < positions.size(); ++bit) {
+            ASSERT_LT(positions[bit], size);
+            ASSERT_FALSE(seen[positions[bit]]) << size;
+            seen[positions[bit]] = true;
+            ASSERT_EQ(perm.GetValue().Position(bit), positions[bit]);
+        }
+    }
+    EXPECT_EQ(TilePermutation::Create(7, "pw").GetErrorCode(), ErrorCode::ImageTooSmall);
+}
+
+TEST(LSBHandler_Tiled, TilePermutationIsStableAndKeyed) {
+    auto first = TilePermutation::Create(200000, "pw");
+    auto second = TilePermutation::Create(200000, "pw");
+    auto other = TilePermutation::Create(200000, "pw2");
+    ASSERT_TRUE(first.IsSuccess() && second.IsSuccess() && other.IsSuccess());
+
+    auto positions = TiledPositions(first.GetValue());
+    EXPECT_EQ(positions, TiledPositions(second.GetValue()));
+    EXPECT_NE(positions, TiledPositions(other.GetValue()));
+
+    // Fixed output: stego files must extract on every platform and library
+    const std::vector<std::size_t> expected{87869, 181791, 132945, 68027, 108188, 24561, 93685, 64869};
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), positions.begin()));
+}
+
+TEST(LSBHandler_Tiled, TilePermutationSpreadsPositions) {
+    // Consecutive bits change tile, and the first tenth of the stream covers the image evenly
+    const std::size_t size = 400000;
+    auto perm = TilePermutation::Create(size, "spread");
+    ASSERT_TRUE(perm.IsSuccess());
+    const std::size_t tileSize = perm.GetValue().GetTileSize();
+    auto positions = TiledPositions(perm.GetValue());
+
+    std::vector<std::size_t> deciles(10, 0);
+    for (std::size_t k = 0; k < size / 10; ++k) {
+        ++deciles[positions[k] * 10 / size];
+        if (k > 0) {
+            EXPECT_NE(positions[k] / tileSize, positions[k - 1] / tileSize);
+        }
+    }
+    for (std::size_t count : deciles) {
+        EXPECT_NEAR(static_cast<double>(count), size / 100.0, size / 1000.0);
+    }
+}
+
+TEST(LSBHandler_Tiled, RoundTripsUpToCapacity) {
+    ImageData original = MakeNoiseImage(160, 120, 3, 8);
+    auto perm = TilePermutation::Create(original.pixels.size(), "pw");
+    ASSERT_TRUE(perm.IsSuccess());
+    const std::size_t capacity = perm.GetValue().GetCapacity() / 8 - LSBStegoHandler::HEADER_SIZE_BYTES;
+
+    LSBStegoHandlerTiled handler;
+    for (std::size_t dataSize : {std::size_t(1), std::size_t(777), capacity}) {
+        auto data = TestHelpers::GenerateRandomData(dataSize);
+        ImageData stego = original;
+        ASSERT_TRUE(handler.EmbedMethod(stego, data, "pw").IsSuccess()) << dataSize;
+
+        auto extracted = handler.ExtractMethod(stego, "pw");
+        ASSERT_TRUE(extracted.IsSuccess()) << extracted.GetErrorMessage();
+        EXPECT_EQ(extracted.GetValue(), data);
+        EXPECT_FALSE(handler.ExtractMethod(stego, "wrong").IsSuccess());
+    }
+
+    ImageData stego = original;
+    auto result = handler.EmbedMethod(stego, std::vector<uint8_t>(capacity + 1, 1), "pw");
+    EXPECT_EQ(result.GetErrorCode(), ErrorCode::InsufficientCapacity);
+}
+
+TEST(LSBHandler_Tiled, DoesNotReadOtherMethodsPayloads) {
+    ImageData stego = MakeNoiseImage(128, 128, 3, 13);
+    std::vector<uint8_t> data(400, 0x5A);
+    LSBStegoHandlerShuffle shuffle;
+    ASSERT_TRUE(shuffle.EmbedMethod(stego, data, "pw").IsSuccess());
+
+    LSBStegoHandlerTiled tiled;
+    EXPECT_FALSE(tiled.ExtractMethod(stego, "pw").IsSuccess());
+    EXPECT_FALSE(tiled.ExtractMethod(MakeNoiseImage(128, 128, 3, 14), "pw").IsSuccess());
+}
+
+// Visual Position Map Tests
+
+namespace {
+
+ImageData MakeFlatImage(int width, int height, int channels, uint8_t value) {
+    return ImageData(std::vector<uint8_t>(static_cast<std::size_t>(width) * height * channels, value),
+                     width, height, channels);
+}
+
+// Samples embedding writes to, found without the map: all ones into zeros and all zeros into ones.
+// The header is the same in both runs, so each of its bits shows up in one of them.
+std::vector<uint8_t> EmbeddedSamples(LSBStegoHandler &handler, int width, int height, int channels,
+                                     std::size_t dataBytes, const std::string &password) {
+    ImageData zeros = MakeFlatImage(width, height, channels, 0x00);
+    ImageData ones = MakeFlatImage(width, height, channels, 0xFF);
+    EXPECT_TRUE(handler.EmbedMethod(zeros, std::vector<uint8_t>(dataBytes, 0xFF), password).IsSuccess());
+    EXPECT_TRUE(handler.EmbedMethod(ones, std::vector<uint8_t>(dataBytes, 0x00), password).IsSuccess());
+
+    std::vector<uint8_t> touched(zeros.pixels.size());
+    for (std::size_t idx = 0; idx < touched.size(); ++idx) {
+        touched[idx] = (zeros.pixels[idx] != 0x00 || ones.pixels[idx] != 0xFF) ? 0xFF : 0x00;
+    }
+    return touched;
+}
+
+std::size_t EncryptedSize(const std::vector<uint8_t> &data, const std::string &password) {
+    auto encrypted = CryptoModule::EncryptData(data, password);
+    EXPECT_TRUE(encrypted.IsSuccess());
+    return encrypted.GetValue().size();
+}
+
+} // namespace
+
+TEST(LSBHandler_Visual, PositionMapMatchesEmbedding) {
+    const auto data = TestHelpers::GenerateRandomData(300);
+    const auto coverPath = TestHelpers::GetOutputPath("visual_cover.png").string();
+    const auto dataPath = TestHelpers::CreateTempFile("visual_data.bin", data).string();
+    const auto mapPath = TestHelpers::GetOutputPath("visual_map.png").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, MakeNoiseImage(96, 80, 1, 21)).IsSuccess());
+    const std::size_t encryptedSize = EncryptedSize(data, "pw");
+
+    LSBStegoHandlerOrdered ordered;
+    LSBStegoHandlerMatching matching;
+    LSBStegoHandlerShuffle shuffle;
+    LSBStegoHandlerTiled tiled;
+    for (LSBStegoHandler *handler : std::initializer_list<LSBStegoHandler *>{&ordered, &matching, &shuffle, &tiled}) {
+        ASSERT_TRUE(handler->Visual(coverPath, dataPath, mapPath, "pw").IsSuccess());
+        auto map = ImageIO::Load(mapPath);
+        ASSERT_TRUE(map.IsSuccess());
+        EXPECT_EQ(map.GetValue().width, 96);
+        EXPECT_EQ(map.GetValue().height, 80);
+
+        std::size_t marked = 0;
+        for (uint8_t value : map.GetValue().pixels) {
+            marked += value != 0;
+        }
+        EXPECT_EQ(marked, (encryptedSize + LSBStegoHandler::HEADER_SIZE_BYTES) * 8);
+        EXPECT_EQ(map.GetValue().pixels, EmbeddedSamples(*handler, 96, 80, 1, encryptedSize, "pw"));
+    }
+}
+
+TEST(LSBHandler_Visual, PositionMapFollowsEmbeddingMask) {
+    const auto data = TestHelpers::GenerateRandomData(200);
+    const auto coverPath = TestHelpers::GetOutputPath("visual_cover_rgb.png").string();
+    const auto dataPath = TestHelpers::CreateTempFile("visual_data_mask.bin", data).string();
+    const auto mapPath = TestHelpers::GetOutputPath("visual_map_mask.png").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, MakeNoiseImage(64, 48, 3, 4)).IsSuccess());
+
+    LSBStegoHandlerShuffle handler;
+    handler.SetEmbeddingMask(EmbeddingMask::Parse("rb", 1, 2).GetValue());
+    ASSERT_TRUE(handler.Visual(coverPath, dataPath, mapPath, "pw").IsSuccess());
+    auto map = ImageIO::Load(mapPath);
+    ASSERT_TRUE(map.IsSuccess());
+
+    EXPECT_EQ(map.GetValue().pixels, EmbeddedSamples(handler, 64, 48, 3, EncryptedSize(data, "pw"), "pw"));
+}
+
+TEST(LSBHandler_Visual, DownscaleKeepsEveryMarkedBlock) {
+    const auto data = TestHelpers::GenerateRandomData(100);
+    const auto coverPath = TestHelpers::GetOutputPath("visual_cover_scale.png").string();
+    const auto dataPath = TestHelpers::CreateTempFile("visual_data_scale.bin", data).string();
+    const auto fullPath = TestHelpers::GetOutputPath("visual_map_full.png").string();
+    const auto smallPath = TestHelpers::GetOutputPath("visual_map_small.png").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, MakeNoiseImage(100, 70, 1, 9)).IsSuccess());
+
+    LSBStegoHandlerTiled handler;
+    ASSERT_TRUE(handler.Visual(coverPath, dataPath, fullPath, "pw").IsSuccess());
+    handler.SetVisualScale(8);
+    ASSERT_TRUE(handler.Visual(coverPath, dataPath, smallPath, "pw").IsSuccess());
+
+    auto full = ImageIO::Load(fullPath);
+    auto small = ImageIO::Load(smallPath);
+    ASSERT_TRUE(full.IsSuccess());
+    ASSERT_TRUE(small.IsSuccess());
+    ASSERT_EQ(small.GetValue().width, 13);
+    ASSERT_EQ(small.GetValue().height, 9);
+
+    std::vector<uint8_t> expected(13 * 9, 0);
+    for (int y = 0; y < 70; ++y) {
+        for (int x = 0; x < 100; ++x) {
+            expected[(y / 8) * 13 + x / 8] |= full.GetValue().pixels[y * 100 + x];
+        }
+    }
+    EXPECT_EQ(small.GetValue().pixels, expected);
+
+    // Methods without a position map are downscaled the same way
+    LSBStegoHandlerHamming hamming;
+    hamming.SetVisualScale(8);
+    ASSERT_TRUE(hamming.Visual(coverPath, dataPath, smallPath, "pw").IsSuccess());
+    small = ImageIO::Load(smallPath);
+    ASSERT_TRUE(small.IsSuccess());
+    EXPECT_EQ(small.GetValue().width, 13);
+    EXPECT_EQ(small.GetValue().height, 9);
+
+    // Scales beyond the image leave a single pixel
+    handler.SetVisualScale(std::numeric_limits<int>::max());
+    ASSERT_TRUE(handler.Visual(coverPath, dataPath, smallPath, "pw").IsSuccess());
+    small = ImageIO::Load(smallPath);
+    ASSERT_TRUE(small.IsSuccess());
+    EXPECT_EQ(small.GetValue().pixels, std::vector<uint8_t>{255});
+}
+
+TEST(LSBHandler_Visual, PositionMapChecksCapacityWithoutEncrypting) {
+    const auto coverPath = TestHelpers::GetOutputPath("visual_cover_tiny.png").string();
+    const auto dataPath = TestHelpers::CreateTempFile("visual_data_big.bin", TestHelpers::GenerateRandomData(2000)).string();
+    const auto mapPath = TestHelpers::GetOutputPath("visual_map_tiny.png").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, MakeNoiseImage(40, 40, 1, 2)).IsSuccess());
+
+    LSBStegoHandlerOrdered handler;
+    EXPECT_EQ(handler.Visual(coverPath, dataPath, mapPath, "pw").GetErrorCode(), ErrorCode::InsufficientCapacity);
+    EXPECT_EQ(handler.Visual(coverPath, TestHelpers::GetOutputPath("missing.bin").string(), mapPath, "pw").GetErrorCode(),
+              ErrorCode::FileNotFound);
+}
+
+TEST(LSBHandler_Visual, DiffAndHeatmapCompareCoverWithStego) {
+    const auto data = TestHelpers::GenerateRandomData(100);
+    const auto coverPath = TestHelpers::GetOutputPath("visual_cover_diff.png").string();
+    const auto dataPath = TestHelpers::CreateTempFile("visual_data_diff.bin", data).string();
+    const auto diffPath = TestHelpers::GetOutputPath("visual_diff.png").string();
+    const auto heatPath = TestHelpers::GetOutputPath("visual_heatmap.png").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, MakeNoiseImage(64, 48, 1, 17)).IsSuccess());
+    const std::size_t payloadBits = (EncryptedSize(data, "pw") + LSBStegoHandler::HEADER_SIZE_BYTES) * 8;
+
+    // lsb fills the first rows: changes stay within them, about half of the bits change
+    LSBStegoHandlerOrdered handler;
+    handler.SetVisualMode(LSBStegoHandler::VisualMode::Diff);
+    ASSERT_TRUE(handler.Visual(coverPath, dataPath, diffPath, "pw").IsSuccess());
+    auto diff = ImageIO::Load(diffPath);
+    ASSERT_TRUE(diff.IsSuccess());
+    ASSERT_EQ(diff.GetValue().pixels.size(), 64u * 48u);
+    std::size_t changed = 0;
+    for (std::size_t idx = 0; idx < diff.GetValue().pixels.size(); ++idx) {
+        if (diff.GetValue().pixels[idx] != 0) {
+            EXPECT_LT(idx, payloadBits);
+            ++changed;
+        }
+    }
+    EXPECT_GT(changed, payloadBits / 3);
+    EXPECT_LT(changed, payloadBits * 2 / 3);
+
+    // Rows 0-15 are full, 16-31 partly used, 32-47 untouched
+    handler.SetVisualMode(LSBStegoHandler::VisualMode::Heatmap);
+    handler.SetVisualScale(16);
+    ASSERT_TRUE(handler.Visual(coverPath, dataPath, heatPath, "pw").IsSuccess());
+    auto heatmap = ImageIO::Load(heatPath);
+    ASSERT_TRUE(heatmap.IsSuccess());
+    ASSERT_EQ(heatmap.GetValue().width, 4);
+    ASSERT_EQ(heatmap.GetValue().height, 3);
+    ASSERT_EQ(heatmap.GetValue().channels, 1);
+    ASSERT_LT(payloadBits, 32u * 64u);
+    for (int column = 0; column < 4; ++column) {
+        EXPECT_NEAR(heatmap.GetValue().pixels[column], 128, 32);
+        EXPECT_LT(heatmap.GetValue().pixels[4 + column], heatmap.GetValue().pixels[column]);
+        EXPECT_EQ(heatmap.GetValue().pixels[8 + column], 0);
+    }
+}
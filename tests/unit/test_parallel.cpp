@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "utils/Parallel.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ParallelTest, RunsEveryItemOnce) {
+    Parallel::ScopedThreadBudget budget(4);
+    std::vector<std::atomic<int>> calls(1000);
+    Parallel::For(calls.size(), [&](std::size_t idx) {
+        ++calls[idx];
+    });
+    for (const auto &count : calls) {
+        EXPECT_EQ(count, 1);
+    }
+}
+
+TEST(ParallelTest, ThreadBudgetIsPerThreadAndRestored) {
+    unsigned hardware = Parallel::GetThreadCount();
+    {
+        Parallel::ScopedThreadBudget outer(3);
+        EXPECT_EQ(Parallel::GetThreadCount(), 3u);
+        {
+            Parallel::ScopedThreadBudget inner(0);
+            EXPECT_EQ(Parallel::GetThreadCount(), 1u);
+        }
+        EXPECT_EQ(Parallel::GetThreadCount(), 3u);
+
+        unsigned other = 0;
+        std::thread([&] { other = Parallel::GetThreadCount(); }).join();
+        EXPECT_EQ(other, hardware);
+    }
+    EXPECT_EQ(Parallel::GetThreadCount(), hardware);
+}
+
+TEST(ParallelTest, NestedForRunsInlineInsideItems) {
+    Parallel::ScopedThreadBudget budget(4);
+    std::atomic<int> nestedOnOtherThreads{0};
+    std::atomic<int> nestedCalls{0};
+    Parallel::For(8, [&](std::size_t) {
+        EXPECT_EQ(Parallel::GetThreadCount(), 1u);
+        std::thread::id owner = std::this_thread::get_id();
+        Parallel::For(16, [&](std::size_t) {
+            ++nestedCalls;
+            if (std::this_thread::get_id() != owner) {
+                ++nestedOnOtherThreads;
+            }
+        });
+    });
+    EXPECT_EQ(nestedCalls, 8 * 16);
+    EXPECT_EQ(nestedOnOtherThreads, 0);
+    EXPECT_EQ(Parallel::GetThreadCount(), 4u);
+}
+
+TEST(ParallelTest, RethrowsWorkerExceptionsOnTheCaller) {
+    Parallel::ScopedThreadBudget budget(4);
+    std::atomic<int> calls{0};
+
+    EXPECT_THROW(Parallel::For(1000, [&](std::size_t idx) {
+        ++calls;
+        if (idx % 100 == 37) {
+            throw std::runtime_error("item failed");
+        }
+    }), std::runtime_error);
+
+    // Items not yet started when the first one threw were skipped
+    EXPECT_LT(calls, 1000);
+    EXPECT_EQ(Parallel::GetThreadCount(), 4u);
+}
@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include "algorithms/PayloadHeader.h"
+#include "algorithms/lsb/ordered/LSBStegoHandlerOrdered.h"
+#include "algorithms/lsb/hamming/LSBStegoHandlerHamming.h"
+#include "algorithms/lsb/matching/LSBStegoHandlerMatching.h"
+#include "utils/Checksum.h"
+#include "utils/ImageIO.h"
+#include "../test_helpers.h"
+
+#include <algorithm>
+#include <string>
+
+// CRC-32C Tests
+
+TEST(Checksum, Crc32cMatchesKnownVector) {
+    const std::string check = "123456789";
+    EXPECT_EQ(Checksum::Crc32c(reinterpret_cast<const uint8_t *>(check.data()), check.size()), 0xE3069283u);
+    EXPECT_EQ(Checksum::Crc32c(nullptr, 0), 0u);
+}
+
+TEST(Checksum, Crc32cMatchesRFC3720Vectors) {
+    std::vector<uint8_t> zeros(32, 0x00);
+    std::vector<uint8_t> ones(32, 0xFF);
+    std::vector<uint8_t> ascending(32);
+    for (std::size_t idx = 0; idx < ascending.size(); ++idx) {
+        ascending[idx] = static_cast<uint8_t>(idx);
+    }
+    EXPECT_EQ(Checksum::Crc32c(zeros.data(), zeros.size()), 0x8A9136AAu);
+    EXPECT_EQ(Checksum::Crc32c(ones.data(), ones.size()), 0x62A8AB43u);
+    EXPECT_EQ(Checksum::Crc32c(ascending.data(), ascending.size()), 0x46DD794Eu);
+
+    // Unaligned start and odd tail
+    EXPECT_EQ(Checksum::Crc32c(ascending.data() + 1, 29),
+              Checksum::Crc32c(ascending.data() + 8, 22, Checksum::Crc32c(ascending.data() + 1, 7)));
+}
+
+TEST(Checksum, Crc32cCanBeComputedIncrementally) {
+    auto data = TestHelpers::GenerateRandomData(1000);
+    uint32_t whole = Checksum::Crc32c(data.data(), data.size());
+    uint32_t split = Checksum::Crc32c(data.data() + 300, 700, Checksum::Crc32c(data.data(), 300));
+    EXPECT_EQ(whole, split);
+}
+
+// Header Encoding Tests
+
+TEST(PayloadHeader, RoundTripsThroughParse) {
+    auto bytes = PayloadHeader::Encode(PayloadMethod::DCT, 1234);
+    auto header = PayloadHeader::Parse(bytes.data(), bytes.size(), PayloadMethod::DCT);
+    ASSERT_TRUE(header.IsSuccess()) << header.GetErrorMessage();
+
+    EXPECT_EQ(header.GetValue().version, PayloadHeader::VERSION);
+    EXPECT_EQ(header.GetValue().method, PayloadMethod::DCT);
+    EXPECT_EQ(header.GetValue().kdf, PayloadHeader::KDF_PBKDF2_SHA256);
+    EXPECT_EQ(header.GetValue().dataSize, 1234u);
+    EXPECT_EQ(header.GetValue().GetSizeBits(), PayloadHeader::SIZE_BITS);
+}
+
+TEST(PayloadHeader, BuildPrefixesTheData) {
+    std::vector<uint8_t> data{1, 2, 3};
+    auto stream = PayloadHeader::Build(PayloadMethod::LSB, data);
+    ASSERT_EQ(stream.size(), PayloadHeader::SIZE_BYTES + data.size());
+
+    auto header = PayloadHeader::Encode(PayloadMethod::LSB, 3);
+    EXPECT_TRUE(std::equal(header.begin(), header.end(), stream.begin()));
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), stream.begin() + PayloadHeader::SIZE_BYTES));
+}
+
+TEST(PayloadHeader, FallsBackToLegacySizePrefix) {
+    std::vector<uint8_t> bytes{0x2A, 0x00, 0x00, 0x00};
+    auto header = PayloadHeader::Parse(bytes.data(), bytes.size(), PayloadMethod::LSBShuffle, true);
+    ASSERT_TRUE(header.IsSuccess());
+    EXPECT_EQ(header.GetValue().version, 0);
+    EXPECT_EQ(header.GetValue().dataSize, 42u);
+    EXPECT_EQ(header.GetValue().GetSizeBytes(), PayloadHeader::LEGACY_SIZE_BYTES);
+}
+
+TEST(PayloadHeader, RequiresMagicUnlessLegacyIsAccepted) {
+    std::vector<uint8_t> bytes(PayloadHeader::SIZE_BYTES, 0);
+    bytes[0] = 0x2A;
+    EXPECT_EQ(PayloadHeader::Parse(bytes.data(), bytes.size(), PayloadMethod::DCT).GetErrorCode(),
+              ErrorCode::CorruptedPayload);
+    EXPECT_EQ(PayloadHeader::Parse(bytes.data(), 4, PayloadMethod::DCT).GetErrorCode(), ErrorCode::ImageTooSmall);
+    EXPECT_TRUE(PayloadHeader::Parse(bytes.data(), 4, PayloadMethod::LSB, true).IsSuccess());
+}
+
+TEST(PayloadHeader, RejectsCorruptedHeader) {
+    auto bytes = PayloadHeader::Encode(PayloadMethod::LSB, 10);
+    bytes[12] ^= 0x01; // size field
+    auto header = PayloadHeader::Parse(bytes.data(), bytes.size(), PayloadMethod::LSB);
+    EXPECT_EQ(header.GetErrorCode(), ErrorCode::CorruptedPayload);
+}
+
+TEST(PayloadHeader, VotesOverTheCopiesOfAnErrorCorrectedHeader) {
+    std::vector<uint8_t> data(40, 0xA5);
+    std::vector<uint8_t> stream = PayloadHeader::Build(
+        PayloadMethod::LSB, PayloadHeader::AddCopies(PayloadMethod::LSB, data, PayloadHeader::FLAG_ERROR_CORRECTION),
+        PayloadHeader::FLAG_ERROR_CORRECTION);
+    ASSERT_EQ(stream.size(), PayloadHeader::PROTECTED_SIZE_BYTES + data.size());
+    EXPECT_TRUE(std::equal(stream.begin(), stream.begin() + 20, stream.begin() + 20));
+    EXPECT_TRUE(std::equal(stream.begin(), stream.begin() + 20, stream.begin() + 40));
+
+    // Different bits of each copy damaged: the majority is still the header
+    stream[0] ^= 0x01;
+    stream[12] ^= 0x80;
+    stream[20 + 12] ^= 0x01;
+    stream[40 + 18] ^= 0x10;
+    auto header = PayloadHeader::Parse(stream.data(), stream.size(), PayloadMethod::LSB, true);
+    ASSERT_TRUE(header.IsSuccess()) << header.GetErrorMessage();
+    EXPECT_EQ(header.GetValue().dataSize, PayloadHeader::COPIES_SIZE_BYTES + data.size());
+    EXPECT_EQ(header.GetValue().GetSizeBytes(), PayloadHeader::SIZE_BYTES);
+
+    // Only the first copy was seen, or the same bit is wrong in two copies
+    EXPECT_EQ(PayloadHeader::Parse(stream.data(), 20, PayloadMethod::LSB).GetErrorCode(), ErrorCode::CorruptedPayload);
+    stream[20 + 12] ^= 0x81;
+    EXPECT_EQ(PayloadHeader::Parse(stream.data(), stream.size(), PayloadMethod::LSB).GetErrorCode(),
+              ErrorCode::CorruptedPayload);
+
+    // Copies of a header without error correction are never trusted
+    auto plain = PayloadHeader::Encode(PayloadMethod::LSB, 10);
+    std::vector<uint8_t> repeated;
+    for (int copy = 0; copy < 3; ++copy) {
+        repeated.insert(repeated.end(), plain.begin(), plain.end());
+    }
+    repeated[12] ^= 0x01;
+    EXPECT_EQ(PayloadHeader::Parse(repeated.data(), repeated.size(), PayloadMethod::LSB).GetErrorCode(),
+              ErrorCode::CorruptedPayload);
+}
+
+TEST(PayloadHeader, RejectsTruncatedHeader) {
+    auto bytes = PayloadHeader::Encode(PayloadMethod::LSB, 10);
+    EXPECT_EQ(PayloadHeader::Parse(bytes.data(), 3, PayloadMethod::LSB).GetErrorCode(), ErrorCode::ImageTooSmall);
+    EXPECT_EQ(PayloadHeader::Parse(bytes.data(), 19, PayloadMethod::LSB).GetErrorCode(), ErrorCode::ImageTooSmall);
+}
+
+TEST(PayloadHeader, CarriesKnownFlagsOnly) {
+    auto bytes = PayloadHeader::Encode(PayloadMethod::LSB, 10, PayloadHeader::FLAG_KEY_CHECK);
+    auto header = PayloadHeader::Parse(bytes.data(), bytes.size(), PayloadMethod::LSB);
+    ASSERT_TRUE(header.IsSuccess());
+    EXPECT_EQ(header.GetValue().flags, PayloadHeader::FLAG_KEY_CHECK);
+
+    bytes = PayloadHeader::Encode(PayloadMethod::LSB, 10, 0x80);
+    EXPECT_EQ(PayloadHeader::Parse(bytes.data(), bytes.size(), PayloadMethod::LSB).GetErrorCode(),
+              ErrorCode::CorruptedPayload);
+}
+
+TEST(PayloadHeader, RejectsOtherMethods) {
+    auto bytes = PayloadHeader::Encode(PayloadMethod::LSBHamming, 10);
+    auto header = PayloadHeader::Parse(bytes.data(), bytes.size(), PayloadMethod::LSBShuffle);
+    EXPECT_EQ(header.GetErrorCode(), ErrorCode::MethodMismatch);
+    EXPECT_NE(header.GetErrorMessage().find("hamming"), std::string::npos);
+
+    // Ordered LSB and LSB matching share a layout
+    bytes = PayloadHeader::Encode(PayloadMethod::LSBMatching, 10);
+    EXPECT_TRUE(PayloadHeader::Parse(bytes.data(), bytes.size(), PayloadMethod::LSB).IsSuccess());
+}
+
+// Handler Integration Tests
+
+TEST(PayloadHeader, HandlersRejectPayloadsOfOtherMethods) {
+    auto pixels = TestHelpers::GenerateRandomData(4000);
+    ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+    std::vector<uint8_t> data(64, 0x5A);
+
+    // Hamming keeps its header in plain LSBs, where ordered LSB finds it
+    LSBStegoHandlerHamming hamming;
+    ASSERT_TRUE(hamming.EmbedMethod(imgData, data, "").IsSuccess());
+
+    LSBStegoHandlerOrdered ordered;
+    EXPECT_EQ(ordered.ExtractMethod(imgData, "").GetErrorCode(), ErrorCode::MethodMismatch);
+
+    // Ordered LSB payloads are readable by LSB matching
+    ASSERT_TRUE(ordered.EmbedMethod(imgData, data, "").IsSuccess());
+    LSBStegoHandlerMatching matching;
+    auto extracted = matching.ExtractMethod(imgData, "");
+    ASSERT_TRUE(extracted.IsSuccess());
+    EXPECT_EQ(extracted.GetValue(), data);
+}
+
+TEST(PayloadHeader, ExtractsLegacyPayloads) {
+    // Pre-header layout: bare 32-bit size, then data, bit k in pixel k
+    std::vector<uint8_t> data{0xDE, 0xAD, 0xBE, 0xEF, 0x01};
+    std::vector<uint8_t> stream{static_cast<uint8_t>(data.size()), 0, 0, 0};
+    stream.insert(stream.end(), data.begin(), data.end());
+
+    auto pixels = TestHelpers::GenerateRandomData(1000);
+    for (std::size_t bit = 0; bit < stream.size() * 8; ++bit) {
+        pixels[bit] = static_cast<uint8_t>((pixels[bit] & 0xFE) | ((stream[bit / 8] >> (bit % 8)) & 1));
+    }
+    ImageData imgData(pixels, static_cast<int>(pixels.size()), 1, 1);
+
+    LSBStegoHandlerOrdered handler;
+    auto extracted = handler.ExtractMethod(imgData, "");
+    ASSERT_TRUE(extracted.IsSuccess()) << extracted.GetErrorMessage();
+    EXPECT_EQ(extracted.GetValue(), data);
+
+    // Methods added after the header never wrote a bare size
+    LSBStegoHandlerMatching matching;
+    EXPECT_EQ(matching.ExtractMethod(imgData, "").GetErrorCode(), ErrorCode::CorruptedPayload);
+    LSBStegoHandlerHamming hamming;
+    EXPECT_EQ(hamming.ExtractMethod(imgData, "").GetErrorCode(), ErrorCode::CorruptedPayload);
+}
+
+TEST(PayloadHeader, KeyCheckRejectsWrongPasswordBeforeDecryption) {
+    TestHelpers::CleanOutputDirectory();
+    auto coverPath = TestHelpers::GetOutputPath("cover.png").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, TestHelpers::GenerateRandomData(64 * 64 * 3), 64, 64, 3).IsSuccess());
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+
+    LSBStegoHandlerOrdered embedder;
+    embedder.SetKeyCheck(true);
+    ASSERT_TRUE(embedder.Embed(coverPath, dataPath, stegoPath, "pw").IsSuccess());
+
+    // Extraction needs no setting, the header flag says a check is present
+    LSBStegoHandlerOrdered extractor;
+    ASSERT_TRUE(extractor.Extract(stegoPath, recovered, "pw").IsSuccess());
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, recovered));
+
+    auto wrong = extractor.Extract(stegoPath, recovered, "not the password");
+    EXPECT_EQ(wrong.GetErrorCode(), ErrorCode::AuthenticationFailed);
+    EXPECT_NE(wrong.GetErrorMessage().find("Key check"), std::string::npos);
+    TestHelpers::CleanOutputDirectory();
+}
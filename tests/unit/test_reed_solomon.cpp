@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include "utils/ReedSolomon.h"
+#include "algorithms/lsb/ordered/LSBStegoHandlerOrdered.h"
+#include "algorithms/lsb/hamming/LSBStegoHandlerHamming.h"
+#include "algorithms/lsb/adaptive/LSBStegoHandlerAdaptive.h"
+#include "algorithms/lsb/shuffle/LSBStegoHandlerShuffle.h"
+#include "algorithms/lsb/tiled/LSBStegoHandlerTiled.h"
+#include "utils/ImageIO.h"
+#include "../test_helpers.h"
+
+#include <random>
+#include <set>
+
+namespace {
+
+// Damage 'count' distinct bytes of codeword 'codeword' (prefix excluded)
+void DamageCodeword(std::vector<uint8_t> &block, std::size_t dataSize, int parity,
+                    std::size_t codeword, std::size_t count, std::mt19937 &rng) {
+    std::size_t rowSize = (dataSize + (255 - parity) - 1) / (255 - parity);
+    std::size_t rows = (block.size() - ReedSolomon::PREFIX_SIZE) / rowSize;
+    std::set<std::size_t> picked;
+    while (picked.size() < count) {
+        picked.insert(rng() % rows);
+    }
+    for (std::size_t row : picked) {
+        block[ReedSolomon::PREFIX_SIZE + row * rowSize + codeword] ^= static_cast<uint8_t>(1 + rng() % 255);
+    }
+}
+
+} // namespace
+
+// Codec Tests
+
+TEST(ReedSolomon, RoundTripsWithoutDamage) {
+    for (std::size_t size : {0u, 1u, 222u, 223u, 224u, 5000u, 100000u}) {
+        auto data = TestHelpers::GenerateRandomData(size);
+        auto block = ReedSolomon::Encode(data, ReedSolomon::DEFAULT_PARITY);
+        ASSERT_TRUE(block.IsSuccess());
+        EXPECT_EQ(block.GetValue().size(), ReedSolomon::GetEncodedSize(size, ReedSolomon::DEFAULT_PARITY));
+
+        std::size_t corrected = 99;
+        auto decoded = ReedSolomon::Decode(block.GetValue(), size, &corrected);
+        ASSERT_TRUE(decoded.IsSuccess()) << decoded.GetErrorMessage();
+        EXPECT_EQ(decoded.GetValue(), data);
+        EXPECT_EQ(corrected, 0u);
+    }
+}
+
+TEST(ReedSolomon, CorrectsUpToHalfTheParityPerCodeword) {
+    std::mt19937 rng(7);
+    for (int parity : {2, 8, 32, 128}) {
+        auto data = TestHelpers::GenerateRandomData(3000);
+        auto block = ReedSolomon::Encode(data, parity).GetValue();
+        std::size_t codewords = (data.size() + (255 - parity) - 1) / (255 - parity);
+
+        for (std::size_t codeword = 0; codeword < codewords; ++codeword) {
+            DamageCodeword(block, data.size(), parity, codeword, static_cast<std::size_t>(parity / 2), rng);
+        }
+
+        std::size_t corrected = 0;
+        auto decoded = ReedSolomon::Decode(block, data.size(), &corrected);
+        ASSERT_TRUE(decoded.IsSuccess()) << "parity " << parity << ": " << decoded.GetErrorMessage();
+        EXPECT_EQ(decoded.GetValue(), data);
+        EXPECT_EQ(corrected, codewords * static_cast<std::size_t>(parity / 2));
+    }
+}
+
+TEST(ReedSolomon, SpreadsBurstsAcrossCodewords) {
+    auto data = TestHelpers::GenerateRandomData(50000);
+    auto block = ReedSolomon::Encode(data, 16).GetValue();
+
+    // 224 codewords x 8 correctable bytes: a 1500-byte run is about 7 per codeword
+    for (std::size_t idx = 1000; idx < 2500; ++idx) {
+        block[idx] = static_cast<uint8_t>(~block[idx]);
+    }
+    auto decoded = ReedSolomon::Decode(block, data.size());
+    ASSERT_TRUE(decoded.IsSuccess()) << decoded.GetErrorMessage();
+    EXPECT_EQ(decoded.GetValue(), data);
+}
+
+TEST(ReedSolomon, SurvivesDamagedParameters) {
+    auto data = TestHelpers::GenerateRandomData(1000);
+    auto block = ReedSolomon::Encode(data, 32).GetValue();
+    block[0] ^= 0x10;   // first copy of the parity count
+    block[6] ^= 0x01;   // second copy of the size
+    auto decoded = ReedSolomon::Decode(block, data.size());
+    ASSERT_TRUE(decoded.IsSuccess()) << decoded.GetErrorMessage();
+    EXPECT_EQ(decoded.GetValue(), data);
+}
+
+TEST(ReedSolomon, ReportsUncorrectableDamage) {
+    std::mt19937 rng(11);
+    auto data = TestHelpers::GenerateRandomData(1000);
+    auto block = ReedSolomon::Encode(data, 8).GetValue();
+    DamageCodeword(block, data.size(), 8, 2, 40, rng);
+
+    auto decoded = ReedSolomon::Decode(block, data.size());
+    EXPECT_EQ(decoded.GetErrorCode(), ErrorCode::CorruptedPayload);
+}
+
+TEST(ReedSolomon, RejectsInvalidParameters) {
+    EXPECT_FALSE(ReedSolomon::IsValidParity(0));
+    EXPECT_FALSE(ReedSolomon::IsValidParity(7));
+    EXPECT_FALSE(ReedSolomon::IsValidParity(130));
+    EXPECT_EQ(ReedSolomon::Encode({1, 2, 3}, 3).GetErrorCode(), ErrorCode::InvalidArgument);
+    EXPECT_EQ(ReedSolomon::GetEncodedSize(100, 255), 0u);
+    EXPECT_EQ(ReedSolomon::GetEncodedSize(100, -4), 0u);
+
+    auto block = ReedSolomon::Encode({1, 2, 3}, 4).GetValue();
+    EXPECT_EQ(ReedSolomon::Decode({1, 2}, 100).GetErrorCode(), ErrorCode::InvalidDataSize);
+    EXPECT_EQ(ReedSolomon::Decode(block, 2).GetErrorCode(), ErrorCode::CorruptedPayload);
+    block.pop_back();
+    EXPECT_EQ(ReedSolomon::Decode(block, 100).GetErrorCode(), ErrorCode::CorruptedPayload);
+}
+
+// Handler Integration Tests
+
+TEST(ReedSolomon, HandlerRejectsInvalidParity) {
+    LSBStegoHandlerOrdered handler;
+    for (int parity : {255, 256, -4, 3, 130}) {
+        EXPECT_EQ(handler.SetErrorCorrection(parity).GetErrorCode(), ErrorCode::InvalidArgument) << parity;
+        EXPECT_EQ(handler.GetErrorCorrection(), 0);
+    }
+    EXPECT_TRUE(handler.SetErrorCorrection(32).IsSuccess());
+    EXPECT_EQ(handler.GetErrorCorrection(), 32);
+    EXPECT_TRUE(handler.SetErrorCorrection(0).IsSuccess());
+    EXPECT_EQ(handler.GetErrorCorrection(), 0);
+}
+
+TEST(ReedSolomon, HandlerRecoversFromFlippedLSBs) {
+    TestHelpers::CleanOutputDirectory();
+    auto coverPath = TestHelpers::GetOutputPath("cover.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, TestHelpers::GenerateRandomData(64 * 64 * 3), 64, 64, 3).IsSuccess());
+
+    LSBStegoHandlerOrdered embedder;
+    embedder.SetErrorCorrection(32);
+    ASSERT_TRUE(embedder.Embed(coverPath, dataPath, stegoPath, "pw").IsSuccess());
+
+    // Flip a few LSBs past the payload header
+    auto stego = ImageIO::Load(stegoPath).GetValue();
+    for (std::size_t pixel : {200u, 333u, 700u, 1100u, 1500u}) {
+        stego.pixels[pixel] ^= 1;
+    }
+    ASSERT_TRUE(ImageIO::Save(stegoPath, stego).IsSuccess());
+
+    LSBStegoHandlerOrdered extractor;
+    auto extractResult = extractor.Extract(stegoPath, recovered, "pw");
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, recovered));
+    TestHelpers::CleanOutputDirectory();
+}
+
+TEST(ReedSolomon, HandlerRecoversFromFlippedHeaderBits) {
+    TestHelpers::CleanOutputDirectory();
+    auto coverPath = TestHelpers::GetOutputPath("cover.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, TestHelpers::GenerateRandomData(64 * 64 * 3), 64, 64, 3).IsSuccess());
+
+    LSBStegoHandlerOrdered ordered;
+    LSBStegoHandlerHamming hamming;
+    for (StegoHandler *handler : {static_cast<StegoHandler *>(&ordered), static_cast<StegoHandler *>(&hamming)}) {
+        handler->SetErrorCorrection(0);
+        ASSERT_TRUE(handler->Embed(coverPath, dataPath, stegoPath, "pw").IsSuccess());
+
+        // Magic and size bits of the only header copy: nothing to vote with
+        auto stego = ImageIO::Load(stegoPath).GetValue();
+        stego.pixels[3] ^= 1;
+        stego.pixels[100] ^= 1;
+        ASSERT_TRUE(ImageIO::Save(stegoPath, stego).IsSuccess());
+        EXPECT_FALSE(handler->Extract(stegoPath, recovered, "pw").IsSuccess());
+
+        handler->SetErrorCorrection(32);
+        ASSERT_TRUE(handler->Embed(coverPath, dataPath, stegoPath, "pw").IsSuccess());
+        stego = ImageIO::Load(stegoPath).GetValue();
+        stego.pixels[3] ^= 1;
+        stego.pixels[100] ^= 1;
+        stego.pixels[120] ^= 1;
+        ASSERT_TRUE(ImageIO::Save(stegoPath, stego).IsSuccess());
+
+        auto extractResult = handler->Extract(stegoPath, recovered, "pw");
+        ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+        EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, recovered));
+    }
+    TestHelpers::CleanOutputDirectory();
+}
+
+TEST(ReedSolomon, HandlersPlaceHeaderCopiesConsistently) {
+    TestHelpers::CleanOutputDirectory();
+    auto coverPath = TestHelpers::GetOutputPath("cover.png").string();
+    auto dataPath = TestHelpers::GetFixturePath("small.txt").string();
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.txt").string();
+    ASSERT_TRUE(ImageIO::Save(coverPath, TestHelpers::GenerateRandomData(64 * 64 * 3), 64, 64, 3).IsSuccess());
+
+    // Each keeps the header outside the data its own way
+    LSBStegoHandlerAdaptive adaptive;
+    LSBStegoHandlerShuffle shuffle;
+    LSBStegoHandlerTiled tiled;
+    for (StegoHandler *handler : {static_cast<StegoHandler *>(&adaptive), static_cast<StegoHandler *>(&shuffle),
+                                  static_cast<StegoHandler *>(&tiled)}) {
+        handler->SetErrorCorrection(16);
+        ASSERT_TRUE(handler->Embed(coverPath, dataPath, stegoPath, "pw").IsSuccess());
+        auto extractResult = handler->Extract(stegoPath, recovered, "pw");
+        ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+        EXPECT_TRUE(TestHelpers::FilesAreIdentical(dataPath, recovered));
+    }
+    TestHelpers::CleanOutputDirectory();
+}
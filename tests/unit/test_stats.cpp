@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "utils/Stats.h"
+#include "utils/Compression.h"
+#include "utils/CryptoModule.h"
+#include "../test_helpers.h"
+
+// Stats are process wide: every test starts from zero and leaves them disabled
+class StatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Stats::Reset();
+    }
+
+    void TearDown() override {
+        Stats::SetEnabled(false);
+        Stats::Reset();
+    }
+};
+
+TEST_F(StatsTest, RecordsNothingWhileDisabled) {
+    {
+        StageTimer timer(Stats::Stage::Cipher, 100);
+    }
+    Stats::Add(Stats::Counter::SamplesTouched, 5);
+
+    EXPECT_EQ(Stats::GetStage(Stats::Stage::Cipher).calls, 0u);
+    EXPECT_EQ(Stats::GetCounter(Stats::Counter::SamplesTouched), 0u);
+}
+
+TEST_F(StatsTest, AccumulatesCallsBytesAndCounters) {
+    Stats::SetEnabled(true);
+    for (int idx = 0; idx < 3; ++idx) {
+        StageTimer timer(Stats::Stage::Embed, 10);
+        timer.AddBytes(5);
+    }
+    Stats::Add(Stats::Counter::SamplesTouched, 7);
+    Stats::Add(Stats::Counter::SamplesTouched, 8);
+
+    auto totals = Stats::GetStage(Stats::Stage::Embed);
+    EXPECT_EQ(totals.calls, 3u);
+    EXPECT_EQ(totals.bytes, 45u);
+    EXPECT_EQ(Stats::GetCounter(Stats::Counter::SamplesTouched), 15u);
+
+    Stats::Reset();
+    EXPECT_EQ(Stats::GetStage(Stats::Stage::Embed).calls, 0u);
+    EXPECT_EQ(Stats::GetCounter(Stats::Counter::SamplesTouched), 0u);
+}
+
+TEST_F(StatsTest, StopRecordsOnce) {
+    Stats::SetEnabled(true);
+    {
+        StageTimer timer(Stats::Stage::Mac, 1);
+        timer.Stop();
+        timer.Stop();
+    }
+    EXPECT_EQ(Stats::GetStage(Stats::Stage::Mac).calls, 1u);
+}
+
+TEST_F(StatsTest, InstrumentsCryptoAndCompression) {
+    Stats::SetEnabled(true);
+    auto data = TestHelpers::GenerateRandomData(1000);
+    auto compressed = Compression::Compress(data);
+    auto encrypted = CryptoModule::EncryptData(compressed, "pw");
+    ASSERT_TRUE(encrypted.IsSuccess());
+    ASSERT_TRUE(CryptoModule::DecryptData(encrypted.GetValue(), "pw").IsSuccess());
+
+    EXPECT_EQ(Stats::GetStage(Stats::Stage::Compress).bytes, 1000u);
+    EXPECT_EQ(Stats::GetStage(Stats::Stage::KeyDerivation).calls, 2u);
+    EXPECT_EQ(Stats::GetStage(Stats::Stage::Cipher).calls, 2u);
+    EXPECT_EQ(Stats::GetStage(Stats::Stage::Mac).calls, 2u);
+}
+
+TEST_F(StatsTest, JsonListsEveryStageAndCounter) {
+    Stats::SetEnabled(true);
+    {
+        StageTimer timer(Stats::Stage::ImageDecode, 64);
+    }
+    std::string json = Stats::FormatJson();
+
+    for (std::size_t idx = 0; idx < static_cast<std::size_t>(Stats::Stage::Count); ++idx) {
+        EXPECT_NE(json.find(std::string("\"") + Stats::GetName(static_cast<Stats::Stage>(idx)) + "\""), std::string::npos);
+    }
+    for (std::size_t idx = 0; idx < static_cast<std::size_t>(Stats::Counter::Count); ++idx) {
+        EXPECT_NE(json.find(std::string("\"") + Stats::GetName(static_cast<Stats::Counter>(idx)) + "\""), std::string::npos);
+    }
+    EXPECT_NE(json.find("\"imageDecode\": {\"calls\": 1,"), std::string::npos);
+    EXPECT_NE(json.find("\"peakRssBytes\""), std::string::npos);
+
+    // The table only lists stages that ran
+    std::string table = Stats::FormatTable();
+    EXPECT_NE(table.find("imageDecode"), std::string::npos);
+    EXPECT_EQ(table.find("imageEncode"), std::string::npos);
+}
@@ -0,0 +1,296 @@
+#include <gtest/gtest.h>
+#include "analysis/Steganalysis.h"
+#include "utils/ImageIO.h"
+#include "../test_helpers.h"
+#include "../simd_level_test.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+int SmoothnessNaively(const std::array<int, 4> &v) {
+    return std::abs(v[1] - v[0]) + std::abs(v[2] - v[1]) + std::abs(v[3] - v[2]);
+}
+
+// RS counts straight from the definition, one group at a time
+RSCounts CountRSGroupsNaively(const uint8_t *samples, std::size_t groups) {
+    auto flip = [](int v) { return v ^ 1; };
+    auto shiftedFlip = [](int v) { return (v & 1) ? v + 1 : v - 1; };
+    RSCounts counts;
+    for (std::size_t group = 0; group < groups; ++group) {
+        std::array<int, 4> v{samples[group * 4], samples[group * 4 + 1], samples[group * 4 + 2], samples[group * 4 + 3]};
+        std::array<int, 4> w{flip(v[0]), flip(v[1]), flip(v[2]), flip(v[3])};
+        int f = SmoothnessNaively(v);
+        int fM = SmoothnessNaively({v[0], flip(v[1]), flip(v[2]), v[3]});
+        int fNegM = SmoothnessNaively({v[0], shiftedFlip(v[1]), shiftedFlip(v[2]), v[3]});
+        int g = SmoothnessNaively(w);
+        int gM = SmoothnessNaively({w[0], flip(w[1]), flip(w[2]), w[3]});
+        int gNegM = SmoothnessNaively({w[0], shiftedFlip(w[1]), shiftedFlip(w[2]), w[3]});
+        ++counts.groups;
+        counts.regularM += fM > f;
+        counts.singularM += fM < f;
+        counts.regularNegM += fNegM > f;
+        counts.singularNegM += fNegM < f;
+        counts.flippedRegularM += gM > g;
+        counts.flippedSingularM += gM < g;
+        counts.flippedRegularNegM += gNegM > g;
+        counts.flippedSingularNegM += gNegM < g;
+    }
+    return counts;
+}
+
+void ExpectSameCounts(const RSCounts &actual, const RSCounts &expected) {
+    EXPECT_EQ(actual.groups, expected.groups);
+    EXPECT_EQ(actual.regularM, expected.regularM);
+    EXPECT_EQ(actual.singularM, expected.singularM);
+    EXPECT_EQ(actual.regularNegM, expected.regularNegM);
+    EXPECT_EQ(actual.singularNegM, expected.singularNegM);
+    EXPECT_EQ(actual.flippedRegularM, expected.flippedRegularM);
+    EXPECT_EQ(actual.flippedSingularM, expected.flippedSingularM);
+    EXPECT_EQ(actual.flippedRegularNegM, expected.flippedRegularNegM);
+    EXPECT_EQ(actual.flippedSingularNegM, expected.flippedSingularNegM);
+}
+
+} // namespace
+
+// Test fixture for steganalysis tests with automatic output cleanup
+class SteganalysisTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    void TearDown() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    // Smooth shading with mild sensor noise, close enough to a photo for both tests
+    static ImageData MakeCover(int width, int height, int channels) {
+        std::mt19937 rng(1234);
+        std::normal_distribution<double> noise(0.0, 1.5);
+        ImageData image(std::vector<uint8_t>(static_cast<std::size_t>(width) * height * channels), width, height, channels);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                for (int c = 0; c < channels; ++c) {
+                    double value = 120.0 + 60.0 * std::sin(x * 0.021 + c) * std::cos(y * 0.017)
+                                 + 25.0 * std::sin((x + 2 * y) * 0.006) + noise(rng);
+                    image.pixels[(static_cast<std::size_t>(y) * width + x) * channels + c] =
+                        static_cast<uint8_t>(std::clamp(std::lround(value), 0L, 255L));
+                }
+            }
+        }
+        return image;
+    }
+
+    // LSB replacement with random bits on the first `fraction` of samples (raster order),
+    // or on a random `fraction` of all samples when scattered
+    static void EmbedRandomBits(ImageData &image, double fraction, bool scattered) {
+        std::mt19937 rng(99);
+        std::bernoulli_distribution pick(fraction);
+        std::size_t limit = static_cast<std::size_t>(image.pixels.size() * fraction);
+        for (std::size_t idx = 0; idx < image.pixels.size(); ++idx) {
+            bool carries = scattered ? pick(rng) : idx < limit;
+            if (carries) {
+                image.pixels[idx] = static_cast<uint8_t>((image.pixels[idx] & 0xFE) | (rng() & 1));
+            }
+        }
+    }
+};
+
+// Statistic Tests
+
+TEST_F(SteganalysisTest, ChiSquareSeparatesEvenAndUnevenPairs) {
+    std::array<uint64_t, 256> even{};
+    std::array<uint64_t, 256> uneven{};
+    for (std::size_t value = 0; value < 256; value += 2) {
+        even[value] = 1000 + value;
+        even[value + 1] = 1000 + value;
+        uneven[value] = 1500;
+        uneven[value + 1] = 500;
+    }
+
+    EXPECT_GT(Steganalysis::ChiSquareProbability(even), 0.99);
+    EXPECT_LT(Steganalysis::ChiSquareProbability(uneven), 0.01);
+    EXPECT_EQ(Steganalysis::ChiSquareProbability({}), 0.0);
+}
+
+// Runs once per RS group kernel
+class SteganalysisKernelTest : public SimdLevelTest {};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, SteganalysisKernelTest, AllSimdLevels(), SimdLevelParamName);
+
+TEST_P(SteganalysisKernelTest, RSGroupCountsMatchTheDefinition) {
+    // Smooth runs and the extremes 0 and 255, where the shifted flip leaves the 8-bit range
+    auto random = TestHelpers::GenerateRandomData(4 * 200);
+    std::vector<uint8_t> samples(random.size());
+    for (std::size_t idx = 0; idx < samples.size(); ++idx) {
+        samples[idx] = idx % 3 == 0 ? random[idx] : static_cast<uint8_t>((idx / 16) % 2 ? 255 - random[idx] % 3 : random[idx] % 3);
+    }
+
+    for (std::size_t first : {std::size_t(0), std::size_t(1)}) {
+        for (std::size_t groups = 0; groups <= 100; ++groups) {
+            RSCounts counts;
+            Steganalysis::CountRSGroups(samples.data() + first, groups, counts);
+            ExpectSameCounts(counts, CountRSGroupsNaively(samples.data() + first, groups));
+        }
+    }
+
+    // Counts add up, and a long run outlasts the kernels' narrow counters
+    auto large = TestHelpers::GenerateRandomData(4 * 600000);
+    RSCounts counts;
+    Steganalysis::CountRSGroups(large.data(), 300000, counts);
+    Steganalysis::CountRSGroups(large.data() + 4 * 300000, 300000, counts);
+    ExpectSameCounts(counts, CountRSGroupsNaively(large.data(), 600000));
+}
+
+TEST_F(SteganalysisTest, EstimatesOfEmptyCountsAreZero) {
+    EXPECT_EQ(Steganalysis::EstimateRS(RSCounts{}), 0.0);
+    EXPECT_EQ(Steganalysis::EstimateSPA(SPACounts{}), 0.0);
+    EXPECT_EQ(Steganalysis::EstimateWS(WSSums{}), 0.0);
+}
+
+// Image Tests
+
+TEST_F(SteganalysisTest, CleanCoverIsNotSuspicious) {
+    auto result = Steganalysis::AnalyzeImage(MakeCover(512, 384, 3));
+    ASSERT_TRUE(result.IsSuccess()) << result.GetErrorMessage();
+
+    const auto &report = result.GetValue();
+    EXPECT_EQ(report.channelScores.size(), 3u);
+    EXPECT_LT(report.chiSquare, Steganalysis::CHI_SQUARE_THRESHOLD);
+    EXPECT_LT(report.rs, Steganalysis::PAYLOAD_THRESHOLD);
+    EXPECT_LT(report.spa, Steganalysis::PAYLOAD_THRESHOLD);
+    EXPECT_LT(report.ws, Steganalysis::PAYLOAD_THRESHOLD);
+    EXPECT_FALSE(report.suspicious);
+}
+
+TEST_F(SteganalysisTest, FullLSBReplacementIsDetected) {
+    auto image = MakeCover(512, 384, 3);
+    EmbedRandomBits(image, 1.0, false);
+
+    auto report = Steganalysis::AnalyzeImage(image).GetValue();
+    EXPECT_GT(report.chiSquare, Steganalysis::CHI_SQUARE_THRESHOLD);
+    EXPECT_GT(report.rs, 0.8);
+    EXPECT_TRUE(report.suspicious);
+}
+
+TEST_F(SteganalysisTest, RSEstimatesScatteredEmbeddingRate) {
+    auto image = MakeCover(512, 384, 1);
+    EmbedRandomBits(image, 0.4, true);
+
+    auto report = Steganalysis::AnalyzeImage(image).GetValue();
+    EXPECT_NEAR(report.rs, 0.4, 0.1);
+    EXPECT_TRUE(report.suspicious);
+}
+
+TEST_F(SteganalysisTest, PayloadEstimatesPerChannel) {
+    auto image = MakeCover(512, 384, 3);
+    EmbedRandomBits(image, 0.3, true);
+
+    auto report = Steganalysis::AnalyzeImage(image).GetValue();
+    ASSERT_EQ(report.channelScores.size(), 3u);
+    for (const auto &scores : report.channelScores) {
+        EXPECT_NEAR(scores.spa, 0.3, 0.05);
+        EXPECT_NEAR(scores.ws, 0.3, 0.05);
+    }
+
+    // 0.3 bits per pixel in each of the 3 channels
+    double expectedBytes = 0.3 * 3 * 512 * 384 / 8;
+    EXPECT_NEAR(static_cast<double>(report.payloadBytes), expectedBytes, expectedBytes * 0.15);
+}
+
+TEST_F(SteganalysisTest, SequentialPartialEmbeddingIsDetected) {
+    auto image = MakeCover(512, 512, 1);
+    EmbedRandomBits(image, 0.5, false);
+
+    auto report = Steganalysis::AnalyzeImage(image).GetValue();
+    EXPECT_GT(report.chiSquare, Steganalysis::CHI_SQUARE_THRESHOLD);
+    EXPECT_NEAR(report.rs, 0.5, 0.1);
+}
+
+TEST_F(SteganalysisTest, ParallelAndSerialPassesAgree) {
+    auto image = MakeCover(301, 203, 4);
+    EmbedRandomBits(image, 0.3, true);
+
+    auto parallel = Steganalysis::AnalyzeImage(image, true).GetValue();
+    auto serial = Steganalysis::AnalyzeImage(image, false).GetValue();
+    ASSERT_EQ(parallel.channelScores.size(), 3u); // alpha skipped
+    for (std::size_t channel = 0; channel < 3; ++channel) {
+        EXPECT_EQ(parallel.channelScores[channel].chiSquare, serial.channelScores[channel].chiSquare);
+        EXPECT_EQ(parallel.channelScores[channel].rs, serial.channelScores[channel].rs);
+        EXPECT_EQ(parallel.channelScores[channel].spa, serial.channelScores[channel].spa);
+        EXPECT_EQ(parallel.channelScores[channel].ws, serial.channelScores[channel].ws);
+    }
+}
+
+TEST_F(SteganalysisTest, InvalidImageIsRejected) {
+    ImageData empty;
+    EXPECT_EQ(Steganalysis::AnalyzeImage(empty).GetErrorCode(), ErrorCode::InvalidImageDimensions);
+}
+
+// File and Report Tests
+
+TEST_F(SteganalysisTest, CollectImagesScansDirectories) {
+    auto files = Steganalysis::CollectImages(TestHelpers::GetFixturesDir().string());
+    ASSERT_TRUE(files.IsSuccess()) << files.GetErrorMessage();
+    EXPECT_TRUE(std::is_sorted(files.GetValue().begin(), files.GetValue().end()));
+    for (const auto &file : files.GetValue()) {
+        EXPECT_EQ(file.find(".txt"), std::string::npos);
+    }
+    EXPECT_GE(files.GetValue().size(), 10u);
+
+    auto single = Steganalysis::CollectImages(TestHelpers::GetFixturePath("small_rgb.png").string());
+    ASSERT_TRUE(single.IsSuccess());
+    EXPECT_EQ(single.GetValue().size(), 1u);
+
+    EXPECT_EQ(Steganalysis::CollectImages("does/not/exist").GetErrorCode(), ErrorCode::FileNotFound);
+}
+
+TEST_F(SteganalysisTest, SixteenBitImagesAreRejected) {
+    auto path = TestHelpers::GetOutputPath("sixteen.png").string();
+    ImageData16 image(std::vector<uint16_t>(32 * 32 * 3, 0x1234), 32, 32, 3);
+    ASSERT_TRUE(ImageIO::Save(path, image).IsSuccess());
+
+    auto result = Steganalysis::AnalyzeFile(path);
+    EXPECT_EQ(result.GetErrorCode(), ErrorCode::UnsupportedImageFormat);
+    EXPECT_NE(result.GetErrorMessage().find("16-bit"), std::string::npos);
+
+    auto reports = Steganalysis::AnalyzeFiles({path});
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_FALSE(reports[0].error.empty());
+}
+
+TEST_F(SteganalysisTest, ReportsKeepOrderAndLoadErrors) {
+    auto stegoPath = TestHelpers::GetOutputPath("stego.png").string();
+    auto image = MakeCover(128, 96, 3);
+    EmbedRandomBits(image, 1.0, false);
+    ASSERT_TRUE(ImageIO::Save(stegoPath, image).IsSuccess());
+
+    std::vector<std::string> files = {
+        TestHelpers::GetFixturePath("medium_rgb.png").string(),
+        TestHelpers::GetOutputPath("missing.png").string(),
+        stegoPath
+    };
+    auto reports = Steganalysis::AnalyzeFiles(files);
+    ASSERT_EQ(reports.size(), 3u);
+    EXPECT_EQ(reports[0].file, files[0]);
+    EXPECT_TRUE(reports[0].error.empty());
+    EXPECT_FALSE(reports[1].error.empty());
+    EXPECT_TRUE(reports[2].suspicious);
+
+    std::string json = Steganalysis::ToJson(reports);
+    EXPECT_NE(json.find("\"images\": ["), std::string::npos);
+    EXPECT_NE(json.find("\"error\": "), std::string::npos);
+    EXPECT_NE(json.find("\"suspicious\": true"), std::string::npos);
+    EXPECT_NE(json.find("\"ws\": "), std::string::npos);
+    EXPECT_NE(json.find("\"payloadBytes\": "), std::string::npos);
+    EXPECT_EQ(Steganalysis::ToJson({}), "{\n  \"images\": []\n}\n");
+
+    ImageAnalysis named;
+    named.file = "dir\\a \"b\".png";
+    named.error = "bad\n";
+    EXPECT_NE(Steganalysis::ToJson({named}).find("\"dir\\\\a \\\"b\\\".png\", \"error\": \"bad\\u000a\""), std::string::npos);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "../synthetic_cover.h"
+
+#include <set>
+
+TEST(SyntheticCoverTest, SameSpecSameImage) {
+    for (auto pattern : {SyntheticCover::Pattern::Noise, SyntheticCover::Pattern::Gradient, SyntheticCover::Pattern::Photo}) {
+        SyntheticCover::Spec spec{200, 150, 3, pattern, 7};
+        ImageData first = SyntheticCover::Generate(spec);
+        ImageData second = SyntheticCover::Generate(spec);
+
+        EXPECT_EQ(first.width, 200);
+        EXPECT_EQ(first.height, 150);
+        EXPECT_EQ(first.channels, 3);
+        ASSERT_EQ(first.pixels.size(), 200u * 150u * 3u);
+        EXPECT_EQ(first.pixels, second.pixels) << SyntheticCover::GetPatternName(pattern);
+    }
+}
+
+TEST(SyntheticCoverTest, SeedChangesRandomPatterns) {
+    SyntheticCover::Spec spec{64, 64, 1, SyntheticCover::Pattern::Noise, 1};
+    ImageData first = SyntheticCover::Generate(spec);
+    spec.seed = 2;
+    EXPECT_NE(first.pixels, SyntheticCover::Generate(spec).pixels);
+
+    spec.pattern = SyntheticCover::Pattern::Photo;
+    ImageData photo = SyntheticCover::Generate(spec);
+    spec.seed = 3;
+    EXPECT_NE(photo.pixels, SyntheticCover::Generate(spec).pixels);
+}
+
+TEST(SyntheticCoverTest, PhotoHasAlphaAndVariedSamples) {
+    ImageData image = SyntheticCover::Generate({128, 96, 4, SyntheticCover::Pattern::Photo, 1});
+
+    std::set<uint8_t> colorValues;
+    for (std::size_t idx = 0; idx < image.pixels.size(); idx += 4) {
+        EXPECT_EQ(image.pixels[idx + 3], 255);
+        colorValues.insert(image.pixels[idx]);
+    }
+    EXPECT_GT(colorValues.size(), 32u);
+}
+
+TEST(SyntheticCoverTest, MegapixelsGiveFourToThree) {
+    SyntheticCover::Spec spec = SyntheticCover::FromMegapixels(12, 3, SyntheticCover::Pattern::Gradient);
+    EXPECT_EQ(spec.width, 4000);
+    EXPECT_EQ(spec.height, 3000);
+    EXPECT_EQ(spec.channels, 3);
+}
+
+TEST(SyntheticCoverTest, PayloadIsDeterministic) {
+    auto payload = SyntheticCover::GeneratePayload(1001, 5);
+    ASSERT_EQ(payload.size(), 1001u);
+    EXPECT_EQ(payload, SyntheticCover::GeneratePayload(1001, 5));
+    EXPECT_NE(payload, SyntheticCover::GeneratePayload(1001, 6));
+    EXPECT_TRUE(SyntheticCover::GeneratePayload(0).empty());
+}
+
+TEST(SyntheticCoverTest, ParsesPatternNames) {
+    EXPECT_EQ(SyntheticCover::ParsePattern("photo").GetValue(), SyntheticCover::Pattern::Photo);
+    EXPECT_EQ(SyntheticCover::ParsePattern("noise").GetValue(), SyntheticCover::Pattern::Noise);
+    EXPECT_FALSE(SyntheticCover::ParsePattern("plaid").IsSuccess());
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "utils/TraceRecorder.h"
+#include "utils/Stats.h"
+#include "utils/Parallel.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+// The recorder is process wide: every test leaves it stopped
+class TraceRecorderTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        TraceRecorder::Stop();
+    }
+
+    static std::size_t CountOf(const std::string &text, const std::string &needle) {
+        std::size_t count = 0;
+        for (std::size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+            ++count;
+        }
+        return count;
+    }
+};
+
+TEST_F(TraceRecorderTest, RecordsNothingWhileStopped) {
+    TraceRecorder::Start();
+    TraceRecorder::Stop();
+    {
+        StageTimer timer(Stats::Stage::Embed, 10);
+        TraceSpan span("idle", "test");
+    }
+    EXPECT_EQ(TraceRecorder::GetEventCount(), 0u);
+}
+
+TEST_F(TraceRecorderTest, StageTimersBecomeSpans) {
+    TraceRecorder::Start();
+    {
+        StageTimer timer(Stats::Stage::Cipher, 128);
+        timer.Stop();
+        timer.Stop();
+    }
+    {
+        TraceSpan span("custom", "test");
+    }
+    TraceRecorder::Stop();
+
+    EXPECT_EQ(TraceRecorder::GetEventCount(), 2u);
+    std::string json = TraceRecorder::FormatJson();
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"cipher\", \"cat\": \"stage\", \"ph\": \"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\": {\"bytes\": 128}"), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"custom\", \"cat\": \"test\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\": {\"name\": \"main\"}"), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, StartDropsEarlierSpans) {
+    TraceRecorder::Start();
+    {
+        TraceSpan span("first", "test");
+    }
+    TraceRecorder::Start();
+    TraceRecorder::Stop();
+
+    EXPECT_EQ(TraceRecorder::GetEventCount(), 0u);
+    EXPECT_EQ(TraceRecorder::FormatJson().find("\"first\""), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, ThreadsRecordIntoTheirOwnRows) {
+    // Both threads stay alive until both have recorded, so neither can take over the other's buffer
+    std::atomic<int> recorded{0};
+    auto record = [&](const char *name) {
+        {
+            TraceSpan span(name, "test");
+        }
+        ++recorded;
+        while (recorded < 2) {
+            std::this_thread::yield();
+        }
+    };
+
+    TraceRecorder::Start();
+    std::thread first(record, "a");
+    std::thread second(record, "b");
+    first.join();
+    second.join();
+    TraceRecorder::Stop();
+
+    std::string json = TraceRecorder::FormatJson();
+    EXPECT_EQ(TraceRecorder::GetEventCount(), 2u);
+    EXPECT_EQ(CountOf(json, "\"name\": \"thread_name\""), 3u);
+    EXPECT_EQ(CountOf(json, "\"args\": {\"name\": \"worker "), 2u);
+}
+
+TEST_F(TraceRecorderTest, FinishedThreadsHandTheirBufferOn) {
+    TraceRecorder::Start();
+    for (int idx = 0; idx < 4; ++idx) {
+        std::thread worker([] { TraceSpan span("step", "test"); });
+        worker.join();
+    }
+    TraceRecorder::Stop();
+
+    // One row for main, one shared by the workers that ran one after another
+    std::string json = TraceRecorder::FormatJson();
+    EXPECT_EQ(CountOf(json, "\"name\": \"step\""), 4u);
+    EXPECT_EQ(CountOf(json, "\"name\": \"thread_name\""), 2u);
+}
+
+TEST_F(TraceRecorderTest, ParallelForMarksWorkersAndJoin) {
+    if (Parallel::GetThreadCount() < 2) {
+        GTEST_SKIP() << "Needs more than one worker thread";
+    }
+
+    TraceRecorder::Start();
+    std::size_t items = Parallel::GetThreadCount() * 4;
+    Parallel::For(items, [](std::size_t) {
+        StageTimer timer(Stats::Stage::Embed);
+    });
+    TraceRecorder::Stop();
+
+    std::string json = TraceRecorder::FormatJson();
+    EXPECT_EQ(CountOf(json, "\"name\": \"embed\""), items);
+    EXPECT_EQ(CountOf(json, "\"name\": \"join\", \"cat\": \"wait\""), 1u);
+    EXPECT_GE(CountOf(json, "\"name\": \"worker\""), 2u);
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include "algorithms/wav/WAVStegoHandler.h"
+#include "utils/MappedFile.h"
+#include "../test_helpers.h"
+
+// Test fixture for WAV handler tests with automatic output cleanup
+class WAVHandlerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    void TearDown() override {
+        TestHelpers::CleanOutputDirectory();
+    }
+
+    static void PutLE(std::vector<uint8_t> &out, uint32_t value, int bytes) {
+        for (int idx = 0; idx < bytes; ++idx) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * idx)));
+        }
+    }
+
+    // Build a PCM WAV with noise samples and a LIST chunk before the data
+    static std::vector<uint8_t> BuildWav(uint16_t channels, uint16_t bits, std::size_t frames,
+                                         uint16_t format = 1) {
+        uint16_t blockAlign = static_cast<uint16_t>(channels * (bits / 8));
+        auto samples = TestHelpers::GenerateRandomData(frames * blockAlign);
+
+        std::vector<uint8_t> wav = {'R', 'I', 'F', 'F'};
+        PutLE(wav, static_cast<uint32_t>(4 + 24 + 12 + 8 + samples.size()), 4);
+        wav.insert(wav.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+        PutLE(wav, 16, 4);
+        PutLE(wav, format, 2);
+        PutLE(wav, channels, 2);
+        PutLE(wav, 44100, 4);
+        PutLE(wav, 44100u * blockAlign, 4);
+        PutLE(wav, blockAlign, 2);
+        PutLE(wav, bits, 2);
+        wav.insert(wav.end(), {'L', 'I', 'S', 'T'});
+        PutLE(wav, 3, 4);
+        wav.insert(wav.end(), {'a', 'b', 'c', 0}); // odd size + pad byte
+        wav.insert(wav.end(), {'d', 'a', 't', 'a'});
+        PutLE(wav, static_cast<uint32_t>(samples.size()), 4);
+        wav.insert(wav.end(), samples.begin(), samples.end());
+        return wav;
+    }
+
+    static std::string WriteWav(const std::string &filename, const std::vector<uint8_t> &wav) {
+        auto path = TestHelpers::GetOutputPath(filename);
+        TestHelpers::WriteBinaryFile(path, wav);
+        return path.string();
+    }
+};
+
+// Layout Tests
+
+TEST_F(WAVHandlerTest, ParsesPcmLayouts) {
+    for (uint16_t bits : {8, 16, 24, 32}) {
+        auto wav = BuildWav(2, bits, 1000);
+        auto layout = WAVStegoHandler::ParseLayout(wav.data(), wav.size());
+        ASSERT_TRUE(layout.IsSuccess()) << layout.GetErrorMessage();
+
+        EXPECT_EQ(layout.GetValue().channels, 2);
+        EXPECT_EQ(layout.GetValue().sampleRate, 44100u);
+        EXPECT_EQ(layout.GetValue().bytesPerSample, bits / 8);
+        EXPECT_EQ(layout.GetValue().dataOffset, 56u);
+        EXPECT_EQ(layout.GetValue().GetSampleCount(), 2000u);
+        EXPECT_EQ(WAVStegoHandler::CalculateCapacity(layout.GetValue()), (2000u - WAVStegoHandler::HEADER_SIZE_BITS) / 8);
+    }
+}
+
+TEST_F(WAVHandlerTest, ClampsTruncatedDataChunk) {
+    auto wav = BuildWav(1, 16, 1000);
+    wav.resize(wav.size() - 101); // cut mid-sample
+
+    auto layout = WAVStegoHandler::ParseLayout(wav.data(), wav.size());
+    ASSERT_TRUE(layout.IsSuccess()) << layout.GetErrorMessage();
+    EXPECT_EQ(layout.GetValue().GetSampleCount(), 949u);
+}
+
+TEST_F(WAVHandlerTest, RejectsNonPcmAndMalformedFiles) {
+    auto floatWav = BuildWav(1, 32, 100, 3);
+    EXPECT_EQ(WAVStegoHandler::ParseLayout(floatWav.data(), floatWav.size()).GetErrorCode(),
+              ErrorCode::UnsupportedImageFormat);
+
+    auto oddBits = BuildWav(1, 16, 100);
+    oddBits[34] = 12;
+    EXPECT_EQ(WAVStegoHandler::ParseLayout(oddBits.data(), oddBits.size()).GetErrorCode(),
+              ErrorCode::UnsupportedImageFormat);
+
+    auto notRiff = BuildWav(1, 16, 100);
+    notRiff[0] = 'X';
+    EXPECT_EQ(WAVStegoHandler::ParseLayout(notRiff.data(), notRiff.size()).GetErrorCode(),
+              ErrorCode::UnsupportedImageFormat);
+
+    auto noData = BuildWav(1, 16, 100);
+    noData.resize(48); // ends inside the LIST chunk
+    EXPECT_EQ(WAVStegoHandler::ParseLayout(noData.data(), noData.size()).GetErrorCode(),
+              ErrorCode::ImageCorrupted);
+}
+
+// Sample Level Tests
+
+TEST_F(WAVHandlerTest, RoundTripsThroughSamples) {
+    WAVStegoHandler handler;
+    for (uint16_t bits : {8, 16, 24}) {
+        auto wav = BuildWav(2, bits, 20000);
+        auto layout = WAVStegoHandler::ParseLayout(wav.data(), wav.size()).GetValue();
+        auto payload = TestHelpers::GenerateRandomData(WAVStegoHandler::CalculateCapacity(layout));
+
+        ASSERT_TRUE(handler.EmbedSamples(wav.data(), layout, payload).IsSuccess());
+
+        auto extractResult = handler.ExtractSamples(wav.data(), layout);
+        ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+        EXPECT_EQ(extractResult.GetValue(), payload);
+    }
+}
+
+TEST_F(WAVHandlerTest, OnlyChangesBitZeroOfEachSample) {
+    WAVStegoHandler handler;
+    auto original = BuildWav(1, 24, 5000);
+    auto wav = original;
+    auto layout = WAVStegoHandler::ParseLayout(wav.data(), wav.size()).GetValue();
+    auto payload = TestHelpers::GenerateRandomData(300);
+
+    ASSERT_TRUE(handler.EmbedSamples(wav.data(), layout, payload).IsSuccess());
+
+    std::size_t changed = 0;
+    for (std::size_t idx = 0; idx < wav.size(); ++idx) {
+        bool lowByte = idx >= layout.dataOffset && (idx - layout.dataOffset) % 3 == 0;
+        if (!lowByte) {
+            EXPECT_EQ(wav[idx], original[idx]); // headers and upper sample bytes untouched
+            continue;
+        }
+        EXPECT_EQ(wav[idx] | 1, original[idx] | 1);
+        changed += wav[idx] != original[idx];
+    }
+    EXPECT_GT(changed, 0u);
+}
+
+TEST_F(WAVHandlerTest, RejectsEmptyAndOversizedData) {
+    WAVStegoHandler handler;
+    auto wav = BuildWav(1, 16, 1000);
+    auto layout = WAVStegoHandler::ParseLayout(wav.data(), wav.size()).GetValue();
+
+    EXPECT_EQ(handler.EmbedSamples(wav.data(), layout, {}).GetErrorCode(), ErrorCode::InvalidArgument);
+
+    std::vector<uint8_t> tooLarge(WAVStegoHandler::CalculateCapacity(layout) + 1, 0x42);
+    EXPECT_EQ(handler.EmbedSamples(wav.data(), layout, tooLarge).GetErrorCode(),
+              ErrorCode::InsufficientCapacity);
+}
+
+// File Level Tests
+
+TEST_F(WAVHandlerTest, CopyOnWriteMappingLeavesFileUntouched) {
+    auto wav = BuildWav(1, 16, 1000);
+    auto path = WriteWav("cover.wav", wav);
+
+    auto mapResult = MappedFile::Open(path, MappedFile::Mode::CopyOnWrite);
+    ASSERT_TRUE(mapResult.IsSuccess()) << mapResult.GetErrorMessage();
+    MappedFile file = std::move(mapResult.GetValue());
+    ASSERT_EQ(file.Size(), wav.size());
+
+    file.Data()[100] ^= 0xFF;
+    ASSERT_TRUE(file.WriteTo(TestHelpers::GetOutputPath("copy.wav").string()).IsSuccess());
+    file.Close();
+
+    EXPECT_EQ(TestHelpers::ReadBinaryFile(path), wav);
+    auto copy = TestHelpers::ReadBinaryFile(TestHelpers::GetOutputPath("copy.wav"));
+    ASSERT_EQ(copy.size(), wav.size());
+    EXPECT_EQ(copy[100], static_cast<uint8_t>(wav[100] ^ 0xFF));
+}
+
+TEST_F(WAVHandlerTest, EmbedExtractFileRoundTrip) {
+    auto cover = WriteWav("cover.wav", BuildWav(2, 16, 50000));
+    auto data = TestHelpers::CreateTempFile("secret.bin", TestHelpers::GenerateRandomData(4000));
+    auto stego = TestHelpers::GetOutputPath("stego.wav").string();
+    auto recovered = TestHelpers::GetOutputPath("recovered.bin").string();
+
+    WAVStegoHandler handler;
+    auto embedResult = handler.Embed(cover, data.string(), stego, "pw");
+    ASSERT_TRUE(embedResult.IsSuccess()) << embedResult.GetErrorMessage();
+    EXPECT_EQ(TestHelpers::GetFileSize(stego), TestHelpers::GetFileSize(cover));
+    EXPECT_FALSE(TestHelpers::FilesAreIdentical(stego, cover));
+
+    auto extractResult = handler.Extract(stego, recovered, "pw");
+    ASSERT_TRUE(extractResult.IsSuccess()) << extractResult.GetErrorMessage();
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(data, recovered));
+}
+
+TEST_F(WAVHandlerTest, EmbedCanOverwriteTheCover) {
+    auto cover = WriteWav("cover.wav", BuildWav(1, 8, 50000));
+    auto data = TestHelpers::CreateTempFile("secret.bin", TestHelpers::GenerateRandomData(1000));
+    auto recovered = TestHelpers::GetOutputPath("recovered.bin").string();
+
+    WAVStegoHandler handler;
+    auto embedResult = handler.Embed(cover, data.string(), cover, "pw");
+    ASSERT_TRUE(embedResult.IsSuccess()) << embedResult.GetErrorMessage();
+    EXPECT_FALSE(TestHelpers::FileExists(cover + ".tmp"));
+
+    ASSERT_TRUE(handler.Extract(cover, recovered, "pw").IsSuccess());
+    EXPECT_TRUE(TestHelpers::FilesAreIdentical(data, recovered));
+}
+
+TEST_F(WAVHandlerTest, RejectsNonWavOutputAndPixelMethods) {
+    auto cover = WriteWav("cover.wav", BuildWav(1, 16, 1000));
+    auto data = TestHelpers::CreateTempFile("secret.bin", {1, 2, 3});
+
+    WAVStegoHandler handler;
+    EXPECT_EQ(handler.Embed(cover, data.string(), TestHelpers::GetOutputPath("stego.png").string(), "").GetErrorCode(),
+              ErrorCode::UnsupportedImageFormat);
+
+    ImageData image(std::vector<uint8_t>(16, 0), 4, 4, 1);
+    EXPECT_EQ(handler.EmbedMethod(image, {1}, "").GetErrorCode(), ErrorCode::NotImplemented);
+    EXPECT_EQ(handler.ExtractMethod(image, "").GetErrorCode(), ErrorCode::NotImplemented);
+}